@@ -25,6 +25,8 @@
 #include <thread>
 #include <poll.h>
 #include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
 
 namespace md = mir::dispatch;
 
@@ -72,6 +74,39 @@ private:
 
 thread_local uint64_t TestDispatchable::dispatch_count = 0;
 
+/// Stays readable, so is dispatched every time the multiplexer rearms it
+class AlwaysReadyDispatchable : public md::Dispatchable
+{
+public:
+    AlwaysReadyDispatchable(uint64_t& dispatch_count)
+        : fd{eventfd(1, EFD_CLOEXEC)},
+          dispatch_count{dispatch_count}
+    {
+        if (fd == mir::Fd::invalid)
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to create eventfd"};
+        }
+    }
+
+    mir::Fd watch_fd() const override
+    {
+        return fd;
+    }
+    bool dispatch(md::FdEvents) override
+    {
+        ++dispatch_count;
+        return true;
+    }
+    md::FdEvents relevant_events() const override
+    {
+        return md::FdEvent::readable;
+    }
+
+private:
+    mir::Fd const fd;
+    uint64_t& dispatch_count;
+};
+
 bool fd_is_readable(int fd)
 {
     struct pollfd poller {
@@ -82,6 +117,30 @@ bool fd_is_readable(int fd)
     return poll(&poller, 1, 0);
 }
 
+void dispatch_ready_fds(int ready_count, uint64_t dispatch_count)
+{
+    uint64_t dispatched{0};
+    md::MultiplexingDispatchable dispatcher;
+    std::vector<std::shared_ptr<AlwaysReadyDispatchable>> sources;
+    for (int i = 0; i < ready_count; ++i)
+    {
+        sources.push_back(std::make_shared<AlwaysReadyDispatchable>(dispatched));
+        dispatcher.add_watch(sources.back());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (dispatched < dispatch_count)
+    {
+        dispatcher.dispatch(md::FdEvent::readable);
+    }
+
+    auto duration = std::chrono::steady_clock::now() - start;
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    std::cout<<"With "<<ready_count<<" ready fds dispatching "<<dispatched<<" times took "<<nanoseconds<<"ns"
+             <<" ("<<dispatched * 1000000000.0 / nanoseconds<<" dispatches/s)"<<std::endl;
+}
+
 int main(int argc, char** argv)
 {
     if (argc != 3)
@@ -117,5 +176,18 @@ int main(int argc, char** argv)
 
     auto duration = std::chrono::steady_clock::now() - start;
     std::cout<<"Dispatching "<<dispatch_count<<" times took "<<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns"<<std::endl;
+
+    // Enough fds for the largest set of sources
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    for (int ready_count : {1, 10, 100, 1000})
+    {
+        dispatch_ready_fds(ready_count, dispatch_count);
+    }
     exit(0);
 }
@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/basic_observers.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct Observer
+{
+    virtual ~Observer() = default;
+    virtual void notify() = 0;
+};
+
+struct CountingObserver : Observer
+{
+    void notify() override { ++count; }
+    uint64_t count{0};
+};
+
+struct Observers : Observer, mir::BasicObservers<Observer>
+{
+    using mir::BasicObservers<Observer>::add;
+    using mir::BasicObservers<Observer>::remove;
+
+    void notify() override
+    {
+        for_each([](std::shared_ptr<Observer> const& observer) { observer->notify(); });
+    }
+};
+
+/// Time for thread_count threads to each notify all observers `notifications` times
+auto time_notifications(Observers& observers, int thread_count, uint64_t notifications, bool churn)
+    -> std::chrono::nanoseconds
+{
+    std::atomic<bool> started{false};
+    std::atomic<bool> finished{false};
+
+    // Adds and removes an observer concurrently with the notifications
+    std::thread churner;
+    if (churn)
+    {
+        churner = std::thread{[&]
+            {
+                auto const observer = std::make_shared<CountingObserver>();
+                while (!finished)
+                {
+                    observers.add(observer);
+                    observers.remove(observer);
+                }
+            }};
+    }
+
+    std::vector<std::thread> notifiers;
+    for (int i = 0; i < thread_count; ++i)
+    {
+        notifiers.emplace_back([&]
+            {
+                while (!started) std::this_thread::yield();
+
+                for (uint64_t n = 0; n != notifications; ++n)
+                {
+                    observers.notify();
+                }
+            });
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    started = true;
+
+    for (auto& thread : notifiers)
+    {
+        thread.join();
+    }
+
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    finished = true;
+    if (churner.joinable()) churner.join();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4 || argc > 5)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <max threads> <observers> <notifications per thread> [churn]"<<std::endl;
+        std::cout<<"  Notifies from 1, 2, 4, ... <max threads> threads; \"churn\" adds and removes"<<std::endl;
+        std::cout<<"  an observer on another thread while notifying."<<std::endl;
+        exit(1);
+    }
+
+    int const max_threads = std::atoi(argv[1]);
+    int const observer_count = std::atoi(argv[2]);
+    uint64_t const notifications = std::atoll(argv[3]);
+    bool const churn = argc == 5 && std::string{argv[4]} == "churn";
+
+    Observers observers;
+    for (int i = 0; i < observer_count; ++i)
+    {
+        observers.add(std::make_shared<CountingObserver>());
+    }
+
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        auto const duration = time_notifications(observers, threads, notifications, churn);
+        auto const calls = threads * notifications * observer_count;
+
+        std::cout<<threads<<" thread(s): "<<calls<<" observer calls took "<<duration.count()<<"ns ("
+                 <<(calls ? double(duration.count()) / calls : 0.0)<<"ns per call)"<<std::endl;
+    }
+
+    exit(0);
+}
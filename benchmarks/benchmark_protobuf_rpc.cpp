@@ -0,0 +1,254 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures the protobuf work of a buffer swap on both ends of a mirclient
+// connection: the client's submit_buffer invocation, the server's (empty)
+// response and the buffer event that returns the next buffer to the client.
+// The "copying" path is how each end used to (de)serialize messages; the
+// "in place" path is the current one.
+
+#include "mir/protobuf/wire_codec.h"
+
+#include "mir_protobuf.pb.h"
+#include "mir_protobuf_wire.pb.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace mp = mir::protobuf;
+
+namespace
+{
+std::atomic<uint64_t> allocations{0};
+
+mp::BufferRequest make_submission(int buffer_id)
+{
+    mp::BufferRequest request;
+    request.mutable_id()->set_value(1);
+    auto const buffer = request.mutable_buffer();
+    buffer->set_buffer_id(buffer_id);
+    buffer->set_width(1920);
+    buffer->set_height(1080);
+    buffer->set_stride(7680);
+    buffer->set_flags(0);
+    buffer->set_fds_on_side_channel(1);
+    return request;
+}
+
+mp::EventSequence make_buffer_event(int buffer_id)
+{
+    mp::EventSequence seq;
+    auto const request = seq.mutable_buffer_request();
+    request->mutable_id()->set_value(1);
+    auto const buffer = request->mutable_buffer();
+    buffer->set_buffer_id(buffer_id);
+    buffer->set_width(1920);
+    buffer->set_height(1080);
+    buffer->set_stride(7680);
+    buffer->set_fds_on_side_channel(1);
+    return seq;
+}
+
+size_t size_of(google::protobuf::MessageLite const& message)
+{
+#if GOOGLE_PROTOBUF_VERSION >= 3010000
+    return message.ByteSizeLong();
+#else
+    return message.ByteSize();
+#endif
+}
+
+/// Serializes and parses everything via intermediate strings
+struct CopyingPath
+{
+    int64_t checksum{0};
+
+    void round_trip(mp::BufferRequest const& submission, mp::EventSequence& event, uint32_t id)
+    {
+        // Client: invocation
+        mp::wire::Invocation invocation;
+        invocation.set_id(id);
+        invocation.set_method_name("submit_buffer");
+        invocation.set_parameters(submission.SerializeAsString());
+        invocation.set_protocol_version(1);
+        std::vector<uint8_t> send_buffer(size_of(invocation));
+        invocation.SerializeToArray(send_buffer.data(), send_buffer.size());
+
+        // Server: dispatch and reply
+        mp::wire::Invocation received_invocation;
+        received_invocation.ParseFromArray(send_buffer.data(), send_buffer.size());
+        mp::BufferRequest request;
+        request.ParseFromString(received_invocation.parameters());
+        checksum += request.buffer().buffer_id();
+
+        mp::Void response;
+        mp::wire::Result result;
+        result.set_id(received_invocation.id());
+        result.set_response(response.SerializeAsString());
+        auto const response_bytes = result.SerializeAsString();
+
+        mp::wire::Result event_result;
+        event_result.add_events(event.SerializeAsString());
+        auto const event_bytes = event_result.SerializeAsString();
+
+        // Client: results
+        for (auto const& bytes : {response_bytes, event_bytes})
+        {
+            mp::wire::Result received;
+            received.ParseFromArray(bytes.data(), bytes.size());
+            for (int i = 0; i != received.events_size(); ++i)
+            {
+                mp::EventSequence seq;
+                seq.ParseFromString(received.events(i));
+                checksum += seq.buffer_request().buffer().buffer_id();
+            }
+            if (received.has_id())
+            {
+                mp::Void void_response;
+                void_response.ParseFromString(received.response());
+                checksum += received.id();
+            }
+        }
+    }
+};
+
+/// Serializes into reused buffers and decodes nested messages in place
+struct InPlacePath
+{
+    int64_t checksum{0};
+
+    std::vector<uint8_t> send_buffer;
+    mp::InvocationView invocation_view;
+    mp::MessageArena server_arena;
+    std::vector<uint8_t> response_bytes;
+    std::vector<uint8_t> event_bytes;
+    mp::ResultView result_view;
+    mp::MessageArena client_arena;
+    mp::Void void_response;
+
+    void round_trip(mp::BufferRequest const& submission, mp::EventSequence& event, uint32_t id)
+    {
+        // Client: invocation
+        mp::wire::Invocation invocation;
+        invocation.set_id(id);
+        invocation.set_method_name("submit_buffer");
+        auto const parameters = invocation.mutable_parameters();
+        parameters->resize(size_of(submission));
+        submission.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(&(*parameters)[0]));
+        invocation.set_protocol_version(1);
+        send_buffer.resize(size_of(invocation));
+        invocation.SerializeWithCachedSizesToArray(send_buffer.data());
+
+        // Server: dispatch and reply
+        server_arena.reset();
+        invocation_view.parse(send_buffer.data(), send_buffer.size());
+        auto const request = server_arena.create<mp::BufferRequest>();
+        invocation_view.parameters.parse_into(*request);
+        checksum += request->buffer().buffer_id();
+
+        auto const response = server_arena.create<mp::Void>();
+        auto const response_envelope = mp::ResultEnvelope::response(invocation_view.id, size_of(*response));
+        response_bytes.resize(response_envelope.size());
+        response->SerializeWithCachedSizesToArray(response_envelope.write_header(response_bytes.data()));
+
+        auto const event_envelope = mp::ResultEnvelope::event(size_of(event));
+        event_bytes.resize(event_envelope.size());
+        event.SerializeWithCachedSizesToArray(event_envelope.write_header(event_bytes.data()));
+
+        // Client: results
+        for (auto const bytes : {&response_bytes, &event_bytes})
+        {
+            result_view.parse(bytes->data(), bytes->size());
+            for (auto const& event_field : result_view.events)
+            {
+                client_arena.reset();
+                auto const seq = client_arena.create<mp::EventSequence>();
+                event_field.parse_into(*seq);
+                checksum += seq->buffer_request().buffer().buffer_id();
+            }
+            if (result_view.has_id)
+            {
+                result_view.response.parse_into(void_response);
+                checksum += result_view.id;
+            }
+        }
+    }
+};
+
+template<typename Path>
+void run(char const* name, uint64_t round_trips)
+{
+    Path path;
+    auto const submission = make_submission(7);
+    auto event = make_buffer_event(8);
+
+    // Let any reused storage reach its working size
+    path.round_trip(submission, event, 0);
+
+    auto const allocations_before = allocations.load();
+    auto const start = std::chrono::steady_clock::now();
+
+    for (uint64_t i = 0; i != round_trips; ++i)
+    {
+        path.round_trip(submission, event, static_cast<uint32_t>(i));
+    }
+
+    auto const duration = std::chrono::steady_clock::now() - start;
+    auto const allocated = allocations.load() - allocations_before;
+
+    std::cout << name << ": " << round_trips << " buffer swaps took "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / round_trips
+              << "ns and " << static_cast<double>(allocated) / round_trips << " allocations each"
+              << " (checksum " << path.checksum << ")" << std::endl;
+}
+}
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (auto const memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <number of buffer swaps>"<<std::endl;
+        exit(1);
+    }
+
+    uint64_t const round_trips = std::atoll(argv[1]);
+
+    run<CopyingPath>("copying", round_trips);
+    run<InPlacePath>("in place", round_trips);
+}
@@ -105,6 +105,33 @@ Results compute_frame_uniformity(std::vector<TouchSamples::Sample> const& result
     return {average_pixel_offset, uniformity};
 }
 
+Results run_tests(FrameUniformityTestParameters const& parameters, int run_count)
+{
+    Results average{0, 0};
+
+    for (int i = 0; i < run_count; i++)
+    {
+        FrameUniformityTest t(parameters);
+
+        t.run_test();
+  
+        auto touch_timings = t.server_timings();
+        auto touch_start_time = touch_timings.touch_start;
+        auto touch_end_time = touch_timings.touch_end;
+        auto samples = t.client_results()->get();
+
+        auto results = compute_frame_uniformity(samples, parameters.touch_start, parameters.touch_end,
+            touch_start_time, touch_end_time);
+        
+        average.average_pixel_offset += results.average_pixel_offset;
+        average.frame_uniformity += results.frame_uniformity;
+    }
+    
+    average.average_pixel_offset /= run_count;
+    average.frame_uniformity /= run_count;
+
+    return average;
+}
 }
 
 // Main is inside a test to work around mir_test_framework 'issues' (e.g. mir_test_framework contains
@@ -117,35 +144,26 @@ TEST(FrameUniformity, average_frame_offset)
     std::chrono::milliseconds touch_duration{1000};
     
     int const run_count = 1;
-    double average_lag = 0, average_uniformity = 0;
 
     // Ensure we load the correct platform libraries
     setenv("MIR_CLIENT_PLATFORM_PATH",
            (mtf::library_path() + "/client-modules").c_str(),
            true);
-    
-    for (int i = 0; i < run_count; i++)
+
+    // Touches arrive at their own rate; compare delivering them as they come with
+    // resampling them to the (simulated) vsync
+    for (auto const resampling : {"off", "touch"})
     {
-        FrameUniformityTest t({screen_size, touch_start_point, touch_end_point, touch_duration});
+        setenv("MIR_SERVER_INPUT_RESAMPLING", resampling, true);
 
-        t.run_test();
-  
-        auto touch_timings = t.server_timings();
-        auto touch_start_time = touch_timings.touch_start;
-        auto touch_end_time = touch_timings.touch_end;
-        auto samples = t.client_results()->get();
+        auto const results = run_tests(
+            {screen_size, touch_start_point, touch_end_point, touch_duration}, run_count);
 
-        auto results = compute_frame_uniformity(samples, touch_start_point, touch_end_point,
-            touch_start_time, touch_end_time);
-        
-        average_lag += results.average_pixel_offset;
-        average_uniformity += results.frame_uniformity;
+        std::cout << "Input resampling: " << resampling << std::endl;
+        std::cout << "Average pixel lag: " << results.average_pixel_offset << "px" << std::endl;
+        std::cout << "Frame Uniformity (smaller scores are more uniform): " << results.frame_uniformity
+            << "px per sample\n" << std::endl;
     }
-    
-    average_lag /= run_count;
-    average_uniformity /= run_count;
-    
-    std::cout << "Average pixel lag: " << average_lag << "px" << std::endl;
-    std::cout << "Frame Uniformity (smaller scores are more uniform): " << average_uniformity << "px per sample\n"
-        << std::endl;
+
+    unsetenv("MIR_SERVER_INPUT_RESAMPLING");
 }
@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/gl/renderer.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_egl.h"
+#include "mir/test/doubles/mock_gl_buffer.h"
+#include "mir/test/doubles/stub_gl_display_buffer.h"
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace mg = mir::graphics;
+namespace mrg = mir::renderer::gl;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+/// Counts the GL calls made in drawing a frame (setup and queries aren't counted)
+void count_draw_calls(mtd::MockGL& gl, uint64_t& calls)
+{
+    auto const count = [&calls] { ++calls; };
+
+    ON_CALL(gl, glUseProgram(_)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glUniform1i(_, _)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glUniform1f(_, _)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glUniform2f(_, _, _)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glUniformMatrix4fv(_, _, _, _)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glEnable(_)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glDisable(_)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glBlendFuncSeparate(_, _, _, _)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glBlendColor(_, _, _, _)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glScissor(_, _, _, _)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glActiveTexture(_)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glBindTexture(_, _)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glBindBuffer(_, _)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glBufferData(_, _, _, _)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glEnableVertexAttribArray(_)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glDisableVertexAttribArray(_)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glVertexAttribPointer(_, _, _, _, _, _)).WillByDefault(InvokeWithoutArgs(count));
+    ON_CALL(gl, glDrawArrays(_, _, _)).WillByDefault(InvokeWithoutArgs(count));
+}
+
+/// A desktop's worth of small surfaces: mostly opaque, some shaped, some translucent
+auto renderables(int count) -> mg::RenderableList
+{
+    mg::RenderableList list;
+    for (int i = 0; i < count; ++i)
+    {
+        geom::Rectangle const area{{(i * 37) % 1800, (i * 23) % 1000}, {120, 80}};
+        auto const renderable = std::make_shared<mtd::FakeRenderable>(
+            area,
+            i % 7 == 0 ? 0.75f : 1.0f,
+            i % 5 != 0);
+        renderable->set_buffer(std::make_shared<NiceMock<mtd::MockGLBuffer>>());
+        list.push_back(renderable);
+    }
+    return list;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" [frames]"<<std::endl;
+        std::cout<<"  Renders 10, 100 and 500 renderables through a mock GL, reporting the GL"<<std::endl;
+        std::cout<<"  calls and the CPU time per frame. The time includes the mock's overhead,"<<std::endl;
+        std::cout<<"  so compare it between builds rather than with a real driver."<<std::endl;
+        exit(1);
+    }
+
+    int const frames = argc == 2 ? std::atoi(argv[1]) : 1000;
+
+    NiceMock<mtd::MockGL> mock_gl;
+    NiceMock<mtd::MockEGL> mock_egl;
+    mtd::StubGLDisplayBuffer display_buffer{{{0, 0}, {1920, 1080}}};
+
+    uint64_t calls{0};
+    count_draw_calls(mock_gl, calls);
+
+    for (int const count : {10, 100, 500})
+    {
+        mrg::Renderer renderer{display_buffer};
+        auto const list = renderables(count);
+
+        // The first frame compiles programs and loads textures
+        renderer.render(list);
+
+        calls = 0;
+        auto const start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame != frames; ++frame)
+        {
+            renderer.render(list);
+        }
+        std::chrono::duration<double, std::micro> const duration{std::chrono::steady_clock::now() - start};
+
+        std::cout<<std::setw(4)<<count<<" renderables: "
+                 <<std::setw(6)<<calls / frames<<" GL calls and "
+                 <<std::fixed<<std::setprecision(1)<<duration.count() / frames<<"us per frame"<<std::endl;
+    }
+
+    exit(0);
+}
@@ -0,0 +1,555 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "load_client.h"
+#include "resource_usage.h"
+
+#include "mir/anonymous_shm_file.h"
+
+#include <wayland-client.h>
+#include "xdg-shell-client-protocol.h"
+#ifdef MIR_WAYLAND_LOAD_DMABUF
+#include "linux-dmabuf-unstable-v1-client-protocol.h"
+#include <gbm.h>
+#include <drm_fourcc.h>
+#endif
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace mb = mir::benchmark;
+namespace geom = mir::geometry;
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+/// Enough buffers for one to be on screen, one queued and one being drawn
+int const buffers_per_surface{3};
+
+struct Buffer
+{
+    wl_buffer* buffer{nullptr};
+    bool busy{false};
+};
+
+struct Surface
+{
+    wl_surface* surface{nullptr};
+    wl_subsurface* subsurface{nullptr};
+    std::vector<Buffer> buffers;
+
+    auto free_buffer() -> Buffer*
+    {
+        for (auto& buffer : buffers)
+        {
+            if (!buffer.busy)
+                return &buffer;
+        }
+        return nullptr;
+    }
+};
+}
+
+class mb::LoadClient::Self
+{
+public:
+    Self(Fd connection, LoadClientConfig const& config);
+    ~Self();
+
+    void run(int stop_fd, std::atomic<bool> const& measuring, LoadClientResults& results);
+
+private:
+    void bind_globals();
+    void create_window();
+    void create_buffers(Surface& surface, geom::Size size);
+    void create_shm_buffers(Surface& surface, geom::Size size);
+    void create_dmabuf_buffers(Surface& surface, geom::Size size);
+    void draw();
+    void frame_done();
+    void pointer_event();
+    void check_for_errors() const;
+
+    static wl_registry_listener const registry_listener;
+    static xdg_wm_base_listener const wm_base_listener;
+    static xdg_surface_listener const surface_listener;
+    static xdg_toplevel_listener const toplevel_listener;
+    static wl_buffer_listener const buffer_listener;
+    static wl_callback_listener const frame_listener;
+    static wl_seat_listener const seat_listener;
+    static wl_pointer_listener const pointer_listener;
+
+    LoadClientConfig const config;
+    wl_display* const display;
+    wl_registry* registry{nullptr};
+    wl_compositor* compositor{nullptr};
+    wl_subcompositor* subcompositor{nullptr};
+    wl_shm* shm{nullptr};
+    xdg_wm_base* wm_base{nullptr};
+    wl_seat* seat{nullptr};
+    wl_pointer* pointer{nullptr};
+#ifdef MIR_WAYLAND_LOAD_DMABUF
+    zwp_linux_dmabuf_v1* dmabuf{nullptr};
+    Fd render_node;
+    gbm_device* gbm{nullptr};
+    std::vector<gbm_bo*> bos;
+#endif
+
+    std::vector<std::unique_ptr<AnonymousShmFile>> shm_files;
+    Surface toplevel;
+    std::vector<Surface> subsurfaces;
+    xdg_surface* window_surface{nullptr};
+    xdg_toplevel* window{nullptr};
+    BufferType buffer_type_used{BufferType::shm};
+
+    bool configured{false};
+    bool draw_pending{false};
+    wl_callback* frame_callback{nullptr};
+    Clock::time_point committed_at;
+
+    std::atomic<bool> const* measuring{nullptr};
+    LoadClientResults* results{nullptr};
+};
+
+wl_registry_listener const mb::LoadClient::Self::registry_listener{
+    [](void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t version)
+    {
+        auto const self = static_cast<Self*>(data);
+
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+        {
+            self->compositor = static_cast<wl_compositor*>(
+                wl_registry_bind(registry, id, &wl_compositor_interface, std::min(version, 4u)));
+        }
+        else if (strcmp(interface, wl_subcompositor_interface.name) == 0)
+        {
+            self->subcompositor = static_cast<wl_subcompositor*>(
+                wl_registry_bind(registry, id, &wl_subcompositor_interface, 1));
+        }
+        else if (strcmp(interface, wl_shm_interface.name) == 0)
+        {
+            self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+        }
+        else if (strcmp(interface, xdg_wm_base_interface.name) == 0)
+        {
+            self->wm_base = static_cast<xdg_wm_base*>(wl_registry_bind(registry, id, &xdg_wm_base_interface, 1));
+            xdg_wm_base_add_listener(self->wm_base, &wm_base_listener, self);
+        }
+        else if (strcmp(interface, wl_seat_interface.name) == 0)
+        {
+            self->seat = static_cast<wl_seat*>(
+                wl_registry_bind(registry, id, &wl_seat_interface, std::min(version, 5u)));
+            wl_seat_add_listener(self->seat, &seat_listener, self);
+        }
+#ifdef MIR_WAYLAND_LOAD_DMABUF
+        else if (strcmp(interface, zwp_linux_dmabuf_v1_interface.name) == 0 && version >= 2)
+        {
+            self->dmabuf = static_cast<zwp_linux_dmabuf_v1*>(
+                wl_registry_bind(registry, id, &zwp_linux_dmabuf_v1_interface, 2));
+        }
+#endif
+    },
+    [](void*, wl_registry*, uint32_t) {}
+};
+
+wl_buffer_listener const mb::LoadClient::Self::buffer_listener{
+    [](void* data, wl_buffer*)
+    {
+        auto const buffer = static_cast<Buffer*>(data);
+        buffer->busy = false;
+    }
+};
+
+wl_callback_listener const mb::LoadClient::Self::frame_listener{
+    [](void* data, wl_callback* callback, uint32_t)
+    {
+        auto const self = static_cast<Self*>(data);
+        wl_callback_destroy(callback);
+        self->frame_callback = nullptr;
+        self->frame_done();
+    }
+};
+
+xdg_wm_base_listener const mb::LoadClient::Self::wm_base_listener{
+    [](void*, xdg_wm_base* wm_base, uint32_t serial) { xdg_wm_base_pong(wm_base, serial); }
+};
+
+xdg_surface_listener const mb::LoadClient::Self::surface_listener{
+    [](void* data, xdg_surface* surface, uint32_t serial)
+    {
+        auto const self = static_cast<Self*>(data);
+        xdg_surface_ack_configure(surface, serial);
+        if (!self->configured)
+        {
+            self->configured = true;
+            self->draw();
+        }
+    }
+};
+
+xdg_toplevel_listener const mb::LoadClient::Self::toplevel_listener{
+    // We keep our own size whatever is suggested, so the load is the same for every client
+    [](void*, xdg_toplevel*, int32_t, int32_t, wl_array*) {},
+    [](void*, xdg_toplevel*) {}
+};
+
+wl_seat_listener const mb::LoadClient::Self::seat_listener{
+    [](void* data, wl_seat* seat, uint32_t capabilities)
+    {
+        auto const self = static_cast<Self*>(data);
+        if ((capabilities & WL_SEAT_CAPABILITY_POINTER) && !self->pointer)
+        {
+            self->pointer = wl_seat_get_pointer(seat);
+            wl_pointer_add_listener(self->pointer, &pointer_listener, self);
+        }
+    },
+    [](void*, wl_seat*, char const*) {}
+};
+
+// Built field by field: newer libwayland appends events for versions we never bind
+wl_pointer_listener const mb::LoadClient::Self::pointer_listener = []
+    {
+        wl_pointer_listener listener{};
+        listener.enter = [](void* data, wl_pointer*, uint32_t, wl_surface*, wl_fixed_t, wl_fixed_t)
+            { static_cast<Self*>(data)->pointer_event(); };
+        listener.leave = [](void* data, wl_pointer*, uint32_t, wl_surface*)
+            { static_cast<Self*>(data)->pointer_event(); };
+        listener.motion = [](void* data, wl_pointer*, uint32_t, wl_fixed_t, wl_fixed_t)
+            { static_cast<Self*>(data)->pointer_event(); };
+        listener.button = [](void* data, wl_pointer*, uint32_t, uint32_t, uint32_t, uint32_t)
+            { static_cast<Self*>(data)->pointer_event(); };
+        listener.axis = [](void* data, wl_pointer*, uint32_t, uint32_t, wl_fixed_t)
+            { static_cast<Self*>(data)->pointer_event(); };
+        listener.frame = [](void*, wl_pointer*) {};
+        listener.axis_source = [](void*, wl_pointer*, uint32_t) {};
+        listener.axis_stop = [](void*, wl_pointer*, uint32_t, uint32_t) {};
+        listener.axis_discrete = [](void*, wl_pointer*, uint32_t, int32_t) {};
+        return listener;
+    }();
+
+mb::LoadClient::Self::Self(Fd connection, LoadClientConfig const& config)
+    : config{config},
+      display{wl_display_connect_to_fd(dup(connection))}
+{
+    if (!display)
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Failed to connect to Wayland server"}));
+}
+
+mb::LoadClient::Self::~Self()
+{
+    if (frame_callback)
+        wl_callback_destroy(frame_callback);
+    for (auto const& buffer : toplevel.buffers)
+        wl_buffer_destroy(buffer.buffer);
+    for (auto& surface : subsurfaces)
+    {
+        for (auto const& buffer : surface.buffers)
+            wl_buffer_destroy(buffer.buffer);
+        wl_subsurface_destroy(surface.subsurface);
+        wl_surface_destroy(surface.surface);
+    }
+    if (window)
+        xdg_toplevel_destroy(window);
+    if (window_surface)
+        xdg_surface_destroy(window_surface);
+    if (toplevel.surface)
+        wl_surface_destroy(toplevel.surface);
+#ifdef MIR_WAYLAND_LOAD_DMABUF
+    for (auto const bo : bos)
+        gbm_bo_destroy(bo);
+    if (gbm)
+        gbm_device_destroy(gbm);
+#endif
+    wl_display_disconnect(display);
+}
+
+void mb::LoadClient::Self::run(int stop_fd, std::atomic<bool> const& measuring, LoadClientResults& results)
+{
+    this->measuring = &measuring;
+    this->results = &results;
+
+    bind_globals();
+    create_window();
+    results.buffer_type_used = buffer_type_used;
+
+    for (;;)
+    {
+        while (wl_display_prepare_read(display) != 0)
+            wl_display_dispatch_pending(display);
+
+        if (wl_display_flush(display) < 0 && errno != EAGAIN)
+            check_for_errors();
+
+        pollfd fds[2] = {{wl_display_get_fd(display), POLLIN, 0}, {stop_fd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0)
+        {
+            wl_display_cancel_read(display);
+            if (errno == EINTR)
+                continue;
+            BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to poll"}));
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            if (wl_display_read_events(display) < 0)
+                check_for_errors();
+        }
+        else
+        {
+            wl_display_cancel_read(display);
+        }
+
+        if (wl_display_dispatch_pending(display) < 0)
+            check_for_errors();
+
+        // Waiting on a wl_buffer.release, which may just have arrived
+        if (draw_pending)
+            draw();
+
+        if (fds[1].revents & POLLIN)
+            break;
+    }
+}
+
+void mb::LoadClient::Self::bind_globals()
+{
+    registry = wl_display_get_registry(display);
+    wl_registry_add_listener(registry, &registry_listener, this);
+    wl_display_roundtrip(display);
+    check_for_errors();
+
+    if (!compositor || !shm || !wm_base || (config.subsurfaces > 0 && !subcompositor))
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Server is missing a required global"}));
+
+#ifdef MIR_WAYLAND_LOAD_DMABUF
+    if (config.buffer_type == BufferType::dmabuf && dmabuf)
+    {
+        render_node = Fd{open("/dev/dri/renderD128", O_RDWR | O_CLOEXEC)};
+        if (render_node != Fd::invalid)
+            gbm = gbm_create_device(render_node);
+        if (gbm)
+            buffer_type_used = BufferType::dmabuf;
+    }
+#endif
+}
+
+void mb::LoadClient::Self::create_window()
+{
+    toplevel.surface = wl_compositor_create_surface(compositor);
+    window_surface = xdg_wm_base_get_xdg_surface(wm_base, toplevel.surface);
+    xdg_surface_add_listener(window_surface, &surface_listener, this);
+    window = xdg_surface_get_toplevel(window_surface);
+    xdg_toplevel_add_listener(window, &toplevel_listener, this);
+    xdg_toplevel_set_title(window, "wayland-load");
+    create_buffers(toplevel, config.size);
+
+    // Subsurfaces are a quarter of the window, cascaded over it, and stay in (the default)
+    // synchronized mode so their state is applied by the parent's commit
+    geom::Size const subsurface_size{config.size.width.as_int() / 2, config.size.height.as_int() / 2};
+    subsurfaces.resize(config.subsurfaces);
+    int offset{0};
+    for (auto& surface : subsurfaces)
+    {
+        surface.surface = wl_compositor_create_surface(compositor);
+        surface.subsurface = wl_subcompositor_get_subsurface(subcompositor, surface.surface, toplevel.surface);
+        wl_subsurface_set_position(surface.subsurface, offset, offset);
+        offset = (offset + 8) % (config.size.height.as_int() / 2);
+        create_buffers(surface, subsurface_size);
+    }
+
+    wl_surface_commit(toplevel.surface);
+}
+
+void mb::LoadClient::Self::create_buffers(Surface& surface, geom::Size size)
+{
+    surface.buffers.resize(buffers_per_surface);
+#ifdef MIR_WAYLAND_LOAD_DMABUF
+    if (buffer_type_used == BufferType::dmabuf)
+    {
+        create_dmabuf_buffers(surface, size);
+        return;
+    }
+#endif
+    create_shm_buffers(surface, size);
+}
+
+void mb::LoadClient::Self::create_shm_buffers(Surface& surface, geom::Size size)
+{
+    auto const stride = size.width.as_int() * 4;
+    auto const buffer_bytes = stride * size.height.as_int();
+
+    shm_files.push_back(std::make_unique<AnonymousShmFile>(buffer_bytes * surface.buffers.size()));
+    auto const& file = *shm_files.back();
+
+    // Translucent, so no surface occludes another and every client keeps getting frames.
+    // The content never changes: what we're loading is the server's buffer handling, not its blending
+    std::fill_n(static_cast<uint32_t*>(file.base_ptr()), buffer_bytes * surface.buffers.size() / 4, 0x80406080);
+
+    auto const pool = wl_shm_create_pool(shm, file.fd(), buffer_bytes * surface.buffers.size());
+    int offset{0};
+    for (auto& buffer : surface.buffers)
+    {
+        buffer.buffer = wl_shm_pool_create_buffer(
+            pool, offset, size.width.as_int(), size.height.as_int(), stride, WL_SHM_FORMAT_ARGB8888);
+        wl_buffer_add_listener(buffer.buffer, &buffer_listener, &buffer);
+        offset += buffer_bytes;
+    }
+    wl_shm_pool_destroy(pool);
+}
+
+void mb::LoadClient::Self::create_dmabuf_buffers(Surface& surface, geom::Size size)
+{
+#ifdef MIR_WAYLAND_LOAD_DMABUF
+    for (auto& buffer : surface.buffers)
+    {
+        auto const bo = gbm_bo_create(
+            gbm, size.width.as_uint32_t(), size.height.as_uint32_t(), GBM_FORMAT_ARGB8888, GBM_BO_USE_RENDERING);
+        if (!bo)
+            BOOST_THROW_EXCEPTION((std::runtime_error{"Failed to allocate GBM buffer"}));
+        bos.push_back(bo);
+
+        Fd const fd{gbm_bo_get_fd(bo)};
+        auto const params = zwp_linux_dmabuf_v1_create_params(dmabuf);
+        // An invalid modifier leaves the layout to the driver's implicit choice, as gbm_bo_create() did
+        zwp_linux_buffer_params_v1_add(
+            params, fd, 0, 0, gbm_bo_get_stride(bo),
+            DRM_FORMAT_MOD_INVALID >> 32, DRM_FORMAT_MOD_INVALID & 0xffffffff);
+        buffer.buffer = zwp_linux_buffer_params_v1_create_immed(
+            params, size.width.as_int(), size.height.as_int(), DRM_FORMAT_ARGB8888, 0);
+        zwp_linux_buffer_params_v1_destroy(params);
+        wl_buffer_add_listener(buffer.buffer, &buffer_listener, &buffer);
+    }
+#else
+    (void)surface;
+    (void)size;
+#endif
+}
+
+void mb::LoadClient::Self::draw()
+{
+    auto const main_buffer = toplevel.free_buffer();
+    if (!main_buffer)
+    {
+        // The compositor still holds all our buffers; a release will come round to draw again
+        draw_pending = true;
+        return;
+    }
+    draw_pending = false;
+
+    for (auto& surface : subsurfaces)
+    {
+        // If a subsurface has no free buffer it just keeps its current content this frame
+        if (auto const buffer = surface.free_buffer())
+        {
+            buffer->busy = true;
+            wl_surface_attach(surface.surface, buffer->buffer, 0, 0);
+            wl_surface_damage(surface.surface, 0, 0, INT32_MAX, INT32_MAX);
+            wl_surface_commit(surface.surface);
+        }
+    }
+
+    main_buffer->busy = true;
+    wl_surface_attach(toplevel.surface, main_buffer->buffer, 0, 0);
+    wl_surface_damage(toplevel.surface, 0, 0, INT32_MAX, INT32_MAX);
+    frame_callback = wl_surface_frame(toplevel.surface);
+    wl_callback_add_listener(frame_callback, &frame_listener, this);
+    committed_at = Clock::now();
+    wl_surface_commit(toplevel.surface);
+}
+
+void mb::LoadClient::Self::frame_done()
+{
+    if (*measuring)
+    {
+        ++results->frames;
+        results->commit_to_frame_latencies.push_back(Clock::now() - committed_at);
+    }
+    draw();
+}
+
+void mb::LoadClient::Self::pointer_event()
+{
+    if (*measuring)
+        ++results->pointer_events;
+}
+
+void mb::LoadClient::Self::check_for_errors() const
+{
+    if (auto const error = wl_display_get_error(display))
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{error, std::system_category(), "Wayland connection failed"}));
+    }
+}
+
+mb::LoadClient::LoadClient(Fd connection, LoadClientConfig const& config)
+    : self{std::make_unique<Self>(connection, config)},
+      stop_event{eventfd(0, EFD_CLOEXEC)},
+      thread{[this]()
+          {
+              mark_load_generator_thread();
+              try
+              {
+                  self->run(stop_event, measuring, results);
+              }
+              catch (std::exception const& error)
+              {
+                  results.error = error.what();
+              }
+          }}
+{
+}
+
+mb::LoadClient::~LoadClient()
+{
+    if (thread.joinable())
+        stop();
+}
+
+void mb::LoadClient::start_measuring()
+{
+    measuring = true;
+}
+
+void mb::LoadClient::stop_measuring()
+{
+    measuring = false;
+}
+
+auto mb::LoadClient::stop() -> LoadClientResults
+{
+    measuring = false;
+
+    uint64_t const wake{1};
+    if (write(stop_event, &wake, sizeof wake) != sizeof wake)
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to stop load client"}));
+
+    thread.join();
+    return results;
+}
+
+auto mb::LoadClient::native_handle() -> std::thread::native_handle_type
+{
+    return thread.native_handle();
+}
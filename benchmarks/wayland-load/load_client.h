@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARKS_WAYLAND_LOAD_CLIENT_H_
+#define MIR_BENCHMARKS_WAYLAND_LOAD_CLIENT_H_
+
+#include "mir/fd.h"
+#include "mir/geometry/size.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mir
+{
+namespace benchmark
+{
+enum class BufferType
+{
+    shm,
+    dmabuf
+};
+
+struct LoadClientConfig
+{
+    BufferType buffer_type;
+    geometry::Size size;
+    int subsurfaces;
+};
+
+struct LoadClientResults
+{
+    uint64_t frames{0};
+    /// Time from wl_surface.commit to the frame callback's done event, for each frame
+    std::vector<std::chrono::nanoseconds> commit_to_frame_latencies;
+    uint64_t pointer_events{0};
+    /// dmabuf may have been requested but be unavailable, in which case SHM is used
+    BufferType buffer_type_used{BufferType::shm};
+    std::string error;
+};
+
+/**
+ * A synthetic Wayland client that redraws an xdg_toplevel (and optionally
+ * some subsurfaces) as fast as its frame callbacks allow.
+ *
+ * The client runs its own event loop on its own thread. It only records
+ * results between start_measuring() and stop_measuring().
+ */
+class LoadClient
+{
+public:
+    LoadClient(Fd connection, LoadClientConfig const& config);
+    ~LoadClient();
+
+    void start_measuring();
+    void stop_measuring();
+
+    /// Stop the client and collect what it recorded while measuring
+    auto stop() -> LoadClientResults;
+
+    /// The client thread, so its CPU time can be separated from the server's
+    auto native_handle() -> std::thread::native_handle_type;
+
+private:
+    class Self;
+    std::unique_ptr<Self> const self;
+    Fd const stop_event;
+    std::atomic<bool> measuring{false};
+    LoadClientResults results;
+    std::thread thread;
+};
+}
+}
+
+#endif // MIR_BENCHMARKS_WAYLAND_LOAD_CLIENT_H_
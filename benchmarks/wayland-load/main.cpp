@@ -0,0 +1,367 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "load_client.h"
+#include "resource_usage.h"
+
+#include "miral/test_display_server.h"
+#include "mir_test_framework/executable_path.h"
+#include "mir_test_framework/fake_input_device.h"
+#include "mir_test_framework/stub_server_platform_factory.h"
+#include "mir/test/event_factory.h"
+#include "mir/compositor/display_buffer_compositor_factory.h"
+#include "mir/input/input_device_info.h"
+#include "mir/server.h"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace mb = mir::benchmark;
+namespace mtf = mir_test_framework;
+namespace mi = mir::input;
+namespace mis = mir::input::synthesis;
+namespace po = boost::program_options;
+namespace geom = mir::geometry;
+
+namespace
+{
+struct Options
+{
+    std::string platform;
+    int clients;
+    mb::BufferType buffer_type;
+    int subsurfaces;
+    geom::Size window_size;
+    int pointer_rate;
+    std::chrono::duration<double> warmup;
+    std::chrono::duration<double> duration;
+    std::string output;
+};
+
+auto parse_options(int argc, char const* argv[], Options& options) -> bool
+{
+    std::string buffer_type;
+    int width, height;
+    double warmup, duration;
+
+    po::options_description description{"Options"};
+    description.add_options()
+        ("help", "Show this help")
+        ("platform", po::value(&options.platform)->default_value("stub"),
+            "Server graphics platform: \"stub\" (no GPU) or \"offscreen\" (gbm-kms without outputs)")
+        ("clients", po::value(&options.clients)->default_value(8), "Number of synthetic clients")
+        ("buffer-type", po::value(&buffer_type)->default_value("shm"), "Client buffers: \"shm\" or \"dmabuf\"")
+        ("subsurfaces", po::value(&options.subsurfaces)->default_value(0), "Subsurfaces per client window")
+        ("width", po::value(&width)->default_value(256), "Client window width")
+        ("height", po::value(&height)->default_value(256), "Client window height")
+        ("pointer-rate", po::value(&options.pointer_rate)->default_value(125),
+            "Synthetic pointer motion events per second (0 to disable)")
+        ("warmup", po::value(&warmup)->default_value(2), "Seconds to run before measuring")
+        ("duration", po::value(&duration)->default_value(10), "Seconds to measure for")
+        ("output", po::value(&options.output), "File for the JSON results (default: stdout)");
+
+    po::variables_map values;
+    po::store(po::parse_command_line(argc, argv, description), values);
+    po::notify(values);
+
+    if (values.count("help"))
+    {
+        std::cout << description << std::endl;
+        return false;
+    }
+
+    if (options.platform != "stub" && options.platform != "offscreen")
+        throw std::invalid_argument{"Unknown platform: " + options.platform};
+
+    if (buffer_type == "shm")
+        options.buffer_type = mb::BufferType::shm;
+    else if (buffer_type == "dmabuf")
+        options.buffer_type = mb::BufferType::dmabuf;
+    else
+        throw std::invalid_argument{"Unknown buffer type: " + buffer_type};
+
+    if (options.clients < 1 || options.subsurfaces < 0 || width < 2 || height < 2 || duration <= 0)
+        throw std::invalid_argument{"Invalid benchmark parameters"};
+
+    options.window_size = geom::Size{width, height};
+    options.warmup = std::chrono::duration<double>{warmup};
+    options.duration = std::chrono::duration<double>{duration};
+    return true;
+}
+
+auto to_string(mb::BufferType type) -> char const*
+{
+    return type == mb::BufferType::dmabuf ? "dmabuf" : "shm";
+}
+
+/// Nearest-rank percentile of sorted samples, in milliseconds
+auto percentile_ms(std::vector<std::chrono::nanoseconds> const& sorted, double percent) -> double
+{
+    if (sorted.empty())
+        return 0;
+
+    auto const rank = static_cast<size_t>(std::ceil(percent / 100 * sorted.size()));
+    auto const index = std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0);
+    return std::chrono::duration<double, std::milli>{sorted[index]}.count();
+}
+
+/// text as a JSON string literal, quotes included
+auto json_string(std::string const& text) -> std::string
+{
+    std::ostringstream result;
+    result << '"';
+    for (unsigned char const c : text)
+    {
+        switch (c)
+        {
+        case '"':  result << "\\\""; break;
+        case '\\': result << "\\\\"; break;
+        case '\b': result << "\\b"; break;
+        case '\f': result << "\\f"; break;
+        case '\n': result << "\\n"; break;
+        case '\r': result << "\\r"; break;
+        case '\t': result << "\\t"; break;
+        default:
+            if (c < 0x20)
+                result << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int{c} << std::dec;
+            else
+                result << c;
+        }
+    }
+    result << '"';
+    return result.str();
+}
+
+/// Sweeps the cursor back and forth across the outputs so it crosses the client windows
+class PointerInjector
+{
+public:
+    PointerInjector(int rate)
+        : device{mtf::add_fake_input_device(
+              mi::InputDeviceInfo{"load-pointer", "load-pointer-uid", mi::DeviceCapability::pointer})},
+          thread{[this, period = std::chrono::duration<double>{1.0 / rate}]()
+              {
+                  mb::mark_load_generator_thread();
+                  int step{0};
+                  while (!stopping)
+                  {
+                      int const dx = (step++ / 256) % 2 ? -8 : 8;
+                      device->emit_event(mis::a_pointer_event().with_movement(dx, dx / 2));
+                      std::this_thread::sleep_for(period);
+                  }
+              }}
+    {
+    }
+
+    ~PointerInjector()
+    {
+        stopping = true;
+        thread.join();
+    }
+
+    auto native_handle() -> std::thread::native_handle_type { return thread.native_handle(); }
+
+private:
+    mir::UniqueModulePtr<mtf::FakeInputDevice> const device;
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
+
+struct Sample
+{
+    std::chrono::steady_clock::time_point time;
+    std::chrono::nanoseconds process_cpu;
+    std::chrono::nanoseconds load_generator_cpu;
+    uint64_t allocations;
+};
+
+auto take_sample(
+    std::vector<std::unique_ptr<mb::LoadClient>> const& clients,
+    PointerInjector* injector) -> Sample
+{
+    std::chrono::nanoseconds load_generator_cpu{mb::thread_cpu_time(pthread_self())};
+    for (auto const& client : clients)
+        load_generator_cpu += mb::thread_cpu_time(client->native_handle());
+    if (injector)
+        load_generator_cpu += mb::thread_cpu_time(injector->native_handle());
+
+    return Sample{
+        std::chrono::steady_clock::now(),
+        mb::process_cpu_time(),
+        load_generator_cpu,
+        mb::server_allocations()};
+}
+
+void write_results(
+    std::ostream& out,
+    Options const& options,
+    Sample const& start,
+    Sample const& end,
+    std::vector<mb::LoadClientResults> const& results)
+{
+    std::chrono::duration<double> const elapsed = end.time - start.time;
+
+    uint64_t frames{0};
+    uint64_t pointer_events{0};
+    std::vector<std::chrono::nanoseconds> latencies;
+    std::vector<double> client_fps;
+    std::vector<std::string> errors;
+    auto buffer_type_used = options.buffer_type;
+    for (auto const& result : results)
+    {
+        frames += result.frames;
+        pointer_events += result.pointer_events;
+        latencies.insert(
+            latencies.end(), result.commit_to_frame_latencies.begin(), result.commit_to_frame_latencies.end());
+        client_fps.push_back(result.frames / elapsed.count());
+        if (!result.error.empty())
+            errors.push_back(result.error);
+        if (result.buffer_type_used != options.buffer_type)
+            buffer_type_used = result.buffer_type_used;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::chrono::duration<double> const server_cpu =
+        (end.process_cpu - start.process_cpu) - (end.load_generator_cpu - start.load_generator_cpu);
+    auto const memory = mb::memory_usage();
+    auto const allocations = end.allocations - start.allocations;
+
+    out << std::fixed << std::setprecision(3)
+        << "{\n"
+        << "  \"benchmark\": \"mir_wayland_load\",\n"
+        << "  \"config\": {\n"
+        << "    \"platform\": " << json_string(options.platform) << ",\n"
+        << "    \"clients\": " << options.clients << ",\n"
+        << "    \"buffer_type\": \"" << to_string(options.buffer_type) << "\",\n"
+        << "    \"buffer_type_used\": \"" << to_string(buffer_type_used) << "\",\n"
+        << "    \"subsurfaces\": " << options.subsurfaces << ",\n"
+        << "    \"window_width\": " << options.window_size.width.as_int() << ",\n"
+        << "    \"window_height\": " << options.window_size.height.as_int() << ",\n"
+        << "    \"pointer_rate\": " << options.pointer_rate << ",\n"
+        << "    \"duration_s\": " << elapsed.count() << "\n"
+        << "  },\n"
+        << "  \"results\": {\n"
+        << "    \"frames\": " << frames << ",\n"
+        << "    \"fps\": " << frames / elapsed.count() << ",\n"
+        << "    \"client_fps_min\": " << *std::min_element(client_fps.begin(), client_fps.end()) << ",\n"
+        << "    \"client_fps_max\": " << *std::max_element(client_fps.begin(), client_fps.end()) << ",\n"
+        << "    \"commit_to_frame_ms_p50\": " << percentile_ms(latencies, 50) << ",\n"
+        << "    \"commit_to_frame_ms_p99\": " << percentile_ms(latencies, 99) << ",\n"
+        << "    \"commit_to_frame_ms_max\": " << percentile_ms(latencies, 100) << ",\n"
+        << "    \"server_cpu_percent\": " << 100 * server_cpu.count() / elapsed.count() << ",\n"
+        << "    \"rss_kib\": " << memory.rss_kib << ",\n"
+        << "    \"peak_rss_kib\": " << memory.peak_rss_kib << ",\n"
+        << "    \"server_allocations\": " << allocations << ",\n"
+        << "    \"allocations_per_frame\": " << (frames ? double(allocations) / frames : 0.0) << ",\n"
+        << "    \"pointer_events\": " << pointer_events << "\n"
+        << "  },\n"
+        << "  \"errors\": [";
+    for (auto i = 0u; i != errors.size(); ++i)
+    {
+        // Error messages come from exceptions, and may hold anything
+        out << (i ? ", " : "") << json_string(errors[i]);
+    }
+    out << "]\n}" << std::endl;
+}
+}
+
+int main(int argc, char const* argv[])
+try
+{
+    mb::mark_load_generator_thread();
+
+    Options options;
+    if (!parse_options(argc, argv, options))
+        return EXIT_SUCCESS;
+
+    char const* offscreen_argv[] = {argv[0], "--offscreen"};
+    auto const offscreen = options.platform == "offscreen";
+    miral::TestDisplayServer server{offscreen ? 2 : 1, offscreen_argv};
+
+    mir::Server* mir_server{nullptr};
+    if (offscreen)
+    {
+        server.add_to_environment(
+            "MIR_SERVER_PLATFORM_GRAPHICS_LIB",
+            mtf::server_platform("graphics-gbm-kms").c_str());
+    }
+    server.add_server_init([&](mir::Server& init_server)
+        {
+            mir_server = &init_server;
+            if (offscreen)
+            {
+                // Replace the test framework's headless compositor with the real one
+                init_server.override_the_display_buffer_compositor_factory(
+                    []{ return std::shared_ptr<mir::compositor::DisplayBufferCompositorFactory>{}; });
+            }
+        });
+    server.start_server();
+
+    std::unique_ptr<PointerInjector> injector;
+    if (options.pointer_rate > 0)
+        injector = std::make_unique<PointerInjector>(options.pointer_rate);
+
+    mb::LoadClientConfig const client_config{options.buffer_type, options.window_size, options.subsurfaces};
+    std::vector<std::unique_ptr<mb::LoadClient>> clients;
+    for (int i = 0; i != options.clients; ++i)
+        clients.push_back(std::make_unique<mb::LoadClient>(mir_server->open_wayland_client_socket(), client_config));
+
+    std::this_thread::sleep_for(options.warmup);
+
+    auto const start = take_sample(clients, injector.get());
+    for (auto const& client : clients)
+        client->start_measuring();
+
+    std::this_thread::sleep_for(options.duration);
+
+    for (auto const& client : clients)
+        client->stop_measuring();
+    // Thread CPU clocks are only valid until the threads are joined
+    auto const end = take_sample(clients, injector.get());
+    std::vector<mb::LoadClientResults> results;
+    for (auto const& client : clients)
+        results.push_back(client->stop());
+
+    if (options.output.empty())
+    {
+        write_results(std::cout, options, start, end, results);
+    }
+    else
+    {
+        std::ofstream out{options.output};
+        write_results(out, options, start, end, results);
+    }
+
+    clients.clear();
+    injector.reset();
+    server.stop_server();
+
+    auto const failed = std::any_of(results.begin(), results.end(), [](auto const& r) { return !r.error.empty(); });
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "mir_wayland_load_benchmark: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resource_usage.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <string>
+#include <system_error>
+
+#include <sys/resource.h>
+#include <time.h>
+
+namespace mb = mir::benchmark;
+
+namespace
+{
+std::atomic<uint64_t> allocations{0};
+thread_local bool is_load_generator_thread{false};
+
+void* counted_allocation(std::size_t size) noexcept
+{
+    if (!is_load_generator_thread)
+        allocations.fetch_add(1, std::memory_order_relaxed);
+
+    return std::malloc(size ? size : 1);
+}
+
+auto to_nanoseconds(timeval const& time) -> std::chrono::nanoseconds
+{
+    return std::chrono::seconds{time.tv_sec} + std::chrono::microseconds{time.tv_usec};
+}
+}
+
+// Replacing the global allocation functions here counts allocations made anywhere in
+// the process, including by the server's shared libraries
+void* operator new(std::size_t size)
+{
+    if (auto const result = counted_allocation(size))
+        return result;
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+    return counted_allocation(size);
+}
+
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept
+{
+    return counted_allocation(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void mb::mark_load_generator_thread()
+{
+    is_load_generator_thread = true;
+}
+
+auto mb::server_allocations() -> uint64_t
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+auto mb::process_cpu_time() -> std::chrono::nanoseconds
+{
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to get process CPU time"}));
+
+    return to_nanoseconds(usage.ru_utime) + to_nanoseconds(usage.ru_stime);
+}
+
+auto mb::thread_cpu_time(pthread_t thread) -> std::chrono::nanoseconds
+{
+    clockid_t clock;
+    if (auto const error = pthread_getcpuclockid(thread, &clock))
+        BOOST_THROW_EXCEPTION((std::system_error{error, std::system_category(), "Failed to get thread CPU clock"}));
+
+    timespec time;
+    if (clock_gettime(clock, &time) != 0)
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to get thread CPU time"}));
+
+    return std::chrono::seconds{time.tv_sec} + std::chrono::nanoseconds{time.tv_nsec};
+}
+
+auto mb::memory_usage() -> MemoryUsage
+{
+    MemoryUsage result{0, 0};
+
+    std::ifstream status{"/proc/self/status"};
+    std::string key;
+    while (status >> key)
+    {
+        if (key == "VmRSS:")
+            status >> result.rss_kib;
+        else if (key == "VmHWM:")
+            status >> result.peak_rss_kib;
+        status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+
+    return result;
+}
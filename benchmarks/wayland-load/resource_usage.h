@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARKS_WAYLAND_LOAD_RESOURCE_USAGE_H_
+#define MIR_BENCHMARKS_WAYLAND_LOAD_RESOURCE_USAGE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <pthread.h>
+
+namespace mir
+{
+namespace benchmark
+{
+/**
+ * Exclude the calling thread's allocations from server_allocations().
+ *
+ * The server and the load generator share a process; every thread the
+ * benchmark itself starts calls this so that what remains is the server.
+ */
+void mark_load_generator_thread();
+
+/// Allocations (through operator new) made by threads other than the load generator's
+auto server_allocations() -> uint64_t;
+
+/// CPU time (user and system) consumed by the whole process
+auto process_cpu_time() -> std::chrono::nanoseconds;
+
+/// CPU time consumed by one thread of this process
+auto thread_cpu_time(pthread_t thread) -> std::chrono::nanoseconds;
+
+struct MemoryUsage
+{
+    uint64_t rss_kib;
+    uint64_t peak_rss_kib;
+};
+
+auto memory_usage() -> MemoryUsage;
+}
+}
+
+#endif // MIR_BENCHMARKS_WAYLAND_LOAD_RESOURCE_USAGE_H_
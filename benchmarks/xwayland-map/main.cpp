@@ -0,0 +1,294 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "miral/test_display_server.h"
+#include "miral/x11_support.h"
+#include "miral/application_info.h"
+#include "mir_test_framework/executable_path.h"
+#include "mir/compositor/display_buffer_compositor_factory.h"
+#include "mir/server.h"
+
+#include <boost/program_options.hpp>
+
+#include <xcb/xcb.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <time.h>
+
+namespace mtf = mir_test_framework;
+namespace po = boost::program_options;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+struct Options
+{
+    std::string platform;
+    std::string xwayland_path;
+    int windows;
+    std::chrono::duration<double> timeout;
+    std::string output;
+};
+
+auto parse_options(int argc, char const* argv[], Options& options) -> bool
+{
+    double timeout;
+
+    po::options_description description{"Options"};
+    description.add_options()
+        ("help", "Show this help")
+        ("platform", po::value(&options.platform)->default_value("offscreen"),
+            "Server graphics platform: \"offscreen\" (gbm-kms without outputs) or \"stub\" (no GPU)")
+        ("xwayland-path", po::value(&options.xwayland_path)->default_value("/usr/bin/Xwayland"),
+            "Path to the Xwayland executable")
+        ("windows", po::value(&options.windows)->default_value(500), "Number of X11 windows to map")
+        ("timeout", po::value(&timeout)->default_value(60), "Seconds to wait for the windows to appear")
+        ("output", po::value(&options.output), "File for the JSON results (default: stdout)");
+
+    po::variables_map values;
+    po::store(po::parse_command_line(argc, argv, description), values);
+    po::notify(values);
+
+    if (values.count("help"))
+    {
+        std::cout << description << std::endl;
+        return false;
+    }
+
+    if (options.platform != "stub" && options.platform != "offscreen")
+        throw std::invalid_argument{"Unknown platform: " + options.platform};
+
+    if (options.windows < 1 || timeout <= 0)
+        throw std::invalid_argument{"Invalid benchmark parameters"};
+
+    options.timeout = std::chrono::duration<double>{timeout};
+    return true;
+}
+
+auto cpu_time(clockid_t clock) -> std::chrono::nanoseconds
+{
+    timespec time;
+    clock_gettime(clock, &time);
+    return std::chrono::seconds{time.tv_sec} + std::chrono::nanoseconds{time.tv_nsec};
+}
+
+/// Nearest-rank percentile of sorted samples, in milliseconds
+auto percentile_ms(std::vector<std::chrono::nanoseconds> const& sorted, double percent) -> double
+{
+    if (sorted.empty())
+        return 0;
+
+    auto const rank = static_cast<size_t>(std::ceil(percent / 100 * sorted.size()));
+    auto const index = std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0);
+    return std::chrono::duration<double, std::milli>{sorted[index]}.count();
+}
+
+auto as_ms(std::chrono::steady_clock::duration duration) -> double
+{
+    return std::chrono::duration<double, std::milli>{duration}.count();
+}
+
+auto count_server_windows(miral::TestDisplayServer& server) -> size_t
+{
+    size_t count{0};
+    server.invoke_tools([&](miral::WindowManagerTools& tools)
+        {
+            tools.for_each_application([&](miral::ApplicationInfo& info) { count += info.windows().size(); });
+        });
+    return count;
+}
+
+struct Results
+{
+    std::chrono::steady_clock::duration connect;
+    std::chrono::steady_clock::duration all_mapped;
+    std::chrono::steady_clock::duration all_shown;
+    std::vector<std::chrono::nanoseconds> map_latencies;
+    std::chrono::nanoseconds server_cpu;
+    size_t windows_mapped;
+    size_t windows_shown;
+};
+
+void write_results(std::ostream& out, Options const& options, Results const& results)
+{
+    out << std::fixed << std::setprecision(3)
+        << "{\n"
+        << "  \"benchmark\": \"mir_xwayland_map\",\n"
+        << "  \"config\": {\n"
+        << "    \"platform\": \"" << options.platform << "\",\n"
+        << "    \"windows\": " << options.windows << "\n"
+        << "  },\n"
+        << "  \"results\": {\n"
+        << "    \"connect_ms\": " << as_ms(results.connect) << ",\n"
+        << "    \"windows_mapped\": " << results.windows_mapped << ",\n"
+        << "    \"windows_shown\": " << results.windows_shown << ",\n"
+        << "    \"all_mapped_ms\": " << as_ms(results.all_mapped) << ",\n"
+        << "    \"all_shown_ms\": " << as_ms(results.all_shown) << ",\n"
+        << "    \"map_ms_p50\": " << percentile_ms(results.map_latencies, 50) << ",\n"
+        << "    \"map_ms_p99\": " << percentile_ms(results.map_latencies, 99) << ",\n"
+        << "    \"map_ms_max\": " << percentile_ms(results.map_latencies, 100) << ",\n"
+        << "    \"server_cpu_ms\": " << std::chrono::duration<double, std::milli>{results.server_cpu}.count() << "\n"
+        << "  }\n"
+        << "}" << std::endl;
+}
+}
+
+int main(int argc, char const* argv[])
+try
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+        return EXIT_SUCCESS;
+
+    auto const offscreen = options.platform == "offscreen";
+    auto const xwayland_path = "--xwayland-path=" + options.xwayland_path;
+    std::vector<char const*> server_argv{argv[0], "--enable-x11", xwayland_path.c_str()};
+    if (offscreen)
+        server_argv.push_back("--offscreen");
+    miral::TestDisplayServer server{static_cast<int>(server_argv.size()), server_argv.data()};
+
+    mir::Server* mir_server{nullptr};
+    if (offscreen)
+    {
+        server.add_to_environment(
+            "MIR_SERVER_PLATFORM_GRAPHICS_LIB",
+            mtf::server_platform("graphics-gbm-kms").c_str());
+    }
+    server.add_server_init(miral::X11Support{});
+    server.add_server_init([&](mir::Server& init_server)
+        {
+            mir_server = &init_server;
+            if (offscreen)
+            {
+                // Replace the test framework's headless compositor with the real one
+                init_server.override_the_display_buffer_compositor_factory(
+                    []{ return std::shared_ptr<mir::compositor::DisplayBufferCompositorFactory>{}; });
+            }
+        });
+    server.start_server();
+
+    auto const x11_display = mir_server->x11_display();
+    if (!x11_display.is_set())
+        throw std::runtime_error{"Server did not open an X11 display"};
+
+    Results results{};
+    auto const benchmark_thread_cpu_start = cpu_time(CLOCK_THREAD_CPUTIME_ID);
+    auto const process_cpu_start = cpu_time(CLOCK_PROCESS_CPUTIME_ID);
+
+    // Connecting spawns Xwayland and starts the window manager
+    auto const connect_start = std::chrono::steady_clock::now();
+    std::unique_ptr<xcb_connection_t, decltype(&xcb_disconnect)> connection{
+        xcb_connect(x11_display.value().c_str(), nullptr),
+        &xcb_disconnect};
+    if (xcb_connection_has_error(connection.get()))
+        throw std::runtime_error{"Failed to connect to " + x11_display.value()};
+    auto const screen = xcb_setup_roots_iterator(xcb_get_setup(connection.get())).data;
+    results.connect = std::chrono::steady_clock::now() - connect_start;
+
+    std::unordered_map<xcb_window_t, std::chrono::steady_clock::time_point> map_requested;
+    uint32_t const event_mask{XCB_EVENT_MASK_STRUCTURE_NOTIFY};
+    auto const map_start = std::chrono::steady_clock::now();
+    for (int i = 0; i != options.windows; ++i)
+    {
+        auto const window = xcb_generate_id(connection.get());
+        xcb_create_window(
+            connection.get(),
+            XCB_COPY_FROM_PARENT,
+            window,
+            screen->root,
+            (i % 20) * 32, (i / 20) * 32, 64, 64, 0,
+            XCB_WINDOW_CLASS_INPUT_OUTPUT,
+            screen->root_visual,
+            XCB_CW_EVENT_MASK, &event_mask);
+        xcb_map_window(connection.get(), window);
+        map_requested[window] = std::chrono::steady_clock::now();
+    }
+    xcb_flush(connection.get());
+
+    // The window manager maps each window once it has handled the MapRequest
+    auto const deadline = map_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(options.timeout);
+    while (results.windows_mapped != map_requested.size() && std::chrono::steady_clock::now() < deadline)
+    {
+        std::unique_ptr<xcb_generic_event_t, decltype(&free)> const event{
+            xcb_poll_for_event(connection.get()),
+            &free};
+        if (!event)
+        {
+            if (xcb_connection_has_error(connection.get()))
+                throw std::runtime_error{"X11 connection lost"};
+            std::this_thread::sleep_for(100us);
+            continue;
+        }
+
+        if ((event->response_type & ~0x80) == XCB_MAP_NOTIFY)
+        {
+            auto const map = reinterpret_cast<xcb_map_notify_event_t*>(event.get());
+            auto const requested = map_requested.find(map->window);
+            if (requested != map_requested.end())
+            {
+                auto const now = std::chrono::steady_clock::now();
+                results.map_latencies.push_back(now - requested->second);
+                results.all_mapped = now - map_start;
+                ++results.windows_mapped;
+            }
+        }
+    }
+
+    // Then Xwayland creates the wl_surfaces the window manager turns into Mir windows
+    while ((results.windows_shown = count_server_windows(server)) < map_requested.size() &&
+           std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(5ms);
+    }
+    results.all_shown = std::chrono::steady_clock::now() - map_start;
+
+    results.server_cpu =
+        (cpu_time(CLOCK_PROCESS_CPUTIME_ID) - process_cpu_start) -
+        (cpu_time(CLOCK_THREAD_CPUTIME_ID) - benchmark_thread_cpu_start);
+    std::sort(results.map_latencies.begin(), results.map_latencies.end());
+
+    if (options.output.empty())
+    {
+        write_results(std::cout, options, results);
+    }
+    else
+    {
+        std::ofstream out{options.output};
+        write_results(out, options, results);
+    }
+
+    connection.reset();
+    server.stop_server();
+
+    auto const complete =
+        results.windows_mapped == map_requested.size() &&
+        results.windows_shown >= map_requested.size();
+    return complete ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "mir_xwayland_map_benchmark: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -25,6 +25,7 @@
 #include <functional>
 #include <initializer_list>
 #include <list>
+#include <memory>
 #include <mutex>
 
 #include <pthread.h>
@@ -48,6 +49,12 @@ enum class DispatchReentrancy
 
 /**
  * \brief An adaptor that combines multiple Dispatchables into a single Dispatchable
+ *
+ * Each dispatch() collects a bounded batch of ready dispatchees with a single
+ * epoll_wait(). The batch is shared: while one thread works through it the
+ * watch_fd() stays readable, so any other thread dispatching this adaptor
+ * takes the next entry rather than waiting behind a slow dispatchee.
+ *
  * \note Instances are fully thread-safe.
  */
 class MultiplexingDispatchable final : public Dispatchable
@@ -95,10 +102,17 @@ public:
      */
     void remove_watch(Fd const& fd);
 private:
+    struct Watch;
+    struct ReadyQueue;
+
+    void dispatch_ready(std::shared_ptr<Watch> const& watch, FdEvents events);
+
     PosixRWMutex lifetime_mutex;
-    std::list<std::pair<std::shared_ptr<Dispatchable>, bool>> dispatchee_holder;
+    std::list<std::shared_ptr<Watch>> dispatchee_holder;
+    int reentrant_watches{0};
 
     Fd epoll_fd;
+    std::unique_ptr<ReadyQueue> const ready;
 };
 }
 }
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Daniel van Vugt <daniel.van.vugt@canonical.com>
+ */
+
+#ifndef MIR_GRAPHICS_DIRECT_SCANOUT_H_
+#define MIR_GRAPHICS_DIRECT_SCANOUT_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/graphics/renderable.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+
+namespace mir
+{
+namespace graphics
+{
+/**
+ * Matches the renderable that, alone, makes up everything visible in an output.
+ *
+ * Use with std::find_if() over a RenderableList in reverse (top-most first): it matches
+ * the first renderable overlapping the output if that renderable is opaque, untransformed,
+ * uncropped and exactly covers the output. Anything overlapping the output beneath it is hidden.
+ */
+class ScanoutMatch
+{
+public:
+    ScanoutMatch(geometry::Rectangle const& view_area);
+    bool operator()(std::shared_ptr<Renderable> const& renderable);
+
+private:
+    geometry::Rectangle const view_area;
+    bool scanout_is_feasible;
+    glm::mat4 const identity;
+};
+
+/// The renderable in renderlist that could be shown as the whole of view_area, or null if there's none
+auto scanout_candidate(RenderableList const& renderlist, geometry::Rectangle const& view_area)
+    -> std::shared_ptr<Renderable>;
+
+/**
+ * A DisplayBuffer that can show a client's buffer directly as its output, so that a
+ * fullscreen surface needs no composition.
+ *
+ * DisplayBuffers that can do this implement this interface as well as DisplayBuffer.
+ */
+class DirectScanout
+{
+public:
+    virtual ~DirectScanout() = default;
+
+    /**
+     * Shows the buffer of candidate (found by scanout_candidate()) as this DisplayBuffer's
+     * next frame, in place of a composited one.
+     *
+     * \returns false if the buffer can't be shown directly: the frame must then be composited.
+     */
+    virtual bool scanout(std::shared_ptr<Renderable> const& candidate) = 0;
+
+protected:
+    DirectScanout() = default;
+    DirectScanout(DirectScanout const&) = delete;
+    DirectScanout& operator=(DirectScanout const&) = delete;
+};
+}
+}
+
+#endif /* MIR_GRAPHICS_DIRECT_SCANOUT_H_ */
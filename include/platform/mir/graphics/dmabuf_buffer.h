@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_DMABUF_BUFFER_H_
+#define MIR_GRAPHICS_DMABUF_BUFFER_H_
+
+#include "mir/fd.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+/**
+ * A buffer whose contents can be shared, without a copy, as Linux dma-bufs.
+ *
+ * Buffers that can do this implement this interface on their NativeBufferBase.
+ */
+class DMABufBuffer
+{
+public:
+    struct Plane
+    {
+        Fd dma_buf;
+        uint32_t stride;
+        uint32_t offset;
+    };
+
+    struct Export
+    {
+        uint32_t drm_fourcc;
+        /// DRM_FORMAT_MOD_INVALID if the driver chose the layout implicitly
+        uint64_t modifier;
+        /// The first row in memory is the bottom of the image
+        bool y_inverted;
+        std::vector<Plane> planes;
+    };
+
+    virtual ~DMABufBuffer() = default;
+
+    /// The buffer's dma-bufs, exported on first use, or null if it can't be exported
+    virtual auto dma_buf_export() -> Export const* = 0;
+
+    /**
+     * Marks the buffer as used for a frame, as drawing it would.
+     *
+     * Whatever shows the exported buffer in place of drawing it calls this, so that its
+     * client is told to draw the next one.
+     */
+    virtual void mark_consumed() = 0;
+
+protected:
+    DMABufBuffer() = default;
+    DMABufBuffer(DMABufBuffer const&) = delete;
+    DMABufBuffer& operator=(DMABufBuffer const&) = delete;
+};
+}
+}
+
+#endif /* MIR_GRAPHICS_DMABUF_BUFFER_H_ */
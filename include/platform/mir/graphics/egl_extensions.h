@@ -181,6 +181,26 @@ typedef EGLBoolean (EGLAPIENTRYP PFNEGLQUERYDMABUFFORMATSEXTPROC) (EGLDisplay dp
 typedef EGLBoolean (EGLAPIENTRYP PFNEGLQUERYDMABUFMODIFIERSEXTPROC) (EGLDisplay dpy, EGLint format, EGLint max_modifiers, EGLuint64KHR *modifiers, EGLBoolean *external_only, EGLint *num_modifiers);
 #endif /* EGL_EXT_image_dma_buf_import_modifiers */
 
+#ifndef EGL_KHR_wait_sync
+#define EGL_KHR_wait_sync 1
+typedef EGLint (EGLAPIENTRYP PFNEGLWAITSYNCKHRPROC) (EGLDisplay dpy, EGLSyncKHR sync, EGLint flags);
+#endif /* EGL_KHR_wait_sync */
+
+#ifndef EGL_ANDROID_native_fence_sync
+#define EGL_ANDROID_native_fence_sync 1
+#define EGL_SYNC_NATIVE_FENCE_ANDROID     0x3144
+#define EGL_SYNC_NATIVE_FENCE_FD_ANDROID  0x3145
+#define EGL_SYNC_NATIVE_FENCE_SIGNALED_ANDROID 0x3146
+#define EGL_NO_NATIVE_FENCE_FD_ANDROID    -1
+typedef EGLint (EGLAPIENTRYP PFNEGLDUPNATIVEFENCEFDANDROIDPROC) (EGLDisplay dpy, EGLSyncKHR sync);
+#endif /* EGL_ANDROID_native_fence_sync */
+
+#ifndef EGL_MESA_image_dma_buf_export
+#define EGL_MESA_image_dma_buf_export 1
+typedef EGLBoolean (EGLAPIENTRYP PFNEGLEXPORTDMABUFIMAGEQUERYMESAPROC) (EGLDisplay dpy, EGLImageKHR image, int *fourcc, int *num_planes, EGLuint64KHR *modifiers);
+typedef EGLBoolean (EGLAPIENTRYP PFNEGLEXPORTDMABUFIMAGEMESAPROC) (EGLDisplay dpy, EGLImageKHR image, int *fds, EGLint *strides, EGLint *offsets);
+#endif /* EGL_MESA_image_dma_buf_export */
+
 /*
  * Just enough polyfill for rawhide headers...
  */
@@ -273,6 +293,26 @@ struct EGLExtensions
         PFNEGLQUERYDMABUFFORMATSEXTPROC const eglQueryDmaBufFormatsExt;
         PFNEGLQUERYDMABUFMODIFIERSEXTPROC const eglQueryDmaBufModifiersExt;
     };
+
+    /// Importing and exporting Linux sync_file fences as EGL syncs
+    struct ANDROIDNativeFenceSync
+    {
+        ANDROIDNativeFenceSync(EGLDisplay dpy);
+
+        PFNEGLCREATESYNCKHRPROC const eglCreateSyncKHR;
+        PFNEGLDESTROYSYNCKHRPROC const eglDestroySyncKHR;
+        PFNEGLWAITSYNCKHRPROC const eglWaitSyncKHR;
+        PFNEGLDUPNATIVEFENCEFDANDROIDPROC const eglDupNativeFenceFDANDROID;
+    };
+
+    /// Exporting EGLImages as Linux dma-bufs
+    struct MESAImageDMABufExport
+    {
+        MESAImageDMABufExport(EGLDisplay dpy);
+
+        PFNEGLEXPORTDMABUFIMAGEQUERYMESAPROC const eglExportDMABUFImageQueryMESA;
+        PFNEGLEXPORTDMABUFIMAGEMESAPROC const eglExportDMABUFImageMESA;
+    };
 };
 
 }
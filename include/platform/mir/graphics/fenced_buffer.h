@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_FENCED_BUFFER_H_
+#define MIR_GRAPHICS_FENCED_BUFFER_H_
+
+#include "mir/fd.h"
+
+#include <functional>
+
+namespace mir
+{
+namespace graphics
+{
+/**
+ * A buffer whose content can be synchronised with explicit fences.
+ *
+ * Buffers whose native_buffer_base() implements this can be given a fence
+ * (a Linux sync_file) to wait on before the compositor reads them, and report
+ * a fence that signals once those reads are complete, rather than relying on
+ * implicit synchronisation.
+ */
+class FencedBuffer
+{
+public:
+    virtual ~FencedBuffer() = default;
+
+    /// Delay the compositor's reads of the buffer until \a fence signals
+    virtual void set_acquire_fence(Fd fence) = 0;
+
+    /**
+     * Set the handler called (on the Wayland thread) when the buffer is
+     * released, with a fence that signals once the compositor's reads have
+     * completed. The fence is invalid if the reads have already completed.
+     */
+    virtual void set_release_handler(std::function<void(Fd release_fence)>&& handler) = 0;
+
+protected:
+    FencedBuffer() = default;
+    FencedBuffer(FencedBuffer const&) = delete;
+    FencedBuffer& operator=(FencedBuffer const&) = delete;
+};
+}
+}
+
+#endif /* MIR_GRAPHICS_FENCED_BUFFER_H_ */
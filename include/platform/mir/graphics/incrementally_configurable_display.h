@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_INCREMENTALLY_CONFIGURABLE_DISPLAY_H_
+#define MIR_GRAPHICS_INCREMENTALLY_CONFIGURABLE_DISPLAY_H_
+
+#include <functional>
+
+namespace mir
+{
+namespace graphics
+{
+class DisplayConfiguration;
+class DisplaySyncGroup;
+
+/**
+ * A Display that can apply a configuration without invalidating the
+ * DisplaySyncGroups of the outputs that the configuration leaves unchanged.
+ *
+ * Displays that can do this implement this interface as well as Display.
+ */
+class IncrementallyConfigurableDisplay
+{
+public:
+    virtual ~IncrementallyConfigurableDisplay() = default;
+
+    /**
+     * Sets a new output configuration, only replacing the DisplaySyncGroups that it changes.
+     *
+     * Before anything is changed \p invalidating is called with each DisplaySyncGroup that is
+     * to be destroyed; once it returns nothing may use that group or its DisplayBuffers.
+     *
+     * Every other DisplaySyncGroup (and its DisplayBuffers) remains valid, and may continue
+     * to be used throughout. Groups for newly enabled outputs are found with
+     * Display::for_each_display_sync_group() afterwards.
+     */
+    virtual void configure_incrementally(
+        DisplayConfiguration const& conf,
+        std::function<void(DisplaySyncGroup& group)> const& invalidating) = 0;
+
+protected:
+    IncrementallyConfigurableDisplay() = default;
+    IncrementallyConfigurableDisplay(IncrementallyConfigurableDisplay const&) = delete;
+    IncrementallyConfigurableDisplay& operator=(IncrementallyConfigurableDisplay const&) = delete;
+};
+}
+}
+
+#endif /* MIR_GRAPHICS_INCREMENTALLY_CONFIGURABLE_DISPLAY_H_ */
@@ -0,0 +1,57 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_PARTIAL_OVERLAY_H_
+#define MIR_GRAPHICS_PARTIAL_OVERLAY_H_
+
+#include "mir/graphics/renderable.h"
+
+namespace mir
+{
+namespace graphics
+{
+/**
+ * A DisplayBuffer that can show the top of a scene as overlays and leave only what is
+ * beneath them to be composited, rather than overlaying all of the scene or none of it.
+ *
+ * DisplayBuffers that can do this implement this interface as well as DisplayBuffer, and
+ * compositors that know of it use it in place of DisplayBuffer::overlay().
+ */
+class PartialOverlay
+{
+public:
+    virtual ~PartialOverlay() = default;
+
+    /**
+     * Shows as much of the top of renderlist as it can as overlays.
+     *
+     * \param [in,out] renderlist   The scene, bottom-most first. If it isn't all overlaid this
+     *                              is left holding what must be composited beneath the overlays:
+     *                              they appear with the composited frame.
+     * \returns true if all of the scene is shown as overlays, in which case nothing
+     *          is to be composited.
+     */
+    virtual bool overlay_top_of(RenderableList& renderlist) = 0;
+
+protected:
+    PartialOverlay() = default;
+    PartialOverlay(PartialOverlay const&) = delete;
+    PartialOverlay& operator=(PartialOverlay const&) = delete;
+};
+}
+}
+
+#endif /* MIR_GRAPHICS_PARTIAL_OVERLAY_H_ */
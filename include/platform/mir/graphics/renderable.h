@@ -31,6 +31,28 @@ namespace graphics
 {
 
 class Buffer;
+
+/**
+ * A part of a buffer in texture coordinates: (0, 0) is the top-left corner of
+ * the buffer and (1, 1) is the bottom-right.
+ */
+struct TextureBounds
+{
+    float left{0.0f};
+    float top{0.0f};
+    float right{1.0f};
+    float bottom{1.0f};
+};
+
+inline bool operator==(TextureBounds const& lhs, TextureBounds const& rhs)
+{
+    return lhs.left == rhs.left && lhs.top == rhs.top && lhs.right == rhs.right && lhs.bottom == rhs.bottom;
+}
+
+inline bool operator!=(TextureBounds const& lhs, TextureBounds const& rhs)
+{
+    return !(lhs == rhs);
+}
 class Renderable
 {
 public:
@@ -52,6 +74,12 @@ public:
     virtual geometry::Rectangle screen_position() const = 0;
     virtual std::experimental::optional<geometry::Rectangle> clip_area() const = 0;
 
+    /**
+     * The part of buffer() to show, stretched to fill screen_position().
+     * By default this is the whole buffer.
+     */
+    virtual TextureBounds texture_bounds() const { return {}; }
+
     // These are from the old CompositingCriteria. There is a little bit
     // of function overlap with the above functions still.
     virtual float alpha() const = 0;
@@ -49,15 +49,28 @@ extern char const* const fatal_except_opt;
 extern char const* const debug_opt;
 extern char const* const composite_delay_opt;
 extern char const* const enable_key_repeat_opt;
+extern char const* const input_resampling_opt;
 extern char const* const x11_display_opt;
 extern char const* const wayland_extensions_opt;
 extern char const* const enable_mirclient_opt;
+extern char const* const wayland_client_queue_limit_opt;
+extern char const* const wayland_slow_client_policy_opt;
 
 extern char const* const offscreen_opt;
+extern char const* const renderer_opt;
+extern char const* const gl_program_cache_opt;
 
 extern char const* const enable_key_repeat_opt;
 
 extern char const* const off_opt_value;
+extern char const* const auto_opt_value;
+extern char const* const gl_renderer_value;
+extern char const* const software_renderer_value;
+extern char const* const throttle_opt_value;
+extern char const* const disconnect_opt_value;
+extern char const* const touch_opt_value;
+extern char const* const pointer_opt_value;
+extern char const* const all_opt_value;
 extern char const* const log_opt_value;
 extern char const* const lttng_opt_value;
 
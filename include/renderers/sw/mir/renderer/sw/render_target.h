@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_RENDER_TARGET_H_
+#define MIR_RENDERER_SW_RENDER_TARGET_H_
+
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/geometry/rectangle.h"
+
+#include <memory>
+#include <vector>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+
+/**
+ * A display buffer that can be composited into by the CPU.
+ */
+class RenderTarget
+{
+public:
+    virtual ~RenderTarget() = default;
+
+    /**
+     * Map the framebuffer into CPU-accessible memory.
+     *
+     * \note    The content of the mapping is whatever was committed by the
+     *          previous frame, so a renderer need only redraw damaged regions.
+     */
+    virtual auto map_framebuffer() -> std::unique_ptr<Mapping<unsigned char>> = 0;
+
+    /**
+     * Present the content written to the framebuffer.
+     * Any mapping returned by map_framebuffer() must be destroyed first.
+     *
+     * \param damage  The framebuffer areas written since the previous commit;
+     *                the rest of the framebuffer is unchanged
+     */
+    virtual void commit(std::vector<geometry::Rectangle> const& damage) = 0;
+
+protected:
+    RenderTarget() = default;
+    RenderTarget(RenderTarget const&) = delete;
+    RenderTarget& operator=(RenderTarget const&) = delete;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_RENDER_TARGET_H_ */
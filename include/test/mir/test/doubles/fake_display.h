@@ -20,6 +20,8 @@
 #define MIR_TEST_DOUBLES_FAKE_DISPLAY_H_
 
 #include "mir/test/doubles/null_display.h"
+#include "mir/graphics/incrementally_configurable_display.h"
+#include "mir/graphics/display_configuration.h"
 #include "mir/fd.h"
 
 #include "mir/geometry/rectangle.h"
@@ -35,7 +37,7 @@ namespace test
 namespace doubles
 {
 class StubDisplayConfig;
-class FakeDisplay : public NullDisplay
+class FakeDisplay : public NullDisplay, public graphics::IncrementallyConfigurableDisplay
 {
 public:
     FakeDisplay();
@@ -52,6 +54,9 @@ public:
 
     bool apply_if_configuration_preserves_display_buffers(graphics::DisplayConfiguration const&) override;
     void configure(mir::graphics::DisplayConfiguration const&) override;
+    void configure_incrementally(
+        graphics::DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& invalidating) override;
 
     void emit_configuration_change_event(
         std::shared_ptr<mir::graphics::DisplayConfiguration> const& new_config);
@@ -59,8 +64,16 @@ public:
     void wait_for_configuration_change_handler();
 
 private:
+    /// The group displaying an output, as it was when the group was created
+    struct OutputGroup
+    {
+        graphics::DisplayConfigurationOutputId output_id;
+        geometry::Rectangle extents;
+        std::unique_ptr<StubDisplaySyncGroup> group;
+    };
+
     std::shared_ptr<StubDisplayConfig> config;
-    std::vector<std::unique_ptr<StubDisplaySyncGroup>> groups;
+    std::vector<OutputGroup> groups;
     Fd const wakeup_trigger;
     std::atomic<bool> handler_called;
     std::mutex mutable configuration_mutex;
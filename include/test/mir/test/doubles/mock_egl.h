@@ -162,6 +162,8 @@ public:
     MOCK_METHOD3(eglCreateSyncKHR, EGLSyncKHR(EGLDisplay, EGLenum, EGLint const*));
     MOCK_METHOD2(eglDestroySyncKHR, EGLBoolean(EGLDisplay, EGLSyncKHR));
     MOCK_METHOD4(eglClientWaitSyncKHR, EGLint(EGLDisplay, EGLSyncKHR, EGLint, EGLTimeKHR));
+    MOCK_METHOD3(eglWaitSyncKHR, EGLint(EGLDisplay, EGLSyncKHR, EGLint));
+    MOCK_METHOD2(eglDupNativeFenceFDANDROID, EGLint(EGLDisplay, EGLSyncKHR));
 
     MOCK_METHOD5(eglGetSyncValuesCHROMIUM, EGLBoolean(EGLDisplay, EGLSurface,
                                                       int64_t*, int64_t*,
@@ -67,6 +67,7 @@ public:
     MOCK_METHOD1(glEnable, void(GLenum));
     MOCK_METHOD1(glEnableVertexAttribArray, void(GLuint));
     MOCK_METHOD0(glFinish, void());
+    MOCK_METHOD0(glFlush, void());
     MOCK_METHOD4(glFramebufferRenderbuffer,
                  void(GLenum, GLenum, GLenum, GLuint));
     MOCK_METHOD5(glFramebufferTexture2D,
@@ -38,6 +38,8 @@ struct StubSession : scene::Session
 
     void take_snapshot(scene::SnapshotCallback const& snapshot_taken) override;
 
+    void take_snapshot(geometry::Size const& max_size, scene::SnapshotCallback const& snapshot_taken) override;
+
     std::shared_ptr<scene::Surface> default_surface() const override;
 
     void set_lifecycle_state(MirLifecycleState state) override;
@@ -51,6 +51,8 @@ struct StubSurface : scene::Surface
     bool visible() const override { return false; }
     graphics::RenderableList generate_renderables(compositor::CompositorID) const override { return {}; }
     int buffers_ready_for_compositor(void const*) const override { return 0; }
+    void frame_presented(compositor::CompositorID) override {}
+    compositor::FrameStatistics frame_statistics() const override { return {}; }
     MirWindowType type() const override { return mir_window_type_normal; }
     MirWindowState state() const override { return mir_window_state_fullscreen; }
     int configure(MirWindowAttrib, int value) override { return value; }
@@ -21,6 +21,9 @@
 
 #include <boost/throw_exception.hpp>
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <stdexcept>
 
@@ -189,8 +192,72 @@ public:
     wl_global* const global;
 };
 
+/**
+ * Report the exception being handled by a request thunk
+ *
+ * A ProtocolError is sent to the client as that error; anything else is
+ * logged and reported to the client as an implementation error.
+ * \note Only call this from within a catch block
+ */
 void internal_error_processing_request(wl_client* client, char const* method_name);
 
+/**
+ * The dispatch statistics of one request
+ *
+ * Thunks generated with --profile-requests (see the MIR_WAYLAND_PROFILE_REQUESTS
+ * build option) keep one of these for each request they dispatch.
+ * Like the rest of the wrappers it is only updated on the Wayland thread.
+ */
+class RequestProfile
+{
+public:
+    explicit RequestProfile(char const* name);
+
+    RequestProfile(RequestProfile const&) = delete;
+    RequestProfile& operator=(RequestProfile const&) = delete;
+
+    char const* const name;
+    uint64_t dispatch_count{0};
+    std::chrono::nanoseconds total_time{0};
+    std::chrono::nanoseconds max_time{0};
+
+private:
+    friend void for_each_request_profile(std::function<void(RequestProfile const&)> const& callback);
+    RequestProfile* next;
+};
+
+/// Accounts one dispatch to a RequestProfile, from construction to destruction
+class RequestTimer
+{
+public:
+    explicit RequestTimer(RequestProfile& profile)
+        : profile{profile},
+          start{std::chrono::steady_clock::now()}
+    {
+    }
+
+    ~RequestTimer()
+    {
+        auto const elapsed = std::chrono::steady_clock::now() - start;
+        ++profile.dispatch_count;
+        profile.total_time += elapsed;
+        if (elapsed > profile.max_time)
+        {
+            profile.max_time = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+        }
+    }
+
+    RequestTimer(RequestTimer const&) = delete;
+    RequestTimer& operator=(RequestTimer const&) = delete;
+
+private:
+    RequestProfile& profile;
+    std::chrono::steady_clock::time_point const start;
+};
+
+/// Visit the profile of every request that has been dispatched so far
+void for_each_request_profile(std::function<void(RequestProfile const&)> const& callback);
+
 }
 }
 
@@ -21,8 +21,6 @@
 
 #include "mir_protobuf.pb.h"
 #include "mir_protobuf_wire.pb.h"
-#include "mir/frontend/client_constants.h"
-#include "mir/variable_length_array.h"
 #include "mir/protobuf/protocol_version.h"
 #include "mir/log.h"
 
@@ -153,20 +151,21 @@ mir::protobuf::wire::Invocation mclr::MirBasicRpcChannel::invocation_for(
     google::protobuf::MessageLite const* request,
     size_t num_side_channel_fds)
 {
-    mir::VariableLengthArray<mir::frontend::serialization_buffer_size>
-#if GOOGLE_PROTOBUF_VERSION >= 3010000
-        buffer{static_cast<size_t>(request->ByteSizeLong())};
-#else
-        buffer{static_cast<size_t>(request->ByteSize())};
-#endif
-
-    request->SerializeWithCachedSizesToArray(buffer.data());
-
     mir::protobuf::wire::Invocation invoke;
 
     invoke.set_id(next_id());
     invoke.set_method_name(method_name);
-    invoke.set_parameters(buffer.data(), buffer.size());
+
+    // Serialize the request in place rather than copying it in afterwards
+#if GOOGLE_PROTOBUF_VERSION >= 3010000
+    auto const request_size = static_cast<size_t>(request->ByteSizeLong());
+#else
+    auto const request_size = static_cast<size_t>(request->ByteSize());
+#endif
+    auto const parameters = invoke.mutable_parameters();
+    parameters->resize(request_size);
+    request->SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(&(*parameters)[0]));
+
     invoke.set_protocol_version(protocol_version);
     invoke.set_side_channel_fds(num_side_channel_fds);
 
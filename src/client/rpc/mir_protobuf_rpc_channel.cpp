@@ -28,7 +28,6 @@
 #include "../display_configuration.h"
 #include "../lifecycle_control.h"
 #include "../event_sink.h"
-#include "../make_protobuf_object.h"
 #include "../protobuf_to_native_buffer.h"
 #include "../mir_error.h"
 #include "mir/input/input_devices.h"
@@ -276,13 +275,14 @@ void mclr::MirProtobufRpcChannel::send_message(
         static_cast<unsigned char>((size >> 0) & 0xff)
     };
 
-    detail::SendBuffer send_buffer(sizeof header_bytes + size);
-    std::copy(header_bytes, header_bytes + sizeof header_bytes, send_buffer.begin());
-    body.SerializeToArray(send_buffer.data() + sizeof header_bytes, size);
-
     try
     {
         std::lock_guard<decltype(write_mutex)> lock(write_mutex);
+
+        send_buffer.resize(sizeof header_bytes + size);
+        std::copy(header_bytes, header_bytes + sizeof header_bytes, send_buffer.begin());
+        body.SerializeWithCachedSizesToArray(send_buffer.data() + sizeof header_bytes);
+
         transport->send_message(send_buffer, fds);
     }
     catch (std::runtime_error const& err)
@@ -294,11 +294,12 @@ void mclr::MirProtobufRpcChannel::send_message(
     rpc_report->invocation_succeeded(invocation);
 }
 
-void mclr::MirProtobufRpcChannel::process_event_sequence(std::string const& event)
+void mclr::MirProtobufRpcChannel::process_event_sequence(mp::WireBytes const& event)
 {
-    mp::EventSequence seq;
+    event_arena.reset();
+    auto& seq = *event_arena.create<mp::EventSequence>();
 
-    seq.ParseFromString(event);
+    event.parse_into(seq);
 
     if (seq.has_display_configuration())
     {
@@ -484,7 +485,7 @@ void mclr::MirProtobufRpcChannel::on_data_available()
      */
     std::lock_guard<decltype(read_mutex)> lock(read_mutex);
 
-    auto result = mcl::make_protobuf_object<mp::wire::Result>();
+    auto& result = received_result;
     try
     {
         uint16_t message_size;
@@ -494,9 +495,16 @@ void mclr::MirProtobufRpcChannel::on_data_available()
         body_bytes.resize(message_size);
         transport->receive_data(body_bytes.data(), message_size);
 
-        result->ParseFromArray(body_bytes.data(), message_size);
+        // The response and events stay in body_bytes until they're decoded
+        // into the messages that consume them
+        if (!received.parse(body_bytes.data(), message_size))
+            BOOST_THROW_EXCEPTION(std::runtime_error("Failed to parse result"));
+
+        result.Clear();
+        if (received.has_id)
+            result.set_id(received.id);
 
-        rpc_report->result_receipt_succeeded(*result);
+        rpc_report->result_receipt_succeeded(result);
     }
     catch (std::exception const& x)
     {
@@ -506,34 +514,33 @@ void mclr::MirProtobufRpcChannel::on_data_available()
 
     try
     {
-        for (int i = 0; i != result->events_size(); ++i)
+        for (auto const& event : received.events)
         {
-            process_event_sequence(result->events(i));
+            process_event_sequence(event);
         }
 
-        if (result->has_id())
+        if (received.has_id)
         {
             pending_calls.populate_message_for_result(
-                *result,
+                result,
                 [&](google::protobuf::MessageLite* result_message)
                     {
-                        result_message->ParseFromString(result->response());
+                        received.response.parse_into(*result_message);
                         receive_file_descriptors(result_message);
                     });
 
             if (id_to_wait_for)
             {
-                if (result->id() == id_to_wait_for.value())
+                if (result.id() == id_to_wait_for.value())
                 {
-                    pending_calls.complete_response(*result);
+                    pending_calls.complete_response(result);
                     multiplexer.add_watch(delayed_processor);
                 }
                 else
                 {
-                    // It's too difficult to convince C++ to move this lambda everywhere, so
-                    // just give up and let it pretend its a shared_ptr.
-                    std::shared_ptr<mp::wire::Result> appeaser{std::move(result)};
-                    delayed_processor->enqueue([delayed_result = std::move(appeaser), this]() mutable
+                    // Only the id is needed to complete the response later
+                    auto delayed_result = std::make_shared<mp::wire::Result>(result);
+                    delayed_processor->enqueue([delayed_result, this]()
                     {
                         pending_calls.complete_response(*delayed_result);
                     });
@@ -541,7 +548,7 @@ void mclr::MirProtobufRpcChannel::on_data_available()
             }
             else
             {
-                pending_calls.complete_response(*result);
+                pending_calls.complete_response(result);
             }
         }
     }
@@ -550,7 +557,7 @@ void mclr::MirProtobufRpcChannel::on_data_available()
         // TODO: This is dangerous as an error in result processing could cause a wait handle
         // to never fire. Could perhaps fix by catching and setting error on the response before invoking
         // callback ~racarr
-        rpc_report->result_processing_failed(*result, x);
+        rpc_report->result_processing_failed(result, x);
     }
 }
 
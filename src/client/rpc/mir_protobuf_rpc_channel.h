@@ -24,6 +24,7 @@
 #include "mir/dispatch/dispatchable.h"
 #include "mir/dispatch/multiplexing_dispatchable.h"
 #include "mir/dispatch/action_queue.h"
+#include "mir/protobuf/wire_codec.h"
 
 #include "../lifecycle_control.h"
 #include "../ping_handler.h"
@@ -122,6 +123,14 @@ private:
     detail::SendBuffer header_bytes;
     detail::SendBuffer body_bytes;
 
+    // Reused for each message; guarded by read_mutex
+    mir::protobuf::ResultView received;
+    mir::protobuf::wire::Result received_result;
+    mir::protobuf::MessageArena event_arena;
+
+    // Guarded by write_mutex
+    detail::SendBuffer send_buffer;
+
     void receive_file_descriptors(google::protobuf::MessageLite* response);
     template<class MessageType>
     void receive_any_file_descriptors_for(MessageType* response);
@@ -130,7 +139,7 @@ private:
                       std::vector<mir::Fd>& fds);
 
     void read_message();
-    void process_event_sequence(std::string const& event);
+    void process_event_sequence(mir::protobuf::WireBytes const& event);
 
     void notify_disconnected();
 
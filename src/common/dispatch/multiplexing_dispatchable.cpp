@@ -22,9 +22,13 @@
 #include "mir/posix_rw_mutex.h"
 
 #include <boost/throw_exception.hpp>
+#include <array>
+#include <atomic>
+#include <deque>
 #include <shared_mutex>
 
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <poll.h>
 #include <limits.h>
 #include <unistd.h>
@@ -36,6 +40,10 @@ namespace md = mir::dispatch;
 
 namespace
 {
+// Enough to amortise an epoll_wait() over a busy set of sources while
+// keeping the batch on the stack.
+int const max_batch_size{16};
+
 class DispatchableAdaptor : public md::Dispatchable
 {
 public:
@@ -69,11 +77,104 @@ private:
     std::function<void()> const handler;
 };
 
+mir::Fd make_pending_fd()
+{
+    mir::Fd fd{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+    if (fd == mir::Fd::invalid)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                 std::system_category(),
+                                                 "Failed to create batch eventfd"}));
+    }
+    return fd;
+}
 }
 
+struct md::MultiplexingDispatchable::Watch : std::enable_shared_from_this<Watch>
+{
+    Watch(std::shared_ptr<Dispatchable> const& dispatchee, DispatchReentrancy reentrancy)
+        : dispatchee{dispatchee},
+          rearm{reentrancy == DispatchReentrancy::sequential}
+    {
+    }
+
+    std::shared_ptr<Dispatchable> const dispatchee;
+    bool const rearm;
+    std::atomic<bool> removed{false};
+};
+
+/**
+ * The part of a batch that the thread which collected it has yet to dispatch.
+ *
+ * pending_fd is in the epoll set and is readable exactly while the queue is
+ * non-empty, so that any thread dispatching the adaptor can take an entry.
+ */
+struct md::MultiplexingDispatchable::ReadyQueue
+{
+    struct Entry
+    {
+        std::shared_ptr<Watch> watch;
+        FdEvents events;
+    };
+
+    template<typename Iterator>
+    void push(Iterator begin, Iterator end)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto const was_empty = entries.empty();
+        entries.insert(entries.end(), std::make_move_iterator(begin), std::make_move_iterator(end));
+        if (was_empty && !entries.empty())
+        {
+            eventfd_write(pending_fd, 1);
+        }
+    }
+
+    bool pop(Entry& entry)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (entries.empty())
+        {
+            return false;
+        }
+        entry = std::move(entries.front());
+        entries.pop_front();
+        if (entries.empty())
+        {
+            eventfd_t unused;
+            eventfd_read(pending_fd, &unused);
+        }
+        return true;
+    }
+
+    void discard(mir::Fd const& fd)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (entries.empty())
+        {
+            return;
+        }
+        entries.erase(
+            std::remove_if(
+                entries.begin(),
+                entries.end(),
+                [&fd](Entry const& entry) { return entry.watch->dispatchee->watch_fd() == fd; }),
+            entries.end());
+        if (entries.empty())
+        {
+            eventfd_t unused;
+            eventfd_read(pending_fd, &unused);
+        }
+    }
+
+    mir::Fd const pending_fd{make_pending_fd()};
+    std::mutex mutex;
+    std::deque<Entry> entries;
+};
+
 md::MultiplexingDispatchable::MultiplexingDispatchable()
     : lifetime_mutex{PosixRWMutex::Type::PreferWriterNonRecursive},
-      epoll_fd{mir::Fd{::epoll_create1(EPOLL_CLOEXEC)}}
+      epoll_fd{mir::Fd{::epoll_create1(EPOLL_CLOEXEC)}},
+      ready{std::make_unique<ReadyQueue>()}
 {
     if (epoll_fd == mir::Fd::invalid)
     {
@@ -81,6 +182,18 @@ md::MultiplexingDispatchable::MultiplexingDispatchable()
                                                  std::system_category(),
                                                  "Failed to create epoll monitor"}));
     }
+
+    // Level-triggered: every thread should see it until the queue is drained
+    epoll_event e;
+    ::memset(&e, 0, sizeof(e));
+    e.events = EPOLLIN;
+    e.data.ptr = static_cast<void*>(ready.get());
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ready->pending_fd, &e) < 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                 std::system_category(),
+                                                 "Failed to monitor batch eventfd"}));
+    }
 }
 
 md::MultiplexingDispatchable::~MultiplexingDispatchable() noexcept
@@ -108,14 +221,18 @@ bool md::MultiplexingDispatchable::dispatch(md::FdEvents events)
         return false;
     }
 
-    std::shared_ptr<md::Dispatchable> source;
-    bool rearm_source{false};
-    epoll_event event;
+    std::array<ReadyQueue::Entry, max_batch_size> batch;
+    int batch_size{0};
 
     {
         std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
 
-        auto result = epoll_wait(epoll_fd, &event, 1, 0);
+        // A reentrant dispatchee stays ready for every thread until it is
+        // serviced, so collecting it in a batch would only queue duplicates.
+        auto const limit = reentrant_watches > 0 ? 1 : max_batch_size;
+
+        std::array<epoll_event, max_batch_size> ready_events;
+        auto result = epoll_wait(epoll_fd, ready_events.data(), limit, 0);
 
         if (result < 0)
         {
@@ -124,30 +241,63 @@ bool md::MultiplexingDispatchable::dispatch(md::FdEvents events)
                                                      "Failed to wait on fds"}));
         }
 
-        if (result == 0)
+        for (int i = 0; i != result; ++i)
         {
-            // Some other thread must have stolen the event we were woken for;
-            // that's ok, just return.
-            return true;
+            // The queued remainder of a batch is picked up below
+            if (ready_events[i].data.ptr != ready.get())
+            {
+                auto const watch = static_cast<Watch*>(ready_events[i].data.ptr);
+                batch[batch_size++] = {watch->shared_from_this(), epoll_to_fd_event(ready_events[i])};
+            }
         }
+    }
+
+    // If no sources are ready some other thread must have stolen the event
+    // we were woken for; that's ok, there's nothing to do.
+    if (batch_size > 1)
+    {
+        ready->push(batch.begin() + 1, batch.begin() + batch_size);
+    }
+
+    if (batch_size > 0)
+    {
+        dispatch_ready(batch[0].watch, batch[0].events);
+    }
 
-        auto event_source = reinterpret_cast<decltype(dispatchee_holder)::pointer>(event.data.ptr);
+    // Entries that we (or other threads) queued, in the order they were
+    // reported, until the queue is empty or we've done a batch worth; in the
+    // latter case pending_fd remains readable and we'll be called again.
+    ReadyQueue::Entry entry;
+    for (int i = 1; i < max_batch_size && ready->pop(entry); ++i)
+    {
+        dispatch_ready(entry.watch, entry.events);
+    }
+
+    return true;
+}
 
-        source = event_source->first;
-        rearm_source = event_source->second;
+void md::MultiplexingDispatchable::dispatch_ready(std::shared_ptr<Watch> const& watch, FdEvents events)
+{
+    if (watch->removed)
+    {
+        // Removed after it was queued
+        return;
     }
 
-    if (!source->dispatch(epoll_to_fd_event(event)))
+    auto const& source = watch->dispatchee;
+
+    if (!source->dispatch(events))
     {
         remove_watch(source);
     }
-    else if (rearm_source)
+    else if (watch->rearm && !watch->removed)
     {
+        epoll_event event;
+        ::memset(&event, 0, sizeof(event));
         event.events = fd_event_to_epoll(source->relevant_events()) | EPOLLONESHOT;
+        event.data.ptr = static_cast<void*>(watch.get());
         epoll_ctl(epoll_fd, EPOLL_CTL_MOD, source->watch_fd(), &event);
     }
-
-    return true;
 }
 
 md::FdEvents md::MultiplexingDispatchable::relevant_events() const
@@ -163,12 +313,14 @@ void md::MultiplexingDispatchable::add_watch(std::shared_ptr<md::Dispatchable> c
 void md::MultiplexingDispatchable::add_watch(std::shared_ptr<md::Dispatchable> const& dispatchee,
                                              DispatchReentrancy reentrancy)
 {
-    decltype(dispatchee_holder)::iterator new_holder;
+    auto const watch = std::make_shared<Watch>(dispatchee, reentrancy);
     {
         std::unique_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
-        new_holder = dispatchee_holder.emplace(dispatchee_holder.begin(),
-                                               dispatchee,
-                                               reentrancy == DispatchReentrancy::sequential);
+        dispatchee_holder.push_front(watch);
+        if (!watch->rearm)
+        {
+            ++reentrant_watches;
+        }
     }
 
     epoll_event e;
@@ -179,11 +331,15 @@ void md::MultiplexingDispatchable::add_watch(std::shared_ptr<md::Dispatchable> c
     {
         e.events |= EPOLLONESHOT;
     }
-    e.data.ptr = static_cast<void*>(&(*new_holder));
+    e.data.ptr = static_cast<void*>(watch.get());
     if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, dispatchee->watch_fd(), &e) < 0)
     {
         std::unique_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
-        dispatchee_holder.erase(new_holder);
+        dispatchee_holder.remove(watch);
+        if (!watch->rearm)
+        {
+            --reentrant_watches;
+        }
         if (errno == EEXIST)
         {
             BOOST_THROW_EXCEPTION((std::logic_error{"Attempted to monitor the same fd twice"}));
@@ -222,9 +378,22 @@ void md::MultiplexingDispatchable::remove_watch(Fd const& fd)
                                                  "Failed to remove fd monitor"}));
     }
 
-    std::unique_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
-    dispatchee_holder.remove_if([&fd](std::pair<std::shared_ptr<Dispatchable>,bool> const& candidate)
     {
-        return candidate.first->watch_fd() == fd;
-    });
+        std::unique_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
+        dispatchee_holder.remove_if([this, &fd](std::shared_ptr<Watch> const& candidate)
+        {
+            if (candidate->dispatchee->watch_fd() != fd)
+            {
+                return false;
+            }
+            candidate->removed = true;
+            if (!candidate->rearm)
+            {
+                --reentrant_watches;
+            }
+            return true;
+        });
+    }
+
+    ready->discard(fd);
 }
@@ -0,0 +1,452 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/logging/async_logger.h"
+#include "mir/thread_name.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#include <unistd.h>
+
+namespace ml = mir::logging;
+
+/// Messages waiting to be written, from one thread: a single-producer, single-consumer ring
+class ml::AsyncLogger::Buffer
+{
+public:
+    struct Header
+    {
+        std::uint32_t size;             ///< Of the whole record, so the next one follows it
+        std::uint16_t severity;         ///< Or skip, for unused space at the end of the ring
+        std::uint16_t component_length;
+        std::uint32_t message_length;
+        std::uint32_t unused;
+        std::int64_t seconds;
+        std::int64_t nanoseconds;
+
+        auto component() const -> char const* { return reinterpret_cast<char const*>(this + 1); }
+        auto message() const -> char const* { return component() + component_length; }
+    };
+
+    static std::uint16_t const skip{0xffff};
+
+    explicit Buffer(std::size_t size)
+        : capacity{rounded_capacity(size)},
+          data{new Header[capacity / sizeof(Header)]}
+    {
+    }
+
+    /// Called by the logging thread: copies the message in, unless there's no room
+    auto push(
+        Severity severity,
+        timespec const& time,
+        char const* component, std::size_t component_length,
+        char const* message, std::size_t message_length) -> bool
+    {
+        // A message too long to ever fit is truncated
+        component_length = std::min<std::size_t>(component_length, 256);
+        message_length = std::min(message_length, capacity / 2 - sizeof(Header) - component_length);
+
+        auto const size = round_up(sizeof(Header) + component_length + message_length);
+        auto const position = head.load(std::memory_order_relaxed);
+        auto const offset = position & (capacity - 1);
+        auto const contiguous = capacity - offset;
+        auto const needed = size <= contiguous ? size : contiguous + size;
+
+        if (capacity - (position - tail.load(std::memory_order_acquire)) < needed)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto record = position;
+        if (size > contiguous)
+        {
+            auto const unused = at(offset);
+            unused->size = contiguous;
+            unused->severity = skip;
+            record += contiguous;
+        }
+
+        auto const header = at(record & (capacity - 1));
+        header->size = size;
+        header->severity = static_cast<std::uint16_t>(severity);
+        header->component_length = component_length;
+        header->message_length = message_length;
+        header->seconds = time.tv_sec;
+        header->nanoseconds = time.tv_nsec;
+        memcpy(const_cast<char*>(header->component()), component, component_length);
+        memcpy(const_cast<char*>(header->message()), message, message_length);
+
+        head.store(position + needed);
+        return true;
+    }
+
+    /// Called by the writer: the records pushed so far (which stay put until release())
+    void collect(std::vector<Header const*>& records)
+    {
+        auto position = tail.load(std::memory_order_relaxed);
+        collected = head.load();
+
+        while (position != collected)
+        {
+            auto const header = at(position & (capacity - 1));
+            if (header->severity != skip)
+                records.push_back(header);
+            position += header->size;
+        }
+    }
+
+    /// Called by the writer: makes the room taken by the collected records available again
+    void release()
+    {
+        tail.store(collected, std::memory_order_release);
+    }
+
+    auto empty() const -> bool
+    {
+        return head.load() == tail.load(std::memory_order_relaxed);
+    }
+
+    /// Set once either the thread or the logger has gone
+    std::atomic<bool> detached{false};
+    std::atomic<std::uint64_t> dropped{0};
+
+private:
+    static auto rounded_capacity(std::size_t size) -> std::size_t
+    {
+        std::size_t capacity{4096};
+        while (capacity < size)
+            capacity *= 2;
+        return capacity;
+    }
+
+    static auto round_up(std::size_t size) -> std::size_t
+    {
+        return (size + sizeof(Header) - 1) / sizeof(Header) * sizeof(Header);
+    }
+
+    auto at(std::size_t offset) const -> Header*
+    {
+        return reinterpret_cast<Header*>(reinterpret_cast<char*>(data.get()) + offset);
+    }
+
+    std::size_t const capacity;
+    std::unique_ptr<Header[]> const data;
+    std::atomic<std::uint64_t> head{0};
+    std::atomic<std::uint64_t> tail{0};
+    std::uint64_t collected{0};
+};
+
+namespace
+{
+std::atomic<std::uint64_t> next_serial{1};
+
+/// This thread's buffers, one for each logger it has used
+struct ThreadBuffers
+{
+    ~ThreadBuffers()
+    {
+        for (auto const& buffer : buffers)
+            buffer.second->detached = true;
+    }
+
+    std::vector<std::pair<std::uint64_t, std::shared_ptr<ml::AsyncLogger::Buffer>>> buffers;
+};
+
+thread_local ThreadBuffers thread_buffers;
+
+char const* const severity_labels[] =
+{
+    "< CRITICAL! > ",
+    "< - ERROR - > ",
+    "< -warning- > ",
+    "<information> ",
+    "< - debug - > "
+};
+
+/// Converting to local time is only needed when the second changes
+class TimestampFormatter
+{
+public:
+    void append(std::string& out, std::int64_t seconds, std::int64_t nanoseconds)
+    {
+        if (seconds != formatted_seconds)
+        {
+            time_t const time = seconds;
+            tm local;
+            localtime_r(&time, &local);
+            length = strftime(formatted, sizeof formatted, "%F %T", &local);
+            formatted_seconds = seconds;
+        }
+
+        char fraction[16];
+        auto const fraction_length = snprintf(fraction, sizeof fraction, ".%06ld", static_cast<long>(nanoseconds / 1000));
+
+        out += '[';
+        out.append(formatted, length);
+        out.append(fraction, fraction_length);
+        out += "] ";
+    }
+
+private:
+    std::int64_t formatted_seconds{-1};
+    char formatted[32];
+    std::size_t length{0};
+};
+
+void write_all(int fd, std::string const& text)
+{
+    auto data = text.data();
+    auto remaining = text.size();
+
+    while (remaining)
+    {
+        auto const written = write(fd, data, remaining);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            // Nowhere to report failing to write the log
+            return;
+        }
+        data += written;
+        remaining -= written;
+    }
+}
+
+auto now() -> timespec
+{
+    timespec time;
+    clock_gettime(CLOCK_REALTIME, &time);
+    return time;
+}
+}
+
+ml::AsyncLogger::AsyncLogger()
+    : AsyncLogger{STDOUT_FILENO, STDERR_FILENO, 64 * 1024}
+{
+}
+
+ml::AsyncLogger::AsyncLogger(int output_fd, int error_fd, std::size_t buffer_size)
+    : output_fd{output_fd},
+      error_fd{error_fd},
+      buffer_size{buffer_size},
+      serial{next_serial++},
+      writer{[this] { write_messages(); }}
+{
+}
+
+ml::AsyncLogger::~AsyncLogger()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+        writer_waiting = false;
+        wake_writer.notify_one();
+    }
+
+    writer.join();
+
+    for (auto const& buffer : buffers)
+        buffer->detached = true;
+}
+
+void ml::AsyncLogger::log(Severity severity, std::string const& message, std::string const& component)
+{
+    auto& buffer = buffer_for_this_thread();
+    auto const time = now();
+
+    if (!buffer.push(severity, time, component.data(), component.size(), message.data(), message.size()) &&
+        severity <= Severity::error)
+    {
+        flush();
+        buffer.push(severity, time, component.data(), component.size(), message.data(), message.size());
+    }
+
+    submit(buffer, severity);
+}
+
+void ml::AsyncLogger::log(char const* component, Severity severity, char const* format, ...)
+{
+    char message[4096];
+    va_list va;
+    va_start(va, format);
+    auto const length = vsnprintf(message, sizeof message, format, va);
+    va_end(va);
+
+    if (length < 0)
+        return;
+
+    auto& buffer = buffer_for_this_thread();
+    auto const time = now();
+    auto const component_length = strlen(component);
+    auto const message_length = std::min<std::size_t>(length, sizeof message - 1);
+
+    if (!buffer.push(severity, time, component, component_length, message, message_length) &&
+        severity <= Severity::error)
+    {
+        flush();
+        buffer.push(severity, time, component, component_length, message, message_length);
+    }
+
+    submit(buffer, severity);
+}
+
+void ml::AsyncLogger::flush()
+{
+    std::unique_lock<std::mutex> lock{mutex};
+
+    if (std::this_thread::get_id() == writer.get_id())
+        return;
+
+    auto const ticket = ++flush_requested;
+    writer_waiting = false;
+    wake_writer.notify_one();
+
+    flushed_cv.wait(lock, [&] { return flushed >= ticket; });
+}
+
+auto ml::AsyncLogger::buffer_for_this_thread() -> Buffer&
+{
+    auto& mine = thread_buffers.buffers;
+
+    for (auto const& buffer : mine)
+    {
+        if (buffer.first == serial)
+            return *buffer.second;
+    }
+
+    // Loggers this thread used before may have gone
+    mine.erase(
+        std::remove_if(mine.begin(), mine.end(), [](auto const& buffer) { return buffer.second->detached.load(); }),
+        mine.end());
+
+    auto const buffer = std::make_shared<Buffer>(buffer_size);
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        buffers.push_back(buffer);
+    }
+    mine.emplace_back(serial, buffer);
+
+    return *buffer;
+}
+
+void ml::AsyncLogger::submit(Buffer&, Severity severity)
+{
+    // The lock is only taken to wake the writer, at most once each time it sleeps
+    if (writer_waiting.load())
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        writer_waiting = false;
+        wake_writer.notify_one();
+    }
+
+    if (severity <= Severity::error)
+        flush();
+}
+
+void ml::AsyncLogger::write_messages()
+{
+    std::vector<std::shared_ptr<Buffer>> current;
+    std::vector<Buffer::Header const*> records;
+    std::string output;
+    std::string errors;
+    TimestampFormatter timestamp;
+
+    mir::set_thread_name("Mir/Logger");
+
+    std::unique_lock<std::mutex> lock{mutex};
+    for (;;)
+    {
+        auto const ticket = flush_requested;
+        auto const stop = stopping;
+        current = buffers;
+        lock.unlock();
+
+        records.clear();
+        for (auto const& buffer : current)
+            buffer->collect(records);
+
+        // Each thread's messages are in order; this interleaves the threads'
+        std::stable_sort(records.begin(), records.end(),
+            [](Buffer::Header const* a, Buffer::Header const* b)
+            {
+                return a->seconds != b->seconds ? a->seconds < b->seconds : a->nanoseconds < b->nanoseconds;
+            });
+
+        output.clear();
+        errors.clear();
+        for (auto const record : records)
+        {
+            auto& out = record->severity < static_cast<std::uint16_t>(Severity::informational) ? errors : output;
+            timestamp.append(out, record->seconds, record->nanoseconds);
+            out += severity_labels[record->severity];
+            out.append(record->component(), record->component_length);
+            out += ": ";
+            out.append(record->message(), record->message_length);
+            out += '\n';
+        }
+
+        for (auto const& buffer : current)
+        {
+            buffer->release();
+
+            if (auto const dropped = buffer->dropped.exchange(0))
+            {
+                auto const time = now();
+                timestamp.append(errors, time.tv_sec, time.tv_nsec);
+                errors += severity_labels[static_cast<int>(Severity::warning)];
+                errors += "logging: " + std::to_string(dropped) + " message(s) dropped: logged faster than they could be written";
+                errors += '\n';
+            }
+        }
+
+        write_all(error_fd, errors);
+        write_all(output_fd, output);
+
+        current.clear();
+        lock.lock();
+
+        // Threads that have exited need no buffer, once it's been written
+        buffers.erase(
+            std::remove_if(buffers.begin(), buffers.end(),
+                [](auto const& buffer) { return buffer->detached && buffer->empty(); }),
+            buffers.end());
+
+        flushed = ticket;
+        flushed_cv.notify_all();
+
+        if (stop)
+            break;
+
+        // Set before checking the buffers: a thread pushing after the check will see it, and wake us
+        writer_waiting = true;
+        auto const pending = std::any_of(buffers.begin(), buffers.end(), [](auto const& b) { return !b->empty(); });
+        if (!pending)
+        {
+            wake_writer.wait(lock, [this] { return !writer_waiting || stopping || flush_requested != flushed; });
+        }
+        writer_waiting = false;
+    }
+}
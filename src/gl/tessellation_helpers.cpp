@@ -36,13 +36,12 @@ mgl::Primitive mgl::tessellate_renderable_into_rectangle(
     mgl::Primitive rectangle;
     rectangle.type = GL_TRIANGLE_STRIP;
 
-    GLfloat const tex_right = 1.0f;
-    GLfloat const tex_bottom = 1.0f;
+    auto const tex = renderable.texture_bounds();
 
     auto& vertices = rectangle.vertices;
-    vertices[0] = {{left,  top,    0.0f}, {0.0f,      0.0f}};
-    vertices[1] = {{left,  bottom, 0.0f}, {0.0f,      tex_bottom}};
-    vertices[2] = {{right, top,    0.0f}, {tex_right, 0.0f}};
-    vertices[3] = {{right, bottom, 0.0f}, {tex_right, tex_bottom}};
+    vertices[0] = {{left,  top,    0.0f}, {tex.left,  tex.top}};
+    vertices[1] = {{left,  bottom, 0.0f}, {tex.left,  tex.bottom}};
+    vertices[2] = {{right, top,    0.0f}, {tex.right, tex.top}};
+    vertices[3] = {{right, bottom, 0.0f}, {tex.right, tex.bottom}};
     return rectangle;
 }
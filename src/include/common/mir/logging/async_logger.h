@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_LOGGING_ASYNC_LOGGER_H_
+#define MIR_LOGGING_ASYNC_LOGGER_H_
+
+#include "mir/logging/logger.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mir
+{
+namespace logging
+{
+/**
+ * Writes log messages, in the DumbConsoleLogger's format, from a thread of its own.
+ *
+ * Each logging thread copies its messages into a buffer of its own, which
+ * needs no lock, and the writer thread formats and writes them (in timestamp
+ * order) in batches. A thread never waits for the console: if its buffer is
+ * full the message is dropped, and the number dropped is logged instead.
+ *
+ * Errors and critical messages are the exception: they are not dropped, and
+ * are written before log() returns, so that they are seen even if the
+ * process is about to die.
+ */
+class AsyncLogger : public Logger
+{
+public:
+    /// Writes to stdout (or, for warnings and worse, stderr)
+    AsyncLogger();
+
+    /// \param buffer_size  bytes of messages each thread can have waiting to be written
+    AsyncLogger(int output_fd, int error_fd, std::size_t buffer_size);
+
+    ~AsyncLogger();
+
+    void log(Severity severity, std::string const& message, std::string const& component) override;
+    void log(char const* component, Severity severity, char const* format, ...) override
+        __attribute__ ((format (printf, 4, 5)));
+
+    /// Waits until every message already logged has been written
+    void flush();
+
+    class Buffer;
+
+private:
+    auto buffer_for_this_thread() -> Buffer&;
+    void submit(Buffer& buffer, Severity severity);
+    void write_messages();
+
+    int const output_fd;
+    int const error_fd;
+    std::size_t const buffer_size;
+    std::uint64_t const serial;
+
+    std::mutex mutex;
+    std::condition_variable wake_writer;
+    std::condition_variable flushed_cv;
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    std::atomic<bool> writer_waiting{false};
+    std::uint64_t flush_requested{0};
+    std::uint64_t flushed{0};
+    bool stopping{false};
+
+    std::thread writer;
+};
+}
+}
+
+#endif // MIR_LOGGING_ASYNC_LOGGER_H_
@@ -0,0 +1,347 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_PROTOBUF_WIRE_CODEC_H
+#define MIR_PROTOBUF_WIRE_CODEC_H
+
+#include "mir_protobuf_wire.pb.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+#if GOOGLE_PROTOBUF_VERSION >= 3014000
+#include <google/protobuf/arena.h>
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace protobuf
+{
+/// A length-delimited field of a received message, left in the receive buffer
+struct WireBytes
+{
+    unsigned char const* data{nullptr};
+    size_t size{0};
+
+    /// Decodes the field as a nested message
+    bool parse_into(google::protobuf::MessageLite& message) const
+    {
+        return message.ParseFromArray(data, static_cast<int>(size));
+    }
+};
+
+namespace wire_codec
+{
+using google::protobuf::internal::WireFormatLite;
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::io::CodedOutputStream;
+
+inline bool read_bytes(CodedInputStream& input, WireBytes& bytes)
+{
+    uint32_t length;
+    if (!input.ReadVarint32(&length))
+        return false;
+
+    bytes = WireBytes{};
+    if (length == 0)
+        return true;
+
+    void const* data;
+    int available;
+    if (!input.GetDirectBufferPointer(&data, &available) ||
+        static_cast<uint32_t>(available) < length)
+    {
+        return false;
+    }
+
+    bytes.data = static_cast<unsigned char const*>(data);
+    bytes.size = length;
+    return input.Skip(length);
+}
+
+inline bool is_bytes(uint32_t tag)
+{
+    return WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
+}
+
+inline bool is_varint(uint32_t tag)
+{
+    return WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_VARINT;
+}
+}
+
+/**
+ * The fields of a serialized wire::Invocation.
+ *
+ * Unlike wire::Invocation::ParseFromArray() the parameters are not copied;
+ * they refer into the buffer passed to parse(), which must outlive them.
+ * Reusing one view keeps the capacity of method_name between messages.
+ */
+struct InvocationView
+{
+    uint32_t id{0};
+    std::string method_name;
+    WireBytes parameters;
+    bool has_protocol_version{false};
+    uint32_t protocol_version{0};
+    uint32_t side_channel_fds{0};
+
+    bool parse(void const* data, size_t size)
+    {
+        using namespace wire_codec;
+        using Invocation = wire::Invocation;
+
+        id = 0;
+        method_name.clear();
+        parameters = WireBytes{};
+        has_protocol_version = false;
+        protocol_version = 0;
+        side_channel_fds = 0;
+
+        CodedInputStream input{static_cast<uint8_t const*>(data), static_cast<int>(size)};
+
+        while (auto const tag = input.ReadTag())
+        {
+            bool ok;
+            switch (WireFormatLite::GetTagFieldNumber(tag))
+            {
+            case Invocation::kIdFieldNumber:
+                ok = is_varint(tag) && input.ReadVarint32(&id);
+                break;
+
+            case Invocation::kMethodNameFieldNumber:
+            {
+                WireBytes name;
+                ok = is_bytes(tag) && read_bytes(input, name);
+                if (ok)
+                    method_name.assign(reinterpret_cast<char const*>(name.data), name.size);
+                break;
+            }
+
+            case Invocation::kParametersFieldNumber:
+                ok = is_bytes(tag) && read_bytes(input, parameters);
+                break;
+
+            case Invocation::kProtocolVersionFieldNumber:
+                ok = is_varint(tag) && input.ReadVarint32(&protocol_version);
+                has_protocol_version = ok;
+                break;
+
+            case Invocation::kSideChannelFdsFieldNumber:
+                ok = is_varint(tag) && input.ReadVarint32(&side_channel_fds);
+                break;
+
+            default:
+                ok = WireFormatLite::SkipField(&input, tag);
+                break;
+            }
+
+            if (!ok)
+                return false;
+        }
+
+        return input.ConsumedEntireMessage();
+    }
+};
+
+/**
+ * The fields of a serialized wire::Result.
+ *
+ * As with InvocationView, the response and events refer into the buffer
+ * passed to parse(), so each is decoded exactly once: straight into the
+ * message that consumes it.
+ */
+struct ResultView
+{
+    bool has_id{false};
+    uint32_t id{0};
+    WireBytes response;
+    std::vector<WireBytes> events;
+
+    bool parse(void const* data, size_t size)
+    {
+        using namespace wire_codec;
+        using Result = wire::Result;
+
+        has_id = false;
+        id = 0;
+        response = WireBytes{};
+        events.clear();
+
+        CodedInputStream input{static_cast<uint8_t const*>(data), static_cast<int>(size)};
+
+        while (auto const tag = input.ReadTag())
+        {
+            bool ok;
+            switch (WireFormatLite::GetTagFieldNumber(tag))
+            {
+            case Result::kIdFieldNumber:
+                ok = is_varint(tag) && input.ReadVarint32(&id);
+                has_id = ok;
+                break;
+
+            case Result::kResponseFieldNumber:
+                ok = is_bytes(tag) && read_bytes(input, response);
+                break;
+
+            case Result::kEventsFieldNumber:
+                events.emplace_back();
+                ok = is_bytes(tag) && read_bytes(input, events.back());
+                break;
+
+            default:
+                ok = WireFormatLite::SkipField(&input, tag);
+                break;
+            }
+
+            if (!ok)
+                return false;
+        }
+
+        return input.ConsumedEntireMessage();
+    }
+};
+
+/**
+ * Writes a wire::Result around a payload that is serialized in place.
+ *
+ * This produces the same bytes as setting the payload on a wire::Result and
+ * serializing that, without first serializing the payload to a temporary.
+ */
+class ResultEnvelope
+{
+public:
+    /// A Result with the payload as its response
+    static ResultEnvelope response(uint32_t id, size_t payload_size)
+    {
+        return ResultEnvelope{true, id, wire::Result::kResponseFieldNumber, payload_size};
+    }
+
+    /// A Result with the payload as its only event
+    static ResultEnvelope event(size_t payload_size)
+    {
+        return ResultEnvelope{false, 0, wire::Result::kEventsFieldNumber, payload_size};
+    }
+
+    /// The size of the whole serialized Result
+    size_t size() const
+    {
+        return header_size + payload_size;
+    }
+
+    /// Writes the Result header, returning where the payload goes
+    unsigned char* write_header(unsigned char* target) const
+    {
+        using namespace wire_codec;
+
+        if (has_id)
+            target = WireFormatLite::WriteUInt32ToArray(wire::Result::kIdFieldNumber, id, target);
+
+        target = WireFormatLite::WriteTagToArray(field, WireFormatLite::WIRETYPE_LENGTH_DELIMITED, target);
+        return CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(payload_size), target);
+    }
+
+private:
+    ResultEnvelope(bool has_id, uint32_t id, int field, size_t payload_size) :
+        has_id{has_id},
+        id{id},
+        field{field},
+        payload_size{payload_size},
+        header_size{
+            (has_id ? wire_codec::WireFormatLite::TagSize(wire::Result::kIdFieldNumber, wire_codec::WireFormatLite::TYPE_UINT32) +
+                      wire_codec::CodedOutputStream::VarintSize32(id) : 0) +
+            wire_codec::WireFormatLite::TagSize(field, wire_codec::WireFormatLite::TYPE_BYTES) +
+            wire_codec::CodedOutputStream::VarintSize32(static_cast<uint32_t>(payload_size))}
+    {
+    }
+
+    bool const has_id;
+    uint32_t const id;
+    int const field;
+    size_t const payload_size;
+    size_t const header_size;
+};
+
+/**
+ * Storage for the messages decoded from (or built in reply to) one wire message.
+ *
+ * Messages from create() stay valid until the next reset(). With a protobuf
+ * that allows arena allocation of every message the messages, and their
+ * strings and nested messages, come from one arena whose first block is
+ * reused between wire messages; so decoding a typical message doesn't touch
+ * the heap at all. Otherwise each message is an ordinary heap allocation.
+ */
+class MessageArena
+{
+public:
+    MessageArena()
+#if GOOGLE_PROTOBUF_VERSION >= 3014000
+        : arena{arena_options(initial_block)}
+#endif
+    {
+    }
+
+    template<typename Message>
+    Message* create()
+    {
+#if GOOGLE_PROTOBUF_VERSION >= 3014000
+        return google::protobuf::Arena::CreateMessage<Message>(&arena);
+#else
+        auto const message = new Message;
+        messages.emplace_back(message);
+        return message;
+#endif
+    }
+
+    /// Releases every message from create()
+    void reset()
+    {
+#if GOOGLE_PROTOBUF_VERSION >= 3014000
+        arena.Reset();
+#else
+        messages.clear();
+#endif
+    }
+
+private:
+    MessageArena(MessageArena const&) = delete;
+    MessageArena& operator=(MessageArena const&) = delete;
+
+#if GOOGLE_PROTOBUF_VERSION >= 3014000
+    static google::protobuf::ArenaOptions arena_options(std::array<char, 4096>& block)
+    {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = block.data();
+        options.initial_block_size = block.size();
+        return options;
+    }
+
+    alignas(std::max_align_t) std::array<char, 4096> initial_block;
+    google::protobuf::Arena arena;
+#else
+    std::vector<std::unique_ptr<google::protobuf::MessageLite>> messages;
+#endif
+};
+}
+}
+
+#endif /* MIR_PROTOBUF_WIRE_CODEC_H */
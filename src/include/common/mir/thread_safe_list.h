@@ -20,29 +20,49 @@
 #ifndef MIR_THREAD_SAFE_LIST_H_
 #define MIR_THREAD_SAFE_LIST_H_
 
-#include "mir/recursive_read_write_mutex.h"
-
 #include <atomic>
-#include <functional>
+#include <cstdint>
+#include <thread>
 
 namespace mir
 {
+namespace detail
+{
+/// A for_each() frame of some ThreadSafeList on the current thread
+struct ThreadSafeListVisit
+{
+    void const* item;
+    ThreadSafeListVisit const* outer;
+};
+
+/// The current thread's innermost visit. (This lives in mircommon so that all
+/// modules see the same thread-local, whichever instantiated the list.)
+auto thread_safe_list_visits() -> ThreadSafeListVisit const*&;
+}
 
 /*
  * Requirements for type 'Element'
  *  - for_each():
- *    - copy-assignable
+ *    - copy-constructible
+ *    - conversion to bool: elements that convert to false are skipped
  *  - add():
  *    - copy-assignable
- *    - conversion to bool: indicates whether this is a valid element
  *  - remove(), remove_all():
  *    - copy-assignable
- *    - Element{}: default construction should create an invalid element
+ *    - Element{}: value initialization (used to release removed elements)
  *    - bool operator==: equality of elements
- *    - bool operator!=: inequality of elements
  *  - clear():
  *    - copy-assignable
- *    - Element{}: value initialization should create an invalid element
+ *    - Element{}: value initialization (used to release removed elements)
+ *
+ * for_each() neither locks nor allocates: each item carries a count of the
+ * threads currently visiting it, and a removal waits for that count to drain
+ * before releasing the element. So once remove() returns no *other* thread is
+ * still calling into the removed element, while the thread doing the removal
+ * may do so from inside for_each() (including for the element being removed).
+ *
+ * Items are never freed while the list exists; removed items are reused by
+ * later add()s.
  */
 
 template<class Element>
@@ -53,37 +73,98 @@ public:
     void remove(Element const& element);
     unsigned int remove_all(Element const& element);
     void clear();
-    void for_each(std::function<void(Element const& element)> const& f);
+    template<typename F>
+    void for_each(F const& f);
 
 private:
+    // The low bits of ListItem::state are one of these, the remaining bits
+    // count the times the item has been claimed (so that a removal can
+    // detect that the item has been reused since it compared the element).
+    enum : uint64_t
+    {
+        unused = 0,
+        claimed = 1,
+        live = 2,
+        removing = 3,
+        tag_mask = 3,
+        generation_increment = 4
+    };
+
     struct ListItem
     {
         ListItem() {}
-        RecursiveReadWriteMutex mutex;
+        std::atomic<uint64_t> state{unused};
+        std::atomic<unsigned int> visitors{0};
         Element element{};
         std::atomic<ListItem*> next{nullptr};
 
         ~ListItem() { delete next.load(); }
     } head;
+
+    class VisitGuard;
+
+    auto try_claim(ListItem* item) -> bool;
+    auto try_remove_if(ListItem* item, Element const& element) -> bool;
+    auto try_remove(ListItem* item, uint64_t state) -> bool;
 };
 
 template<class Element>
-void ThreadSafeList<Element>::for_each(
-    std::function<void(Element const& element)> const& f)
+class ThreadSafeList<Element>::VisitGuard
 {
-    ListItem* current_item = &head;
+public:
+    explicit VisitGuard(ListItem* item) :
+        item{item},
+        innermost{detail::thread_safe_list_visits()},
+        visit{item, innermost}
+    {
+        item->visitors.fetch_add(1);
+        innermost = &visit;
+    }
 
-    while (current_item)
+    ~VisitGuard()
     {
-        RecursiveReadLock lock{current_item->mutex};
+        innermost = visit.outer;
+        item->visitors.fetch_sub(1);
+    }
+
+private:
+    VisitGuard(VisitGuard const&) = delete;
+    VisitGuard& operator=(VisitGuard const&) = delete;
+
+    ListItem* const item;
+    // The items this thread is visiting form an intrusive stack of these, so
+    // that a removal from inside for_each() doesn't wait for itself
+    detail::ThreadSafeListVisit const*& innermost;
+    detail::ThreadSafeListVisit const visit;
+};
 
-        // We need to take a copy in case we recursively remove during call
-        if (auto const copy_of_element = current_item->element) f(copy_of_element);
+template<class Element>
+template<typename F>
+void ThreadSafeList<Element>::for_each(F const& f)
+{
+    for (ListItem* current_item = &head; current_item; current_item = current_item->next)
+    {
+        // Announce the visit *before* checking the state: a removal changes
+        // the state *before* checking for visitors, so one of us sees the other.
+        VisitGuard const guard{current_item};
 
-        current_item = current_item->next;
+        if ((current_item->state.load() & tag_mask) == live)
+        {
+            // We need to take a copy in case we recursively remove during call
+            if (Element const copy_of_element = current_item->element) f(copy_of_element);
+        }
     }
 }
 
+template<class Element>
+auto ThreadSafeList<Element>::try_claim(ListItem* item) -> bool
+{
+    auto state = item->state.load();
+
+    return (state & tag_mask) == unused &&
+        item->state.compare_exchange_strong(state, (state + generation_increment) | claimed);
+}
+
 template<class Element>
 void ThreadSafeList<Element>::add(Element const& element)
 {
@@ -91,26 +172,19 @@ void ThreadSafeList<Element>::add(Element const& element)
 
     do
     {
-        // Note: we release the read lock to avoid two threads calling add at
-        // the same time mutually blocking the other's upgrade to write lock.
-        {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element) continue;
-        }
-
-        RecursiveWriteLock lock{current_item->mutex};
-
-        if (!current_item->element)
+        if (try_claim(current_item))
         {
             current_item->element = element;
+            current_item->state.fetch_add(live - claimed);
             return;
         }
     }
     while (current_item->next && (current_item = current_item->next));
 
-    // No empty Items so append a new one
+    // No unused Items so append a new one
     auto new_item = new ListItem;
     new_item->element = element;
+    new_item->state = generation_increment | live;
 
     for (ListItem* expected{nullptr};
         !current_item->next.compare_exchange_weak(expected, new_item);
@@ -120,6 +194,41 @@ void ThreadSafeList<Element>::add(Element const& element)
     }
 }
 
+template<class Element>
+auto ThreadSafeList<Element>::try_remove_if(ListItem* item, Element const& element) -> bool
+{
+    uint64_t state;
+    {
+        VisitGuard const guard{item};
+
+        state = item->state.load();
+        if ((state & tag_mask) != live || !(item->element == element)) return false;
+    }
+
+    return try_remove(item, state);
+}
+
+template<class Element>
+auto ThreadSafeList<Element>::try_remove(ListItem* item, uint64_t state) -> bool
+{
+    if (!item->state.compare_exchange_strong(state, (state & ~tag_mask) | removing))
+        return false;
+
+    unsigned int own_visits{0};
+    for (auto visit = detail::thread_safe_list_visits(); visit; visit = visit->outer)
+    {
+        if (visit->item == item) ++own_visits;
+    }
+
+    // Wait for other threads to finish with the element
+    while (item->visitors.load() != own_visits)
+        std::this_thread::yield();
+
+    item->element = Element{};
+    item->state.store(state & ~tag_mask);
+    return true;
+}
+
 template<class Element>
 void ThreadSafeList<Element>::remove(Element const& element)
 {
@@ -127,18 +236,7 @@ void ThreadSafeList<Element>::remove(Element const& element)
 
     do
     {
-        {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element != element) continue;
-        }
-
-        RecursiveWriteLock lock{current_item->mutex};
-
-        if (current_item->element == element)
-        {
-            current_item->element = Element{};
-            return;
-        }
+        if (try_remove_if(current_item, element)) return;
     }
     while ((current_item = current_item->next));
 }
@@ -151,18 +249,7 @@ unsigned int ThreadSafeList<Element>::remove_all(Element const& element)
 
     do
     {
-        {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element != element) continue;
-        }
-
-        RecursiveWriteLock lock{current_item->mutex};
-
-        if (current_item->element == element)
-        {
-            current_item->element = Element{};
-            ++removed;
-        }
+        if (try_remove_if(current_item, element)) ++removed;
     }
     while ((current_item = current_item->next));
 
@@ -176,8 +263,8 @@ void ThreadSafeList<Element>::clear()
 
     do
     {
-        RecursiveWriteLock lock{current_item->mutex};
-        current_item->element = Element{};
+        auto const state = current_item->state.load();
+        if ((state & tag_mask) == live) try_remove(current_item, state);
     }
     while ((current_item = current_item->next));
 }
@@ -24,6 +24,7 @@
 #include "mir/frontend/buffer_stream.h"
 #include "mir_toolkit/common.h"
 #include "mir/graphics/buffer_id.h"
+#include "mir/compositor/frame_statistics.h"
 
 #include <memory>
 
@@ -32,6 +33,7 @@ namespace mir
 namespace graphics
 {
 class Buffer;
+struct TextureBounds;
 }
 
 namespace compositor
@@ -45,10 +47,18 @@ public:
     virtual auto lock_compositor_buffer(void const* user_id) -> std::shared_ptr<graphics::Buffer> = 0;
     /// Logical size of the stream (may be different than buffer sizes if scaled)
     virtual auto stream_size() -> geometry::Size = 0;
+    /// The part of buffer that is shown, as set by the viewport it was submitted with
+    virtual auto texture_bounds(graphics::Buffer const& buffer) const -> graphics::TextureBounds = 0;
     virtual auto buffers_ready_for_compositor(void const* user_id) const -> int = 0;
     virtual void drop_old_buffers() = 0;
     virtual auto has_submitted_buffer() const -> bool = 0;
     virtual auto framedropping() const -> bool = 0;
+
+    /// The buffer user_id last locked has been drawn into a frame
+    virtual void frame_composited(void const* user_id) = 0;
+    /// The frame user_id last drew the stream into has been posted to the display
+    virtual void frame_presented(void const* user_id) = 0;
+    virtual auto frame_statistics() const -> FrameStatistics = 0;
 };
 
 }
@@ -21,6 +21,7 @@
 
 namespace mir
 {
+namespace graphics { class DisplaySyncGroup; }
 namespace compositor
 {
 
@@ -32,6 +33,21 @@ public:
     virtual void start() = 0;
     virtual void stop() = 0;
 
+    /**
+     * Stop compositing to a DisplaySyncGroup that the Display is about to destroy.
+     *
+     * Returns once nothing is using \p group; compositing to other groups continues.
+     * The default implementation stops all compositing.
+     */
+    virtual void stop_compositing_to(graphics::DisplaySyncGroup& /*group*/) { stop(); }
+
+    /**
+     * Start compositing to any of the Display's DisplaySyncGroups that are not being
+     * composited (following stop_compositing_to() and a reconfiguration).
+     * The default implementation (re)starts all compositing.
+     */
+    virtual void start_compositing_to_new_groups() { start(); }
+
 protected:
     Compositor() = default;
     Compositor(Compositor const&) = delete;
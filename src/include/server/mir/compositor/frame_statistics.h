@@ -0,0 +1,70 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_FRAME_STATISTICS_H_
+#define MIR_COMPOSITOR_FRAME_STATISTICS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace mir
+{
+namespace compositor
+{
+/// When one frame reached each stage on its way to the display (a default time_point if it didn't)
+struct FrameTimestamps
+{
+    /// The client submitted the buffer
+    std::chrono::steady_clock::time_point committed;
+    /// A compositor first took the buffer
+    std::chrono::steady_clock::time_point acquired;
+    /// The buffer was first drawn into a frame (or handed to the display as it is)
+    std::chrono::steady_clock::time_point composited;
+    /// The first frame the buffer was drawn into was posted to the display
+    std::chrono::steady_clock::time_point presented;
+};
+
+/// The frame pacing of a buffer stream
+struct FrameStatistics
+{
+    /// Since the stream was created
+    uint64_t frames_committed{0};
+    /// Since the stream was created
+    uint64_t frames_presented{0};
+    /// Frames replaced by a newer one before any compositor took them
+    uint64_t frames_missed{0};
+
+    /// Buffers submitted that are waiting for the compositor
+    unsigned queued_buffers{0};
+
+    /// The most recent frames (at most 64), oldest first
+    std::vector<FrameTimestamps> recent_frames;
+};
+
+/// The frame pacing of a surface's main buffer stream
+struct SurfaceFrameStatistics
+{
+    pid_t pid;
+    std::string name;
+    FrameStatistics frames;
+};
+}
+}
+
+#endif /* MIR_COMPOSITOR_FRAME_STATISTICS_H_ */
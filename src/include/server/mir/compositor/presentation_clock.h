@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_PRESENTATION_CLOCK_H_
+#define MIR_COMPOSITOR_PRESENTATION_CLOCK_H_
+
+#include "mir/optional_value.h"
+#include "mir/time/types.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace mir
+{
+namespace time
+{
+class Clock;
+}
+namespace compositor
+{
+/**
+ * Predicts when the compositor will next post a frame.
+ *
+ * Each compositing thread notes when it posts a frame; the interval between
+ * consecutive frames (ignoring gaps where nothing was drawn) gives an
+ * estimate of the refresh period. Compositing only happens while something
+ * changes, so there is no prediction once frames stop coming.
+ *
+ * All members are threadsafe.
+ */
+class PresentationClock
+{
+public:
+    using SourceId = void const*;  // e.g. the compositing thread
+
+    explicit PresentationClock(std::shared_ptr<time::Clock> const& clock);
+
+    void frame_posted(SourceId source);
+    void source_removed(SourceId source);
+
+    /// When the next frame will be posted, if frames are currently being posted
+    auto next_frame() const -> optional_value<time::Timestamp>;
+
+private:
+    PresentationClock(PresentationClock const&) = delete;
+    PresentationClock& operator=(PresentationClock const&) = delete;
+
+    struct Source
+    {
+        time::Timestamp last_frame;
+        time::Duration period;
+    };
+
+    std::shared_ptr<time::Clock> const clock;
+
+    std::mutex mutable mutex;
+    std::unordered_map<SourceId, Source> sources;
+};
+}
+}
+
+#endif /* MIR_COMPOSITOR_PRESENTATION_CLOCK_H_ */
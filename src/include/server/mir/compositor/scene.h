@@ -69,6 +69,12 @@ public:
      */
     virtual int frames_pending(CompositorID id) const = 0;
 
+    /**
+     * Tell the scene that the frame last composited from the elements for
+     * id has been posted to the display.
+     */
+    virtual void frame_presented(CompositorID id) = 0;
+
     virtual void register_compositor(CompositorID id) = 0;
     virtual void unregister_compositor(CompositorID id) = 0;
 
@@ -55,6 +55,7 @@ class Drawer;
 class DisplayBufferCompositorFactory;
 class Compositor;
 class CompositorReport;
+class PresentationClock;
 }
 namespace frontend
 {
@@ -257,6 +258,7 @@ public:
      *  @{ */
     virtual std::shared_ptr<graphics::GraphicBufferAllocator> the_buffer_allocator();
     virtual std::shared_ptr<compositor::Scene>                  the_scene();
+    virtual std::shared_ptr<compositor::PresentationClock>      the_presentation_clock();
     /** @} */
 
     /** @name frontend configuration - dependencies
@@ -441,6 +443,7 @@ protected:
     CachedPtr<compositor::DisplayBufferCompositorFactory> display_buffer_compositor_factory;
     CachedPtr<compositor::Compositor> compositor;
     CachedPtr<compositor::CompositorReport> compositor_report;
+    CachedPtr<compositor::PresentationClock> presentation_clock;
     CachedPtr<logging::Logger> logger;
     CachedPtr<graphics::DisplayReport> display_report;
     CachedPtr<time::Clock> clock;
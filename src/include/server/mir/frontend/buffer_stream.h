@@ -22,6 +22,7 @@
 #include <mir_toolkit/common.h>
 #include "mir/graphics/buffer_id.h"
 #include "mir/geometry/size.h"
+#include <experimental/optional>
 #include <functional>
 #include <memory>
 
@@ -31,6 +32,7 @@ namespace graphics
 {
 class Buffer;
 struct BufferProperties;
+struct TextureBounds;
 }
 
 namespace frontend
@@ -55,6 +57,19 @@ public:
     //      side once we only support the NBS system.
     virtual void allow_framedropping(bool) = 0;
     virtual void set_scale(float scale) = 0;
+    /**
+     * Show only part of each buffer, optionally stretched to a logical size.
+     *
+     * The bounds apply to the buffers submitted after this call, so buffers
+     * already queued are still shown as they were submitted.
+     *
+     * \param [in] bounds  the part of each buffer to show
+     * \param [in] size    the logical size to show it at, or unset to use the
+     *                     (scaled) size of the buffer
+     */
+    virtual void set_viewport(
+        graphics::TextureBounds const& bounds,
+        std::experimental::optional<geometry::Size> const& size) = 0;
 protected:
     BufferStream() = default;
     BufferStream(BufferStream const&) = delete;
@@ -21,18 +21,13 @@
 
 #include <google/protobuf/stubs/common.h>
 
+#include "mir/protobuf/wire_codec.h"
+
 #include <mir/fd.h>
 #include <vector>
 
 namespace mir
 {
-namespace protobuf
-{
-namespace wire
-{
-class Invocation;
-}
-}
 namespace frontend
 {
 namespace detail
@@ -40,14 +35,22 @@ namespace detail
 class Invocation
 {
 public:
-    Invocation(mir::protobuf::wire::Invocation const& invocation) :
-        invocation(invocation) {}
+    Invocation(mir::protobuf::InvocationView const& invocation, mir::protobuf::MessageArena& arena) :
+        invocation(invocation), arena(arena) {}
 
     const ::std::string& method_name() const;
-    const ::std::string& parameters() const;
     google::protobuf::uint32 id() const;
+
+    /// Decodes the parameters straight from the receive buffer
+    bool parse_parameters(google::protobuf::MessageLite& message) const;
+
+    /// Creates a message that lives until the next invocation is received
+    template<typename Message>
+    Message* make_message() const { return arena.create<Message>(); }
+
 private:
-    mir::protobuf::wire::Invocation const& invocation;
+    mir::protobuf::InvocationView const& invocation;
+    mir::protobuf::MessageArena& arena;
 };
 
 class MessageProcessor
@@ -57,10 +57,10 @@ void invoke(
         ::google::protobuf::Closure* done),
         Invocation const& invocation)
 {
-    ParameterMessage parameter_message;
-    if (!parameter_message.ParseFromString(invocation.parameters()))
+    auto const parameter_message = invocation.make_message<ParameterMessage>();
+    if (!invocation.parse_parameters(*parameter_message))
         BOOST_THROW_EXCEPTION(std::runtime_error("Failed to parse message parameters!"));
-    ResultMessage result_message;
+    auto const result_message = invocation.make_message<ResultMessage>();
 
     try
     {
@@ -72,11 +72,11 @@ void invoke(
                     self,
                     &Self::send_response,
                     invocation.id(),
-                    &result_message));
+                    result_message));
 
         (server->*function)(
-            &parameter_message,
-            &result_message,
+            parameter_message,
+            result_message,
             callback.get());
     }
     catch (mir::cookie::SecurityCheckError const& /*err*/)
@@ -85,17 +85,17 @@ void invoke(
     }
     catch (mir::ClientVisibleError const& error)
     {
-        auto client_error = result_message.mutable_structured_error();
+        auto client_error = result_message->mutable_structured_error();
         client_error->set_code(error.code());
         client_error->set_domain(error.domain());
-        self->send_response(invocation.id(), &result_message);
+        self->send_response(invocation.id(), result_message);
     }
     catch (std::exception const& x)
     {
         using namespace std::literals::string_literals;
-        result_message.set_error("Error processing request: "s +
+        result_message->set_error("Error processing request: "s +
             x.what() + "\nInternal error details: " + boost::diagnostic_information(x));
-        self->send_response(invocation.id(), &result_message);
+        self->send_response(invocation.id(), result_message);
     }
 }
 
@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_CLIENT_TRAFFIC_H_
+#define MIR_FRONTEND_WAYLAND_CLIENT_TRAFFIC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+namespace mir
+{
+namespace frontend
+{
+/// The Wayland protocol traffic of one connected client
+struct WaylandClientTraffic
+{
+    pid_t pid;
+
+    /// Requests received from the client since it connected
+    uint64_t requests;
+    /// Events sent to the client since it connected
+    uint64_t events;
+
+    /// Over the most recent sampling interval
+    double requests_per_second;
+    /// Over the most recent sampling interval
+    double events_per_second;
+
+    /// Approximate bytes sent to the client that it has not yet read
+    size_t queued_bytes;
+
+    /// Frame callbacks the client has requested that are not yet done
+    unsigned pending_frame_callbacks;
+
+    /// Whether frame callbacks are being held back until the client catches up
+    bool throttled;
+};
+}
+}
+
+#endif /* MIR_FRONTEND_WAYLAND_CLIENT_TRAFFIC_H_ */
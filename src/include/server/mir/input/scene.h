@@ -25,6 +25,7 @@
 
 namespace mir
 {
+namespace geometry { struct Rectangle; }
 namespace scene
 {
 class Observer;
@@ -59,6 +60,10 @@ public:
     // TODO: How can something like SurfaceObserver be adapted to work with non surface renderables?
     virtual void emit_scene_changed() = 0;
 
+    // As emit_scene_changed(), for a change confined to damage (e.g. a cursor moving): only the
+    // outputs showing it need recomposing.
+    virtual void emit_scene_damaged(geometry::Rectangle const& damage) = 0;
+
 protected:
     Scene() = default;
     Scene(Scene const&) = delete;
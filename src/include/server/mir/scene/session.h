@@ -72,6 +72,8 @@ public:
     virtual void send_input_config(MirInputConfig const& config) = 0;
 
     virtual void take_snapshot(SnapshotCallback const& snapshot_taken) = 0;
+    /// A snapshot scaled down (keeping its aspect ratio) to fit within max_size, e.g. for a thumbnail
+    virtual void take_snapshot(geometry::Size const& max_size, SnapshotCallback const& snapshot_taken) = 0;
     virtual auto default_surface() const -> std::shared_ptr<Surface> = 0;
     virtual void set_lifecycle_state(MirLifecycleState state) = 0;
 
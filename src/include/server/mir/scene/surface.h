@@ -23,6 +23,7 @@
 #include "mir/input/surface.h"
 #include "mir/frontend/surface.h"
 #include "mir/compositor/compositor_id.h"
+#include "mir/compositor/frame_statistics.h"
 #include "mir/optional_value.h"
 
 #include <vector>
@@ -66,6 +67,10 @@ public:
 
     virtual graphics::RenderableList generate_renderables(compositor::CompositorID id) const = 0; 
     virtual int buffers_ready_for_compositor(void const* compositor_id) const = 0;
+    /// The frame last composited from the renderables generated for id has been posted to the display
+    virtual void frame_presented(compositor::CompositorID id) = 0;
+    /// Of the surface's main buffer stream
+    virtual auto frame_statistics() const -> compositor::FrameStatistics = 0;
 
     virtual MirWindowType type() const = 0;
     virtual MirWindowState state() const = 0;
@@ -34,7 +34,7 @@ namespace mir
 template<class Observer>
 class ObserverRegistrar;
 
-namespace compositor { class Compositor; class DisplayBufferCompositorFactory; class CompositorReport; }
+namespace compositor { class Compositor; class DisplayBufferCompositorFactory; class CompositorReport; struct SurfaceFrameStatistics; }
 namespace graphics { class Cursor; class Platform; class Display; class GLConfig; class DisplayConfigurationPolicy; class DisplayConfigurationObserver; }
 namespace input { class CompositeEventFilter; class InputDispatcher; class CursorListener; class CursorImages; class TouchVisualizer; class InputDeviceHub;}
 namespace logging { class Logger; }
@@ -44,6 +44,7 @@ namespace frontend
 class SessionAuthorizer;
 class SessionMediatorObserver;
 class MirClientSession;
+struct WaylandClientTraffic;
 }
 namespace cookie
 {
@@ -491,6 +492,12 @@ public:
     /// Get the name of the X11 display usable as a $DISPLAY value
     auto x11_display() const -> optional_value<std::string>;
 
+    /// Get the protocol traffic of each connected Wayland client (sampled twice a second)
+    auto wayland_client_traffic() const -> std::vector<frontend::WaylandClientTraffic>;
+
+    /// Get the recent frame timings of each surface, from commit to presentation
+    auto surface_frame_statistics() const -> std::vector<compositor::SurfaceFrameStatistics>;
+
     /// Overrides the standard set of Wayland extensions (mir::frontend::get_standard_extensions()) with a new list
     void set_enabled_wayland_extensions(std::vector<std::string> const& extensions);
 /** @} */
@@ -42,6 +42,7 @@ char const* const position = "position";
 char const* const mode = "mode";
 char const* const orientation = "orientation";
 char const* const scale = "scale";
+char const* const adaptive_sync = "adaptive-sync";
 char const* const orientation_value[] = { "normal", "left", "inverted", "right" };
 
 auto as_string(MirOrientation orientation) -> char const*
@@ -236,6 +237,15 @@ try
                         output_config.scale = s.as<float>();
                     }
 
+                    if (auto const a = port_config[adaptive_sync])
+                    {
+                        auto const adaptive_sync = a.as<std::string>();
+                        if (adaptive_sync != state_enabled && adaptive_sync != state_disabled)
+                            throw mir::AbnormalExit{error_prefix + "invalid 'adaptive-sync' (" +
+                                                    adaptive_sync + ") for port: " + port_name};
+                        output_config.adaptive_sync = (adaptive_sync == state_enabled);
+                    }
+
                     layout_config[output_id] = output_config;
                 }
             }
@@ -348,6 +358,9 @@ void miral::StaticDisplayConfig::apply_to(mg::DisplayConfiguration& conf)
                 {
                     conf_output.orientation = conf.orientation.value();
                 }
+
+                conf_output.vrr_enabled = conf_output.vrr_capable &&
+                    (!conf.adaptive_sync.is_set() || conf.adaptive_sync.value());
             }
             else
             {
@@ -386,6 +399,12 @@ void miral::StaticDisplayConfig::apply_to(mg::DisplayConfiguration& conf)
                            "\n        # orientation: " << as_string(conf_output.orientation)
                         << "\t# {normal, left, right, inverted}, defaults to normal"
                            "\n        # scale: " << conf_output.scale;
+
+                    if (conf_output.vrr_capable)
+                    {
+                        out << "\n        # adaptive-sync: " << (conf_output.vrr_enabled ? state_enabled : state_disabled)
+                            << "\t# {enabled, disabled}, defaults to enabled";
+                    }
                 }
             }
             else
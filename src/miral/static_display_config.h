@@ -58,6 +58,7 @@ private:
         mir::optional_value<double> refresh;
         mir::optional_value<float>  scale;
         mir::optional_value<MirOrientation>  orientation;
+        mir::optional_value<bool>   adaptive_sync;
     };
 
     using Id2Config = std::map<Id, Config>;
@@ -24,7 +24,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <dirent.h>
+#include <unistd.h>
 
 /*
  * From libXcursor/include/X11/extensions/Xcursor.h
@@ -212,61 +212,12 @@ XcursorImageCreate (int width, int height)
     return image;
 }
 
-static void
+void
 XcursorImageDestroy (XcursorImage *image)
 {
     free (image);
 }
 
-static XcursorImages *
-XcursorImagesCreate (int size)
-{
-    XcursorImages   *images;
-
-    images = malloc (sizeof (XcursorImages) +
-		     size * sizeof (XcursorImage *));
-    if (!images)
-	return NULL;
-    images->nimage = 0;
-    images->images = (XcursorImage **) (images + 1);
-    images->name = NULL;
-    return images;
-}
-
-void
-XcursorImagesDestroy (XcursorImages *images)
-{
-    int	n;
-
-    if (!images)
-        return;
-
-    for (n = 0; n < images->nimage; n++)
-	XcursorImageDestroy (images->images[n]);
-    if (images->name)
-	free (images->name);
-    free (images);
-}
-
-static void
-XcursorImagesSetName (XcursorImages *images, const char *name)
-{
-    char    *new;
-
-    if (!images || !name)
-        return;
-
-    new = malloc (strlen (name) + 1);
-
-    if (!new)
-	return;
-
-    strcpy (new, name);
-    if (images->name)
-	free (images->name);
-    images->name = new;
-}
-
 static XcursorBool
 _XcursorReadUInt (XcursorFile *file, XcursorUInt *u)
 {
@@ -510,93 +461,101 @@ _XcursorReadImage (XcursorFile		*file,
     return image;
 }
 
-static XcursorImages *
-XcursorXcFileLoadImages (XcursorFile *file, int size)
-{
-    XcursorFileHeader	*fileHeader;
-    XcursorDim		bestSize;
-    int			nsize;
-    XcursorImages	*images;
-    int			n;
-    int			toc;
+/*
+ * Reading cursors already in memory (e.g. mmap()ed files) rather than through stdio
+ */
 
-    if (!file || size < 0)
-	return NULL;
-    fileHeader = _XcursorReadFileHeader (file);
-    if (!fileHeader)
-	return NULL;
-    bestSize = _XcursorFindBestSize (fileHeader, (XcursorDim) size, &nsize);
-    if (!bestSize)
-    {
-        _XcursorFileHeaderDestroy (fileHeader);
-	return NULL;
-    }
-    images = XcursorImagesCreate (nsize);
-    if (!images)
-    {
-        _XcursorFileHeaderDestroy (fileHeader);
-	return NULL;
-    }
-    for (n = 0; n < nsize; n++)
-    {
-	toc = _XcursorFindImageToc (fileHeader, bestSize, n);
-	if (toc < 0)
-	    break;
-	images->images[images->nimage] = _XcursorReadImage (file, fileHeader,
-							    toc);
-	if (!images->images[images->nimage])
-	    break;
-	images->nimage++;
-    }
-    _XcursorFileHeaderDestroy (fileHeader);
-    if (images->nimage != nsize)
-    {
-	XcursorImagesDestroy (images);
-	images = NULL;
-    }
-    return images;
-}
+typedef struct _XcursorMemoryFile {
+    const unsigned char	*data;
+    size_t		length;
+    size_t		position;
+} XcursorMemoryFile;
 
 static int
-_XcursorStdioFileRead (XcursorFile *file, unsigned char *buf, int len)
+_XcursorMemoryFileRead (XcursorFile *file, unsigned char *buf, int len)
 {
-    FILE    *f = file->closure;
-    return fread (buf, 1, len, f);
+    XcursorMemoryFile	*memory = file->closure;
+    size_t		available = memory->length - memory->position;
+
+    if (len <= 0)
+	return 0;
+    if ((size_t) len > available)
+	len = available;
+    memcpy (buf, memory->data + memory->position, len);
+    memory->position += len;
+    return len;
 }
 
 static int
-_XcursorStdioFileWrite (XcursorFile *file, unsigned char *buf, int len)
+_XcursorMemoryFileWrite (XcursorFile *file, unsigned char *buf, int len)
 {
-    FILE    *f = file->closure;
-    return fwrite (buf, 1, len, f);
+    (void) file;
+    (void) buf;
+    (void) len;
+    return 0;
 }
 
 static int
-_XcursorStdioFileSeek (XcursorFile *file, long offset, int whence)
+_XcursorMemoryFileSeek (XcursorFile *file, long offset, int whence)
 {
-    FILE    *f = file->closure;
-    return fseek (f, offset, whence);
-}
+    XcursorMemoryFile	*memory = file->closure;
+    long		base;
 
-static void
-_XcursorStdioFileInitialize (FILE *stdfile, XcursorFile *file)
-{
-    file->closure = stdfile;
-    file->read = _XcursorStdioFileRead;
-    file->write = _XcursorStdioFileWrite;
-    file->seek = _XcursorStdioFileSeek;
+    switch (whence)
+    {
+    case SEEK_SET: base = 0; break;
+    case SEEK_CUR: base = memory->position; break;
+    case SEEK_END: base = memory->length; break;
+    default: return EOF;
+    }
+    if (offset < -base || (size_t) (base + offset) > memory->length)
+	return EOF;
+    memory->position = base + offset;
+    return 0;
 }
 
-static XcursorImages *
-XcursorFileLoadImages (FILE *file, int size)
+/** Decode one cursor image from an Xcursor file held in memory
+ *
+ * Only the first image (the first animation frame) of the nominal size
+ * closest to \p size is decoded; the rest of the file is never touched.
+ *
+ * \return the image, to be freed with XcursorImageDestroy(), or NULL
+ * if the data is not a valid cursor file.
+ */
+XcursorImage *
+xcursor_load_image_from_memory (const unsigned char *data, size_t length, int size)
 {
-    XcursorFile	f;
+    XcursorMemoryFile	memory;
+    XcursorFile		file;
+    XcursorFileHeader	*fileHeader;
+    XcursorDim		bestSize;
+    int			nsize;
+    int			toc;
+    XcursorImage	*image = NULL;
 
-    if (!file)
-        return NULL;
+    if (!data || size < 0)
+	return NULL;
+
+    memory.data = data;
+    memory.length = length;
+    memory.position = 0;
+    file.closure = &memory;
+    file.read = _XcursorMemoryFileRead;
+    file.write = _XcursorMemoryFileWrite;
+    file.seek = _XcursorMemoryFileSeek;
 
-    _XcursorStdioFileInitialize (file, &f);
-    return XcursorXcFileLoadImages (&f, size);
+    fileHeader = _XcursorReadFileHeader (&file);
+    if (!fileHeader)
+	return NULL;
+    bestSize = _XcursorFindBestSize (fileHeader, (XcursorDim) size, &nsize);
+    if (bestSize)
+    {
+	toc = _XcursorFindImageToc (fileHeader, bestSize, 0);
+	if (toc >= 0)
+	    image = _XcursorReadImage (&file, fileHeader, toc);
+    }
+    _XcursorFileHeaderDestroy (fileHeader);
+    return image;
 }
 
 /*
@@ -789,98 +748,34 @@ _XcursorThemeInherits (const char *full)
     return result;
 }
 
-static void
-load_all_cursors_from_dir(const char *path, int size,
-			  void (*load_callback)(XcursorImages *, void *),
-			  void *user_data)
-{
-	FILE *f;
-	DIR *dir = opendir(path);
-	struct dirent *ent;
-	char *full;
-	XcursorImages *images;
-
-	if (!dir)
-		return;
-
-	for(ent = readdir(dir); ent; ent = readdir(dir)) {
-#ifdef _DIRENT_HAVE_D_TYPE
-		if (ent->d_type != DT_UNKNOWN &&
-		    (ent->d_type != DT_REG && ent->d_type != DT_LNK))
-			continue;
-#endif
-
-		full = _XcursorBuildFullname(path, "", ent->d_name);
-		if (!full)
-			continue;
-
-		f = fopen(full, "r");
-		if (!f) {
-			free(full);
-			continue;
-		}
-
-		images = XcursorFileLoadImages(f, size);
+/* Guards against themes that (indirectly) inherit from themselves */
+#define XCURSOR_MAX_INHERITS_DEPTH 32
 
-		if (images) {
-			XcursorImagesSetName(images, ent->d_name);
-			load_callback(images, user_data);
-		}
-
-		fclose (f);
-		free(full);
-	}
-
-	closedir(dir);
-}
-
-/** Load all the cursor of a theme
- *
- * This function loads all the cursor images of a given theme and its
- * inherited themes. Each cursor is loaded into an XcursorImages object
- * which is passed to the caller's load callback. If a cursor appears
- * more than once across all the inherited themes, the load callback
- * will be called multiple times, with possibly different XcursorImages
- * object which have the same name. The user is expected to destroy the
- * XcursorImages objects passed to the callback with
- * XcursorImagesDestroy().
- *
- * \param theme The name of theme that should be loaded
- * \param size The desired size of the cursor images
- * \param load_callback A callback function that will be called
- * for each cursor loaded. The first parameter is the XcursorImages
- * object representing the loaded cursor and the second is a pointer
- * to data provided by the user.
- * \param user_data The data that should be passed to the load callback
- */
-void
-xcursor_load_theme(const char *theme, int size,
-		    void (*load_callback)(XcursorImages *, void *),
-		    void *user_data)
+static char *
+_XcursorFindThemeFile (const char *theme, const char *name, int depth)
 {
 	char *full, *dir;
 	char *inherits = NULL;
+	char *found = NULL;
 	const char *path, *i;
 
-	if (!theme)
-		theme = "default";
+	if (depth > XCURSOR_MAX_INHERITS_DEPTH)
+		return NULL;
 
 	for (path = XcursorLibraryPath();
-	     path;
+	     path && !found;
 	     path = _XcursorNextPath(path)) {
 		dir = _XcursorBuildThemeDir(path, theme);
 		if (!dir)
 			continue;
 
-		full = _XcursorBuildFullname(dir, "cursors", "");
-
-		if (full) {
-			load_all_cursors_from_dir(full, size, load_callback,
-						  user_data);
+		full = _XcursorBuildFullname(dir, "cursors", name);
+		if (full && access(full, R_OK) == 0)
+			found = full;
+		else
 			free(full);
-		}
 
-		if (!inherits) {
+		if (!found && !inherits) {
 			full = _XcursorBuildFullname(dir, "", "index.theme");
 			if (full) {
 				inherits = _XcursorThemeInherits(full);
@@ -891,9 +786,34 @@ xcursor_load_theme(const char *theme, int size,
 		free(dir);
 	}
 
-	for (i = inherits; i; i = _XcursorNextPath(i))
-		xcursor_load_theme(i, size, load_callback, user_data);
+	for (i = inherits; i && !found; i = _XcursorNextPath(i))
+		found = _XcursorFindThemeFile(i, name, depth + 1);
 
 	if (inherits)
 		free(inherits);
+
+	return found;
+}
+
+/** Find the file for a single cursor of a theme
+ *
+ * The theme directories on the Xcursor search path are tried in order,
+ * followed by the themes it inherits, and the first file found wins. No
+ * cursor files are opened.
+ *
+ * \param theme The name of the theme to search
+ * \param name The name of the cursor, which must not contain '/'
+ * \return the path of the cursor file, to be freed with free(), or
+ * NULL if the theme has no such cursor
+ */
+char *
+xcursor_find_theme_file(const char *theme, const char *name)
+{
+	if (!theme)
+		theme = "default";
+
+	if (!name || strchr(name, '/'))
+		return NULL;
+
+	return _XcursorFindThemeFile(theme, name, 0);
 }
@@ -23,6 +23,7 @@
 #ifndef XCURSOR_H
 #define XCURSOR_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 
@@ -43,20 +44,12 @@ typedef struct _XcursorImage {
     XcursorPixel    *pixels;	/* pointer to pixels */
 } XcursorImage;
 
-/*
- * Other data structures exposed by the library API
- */
-typedef struct _XcursorImages {
-    int		    nimage;	/* number of images */
-    XcursorImage    **images;	/* array of XcursorImage pointers */
-    char	    *name;	/* name used to load images */
-} XcursorImages;
-
 void
-XcursorImagesDestroy (XcursorImages *images);
+XcursorImageDestroy (XcursorImage *image);
 
-void
-xcursor_load_theme(const char *theme, int size,
-		    void (*load_callback)(XcursorImages *, void *),
-		    void *user_data);
+char *
+xcursor_find_theme_file(const char *theme, const char *name);
+
+XcursorImage *
+xcursor_load_image_from_memory (const unsigned char *data, size_t length, int size);
 #endif
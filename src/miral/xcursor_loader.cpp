@@ -19,11 +19,15 @@
 #include "xcursor_loader.h"
 
 #include <mir/graphics/cursor_image.h>
+#include <mir/fd.h>
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
 
+#include <fcntl.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <mir_toolkit/cursors.h>
 
@@ -36,22 +40,24 @@ extern "C"
 }
 
 namespace mg = mir::graphics;
-namespace mi = mir::input;
 namespace geom = mir::geometry;
 
 namespace
 {
+/// Plenty for the names Mir itself asks for, while bounding what clients can make us remember
+auto const max_missing_images = 256u;
+
 class XCursorImage : public mg::CursorImage
 {
 public:
-    XCursorImage(_XcursorImage *image, std::shared_ptr<_XcursorImages> const& save_resource)
-        : image(image),
-          save_resource(save_resource)
+    explicit XCursorImage(_XcursorImage *image)
+        : image(image)
     {
     }
 
     ~XCursorImage()
     {
+        XcursorImageDestroy(image);
     }
 
     void const* as_argb_8888() const override
@@ -68,10 +74,37 @@ public:
     }
 
 private:
-    _XcursorImage *image;
-    std::shared_ptr<_XcursorImages> const save_resource;
+    XCursorImage(XCursorImage const&) = delete;
+    XCursorImage& operator=(XCursorImage const&) = delete;
+
+    _XcursorImage* const image;
 };
 
+// Maps the file rather than reading it, so only the pages holding the header and the image we want are touched
+auto load_image_file(char const* path, uint32_t nominal_size) -> std::shared_ptr<mg::CursorImage>
+{
+    mir::Fd const fd{open(path, O_RDONLY | O_CLOEXEC)};
+    if (fd == mir::Fd::invalid)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        return nullptr;
+
+    auto const length = static_cast<size_t>(info.st_size);
+    auto const data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    auto const image = xcursor_load_image_from_memory(static_cast<unsigned char const*>(data), length, nominal_size);
+    munmap(data, length);
+
+    if (!image)
+        return nullptr;
+
+    return std::make_shared<XCursorImage>(image);
+}
+
 std::string const
 xcursor_name_for_mir_cursor(std::string const& mir_cursor_name)
 {
@@ -142,74 +175,68 @@ xcursor_name_for_mir_cursor(std::string const& mir_cursor_name)
 }
 }
 
-miral::XCursorLoader::XCursorLoader()
+miral::XCursorLoader::XCursorLoader() :
+    XCursorLoader{"default"}
 {
-    load_cursor_theme("default");
 }
 
-miral::XCursorLoader::XCursorLoader(std::string const& theme)
+miral::XCursorLoader::XCursorLoader(std::string const& theme) :
+    theme{theme}
 {
-    load_cursor_theme(theme);
 }
 
-// Each XcursorImages represents images for the different sizes of a given symbolic cursor.
-void miral::XCursorLoader::load_appropriately_sized_image(_XcursorImages *images)
+auto miral::XCursorLoader::image_locked(
+    std::lock_guard<std::mutex> const&,
+    std::string const& xcursor_name,
+    uint32_t size) -> std::shared_ptr<mg::CursorImage>
 {
-    // We would rather take this lock in load_cursor_theme but the Xcursor lib style
-    // makes it difficult to use our standard 'pass the lg around to _locked members' pattern
-    std::lock_guard<std::mutex> lg(guard);
+    auto const key = std::make_pair(xcursor_name, size);
 
-    // We have to save all the images as XCursor expects us to free them.
-    // This contains the actual image data though, so we need to ensure they stay alive
-    // with the lifetime of the mg::CursorImage instance which refers to them.
-    auto saved_xcursor_library_resource = std::shared_ptr<_XcursorImages>(images, [](_XcursorImages *images)
-        {
-            XcursorImagesDestroy(images);
-        });
+    auto const cached = loaded_images.find(key);
+    if (cached != loaded_images.end())
+        return cached->second;
 
-    for (int i = 0; i < images->nimage; i++)
+    if (missing_images.count(key))
+        return nullptr;
+
+    std::shared_ptr<mg::CursorImage> image;
+
+    std::unique_ptr<char, decltype(&free)> const path{
+        xcursor_find_theme_file(theme.c_str(), xcursor_name.c_str()),
+        &free};
+    if (path)
+        image = load_image_file(path.get(), size);
+
+    if (image)
     {
-        _XcursorImage *candidate = images->images[i];
-        if (candidate->width == mi::default_cursor_size.width.as_uint32_t() &&
-            candidate->height == mi::default_cursor_size.height.as_uint32_t())
-        {
-            loaded_images[std::string(images->name)] = std::make_shared<XCursorImage>(candidate, saved_xcursor_library_resource);
-            return;
-        }
+        loaded_images[key] = image;
     }
+    else
+    {
+        if (missing_images.size() >= max_missing_images)
+            missing_images.clear();
 
-    loaded_images[std::string(images->name)] = std::make_shared<XCursorImage>(images->images[0], saved_xcursor_library_resource);
-}
+        missing_images.insert(key);
+    }
 
-void miral::XCursorLoader::load_cursor_theme(std::string const& theme_name)
-{
-    // Cursors are named by their square dimension...called the nominal size in XCursor terminology, so we just look up by width.
-    // Later we verify the actual size.
-    xcursor_load_theme(theme_name.c_str(), mi::default_cursor_size.width.as_uint32_t(),
-        [](XcursorImages* images, void *this_ptr)  -> void
-        {
-            // Can't use lambda capture as this lambda is thunked to a C function ptr
-            auto p = static_cast<miral::XCursorLoader*>(this_ptr);
-            p->load_appropriately_sized_image(images);
-        }, this);
+    return image;
 }
 
 std::shared_ptr<mg::CursorImage> miral::XCursorLoader::image(
     std::string const& cursor_name,
-    geom::Size const& /*size*/)
+    geom::Size const& size)
 {
     auto xcursor_name = xcursor_name_for_mir_cursor(cursor_name);
 
+    // Cursors are named by their square dimension...called the nominal size in XCursor terminology, so we just look
+    // up by width. The closest size the theme has is used.
+    auto const nominal_size = size.width.as_uint32_t();
+
     std::lock_guard<std::mutex> lg(guard);
 
-    auto it = loaded_images.find(xcursor_name);
-    if (it != loaded_images.end())
-        return it->second;
+    if (auto const image = image_locked(lg, xcursor_name, nominal_size))
+        return image;
 
     // Fall back
-    it = loaded_images.find("arrow");
-    if (it != loaded_images.end())
-        return it->second;
-
-    return nullptr;
+    return image_locked(lg, "arrow", nominal_size);
 }
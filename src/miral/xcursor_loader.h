@@ -26,17 +26,16 @@
 #include <string>
 #include <map>
 #include <mutex>
-
-// Unfortunately this library does not compile as C++ so we can not namespace it.
-extern "C"
-{
-struct _XcursorImages;
-}
+#include <set>
+#include <utility>
 
 namespace mir { namespace graphics { class CursorImage; } }
 
 namespace miral
 {
+/// Loads cursor images from an XCursor theme as they are asked for
+/// Each cursor file is read (via mmap()) and decoded at most once for each size, and the images are cached so
+/// every cursor shown, whether software or hardware, shares the same decoded pixels.
 class XCursorLoader : public mir::input::CursorImages
 {
 public:
@@ -53,12 +52,18 @@ protected:
     XCursorLoader& operator=(XCursorLoader const&) = delete;
 
 private:
+    std::string const theme;
+
     std::mutex guard;
 
-    std::map<std::string, std::shared_ptr<mir::graphics::CursorImage>> loaded_images;
+    /// Keyed by XCursor name and nominal size
+    std::map<std::pair<std::string, uint32_t>, std::shared_ptr<mir::graphics::CursorImage>> loaded_images;
+
+    /// Cursors the theme doesn't have. Clients choose the names, so this is forgotten whenever it fills up.
+    std::set<std::pair<std::string, uint32_t>> missing_images;
 
-    void load_cursor_theme(std::string const& theme_name);
-    void load_appropriately_sized_image(_XcursorImages *images);
+    auto image_locked(std::lock_guard<std::mutex> const&, std::string const& xcursor_name, uint32_t size)
+        -> std::shared_ptr<mir::graphics::CursorImage>;
 };
 }
 
@@ -16,33 +16,40 @@
  * Authored by: Daniel van Vugt <daniel.van.vugt@canonical.com>
  */
 
-#include "mir/graphics/renderable.h"
-#include "mir/graphics/display_buffer.h"
-#include "bypass.h"
+#include "mir/graphics/direct_scanout.h"
 
-using namespace mir;
-namespace mgg = mir::graphics::gbm;
+#include <algorithm>
 
-mgg::BypassMatch::BypassMatch(geometry::Rectangle const& rect)
-    : view_area(rect),
-      bypass_is_feasible(true),
+namespace mg = mir::graphics;
+
+mg::ScanoutMatch::ScanoutMatch(geometry::Rectangle const& view_area)
+    : view_area(view_area),
+      scanout_is_feasible(true),
       identity(1)
 {
 }
 
-bool mgg::BypassMatch::operator()(std::shared_ptr<graphics::Renderable> const& renderable)
+bool mg::ScanoutMatch::operator()(std::shared_ptr<Renderable> const& renderable)
 {
-    //we've already eliminated bypass as a possibility
-    if (!bypass_is_feasible)
+    //we've already eliminated scanout as a possibility
+    if (!scanout_is_feasible)
         return false;
 
-    //offscreen surfaces don't affect if bypass is possible
+    //offscreen surfaces don't affect if scanout is possible
     if (!view_area.overlaps(renderable->screen_position()))
         return false;
 
     auto const is_opaque = !((renderable->alpha() != 1.0f) || renderable->shaped());
     auto const fits = (renderable->screen_position() == view_area);
     auto const is_orthogonal = (renderable->transformation() == identity);
-    bypass_is_feasible = (is_opaque && fits && is_orthogonal);
-    return bypass_is_feasible;
+    auto const is_uncropped = (renderable->texture_bounds() == TextureBounds{});
+    scanout_is_feasible = (is_opaque && fits && is_orthogonal && is_uncropped);
+    return scanout_is_feasible;
+}
+
+auto mg::scanout_candidate(RenderableList const& renderlist, geometry::Rectangle const& view_area)
+    -> std::shared_ptr<Renderable>
+{
+    auto const match = std::find_if(renderlist.rbegin(), renderlist.rend(), ScanoutMatch{view_area});
+    return match != renderlist.rend() ? *match : nullptr;
 }
@@ -20,6 +20,7 @@
 #include "mir/graphics/egl_wayland_allocator.h"
 
 #include <boost/throw_exception.hpp>
+#include <array>
 #include <mutex>
 
 #include "mir/graphics/egl_extensions.h"
@@ -27,6 +28,7 @@
 #include "mir/geometry/size.h"
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/buffer_basic.h"
+#include "mir/graphics/dmabuf_buffer.h"
 #include "mir/graphics/texture.h"
 #include "mir/renderer/gl/context.h"
 #include "mir/executor.h"
@@ -104,7 +106,8 @@ EGLint get_wl_egl_format(wl_resource* resource, mg::EGLExtensions::WaylandExtens
 class WaylandTexBuffer :
     public mg::BufferBasic,
     public mg::NativeBufferBase,
-    public mg::gl::Texture
+    public mg::gl::Texture,
+    public mg::DMABufBuffer
 {
 public:
     // Note: Must be called with a current EGL context
@@ -122,7 +125,9 @@ public:
           size_{get_wl_buffer_size(buffer, *extensions.wayland)},
           layout_{get_texture_layout(buffer, *extensions.wayland)},
           egl_format{get_wl_egl_format(buffer, *extensions.wayland)},
-          wayland_executor{std::move(wayland_executor)}
+          wayland_executor{std::move(wayland_executor)},
+          dpy{eglGetCurrentDisplay()},
+          destroy_image{extensions.eglDestroyImageKHR}
     {
         if (egl_format != EGL_TEXTURE_RGB && egl_format != EGL_TEXTURE_RGBA)
         {
@@ -137,7 +142,7 @@ public:
                 EGL_NONE
             };
 
-        auto egl_image = extensions.eglCreateImageKHR(
+        egl_image = extensions.eglCreateImageKHR(
             eglGetCurrentDisplay(),
             EGL_NO_CONTEXT,
             EGL_WAYLAND_BUFFER_WL,
@@ -154,9 +159,7 @@ public:
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        // tex is now an EGLImage sibling, so we can free the EGLImage without
-        // freeing the backing data.
-        extensions.eglDestroyImageKHR(eglGetCurrentDisplay(), egl_image);
+        // tex is an EGLImage sibling, so the EGLImage is only kept for dma_buf_export()
     }
 
     ~WaylandTexBuffer()
@@ -171,6 +174,7 @@ public:
               context->release_current();
             });
 
+        destroy_image(dpy, egl_image);
         on_release();
     }
 
@@ -238,16 +242,85 @@ public:
     void bind() override
     {
         glBindTexture(GL_TEXTURE_2D, tex);
+        mark_consumed();
+    }
+
+    void add_syncpoint() override
+    {
+    }
+
+    auto dma_buf_export() -> Export const* override
+    {
+        std::lock_guard<decltype(export_mutex)> lock{export_mutex};
+
+        if (!export_attempted)
+        {
+            export_attempted = true;
+            exported = export_image();
+        }
+
+        return exported ? &exported.value() : nullptr;
+    }
 
+    void mark_consumed() override
+    {
         std::lock_guard<decltype(consumed_mutex)> lock(consumed_mutex);
         on_consumed();
         on_consumed = [](){};
     }
 
-    void add_syncpoint() override
+private:
+    auto export_image() const -> std::experimental::optional<Export>
     {
+        std::experimental::optional<mg::EGLExtensions::MESAImageDMABufExport> dma_buf_ext;
+        try
+        {
+            dma_buf_ext.emplace(dpy);
+        }
+        catch (std::runtime_error const&)
+        {
+            return {};
+        }
+
+        int fourcc;
+        int num_planes;
+        EGLuint64KHR modifiers[4];
+        if (dma_buf_ext->eglExportDMABUFImageQueryMESA(dpy, egl_image, &fourcc, &num_planes, nullptr) != EGL_TRUE ||
+            num_planes < 1 || num_planes > 4 ||
+            dma_buf_ext->eglExportDMABUFImageQueryMESA(dpy, egl_image, &fourcc, &num_planes, modifiers) != EGL_TRUE)
+        {
+            return {};
+        }
+
+        std::array<int, 4> fds;
+        std::array<EGLint, 4> strides;
+        std::array<EGLint, 4> offsets;
+        fds.fill(mir::Fd::invalid);
+        if (dma_buf_ext->eglExportDMABUFImageMESA(dpy, egl_image, fds.data(), strides.data(), offsets.data()) != EGL_TRUE)
+            return {};
+
+        // Texture layouts are in GL coordinates, where y = 0 is the bottom row
+        Export result{
+            static_cast<uint32_t>(fourcc),
+            modifiers[0],
+            layout_ == Layout::TopRowFirst,
+            {}};
+
+        // Planes sharing a dma-buf are reported with an fd of -1
+        mir::Fd last_fd;
+        for (auto plane = 0; plane != num_planes; ++plane)
+        {
+            if (fds[plane] != mir::Fd::invalid)
+                last_fd = mir::Fd{fds[plane]};
+
+            result.planes.push_back(
+                Plane{last_fd, static_cast<uint32_t>(strides[plane]), static_cast<uint32_t>(offsets[plane])});
+        }
+
+        return result;
     }
-private:
+
+
     std::shared_ptr<mir::renderer::gl::Context> const ctx;
     GLuint const tex;
 
@@ -260,6 +333,14 @@ private:
     EGLint const egl_format;
 
     std::shared_ptr<mir::Executor> const wayland_executor;
+
+    EGLDisplay const dpy;
+    PFNEGLDESTROYIMAGEKHRPROC const destroy_image;
+    EGLImageKHR egl_image;
+
+    std::mutex export_mutex;
+    bool export_attempted{false};
+    std::experimental::optional<Export> exported;
 };
 }
 
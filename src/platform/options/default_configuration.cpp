@@ -43,17 +43,30 @@ char const* const mo::seat_report_opt            = "seat-report";
 char const* const mo::shared_library_prober_report_opt = "shared-library-prober-report";
 char const* const mo::shell_report_opt            = "shell-report";
 char const* const mo::offscreen_opt               = "offscreen";
+char const* const mo::renderer_opt                = "renderer";
+char const* const mo::gl_program_cache_opt        = "gl-program-cache";
 char const* const mo::touchspots_opt              = "enable-touchspots";
 char const* const mo::cursor_opt                  = "cursor";
 char const* const mo::fatal_except_opt            = "on-fatal-error-except";
 char const* const mo::debug_opt                   = "debug";
 char const* const mo::composite_delay_opt         = "composite-delay";
 char const* const mo::enable_key_repeat_opt       = "enable-key-repeat";
+char const* const mo::input_resampling_opt        = "input-resampling";
 char const* const mo::x11_display_opt             = "enable-x11";
 char const* const mo::wayland_extensions_opt      = "wayland-extensions";
 char const* const mo::enable_mirclient_opt        = "enable-mirclient";
+char const* const mo::wayland_client_queue_limit_opt = "wayland-client-queue-limit";
+char const* const mo::wayland_slow_client_policy_opt = "wayland-slow-client-policy";
 
 char const* const mo::off_opt_value = "off";
+char const* const mo::auto_opt_value = "auto";
+char const* const mo::gl_renderer_value = "gl";
+char const* const mo::software_renderer_value = "software";
+char const* const mo::throttle_opt_value = "throttle";
+char const* const mo::disconnect_opt_value = "disconnect";
+char const* const mo::touch_opt_value = "touch";
+char const* const mo::pointer_opt_value = "pointer";
+char const* const mo::all_opt_value = "all";
 char const* const mo::log_opt_value = "log";
 char const* const mo::lttng_opt_value = "lttng";
 
@@ -184,6 +197,22 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "Default: A negative value means decide automatically.")
         (offscreen_opt,
             "Render to offscreen buffers instead of the real outputs.")
+        (renderer_opt,
+            po::value<std::string>()->default_value(gl_renderer_value),
+            "Renderer used for compositing [{gl,software}]. "
+            "The software renderer composites on the CPU and requires --offscreen.")
+        (gl_program_cache_opt,
+            po::value<std::string>()->default_value(auto_opt_value),
+            "Where the GL renderer keeps its compiled programs between runs [{auto,off,<directory>}]. "
+            "auto uses $XDG_CACHE_HOME/mir (or $HOME/.cache/mir); off compiles them every time.")
+        (wayland_client_queue_limit_opt,
+            po::value<int>()->default_value(262144),
+            "Bytes a Wayland client may leave unread on its socket before it is treated as slow.")
+        (wayland_slow_client_policy_opt,
+            po::value<std::string>()->default_value(off_opt_value),
+            "What to do with a Wayland client that stays over its queue limit [{off,throttle,disconnect}]. "
+            "throttle holds back its frame callbacks until it catches up; "
+            "disconnect also disconnects it if it does not catch up.")
         (touchspots_opt,
             "Display visualization of touchspots (e.g. for screencasting).")
         (cursor_opt,
@@ -191,6 +220,10 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "Cursor (mouse pointer) to use [{auto,null,software}]")
         (enable_key_repeat_opt, po::value<bool>()->default_value(true),
              "Enable server generated key repeat")
+        (input_resampling_opt,
+            po::value<std::string>()->default_value(off_opt_value),
+            "Which devices' motion to resample to the display's frame rate [{off,touch,pointer,all}]. "
+            "Holds motion until shortly before each frame and delivers one position predicted for it.")
         (fatal_except_opt, "On \"fatal error\" conditions [e.g. drivers behaving "
             "in unexpected ways] throw an exception (instead of a core dump)")
         (debug_opt, "Enable extra development debugging. "
@@ -0,0 +1,170 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buffer_fences.h"
+
+#define MIR_LOG_COMPONENT "buffer-fences"
+#include "mir/log.h"
+
+#include <GLES2/gl2.h>
+
+#include <linux/sync_file.h>
+#include <sys/ioctl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+
+namespace
+{
+// Without native fences we wait on the CPU, so bound the wait to stop a misbehaving
+// client stalling composition indefinitely.
+std::chrono::milliseconds const cpu_acquire_timeout{100};
+}
+
+mgc::BufferFences::BufferFences(
+    EGLDisplay dpy,
+    std::shared_ptr<EGLExtensions::ANDROIDNativeFenceSync const> native_sync)
+    : dpy{dpy},
+      native_sync{std::move(native_sync)}
+{
+}
+
+void mgc::BufferFences::set_acquire_fence(Fd fence)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    acquire = std::move(fence);
+}
+
+void mgc::BufferFences::wait_for_acquire()
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    if (acquire == Fd::invalid)
+        return;
+
+    // Once the fence has signalled nobody needs to wait for it again
+    if (wait_for_fence(acquire, std::chrono::milliseconds{0}))
+    {
+        acquire = Fd{};
+        return;
+    }
+
+    if (native_sync)
+    {
+        // EGL takes ownership of the fd on success. We keep the original so that
+        // contexts on other outputs can wait for it too.
+        int const fd = dup(acquire);
+        EGLint const attribs[] = {EGL_SYNC_NATIVE_FENCE_FD_ANDROID, fd, EGL_NONE};
+        auto const sync = native_sync->eglCreateSyncKHR(dpy, EGL_SYNC_NATIVE_FENCE_ANDROID, attribs);
+        if (sync != EGL_NO_SYNC_KHR)
+        {
+            native_sync->eglWaitSyncKHR(dpy, sync, 0);
+            native_sync->eglDestroySyncKHR(dpy, sync);
+            return;
+        }
+
+        close(fd);
+        log_warning("Failed to import acquire fence; waiting for it on the CPU");
+    }
+
+    if (!wait_for_fence(acquire, cpu_acquire_timeout))
+    {
+        log_warning("Client buffer's acquire fence did not signal within %lldms",
+            static_cast<long long>(cpu_acquire_timeout.count()));
+    }
+    acquire = Fd{};
+}
+
+void mgc::BufferFences::add_release_point()
+{
+    if (!native_sync)
+        return;
+
+    EGLint const attribs[] = {EGL_SYNC_NATIVE_FENCE_FD_ANDROID, EGL_NO_NATIVE_FENCE_FD_ANDROID, EGL_NONE};
+    auto const sync = native_sync->eglCreateSyncKHR(dpy, EGL_SYNC_NATIVE_FENCE_ANDROID, attribs);
+    if (sync == EGL_NO_SYNC_KHR)
+    {
+        log_warning("Failed to create release fence");
+        return;
+    }
+
+    // The native fence only exists once the sync has been flushed to the GPU
+    glFlush();
+    Fd fence{native_sync->eglDupNativeFenceFDANDROID(dpy, sync)};
+    native_sync->eglDestroySyncKHR(dpy, sync);
+
+    if (fence == EGL_NO_NATIVE_FENCE_FD_ANDROID)
+    {
+        log_warning("Failed to export release fence");
+        return;
+    }
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    release = merge_fences(release, fence);
+}
+
+auto mgc::BufferFences::release_fence() const -> Fd
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    return release;
+}
+
+auto mgc::wait_for_fence(Fd const& fence, std::chrono::milliseconds timeout) -> bool
+{
+    if (fence == Fd::invalid)
+        return true;
+
+    // A sync_file polls readable once it has signalled
+    pollfd pfd{fence, POLLIN, 0};
+    int result;
+    do
+    {
+        result = poll(&pfd, 1, timeout.count());
+    }
+    while (result < 0 && (errno == EINTR || errno == EAGAIN));
+
+    if (result < 0)
+    {
+        log_warning("Failed to wait for fence: %s", strerror(errno));
+        return false;
+    }
+
+    return result > 0 && (pfd.revents & POLLIN);
+}
+
+auto mgc::merge_fences(Fd const& first, Fd const& second) -> Fd
+{
+    if (first == Fd::invalid)
+        return second;
+    if (second == Fd::invalid)
+        return first;
+
+    sync_merge_data data{};
+    strncpy(data.name, "mir-release", sizeof data.name - 1);
+    data.fd2 = second;
+    if (ioctl(first, SYNC_IOC_MERGE, &data) < 0)
+    {
+        // The later fence is the better approximation of "all reads are complete"
+        log_warning("Failed to merge fences: %s", strerror(errno));
+        return second;
+    }
+
+    return Fd{data.fence};
+}
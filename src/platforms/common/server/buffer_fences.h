@@ -0,0 +1,81 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_COMMON_BUFFER_FENCES_H_
+#define MIR_GRAPHICS_COMMON_BUFFER_FENCES_H_
+
+#include "mir/fd.h"
+#include "mir/graphics/egl_extensions.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace mir
+{
+namespace graphics
+{
+namespace common
+{
+/**
+ * The explicit synchronisation state of a client buffer.
+ *
+ * With EGL_ANDROID_native_fence_sync the GPU waits for the acquire fence, and
+ * release fences are exported from the compositor's GL command stream, so
+ * neither side waits on the CPU. Without it the acquire fence is waited for on
+ * the CPU (for a bounded time) and there is no release fence.
+ */
+class BufferFences
+{
+public:
+    /**
+     * \param [in] dpy          the display of the contexts that will read the buffer
+     * \param [in] native_sync  the native fence extension, or null if unsupported
+     */
+    BufferFences(
+        EGLDisplay dpy,
+        std::shared_ptr<EGLExtensions::ANDROIDNativeFenceSync const> native_sync);
+
+    void set_acquire_fence(Fd fence);
+
+    /// Make the current context's subsequent commands wait for the acquire fence
+    void wait_for_acquire();
+
+    /// Mark the end of the current context's commands that read the buffer
+    void add_release_point();
+
+    /// A fence that signals once all the reads marked by add_release_point() have completed
+    auto release_fence() const -> Fd;
+
+private:
+    EGLDisplay const dpy;
+    std::shared_ptr<EGLExtensions::ANDROIDNativeFenceSync const> const native_sync;
+
+    std::mutex mutable mutex;
+    Fd acquire;
+    Fd release;
+};
+
+/// Whether the sync_file \a fence signals within \a timeout; an invalid fence counts as signalled
+auto wait_for_fence(Fd const& fence, std::chrono::milliseconds timeout) -> bool;
+
+/// A sync_file that signals once both \a first and \a second have; either may be invalid
+auto merge_fences(Fd const& first, Fd const& second) -> Fd;
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_COMMON_BUFFER_FENCES_H_ */
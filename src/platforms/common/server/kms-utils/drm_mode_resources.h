@@ -26,6 +26,7 @@
 #include <functional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace mir
 {
@@ -44,6 +45,14 @@ typedef std::unique_ptr<drmModeObjectProperties,void(*)(drmModeObjectProperties*
 typedef std::unique_ptr<drmModePropertyRes,void(*)(drmModePropertyPtr)> DRMModePropertyUPtr;
 
 DRMModeConnectorUPtr get_connector(int drm_fd, uint32_t id);
+/**
+ * Get the connector state the kernel already knows, without forcing a probe
+ *
+ * Unlike get_connector() this does not re-read the EDID or re-detect the
+ * connection status, so it is cheap enough to call from latency-sensitive
+ * threads. The modes are those found by the most recent full probe.
+ */
+DRMModeConnectorUPtr get_connector_current(int drm_fd, uint32_t id);
 DRMModeEncoderUPtr get_encoder(int drm_fd, uint32_t id);
 DRMModeCrtcUPtr get_crtc(int drm_fd, uint32_t id);
 DRMModePlaneUPtr get_plane(int drm_fd, uint32_t id);
@@ -148,6 +157,8 @@ public:
 
     size_t num_crtcs() const;
 
+    std::vector<uint32_t> connector_ids() const;
+
     DRMModeConnectorUPtr connector(uint32_t id) const;
     DRMModeEncoderUPtr encoder(uint32_t id) const;
     DRMModeCrtcUPtr crtc(uint32_t id) const;
@@ -299,6 +299,16 @@ void mgg::BufferAllocator::bind_display(wl_display* display, std::shared_ptr<Exe
     try
     {
         mg::EGLExtensions::EXTImageDmaBufImportModifiers modifier_ext{dpy};
+        std::shared_ptr<mg::EGLExtensions::ANDROIDNativeFenceSync const> native_sync;
+        try
+        {
+            native_sync = std::make_shared<mg::EGLExtensions::ANDROIDNativeFenceSync>(dpy);
+        }
+        catch (std::runtime_error const&)
+        {
+            mir::log_info(
+                "No EGL_ANDROID_native_fence_sync support, explicit sync fences will be waited for on the CPU");
+        }
         dmabuf_extension =
             std::unique_ptr<LinuxDmaBufUnstable, std::function<void(LinuxDmaBufUnstable*)>>(
                 new LinuxDmaBufUnstable{
@@ -306,6 +316,7 @@ void mgg::BufferAllocator::bind_display(wl_display* display, std::shared_ptr<Exe
                     dpy,
                     egl_extensions,
                     modifier_ext,
+                    std::move(native_sync),
                 },
                 [wayland_executor](LinuxDmaBufUnstable* global)
                 {
@@ -19,7 +19,7 @@
 #ifndef MIR_GRAPHICS_GBM_BYPASS_H_
 #define MIR_GRAPHICS_GBM_BYPASS_H_
 
-#include "mir/graphics/renderable.h"
+#include "mir/graphics/direct_scanout.h"
 
 namespace mir
 {
@@ -27,18 +27,8 @@ namespace graphics
 {
 namespace gbm
 {
-
-class BypassMatch
-{
-public:
-    BypassMatch(geometry::Rectangle const& rect);
-    bool operator()(std::shared_ptr<graphics::Renderable> const&);
-private:
-    geometry::Rectangle const view_area;
-    bool bypass_is_feasible;
-    glm::mat4 const identity;
-};
-
+/// Bypass is KMS scanning out the buffer of a renderable matched in the platform-neutral way
+using BypassMatch = graphics::ScanoutMatch;
 } // namespace gbm-kms
 } // namespace graphics
 } // namespace mir
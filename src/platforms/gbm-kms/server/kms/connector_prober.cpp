@@ -0,0 +1,186 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "connector_prober.h"
+#include "kms-utils/drm_mode_resources.h"
+
+#include "mir/log.h"
+#include "mir/thread_name.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <system_error>
+
+namespace mgg = mir::graphics::gbm;
+namespace mgk = mir::graphics::kms;
+
+namespace
+{
+mir::Fd make_completion_fd()
+{
+    mir::Fd fd{eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE | EFD_NONBLOCK)};
+    if (fd == mir::Fd::invalid)
+    {
+        BOOST_THROW_EXCEPTION((
+            std::system_error{errno, std::system_category(), "Failed to create connector probe eventfd"}));
+    }
+    return fd;
+}
+
+auto device_numbers(std::vector<int> const& drm_fds) -> std::vector<dev_t>
+{
+    std::vector<dev_t> devices;
+    for (auto const drm_fd : drm_fds)
+    {
+        struct stat info;
+        devices.push_back(fstat(drm_fd, &info) == 0 ? info.st_rdev : 0);
+    }
+    return devices;
+}
+
+/// The kernel replaces the EDID blob whenever it reads a different EDID
+auto edid_blob_id(int drm_fd, uint32_t connector_id) -> uint64_t
+{
+    mgk::ObjectProperties const properties{drm_fd, connector_id, DRM_MODE_OBJECT_CONNECTOR};
+    return properties.has_property("EDID") ? properties["EDID"] : 0;
+}
+}
+
+mgg::ConnectorProber::ConnectorProber(std::vector<int> const& drm_fds)
+    : drm_fds{drm_fds},
+      devices{device_numbers(drm_fds)},
+      completed{make_completion_fd()}
+{
+    for (auto const drm_fd : drm_fds)
+    {
+        try
+        {
+            mgk::DRMModeResources resources{drm_fd};
+            for (auto const id : resources.connector_ids())
+            {
+                auto const connector = mgk::get_connector_current(drm_fd, id);
+                connections[{drm_fd, id}] = {connector->connection, edid_blob_id(drm_fd, id)};
+            }
+        }
+        catch (std::exception const& error)
+        {
+            // The first request_probe() will probe everything on this device
+            mir::log_warning("Failed to read DRM connector state: %s", error.what());
+        }
+    }
+
+    worker = std::thread{[this] { run(); }};
+}
+
+mgg::ConnectorProber::~ConnectorProber()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    requested.notify_all();
+    worker.join();
+}
+
+void mgg::ConnectorProber::request_probe()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        probe_requested = true;
+    }
+    requested.notify_all();
+}
+
+void mgg::ConnectorProber::request_probe(dev_t device, uint32_t connector_id)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        probe_requested = true;
+
+        for (auto i = 0u; i != devices.size(); ++i)
+        {
+            if (devices[i] == device)
+                hotplugged_connectors.insert({drm_fds[i], connector_id});
+        }
+    }
+    requested.notify_all();
+}
+
+auto mgg::ConnectorProber::completion_fd() const -> mir::Fd
+{
+    return completed;
+}
+
+void mgg::ConnectorProber::run()
+{
+    mir::set_thread_name("Mir/KMS probe");
+
+    std::unique_lock<std::mutex> lock{mutex};
+
+    while (true)
+    {
+        requested.wait(lock, [this] { return stopping || probe_requested; });
+
+        if (stopping)
+            return;
+
+        probe_requested = false;
+        std::set<ConnectorKey> hotplugged;
+        swap(hotplugged, hotplugged_connectors);
+
+        lock.unlock();
+        probe_changed_connectors(hotplugged);
+        if (eventfd_write(completed, 1) != 0)
+        {
+            mir::log_warning("Failed to signal connector probe completion: %s", strerror(errno));
+        }
+        lock.lock();
+    }
+}
+
+void mgg::ConnectorProber::probe_changed_connectors(std::set<ConnectorKey> const& hotplugged)
+{
+    for (auto const drm_fd : drm_fds)
+    {
+        try
+        {
+            mgk::DRMModeResources resources{drm_fd};
+            for (auto const id : resources.connector_ids())
+            {
+                auto const current = mgk::get_connector_current(drm_fd, id);
+                auto const known = connections.find({drm_fd, id});
+
+                if (known == connections.end() ||
+                    known->second.status != current->connection ||
+                    known->second.edid_blob_id != edid_blob_id(drm_fd, id) ||
+                    current->connection == DRM_MODE_UNKNOWNCONNECTION ||
+                    hotplugged.count({drm_fd, id}))
+                {
+                    // Full probe; the kernel caches what it finds for get_connector_current()
+                    auto const probed = mgk::get_connector(drm_fd, id);
+                    connections[{drm_fd, id}] = {probed->connection, edid_blob_id(drm_fd, id)};
+                }
+            }
+        }
+        catch (std::exception const& error)
+        {
+            mir::log_warning("Failed to probe DRM connectors: %s", error.what());
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_GBM_CONNECTOR_PROBER_H_
+#define MIR_GRAPHICS_GBM_CONNECTOR_PROBER_H_
+
+#include "mir/fd.h"
+
+#include <xf86drmMode.h>
+#include <sys/types.h>
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+namespace gbm
+{
+
+/**
+ * Keeps the kernel's connector state fresh without blocking the caller.
+ *
+ * A full connector probe (drmModeGetConnector) re-reads the EDID and can take
+ * hundreds of milliseconds per connector. The prober instead compares the
+ * kernel's cached state with what it saw last time, and fully probes (on its
+ * own thread) only the connectors whose connection status or EDID changed,
+ * and those a hotplug event named. After that kms::get_connector_current()
+ * returns up-to-date modes.
+ */
+class ConnectorProber
+{
+public:
+    explicit ConnectorProber(std::vector<int> const& drm_fds);
+    ~ConnectorProber();
+
+    /**
+     * Ask for the connectors to be checked.
+     *
+     * Requests made before a pending check starts are served by that check.
+     */
+    void request_probe();
+
+    /**
+     * Ask for the connectors to be checked, and for one that a hotplug event
+     * named to be fully probed even if its state looks unchanged (a monitor
+     * may have been swapped for another).
+     *
+     * \param device       the DRM device's number
+     * \param connector_id the connector on that device
+     */
+    void request_probe(dev_t device, uint32_t connector_id);
+
+    /**
+     * An eventfd, in semaphore mode, that is signalled once each time a
+     * check finishes (however many requests it served).
+     */
+    auto completion_fd() const -> mir::Fd;
+
+private:
+    ConnectorProber(ConnectorProber const&) = delete;
+    ConnectorProber& operator=(ConnectorProber const&) = delete;
+
+    using ConnectorKey = std::pair<int, uint32_t>;  ///< DRM fd and connector id
+
+    /// What a connector's cached state was when last checked
+    struct Connection
+    {
+        drmModeConnection status;
+        uint64_t edid_blob_id;
+    };
+
+    void run();
+    void probe_changed_connectors(std::set<ConnectorKey> const& hotplugged);
+
+    std::vector<int> const drm_fds;
+    std::vector<dev_t> const devices;   ///< Of drm_fds, in the same order
+    mir::Fd const completed;
+
+    std::mutex mutex;
+    std::condition_variable requested;
+    bool probe_requested{false};
+    std::set<ConnectorKey> hotplugged_connectors;
+    bool stopping{false};
+
+    /// Only touched by the prober thread once it has started
+    std::map<ConnectorKey, Connection> connections;
+
+    std::thread worker;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_GBM_CONNECTOR_PROBER_H_ */
@@ -43,7 +43,10 @@
 #include "kms-utils/drm_mode_resources.h"
 #include "kms-utils/kms_connector.h"
 
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
+#include <sys/eventfd.h>
 #include <algorithm>
 #include <unordered_map>
 
@@ -90,6 +93,22 @@ std::vector<int> drm_fds_from_drm_helpers(
     return fds;
 }
 
+/// Whether the device behind drm_fd is the one gbm renders on
+bool is_render_device(mgg::helpers::GBMHelper const& gbm, int drm_fd)
+{
+    auto const primary_name =
+        [](int fd)
+        {
+            return std::unique_ptr<char, decltype(&free)>{drmGetPrimaryDeviceNameFromFd(fd), &free};
+        };
+
+    auto const render_device = primary_name(gbm_device_get_fd(gbm.device));
+    auto const output_device = primary_name(drm_fd);
+
+    // If we can't tell, assume the worst: that buffers must be shared
+    return render_device && output_device && strcmp(render_device.get(), output_device.get()) == 0;
+}
+
 double calculate_vrefresh_hz(drmModeModeInfo const& mode)
 {
     if (mode.htotal == 0 || mode.vtotal == 0)
@@ -200,6 +219,7 @@ mgg::Display::Display(std::vector<std::shared_ptr<helpers::DRMHelper>> const& dr
                   }
                   return flipper;
               })},
+      connector_prober{drm_fds_from_drm_helpers(drm)},
       current_display_configuration{output_container},
       dirty_configuration{false},
       bypass_option(bypass_option),
@@ -270,18 +290,43 @@ void mgg::Display::register_configuration_change_handler(
     EventHandlerRegister& handlers,
     DisplayConfigurationChangeHandler const& conf_change_handler)
 {
+    /*
+     * Connectors are probed off the main loop; the configuration only
+     * changes once the probe that a uevent triggers has completed.
+     */
     handlers.register_fd_handler(
-        {monitor.fd()},
+        {monitor.fd(), connector_prober.completion_fd()},
         this,
         make_module_ptr<std::function<void(int)>>(
-            [conf_change_handler, this](int)
+            [conf_change_handler, this](int fd)
             {
-                monitor.process_events([conf_change_handler, this]
-                                       (mir::udev::Monitor::EventType, mir::udev::Device const&)
-                                       {
-                                            dirty_configuration = true;
-                                            conf_change_handler();
-                                       });
+                if (fd == monitor.fd())
+                {
+                    monitor.process_events([this]
+                                           (mir::udev::Monitor::EventType, mir::udev::Device const& device)
+                                           {
+                                                // Newer kernels say which connector a hotplug was on
+                                                if (auto const connector = device.property("CONNECTOR"))
+                                                {
+                                                    connector_prober.request_probe(
+                                                        device.devnum(),
+                                                        strtoul(connector, nullptr, 10));
+                                                }
+                                                else
+                                                {
+                                                    connector_prober.request_probe();
+                                                }
+                                           });
+                }
+                else
+                {
+                    eventfd_t unused;
+                    if (eventfd_read(fd, &unused) == 0)
+                    {
+                        dirty_configuration = true;
+                        conf_change_handler();
+                    }
+                }
             }));
 }
 
@@ -392,6 +437,58 @@ std::unique_ptr<mir::renderer::gl::Context> mgg::Display::create_gl_context() co
     return std::make_unique<GBMGLContext>(*gbm, *gl_config, shared_egl.context());
 }
 
+void mgg::Display::configure_incrementally(
+    mg::DisplayConfiguration const& conf,
+    std::function<void(mg::DisplaySyncGroup&)> const& invalidating)
+{
+    if (!conf.valid())
+    {
+        BOOST_THROW_EXCEPTION(
+            std::logic_error("Invalid or inconsistent display configuration"));
+    }
+
+    auto const& kms_conf = dynamic_cast<RealKMSDisplayConfiguration const&>(conf);
+
+    /*
+     * Stopping compositing to a sync group waits for its compositor thread, which
+     * may itself be waiting for configuration_mutex (to move the cursor, or to
+     * enumerate the sync groups). So find the sync groups to be replaced, and
+     * report them, before taking the lock to replace them.
+     */
+    std::vector<mg::DisplaySyncGroup*> invalidated;
+    {
+        std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
+
+        if (!compatible(current_display_configuration, kms_conf))
+        {
+            auto const kept = kept_display_buffers_locked(kms_conf, lock);
+            for (auto i = 0u; i != display_buffers.size(); ++i)
+            {
+                if (!kept[i])
+                    invalidated.push_back(display_buffers[i].get());
+            }
+        }
+    }
+
+    for (auto const group : invalidated)
+        invalidating(*group);
+
+    {
+        std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
+
+        if (compatible(current_display_configuration, kms_conf))
+        {
+            configure_locked(kms_conf, lock);
+        }
+        else
+        {
+            configure_changed_outputs_locked(kms_conf, lock);
+        }
+    }
+
+    if (auto c = cursor.lock()) c->resume();
+}
+
 bool mgg::Display::apply_if_configuration_preserves_display_buffers(
     mg::DisplayConfiguration const& conf)
 {
@@ -445,6 +542,13 @@ void add_to_drm_device_group(
         grouping.push_back(std::vector<std::shared_ptr<mgg::KMSOutput>>{std::move(output)});
     }
 }
+
+auto outputs_of(mg::OverlappingOutputGroup const& group) -> std::vector<mg::DisplayConfigurationOutput>
+{
+    std::vector<mg::DisplayConfigurationOutput> outputs;
+    group.for_each_output([&](mg::DisplayConfigurationOutput const& output) { outputs.push_back(output); });
+    return outputs;
+}
 }
 
 void mgg::Display::configure_locked(
@@ -457,6 +561,7 @@ void mgg::Display::configure_locked(
         (&kms_conf != &current_display_configuration) &&
         compatible(kms_conf, current_display_configuration)};
     std::vector<std::unique_ptr<DisplayBuffer>> display_buffers_new;
+    std::vector<std::vector<DisplayConfigurationOutput>> display_buffer_outputs_new;
 
     if (!comp)
     {
@@ -488,83 +593,47 @@ void mgg::Display::configure_locked(
     grouping.for_each_group(
         [&](OverlappingOutputGroup const& group)
         {
-            auto bounding_rect = group.bounding_rectangle();
-            // Each vector<KMSOutput> is a single GPU memory domain
-            std::vector<std::vector<std::shared_ptr<KMSOutput>>> kms_output_groups;
-            glm::mat2 transformation;
-            geom::Size current_mode_resolution;
-
-            group.for_each_output(
-                [&](DisplayConfigurationOutput const& conf_output)
-                {
-                    auto kms_output = current_display_configuration.get_output_for(conf_output.id);
+            if (comp)
+            {
+                auto bounding_rect = group.bounding_rectangle();
+                glm::mat2 transformation;
 
-                    auto const mode_index = kms_conf.get_kms_mode_index(conf_output.id,
-                                                                  conf_output.current_mode_index);
-                    kms_output->configure(conf_output.top_left - bounding_rect.top_left, mode_index);
-                    if (!comp)
+                group.for_each_output(
+                    [&](DisplayConfigurationOutput const& conf_output)
                     {
-                        kms_output->set_power_mode(conf_output.power_mode);
-                        kms_output->set_gamma(conf_output.gamma);
-                        add_to_drm_device_group(kms_output_groups, std::move(kms_output));
-                    }
+                        auto kms_output = current_display_configuration.get_output_for(conf_output.id);
 
-                    /*
-                     * Presently OverlappingOutputGroup guarantees all grouped
-                     * outputs have the same transformation.
-                     */
-                    transformation = conf_output.transformation();
-                    if (conf_output.current_mode_index < conf_output.modes.size())
-                        current_mode_resolution = conf_output.modes[conf_output.current_mode_index].size;
-                });
+                        auto const mode_index = kms_conf.get_kms_mode_index(conf_output.id,
+                                                                      conf_output.current_mode_index);
+                        kms_output->configure(conf_output.top_left - bounding_rect.top_left, mode_index);
+                        kms_output->allow_variable_refresh(conf_output.vrr_enabled);
 
-            if (comp)
-            {
+                        /*
+                         * Presently OverlappingOutputGroup guarantees all grouped
+                         * outputs have the same transformation.
+                         */
+                        transformation = conf_output.transformation();
+                    });
+
+                display_buffer_outputs[group_idx] = outputs_of(group);
                 display_buffers[group_idx++]->set_transformation(transformation,
                                                                  bounding_rect);
             }
             else
             {
-                uint32_t const width  = current_mode_resolution.width.as_uint32_t();
-                uint32_t const height = current_mode_resolution.height.as_uint32_t();
-
-                for (auto const& group : kms_output_groups)
+                for (auto& db : create_display_buffers_locked(kms_conf, group))
                 {
-                    /*
-                     * In a hybrid setup a scanout surface needs to be allocated differently if it
-                     * needs to be able to be shared across GPUs. This likely reduces performance.
-                     *
-                     * As a first cut, assume every scanout buffer in a hybrid setup might need
-                     * to be shared.
-                     */
-                    auto surface = gbm->create_scanout_surface(width, height, drm.size() != 1);
-                    auto const raw_surface = surface.get();
-
-                    auto db = std::make_unique<DisplayBuffer>(
-                        bypass_option,
-                        listener,
-                        group,
-                        GBMOutputSurface{
-                            group.front()->drm_fd(),
-                            std::move(surface),
-                            width, height,
-                            helpers::EGLHelper{
-                                *gl_config,
-                                *gbm,
-                                raw_surface,
-                                shared_egl.context()
-                            }
-                        },
-                        bounding_rect,
-                        transformation);
-
                     display_buffers_new.push_back(std::move(db));
+                    display_buffer_outputs_new.push_back(outputs_of(group));
                 }
             }
         });
 
     if (!comp)
+    {
         display_buffers = std::move(display_buffers_new);
+        display_buffer_outputs = std::move(display_buffer_outputs_new);
+    }
 
     /* Store applied configuration */
     current_display_configuration = kms_conf;
@@ -573,3 +642,188 @@ void mgg::Display::configure_locked(
         /* Clear connected but unused outputs */
         clear_connected_unused_outputs();
 }
+
+auto mgg::Display::kept_display_buffers_locked(
+    mgg::RealKMSDisplayConfiguration const& kms_conf,
+    std::lock_guard<std::mutex> const&) const -> std::vector<bool>
+{
+    /*
+     * A display buffer survives if the new configuration has a group with
+     * exactly the outputs (and output settings) it was created for.
+     */
+    std::vector<bool> kept(display_buffers.size(), false);
+
+    OverlappingOutputGrouping{kms_conf}.for_each_group(
+        [&](OverlappingOutputGroup const& group)
+        {
+            auto const outputs = outputs_of(group);
+            for (auto i = 0u; i != display_buffers.size(); ++i)
+            {
+                if (display_buffer_outputs[i] == outputs)
+                    kept[i] = true;
+            }
+        });
+
+    return kept;
+}
+
+void mgg::Display::configure_changed_outputs_locked(
+    mgg::RealKMSDisplayConfiguration const& kms_conf,
+    std::lock_guard<std::mutex> const& lock)
+{
+    std::vector<OverlappingOutputGroup> groups;
+    OverlappingOutputGrouping{kms_conf}.for_each_group(
+        [&](OverlappingOutputGroup const& group) { groups.push_back(group); });
+
+    // configure_incrementally() has already reported the sync groups that aren't kept
+    auto kept = kept_display_buffers_locked(kms_conf, lock);
+    std::vector<DisplayConfigurationOutputId> untouched_outputs;
+
+    for (auto i = 0u; i != display_buffers.size(); ++i)
+    {
+        if (kept[i])
+        {
+            for (auto const& output : display_buffer_outputs[i])
+                untouched_outputs.push_back(output.id);
+        }
+    }
+
+    /*
+     * As in configure_locked(), don't let the new display buffers take over
+     * outputs with page flips pending for the old ones.
+     */
+    for (auto i = 0u; i != display_buffers.size(); ++i)
+    {
+        if (!kept[i])
+            display_buffers[i]->wait_for_page_flip();
+    }
+
+    /* Reset the state of the outputs being reconfigured */
+    kms_conf.for_each_output(
+        [&](DisplayConfigurationOutput const& conf_output)
+        {
+            if (std::find(untouched_outputs.begin(), untouched_outputs.end(), conf_output.id) ==
+                untouched_outputs.end())
+            {
+                auto kms_output = current_display_configuration.get_output_for(conf_output.id);
+                kms_output->clear_cursor();
+                kms_output->reset();
+            }
+        });
+
+    /* Keep display_buffers in grouping order, as configure_locked() relies on that */
+    decltype(display_buffers) display_buffers_new;
+    decltype(display_buffer_outputs) display_buffer_outputs_new;
+
+    for (auto const& group : groups)
+    {
+        auto const outputs = outputs_of(group);
+        bool reused{false};
+
+        for (auto i = 0u; i != display_buffers.size(); ++i)
+        {
+            if (kept[i] && display_buffer_outputs[i] == outputs)
+            {
+                display_buffers_new.push_back(std::move(display_buffers[i]));
+                display_buffer_outputs_new.push_back(outputs);
+                kept[i] = false;
+                reused = true;
+            }
+        }
+
+        if (!reused)
+        {
+            for (auto& db : create_display_buffers_locked(kms_conf, group))
+            {
+                display_buffers_new.push_back(std::move(db));
+                display_buffer_outputs_new.push_back(outputs);
+            }
+        }
+    }
+
+    /* The replaced display buffers are destroyed after their successors take over */
+    swap(display_buffers, display_buffers_new);
+    display_buffer_outputs = std::move(display_buffer_outputs_new);
+
+    /* Store applied configuration */
+    current_display_configuration = kms_conf;
+
+    /* Clear connected but unused outputs */
+    clear_connected_unused_outputs();
+}
+
+auto mgg::Display::create_display_buffers_locked(
+    mgg::RealKMSDisplayConfiguration const& kms_conf,
+    OverlappingOutputGroup const& group) -> std::vector<std::unique_ptr<DisplayBuffer>>
+{
+    auto bounding_rect = group.bounding_rectangle();
+    // Each vector<KMSOutput> is a single GPU memory domain
+    std::vector<std::vector<std::shared_ptr<KMSOutput>>> kms_output_groups;
+    glm::mat2 transformation;
+    geom::Size current_mode_resolution;
+
+    group.for_each_output(
+        [&](DisplayConfigurationOutput const& conf_output)
+        {
+            auto kms_output = current_display_configuration.get_output_for(conf_output.id);
+
+            auto const mode_index = kms_conf.get_kms_mode_index(conf_output.id,
+                                                          conf_output.current_mode_index);
+            kms_output->configure(conf_output.top_left - bounding_rect.top_left, mode_index);
+            kms_output->set_power_mode(conf_output.power_mode);
+            kms_output->set_gamma(conf_output.gamma);
+            kms_output->allow_variable_refresh(conf_output.vrr_enabled);
+            add_to_drm_device_group(kms_output_groups, std::move(kms_output));
+
+            /*
+             * Presently OverlappingOutputGroup guarantees all grouped
+             * outputs have the same transformation.
+             */
+            transformation = conf_output.transformation();
+            if (conf_output.current_mode_index < conf_output.modes.size())
+                current_mode_resolution = conf_output.modes[conf_output.current_mode_index].size;
+        });
+
+    uint32_t const width  = current_mode_resolution.width.as_uint32_t();
+    uint32_t const height = current_mode_resolution.height.as_uint32_t();
+
+    std::vector<std::unique_ptr<DisplayBuffer>> display_buffers_new;
+
+    for (auto const& group : kms_output_groups)
+    {
+        /*
+         * In a hybrid setup a scanout surface needs to be allocated differently (linear)
+         * if it needs to be able to be shared across GPUs. This likely reduces performance,
+         * so is only done for outputs driven by a device other than the one we render on.
+         *
+         * Everything is rendered on the one gbm device that client buffers are imported to;
+         * outputs on other devices scan out its buffers by PRIME, or get a GPU copy of them.
+         */
+        auto surface = gbm->create_scanout_surface(
+            width, height,
+            drm.size() != 1 && !is_render_device(*gbm, group.front()->drm_fd()));
+        auto const raw_surface = surface.get();
+
+        auto db = std::make_unique<DisplayBuffer>(
+            bypass_option,
+            listener,
+            group,
+            GBMOutputSurface{
+                group.front()->drm_fd(),
+                std::move(surface),
+                width, height,
+                helpers::EGLHelper{
+                    *gl_config,
+                    *gbm,
+                    raw_surface,
+                    shared_egl.context()
+                }
+            },
+            bounding_rect,
+            transformation);
+
+        display_buffers_new.push_back(std::move(db));
+    }
+
+    return display_buffers_new;
+}
@@ -20,8 +20,10 @@
 #define MIR_GRAPHICS_GBM_DISPLAY_H_
 
 #include "mir/graphics/display.h"
+#include "mir/graphics/incrementally_configurable_display.h"
 #include "mir/renderer/gl/context_source.h"
 #include "real_kms_output_container.h"
+#include "connector_prober.h"
 #include "real_kms_display_configuration.h"
 #include "display_helpers.h"
 #include "egl_helper.h"
@@ -44,6 +46,7 @@ namespace graphics
 class DisplayReport;
 class DisplayBuffer;
 class DisplayConfigurationPolicy;
+class OverlappingOutputGroup;
 class EventHandlerRegister;
 class GLConfig;
 
@@ -60,7 +63,7 @@ class DisplayBuffer;
 class KMSOutput;
 class Cursor;
 
-class Display : public graphics::Display
+class Display : public graphics::Display, public IncrementallyConfigurableDisplay
 {
 public:
     Display(std::vector<std::shared_ptr<helpers::DRMHelper>> const& drm,
@@ -79,6 +82,9 @@ public:
     std::unique_ptr<DisplayConfiguration> configuration() const override;
     bool apply_if_configuration_preserves_display_buffers(DisplayConfiguration const& conf) override;
     void configure(DisplayConfiguration const& conf) override;
+    void configure_incrementally(
+        DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& invalidating) override;
 
     void register_configuration_change_handler(
         EventHandlerRegister& handlers,
@@ -110,7 +116,10 @@ private:
     mir::udev::Monitor monitor;
     helpers::EGLHelper shared_egl;
     std::vector<std::unique_ptr<DisplayBuffer>> display_buffers;
+    /// The outputs (as configured) that each of display_buffers was created for
+    std::vector<std::vector<DisplayConfigurationOutput>> display_buffer_outputs;
     std::shared_ptr<KMSOutputContainer> const output_container;
+    ConnectorProber connector_prober;
     mutable RealKMSDisplayConfiguration current_display_configuration;
     mutable std::atomic<bool> dirty_configuration;
 
@@ -118,6 +127,20 @@ private:
         RealKMSDisplayConfiguration const& conf,
         std::lock_guard<decltype(configuration_mutex)> const&);
 
+    /// Which of display_buffers conf leaves unchanged
+    auto kept_display_buffers_locked(
+        RealKMSDisplayConfiguration const& conf,
+        std::lock_guard<decltype(configuration_mutex)> const&) const -> std::vector<bool>;
+
+    /// Replaces only the display buffers whose outputs conf changes
+    void configure_changed_outputs_locked(
+        RealKMSDisplayConfiguration const& conf,
+        std::lock_guard<decltype(configuration_mutex)> const&);
+
+    auto create_display_buffers_locked(
+        RealKMSDisplayConfiguration const& conf,
+        OverlappingOutputGroup const& group) -> std::vector<std::unique_ptr<DisplayBuffer>>;
+
     BypassOption bypass_option;
     std::weak_ptr<Cursor> cursor;
     std::shared_ptr<GLConfig> const gl_config;
@@ -20,7 +20,6 @@
 #include "kms_output.h"
 #include "mir/graphics/display_report.h"
 #include "mir/graphics/transformation.h"
-#include "bypass.h"
 #include "gbm_buffer.h"
 #include "mir/fatal.h"
 #include "mir/log.h"
@@ -42,6 +41,8 @@
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <unordered_map>
+#include <utility>
 
 namespace mg = mir::graphics;
 namespace mgg = mir::graphics::gbm;
@@ -320,17 +321,8 @@ public:
         attrtex = glGetAttribLocation(prog, "texcoord");
         auto unitex = glGetUniformLocation(prog, "tex");
 
-        glGenTextures(1, &tex);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, tex);
-
         glUniform1i(unitex, 0);
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
         static GLfloat const dest_vert[4][2] =
             { { -1.f, 1.f }, { 1.f, 1.f }, { 1.f, -1.f }, { -1.f, -1.f } };
         vert_data = std::make_unique<VBO>(dest_vert, sizeof(dest_vert));
@@ -348,6 +340,11 @@ public:
     ~EGLBufferCopier()
     {
         egl.make_current();
+        for (auto const& source : sources)
+        {
+            glDeleteTextures(1, &source.second.tex);
+            eglDestroyImageKHR(eglGetCurrentDisplay(), source.second.image);
+        }
         vert_data = nullptr;
         tex_data = nullptr;
     }
@@ -355,17 +352,57 @@ public:
     mgg::GBMOutputSurface::FrontBuffer copy_front_buffer_from(mgg::GBMOutputSurface::FrontBuffer&& from)
     {
         egl.make_current();
-        mir::Fd const dma_buf{gbm_bo_get_fd(from)};
 
         glUseProgram(prog);
 
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture_for(from));
+
+        vert_data->bind();
+        glVertexAttribPointer (attrpos, 2, GL_FLOAT, GL_FALSE, 0, 0);
+
+        tex_data->bind();
+        glVertexAttribPointer (attrtex, 2, GL_FLOAT, GL_FALSE, 0, 0);
+
+        glEnableVertexAttribArray(attrpos);
+        glEnableVertexAttribArray(attrtex);
+
+        GLubyte const idx[] = { 0, 1, 3, 2 };
+        glDrawElements (GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_BYTE, idx);
+
+        egl.swap_buffers();
+
+        egl.release_current();
+        return mgg::GBMOutputSurface::FrontBuffer(surface.get());
+    }
+
+    private:
+
+    struct Source
+    {
+        EGLImageKHR image;
+        GLuint tex;
+    };
+
+    /*
+     * The rendering GPU's gbm_surface cycles through the same few buffers for its
+     * lifetime, so each is imported once rather than every frame.
+     */
+    auto texture_for(gbm_bo* bo) -> GLuint
+    {
+        auto const existing = sources.find(bo);
+        if (existing != sources.end())
+            return existing->second.tex;
+
+        mir::Fd const dma_buf{gbm_bo_get_fd(bo)};
+
         EGLint const image_attrs[] = {
             EGL_WIDTH, static_cast<EGLint>(width),
             EGL_HEIGHT, static_cast<EGLint>(height),
             EGL_LINUX_DRM_FOURCC_EXT, DRM_FORMAT_XRGB8888,
             EGL_DMA_BUF_PLANE0_FD_EXT, static_cast<int>(dma_buf),
             EGL_DMA_BUF_PLANE0_OFFSET_EXT, 0,
-            EGL_DMA_BUF_PLANE0_PITCH_EXT, static_cast<EGLint>(gbm_bo_get_stride(from)),
+            EGL_DMA_BUF_PLANE0_PITCH_EXT, static_cast<EGLint>(gbm_bo_get_stride(bo)),
             EGL_NONE
         };
 
@@ -381,32 +418,21 @@ public:
             BOOST_THROW_EXCEPTION(mg::egl_error("Failed to create EGLImage from dma_buf"));
         }
 
-        glActiveTexture(GL_TEXTURE0);
+        GLuint tex;
+        glGenTextures(1, &tex);
         glBindTexture(GL_TEXTURE_2D, tex);
-        glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, image);
 
-        vert_data->bind();
-        glVertexAttribPointer (attrpos, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
-        tex_data->bind();
-        glVertexAttribPointer (attrtex, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
-        glEnableVertexAttribArray(attrpos);
-        glEnableVertexAttribArray(attrtex);
-
-        GLubyte const idx[] = { 0, 1, 3, 2 };
-        glDrawElements (GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_BYTE, idx);
-
-        egl.swap_buffers();
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-        eglDestroyImageKHR(eglGetCurrentDisplay(), image);
+        glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, image);
 
-        egl.release_current();
-        return mgg::GBMOutputSurface::FrontBuffer(surface.get());
+        sources.emplace(bo, Source{image, tex});
+        return tex;
     }
 
-    private:
-
     PFNEGLCREATEIMAGEKHRPROC const eglCreateImageKHR;
     PFNEGLDESTROYIMAGEKHRPROC const eglDestroyImageKHR;
     PFNGLEGLIMAGETARGETTEXTURE2DOESPROC const glEGLImageTargetTexture2DOES;
@@ -417,7 +443,7 @@ public:
     mgg::GBMSurfaceUPtr const surface;
     mgmh::EGLHelper egl;
     GLuint prog;
-    GLuint tex;
+    std::unordered_map<gbm_bo*, Source> sources;
     GLint attrtex;
     GLint attrpos;
     std::unique_ptr<VBO> vert_data;
@@ -459,15 +485,34 @@ mgg::DisplayBuffer::DisplayBuffer(
 
     if (needs_bounce_buffer(*outputs.front(), temporary_front))
     {
-        mir::log_info("Hybrid GPU setup detected; DisplayBuffer using EGL buffer copies for migration");
-        get_front_buffer = std::bind(
-            std::mem_fn(&EGLBufferCopier::copy_front_buffer_from),
-            std::make_shared<EGLBufferCopier>(
-                mir::Fd{mir::IntOwnedFd{outputs.front()->drm_fd()}},
-                surface.size().width.as_int(),
-                surface.size().height.as_int(),
-                GBM_FORMAT_XRGB8888),
-            std::placeholders::_1);
+        /*
+         * The rendering GPU's buffers are linear, so the display device may well be
+         * able to scan them out as they are. If it can't (or stops being able to) we
+         * copy each frame into the display device's memory with its GPU instead.
+         */
+        mir::log_info("Hybrid GPU setup detected; DisplayBuffer scanning out the rendering GPU's buffers");
+        get_front_buffer =
+            [outputs = this->outputs, size = surface.size(), copier = std::shared_ptr<EGLBufferCopier>{}]
+                (GBMOutputSurface::FrontBuffer&& fb) mutable
+            {
+                if (!copier)
+                {
+                    auto const displayable = std::all_of(
+                        outputs.begin(), outputs.end(),
+                        [&fb](auto const& output) { return output->fb_for(fb) != nullptr; });
+
+                    if (displayable)
+                        return std::move(fb);
+
+                    mir::log_info("Output can't scan out the rendering GPU's buffers; using EGL buffer copies for migration");
+                    copier = std::make_shared<EGLBufferCopier>(
+                        mir::Fd{mir::IntOwnedFd{outputs.front()->drm_fd()}},
+                        size.width.as_int(),
+                        size.height.as_int(),
+                        GBM_FORMAT_XRGB8888);
+                }
+                return copier->copy_front_buffer_from(std::move(fb));
+            };
     }
     else
     {
@@ -483,7 +528,8 @@ mgg::DisplayBuffer::DisplayBuffer(
      */
     for (auto const& output : outputs)
     {
-        if (output->buffer_requires_migration(visible_composite_frame))
+        if (output->buffer_requires_migration(visible_composite_frame) &&
+            !output->fb_for(visible_composite_frame))
         {
             BOOST_THROW_EXCEPTION(std::invalid_argument(
                 "Attempted to create a DisplayBuffer spanning multiple GPU memory domains"));
@@ -524,33 +570,44 @@ void mgg::DisplayBuffer::set_transformation(glm::mat2 const& t, geometry::Rectan
 }
 
 bool mgg::DisplayBuffer::overlay(RenderableList const& renderable_list)
+{
+    // The compositor has already offered this frame's candidate through scanout()
+    if (std::exchange(scanout_refused, false))
+        return false;
+
+    if (auto const candidate = mg::scanout_candidate(renderable_list, area))
+        return scanout(candidate);
+
+    bypass_buf = nullptr;
+    bypass_bufobj = nullptr;
+    return false;
+}
+
+bool mgg::DisplayBuffer::scanout(std::shared_ptr<Renderable> const& candidate)
 {
     glm::mat2 static const no_transformation(1);
     if (transform == no_transformation &&
        (bypass_option == mgg::BypassOption::allowed))
     {
-        mgg::BypassMatch bypass_match(area);
-        auto bypass_it = std::find_if(renderable_list.rbegin(), renderable_list.rend(), bypass_match);
-        if (bypass_it != renderable_list.rend())
+        auto bypass_buffer = candidate->buffer();
+        auto native = std::dynamic_pointer_cast<mgg::NativeBuffer>(bypass_buffer->native_buffer_handle());
+        if (native && native->flags & mir_buffer_flag_can_scanout &&
+            bypass_buffer->size() == surface.size() &&
+            !needs_bounce_buffer(*outputs.front(), native->bo))
         {
-            auto bypass_buffer = (*bypass_it)->buffer();
-            auto native = std::dynamic_pointer_cast<mgg::NativeBuffer>(bypass_buffer->native_buffer_handle());
-            if (native && native->flags & mir_buffer_flag_can_scanout &&
-                bypass_buffer->size() == surface.size() &&
-                !needs_bounce_buffer(*outputs.front(), native->bo))
+            if (auto bufobj = outputs.front()->fb_for(native->bo))
             {
-                if (auto bufobj = outputs.front()->fb_for(native->bo))
-                {
-                    bypass_buf = bypass_buffer;
-                    bypass_bufobj = bufobj;
-                    return true;
-                }
+                bypass_buf = bypass_buffer;
+                bypass_bufobj = bufobj;
+                scanout_refused = false;
+                return true;
             }
         }
     }
 
     bypass_buf = nullptr;
     bypass_bufobj = nullptr;
+    scanout_refused = true;
     return false;
 }
 
@@ -594,6 +651,7 @@ void mgg::DisplayBuffer::post()
      * point before the next schedule_page_flip().
      */
     wait_for_page_flip();
+    scanout_refused = false;
 
     mgg::FBHandle *bufobj;
     if (bypass_buf)
@@ -608,6 +666,17 @@ void mgg::DisplayBuffer::post()
             fatal_error("Failed to get front buffer object");
     }
 
+    /*
+     * A fullscreen client scanned out directly sets the pace: with a variable
+     * refresh rate each flip is shown as it arrives (within the range the
+     * output supports) rather than at the next fixed refresh.
+     *
+     * Composited frames stay at the fixed rate: they are paced by the compositor,
+     * so there is no single client cadence for the refresh rate to follow.
+     */
+    bool const variable_refresh =
+        outputs.size() == 1 && outputs.front()->set_variable_refresh(bypass_buf != nullptr);
+
     /*
      * Try to schedule a page flip as first preference to avoid tearing.
      * [will complete in a background thread]
@@ -671,8 +740,12 @@ void mgg::DisplayBuffer::post()
     bypass_buf = nullptr;
     bypass_bufobj = nullptr;
 
+    /*
+     * With a variable refresh rate there's no fixed vblank to render just in
+     * time for: compositing as soon as the client commits keeps to its cadence.
+     */
     recommend_sleep = 0ms;
-    if (outputs.size() == 1)
+    if (outputs.size() == 1 && !variable_refresh)
     {
         auto const& output = outputs.front();
         auto const min_frame_interval = 1000ms / output->max_refresh_rate();
@@ -20,6 +20,7 @@
 #define MIR_GRAPHICS_GBM_DISPLAY_BUFFER_H_
 
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/direct_scanout.h"
 #include "mir/graphics/display.h"
 #include "mir/renderer/gl/render_target.h"
 #include "display_helpers.h"
@@ -94,6 +95,7 @@ private:
 };
 
 class DisplayBuffer : public graphics::DisplayBuffer,
+                      public graphics::DirectScanout,
                       public graphics::DisplaySyncGroup,
                       public graphics::NativeDisplayBuffer,
                       public renderer::gl::RenderTarget
@@ -112,6 +114,7 @@ public:
     void release_current() override;
     void swap_buffers() override;
     bool overlay(RenderableList const& renderlist) override;
+    bool scanout(std::shared_ptr<Renderable> const& candidate) override;
     void bind() override;
 
     void for_each_display_buffer(
@@ -155,6 +158,8 @@ private:
     std::atomic<bool> needs_set_crtc;
     std::chrono::milliseconds recommend_sleep{0};
     bool page_flips_pending;
+    // scanout() refused this frame's candidate, so overlay() needn't offer it again
+    bool scanout_refused{false};
 };
 
 }
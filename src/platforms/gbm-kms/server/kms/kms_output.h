@@ -78,6 +78,19 @@ public:
     virtual void set_gamma(GammaCurves const& gamma) = 0;
     virtual Frame last_frame() const = 0;
 
+    /**
+     * Allow (or disallow) the refresh rate to vary, as configured for the output.
+     * Disallowing it returns the output to its mode's fixed rate.
+     */
+    virtual void allow_variable_refresh(bool allowed) = 0;
+    /**
+     * Let the refresh rate follow the page flips (within the range the output
+     * supports) rather than the mode's fixed rate, if allowed and supported.
+     *
+     * \return  True if the refresh rate is now variable
+     */
+    virtual bool set_variable_refresh(bool active) = 0;
+
     /**
      * Re-probe the hardware state of this connector.
      *
@@ -92,6 +105,15 @@ public:
      *                                  is touched.
      */
     virtual void update_from_hardware_state(DisplayConfigurationOutput& to_update) const = 0;
+    /**
+     * Get a framebuffer, for display on this output, showing a buffer.
+     *
+     * A buffer allocated on another device is imported (by PRIME), which only shows what's
+     * expected if the buffer is linear.
+     *
+     * \param [in] bo   GBM buffer to display
+     * \return  The framebuffer, or nullptr if this output's device can't display the buffer
+     */
     virtual FBHandle* fb_for(gbm_bo* bo) const = 0;
 
     /**
@@ -99,9 +121,8 @@ public:
      *
      * \param [in] bo   GBM buffer to test
      * \return  True if buffer must be migrated to display-private memory in order to be displayed.
-     *          If this method returns true the caller should probably copy it to a new buffer before
-     *          calling fb_for(buffer), as acquiring a FBHandle to the buffer will likely make it
-     *          unusable for rendering on the original GPU.
+     *          If this method returns true the caller should copy it to a new buffer before
+     *          calling fb_for(buffer), unless it was allocated to be linear (and so shareable).
      */
     virtual bool buffer_requires_migration(gbm_bo* bo) const = 0;
 
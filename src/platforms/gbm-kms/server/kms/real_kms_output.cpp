@@ -21,6 +21,7 @@
 #include "page_flipper.h"
 #include "kms-utils/kms_connector.h"
 #include "mir/fatal.h"
+#include "mir/fd.h"
 #include "mir/log.h"
 #include <string.h> // strcmp
 #include <sys/stat.h>
@@ -34,11 +35,21 @@ namespace mgg = mg::gbm;
 namespace mgk = mg::kms;
 namespace geom = mir::geometry;
 
+namespace
+{
+void close_gem_handle(int drm_fd, uint32_t handle)
+{
+    drm_gem_close close_args{handle, 0};
+    drmIoctl(drm_fd, DRM_IOCTL_GEM_CLOSE, &close_args);
+}
+}
+
 class mgg::FBHandle
 {
 public:
-    FBHandle(gbm_bo* bo, uint32_t drm_fb_id)
-        : bo{bo}, drm_fb_id{drm_fb_id}
+    /// \param imported_handle  the buffer's GEM handle on drm_fd, if imported from another device
+    FBHandle(int drm_fd, uint32_t drm_fb_id, uint32_t imported_handle)
+        : drm_fd{drm_fd}, drm_fb_id{drm_fb_id}, imported_handle{imported_handle}
     {
     }
 
@@ -46,9 +57,12 @@ public:
     {
         if (drm_fb_id)
         {
-            int drm_fd = gbm_device_get_fd(gbm_bo_get_device(bo));
             drmModeRmFB(drm_fd, drm_fb_id);
         }
+        if (imported_handle)
+        {
+            close_gem_handle(drm_fd, imported_handle);
+        }
     }
 
     uint32_t get_drm_fb_id() const
@@ -56,9 +70,14 @@ public:
         return drm_fb_id;
     }
 
+    int const drm_fd;
+
+    /// The same buffer's framebuffer on another device, if it's been displayed there too
+    std::unique_ptr<FBHandle> next;
+
 private:
-    gbm_bo *bo;
     uint32_t drm_fb_id;
+    uint32_t imported_handle;
 };
 
 namespace
@@ -69,6 +88,19 @@ void bo_user_data_destroy(gbm_bo* /*bo*/, void *data)
     delete bufobj;
 }
 
+/// Imports bo from the device it was allocated on, returning its GEM handle on drm_fd (or 0)
+auto import_bo(int drm_fd, gbm_bo* bo) -> uint32_t
+{
+    mir::Fd const dma_buf{gbm_bo_get_fd(bo)};
+    if (dma_buf < 0)
+        return 0;
+
+    uint32_t handle{0};
+    if (drmPrimeFDToHandle(drm_fd, dma_buf, &handle))
+        return 0;
+
+    return handle;
+}
 }
 
 mgg::RealKMSOutput::RealKMSOutput(
@@ -111,12 +143,13 @@ uint32_t mgg::RealKMSOutput::id() const
 
 void mgg::RealKMSOutput::reset()
 {
-    kms::DRMModeResources resources{drm_fd_};
-
-    /* Update the connector to ensure we have the latest information */
+    /*
+     * Update the connector to ensure we have the latest information.
+     * The kernel's cached state is enough; ConnectorProber keeps it fresh.
+     */
     try
     {
-        connector = resources.connector(connector->connector_id);
+        connector = kms::get_connector_current(drm_fd_, connector->connector_id);
     }
     catch (std::exception const& e)
     {
@@ -138,6 +171,9 @@ void mgg::RealKMSOutput::reset()
         }
     }
 
+    /* The crtc we had may be given to another output, so leave it at a fixed rate */
+    set_variable_refresh(false);
+
     /* Discard previously current crtc */
     current_crtc = nullptr;
 }
@@ -367,6 +403,59 @@ void mgg::RealKMSOutput::set_power_mode(MirPowerMode mode)
     }
 }
 
+void mgg::RealKMSOutput::allow_variable_refresh(bool allowed)
+{
+    std::lock_guard<std::mutex> lock{vrr_mutex};
+
+    if (!allowed)
+        set_variable_refresh_locked(false, lock);
+
+    vrr_allowed = allowed;
+}
+
+bool mgg::RealKMSOutput::set_variable_refresh(bool active)
+{
+    std::lock_guard<std::mutex> lock{vrr_mutex};
+    return set_variable_refresh_locked(active, lock);
+}
+
+bool mgg::RealKMSOutput::set_variable_refresh_locked(bool active, std::lock_guard<std::mutex> const&)
+{
+    active = active && vrr_allowed;
+
+    if (active == vrr_active || !ensure_crtc())
+        return vrr_active;
+
+    mgk::ObjectProperties const crtc_props{drm_fd_, current_crtc};
+    if (!crtc_props.has_property("VRR_ENABLED"))
+    {
+        // The kernel predates adaptive sync, so the output can't have claimed to support it
+        return vrr_active;
+    }
+
+    auto const err = -drmModeObjectSetProperty(
+        drm_fd_,
+        current_crtc->crtc_id,
+        DRM_MODE_OBJECT_CRTC,
+        crtc_props.id_for("VRR_ENABLED"),
+        active);
+
+    if (err)
+    {
+        mir::log_warning(
+            "Failed to %s variable refresh rate on output %s: %s",
+            active ? "enable" : "disable",
+            mgk::connector_name(connector).c_str(),
+            strerror(err));
+    }
+    else
+    {
+        vrr_active = active;
+    }
+
+    return vrr_active;
+}
+
 void mgg::RealKMSOutput::set_gamma(mg::GammaCurves const& gamma)
 {
     if (!ensure_crtc())
@@ -400,7 +489,7 @@ void mgg::RealKMSOutput::set_gamma(mg::GammaCurves const& gamma)
 
 void mgg::RealKMSOutput::refresh_hardware_state()
 {
-    connector = kms::get_connector(drm_fd_, connector->connector_id);
+    connector = kms::get_connector_current(drm_fd_, connector->connector_id);
     current_crtc = nullptr;
 
     if (connector->encoder_id)
@@ -546,6 +635,14 @@ std::vector<uint8_t> edid_for_connector(int drm_fd, uint32_t connector_id)
 
     return edid;
 }
+
+bool vrr_capable(int drm_fd, uint32_t connector_id)
+{
+    mgk::ObjectProperties connector_props{
+        drm_fd, connector_id, DRM_MODE_OBJECT_CONNECTOR};
+
+    return connector_props.has_property("vrr_capable") && connector_props["vrr_capable"];
+}
 }
 
 void mgg::RealKMSOutput::update_from_hardware_state(
@@ -563,11 +660,13 @@ void mgg::RealKMSOutput::update_from_hardware_state(
                                         mir_pixel_format_xrgb_8888};
 
     std::vector<uint8_t> edid;
+    bool variable_refresh{false};
     if (connected) {
         /* Only ask for the EDID on connected outputs. There's obviously no monitor EDID
          * when there is no monitor connected!
          */
         edid = edid_for_connector(drm_fd_, connector->connector_id);
+        variable_refresh = vrr_capable(drm_fd_, connector->connector_id);
     }
 
     drmModeModeInfo current_mode_info = drmModeModeInfo();
@@ -623,6 +722,10 @@ void mgg::RealKMSOutput::update_from_hardware_state(
     output.subpixel_arrangement = kms_subpixel_to_mir_subpixel(connector->subpixel);
     output.gamma = gamma;
     output.edid = edid;
+    /* Adaptive sync is on by default where the display supports it; keep any later choice */
+    if (output.vrr_capable != variable_refresh)
+        output.vrr_enabled = variable_refresh;
+    output.vrr_capable = variable_refresh;
 }
 
 mgg::FBHandle* mgg::RealKMSOutput::fb_for(gbm_bo* bo) const
@@ -632,14 +735,32 @@ mgg::FBHandle* mgg::RealKMSOutput::fb_for(gbm_bo* bo) const
 
     /*
      * Check if we have already set up this gbm_bo (the gbm-kms implementation is
-     * free to reuse gbm_bos). If so, return the associated FBHandle.
+     * free to reuse gbm_bos) for this device. If so, return the associated FBHandle.
      */
-    auto bufobj = static_cast<FBHandle*>(gbm_bo_get_user_data(bo));
-    if (bufobj)
-        return bufobj;
+    auto const first = static_cast<FBHandle*>(gbm_bo_get_user_data(bo));
+    auto last = first;
+    for (auto bufobj = first; bufobj; bufobj = bufobj->next.get())
+    {
+        if (bufobj->drm_fd == drm_fd_)
+            return bufobj;
+        last = bufobj;
+    }
+
+    /*
+     * A buffer allocated on another device is imported by PRIME; this only gives a
+     * sensible picture if the buffer is linear, so it's up to the caller to ask for
+     * a framebuffer only for a buffer it has allocated that way.
+     */
+    uint32_t imported_handle{0};
+    if (buffer_requires_migration(bo))
+    {
+        imported_handle = import_bo(drm_fd_, bo);
+        if (!imported_handle)
+            return nullptr;
+    }
 
     uint32_t fb_id{0};
-    uint32_t handles[4] = {gbm_bo_get_handle(bo).u32, 0, 0, 0};
+    uint32_t handles[4] = {imported_handle ? imported_handle : gbm_bo_get_handle(bo).u32, 0, 0, 0};
     uint32_t strides[4] = {gbm_bo_get_stride(bo), 0, 0, 0};
     uint32_t offsets[4] = {0, 0, 0, 0};
 
@@ -660,11 +781,18 @@ mgg::FBHandle* mgg::RealKMSOutput::fb_for(gbm_bo* bo) const
     auto ret = drmModeAddFB2(drm_fd_, width, height, format,
                              handles, strides, offsets, &fb_id, 0);
     if (ret)
+    {
+        if (imported_handle)
+            close_gem_handle(drm_fd_, imported_handle);
         return nullptr;
+    }
 
     /* Create a FBHandle and associate it with the gbm_bo */
-    bufobj = new FBHandle{bo, fb_id};
-    gbm_bo_set_user_data(bo, bufobj, bo_user_data_destroy);
+    auto const bufobj = new FBHandle{drm_fd_, fb_id, imported_handle};
+    if (last)
+        last->next.reset(bufobj);
+    else
+        gbm_bo_set_user_data(bo, bufobj, bo_user_data_destroy);
 
     return bufobj;
 }
@@ -66,6 +66,9 @@ public:
 
     Frame last_frame() const override;
 
+    void allow_variable_refresh(bool allowed) override;
+    bool set_variable_refresh(bool active) override;
+
     void refresh_hardware_state() override;
     void update_from_hardware_state(DisplayConfigurationOutput& output) const override;
 
@@ -76,6 +79,7 @@ public:
 private:
     bool ensure_crtc();
     void restore_saved_crtc();
+    bool set_variable_refresh_locked(bool active, std::lock_guard<std::mutex> const&);
 
     int const drm_fd_;
     std::shared_ptr<PageFlipper> const page_flipper;
@@ -93,6 +97,11 @@ private:
 
     std::mutex power_mutex;
 
+    // Allowed by reconfiguration, while the compositor sets it active as it posts frames
+    std::mutex vrr_mutex;
+    bool vrr_allowed{false};
+    bool vrr_active{false};
+
     AtomicFrame last_frame_;
 };
 
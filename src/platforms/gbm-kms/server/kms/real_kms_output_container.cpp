@@ -57,17 +57,17 @@ void mgg::RealKMSOutputContainer::update_from_hardware_state()
             continue;
         }
 
-        for (auto &&connector : resources->connectors())
+        for (auto const connector_id : resources->connector_ids())
         {
             // Caution: O(n²) here, but n is the number of outputs, so should
             // conservatively be << 100.
             auto existing_output = std::find_if(
                 outputs.begin(),
                 outputs.end(),
-                [&connector, drm_fd](auto const &candidate)
+                [connector_id, drm_fd](auto const &candidate)
                 {
                     return
-                        connector->connector_id == candidate->id() &&
+                        connector_id == candidate->id() &&
                         drm_fd == candidate->drm_fd();
                 });
 
@@ -82,9 +82,16 @@ void mgg::RealKMSOutputContainer::update_from_hardware_state()
             }
             else
             {
+                /*
+                 * Only the initial update pays for a full probe. After that
+                 * connectors are probed off the main loop (see ConnectorProber)
+                 * and we just pick up the state the kernel has cached.
+                 */
                 new_outputs.push_back(std::make_shared<RealKMSOutput>(
                     drm_fd,
-                    std::move(connector),
+                    initial_probe_done ?
+                        kms::get_connector_current(drm_fd, connector_id) :
+                        resources->connector(connector_id),
                     construct_page_flipper(drm_fd)));
             }
         }
@@ -96,4 +103,5 @@ void mgg::RealKMSOutputContainer::update_from_hardware_state()
     }
 
     outputs = new_outputs;
+    initial_probe_done = true;
 }
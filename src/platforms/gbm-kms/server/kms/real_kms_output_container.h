@@ -45,6 +45,7 @@ private:
     std::vector<int> const drm_fds;
     std::vector<std::shared_ptr<KMSOutput>> outputs;
     std::function<std::shared_ptr<PageFlipper>(int drm_fd)> const construct_page_flipper;
+    bool initial_probe_done{false};
 };
 
 }
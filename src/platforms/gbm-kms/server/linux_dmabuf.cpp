@@ -27,7 +27,9 @@
 #include "mir/graphics/program_factory.h"
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/buffer_basic.h"
+#include "mir/graphics/fenced_buffer.h"
 #include "mir/executor.h"
+#include "buffer_fences.h"
 
 #define MIR_LOG_COMPONENT "linux-dmabuf-import"
 #include "mir/log.h"
@@ -514,13 +516,15 @@ bool drm_format_has_alpha(uint32_t format)
 class WaylandDmabufTexBuffer :
     public mg::BufferBasic,
     public mg::NativeBufferBase,
-    public mg::gl::Texture
+    public mg::gl::Texture,
+    public mg::FencedBuffer
 {
 public:
     // Note: Must be called with a current EGL context
     WaylandDmabufTexBuffer(
         DmaBufBuffer& source,
         mg::EGLExtensions const& extensions,
+        std::shared_ptr<mg::EGLExtensions::ANDROIDNativeFenceSync const> native_sync,
         std::shared_ptr<mir::renderer::gl::Context> ctx,
         std::function<void()>&& on_consumed,
         std::function<void()>&& on_release,
@@ -532,6 +536,7 @@ public:
           size_{source.size()},
           layout_{source.layout()},
           has_alpha{drm_format_has_alpha(source.format())},
+          fences{eglGetCurrentDisplay(), std::move(native_sync)},
           wayland_executor{std::move(wayland_executor)}
     {
         eglBindAPI(EGL_OPENGL_ES_API);
@@ -559,6 +564,14 @@ public:
               context->release_current();
             });
 
+        if (release_handler)
+        {
+            wayland_executor->spawn(
+                [handler = std::move(release_handler), fence = fences.release_fence()]()
+                {
+                    handler(fence);
+                });
+        }
         on_release();
     }
 
@@ -610,6 +623,7 @@ public:
 
     void bind() override
     {
+        fences.wait_for_acquire();
         glBindTexture(GL_TEXTURE_2D, tex);
 
         std::lock_guard<decltype(consumed_mutex)> lock(consumed_mutex);
@@ -619,6 +633,17 @@ public:
 
     void add_syncpoint() override
     {
+        fences.add_release_point();
+    }
+
+    void set_acquire_fence(mir::Fd fence) override
+    {
+        fences.set_acquire_fence(std::move(fence));
+    }
+
+    void set_release_handler(std::function<void(mir::Fd release_fence)>&& handler) override
+    {
+        release_handler = std::move(handler);
     }
 private:
     std::shared_ptr<mir::renderer::gl::Context> const ctx;
@@ -632,6 +657,9 @@ private:
     Layout const layout_;
     bool const has_alpha;
 
+    mg::common::BufferFences fences;
+    std::function<void(mir::Fd)> release_handler;
+
     std::shared_ptr<mir::Executor> const wayland_executor;
 };
 
@@ -875,10 +903,12 @@ mgg::LinuxDmaBufUnstable::LinuxDmaBufUnstable(
     wl_display* display,
     EGLDisplay dpy,
     std::shared_ptr<EGLExtensions> egl_extensions,
-    EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext)
+    EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext,
+    std::shared_ptr<EGLExtensions::ANDROIDNativeFenceSync const> native_sync)
     : mir::wayland::LinuxDmabufV1::Global(display, Version<3>{}),
       dpy{dpy},
       egl_extensions{std::move(egl_extensions)},
+      native_sync{std::move(native_sync)},
       formats{std::make_shared<DmaBufFormatDescriptors>(dpy, dmabuf_ext)}
 {
 }
@@ -896,6 +926,7 @@ auto mgg::LinuxDmaBufUnstable::buffer_from_resource(
         return std::make_shared<WaylandDmabufTexBuffer>(
             *dmabuf,
             *egl_extensions,
+            native_sync,
             std::move(ctx),
             std::move(on_consumed),
             std::move(on_release),
@@ -53,7 +53,8 @@ public:
         wl_display* display,
         EGLDisplay dpy,
         std::shared_ptr<EGLExtensions> egl_extensions,
-        EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext);
+        EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext,
+        std::shared_ptr<EGLExtensions::ANDROIDNativeFenceSync const> native_sync);
 
     std::shared_ptr<Buffer> buffer_from_resource(
         wl_resource* buffer,
@@ -68,6 +69,8 @@ private:
 
     EGLDisplay const dpy;
     std::shared_ptr<EGLExtensions> const egl_extensions;
+    /// Null if the driver can't import and export sync_file fences
+    std::shared_ptr<EGLExtensions::ANDROIDNativeFenceSync const> const native_sync;
     std::shared_ptr<DmaBufFormatDescriptors> const formats;
 };
 
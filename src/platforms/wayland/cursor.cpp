@@ -83,38 +83,71 @@ mpw::Cursor::~Cursor()
 
 void mpw::Cursor::move_to(geometry::Point)
 {
+    // The host moves its cursor: there's nothing to recomposite here or there
 }
 
 void mpw::Cursor::show(graphics::CursorImage const& cursor_image)
 {
     {
         std::lock_guard<decltype(mutex)> lock{mutex};
-        if (buffer) wl_buffer_destroy(buffer);
 
         auto const width = cursor_image.size().width.as_uint32_t();
         auto const height = cursor_image.size().height.as_uint32_t();
-        auto const hotspot_x = cursor_image.hotspot().dx.as_uint32_t();
-        auto const hotspot_y = cursor_image.hotspot().dy.as_uint32_t();
+        auto const size = 4 * width * height;
         void* data_buffer;
-        auto const shm_pool = make_shm_pool(shm, 4 * width * height, &data_buffer);
-        memcpy(data_buffer, cursor_image.as_argb_8888(), 4 * width * height);
+        auto const shm_pool = make_shm_pool(shm, size, &data_buffer);
+        memcpy(data_buffer, cursor_image.as_argb_8888(), size);
+        munmap(data_buffer, size);
+
+        // The host keeps the old buffer until this one is committed in its place
+        auto const old_buffer = buffer;
         buffer = wl_shm_pool_create_buffer(shm_pool, 0, width, height, 4 * width, WL_SHM_FORMAT_ARGB8888);
+        wl_shm_pool_destroy(shm_pool);
+
         wl_surface_attach(surface, buffer, 0, 0);
+        wl_surface_damage(surface, 0, 0, width, height);
         wl_surface_commit(surface);
-        wl_shm_pool_destroy(shm_pool);
-        if (pointer) wl_pointer_set_cursor(pointer, 0, surface, hotspot_x, hotspot_y);
+        if (old_buffer) wl_buffer_destroy(old_buffer);
+
+        hotspot_x = cursor_image.hotspot().dx.as_int();
+        hotspot_y = cursor_image.hotspot().dy.as_int();
+        visible = true;
+        set_cursor();
     }
-    wl_display_roundtrip(display);
+
+    // Pointer motion is frequent, and each show() is followed by it: don't wait on the host
+    wl_display_flush(display);
 }
 
 void mpw::Cursor::hide()
 {
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        visible = false;
+        set_cursor();
+    }
+    wl_display_flush(display);
+}
+
+void mpw::Cursor::set_cursor()
+{
+    if (!pointer)
+        return;
+
+    if (visible && buffer)
+        wl_pointer_set_cursor(pointer, serial, surface, hotspot_x, hotspot_y);
+    else
+        wl_pointer_set_cursor(pointer, serial, nullptr, 0, 0);
 }
 
-void mir::platform::wayland::Cursor::enter(wl_pointer* pointer)
+void mir::platform::wayland::Cursor::enter(wl_pointer* pointer, uint32_t serial)
 {
     std::lock_guard<decltype(mutex)> lock{mutex};
     this->pointer = pointer;
+    this->serial = serial;
+
+    // The host shows its own cursor (or the last client's) until we set ours for this entry
+    set_cursor();
 }
 
 void mir::platform::wayland::Cursor::leave(wl_pointer* /*pointer*/)
@@ -46,10 +46,14 @@ public:
 
     void move_to(geometry::Point position) override;
 
-    void enter(wl_pointer* pointer);
+    /// The host's pointer has entered one of our surfaces: the cursor is set using its serial
+    void enter(wl_pointer* pointer, uint32_t serial);
     void leave(wl_pointer* pointer);
 
 private:
+    /// Sets the host's cursor to ours (or to none, if hidden). Call with mutex held.
+    void set_cursor();
+
     wl_display* const display;
     wl_shm* const shm;
 
@@ -58,6 +62,10 @@ private:
     std::mutex mutable mutex;
     wl_buffer* buffer{nullptr};
     wl_pointer* pointer{nullptr};
+    uint32_t serial{0};
+    int32_t hotspot_x{0};
+    int32_t hotspot_y{0};
+    bool visible{false};
 };
 }
 }
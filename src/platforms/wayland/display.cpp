@@ -84,8 +84,9 @@ mgw::Display* the_display = nullptr;
 mgw::Display::Display(
     wl_display* const wl_display,
     std::shared_ptr<GLConfig> const& gl_config,
+    bool passthrough,
     std::shared_ptr<DisplayReport> const& report) :
-    DisplayClient{wl_display, gl_config},
+    DisplayClient{wl_display, gl_config, passthrough},
     report{report},
     shutdown_signal{::eventfd(0, EFD_CLOEXEC)},
     keyboard_sink{std::make_shared<NullKeyboardInput>()},
@@ -514,7 +515,7 @@ auto mir::graphics::wayland::Display::get_touch_contact(int32_t id) -> decltype(
 void mir::graphics::wayland::Display::pointer_enter(
     wl_pointer* pointer, uint32_t serial, wl_surface* surface, wl_fixed_t x, wl_fixed_t y)
 {
-    if (cursor) cursor->enter(pointer);
+    if (cursor) cursor->enter(pointer, serial);
     DisplayClient::pointer_enter(pointer, serial, surface, x, y);
 }
 
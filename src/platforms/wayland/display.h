@@ -59,6 +59,7 @@ public:
     Display(
         wl_display* const wl_display,
         std::shared_ptr<GLConfig> const& gl_config,
+        bool passthrough,
         std::shared_ptr<DisplayReport> const& report);
 
     ~Display();
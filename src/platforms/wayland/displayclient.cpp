@@ -16,12 +16,23 @@
  */
 
 #include "displayclient.h"
+#include "passthrough.h"
+#include "linux-dmabuf-unstable-v1-client-protocol.h"
 #include "mir/graphics/egl_error.h"
+#include <mir/anonymous_shm_file.h>
+#include <mir/graphics/buffer.h>
+#include <mir/graphics/direct_scanout.h>
+#include <mir/graphics/dmabuf_buffer.h>
+#include <mir/graphics/partial_overlay.h>
 #include <mir/graphics/pixel_format_utils.h>
+#include <mir/graphics/renderable.h>
+#include <mir/renderer/sw/pixel_source.h>
 
 #include <wayland-client.h>
 #include <wayland-egl.h>
+#include <GLES2/gl2.h>
 
+#include <drm_fourcc.h>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <xkbcommon/xkbcommon.h>
@@ -29,18 +40,25 @@
 #include <boost/throw_exception.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <cstring>
+#include <experimental/optional>
 #include <stdlib.h>
 #include <system_error>
 
 namespace mgw = mir::graphics::wayland;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
 
 class mgw::DisplayClient::Output  :
     public DisplaySyncGroup,
     public renderer::gl::RenderTarget,
     public NativeDisplayBuffer,
-    public DisplayBuffer
+    public DisplayBuffer,
+    public DirectScanout,
+    public PartialOverlay
 {
 public:
     Output(
@@ -106,11 +124,299 @@ public:
     auto transformation() const -> glm::mat2 override;
     auto native_display_buffer() -> NativeDisplayBuffer* override;
 
+    // DirectScanout implementation
+    bool scanout(std::shared_ptr<Renderable> const& candidate) override;
+
+    // PartialOverlay implementation
+    bool overlay_top_of(RenderableList& renderlist) override;
+
     // RenderTarget implementation
     void make_current() override;
     void release_current() override;
     void swap_buffers() override;
     void bind() override;
+
+private:
+    class FrameSync;
+    class Subsurface;
+
+    auto can_pass_through(Renderable const& renderable) const -> bool;
+    void pass_through(RenderableList const& renderlist);
+    void hide_subsurfaces();
+
+    std::unique_ptr<FrameSync> const frame_sync;
+
+    // Host subsurfaces showing client buffers
+    SubsurfaceStack subsurfaces;
+    bool passthrough_active{false};
+};
+
+/// Tracks the host's frame callback without blocking the thread that committed the frame
+class mgw::DisplayClient::Output::FrameSync
+{
+public:
+    FrameSync() = default;
+
+    ~FrameSync()
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        if (callback) wl_callback_destroy(callback);
+    }
+
+    /// Ask for notification of when the host wants the frame after the one about to be committed
+    void request_for(wl_surface* surface)
+    {
+        static wl_callback_listener const frame_listener{
+            [](void* data, wl_callback*, uint32_t) { static_cast<FrameSync*>(data)->frame_done(); }
+        };
+
+        std::lock_guard<decltype(mutex)> lock{mutex};
+
+        // If we gave up waiting on the last callback it is still the one to wait for
+        if (!callback)
+        {
+            callback = wl_surface_frame(surface);
+            wl_callback_add_listener(callback, &frame_listener, this);
+        }
+    }
+
+    /// Wait (for a bounded time) for the host to be ready for the next frame
+    void wait_for_previous()
+    {
+        // The host may stop sending frame events to an invisible surface
+        auto const frame_timeout = std::chrono::milliseconds{100};
+
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        cv.wait_for(lock, frame_timeout, [this]{ return !callback; });
+    }
+
+private:
+    void frame_done()
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        wl_callback_destroy(callback);
+        callback = nullptr;
+        cv.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    wl_callback* callback{nullptr};
+};
+
+/**
+ * A host subsurface of an output showing a single client buffer: the buffer itself if
+ * it can be shared as dma-bufs, otherwise a copy of it.
+ */
+class mgw::DisplayClient::Output::Subsurface : public SubsurfaceStack::Layer
+{
+public:
+    Subsurface(DisplayClient const* owner, wl_surface* parent) :
+        owner{owner},
+        surface{wl_compositor_create_surface(owner->compositor)},
+        subsurface{wl_subcompositor_get_subsurface(owner->subcompositor, surface, parent)}
+    {
+    }
+
+    ~Subsurface()
+    {
+        wl_subsurface_destroy(subsurface);
+        wl_surface_destroy(surface);
+    }
+
+    void show(Renderable const& renderable, geom::Displacement offset, wl_surface* sibling) override
+    {
+        auto const buffer = renderable.buffer();
+
+        if (!shown_buffer || buffer->id() != shown_buffer.value())
+        {
+            if (auto const dma_buf = dynamic_cast<DMABufBuffer*>(buffer->native_buffer_base()))
+            {
+                // The host keeps the client's buffer until it releases the wl_buffer
+                auto const forwarded = new ForwardedBuffer{owner->linux_dmabuf, buffer, *dma_buf->dma_buf_export()};
+                wl_surface_attach(surface, forwarded->host_buffer, 0, 0);
+                dma_buf->mark_consumed();
+            }
+            else
+            {
+                auto& host_buffer = host_buffer_for(buffer->size(), buffer->pixel_format());
+                copy_into(host_buffer, *buffer);
+
+                host_buffer.busy = true;
+                wl_surface_attach(surface, host_buffer.buffer, 0, 0);
+            }
+            wl_surface_damage(surface, 0, 0, INT32_MAX, INT32_MAX);
+
+            if (!renderable.shaped() || buffer->pixel_format() == mir_pixel_format_xrgb_8888)
+            {
+                auto const region = wl_compositor_create_region(owner->compositor);
+                wl_region_add(region, 0, 0, buffer->size().width.as_int(), buffer->size().height.as_int());
+                wl_surface_set_opaque_region(surface, region);
+                wl_region_destroy(region);
+            }
+            else
+            {
+                wl_surface_set_opaque_region(surface, nullptr);
+            }
+
+            wl_surface_commit(surface);
+            shown_buffer = buffer->id();
+        }
+
+        // Subsurfaces are synchronized: position and stacking take effect with the parent's commit
+        if (offset != shown_offset)
+        {
+            wl_subsurface_set_position(subsurface, offset.dx.as_int(), offset.dy.as_int());
+            shown_offset = offset;
+        }
+        wl_subsurface_place_above(subsurface, sibling);
+    }
+
+    void hide() override
+    {
+        if (shown_buffer)
+        {
+            wl_surface_attach(surface, nullptr, 0, 0);
+            wl_surface_commit(surface);
+            shown_buffer = {};
+        }
+    }
+
+    auto host_surface() const -> wl_surface* override { return surface; }
+
+private:
+    /// A client's buffer lent to the host, which deletes this when the host releases it
+    struct ForwardedBuffer
+    {
+        ForwardedBuffer(
+            zwp_linux_dmabuf_v1* linux_dmabuf,
+            std::shared_ptr<Buffer> buffer,
+            DMABufBuffer::Export const& dma_buf) :
+            buffer{std::move(buffer)}
+        {
+            static wl_buffer_listener const buffer_listener{
+                [](void* data, wl_buffer*) { delete static_cast<ForwardedBuffer*>(data); }
+            };
+
+            auto const params = zwp_linux_dmabuf_v1_create_params(linux_dmabuf);
+            for (auto plane = 0u; plane != dma_buf.planes.size(); ++plane)
+            {
+                zwp_linux_buffer_params_v1_add(
+                    params,
+                    dma_buf.planes[plane].dma_buf,
+                    plane,
+                    dma_buf.planes[plane].offset,
+                    dma_buf.planes[plane].stride,
+                    dma_buf.modifier >> 32,
+                    dma_buf.modifier & 0xffffffff);
+            }
+
+            host_buffer = zwp_linux_buffer_params_v1_create_immed(
+                params,
+                this->buffer->size().width.as_int(),
+                this->buffer->size().height.as_int(),
+                dma_buf.drm_fourcc,
+                dma_buf.y_inverted ? ZWP_LINUX_BUFFER_PARAMS_V1_FLAGS_Y_INVERT : 0);
+            zwp_linux_buffer_params_v1_destroy(params);
+            wl_buffer_add_listener(host_buffer, &buffer_listener, this);
+        }
+
+        ~ForwardedBuffer()
+        {
+            wl_buffer_destroy(host_buffer);
+        }
+
+        ForwardedBuffer(ForwardedBuffer const&) = delete;
+        ForwardedBuffer& operator=(ForwardedBuffer const&) = delete;
+
+        std::shared_ptr<Buffer> const buffer;
+        wl_buffer* host_buffer;
+    };
+
+    struct HostBuffer
+    {
+        HostBuffer(wl_shm* shm, geom::Size size, MirPixelFormat format) :
+            size{size},
+            format{format},
+            shm_file{4u * size.width.as_uint32_t() * size.height.as_uint32_t()}
+        {
+            static wl_buffer_listener const buffer_listener{
+                [](void* data, wl_buffer*) { static_cast<HostBuffer*>(data)->busy = false; }
+            };
+
+            auto const pool = wl_shm_create_pool(shm, shm_file.fd(), 4 * size.width.as_int() * size.height.as_int());
+            buffer = wl_shm_pool_create_buffer(
+                pool,
+                0,
+                size.width.as_int(),
+                size.height.as_int(),
+                4 * size.width.as_int(),
+                format == mir_pixel_format_argb_8888 ? WL_SHM_FORMAT_ARGB8888 : WL_SHM_FORMAT_XRGB8888);
+            wl_shm_pool_destroy(pool);
+            wl_buffer_add_listener(buffer, &buffer_listener, this);
+        }
+
+        ~HostBuffer()
+        {
+            wl_buffer_destroy(buffer);
+        }
+
+        geom::Size const size;
+        MirPixelFormat const format;
+        AnonymousShmFile const shm_file;
+        wl_buffer* buffer;
+        std::atomic<bool> busy{false};
+    };
+
+    /// A buffer the host has released, reusing an existing one where possible
+    auto host_buffer_for(geom::Size size, MirPixelFormat format) -> HostBuffer&
+    {
+        // Buffers of a stale size are no use once the host has finished with them
+        host_buffers.erase(
+            std::remove_if(begin(host_buffers), end(host_buffers), [&](auto const& host_buffer)
+                {
+                    return !host_buffer->busy && (host_buffer->size != size || host_buffer->format != format);
+                }),
+            end(host_buffers));
+
+        auto const free = std::find_if(begin(host_buffers), end(host_buffers), [](auto const& host_buffer)
+            { return !host_buffer->busy; });
+
+        if (free != end(host_buffers))
+            return **free;
+
+        host_buffers.push_back(std::make_unique<HostBuffer>(owner->shm, size, format));
+        return *host_buffers.back();
+    }
+
+    static void copy_into(HostBuffer& host_buffer, Buffer& buffer)
+    {
+        auto& source = dynamic_cast<mrs::PixelSource&>(*buffer.native_buffer_base());
+        auto const src_stride = source.stride().as_int();
+        auto const dst_stride = 4 * host_buffer.size.width.as_int();
+        auto const height = host_buffer.size.height.as_int();
+        auto const dst = static_cast<unsigned char*>(host_buffer.shm_file.base_ptr());
+
+        source.read([&](unsigned char const* pixels)
+            {
+                if (src_stride == dst_stride)
+                {
+                    memcpy(dst, pixels, dst_stride * height);
+                }
+                else
+                {
+                    for (auto row = 0; row != height; ++row)
+                        memcpy(dst + row * dst_stride, pixels + row * src_stride, dst_stride);
+                }
+            });
+    }
+
+    DisplayClient const* const owner;
+    wl_surface* const surface;
+    wl_subsurface* const subsurface;
+    std::vector<std::unique_ptr<HostBuffer>> host_buffers;
+    std::experimental::optional<BufferID> shown_buffer;
+    geom::Displacement shown_offset;
 };
 
 namespace
@@ -239,7 +545,9 @@ mgw::DisplayClient::Output::Output(
     owner{owner},
     surface{wl_compositor_create_surface(owner->compositor)},
     on_done{[this, on_constructed = std::move(on_constructed), on_change=std::move(on_change)]
-        (Output const& o) mutable { on_constructed(o), on_done = std::move(on_change); }}
+        (Output const& o) mutable { on_constructed(o), on_done = std::move(on_change); }},
+    frame_sync{std::make_unique<FrameSync>()},
+    subsurfaces{surface, [this] { return std::make_unique<Subsurface>(this->owner, surface); }}
 {
     wl_output_add_listener(output, &output_listener, this);
 
@@ -265,6 +573,7 @@ mgw::DisplayClient::Output::~Output()
     if (window)
         wl_shell_surface_destroy(window);
 
+    subsurfaces.clear();
     wl_surface_destroy(surface);
 
     if (eglsurface != EGL_NO_SURFACE)
@@ -328,11 +637,128 @@ auto mgw::DisplayClient::Output::view_area() const -> geometry::Rectangle
     return dcout.extents();
 }
 
-bool mgw::DisplayClient::Output::overlay(mir::graphics::RenderableList const&)
+bool mgw::DisplayClient::Output::overlay(mir::graphics::RenderableList const& renderlist)
+{
+    // All or nothing: unlike overlay_top_of(), nothing is left to composite beneath the overlays
+    if (!owner->passthrough || !owner->subcompositor)
+    {
+        hide_subsurfaces();
+        return false;
+    }
+
+    auto const split = split_for_passthrough(
+        renderlist,
+        view_area(),
+        [this](Renderable const& renderable) { return can_pass_through(renderable); });
+
+    if (!split.composited.empty())
+    {
+        hide_subsurfaces();
+        return false;
+    }
+
+    pass_through(split.passed_through);
+    return true;
+}
+
+bool mgw::DisplayClient::Output::overlay_top_of(RenderableList& renderlist)
 {
+    if (!owner->passthrough || !owner->subcompositor)
+    {
+        // Takes effect with the composited frame committed by swap_buffers()
+        hide_subsurfaces();
+        return false;
+    }
+
+    auto const split = split_for_passthrough(
+        renderlist,
+        view_area(),
+        [this](Renderable const& renderable) { return can_pass_through(renderable); });
+
+    if (split.composited.empty())
+    {
+        pass_through(split.passed_through);
+        return true;
+    }
+
+    // The subsurfaces' state takes effect with the composited frame committed by swap_buffers()
+    subsurfaces.show(split.passed_through, view_area().top_left);
+    passthrough_active = false;
+    renderlist = split.composited;
     return false;
 }
 
+bool mgw::DisplayClient::Output::scanout(std::shared_ptr<Renderable> const& candidate)
+{
+    // Unlike overlay() this needs no --wayland-host-passthrough: a single fullscreen
+    // subsurface has none of the stacking and damage costs of passing through a scene
+    if (!owner->subcompositor || !can_pass_through(*candidate))
+        return false;
+
+    pass_through({candidate});
+    return true;
+}
+
+void mgw::DisplayClient::Output::pass_through(RenderableList const& renderlist)
+{
+    subsurfaces.show(renderlist, view_area().top_left);
+
+    if (passthrough_active)
+    {
+        // Commit the parent to apply the subsurfaces' state
+        frame_sync->wait_for_previous();
+        frame_sync->request_for(surface);
+        wl_surface_commit(surface);
+        wl_display_flush(owner->display);
+    }
+    else
+    {
+        // Clear whatever was last composited into the parent
+        make_current();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        swap_buffers();
+        passthrough_active = true;
+    }
+}
+
+auto mgw::DisplayClient::Output::can_pass_through(Renderable const& renderable) const -> bool
+{
+    auto const buffer = renderable.buffer();
+    auto const position = renderable.screen_position();
+    auto const clip_area = renderable.clip_area();
+
+    // The host can show the buffer (or a copy of it) as-is, but can't transform, crop, clip or fade it
+    auto const shown_as_is =
+        renderable.alpha() == 1.0f &&
+        renderable.transformation() == glm::mat4{1} &&
+        renderable.texture_bounds() == TextureBounds{} &&
+        dcout.scale == 1.0f &&
+        buffer->size() == position.size &&
+        (!clip_area || clip_area.value().contains(position)) &&
+        view_area().contains(position);
+
+    if (!shown_as_is)
+        return false;
+
+    // Hardware buffers are lent to the host, when it can import them; there's no copying them
+    if (auto const dma_buf = dynamic_cast<DMABufBuffer*>(buffer->native_buffer_base()))
+    {
+        auto const exported = dma_buf->dma_buf_export();
+        return exported && owner->host_accepts_dma_buf(exported->drm_fourcc, exported->modifier);
+    }
+
+    auto const format = buffer->pixel_format();
+    return (format == mir_pixel_format_argb_8888 || format == mir_pixel_format_xrgb_8888) &&
+        dynamic_cast<mrs::PixelSource*>(buffer->native_buffer_base());
+}
+
+void mgw::DisplayClient::Output::hide_subsurfaces()
+{
+    subsurfaces.hide();
+    passthrough_active = false;
+}
+
 auto mgw::DisplayClient::Output::transformation() const -> glm::mat2
 {
     return glm::mat2{1};
@@ -359,44 +785,10 @@ void mgw::DisplayClient::Output::release_current()
 
 void mgw::DisplayClient::Output::swap_buffers()
 {
-    struct FrameSync
-    {
-        explicit FrameSync(wl_surface* surface) :
-            callback{wl_surface_frame(surface)}
-        {
-            static struct wl_callback_listener const frame_listener =
-                {
-                    [](void* data, auto... args)
-                        { static_cast<FrameSync*>(data)->frame_done(args...); },
-                };
-
-            wl_callback_add_listener(callback, &frame_listener, this);
-        }
-
-        ~FrameSync()
-        {
-            wl_callback_destroy(callback);
-        }
-
-        void frame_done(wl_callback*, uint32_t)
-        {
-            std::lock_guard<decltype(mutex)> lock{mutex};
-            posted = true;
-            cv.notify_all();
-        }
-
-        void wait_for_done()
-        {
-            std::unique_lock<decltype(mutex)> lock{mutex};
-            cv.wait(lock, [this]{ return posted; });
-        }
-
-        std::mutex mutex;
-        bool posted = false;
-        std::condition_variable cv;
-
-        wl_callback* const callback;
-    } frame_sync{surface};
+    // Don't get more than a frame ahead of the host, but don't wait for it
+    // to show this one: we'll find out asynchronously when it has.
+    frame_sync->wait_for_previous();
+    frame_sync->request_for(surface);
 
     // Avoid throttling compositing by blocking in eglSwapBuffers().
     // Instead we use the frame "done" notification.
@@ -404,8 +796,6 @@ void mgw::DisplayClient::Output::swap_buffers()
 
     if (eglSwapBuffers(owner->egldisplay, eglsurface) != EGL_TRUE)
         BOOST_THROW_EXCEPTION(egl_error("Failed to perform buffer swap"));
-
-    frame_sync.wait_for_done();
 }
 
 void mgw::DisplayClient::Output::bind()
@@ -414,8 +804,10 @@ void mgw::DisplayClient::Output::bind()
 
 mgw::DisplayClient::DisplayClient(
     wl_display* display,
-    std::shared_ptr<GLConfig> const& gl_config) :
+    std::shared_ptr<GLConfig> const& gl_config,
+    bool passthrough) :
     display{display},
+    passthrough{passthrough},
     keyboard_context_{xkb_context_new(XKB_CONTEXT_NO_FLAGS)},
     registry{nullptr, [](auto){}}
 {
@@ -545,6 +937,18 @@ void mgw::DisplayClient::new_global(
     {
         self->shell = static_cast<decltype(self->shell)>(wl_registry_bind(registry, id, &wl_shell_interface, std::min(version, 1u)));
     }
+    else if (strcmp(interface, "wl_subcompositor") == 0)
+    {
+        self->subcompositor = static_cast<decltype(self->subcompositor)>(
+            wl_registry_bind(registry, id, &wl_subcompositor_interface, std::min(version, 1u)));
+    }
+    else if (strcmp(interface, "zwp_linux_dmabuf_v1") == 0 && version >= 2)
+    {
+        // Version 2 is needed to create buffers without waiting on the host
+        self->linux_dmabuf = static_cast<decltype(self->linux_dmabuf)>(
+            wl_registry_bind(registry, id, &zwp_linux_dmabuf_v1_interface, std::min(version, 3u)));
+        add_dmabuf_listener(self, self->linux_dmabuf);
+    }
 }
 
 void mgw::DisplayClient::remove_global(
@@ -841,6 +1245,42 @@ void mir::graphics::wayland::DisplayClient::shm_format(wl_shm* /*wl_shm*/, uint3
     }
 }
 
+void mgw::DisplayClient::add_dmabuf_listener(DisplayClient* self, zwp_linux_dmabuf_v1* linux_dmabuf)
+{
+    static zwp_linux_dmabuf_v1_listener const dmabuf_listener = {
+        [](void* self, zwp_linux_dmabuf_v1* linux_dmabuf, uint32_t format)
+            {
+                // From version 3 the modifier events say whether implicit modifiers are accepted
+                if (zwp_linux_dmabuf_v1_get_version(linux_dmabuf) < 3)
+                    static_cast<DisplayClient*>(self)->dmabuf_modifier(format, DRM_FORMAT_MOD_INVALID);
+            },
+        [](void* self, zwp_linux_dmabuf_v1*, uint32_t format, uint32_t modifier_hi, uint32_t modifier_lo)
+            {
+                static_cast<DisplayClient*>(self)->dmabuf_modifier(
+                    format,
+                    (static_cast<uint64_t>(modifier_hi) << 32) | modifier_lo);
+            },
+    };
+
+    zwp_linux_dmabuf_v1_add_listener(linux_dmabuf, &dmabuf_listener, self);
+}
+
+void mgw::DisplayClient::dmabuf_modifier(uint32_t format, uint64_t modifier)
+{
+    std::lock_guard<decltype(dmabuf_formats_mutex)> lock{dmabuf_formats_mutex};
+    dmabuf_formats.emplace_back(format, modifier);
+}
+
+auto mgw::DisplayClient::host_accepts_dma_buf(uint32_t format, uint64_t modifier) const -> bool
+{
+    if (!linux_dmabuf)
+        return false;
+
+    std::lock_guard<decltype(dmabuf_formats_mutex)> lock{dmabuf_formats_mutex};
+    return std::find(begin(dmabuf_formats), end(dmabuf_formats), std::make_pair(format, modifier)) !=
+        end(dmabuf_formats);
+}
+
 namespace mir
 {
 namespace graphics
@@ -32,8 +32,11 @@
 #include <unordered_map>
 #include <memory>
 #include <mutex>
+#include <utility>
+#include <vector>
 #include <mir/geometry/displacement.h>
 
+struct zwp_linux_dmabuf_v1;
 struct xkb_context;
 struct xkb_keymap;
 struct xkb_state;
@@ -49,7 +52,8 @@ class DisplayClient
 {
 public:
     DisplayClient(wl_display* display,
-    std::shared_ptr<GLConfig> const& gl_config);
+    std::shared_ptr<GLConfig> const& gl_config,
+    bool passthrough);
 
     virtual ~DisplayClient();
 
@@ -132,6 +136,11 @@ protected:
     wl_shell* shell = nullptr;
     wl_seat* seat = nullptr;
     wl_shm* shm = nullptr;
+    wl_subcompositor* subcompositor = nullptr;
+    zwp_linux_dmabuf_v1* linux_dmabuf = nullptr;
+
+    // Forward suitable client buffers to the host as subsurfaces instead of compositing them
+    bool const passthrough;
 
     static void new_global(
         void* data,
@@ -149,6 +158,13 @@ protected:
     void seat_capabilities(wl_seat* seat, uint32_t capabilities);
     void seat_name(wl_seat* seat, const char* name);
 
+    static void add_dmabuf_listener(DisplayClient* self, zwp_linux_dmabuf_v1* linux_dmabuf);
+    void dmabuf_modifier(uint32_t format, uint64_t modifier);
+    /// Whether the host can show client buffers of this format and layout as they are
+    auto host_accepts_dma_buf(uint32_t format, uint64_t modifier) const -> bool;
+    std::mutex mutable dmabuf_formats_mutex;
+    std::vector<std::pair<uint32_t, uint64_t>> dmabuf_formats;
+
     static void add_shm_listener(DisplayClient* self, wl_shm* shm);
     void shm_format(wl_shm *wl_shm, uint32_t format);
     MirPixelFormat shm_pixel_format{mir_pixel_format_invalid};
@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "passthrough.h"
+
+#include <algorithm>
+
+namespace mgw = mir::graphics::wayland;
+namespace geom = mir::geometry;
+
+auto mgw::split_for_passthrough(
+    RenderableList const& renderlist,
+    geom::Rectangle const& view_area,
+    std::function<bool(Renderable const&)> const& can_pass_through) -> PassthroughSplit
+{
+    PassthroughSplit split;
+
+    auto top = renderlist.rbegin();
+    for (; top != renderlist.rend(); ++top)
+    {
+        auto const& renderable = **top;
+
+        if (!view_area.overlaps(renderable.screen_position()))
+            continue;
+
+        if (!can_pass_through(renderable))
+            break;
+
+        split.passed_through.push_back(*top);
+    }
+
+    std::reverse(begin(split.passed_through), end(split.passed_through));
+    split.composited.assign(renderlist.begin(), top.base());
+
+    return split;
+}
+
+mgw::SubsurfaceStack::SubsurfaceStack(wl_surface* parent, std::function<std::unique_ptr<Layer>()> make_layer) :
+    parent{parent},
+    make_layer{std::move(make_layer)}
+{
+}
+
+void mgw::SubsurfaceStack::show(RenderableList const& renderlist, geom::Point origin)
+{
+    while (layers.size() < renderlist.size())
+        layers.push_back(make_layer());
+
+    auto sibling = parent;
+    auto layer = begin(layers);
+
+    for (auto const& renderable : renderlist)
+    {
+        (*layer)->show(*renderable, renderable->screen_position().top_left - origin, sibling);
+        sibling = (*layer)->host_surface();
+        ++layer;
+    }
+
+    for (; layer != end(layers); ++layer)
+        (*layer)->hide();
+}
+
+void mgw::SubsurfaceStack::hide()
+{
+    for (auto const& layer : layers)
+        layer->hide();
+}
+
+void mgw::SubsurfaceStack::clear()
+{
+    layers.clear();
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_PLATFORMS_WAYLAND_PASSTHROUGH_H_
+#define MIR_PLATFORMS_WAYLAND_PASSTHROUGH_H_
+
+#include <mir/geometry/displacement.h>
+#include <mir/geometry/rectangle.h>
+#include <mir/graphics/renderable.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct wl_surface;
+
+namespace mir
+{
+namespace graphics
+{
+namespace wayland
+{
+/// An output's scene, split between host subsurfaces and the composited parent surface
+struct PassthroughSplit
+{
+    /// Bottom-most first, to be drawn into the parent surface
+    RenderableList composited;
+    /// Bottom-most first, each to be shown in a subsurface stacked above the parent
+    RenderableList passed_through;
+};
+
+/**
+ * Splits renderlist (bottom-most first) at the top-most renderable that can't be passed
+ * through: it, and everything beneath it, is composited. Renderables above it that are
+ * outside view_area are in neither part.
+ */
+auto split_for_passthrough(
+    RenderableList const& renderlist,
+    geometry::Rectangle const& view_area,
+    std::function<bool(Renderable const&)> const& can_pass_through) -> PassthroughSplit;
+
+/// Host subsurfaces stacked above a parent surface, each showing one renderable
+class SubsurfaceStack
+{
+public:
+    class Layer
+    {
+    public:
+        virtual ~Layer() = default;
+
+        /// Show renderable at offset from the parent, stacked immediately above sibling
+        virtual void show(Renderable const& renderable, geometry::Displacement offset, wl_surface* sibling) = 0;
+        virtual void hide() = 0;
+        virtual auto host_surface() const -> wl_surface* = 0;
+
+    protected:
+        Layer() = default;
+        Layer(Layer const&) = delete;
+        Layer& operator=(Layer const&) = delete;
+    };
+
+    SubsurfaceStack(wl_surface* parent, std::function<std::unique_ptr<Layer>()> make_layer);
+
+    /// Show renderlist (bottom-most first) above the parent, hiding any layers it doesn't need
+    void show(RenderableList const& renderlist, geometry::Point origin);
+    void hide();
+
+    /// Destroy the layers (which must be done before the parent is)
+    void clear();
+
+private:
+    wl_surface* const parent;
+    std::function<std::unique_ptr<Layer>()> const make_layer;
+
+    // Bottom-most first
+    std::vector<std::unique_ptr<Layer>> layers;
+};
+}
+}
+}
+
+#endif //MIR_PLATFORMS_WAYLAND_PASSTHROUGH_H_
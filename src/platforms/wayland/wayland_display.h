@@ -32,6 +32,7 @@ namespace wayland
 void add_connection_options(boost::program_options::options_description& config);
 auto connection_options_supplied(mir::options::Option const& options) -> bool;
 auto connection(mir::options::Option const& options) -> wl_display*;
+auto passthrough_requested(mir::options::Option const& options) -> bool;
 }
 }
 }
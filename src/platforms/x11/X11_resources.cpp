@@ -85,3 +85,13 @@ auto mx::X11Resources::get_output_config_for_win(Window win)
         return std::experimental::nullopt;
     }
 }
+
+void mx::X11Resources::set_hardware_cursor_in_use(bool in_use)
+{
+    hardware_cursor = in_use;
+}
+
+auto mx::X11Resources::hardware_cursor_in_use() const -> bool
+{
+    return hardware_cursor;
+}
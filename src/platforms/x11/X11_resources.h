@@ -20,6 +20,7 @@
 #define MIR_X11_RESOURCES_H_
 
 #include <X11/Xlib.h>
+#include <atomic>
 #include <experimental/optional>
 #include <unordered_map>
 
@@ -46,11 +47,16 @@ public:
     auto get_output_config_for_win(Window win)
         -> std::experimental::optional<graphics::DisplayConfigurationOutput const* const>;
 
+    /// Whether the display has set an X cursor for its windows (which input must then not hide)
+    void set_hardware_cursor_in_use(bool in_use);
+    auto hardware_cursor_in_use() const -> bool;
+
     static X11Resources instance;
 
 private:
     std::weak_ptr<::Display> connection;
     std::unordered_map<Window, std::weak_ptr<graphics::DisplayConfigurationOutput const>> output_configs;
+    std::atomic<bool> hardware_cursor{false};
 };
 
 }
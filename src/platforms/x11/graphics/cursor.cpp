@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cursor.h"
+#include "../X11_resources.h"
+
+#include "mir/graphics/cursor_image.h"
+
+#include <X11/Xcursor/Xcursor.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace mx = mir::X;
+namespace mg = mir::graphics;
+namespace mgx = mg::X;
+
+namespace
+{
+auto load_cursor(::Display* x_dpy, int width, int height, int hotspot_x, int hotspot_y, void const* pixels) -> ::Cursor
+{
+    auto const image = XcursorImageCreate(width, height);
+    if (!image)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to create X cursor image"));
+
+    image->xhot = hotspot_x;
+    image->yhot = hotspot_y;
+    if (pixels)
+        memcpy(image->pixels, pixels, 4 * width * height);
+    else
+        memset(image->pixels, 0, 4 * width * height);
+
+    auto const cursor = XcursorImageLoadCursor(x_dpy, image);
+    XcursorImageDestroy(image);
+    return cursor;
+}
+}
+
+mgx::X11Cursor::X11Cursor(::Display* x_dpy, std::vector<Window> const& windows)
+    : x_dpy{x_dpy},
+      windows{windows}
+{
+    // The X server shows this cursor: the input platform mustn't hide it
+    mx::X11Resources::instance.set_hardware_cursor_in_use(true);
+}
+
+mgx::X11Cursor::~X11Cursor()
+{
+    mx::X11Resources::instance.set_hardware_cursor_in_use(false);
+
+    // The windows may already have gone, but X keeps a defined cursor until they do
+    if (current != None)
+    {
+        XFreeCursor(x_dpy, current);
+        XFlush(x_dpy);
+    }
+}
+
+void mgx::X11Cursor::show(CursorImage const& cursor_image)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    define(load_cursor(
+        x_dpy,
+        cursor_image.size().width.as_int(),
+        cursor_image.size().height.as_int(),
+        cursor_image.hotspot().dx.as_int(),
+        cursor_image.hotspot().dy.as_int(),
+        cursor_image.as_argb_8888()));
+}
+
+void mgx::X11Cursor::hide()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    // Undefining the cursor would show the parent window's, so hide it behind a transparent one
+    define(load_cursor(x_dpy, 1, 1, 0, 0, nullptr));
+}
+
+void mgx::X11Cursor::move_to(geometry::Point)
+{
+    // The X server moves the cursor with the host's pointer
+}
+
+void mgx::X11Cursor::define(::Cursor cursor)
+{
+    for (auto const window : windows)
+        XDefineCursor(x_dpy, window, cursor);
+
+    if (current != None)
+        XFreeCursor(x_dpy, current);
+    current = cursor;
+
+    XFlush(x_dpy);
+}
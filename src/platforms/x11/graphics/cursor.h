@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_X_CURSOR_H_
+#define MIR_GRAPHICS_X_CURSOR_H_
+
+#include "mir/graphics/cursor.h"
+
+#include <X11/Xlib.h>
+
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+namespace X
+{
+/// The cursor, as an X cursor defined for our windows: the X server draws and moves it,
+/// so pointer motion needs no recompositing.
+class X11Cursor : public graphics::Cursor
+{
+public:
+    X11Cursor(::Display* x_dpy, std::vector<Window> const& windows);
+    ~X11Cursor();
+
+    void show(CursorImage const& cursor_image) override;
+    void hide() override;
+
+    void move_to(geometry::Point position) override;
+
+private:
+    /// Defines cursor for our windows, replacing (and freeing) the current one. Call with mutex held.
+    void define(::Cursor cursor);
+
+    ::Display* const x_dpy;
+    std::vector<Window> const windows;
+
+    std::mutex mutex;
+    ::Cursor current{None};
+};
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_X_CURSOR_H_ */
@@ -30,6 +30,7 @@
 #include "display.h"
 #include "platform.h"
 #include "display_buffer.h"
+#include "cursor.h"
 #include "../X11_resources.h"
 
 #include <boost/throw_exception.hpp>
@@ -364,7 +365,13 @@ void mgx::Display::resume()
 
 auto mgx::Display::create_hardware_cursor() -> std::shared_ptr<Cursor>
 {
-    return nullptr;
+    std::vector<Window> windows;
+    for (auto const& output : outputs)
+    {
+        windows.push_back(*output->window);
+    }
+
+    return std::make_shared<X11Cursor>(x_dpy, windows);
 }
 
 std::unique_ptr<mg::VirtualOutput> mgx::Display::create_virtual_output(int /*width*/, int /*height*/)
@@ -154,7 +154,9 @@ void mix::XInputPlatform::process_input_event()
                         auto const& xenev = xev.xcrossing;
                         XGrabPointer(xenev.display, xenev.window, True, 0, GrabModeAsync,
                                      GrabModeAsync, None, None, CurrentTime);
-                        XFixesHideCursor(xenev.display, xenev.window);
+                        // With a hardware cursor the X server is showing ours, not the host's
+                        if (!mx::X11Resources::instance.hardware_cursor_in_use())
+                            XFixesHideCursor(xenev.display, xenev.window);
                         ptr_grabbed = true;
                     }
                     break;
@@ -166,7 +168,8 @@ void mix::XInputPlatform::process_input_event()
                     {
                         auto const& xlnev = xev.xcrossing;
                         XUngrabPointer(xlnev.display, CurrentTime);
-                        XFixesShowCursor(xlnev.display, xlnev.window);
+                        if (!mx::X11Resources::instance.hardware_cursor_in_use())
+                            XFixesShowCursor(xlnev.display, xlnev.window);
                         ptr_grabbed = false;
                     }
                     break;
@@ -0,0 +1,299 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "GLRenderer"
+
+#include "program_cache.h"
+
+#include "mir/log.h"
+
+#include <GLES2/gl2ext.h>
+#include <EGL/egl.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <unistd.h>
+
+namespace mrg = mir::renderer::gl;
+
+namespace
+{
+// Bump this whenever the layout of the cache files changes
+std::uint32_t const cache_format_version{1};
+
+char const cache_magic[] = "MIR-GL-PROGRAM";
+
+auto gl_string(GLenum name) -> std::string
+{
+    auto const value = reinterpret_cast<char const*>(glGetString(name));
+    return value ? value : "";
+}
+
+struct BinaryEntryPoints
+{
+    PFNGLGETPROGRAMBINARYOESPROC get_program_binary;
+    PFNGLPROGRAMBINARYOESPROC program_binary;
+};
+
+/// The program binary entry points, if the current context supports them
+auto binary_entry_points() -> BinaryEntryPoints
+{
+    BinaryEntryPoints const unsupported{nullptr, nullptr};
+
+    if (gl_string(GL_EXTENSIONS).find("GL_OES_get_program_binary") == std::string::npos)
+        return unsupported;
+
+    GLint formats{0};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+    if (formats <= 0)
+        return unsupported;
+
+    BinaryEntryPoints const entry_points{
+        reinterpret_cast<PFNGLGETPROGRAMBINARYOESPROC>(eglGetProcAddress("glGetProgramBinaryOES")),
+        reinterpret_cast<PFNGLPROGRAMBINARYOESPROC>(eglGetProcAddress("glProgramBinaryOES"))};
+
+    if (!entry_points.get_program_binary || !entry_points.program_binary)
+        return unsupported;
+
+    return entry_points;
+}
+
+/// Binaries are only valid for the driver that produced them
+auto driver_identity() -> std::string
+{
+    return gl_string(GL_VENDOR) + '\n' + gl_string(GL_RENDERER) + '\n' + gl_string(GL_VERSION);
+}
+
+/// FNV-1a: unlike std::hash, stable between builds, so usable as a filename
+auto stable_hash(std::string const& text) -> std::uint64_t
+{
+    std::uint64_t hash{0xcbf29ce484222325};
+    for (unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+template<typename Value>
+void write_value(std::ostream& out, Value value)
+{
+    out.write(reinterpret_cast<char const*>(&value), sizeof value);
+}
+
+template<typename Value>
+auto read_value(std::istream& in) -> Value
+{
+    Value value{};
+    in.read(reinterpret_cast<char*>(&value), sizeof value);
+    return value;
+}
+
+void write_bytes(std::ostream& out, char const* data, std::uint32_t size)
+{
+    write_value(out, size);
+    out.write(data, size);
+}
+
+auto read_bytes(std::istream& in, std::vector<char>& data) -> bool
+{
+    auto const size = read_value<std::uint32_t>(in);
+    if (!in || size > (64u << 20))
+        return false;
+
+    data.resize(size);
+    in.read(data.data(), size);
+    return static_cast<bool>(in);
+}
+}
+
+mrg::ProgramCache::ProgramCache(std::string const& directory)
+    : directory{directory}
+{
+}
+
+mrg::ProgramCache::~ProgramCache() = default;
+
+auto mrg::ProgramCache::program(
+    GLchar const* vertex_src,
+    GLchar const* fragment_src,
+    std::function<GLuint()> const& build) -> std::shared_ptr<SharedProgram>
+{
+    auto key = driver_identity();
+    key += '\0';
+    key += vertex_src;
+    key += '\0';
+    key += fragment_src;
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (auto const shared = programs[key].lock())
+            return shared;
+    }
+
+    // Built without holding the lock; should two renderers race to do this, the last one's is shared
+    std::shared_ptr<SharedProgram> const shared{
+        new SharedProgram{load_or_build(key, build)},
+        [](SharedProgram* program)
+        {
+            glDeleteProgram(program->id);
+            delete program;
+        }};
+
+    std::lock_guard<std::mutex> lock{mutex};
+    programs[key] = shared;
+    return shared;
+}
+
+auto mrg::ProgramCache::load_or_build(
+    std::string const& key,
+    std::function<GLuint()> const& build) -> GLuint
+{
+    auto const entry_points = binary_entry_points();
+    if (!entry_points.program_binary)
+        return build();
+
+    if (auto const binary = find(key))
+    {
+        auto const id = glCreateProgram();
+        entry_points.program_binary(id, binary->format, binary->data.data(), binary->data.size());
+
+        GLint ok{GL_FALSE};
+        glGetProgramiv(id, GL_LINK_STATUS, &ok);
+        if (ok)
+            return id;
+
+        // The driver may reject binaries it produced itself (e.g. after a change it doesn't version)
+        glDeleteProgram(id);
+        while (glGetError() != GL_NO_ERROR)
+            ;
+    }
+
+    auto const id = build();
+
+    GLint length{0};
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length > 0)
+    {
+        auto binary = std::make_shared<Binary>();
+        binary->data.resize(length);
+
+        GLsizei written{0};
+        entry_points.get_program_binary(id, length, &written, &binary->format, binary->data.data());
+        if (written > 0)
+        {
+            binary->data.resize(written);
+            insert(key, binary);
+        }
+    }
+
+    return id;
+}
+
+auto mrg::ProgramCache::find(std::string const& key) -> std::shared_ptr<Binary const>
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const cached = binaries.find(key);
+    if (cached != binaries.end())
+        return cached->second;
+
+    if (directory.empty())
+        return nullptr;
+
+    std::ifstream in{filename_for(key), std::ios::binary};
+    if (!in)
+        return nullptr;
+
+    char magic[sizeof cache_magic];
+    in.read(magic, sizeof magic);
+    if (!in || memcmp(magic, cache_magic, sizeof magic) != 0 ||
+        read_value<std::uint32_t>(in) != cache_format_version)
+    {
+        return nullptr;
+    }
+
+    // The full key is stored, as the filename is only its hash
+    std::vector<char> stored_key;
+    if (!read_bytes(in, stored_key) || std::string{stored_key.begin(), stored_key.end()} != key)
+        return nullptr;
+
+    auto binary = std::make_shared<Binary>();
+    binary->format = read_value<GLenum>(in);
+    if (!in || !read_bytes(in, binary->data))
+        return nullptr;
+
+    binaries.emplace(key, binary);
+    return binary;
+}
+
+void mrg::ProgramCache::insert(std::string const& key, std::shared_ptr<Binary const> const& binary)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    binaries.emplace(key, binary);
+
+    if (directory.empty())
+        return;
+
+    boost::system::error_code error;
+    boost::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        mir::log_debug("Not caching GL program: cannot create %s: %s", directory.c_str(), error.message().c_str());
+        return;
+    }
+
+    // Written alongside and renamed into place, so other servers never see half a file
+    auto const filename = filename_for(key);
+    auto const temporary = filename + "." + std::to_string(getpid());
+    {
+        std::ofstream out{temporary, std::ios::binary | std::ios::trunc};
+        out.write(cache_magic, sizeof cache_magic);
+        write_value(out, cache_format_version);
+        write_bytes(out, key.data(), key.size());
+        write_value(out, binary->format);
+        write_bytes(out, binary->data.data(), binary->data.size());
+
+        if (!out)
+        {
+            mir::log_debug("Not caching GL program: failed writing %s", temporary.c_str());
+            out.close();
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+    {
+        mir::log_debug("Not caching GL program: failed renaming %s", temporary.c_str());
+        std::remove(temporary.c_str());
+    }
+}
+
+auto mrg::ProgramCache::filename_for(std::string const& key) const -> std::string
+{
+    char name[32];
+    snprintf(name, sizeof name, "%016" PRIx64 ".bin", stable_hash(key));
+    return directory + "/" + name;
+}
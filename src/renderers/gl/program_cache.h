@@ -0,0 +1,117 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_GL_PROGRAM_CACHE_H_
+#define MIR_RENDERER_GL_PROGRAM_CACHE_H_
+
+#include <GLES2/gl2.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace renderer
+{
+namespace gl
+{
+/**
+ * A linked program object, used by every renderer in the share group.
+ *
+ * Uniform values are part of the program object, and renderers draw from
+ * threads of their own. So a renderer holds mutex from setting the uniforms
+ * it draws with until it has drawn, and if it was not the last user it sets
+ * them all again.
+ */
+struct SharedProgram
+{
+    explicit SharedProgram(GLuint id) : id{id} {}
+    SharedProgram(SharedProgram const&) = delete;
+    SharedProgram& operator=(SharedProgram const&) = delete;
+
+    GLuint const id;
+    std::mutex mutex;
+    /// Who last set the uniforms (guarded by mutex)
+    void const* user = nullptr;
+};
+
+/**
+ * Shares linked GL programs, so that they need not be compiled again.
+ *
+ * Renderers asking for a program that another renderer is using get the
+ * same program object. (This assumes, as the renderers' use of client
+ * buffer textures already does, that their contexts are in one share group.)
+ * A program is deleted when no renderer uses it any more.
+ *
+ * Binaries (from GL_OES_get_program_binary) are shared by every renderer in
+ * the process and, given a directory, kept between runs. They are keyed by
+ * the driver that produced them and by the programs' source, so a driver
+ * upgrade or a change to a shader just misses the cache.
+ *
+ * All members are threadsafe.
+ */
+class ProgramCache
+{
+public:
+    /// \param directory where to keep binaries between runs (if empty, they're kept only in memory)
+    explicit ProgramCache(std::string const& directory);
+    ~ProgramCache();
+
+    /**
+     * The program, in the current share group, for the given sources.
+     *
+     * If no renderer is using the program, it is loaded from a cached binary
+     * if possible; otherwise it is built (compiled and linked) by build(),
+     * and its binary cached. The last to release the program deletes it, so
+     * must have a context of the share group current.
+     */
+    auto program(
+        GLchar const* vertex_src,
+        GLchar const* fragment_src,
+        std::function<GLuint()> const& build) -> std::shared_ptr<SharedProgram>;
+
+private:
+    ProgramCache(ProgramCache const&) = delete;
+    ProgramCache& operator=(ProgramCache const&) = delete;
+
+    struct Binary
+    {
+        GLenum format;
+        std::vector<char> data;
+    };
+
+    auto load_or_build(
+        std::string const& key,
+        std::function<GLuint()> const& build) -> GLuint;
+    auto find(std::string const& key) -> std::shared_ptr<Binary const>;
+    void insert(std::string const& key, std::shared_ptr<Binary const> const& binary);
+    auto filename_for(std::string const& key) const -> std::string;
+
+    std::string const directory;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Binary const>> binaries;
+    std::unordered_map<std::string, std::weak_ptr<SharedProgram>> programs;
+};
+}
+}
+}
+
+#endif // MIR_RENDERER_GL_PROGRAM_CACHE_H_
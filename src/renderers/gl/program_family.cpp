@@ -17,6 +17,7 @@
  */
 
 #include "program_family.h"
+#include "program_cache.h"
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 #include <mutex>
@@ -53,6 +54,11 @@ void ProgramFamily::Shader::init(GLenum type, const GLchar* src)
     }
 }
 
+ProgramFamily::ProgramFamily(std::shared_ptr<ProgramCache> const& cache)
+    : cache{cache}
+{
+}
+
 ProgramFamily::~ProgramFamily() noexcept
 {
     // shader and program lifetimes are managed manually, so that we don't
@@ -61,7 +67,8 @@ ProgramFamily::~ProgramFamily() noexcept
 
     for (auto& p : program)
     {
-        if (p.second.id)
+        // Shared programs are deleted by the last renderer to release them
+        if (p.second.id && !p.second.shared)
             glDeleteProgram(p.second.id);
     }
 
@@ -89,33 +96,62 @@ GLuint ProgramFamily::add_program(const GLchar* const vshader_src,
     static std::mutex lp1416482_mutex;
     std::lock_guard<decltype(lp1416482_mutex)> lock{lp1416482_mutex};
 
+    auto& p = program[{vshader_src, fshader_src}];
+    if (!p.id)
+    {
+        if (cache)
+        {
+            p.shared = cache->program(
+                vshader_src,
+                fshader_src,
+                [this, vshader_src, fshader_src] { return link(vshader_src, fshader_src); });
+            p.id = p.shared->id;
+        }
+        else
+        {
+            p.id = link(vshader_src, fshader_src);
+        }
+    }
+
+    return p.id;
+}
+
+std::shared_ptr<SharedProgram> ProgramFamily::shared_program(GLuint id) const
+{
+    for (auto const& p : program)
+    {
+        if (p.second.id == id)
+            return p.second.shared;
+    }
+
+    return nullptr;
+}
+
+GLuint ProgramFamily::link(const GLchar* const vshader_src,
+                           const GLchar* const fshader_src)
+{
     auto& v = vshader[vshader_src];
     if (!v.id) v.init(GL_VERTEX_SHADER, vshader_src);
 
     auto& f = fshader[fshader_src];
     if (!f.id) f.init(GL_FRAGMENT_SHADER, fshader_src);
 
-    auto& p = program[{v.id, f.id}];
-    if (!p.id)
+    GLuint const id = glCreateProgram();
+    glAttachShader(id, v.id);
+    glAttachShader(id, f.id);
+    glLinkProgram(id);
+    GLint ok;
+    glGetProgramiv(id, GL_LINK_STATUS, &ok);
+    if (!ok)
     {
-        p.id = glCreateProgram();
-        glAttachShader(p.id, v.id);
-        glAttachShader(p.id, f.id);
-        glLinkProgram(p.id);
-        GLint ok;
-        glGetProgramiv(p.id, GL_LINK_STATUS, &ok);
-        if (!ok)
-        {
-            GLchar log[1024];
-            glGetProgramInfoLog(p.id, sizeof log - 1, NULL, log);
-            log[sizeof log - 1] = '\0';
-            glDeleteShader(p.id);
-            p.id = 0;
-            throw std::runtime_error(std::string("Link failed: ")+log);
-        }
+        GLchar log[1024];
+        glGetProgramInfoLog(id, sizeof log - 1, NULL, log);
+        log[sizeof log - 1] = '\0';
+        glDeleteProgram(id);
+        throw std::runtime_error(std::string("Link failed: ")+log);
     }
 
-    return p.id;
+    return id;
 }
 
 }
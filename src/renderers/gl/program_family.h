@@ -20,6 +20,7 @@
 #define MIR_RENDERER_GL_PROGRAM_FAMILY_H_
 
 #include <GLES2/gl2.h>
+#include <memory>
 #include <utility>
 #include <map>
 #include <unordered_map>
@@ -30,6 +31,8 @@ namespace renderer
 {
 namespace gl
 {
+class ProgramCache;
+struct SharedProgram;
 
 /**
  * ProgramFamily represents a set of GLSL programs that are closely
@@ -38,11 +41,14 @@ namespace gl
  *   A secondary intention is that this class may be extended to allow the
  * different programs within the family to share common patterns of uniform
  * usage too.
+ *   Where a ProgramCache is given, programs are taken from it instead, and
+ * their shaders are only compiled if it misses. Such programs are shared with
+ * other renderers.
  */
 class ProgramFamily
 {
 public:
-    ProgramFamily() = default;
+    explicit ProgramFamily(std::shared_ptr<ProgramCache> const& cache = {});
     ProgramFamily(ProgramFamily const&) = delete;
     ProgramFamily& operator=(ProgramFamily const&) = delete;
     ~ProgramFamily() noexcept;
@@ -50,6 +56,9 @@ public:
     GLuint add_program(const GLchar* const static_vshader_src,
                        const GLchar* const static_fshader_src);
 
+    /// The program with the given id, if it came from the cache (and so is shared)
+    std::shared_ptr<SharedProgram> shared_program(GLuint id) const;
+
 private:
     struct Shader
     {
@@ -59,12 +68,17 @@ private:
     typedef std::unordered_map<const GLchar*, Shader> ShaderMap;
     ShaderMap vshader, fshader;
 
-    typedef std::pair<GLuint, GLuint> ShaderPair;
+    typedef std::pair<const GLchar*, const GLchar*> SourcePair;
     struct Program
     {
         GLuint id = 0;
+        std::shared_ptr<SharedProgram> shared;
     };
-    std::map<ShaderPair, Program> program;
+    std::map<SourcePair, Program> program;
+
+    GLuint link(const GLchar* vshader_src, const GLchar* fshader_src);
+
+    std::shared_ptr<ProgramCache> const cache;
 };
 
 }
@@ -19,6 +19,7 @@
 #define MIR_LOG_COMPONENT "GLRenderer"
 
 #include "renderer.h"
+#include "program_cache.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/gl/default_program_factory.h"
 #include "mir/graphics/renderable.h"
@@ -42,6 +43,9 @@
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
 #include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
 #include <sstream>
 
 namespace mg = mir::graphics;
@@ -150,6 +154,19 @@ public:
         from.id = 0;
     }
 
+    GLHandle& operator=(GLHandle&& from)
+    {
+        std::swap(id, from.id);
+        return *this;
+    }
+
+    GLuint release()
+    {
+        auto const released = id;
+        id = 0;
+        return released;
+    }
+
     operator GLuint() const
     {
         return id;
@@ -173,7 +190,17 @@ public:
     {
     }
 
-    ProgramHandle opaque_handle, alpha_handle;
+    Program(
+        std::shared_ptr<mir::renderer::gl::SharedProgram> const& opaque_shader,
+        std::shared_ptr<mir::renderer::gl::SharedProgram> const& alpha_shader)
+        : opaque_handle{0},
+          alpha_handle{0},
+          opaque{opaque_shader->id, opaque_shader},
+          alpha{alpha_shader->id, alpha_shader}
+    {
+    }
+
+    ProgramHandle opaque_handle, alpha_handle;  ///< Unless shared
     mir::renderer::gl::Renderer::Program opaque, alpha;
 };
 
@@ -198,9 +225,9 @@ const GLchar* const vertex_shader_src =
 class mrg::Renderer::ProgramFactory : public mir::graphics::gl::ProgramFactory
 {
 public:
-    // NOTE: This must be called with a current GL context
-    ProgramFactory()
-        : vertex_shader{compile_shader(GL_VERTEX_SHADER, vertex_shader_src)}
+    explicit ProgramFactory(std::shared_ptr<ProgramCache> const& cache)
+        : vertex_shader{0},
+          cache{cache}
     {
     }
 
@@ -260,22 +287,43 @@ public:
         // GL shader compilation is *not* threadsafe, and requires external synchronisation
         std::lock_guard<std::mutex> lock{compilation_mutex};
 
-        ShaderHandle const opaque_shader{
-            compile_shader(GL_FRAGMENT_SHADER, opaque_fragment.str().c_str())};
-        ShaderHandle const alpha_shader{
-            compile_shader(GL_FRAGMENT_SHADER, alpha_fragment.str().c_str())};
+        auto const opaque_src = opaque_fragment.str();
+        auto const alpha_src = alpha_fragment.str();
 
-        programs.emplace_back(id, std::make_unique<::Program>(
-            link_shader(vertex_shader, opaque_shader),
-            link_shader(vertex_shader, alpha_shader)));
+        if (cache)
+        {
+            auto opaque_program = cache->program(vertex_shader_src, opaque_src.c_str(), build(opaque_src));
+            auto alpha_program = cache->program(vertex_shader_src, alpha_src.c_str(), build(alpha_src));
 
-        return *programs.back().second;
+            programs.emplace_back(id, std::make_unique<::Program>(opaque_program, alpha_program));
+        }
+        else
+        {
+            programs.emplace_back(id, std::make_unique<::Program>(
+                ProgramHandle{build(opaque_src)()},
+                ProgramHandle{build(alpha_src)()}));
+        }
 
-        // We delete opaque_shader and alpha_shader here. This is fine; it only marks them
-        // for deletion. GL will only delete them once the GL Program they're linked in is destroyed.
+        return *programs.back().second;
     }
 
 private:
+    auto build(std::string const& fragment_src) -> std::function<GLuint()>
+    {
+        return [this, fragment_src]
+            {
+                if (!vertex_shader)
+                    vertex_shader = ShaderHandle{compile_shader(GL_VERTEX_SHADER, vertex_shader_src)};
+
+                ShaderHandle const fragment_shader{
+                    compile_shader(GL_FRAGMENT_SHADER, fragment_src.c_str())};
+
+                // We delete fragment_shader here. This is fine; it only marks it for deletion.
+                // GL will only delete it once the GL Program it's linked in is destroyed.
+                return link_shader(vertex_shader, fragment_shader).release();
+            };
+    }
+
     static GLuint compile_shader(GLenum type, GLchar const* src)
     {
         GLuint id = glCreateShader(type);
@@ -323,14 +371,18 @@ private:
         return program;
     }
 
-    ShaderHandle const vertex_shader;
+    ShaderHandle vertex_shader; ///< Only compiled if a program isn't cached
+    std::shared_ptr<ProgramCache> const cache;
     std::vector<std::pair<void*, std::unique_ptr<::Program>>> programs;
     // GL requires us to synchronise multi-threaded access to the shader APIs.
     std::mutex compilation_mutex;
 };
 
-mrg::Renderer::Program::Program(GLuint program_id)
+mrg::Renderer::Program::Program(GLuint program_id, std::shared_ptr<SharedProgram> const& shared)
+    : shared{shared}
 {
+    forget_uniforms();
+
     id = program_id;
     position_attr = glGetAttribLocation(id, "position");
     texcoord_attr = glGetAttribLocation(id, "texcoord");
@@ -349,12 +401,31 @@ mrg::Renderer::Program::Program(GLuint program_id)
     alpha_uniform = glGetUniformLocation(id, "alpha");
 }
 
+void mrg::Renderer::Program::forget_uniforms() const
+{
+    // NaN never compares equal, so a value to set always differs from these
+    auto const unknown = std::numeric_limits<GLfloat>::quiet_NaN();
+
+    screen_uniforms_generation = 0;
+    transform = glm::mat4{unknown};
+    centre = glm::vec2{unknown, unknown};
+    alpha = unknown;
+}
+
 mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
+    : Renderer(display_buffer, nullptr)
+{
+}
+
+mrg::Renderer::Renderer(
+    graphics::DisplayBuffer& display_buffer,
+    std::shared_ptr<ProgramCache> const& program_cache)
     : render_target(&display_buffer),
       clear_color{0.0f, 0.0f, 0.0f, 0.0f},
+      family{program_cache},
       default_program(family.add_program(vshader, default_fshader)),
       alpha_program(family.add_program(vshader, alpha_fshader)),
-      program_factory{std::make_unique<ProgramFactory>()},
+      program_factory{std::make_unique<ProgramFactory>(program_cache)},
       texture_cache(mgl::DefaultProgramFactory().create_texture_cache()),
       display_transform(1)
 {
@@ -407,12 +478,18 @@ mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+    default_program.shared = family.shared_program(default_program.id);
+    alpha_program.shared = family.shared_program(alpha_program.id);
+
     set_viewport(display_buffer.view_area());
 }
 
 mrg::Renderer::~Renderer()
 {
     render_target.ensure_current();
+
+    if (vertex_buffer)
+        glDeleteBuffers(1, &vertex_buffer);
 }
 
 void mrg::Renderer::tessellate(std::vector<mgl::Primitive>& primitives,
@@ -431,13 +508,62 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
     glClear(GL_COLOR_BUFFER_BIT);
 
     ++frameno;
+
+    // Tessellate everything first, so that the frame's vertices are uploaded together
+    vertices.clear();
+    draws.clear();
+    renderable_draws.clear();
+    for (auto const& r : renderables)
+    {
+        renderable_draws.push_back(draws.size());
+
+        primitives.clear();
+        tessellate(primitives, *r);
+        for (auto const& p : primitives)
+        {
+            draws.push_back({p.type, static_cast<GLint>(vertices.size()), p.nvertices});
+            vertices.insert(vertices.end(), p.vertices, p.vertices + p.nvertices);
+        }
+    }
+    renderable_draws.push_back(draws.size());
+
+    if (!vertices.empty())
+    {
+        if (!vertex_buffer)
+            glGenBuffers(1, &vertex_buffer);
+
+        // Respecifying the whole buffer lets the driver orphan the last frame's storage, rather than stall
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(mgl::Vertex), vertices.data(), GL_STREAM_DRAW);
+    }
+
+    // Renderables are drawn in order, as blending requires; sorting them by
+    // state would change the picture, so the state is just not set twice.
+    state = DrawState{};
+    auto next = renderable_draws.begin();
     for (auto const& r : renderables)
     {
-        draw(*r);
+        draw(*r, draws.begin() + next[0], draws.begin() + next[1]);
+        ++next;
     }
 
+    if (state.position_attr >= 0)
+        glDisableVertexAttribArray(state.position_attr);
+    if (state.texcoord_attr >= 0)
+        glDisableVertexAttribArray(state.texcoord_attr);
+    use_scissor(false);
+
+    if (!vertices.empty())
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
     render_target.swap_buffers();
 
+    if (frameno == 1)
+    {
+        std::chrono::duration<double, std::milli> const elapsed{std::chrono::steady_clock::now() - creation_time};
+        mir::log_debug("First frame rendered %.1fms after the renderer was created", elapsed.count());
+    }
+
     // Deleting unused textures only requires the GL context. This clean-up
     // does not affect screen contents so can happen after swap_buffers...
     texture_cache->drop_unused();
@@ -446,12 +572,15 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
         mir::log_debug("GL error: %d", gl_error);
 }
 
-void mrg::Renderer::draw(mg::Renderable const& renderable) const
+void mrg::Renderer::draw(
+    mg::Renderable const& renderable,
+    Draws::const_iterator begin,
+    Draws::const_iterator end) const
 {
     auto const clip_area = renderable.clip_area();
+    use_scissor(static_cast<bool>(clip_area));
     if (clip_area)
     {
-        glEnable(GL_SCISSOR_TEST);
         glScissor(
             clip_area.value().top_left.x.as_int() -
                 viewport.top_left.x.as_int(),
@@ -513,33 +642,10 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
 
     auto const& prog = *maybe_prog;
 
-    glUseProgram(prog.id);
-    if (prog.last_used_frameno != frameno)
-    {   // Avoid reloading the screen-global uniforms on every renderable
-        // TODO: We actually only need to bind these *once*, right? Not once per frame?
-        prog.last_used_frameno = frameno;
-        for (auto i = 0u; i < prog.tex_uniforms.size(); ++i)
-        {
-            if (prog.tex_uniforms[i] != -1)
-            {
-                glUniform1i(prog.tex_uniforms[i], i);
-            }
-        }
-        glUniformMatrix4fv(prog.display_transform_uniform, 1, GL_FALSE,
-                           glm::value_ptr(display_transform));
-        glUniformMatrix4fv(prog.screen_to_gl_coords_uniform, 1, GL_FALSE,
-                           glm::value_ptr(screen_to_gl_coords));
-    }
+    auto const program_lock = use_program(prog);
 
     glActiveTexture(GL_TEXTURE0);
 
-    auto const& rect = renderable.screen_position();
-    GLfloat centrex = rect.top_left.x.as_int() +
-                      rect.size.width.as_int() / 2.0f;
-    GLfloat centrey = rect.top_left.y.as_int() +
-                      rect.size.height.as_int() / 2.0f;
-    glUniform2f(prog.centre_uniform, centrex, centrey);
-
     glm::mat4 transform = renderable.transformation();
     if (texture && (texture->layout() == mg::gl::Texture::Layout::TopRowFirst))
     {
@@ -553,99 +659,187 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
         };
     }
 
-    glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE,
-                       glm::value_ptr(transform));
+    if (transform != prog.transform)
+    {
+        prog.transform = transform;
+        glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE,
+                           glm::value_ptr(transform));
+    }
 
-    if (prog.alpha_uniform >= 0)
-        glUniform1f(prog.alpha_uniform, renderable.alpha());
+    // The centre only matters to a transform other than the identity (most surfaces)
+    if (transform != glm::mat4{1.0f})
+    {
+        auto const& rect = renderable.screen_position();
+        glm::vec2 const centre{
+            rect.top_left.x.as_int() + rect.size.width.as_int() / 2.0f,
+            rect.top_left.y.as_int() + rect.size.height.as_int() / 2.0f};
 
-    glEnableVertexAttribArray(prog.position_attr);
-    glEnableVertexAttribArray(prog.texcoord_attr);
+        if (centre != prog.centre)
+        {
+            prog.centre = centre;
+            glUniform2f(prog.centre_uniform, centre.x, centre.y);
+        }
+    }
 
-    primitives.clear();
-    tessellate(primitives, renderable);
+    if (prog.alpha_uniform >= 0 && renderable.alpha() != prog.alpha)
+    {
+        prog.alpha = renderable.alpha();
+        glUniform1f(prog.alpha_uniform, prog.alpha);
+    }
 
     // if we fail to load the texture, we need to carry on (part of lp:1629275)
     try
     {
-        typedef struct  // Represents parameters of glBlendFuncSeparate()
-        {
-            GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
-        } BlendSeparate;
-
-        BlendSeparate client_blend;
-
         // These renderable method names could be better (see LP: #1236224)
         if (renderable.shaped())  // Client is RGBA:
         {
-            client_blend = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
-                            GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
+            use_blending(true, {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
+                                GL_ONE, GL_ONE_MINUS_SRC_ALPHA}, 1.0f);
         }
         else if (renderable.alpha() == 1.0f)  // RGBX and no window translucency:
         {
-            client_blend = {GL_ONE,  GL_ZERO,
-                            GL_ZERO, GL_ONE};  // Avoid using src_alpha!
+            use_blending(false, {}, 1.0f);  // Avoid using src_alpha!
         }
         else
         {   // Client is RGBX but we also have window translucency.
             // The texture alpha channel is possibly uninitialized so we must be
             // careful and avoid using SRC_ALPHA (LP: #1423462).
-            client_blend = {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
-                            GL_ZERO, GL_ONE};
-            glBlendColor(0.0f, 0.0f, 0.0f, renderable.alpha());
+            use_blending(true, {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
+                                GL_ZERO, GL_ONE}, renderable.alpha());
         }
 
-        for (auto const& p : primitives)
+        if (surface_tex)
+        {
+            surface_tex->bind();
+        }
+        else
         {
-            BlendSeparate blend;
+            texture->bind();
+        }
 
-            blend = client_blend;
-            if (surface_tex)
-            {
-                surface_tex->bind();
-            }
-            else
-            {
-                texture->bind();
-            }
+        for (auto d = begin; d != end; ++d)
+        {
+            glDrawArrays(d->type, d->first, d->count);
+        }
 
-            glVertexAttribPointer(prog.position_attr, 3, GL_FLOAT,
-                                  GL_FALSE, sizeof(mgl::Vertex),
-                                  &p.vertices[0].position);
-            glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT,
-                                  GL_FALSE, sizeof(mgl::Vertex),
-                                  &p.vertices[0].texcoord);
+        if (texture)
+        {
+            // We're done with the texture for now
+            texture->add_syncpoint();
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        report_exception();
+    }
+}
 
-            if (blend.dst_rgb == GL_ZERO)
-            {
-                glDisable(GL_BLEND);
-            }
-            else
-            {
-                glEnable(GL_BLEND);
-                glBlendFuncSeparate(blend.src_rgb,   blend.dst_rgb,
-                                    blend.src_alpha, blend.dst_alpha);
-            }
+auto mrg::Renderer::use_program(Program const& prog) const -> std::unique_lock<std::mutex>
+{
+    std::unique_lock<std::mutex> lock;
+    if (prog.shared)
+    {
+        // Another renderer may have set the program's uniforms since we drew with it
+        lock = std::unique_lock<std::mutex>{prog.shared->mutex};
+        if (prog.shared->user != this)
+        {
+            prog.shared->user = this;
+            prog.forget_uniforms();
 
-            glDrawArrays(p.type, 0, p.nvertices);
+            // Rebinding makes another context's changes to the program visible to ours
+            state.program = nullptr;
+        }
+    }
 
-            if (texture)
+    if (state.program != &prog)
+    {
+        state.program = &prog;
+        glUseProgram(prog.id);
+    }
+
+    if (prog.screen_uniforms_generation != screen_uniforms_generation)
+    {   // Avoid reloading the screen-global uniforms on every renderable
+        prog.screen_uniforms_generation = screen_uniforms_generation;
+        for (auto i = 0u; i < prog.tex_uniforms.size(); ++i)
+        {
+            if (prog.tex_uniforms[i] != -1)
             {
-                // We're done with the texture for now
-                texture->add_syncpoint();
+                glUniform1i(prog.tex_uniforms[i], i);
             }
         }
+        glUniformMatrix4fv(prog.display_transform_uniform, 1, GL_FALSE,
+                           glm::value_ptr(display_transform));
+        glUniformMatrix4fv(prog.screen_to_gl_coords_uniform, 1, GL_FALSE,
+                           glm::value_ptr(screen_to_gl_coords));
     }
-    catch (std::exception const& ex)
+
+    // Attribute arrays are not part of a program, so only need changing if its locations differ
+    if (prog.position_attr != state.position_attr || prog.texcoord_attr != state.texcoord_attr)
     {
-        report_exception();
+        if (state.position_attr >= 0)
+            glDisableVertexAttribArray(state.position_attr);
+        if (state.texcoord_attr >= 0)
+            glDisableVertexAttribArray(state.texcoord_attr);
+
+        state.position_attr = prog.position_attr;
+        state.texcoord_attr = prog.texcoord_attr;
+
+        glEnableVertexAttribArray(prog.position_attr);
+        glEnableVertexAttribArray(prog.texcoord_attr);
+
+        // Offsets into vertex_buffer
+        glVertexAttribPointer(prog.position_attr, 3, GL_FLOAT,
+                              GL_FALSE, sizeof(mgl::Vertex),
+                              reinterpret_cast<void const*>(offsetof(mgl::Vertex, position)));
+        glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT,
+                              GL_FALSE, sizeof(mgl::Vertex),
+                              reinterpret_cast<void const*>(offsetof(mgl::Vertex, texcoord)));
     }
 
-    glDisableVertexAttribArray(prog.texcoord_attr);
-    glDisableVertexAttribArray(prog.position_attr);
-    if (renderable.clip_area())
+    return lock;
+}
+
+void mrg::Renderer::use_blending(bool enabled, std::array<GLenum, 4> const& func, GLfloat alpha) const
+{
+    if (!enabled)
     {
-        glDisable(GL_SCISSOR_TEST);
+        if (state.blend != DrawState::Blend::disabled)
+        {
+            state.blend = DrawState::Blend::disabled;
+            glDisable(GL_BLEND);
+        }
+        return;
+    }
+
+    if (state.blend != DrawState::Blend::enabled)
+    {
+        state.blend = DrawState::Blend::enabled;
+        glEnable(GL_BLEND);
+    }
+
+    // (state.blend_func starts out all GL_ZERO, which is never used with blending enabled)
+    if (func != state.blend_func)
+    {
+        state.blend_func = func;
+        glBlendFuncSeparate(func[0], func[1], func[2], func[3]);
+    }
+
+    if (func[1] == GL_ONE_MINUS_CONSTANT_ALPHA && alpha != state.blend_alpha)
+    {
+        state.blend_alpha = alpha;
+        glBlendColor(0.0f, 0.0f, 0.0f, alpha);
+    }
+}
+
+void mrg::Renderer::use_scissor(bool enabled) const
+{
+    if (enabled != state.scissor)
+    {
+        state.scissor = enabled;
+        if (enabled)
+            glEnable(GL_SCISSOR_TEST);
+        else
+            glDisable(GL_SCISSOR_TEST);
     }
 }
 
@@ -689,6 +883,7 @@ void mrg::Renderer::set_viewport(geometry::Rectangle const& rect)
                       0.0f});
 
     viewport = rect;
+    ++screen_uniforms_generation;
     update_gl_viewport();
 }
 
@@ -734,6 +929,7 @@ void mrg::Renderer::set_output_transform(glm::mat2 const& t)
     if (new_display_transform != display_transform)
     {
         display_transform = new_display_transform;
+        ++screen_uniforms_generation;
         update_gl_viewport();
     }
 }
@@ -29,6 +29,10 @@
 #include "mir/renderer/gl/render_target.h"
 
 #include <GLES2/gl2.h>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -41,6 +45,8 @@ namespace renderer
 {
 namespace gl
 {
+class ProgramCache;
+struct SharedProgram;
 
 class CurrentRenderTarget
 {
@@ -60,6 +66,8 @@ class Renderer : public renderer::Renderer
 {
 public:
     Renderer(graphics::DisplayBuffer& display_buffer);
+    /// \param program_cache shared by renderers, to avoid compiling their GL programs (may be null)
+    Renderer(graphics::DisplayBuffer& display_buffer, std::shared_ptr<ProgramCache> const& program_cache);
     virtual ~Renderer();
 
     // These are called with a valid GL context:
@@ -85,11 +93,27 @@ public:
         GLint transform_uniform = -1;
         GLint screen_to_gl_coords_uniform = -1;
         GLint alpha_uniform = -1;
-        mutable long long last_used_frameno = 0;
 
-        Program(GLuint program_id);
+        /// Set if other renderers use the program too (see use_program())
+        std::shared_ptr<SharedProgram> shared;
+
+        /* The values this program's uniforms were last set to, so that they
+         * need only be set when they change. (They start unknown: another
+         * renderer may have set them.)
+         */
+        mutable long long screen_uniforms_generation;
+        mutable glm::mat4 transform;
+        mutable glm::vec2 centre;
+        mutable GLfloat alpha;
+
+        Program(GLuint program_id, std::shared_ptr<SharedProgram> const& shared = nullptr);
+
+        /// Makes the uniforms be set again before the next draw
+        void forget_uniforms() const;
     };
 private:
+    /// So that we can log how long it takes to get the first frame out
+    std::chrono::steady_clock::time_point const creation_time{std::chrono::steady_clock::now()};
     mutable CurrentRenderTarget render_target;
 
 protected:
@@ -123,10 +147,33 @@ protected:
     static const GLchar* const default_fshader;
     static const GLchar* const alpha_fshader;
 
-    virtual void draw(graphics::Renderable const& renderable) const;
+    /// A run of the frame's vertices, drawn by a single glDrawArrays()
+    struct Draw
+    {
+        GLenum type;
+        GLint first;
+        GLsizei count;
+    };
+    using Draws = std::vector<Draw>;
+
+    /**
+     * draw issues the GL calls for a renderable, whose primitives have
+     * already been tessellated into the frame's vertex buffer.
+     *
+     * \param [in] renderable The renderable surface being drawn.
+     * \param [in] begin,end  The draws for the renderable's primitives.
+     */
+    virtual void draw(
+        graphics::Renderable const& renderable,
+        Draws::const_iterator begin,
+        Draws::const_iterator end) const;
 
 private:
     void update_gl_viewport();
+    /// \return a lock on the program, if shared, to hold until drawn with
+    auto use_program(Program const& program) const -> std::unique_lock<std::mutex>;
+    void use_blending(bool enabled, std::array<GLenum, 4> const& func, GLfloat alpha) const;
+    void use_scissor(bool enabled) const;
 
     class ProgramFactory;
     std::unique_ptr<ProgramFactory> const program_factory;
@@ -134,7 +181,30 @@ private:
     geometry::Rectangle viewport;
     glm::mat4 screen_to_gl_coords;
     glm::mat4 display_transform;
+    /// Bumped whenever screen_to_gl_coords or display_transform change
+    long long screen_uniforms_generation = 1;
     std::vector<mir::gl::Primitive> mutable primitives;
+
+    /* Every renderable's vertices are uploaded to one buffer each frame,
+     * rather than passed as client-side arrays renderable by renderable.
+     */
+    GLuint mutable vertex_buffer = 0;
+    std::vector<mir::gl::Vertex> mutable vertices;
+    Draws mutable draws;
+    std::vector<Draws::size_type> mutable renderable_draws;
+
+    /// The GL state draw() has set this frame, so that it's only changed when it needs to be
+    struct DrawState
+    {
+        Program const* program = nullptr;
+        GLint position_attr = -1;
+        GLint texcoord_attr = -1;
+        enum class Blend { unknown, disabled, enabled } blend = Blend::unknown;
+        std::array<GLenum, 4> blend_func{};
+        GLfloat blend_alpha = -1.0f;
+        bool scissor = false;
+    };
+    DrawState mutable state;
 };
 
 }
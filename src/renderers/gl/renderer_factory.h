@@ -21,18 +21,28 @@
 
 #include "mir/renderer/renderer_factory.h"
 
+#include <memory>
+
 namespace mir
 {
 namespace renderer
 {
 namespace gl
 {
+class ProgramCache;
 
 class RendererFactory : public renderer::RendererFactory
 {
 public:
+    RendererFactory() = default;
+    /// \param program_cache shared by all renderers (may be null, to compile programs every time)
+    explicit RendererFactory(std::shared_ptr<ProgramCache> const& program_cache);
+
     std::unique_ptr<renderer::Renderer> create_renderer_for(
         graphics::DisplayBuffer& display_buffer) override;
+
+private:
+    std::shared_ptr<ProgramCache> const program_cache;
 };
 
 }
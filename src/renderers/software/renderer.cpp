@@ -0,0 +1,614 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "SoftwareRenderer"
+
+#include "renderer.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/buffer.h"
+#include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/log.h"
+#include "mir/report_exception.h"
+
+#include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// Beyond this many damaged regions it is cheaper to redraw their bounding box
+auto const max_damage_rects = 16u;
+
+struct PixelLayout
+{
+    bool red_in_low_byte;   ///< ABGR/XBGR rather than ARGB/XRGB
+    bool has_alpha;
+};
+
+auto layout_of(MirPixelFormat format) -> std::experimental::optional<PixelLayout>
+{
+    switch (format)
+    {
+    case mir_pixel_format_argb_8888: return PixelLayout{false, true};
+    case mir_pixel_format_xrgb_8888: return PixelLayout{false, false};
+    case mir_pixel_format_abgr_8888: return PixelLayout{true, true};
+    case mir_pixel_format_xbgr_8888: return PixelLayout{true, false};
+    default: return {};
+    }
+}
+
+/*
+ * The blending primitives below operate on all four 8-bit channels of a
+ * pixel at once, two channels per 32-bit lane (the same SWAR arithmetic as
+ * pixman's UN8x4 macros).
+ */
+
+/// Multiply each channel of x by a/255, rounding to nearest
+inline auto mul_un8x4(uint32_t x, uint32_t a) -> uint32_t
+{
+    uint32_t rb = (x & 0x00ff00ff) * a + 0x00800080;
+    rb = ((rb + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+
+    uint32_t ag = ((x >> 8) & 0x00ff00ff) * a + 0x00800080;
+    ag = (ag + ((ag >> 8) & 0x00ff00ff)) & 0xff00ff00;
+
+    return ag | rb;
+}
+
+/// Add each channel of x and y, saturating at 255
+inline auto add_un8x4(uint32_t x, uint32_t y) -> uint32_t
+{
+    uint32_t rb = (x & 0x00ff00ff) + (y & 0x00ff00ff);
+    rb |= 0x01000100 - ((rb >> 8) & 0x00ff00ff);
+    rb &= 0x00ff00ff;
+
+    uint32_t ag = ((x >> 8) & 0x00ff00ff) + ((y >> 8) & 0x00ff00ff);
+    ag |= 0x01000100 - ((ag >> 8) & 0x00ff00ff);
+    ag &= 0x00ff00ff;
+
+    return rb | (ag << 8);
+}
+
+inline auto swap_red_blue(uint32_t p) -> uint32_t
+{
+    return (p & 0xff00ff00) | ((p & 0x00ff0000) >> 16) | ((p & 0x000000ff) << 16);
+}
+
+/// Porter-Duff OVER for premultiplied pixels
+inline auto over(uint32_t src, uint32_t dest) -> uint32_t
+{
+    return add_un8x4(src, mul_un8x4(dest, 255 - (src >> 24)));
+}
+
+struct SpanOp
+{
+    uint32_t alpha;     ///< Renderable alpha, [0, 255]
+    uint32_t step;      ///< Source pixels per destination pixel, 16.16 fixed point
+};
+
+/*
+ * Composite count pixels of a source row into dest, starting at source pixel
+ * src_x (16.16 fixed point).
+ *
+ * The loop-invariant choices are template parameters so that the common
+ * cases compile to tight loops that the compiler can vectorise.
+ */
+template<bool swap, bool blend>
+void composite_span(
+    uint32_t* dest,
+    unsigned char const* src_row,
+    int count,
+    uint32_t src_x,
+    SpanOp const& op)
+{
+    for (int i = 0; i != count; ++i, src_x += op.step)
+    {
+        uint32_t pixel;
+        ::memcpy(&pixel, src_row + (src_x >> 16) * sizeof pixel, sizeof pixel);
+
+        if (swap)
+            pixel = swap_red_blue(pixel);
+
+        if (!blend)
+            pixel |= 0xff000000;
+
+        if (op.alpha != 255)
+            pixel = mul_un8x4(pixel, op.alpha);
+
+        dest[i] = (blend || op.alpha != 255) ? over(pixel, dest[i]) : pixel;
+    }
+}
+
+using SpanFunction = void(*)(uint32_t*, unsigned char const*, int, uint32_t, SpanOp const&);
+
+auto select_span_function(bool swap, bool blend) -> SpanFunction
+{
+    if (swap)
+        return blend ? &composite_span<true, true> : &composite_span<true, false>;
+    else
+        return blend ? &composite_span<false, true> : &composite_span<false, false>;
+}
+
+/// A renderable whose pixels have been mapped for this frame
+struct MappedSource
+{
+    std::unique_ptr<mrs::Mapping<unsigned char const>> mapping;
+    geom::Rectangle screen_position;
+    std::experimental::optional<geom::Rectangle> clip_area;
+    SpanFunction span;
+    SpanOp op;
+    uint32_t src_left;  ///< First source column of the texture bounds, 16.16 fixed point
+    int src_top;        ///< First source row of the texture bounds
+    int src_height;     ///< Source rows within the texture bounds
+};
+
+/**
+ * Maps between screen coordinates and framebuffer pixels.
+ *
+ * The output transformation is applied about the centre of the viewport,
+ * as the GL renderer does, with y pointing down rather than up.
+ */
+class FramebufferMapping
+{
+public:
+    FramebufferMapping(geom::Rectangle const& viewport, geom::Size const& fb_size, glm::mat2 const& transform)
+        : viewport{viewport},
+          fb_size{fb_size},
+          identity{transform == glm::mat2{1}},
+          // Flipping y on both sides of the transformation negates its off-diagonal elements
+          to_fb{transform[0][0], -transform[0][1], -transform[1][0], transform[1][1]},
+          to_screen{glm::transpose(to_fb)}
+    {
+    }
+
+    bool is_identity() const { return identity; }
+
+    /// Screen coordinates of framebuffer pixel (0, 0) without a transformation
+    auto offset() const -> geom::Displacement { return viewport.top_left - geom::Point{}; }
+
+    /// The framebuffer pixels showing the screen area
+    auto framebuffer_area(geom::Rectangle const& screen) const -> geom::Rectangle
+    {
+        if (identity)
+            return {screen.top_left - offset(), screen.size};
+
+        auto const a = framebuffer_point(screen.left().as_int(), screen.top().as_int());
+        auto const b = framebuffer_point(screen.right().as_int(), screen.bottom().as_int());
+
+        auto const left = static_cast<int>(std::lround(std::min(a.x, b.x)));
+        auto const top = static_cast<int>(std::lround(std::min(a.y, b.y)));
+        auto const right = static_cast<int>(std::lround(std::max(a.x, b.x)));
+        auto const bottom = static_cast<int>(std::lround(std::max(a.y, b.y)));
+        return {{left, top}, {right - left, bottom - top}};
+    }
+
+    /// The screen pixel shown by framebuffer pixel (x, y)
+    auto screen_pixel(int x, int y) const -> geom::Point
+    {
+        // Map the centre of the pixel to avoid rounding the wrong way at edges
+        auto const fb = glm::vec2{
+            2.0f * (x + 0.5f) / fb_size.width.as_int() - 1.0f,
+            2.0f * (y + 0.5f) / fb_size.height.as_int() - 1.0f};
+        auto const screen = to_screen * fb;
+
+        return {
+            viewport.left().as_int() + static_cast<int>(std::floor((screen.x + 1.0f) / 2.0f * viewport.size.width.as_int())),
+            viewport.top().as_int() + static_cast<int>(std::floor((screen.y + 1.0f) / 2.0f * viewport.size.height.as_int()))};
+    }
+
+private:
+    auto framebuffer_point(int x, int y) const -> glm::vec2
+    {
+        auto const screen = glm::vec2{
+            2.0f * (x - viewport.left().as_int()) / viewport.size.width.as_int() - 1.0f,
+            2.0f * (y - viewport.top().as_int()) / viewport.size.height.as_int() - 1.0f};
+        auto const fb = to_fb * screen;
+
+        return {(fb.x + 1.0f) / 2.0f * fb_size.width.as_int(), (fb.y + 1.0f) / 2.0f * fb_size.height.as_int()};
+    }
+
+    geom::Rectangle const viewport;
+    geom::Size const fb_size;
+    bool const identity;
+    glm::mat2 const to_fb;
+    glm::mat2 const to_screen;  ///< Output transformations are orthogonal, so this is the inverse
+};
+
+auto visible_bounds(
+    geom::Rectangle const& screen_position,
+    std::experimental::optional<geom::Rectangle> const& clip_area) -> geom::Rectangle
+{
+    return clip_area ? screen_position.intersection_with(clip_area.value()) : screen_position;
+}
+
+void fill(mrs::Mapping<unsigned char>& framebuffer, geom::Rectangle const& area, uint32_t value)
+{
+    auto const stride = framebuffer.stride().as_uint32_t();
+    for (auto y = area.top().as_int(); y != area.bottom().as_int(); ++y)
+    {
+        auto const row = reinterpret_cast<uint32_t*>(framebuffer.data() + y * stride);
+        std::fill(row + area.left().as_int(), row + area.right().as_int(), value);
+    }
+}
+
+/// Composite source into the framebuffer area (in framebuffer coordinates) of a transformed output
+void composite_transformed(
+    mrs::Mapping<unsigned char>& framebuffer,
+    geom::Rectangle const& area,
+    FramebufferMapping const& mapping,
+    MappedSource const& source)
+{
+    auto const& position = source.screen_position;
+    auto const src_stride = source.mapping->stride().as_uint32_t();
+    auto const src_width = source.mapping->size().width.as_int();
+    auto const dest_stride = framebuffer.stride().as_uint32_t();
+
+    auto const left = area.left().as_int();
+    auto const width = area.size.width.as_int();
+
+    // Gather the source pixels each framebuffer row shows, then composite them as an untransformed span
+    std::vector<uint32_t> gathered(width);
+    auto const op = SpanOp{source.op.alpha, 0x10000};
+
+    for (auto y = area.top().as_int(); y != area.bottom().as_int(); ++y)
+    {
+        for (auto i = 0; i != width; ++i)
+        {
+            auto const screen = mapping.screen_pixel(left + i, y);
+            auto const src_x = std::clamp<int>(
+                (source.src_left + static_cast<uint32_t>(screen.x.as_int() - position.left().as_int()) * source.op.step) >> 16,
+                0, src_width - 1);
+            auto const src_y = std::clamp<int>(
+                source.src_top +
+                    (static_cast<int64_t>(screen.y.as_int() - position.top().as_int()) * source.src_height) /
+                        position.size.height.as_int(),
+                0, source.mapping->size().height.as_int() - 1);
+
+            ::memcpy(&gathered[i], source.mapping->data() + src_y * src_stride + src_x * sizeof(uint32_t), sizeof(uint32_t));
+        }
+
+        auto const dest_row = reinterpret_cast<uint32_t*>(framebuffer.data() + y * dest_stride);
+        source.span(
+            dest_row + left,
+            reinterpret_cast<unsigned char const*>(gathered.data()),
+            width,
+            0,
+            op);
+    }
+}
+
+/// Composite source into the framebuffer area (in framebuffer coordinates)
+void composite(
+    mrs::Mapping<unsigned char>& framebuffer,
+    geom::Rectangle const& area,
+    FramebufferMapping const& mapping,
+    MappedSource const& source)
+{
+    if (!mapping.is_identity())
+    {
+        composite_transformed(framebuffer, area, mapping, source);
+        return;
+    }
+
+    auto const fb_to_screen = mapping.offset();
+    auto const& position = source.screen_position;
+    auto const src_stride = source.mapping->stride().as_uint32_t();
+    auto const dest_stride = framebuffer.stride().as_uint32_t();
+
+    auto const left = area.left().as_int();
+    auto const width = area.size.width.as_int();
+    auto const src_x = source.src_left + static_cast<uint32_t>((left + fb_to_screen.dx.as_int() - position.left().as_int())) *
+        source.op.step;
+
+    for (auto y = area.top().as_int(); y != area.bottom().as_int(); ++y)
+    {
+        auto const src_y = source.src_top +
+            (static_cast<int64_t>(y + fb_to_screen.dy.as_int() - position.top().as_int()) *
+                source.src_height) / position.size.height.as_int();
+
+        auto const dest_row = reinterpret_cast<uint32_t*>(framebuffer.data() + y * dest_stride);
+        source.span(
+            dest_row + left,
+            source.mapping->data() + src_y * src_stride,
+            width,
+            src_x,
+            source.op);
+    }
+}
+}
+
+mrs::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
+    : render_target{dynamic_cast<RenderTarget*>(display_buffer.native_display_buffer())}
+{
+    if (!render_target)
+        BOOST_THROW_EXCEPTION(std::logic_error("DisplayBuffer does not support software rendering"));
+
+    set_viewport(display_buffer.view_area());
+}
+
+void mrs::Renderer::set_viewport(geometry::Rectangle const& rect)
+{
+    if (rect == viewport)
+        return;
+
+    viewport = rect;
+    needs_full_redraw = true;
+}
+
+void mrs::Renderer::set_output_transform(glm::mat2 const& t)
+{
+    if (t == output_transform)
+        return;
+
+    output_transform = t;
+    needs_full_redraw = true;
+}
+
+void mrs::Renderer::suspend()
+{
+    // Something else (an overlay) has been presented; we can't trust the framebuffer
+    needs_full_redraw = true;
+}
+
+auto mrs::Renderer::last_damage() const -> std::vector<geometry::Rectangle>
+{
+    return damage;
+}
+
+void mrs::Renderer::render(mg::RenderableList const& renderables) const
+{
+    damage = damage_for(renderables);
+
+    std::vector<geom::Rectangle> framebuffer_damage;
+
+    if (!damage.empty())
+    {
+        auto const framebuffer = render_target->map_framebuffer();
+        auto const fb_layout = layout_of(framebuffer->format());
+        if (!fb_layout)
+        {
+            BOOST_THROW_EXCEPTION(std::runtime_error(
+                "Unsupported framebuffer format for software rendering: " +
+                std::to_string(framebuffer->format())));
+        }
+
+        geom::Rectangle const fb_bounds{{0, 0}, framebuffer->size()};
+        FramebufferMapping const mapping{viewport, framebuffer->size(), output_transform};
+
+        std::vector<MappedSource> sources;
+        sources.reserve(renderables.size());
+        for (auto const& renderable : renderables)
+        {
+            auto const bounds = visible_bounds(renderable->screen_position(), renderable->clip_area());
+            bool const needed = std::any_of(
+                damage.begin(), damage.end(),
+                [&bounds](auto const& region) { return bounds.overlaps(region); });
+
+            if (!needed || renderable->screen_position().size.width.as_int() <= 0 ||
+                renderable->screen_position().size.height.as_int() <= 0)
+            {
+                continue;
+            }
+
+            // if we fail to map a buffer we need to carry on with the rest of the scene
+            auto const buffer = renderable->buffer();
+            try
+            {
+                auto const layout = layout_of(buffer->pixel_format());
+                if (!layout)
+                {
+                    mir::log_debug("Skipping buffer in unsupported format %d", static_cast<int>(buffer->pixel_format()));
+                    continue;
+                }
+
+                auto mapping = as_read_mappable_buffer(buffer)->map_readable();
+                auto const src_size = mapping->size();
+                auto const tex = renderable->texture_bounds();
+                auto const src_width = (tex.right - tex.left) * src_size.width.as_int();
+                auto const dest_width = renderable->screen_position().size.width.as_uint32_t();
+
+                MappedSource source{
+                    std::move(mapping),
+                    renderable->screen_position(),
+                    renderable->clip_area(),
+                    select_span_function(
+                        layout->red_in_low_byte != fb_layout->red_in_low_byte,
+                        renderable->shaped() && layout->has_alpha),
+                    SpanOp{
+                        static_cast<uint32_t>(std::clamp(renderable->alpha(), 0.0f, 1.0f) * 255.0f + 0.5f),
+                        static_cast<uint32_t>(static_cast<uint64_t>(src_width * 65536.0) / dest_width)},
+                    static_cast<uint32_t>(tex.left * src_size.width.as_int() * 65536.0),
+                    static_cast<int>(tex.top * src_size.height.as_int()),
+                    static_cast<int>((tex.bottom - tex.top) * src_size.height.as_int())};
+
+                if (source.op.alpha != 0)
+                    sources.push_back(std::move(source));
+            }
+            catch (std::exception const&)
+            {
+                // It will fail the same way every frame: only say so the first time
+                auto const id = buffer->id();
+                if (std::find(unmappable_buffers.begin(), unmappable_buffers.end(), id) == unmappable_buffers.end())
+                {
+                    report_exception();
+                    unmappable_buffers.push_back(id);
+                }
+            }
+        }
+
+        for (auto const& region : damage)
+        {
+            auto const area = mapping.framebuffer_area(region).intersection_with(fb_bounds);
+
+            if (area.size.width.as_int() <= 0 || area.size.height.as_int() <= 0)
+                continue;
+
+            fill(*framebuffer, area, 0);
+            framebuffer_damage.push_back(area);
+
+            for (auto const& source : sources)
+            {
+                auto const visible = visible_bounds(source.screen_position, source.clip_area);
+                auto const target = mapping.framebuffer_area(visible).intersection_with(area);
+
+                if (target.size.width.as_int() > 0 && target.size.height.as_int() > 0)
+                    composite(*framebuffer, target, mapping, source);
+            }
+        }
+    }
+
+    render_target->commit(framebuffer_damage);
+
+    // Forget buffers that are no longer in the scene
+    unmappable_buffers.erase(
+        std::remove_if(
+            unmappable_buffers.begin(), unmappable_buffers.end(),
+            [&renderables](mg::BufferID id)
+            {
+                return std::none_of(
+                    renderables.begin(), renderables.end(),
+                    [id](auto const& renderable)
+                    {
+                        auto const buffer = renderable->buffer();
+                        return buffer && buffer->id() == id;
+                    });
+            }),
+        unmappable_buffers.end());
+}
+
+auto mrs::Renderer::damage_for(mg::RenderableList const& renderables) const -> std::vector<geom::Rectangle>
+{
+    std::vector<RenderedState> current;
+    current.reserve(renderables.size());
+    for (auto const& renderable : renderables)
+    {
+        auto const buffer = renderable->buffer();
+        current.push_back(RenderedState{
+            renderable->id(),
+            buffer ? buffer->id() : mg::BufferID{},
+            renderable->screen_position(),
+            renderable->clip_area(),
+            renderable->alpha(),
+            renderable->shaped(),
+            renderable->texture_bounds()});
+    }
+
+    std::vector<geom::Rectangle> regions;
+
+    if (needs_full_redraw)
+    {
+        regions.push_back(viewport);
+    }
+    else
+    {
+        auto const bounds = [](RenderedState const& state)
+            {
+                return visible_bounds(state.screen_position, state.clip_area);
+            };
+
+        std::unordered_map<mg::Renderable::ID, size_t> previous_index;
+        for (auto i = 0u; i != previous_frame.size(); ++i)
+            previous_index[previous_frame[i].id] = i;
+
+        std::unordered_map<mg::Renderable::ID, size_t> current_index;
+        for (auto i = 0u; i != current.size(); ++i)
+            current_index[current[i].id] = i;
+
+        // Things that have gone away uncover whatever was beneath them
+        for (auto const& state : previous_frame)
+        {
+            if (current_index.find(state.id) == current_index.end())
+                regions.push_back(bounds(state));
+        }
+
+        std::vector<mg::Renderable::ID> surviving_previous_order;
+        std::vector<mg::Renderable::ID> surviving_current_order;
+
+        for (auto const& state : current)
+        {
+            auto const prev = previous_index.find(state.id);
+            if (prev == previous_index.end())
+            {
+                regions.push_back(bounds(state));
+                continue;
+            }
+
+            surviving_current_order.push_back(state.id);
+
+            auto const& before = previous_frame[prev->second];
+            if (before.buffer_id != state.buffer_id ||
+                before.screen_position != state.screen_position ||
+                before.clip_area != state.clip_area ||
+                before.alpha != state.alpha ||
+                before.shaped != state.shaped ||
+                before.texture_bounds != state.texture_bounds)
+            {
+                regions.push_back(bounds(before));
+                regions.push_back(bounds(state));
+            }
+        }
+
+        for (auto const& state : previous_frame)
+        {
+            if (current_index.find(state.id) != current_index.end())
+                surviving_previous_order.push_back(state.id);
+        }
+
+        // Restacking changes whatever the restacked renderables overlap
+        for (auto i = 0u; i != surviving_current_order.size(); ++i)
+        {
+            if (surviving_current_order[i] != surviving_previous_order[i])
+            {
+                regions.push_back(bounds(current[current_index[surviving_current_order[i]]]));
+                regions.push_back(bounds(current[current_index[surviving_previous_order[i]]]));
+            }
+        }
+    }
+
+    previous_frame = std::move(current);
+    needs_full_redraw = false;
+
+    std::vector<geom::Rectangle> result;
+    for (auto const& region : regions)
+    {
+        auto const clipped = region.intersection_with(viewport);
+        if (clipped.size.width.as_int() > 0 && clipped.size.height.as_int() > 0 &&
+            std::find(result.begin(), result.end(), clipped) == result.end())
+        {
+            result.push_back(clipped);
+        }
+    }
+
+    if (result.size() > max_damage_rects)
+    {
+        geom::Rectangles all;
+        for (auto const& region : result)
+            all.add(region);
+        result = {all.bounding_rectangle()};
+    }
+
+    return result;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SOFTWARE_RENDERER_H_
+#define MIR_RENDERER_SOFTWARE_RENDERER_H_
+
+#include <mir/renderer/renderer.h>
+#include <mir/geometry/rectangle.h>
+#include <mir/graphics/buffer_id.h>
+#include <mir/graphics/renderable.h>
+
+#include <experimental/optional>
+#include <vector>
+
+namespace mir
+{
+namespace graphics { class DisplayBuffer; }
+namespace renderer
+{
+namespace software
+{
+class RenderTarget;
+
+/**
+ * A Renderer that composites on the CPU.
+ *
+ * Client buffers are read through their CPU mapping (SHM buffers are read in
+ * place) and blended into the display buffer's framebuffer. Only the regions
+ * that changed since the previous frame are recomposited.
+ */
+class Renderer : public renderer::Renderer
+{
+public:
+    Renderer(graphics::DisplayBuffer& display_buffer);
+
+    void set_viewport(geometry::Rectangle const& rect) override;
+    void set_output_transform(glm::mat2 const&) override;
+    void render(graphics::RenderableList const&) const override;
+    void suspend() override;
+
+    /**
+     * The regions that the most recent render() recomposited, in screen
+     * coordinates.
+     */
+    auto last_damage() const -> std::vector<geometry::Rectangle>;
+
+private:
+    /// What we need to remember about a renderable to detect changes
+    struct RenderedState
+    {
+        graphics::Renderable::ID id;
+        graphics::BufferID buffer_id;
+        geometry::Rectangle screen_position;
+        std::experimental::optional<geometry::Rectangle> clip_area;
+        float alpha;
+        bool shaped;
+        graphics::TextureBounds texture_bounds;
+    };
+
+    auto damage_for(graphics::RenderableList const& renderables) const -> std::vector<geometry::Rectangle>;
+
+    RenderTarget* const render_target;
+    geometry::Rectangle viewport;
+    glm::mat2 output_transform{1};
+    bool mutable needs_full_redraw{true};
+    std::vector<RenderedState> mutable previous_frame;
+    std::vector<geometry::Rectangle> mutable damage;
+    /// Buffers that failed to map, and have been reported
+    std::vector<graphics::BufferID> mutable unmappable_buffers;
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_SOFTWARE_RENDERER_H_
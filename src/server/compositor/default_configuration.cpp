@@ -22,16 +22,49 @@
 #include "buffer_stream_factory.h"
 #include "default_display_buffer_compositor_factory.h"
 #include "multi_threaded_compositor.h"
+#include "mir/compositor/presentation_clock.h"
 #include "gl/renderer_factory.h"
+#include "gl/program_cache.h"
+#include "software/renderer_factory.h"
 #include "mir/main_loop.h"
 
 #include "mir/options/configuration.h"
+#include "mir/log.h"
 
 #include <boost/throw_exception.hpp>
+#include <cstdlib>
+#include <stdexcept>
 
 namespace mc = mir::compositor;
 namespace ms = mir::scene;
 namespace mf = mir::frontend;
+namespace mo = mir::options;
+
+namespace
+{
+auto gl_program_cache(mo::Option const& options) -> std::shared_ptr<mir::renderer::gl::ProgramCache>
+{
+    auto directory = options.get<std::string>(mo::gl_program_cache_opt);
+
+    if (directory == mo::off_opt_value)
+        return nullptr;
+
+    if (directory == mo::auto_opt_value)
+    {
+        if (auto const cache_home = getenv("XDG_CACHE_HOME"))
+            directory = std::string{cache_home} + "/mir/gl-programs";
+        else if (auto const home = getenv("HOME"))
+            directory = std::string{home} + "/.cache/mir/gl-programs";
+        else
+        {
+            mir::log_debug("Keeping GL programs in memory only: Neither XDG_CACHE_HOME or HOME is set");
+            directory.clear();
+        }
+    }
+
+    return std::make_shared<mir::renderer::gl::ProgramCache>(directory);
+}
+}
 
 std::shared_ptr<ms::BufferStreamFactory>
 mir::DefaultServerConfiguration::the_buffer_stream_factory()
@@ -76,16 +109,34 @@ mir::DefaultServerConfiguration::the_compositor()
                 the_display_buffer_compositor_factory(),
                 the_shell(),
                 the_compositor_report(),
+                the_presentation_clock(),
                 composite_delay,
                 true);
         });
 }
 
+std::shared_ptr<mc::PresentationClock>
+mir::DefaultServerConfiguration::the_presentation_clock()
+{
+    return presentation_clock(
+        [this]()
+        {
+            return std::make_shared<mc::PresentationClock>(the_clock());
+        });
+}
+
 std::shared_ptr<mir::renderer::RendererFactory> mir::DefaultServerConfiguration::the_renderer_factory()
 {
     return renderer_factory(
-        []()
+        [this]() -> std::shared_ptr<mir::renderer::RendererFactory>
         {
-            return std::make_shared<mir::renderer::gl::RendererFactory>();
+            auto const renderer = the_options()->get<std::string>(options::renderer_opt);
+
+            if (renderer == options::software_renderer_value)
+                return std::make_shared<mir::renderer::software::RendererFactory>();
+            else if (renderer == options::gl_renderer_value)
+                return std::make_shared<mir::renderer::gl::RendererFactory>(gl_program_cache(*the_options()));
+
+            BOOST_THROW_EXCEPTION(std::runtime_error("Unknown renderer: " + renderer));
         });
 }
@@ -23,6 +23,8 @@
 #include "mir/compositor/scene_element.h"
 #include "mir/graphics/renderable.h"
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/direct_scanout.h"
+#include "mir/graphics/partial_overlay.h"
 #include "mir/graphics/buffer.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/renderer/renderer.h"
@@ -39,6 +41,8 @@ mc::DefaultDisplayBufferCompositor::DefaultDisplayBufferCompositor(
     std::shared_ptr<mir::renderer::Renderer> const& renderer,
     std::shared_ptr<mc::CompositorReport> const& report) :
     display_buffer(display_buffer),
+    direct_scanout(dynamic_cast<mg::DirectScanout*>(&display_buffer)),
+    partial_overlay(dynamic_cast<mg::PartialOverlay*>(&display_buffer)),
     renderer(renderer),
     report(report)
 {
@@ -72,7 +76,26 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
      */
     scene_elements.clear();  // Those in use are still in renderable_list
 
-    if (display_buffer.overlay(renderable_list))
+    // A fullscreen surface that the display can show as it is needs neither the renderer nor an overlay
+    auto const scanned_out = [&]
+        {
+            if (!direct_scanout)
+                return false;
+
+            auto const candidate = mg::scanout_candidate(renderable_list, view_area);
+            return candidate && direct_scanout->scanout(candidate);
+        };
+
+    // What the display buffer can't show as overlays is left to the renderer
+    auto composited = partial_overlay ? renderable_list : mg::RenderableList{};
+    auto const overlaid = [&]
+        {
+            return partial_overlay ?
+                partial_overlay->overlay_top_of(composited) :
+                display_buffer.overlay(renderable_list);
+        };
+
+    if (scanned_out() || overlaid())
     {
         report->renderables_in_frame(this, renderable_list);
         renderer->suspend();
@@ -81,7 +104,7 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
     {
         renderer->set_output_transform(display_buffer.transformation());
         renderer->set_viewport(view_area);
-        renderer->render(renderable_list);
+        renderer->render(partial_overlay ? composited : renderable_list);
 
         report->renderables_in_frame(this, renderable_list);
         report->rendered_frame(this);
@@ -98,6 +121,7 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
          *        acquisition calls when we composite the next frame.
          */
         renderable_list.clear();
+        composited.clear();
     }
 
     report->finished_frame(this);
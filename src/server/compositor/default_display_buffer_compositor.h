@@ -28,6 +28,8 @@ namespace mir
 namespace graphics
 {
 class DisplayBuffer;
+class DirectScanout;
+class PartialOverlay;
 }
 namespace renderer
 {
@@ -50,6 +52,10 @@ public:
 
 private:
     graphics::DisplayBuffer& display_buffer;
+    /// The display buffer, if it can scan out a fullscreen surface's buffer
+    graphics::DirectScanout* const direct_scanout;
+    /// The display buffer, if it can overlay the top of a scene and leave the rest to the renderer
+    graphics::PartialOverlay* const partial_overlay;
     std::shared_ptr<renderer::Renderer> const renderer;
     std::shared_ptr<CompositorReport> const report;
 };
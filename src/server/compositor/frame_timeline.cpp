@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_timeline.h"
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+mc::FrameTimeline::FrameTimeline()
+{
+    users.reserve(max_users);
+}
+
+void mc::FrameTimeline::committed(mg::BufferID buffer, Clock::time_point time)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& frame = frames[next_frame++ % capacity];
+    frame.buffer = buffer;
+    frame.times = FrameTimestamps{time, {}, {}, {}};
+}
+
+void mc::FrameTimeline::acquired(void const* user_id, mg::BufferID buffer, Clock::time_point time)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& acquirer = user(user_id);
+    acquirer.acquired = 0;
+
+    // A buffer can't be submitted again until it's released, so the latest commit of it is the one acquired
+    for (auto number = next_frame - 1; number != 0 && frame(number); --number)
+    {
+        auto const candidate = frame(number);
+        if (candidate->buffer == buffer)
+        {
+            if (candidate->times.acquired == Clock::time_point{})
+                candidate->times.acquired = time;
+
+            if (number > latest_acquired)
+            {
+                frames_missed += number - latest_acquired - 1;
+                latest_acquired = number;
+            }
+
+            acquirer.acquired = number;
+            break;
+        }
+    }
+}
+
+void mc::FrameTimeline::composited(void const* user_id, Clock::time_point time)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& compositor = user(user_id);
+    if (auto const composited = frame(compositor.acquired))
+    {
+        if (composited->times.composited == Clock::time_point{})
+            composited->times.composited = time;
+        compositor.composited = compositor.acquired;
+    }
+}
+
+void mc::FrameTimeline::presented(void const* user_id, Clock::time_point time)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& compositor = user(user_id);
+    if (auto const presented = frame(compositor.composited))
+    {
+        if (presented->times.presented == Clock::time_point{})
+        {
+            presented->times.presented = time;
+            ++frames_presented;
+        }
+    }
+    compositor.composited = 0;
+}
+
+auto mc::FrameTimeline::statistics() const -> FrameStatistics
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    FrameStatistics result;
+    result.frames_committed = next_frame - 1;
+    result.frames_presented = frames_presented;
+    result.frames_missed = frames_missed;
+
+    auto const first = next_frame > capacity ? next_frame - capacity : 1;
+    result.recent_frames.reserve(next_frame - first);
+    for (auto number = first; number != next_frame; ++number)
+        result.recent_frames.push_back(frames[number % capacity].times);
+
+    return result;
+}
+
+auto mc::FrameTimeline::frame(uint64_t number) -> Frame*
+{
+    if (number == 0 || number >= next_frame || next_frame - number > capacity)
+        return nullptr;
+
+    return &frames[number % capacity];
+}
+
+auto mc::FrameTimeline::user(void const* id) -> User&
+{
+    for (auto& user : users)
+    {
+        if (user.id == id)
+            return user;
+    }
+
+    if (users.size() == max_users)
+        users.erase(users.begin());
+
+    users.push_back(User{id, 0, 0});
+    return users.back();
+}
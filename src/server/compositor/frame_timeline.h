@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_FRAME_TIMELINE_H_
+#define MIR_COMPOSITOR_FRAME_TIMELINE_H_
+
+#include "mir/compositor/frame_statistics.h"
+#include "mir/graphics/buffer_id.h"
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+/**
+ * Records when a stream's recent frames were committed, acquired, composited
+ * and presented, in a fixed ring so that recording never allocates.
+ *
+ * Compositors are told apart by the user_id they acquire buffers with: each
+ * composites and presents the buffer it last acquired.
+ */
+class FrameTimeline
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t capacity{64};
+    /// More than this many compositors (outputs, screencasts...) taking from one stream is unusual
+    static constexpr std::size_t max_users{8};
+
+    FrameTimeline();
+
+    void committed(graphics::BufferID buffer, Clock::time_point time);
+    void acquired(void const* user_id, graphics::BufferID buffer, Clock::time_point time);
+    void composited(void const* user_id, Clock::time_point time);
+    void presented(void const* user_id, Clock::time_point time);
+
+    /// Everything but queued_buffers, which the timeline can't know
+    auto statistics() const -> FrameStatistics;
+
+private:
+    struct Frame
+    {
+        graphics::BufferID buffer;
+        FrameTimestamps times;
+    };
+
+    /// Frames are numbered from 1, in the order committed; 0 is none
+    struct User
+    {
+        void const* id;
+        uint64_t acquired;
+        uint64_t composited;
+    };
+
+    auto frame(uint64_t number) -> Frame*;
+    auto user(void const* id) -> User&;
+
+    std::mutex mutable mutex;
+    std::array<Frame, capacity> frames;
+    uint64_t next_frame{1};
+    uint64_t latest_acquired{0};
+    uint64_t frames_presented{0};
+    uint64_t frames_missed{0};
+    std::vector<User> users;
+};
+}
+}
+
+#endif /* MIR_COMPOSITOR_FRAME_TIMELINE_H_ */
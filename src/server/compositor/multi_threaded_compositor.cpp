@@ -24,6 +24,7 @@
 #include "mir/compositor/display_listener.h"
 #include "mir/compositor/scene.h"
 #include "mir/compositor/compositor_report.h"
+#include "mir/compositor/presentation_clock.h"
 #include "mir/scene/legacy_scene_change_notification.h"
 #include "mir/scene/surface_observer.h"
 #include "mir/scene/surface.h"
@@ -32,6 +33,7 @@
 #include "mir/unwind_helpers.h"
 #include "mir/thread_name.h"
 
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include <condition_variable>
@@ -57,7 +59,8 @@ public:
         std::shared_ptr<mc::Scene> const& scene,
         std::shared_ptr<DisplayListener> const& display_listener,
         std::chrono::milliseconds fixed_composite_delay,
-        std::shared_ptr<CompositorReport> const& report) :
+        std::shared_ptr<CompositorReport> const& report,
+        std::shared_ptr<PresentationClock> const& presentation_clock) :
         compositor_factory{db_compositor_factory},
         group(group),
         scene(scene),
@@ -66,6 +69,7 @@ public:
         force_sleep{fixed_composite_delay},
         display_listener{display_listener},
         report{report},
+        presentation_clock{presentation_clock},
         started_future{started.get_future()}
     {
     }
@@ -97,6 +101,10 @@ public:
             [this, &disp_listener]{group.for_each_display_buffer([&disp_listener](mg::DisplayBuffer& buffer)
                 { disp_listener->remove_display(buffer.view_area()); });});
 
+        auto presentation_registration = mir::raii::paired_calls(
+            []{},
+            [this]{ presentation_clock->source_removed(this); });
+
         auto compositor_registration = mir::raii::paired_calls(
             [this,&compositors]
             {
@@ -141,6 +149,9 @@ public:
                         compositor->composite(scene->scene_elements_for(compositor.get()));
                     }
                     group.post();
+                    presentation_clock->frame_posted(this);
+                    for (auto& tuple : compositors)
+                        scene->frame_presented(std::get<1>(tuple).get());
 
                     /*
                      * "Predictive bypass" optimization: If the last frame was
@@ -222,6 +233,11 @@ public:
         run_cv.notify_one();
     }
 
+    bool composites_to(mg::DisplaySyncGroup const& display_sync_group) const
+    {
+        return &group == &display_sync_group;
+    }
+
     void wait_until_started()
     {
         if (started_future.wait_for(10s) != std::future_status::ready)
@@ -241,6 +257,7 @@ private:
     std::condition_variable run_cv;
     std::shared_ptr<DisplayListener> const display_listener;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<PresentationClock> const presentation_clock;
     std::promise<void> started;
     std::future<void> started_future;
     bool not_posted_yet = true;
@@ -255,6 +272,7 @@ mc::MultiThreadedCompositor::MultiThreadedCompositor(
     std::shared_ptr<DisplayBufferCompositorFactory> const& db_compositor_factory,
     std::shared_ptr<DisplayListener> const& display_listener,
     std::shared_ptr<CompositorReport> const& compositor_report,
+    std::shared_ptr<PresentationClock> const& presentation_clock,
     std::chrono::milliseconds fixed_composite_delay,
     bool compose_on_start)
     : display{display},
@@ -262,6 +280,7 @@ mc::MultiThreadedCompositor::MultiThreadedCompositor(
       display_buffer_compositor_factory{db_compositor_factory},
       display_listener{display_listener},
       report{compositor_report},
+      presentation_clock{presentation_clock},
       state{CompositorState::stopped},
       fixed_composite_delay{fixed_composite_delay},
       compose_on_start{compose_on_start},
@@ -286,6 +305,7 @@ mc::MultiThreadedCompositor::~MultiThreadedCompositor()
 void mc::MultiThreadedCompositor::schedule_compositing(int num)
 {
     report->scheduled();
+    std::lock_guard<std::mutex> lock{functors_mutex};
     for (auto& f : thread_functors)
         f->schedule_compositing(num);
 }
@@ -293,11 +313,18 @@ void mc::MultiThreadedCompositor::schedule_compositing(int num)
 void mc::MultiThreadedCompositor::schedule_compositing(int num, geometry::Rectangle const& damage) const
 {
     report->scheduled();
+    std::lock_guard<std::mutex> lock{functors_mutex};
     for (auto& f : thread_functors)
         f->schedule_compositing(num, damage);
 }
 
 void mc::MultiThreadedCompositor::start()
+{
+    std::lock_guard<std::mutex> lock{lifecycle_mutex};
+    start(lock);
+}
+
+void mc::MultiThreadedCompositor::start(std::lock_guard<std::mutex> const&)
 {
     auto stopped = CompositorState::stopped;
 
@@ -331,6 +358,8 @@ void mc::MultiThreadedCompositor::start()
 
 void mc::MultiThreadedCompositor::stop()
 {
+    std::lock_guard<std::mutex> lock{lifecycle_mutex};
+
     auto started = CompositorState::started;
 
     if (!state.compare_exchange_strong(started, CompositorState::stopping))
@@ -361,33 +390,109 @@ void mc::MultiThreadedCompositor::stop()
     state = CompositorState::stopped;
 }
 
-void mc::MultiThreadedCompositor::create_compositing_threads()
+void mc::MultiThreadedCompositor::stop_compositing_to(mg::DisplaySyncGroup& group)
+{
+    // Held until the group's thread has finished, so that start() or stop() can't run meanwhile
+    std::lock_guard<std::mutex> lifecycle_lock{lifecycle_mutex};
+
+    if (state != CompositorState::started)
+        return;
+
+    std::unique_ptr<CompositingFunctor> functor;
+    std::future<void> future;
+    {
+        std::lock_guard<std::mutex> lock{functors_mutex};
+
+        for (auto i = 0u; i != thread_functors.size(); ++i)
+        {
+            if (thread_functors[i]->composites_to(group))
+            {
+                functor = std::move(thread_functors[i]);
+                future = std::move(futures[i]);
+                thread_functors.erase(thread_functors.begin() + i);
+                futures.erase(futures.begin() + i);
+                break;
+            }
+        }
+    }
+
+    if (functor)
+    {
+        functor->stop();
+        future.wait();
+    }
+}
+
+void mc::MultiThreadedCompositor::start_compositing_to_new_groups()
 {
+    std::lock_guard<std::mutex> lock{lifecycle_mutex};
+
+    if (state != CompositorState::started)
+    {
+        start(lock);
+        return;
+    }
+
+    // A new output needs its first frame, and any clients blocked on it need compositing
+    for (auto const functor : create_compositing_threads())
+        functor->schedule_compositing(1);
+}
+
+auto mc::MultiThreadedCompositor::create_compositing_threads() -> std::vector<CompositingFunctor*>
+{
+    std::vector<mg::DisplaySyncGroup*> groups;
+    display->for_each_display_sync_group([&groups](mg::DisplaySyncGroup& group)
+        {
+            groups.push_back(&group);
+        });
+
+    std::vector<CompositingFunctor*> created;
+
     /* Start the display buffer compositing threads */
-    display->for_each_display_sync_group([this](mg::DisplaySyncGroup& group)
+    for (auto const group : groups)
     {
+        std::lock_guard<std::mutex> lock{functors_mutex};
+
+        if (std::any_of(thread_functors.begin(), thread_functors.end(),
+                        [group](auto const& functor) { return functor->composites_to(*group); }))
+        {
+            continue;
+        }
+
         auto thread_functor = std::make_unique<mc::CompositingFunctor>(
-            display_buffer_compositor_factory, group, scene, display_listener,
-            fixed_composite_delay, report);
+            display_buffer_compositor_factory, *group, scene, display_listener,
+            fixed_composite_delay, report, presentation_clock);
 
-        futures.push_back(thread_pool.run(std::ref(*thread_functor), &group));
+        futures.push_back(thread_pool.run(std::ref(*thread_functor), group));
+        created.push_back(thread_functor.get());
         thread_functors.push_back(std::move(thread_functor));
-    });
+    }
 
     thread_pool.shrink();
 
-    for (auto& functor : thread_functors)
+    /*
+     * Wait without holding functors_mutex: a starting thread may cause the scene
+     * observer to schedule compositing (e.g. from DisplayListener::add_display()).
+     */
+    for (auto const functor : created)
         functor->wait_until_started();
+
+    return created;
 }
 
 void mc::MultiThreadedCompositor::destroy_compositing_threads()
 {
-    for (auto& f : thread_functors)
+    decltype(thread_functors) functors;
+    decltype(futures) finished;
+    {
+        std::lock_guard<std::mutex> lock{functors_mutex};
+        swap(functors, thread_functors);
+        swap(finished, futures);
+    }
+
+    for (auto& f : functors)
         f->stop();
 
-    for (auto& f : futures)
+    for (auto& f : finished)
         f.wait();
-
-    thread_functors.clear();
-    futures.clear();
 }
@@ -35,6 +35,7 @@ namespace geometry { struct Rectangle; }
 namespace graphics
 {
 class Display;
+class DisplaySyncGroup;
 }
 namespace scene
 {
@@ -49,6 +50,7 @@ class DisplayListener;
 class CompositingFunctor;
 class Scene;
 class CompositorReport;
+class PresentationClock;
 
 enum class CompositorState
 {
@@ -67,6 +69,7 @@ public:
         std::shared_ptr<DisplayBufferCompositorFactory> const& db_compositor_factory,
         std::shared_ptr<DisplayListener> const& display_listener,
         std::shared_ptr<CompositorReport> const& compositor_report,
+        std::shared_ptr<PresentationClock> const& presentation_clock,
         std::chrono::milliseconds fixed_composite_delay,  // -1 = automatic
         bool compose_on_start);
     ~MultiThreadedCompositor();
@@ -74,8 +77,14 @@ public:
     void start();
     void stop();
 
+    void stop_compositing_to(graphics::DisplaySyncGroup& group);
+    void start_compositing_to_new_groups();
+
 private:
-    void create_compositing_threads();
+    void start(std::lock_guard<std::mutex> const&);
+
+    /// Creates compositing threads for any sync groups that don't have one, returning those
+    auto create_compositing_threads() -> std::vector<CompositingFunctor*>;
     void destroy_compositing_threads();
 
     std::shared_ptr<graphics::Display> const display;
@@ -83,7 +92,14 @@ private:
     std::shared_ptr<DisplayBufferCompositorFactory> const display_buffer_compositor_factory;
     std::shared_ptr<DisplayListener> const display_listener;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<PresentationClock> const presentation_clock;
+
+    // Serialises start(), stop() and the replacement of individual sync groups' threads
+    std::mutex lifecycle_mutex;
 
+    // Guards thread_functors and futures, which change while the scene is observed
+    // when sync groups are replaced individually
+    std::mutex mutable functors_mutex;
     std::vector<std::unique_ptr<CompositingFunctor>> thread_functors;
     std::vector<std::future<void>> futures;
 
@@ -0,0 +1,97 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/compositor/presentation_clock.h"
+#include "mir/time/clock.h"
+
+#include <algorithm>
+
+namespace mc = mir::compositor;
+namespace mt = mir::time;
+
+namespace
+{
+// Until we've seen some frames, assume the common 60Hz
+mt::Duration const initial_period{std::chrono::nanoseconds{16666667}};
+
+// Longer intervals are the compositor idling, not the display's refresh rate
+mt::Duration const max_frame_interval{std::chrono::milliseconds{50}};
+
+// How many frames can be missed before we stop predicting more
+int const frames_until_idle{4};
+}
+
+mc::PresentationClock::PresentationClock(std::shared_ptr<time::Clock> const& clock)
+    : clock{clock}
+{
+}
+
+void mc::PresentationClock::frame_posted(SourceId source)
+{
+    auto const now = clock->now();
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const existing = sources.find(source);
+    if (existing == sources.end())
+    {
+        sources.emplace(source, Source{now, initial_period});
+        return;
+    }
+
+    auto& frames = existing->second;
+    auto const interval = now - frames.last_frame;
+    frames.last_frame = now;
+
+    if (interval < max_frame_interval)
+    {
+        // A frame that missed a refresh or two still tells us the period
+        auto const refreshes = std::max<mt::Duration::rep>(
+            1, (interval + frames.period / 2) / frames.period);
+        auto const sample = interval / refreshes;
+
+        frames.period += (sample - frames.period) / 8;
+    }
+}
+
+void mc::PresentationClock::source_removed(SourceId source)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    sources.erase(source);
+}
+
+auto mc::PresentationClock::next_frame() const -> optional_value<time::Timestamp>
+{
+    auto const now = clock->now();
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    optional_value<time::Timestamp> next;
+    for (auto const& source : sources)
+    {
+        auto const& frames = source.second;
+        auto const since_last = now - frames.last_frame;
+
+        if (since_last > frames_until_idle * frames.period)
+            continue;
+
+        auto const predicted = frames.last_frame + (since_last / frames.period + 1) * frames.period;
+        if (!next.is_set() || predicted < next.value())
+            next = predicted;
+    }
+
+    return next;
+}
@@ -23,6 +23,8 @@
 #include "mir/graphics/buffer.h"
 #include <boost/throw_exception.hpp>
 
+#include <algorithm>
+
 namespace mc = mir::compositor;
 namespace geom = mir::geometry;
 namespace mg = mir::graphics;
@@ -58,6 +60,8 @@ void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
         first_frame_posted = true;
         pf = buffer->pixel_format();
         latest_buffer_size = buffer->size();
+        record_bounds(buffer->id(), lk);
+        timeline.committed(buffer->id(), FrameTimeline::Clock::now());
         schedule->schedule(buffer);
     }
     {
@@ -87,12 +91,17 @@ void mc::Stream::set_frame_posted_callback(
 
 std::shared_ptr<mg::Buffer> mc::Stream::lock_compositor_buffer(void const* id)
 {
-    return arbiter->compositor_acquire(id);
+    auto const buffer = arbiter->compositor_acquire(id);
+    timeline.acquired(id, buffer->id(), FrameTimeline::Clock::now());
+    return buffer;
 }
 
 geom::Size mc::Stream::stream_size()
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
+    if (viewport_size)
+        return viewport_size.value();
+
     return geom::Size{
         roundf(latest_buffer_size.width.as_int() / scale_),
         roundf(latest_buffer_size.height.as_int() / scale_)};
@@ -165,3 +174,62 @@ void mc::Stream::set_scale(float scale)
     std::lock_guard<decltype(mutex)> lk(mutex);
     scale_ = scale;
 }
+
+void mc::Stream::set_viewport(
+    mg::TextureBounds const& bounds,
+    std::experimental::optional<geom::Size> const& size)
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    texture_bounds_ = bounds;
+    viewport_size = size;
+}
+
+auto mc::Stream::texture_bounds(mg::Buffer const& buffer) const -> mg::TextureBounds
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    for (auto const& submitted : submitted_bounds)
+    {
+        if (submitted.first == buffer.id())
+            return submitted.second;
+    }
+    return {};
+}
+
+void mc::Stream::record_bounds(mg::BufferID buffer, std::lock_guard<std::mutex> const&)
+{
+    // Buffer IDs are not reused while the buffer is alive, but a client may submit the same buffer again
+    submitted_bounds.erase(
+        std::remove_if(
+            begin(submitted_bounds),
+            end(submitted_bounds),
+            [buffer](auto const& submitted) { return submitted.first == buffer; }),
+        end(submitted_bounds));
+
+    if (texture_bounds_ == mg::TextureBounds{})
+        return;
+
+    // Far more than can be queued or held by compositors at once
+    if (submitted_bounds.size() == max_submitted_bounds)
+        submitted_bounds.erase(begin(submitted_bounds));
+
+    submitted_bounds.emplace_back(buffer, texture_bounds_);
+}
+
+void mc::Stream::frame_composited(void const* user_id)
+{
+    timeline.composited(user_id, FrameTimeline::Clock::now());
+}
+
+void mc::Stream::frame_presented(void const* user_id)
+{
+    timeline.presented(user_id, FrameTimeline::Clock::now());
+}
+
+auto mc::Stream::frame_statistics() const -> FrameStatistics
+{
+    auto statistics = timeline.statistics();
+
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    statistics.queued_buffers = schedule->num_scheduled();
+    return statistics;
+}
@@ -25,10 +25,13 @@
 #include "mir/frontend/buffer_stream_id.h"
 #include "mir/lockable_callback.h"
 #include "mir/geometry/size.h"
+#include "mir/graphics/renderable.h"
 #include "multi_monitor_arbiter.h"
+#include "frame_timeline.h"
 #include <mutex>
 #include <memory>
 #include <set>
+#include <vector>
 
 namespace mir
 {
@@ -56,10 +59,20 @@ public:
     void drop_old_buffers() override;
     bool has_submitted_buffer() const override;
     void set_scale(float scale) override;
+    void set_viewport(
+        graphics::TextureBounds const& bounds,
+        std::experimental::optional<geometry::Size> const& size) override;
+    auto texture_bounds(graphics::Buffer const& buffer) const -> graphics::TextureBounds override;
+    void frame_composited(void const* user_id) override;
+    void frame_presented(void const* user_id) override;
+    auto frame_statistics() const -> FrameStatistics override;
 
 private:
     enum class ScheduleMode;
     void transition_schedule(std::shared_ptr<Schedule>&& new_schedule, std::lock_guard<std::mutex> const&);
+    void record_bounds(graphics::BufferID buffer, std::lock_guard<std::mutex> const&);
+
+    static constexpr std::size_t max_submitted_bounds{16};
 
     std::mutex mutable mutex;
     ScheduleMode schedule_mode;
@@ -67,8 +80,13 @@ private:
     std::shared_ptr<MultiMonitorArbiter> const arbiter;
     geometry::Size latest_buffer_size;
     float scale_{1.0f};
+    graphics::TextureBounds texture_bounds_;
+    /// The bounds of recently submitted buffers that aren't the whole buffer
+    std::vector<std::pair<graphics::BufferID, graphics::TextureBounds>> submitted_bounds;
+    std::experimental::optional<geometry::Size> viewport_size;
     MirPixelFormat pf;
     bool first_frame_posted;
+    FrameTimeline timeline;
 
     std::mutex callback_mutex;
     std::function<void(geometry::Size const&)> frame_callback;
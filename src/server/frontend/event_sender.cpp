@@ -21,6 +21,7 @@
 #include "mir/frontend/client_constants.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/variable_length_array.h"
+#include "mir/protobuf/wire_codec.h"
 #include "mir/input/device.h"
 #include "mir/input/mir_input_config.h"
 #include "mir/input/mir_input_config_serialization.h"
@@ -33,7 +34,6 @@
 #include "mir/graphics/buffer.h"
 #include "mir/client_visible_error.h"
 
-#include "mir_protobuf_wire.pb.h"
 #include "mir_protobuf.pb.h"
 
 namespace mg = mir::graphics;
@@ -101,23 +101,15 @@ void mfd::EventSender::handle_input_config_change(MirInputConfig const& config)
 
 void mfd::EventSender::send_event_sequence(mp::EventSequence& seq, FdSets const& fds)
 {
-    mir::VariableLengthArray<frontend::serialization_buffer_size>
 #if GOOGLE_PROTOBUF_VERSION >= 3010000
-        send_buffer{static_cast<size_t>(seq.ByteSizeLong())};
+    auto const seq_size = static_cast<size_t>(seq.ByteSizeLong());
 #else
-        send_buffer{static_cast<size_t>(seq.ByteSize())};
+    auto const seq_size = static_cast<size_t>(seq.ByteSize());
 #endif
+    auto const envelope = mir::protobuf::ResultEnvelope::event(seq_size);
 
-    seq.SerializeWithCachedSizesToArray(send_buffer.data());
-
-    mir::protobuf::wire::Result result;
-    result.add_events(send_buffer.data(), send_buffer.size());
-#if GOOGLE_PROTOBUF_VERSION >= 3010000
-    send_buffer.resize(result.ByteSizeLong());
-#else
-    send_buffer.resize(result.ByteSize());
-#endif
-    result.SerializeWithCachedSizesToArray(send_buffer.data());
+    mir::VariableLengthArray<frontend::serialization_buffer_size> send_buffer{envelope.size()};
+    seq.SerializeWithCachedSizesToArray(envelope.write_header(send_buffer.data()));
 
     try
     {
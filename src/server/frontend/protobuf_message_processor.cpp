@@ -68,10 +68,10 @@ template<> struct result_ptr_t<mir::protobuf::SocketFD>     { typedef ::mir::pro
 template<> struct result_ptr_t<mir::protobuf::PlatformOperationMessage> { typedef ::mir::protobuf::PlatformOperationMessage* type; };
 
 template<class ParameterMessage>
-ParameterMessage parse_parameter(Invocation const& invocation)
+ParameterMessage* parse_parameter(Invocation const& invocation)
 {
-    ParameterMessage request;
-    if (!request.ParseFromString(invocation.parameters()))
+    auto const request = invocation.make_message<ParameterMessage>();
+    if (!invocation.parse_parameters(*request))
         BOOST_THROW_EXCEPTION(std::runtime_error("Failed to parse message parameters!"));
     return request;
 }
@@ -169,17 +169,17 @@ void invoke(
 
 const std::string& mfd::Invocation::method_name() const
 {
-    return invocation.method_name();
+    return invocation.method_name;
 }
 
-const std::string& mfd::Invocation::parameters() const
+google::protobuf::uint32 mfd::Invocation::id() const
 {
-    return invocation.parameters();
+    return invocation.id;
 }
 
-google::protobuf::uint32 mfd::Invocation::id() const
+bool mfd::Invocation::parse_parameters(google::protobuf::MessageLite& message) const
 {
-    return invocation.id();
+    return invocation.parameters.parse_into(message);
 }
 
 void mfd::ProtobufMessageProcessor::client_pid(int pid)
@@ -209,11 +209,11 @@ bool mfd::ProtobufMessageProcessor::dispatch(
         }
         else if ("submit_buffer" == invocation.method_name())
         {
-            auto request = parse_parameter<mir::protobuf::BufferRequest>(invocation);
-            request.mutable_buffer()->clear_fd();
+            auto const request = parse_parameter<mir::protobuf::BufferRequest>(invocation);
+            request->mutable_buffer()->clear_fd();
             for (auto& fd : side_channel_fds)
-                request.mutable_buffer()->add_fd(fd);
-            invoke(shared_from_this(), display_server.get(), &DisplayServer::submit_buffer, invocation.id(), &request);
+                request->mutable_buffer()->add_fd(fd);
+            invoke(shared_from_this(), display_server.get(), &DisplayServer::submit_buffer, invocation.id(), request);
         }
         else if ("allocate_buffers" == invocation.method_name())
         {
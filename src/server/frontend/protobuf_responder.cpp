@@ -21,6 +21,7 @@
 #include "message_sender.h"
 #include "mir/frontend/client_constants.h"
 #include "mir/variable_length_array.h"
+#include "mir/protobuf/wire_codec.h"
 #include "socket_messenger.h"
 
 namespace mfd = mir::frontend::detail;
@@ -38,28 +39,15 @@ void mfd::ProtobufResponder::send_response(
     google::protobuf::MessageLite* response,
     FdSets const& fd_sets)
 {
-    mir::VariableLengthArray<serialization_buffer_size>
 #if GOOGLE_PROTOBUF_VERSION >= 3010000
-        send_response_buffer{static_cast<size_t>(response->ByteSizeLong())};
+    auto const response_size = static_cast<size_t>(response->ByteSizeLong());
 #else
-        send_response_buffer{static_cast<size_t>(response->ByteSize())};
+    auto const response_size = static_cast<size_t>(response->ByteSize());
 #endif
+    auto const envelope = mir::protobuf::ResultEnvelope::response(id, response_size);
 
-    response->SerializeWithCachedSizesToArray(send_response_buffer.data());
-
-    {
-        std::lock_guard<decltype(result_guard)> lock{result_guard};
-
-        send_response_result.set_id(id);
-        send_response_result.set_response(send_response_buffer.data(), send_response_buffer.size());
-
-#if GOOGLE_PROTOBUF_VERSION >= 3010000
-        send_response_buffer.resize(send_response_result.ByteSizeLong());
-#else
-        send_response_buffer.resize(send_response_result.ByteSize());
-#endif
-        send_response_result.SerializeWithCachedSizesToArray(send_response_buffer.data());
-    }
+    mir::VariableLengthArray<serialization_buffer_size> send_response_buffer{envelope.size()};
+    response->SerializeWithCachedSizesToArray(envelope.write_header(send_response_buffer.data()));
 
     sender->send(reinterpret_cast<char*>(send_response_buffer.data()), send_response_buffer.size(), fd_sets);
     resource_cache->free_resource(response);
@@ -24,8 +24,6 @@
 #include "mir/protobuf/protocol_version.h"
 #include "mir/log.h"
 
-#include "mir_protobuf_wire.pb.h"
-
 #include <boost/signals2.hpp>
 #include <boost/throw_exception.hpp>
 
@@ -97,20 +95,23 @@ try
         BOOST_THROW_EXCEPTION(std::runtime_error(error.message()));
     }
 
-    mir::protobuf::wire::Invocation invocation;
-    invocation.ParseFromArray(body.data(), body.size());
+    // Messages from the previous invocation are no longer referenced
+    message_arena.reset();
+
+    if (!invocation.parse(body.data(), body.size()))
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to parse invocation"));
 
-    int const v = invocation.has_protocol_version() ?
-                  invocation.protocol_version() :
+    int const v = invocation.has_protocol_version ?
+                  static_cast<int>(invocation.protocol_version) :
                   -1;
     if (v <  mir::protobuf::oldest_compatible_protocol_version() ||
         v >= mir::protobuf::next_incompatible_protocol_version())
         BOOST_THROW_EXCEPTION(std::runtime_error("Unsupported protocol version"));
 
     std::vector<mir::Fd> fds;
-    if (invocation.side_channel_fds() > 0)
+    if (invocation.side_channel_fds > 0)
     {
-        fds.resize(invocation.side_channel_fds());
+        fds.resize(invocation.side_channel_fds);
         message_receiver->receive_fds(fds);
     }
 
@@ -120,7 +121,7 @@ try
         processor->client_pid(client_pid);
     }
 
-    if (processor->dispatch(invocation, fds))
+    if (processor->dispatch({invocation, message_arena}, fds))
     {
         read_next_message();
     }
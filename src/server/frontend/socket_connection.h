@@ -21,6 +21,7 @@
 #define MIR_FRONTEND_DETAIL_SOCKET_CONNECTION_H_
 
 #include "mir/frontend/connections.h"
+#include "mir/protobuf/wire_codec.h"
 
 #include <boost/asio.hpp>
 
@@ -64,6 +65,10 @@ private:
     char header[header_size];
     std::vector<char> body;
 
+    // Reused for each message, so a steady stream of requests doesn't allocate
+    mir::protobuf::InvocationView invocation;
+    mir::protobuf::MessageArena message_arena;
+
     int client_pid = 0;
 };
 
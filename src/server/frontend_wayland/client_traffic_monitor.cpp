@@ -0,0 +1,308 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client_traffic_monitor.h"
+
+#include "mir/log.h"
+
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace mf = mir::frontend;
+
+static_assert(
+    std::is_standard_layout<mf::ClientTraffic>::value,
+    "ClientTraffic must be standard layout for wl_container_of to be defined behaviour");
+
+namespace
+{
+/// How much of what has been written to the client's socket it has not read yet
+auto unread_bytes(wl_client* client) -> size_t
+{
+    int queued{0};
+    if (ioctl(wl_client_get_fd(client), SIOCOUTQ, &queued) < 0 || queued < 0)
+    {
+        return 0;
+    }
+    return static_cast<size_t>(queued);
+}
+}
+
+mf::ClientTraffic::ClientTraffic(wl_client* client, ClientTrafficMonitor* monitor)
+    : client{client},
+      monitor{monitor},
+      stats{}
+{
+    uid_t uid;
+    gid_t gid;
+    wl_client_get_credentials(client, &stats.pid, &uid, &gid);
+
+    destroy_listener.notify = &on_client_destroyed;
+    wl_client_add_destroy_listener(client, &destroy_listener);
+
+    monitor->clients.push_back(this);
+}
+
+mf::ClientTraffic::~ClientTraffic()
+{
+    if (monitor)
+    {
+        auto& clients = monitor->clients;
+        clients.erase(std::remove(begin(clients), end(clients), this), end(clients));
+    }
+
+    // Make further ClientTraffic::from(client) calls return nullptr
+    wl_list_remove(&destroy_listener.link);
+}
+
+auto mf::ClientTraffic::from(wl_client* client) -> ClientTraffic*
+{
+    if (auto const listener = wl_client_get_destroy_listener(client, &on_client_destroyed))
+    {
+        ClientTraffic* traffic;
+        return wl_container_of(listener, traffic, destroy_listener);
+    }
+
+    return nullptr;
+}
+
+void mf::ClientTraffic::on_client_destroyed(wl_listener* listener, void* /*data*/)
+{
+    ClientTraffic* traffic;
+    traffic = wl_container_of(listener, traffic, destroy_listener);
+    delete traffic;
+}
+
+void mf::ClientTraffic::frame_callbacks_requested(unsigned count)
+{
+    stats.pending_frame_callbacks += count;
+}
+
+void mf::ClientTraffic::frame_callbacks_completed(unsigned count)
+{
+    stats.pending_frame_callbacks -= std::min(count, stats.pending_frame_callbacks);
+}
+
+auto mf::ClientTraffic::throttled() const -> bool
+{
+    return stats.throttled;
+}
+
+void mf::ClientTraffic::run_unthrottled(void const* key, std::function<void()>&& work)
+{
+    if (!stats.throttled)
+    {
+        work();
+        return;
+    }
+
+    auto const existing = std::find_if(begin(deferred), end(deferred), [key](auto const& entry) { return entry.first == key; });
+    if (existing != end(deferred))
+    {
+        existing->second = std::move(work);
+    }
+    else
+    {
+        deferred.emplace_back(key, std::move(work));
+    }
+}
+
+void mf::ClientTraffic::cancel_deferred(void const* key)
+{
+    deferred.erase(
+        std::remove_if(begin(deferred), end(deferred), [key](auto const& entry) { return entry.first == key; }),
+        end(deferred));
+}
+
+mf::ClientTrafficMonitor::ClientTrafficMonitor(wl_display* display, Limits const& limits)
+    : limits{limits},
+      client_created{{}, this},
+      logger{add_logger(display, this)},
+      timer{limits.sample_interval.count() > 0 ?
+          wl_event_loop_add_timer(wl_display_get_event_loop(display), &on_sample_timer, this) : nullptr},
+      last_sample{std::chrono::steady_clock::now()}
+{
+    client_created.listener.notify = &on_client_created;
+    wl_display_add_client_created_listener(display, &client_created.listener);
+
+    if (timer)
+    {
+        wl_event_source_timer_update(timer, limits.sample_interval.count());
+    }
+}
+
+mf::ClientTrafficMonitor::~ClientTrafficMonitor()
+{
+    if (timer)
+    {
+        wl_event_source_remove(timer);
+    }
+
+#ifndef MIR_NO_WAYLAND_PROTOCOL_LOGGER
+    if (logger)
+    {
+        wl_protocol_logger_destroy(logger);
+    }
+#endif
+
+    wl_list_remove(&client_created.listener.link);
+
+    // The clients (and their accounting) outlive us until the display is destroyed
+    for (auto const traffic : clients)
+    {
+        traffic->monitor = nullptr;
+    }
+}
+
+auto mf::ClientTrafficMonitor::add_logger(wl_display* display, ClientTrafficMonitor* monitor)
+    -> wl_protocol_logger*
+{
+#ifndef MIR_NO_WAYLAND_PROTOCOL_LOGGER
+    return wl_display_add_protocol_logger(display, &on_message, monitor);
+#else
+    (void)display;
+    (void)monitor;
+    mir::log_warning("Cannot count Wayland requests and events per client: "
+        "wl_display_add_protocol_logger() is unavailable in libwayland-dev "
+        WAYLAND_VERSION);
+    return nullptr;
+#endif
+}
+
+void mf::ClientTrafficMonitor::on_client_created(wl_listener* listener, void* data)
+{
+    ClientCreatedListener* created;
+    created = wl_container_of(listener, created, listener);
+
+    // Deletes itself when the client is destroyed
+    new ClientTraffic{static_cast<wl_client*>(data), created->monitor};
+}
+
+#ifndef MIR_NO_WAYLAND_PROTOCOL_LOGGER
+void mf::ClientTrafficMonitor::on_message(
+    void* /*data*/,
+    wl_protocol_logger_type direction,
+    wl_protocol_logger_message const* message)
+{
+    if (auto const traffic = ClientTraffic::from(wl_resource_get_client(message->resource)))
+    {
+        if (direction == WL_PROTOCOL_LOGGER_REQUEST)
+        {
+            ++traffic->stats.requests;
+        }
+        else
+        {
+            ++traffic->stats.events;
+        }
+    }
+}
+#endif
+
+int mf::ClientTrafficMonitor::on_sample_timer(void* data)
+{
+    auto const monitor = static_cast<ClientTrafficMonitor*>(data);
+    monitor->sample();
+    wl_event_source_timer_update(monitor->timer, monitor->limits.sample_interval.count());
+    return 0;
+}
+
+void mf::ClientTrafficMonitor::sample()
+{
+    auto const now = std::chrono::steady_clock::now();
+    std::chrono::duration<double> const elapsed = now - last_sample;
+    last_sample = now;
+
+    std::vector<ClientTraffic*> too_slow;
+    std::vector<std::function<void()>> resumed;
+
+    for (auto const traffic : clients)
+    {
+        auto& stats = traffic->stats;
+
+        stats.queued_bytes = unread_bytes(traffic->client);
+
+        if (elapsed.count() > 0)
+        {
+            stats.requests_per_second = (stats.requests - traffic->requests_at_last_sample) / elapsed.count();
+            stats.events_per_second = (stats.events - traffic->events_at_last_sample) / elapsed.count();
+        }
+        traffic->requests_at_last_sample = stats.requests;
+        traffic->events_at_last_sample = stats.events;
+
+        if (limits.max_queued_bytes && stats.queued_bytes > limits.max_queued_bytes)
+        {
+            ++traffic->samples_over_limit;
+        }
+        else
+        {
+            traffic->samples_over_limit = 0;
+        }
+
+        if (traffic->samples_over_limit == 0)
+        {
+            stats.throttled = false;
+            for (auto& work : traffic->deferred)
+            {
+                resumed.push_back(std::move(work.second));
+            }
+            traffic->deferred.clear();
+        }
+        else if (limits.throttle_after && traffic->samples_over_limit >= limits.throttle_after)
+        {
+            stats.throttled = true;
+        }
+
+        if (limits.disconnect_after && traffic->samples_over_limit >= limits.disconnect_after)
+        {
+            too_slow.push_back(traffic);
+        }
+    }
+
+    for (auto const traffic : too_slow)
+    {
+        mir::log_warning(
+            "Disconnecting Wayland client (pid %d): it has left %zu bytes unread for %u samples",
+            static_cast<int>(traffic->stats.pid),
+            traffic->stats.queued_bytes,
+            traffic->samples_over_limit);
+
+        // Also destroys traffic, removing it from clients
+        wl_client_destroy(traffic->client);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{snapshot_mutex};
+        latest.clear();
+        for (auto const traffic : clients)
+        {
+            latest.push_back(traffic->stats);
+        }
+    }
+
+    for (auto& work : resumed)
+    {
+        work();
+    }
+}
+
+auto mf::ClientTrafficMonitor::snapshot() const -> std::vector<WaylandClientTraffic>
+{
+    std::lock_guard<std::mutex> lock{snapshot_mutex};
+    return latest;
+}
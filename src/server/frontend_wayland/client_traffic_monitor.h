@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_CLIENT_TRAFFIC_MONITOR_H_
+#define MIR_FRONTEND_CLIENT_TRAFFIC_MONITOR_H_
+
+#include "mir/frontend/wayland_client_traffic.h"
+
+#include <wayland-server-core.h>
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if (WAYLAND_VERSION_MAJOR == 1) && (WAYLAND_VERSION_MINOR < 14)
+#define MIR_NO_WAYLAND_PROTOCOL_LOGGER
+#endif
+
+namespace mir
+{
+namespace frontend
+{
+class ClientTrafficMonitor;
+
+/**
+ * The accounting for one connected client.
+ *
+ * Lives until the client is destroyed. Only use it on the Wayland thread.
+ */
+class ClientTraffic
+{
+public:
+    /// The accounting for client, or nullptr if it is not being monitored
+    static auto from(wl_client* client) -> ClientTraffic*;
+
+    void frame_callbacks_requested(unsigned count);
+    void frame_callbacks_completed(unsigned count);
+
+    /// Whether the client has stayed too far behind on reading what it has been sent
+    auto throttled() const -> bool;
+
+    /// Runs work now or, if the client is throttled, once it has caught up
+    /// While throttled, work for the same key replaces what was deferred before, so each key runs at most once.
+    void run_unthrottled(void const* key, std::function<void()>&& work);
+
+    /// Drops the work deferred for key, if any
+    void cancel_deferred(void const* key);
+
+private:
+    friend class ClientTrafficMonitor;
+
+    ClientTraffic(wl_client* client, ClientTrafficMonitor* monitor);
+    ~ClientTraffic();
+
+    static void on_client_destroyed(wl_listener* listener, void* data);
+
+    wl_listener destroy_listener;
+    wl_client* const client;
+    ClientTrafficMonitor* monitor;
+    WaylandClientTraffic stats;
+
+    uint64_t requests_at_last_sample{0};
+    uint64_t events_at_last_sample{0};
+    unsigned samples_over_limit{0};
+    /// Keyed as passed to run_unthrottled(). A vector (rather than a map) keeps ClientTraffic standard layout.
+    std::vector<std::pair<void const*, std::function<void()>>> deferred;
+};
+
+/**
+ * Per-client accounting of Wayland protocol traffic, and isolation of
+ * clients that don't keep up with it.
+ *
+ * Every request and event is counted as libwayland dispatches or sends it.
+ * Each sample() also reads how much each client has left unread on its
+ * socket. A client that stays over Limits::max_queued_bytes is first
+ * throttled, which holds back its frame callbacks (and so its drawing),
+ * then disconnected. libwayland never blocks on a client's socket, so
+ * nothing here slows the other clients down; the limits just stop a stalled
+ * client costing the server unbounded work and memory.
+ *
+ * Apart from snapshot() everything happens on the Wayland thread.
+ */
+class ClientTrafficMonitor
+{
+public:
+    struct Limits
+    {
+        /// Unread bytes a client may have queued (0 applies no limit)
+        size_t max_queued_bytes;
+        /// Consecutive samples over the limit before throttling (0 never throttles)
+        unsigned throttle_after;
+        /// Consecutive samples over the limit before disconnecting (0 never disconnects)
+        unsigned disconnect_after;
+        /// How often the event loop samples (0 only samples when asked)
+        std::chrono::milliseconds sample_interval;
+    };
+
+    ClientTrafficMonitor(wl_display* display, Limits const& limits);
+    ~ClientTrafficMonitor();
+
+    /// Updates every client's statistics and applies the limits
+    void sample();
+
+    /// The statistics of every client as of the last sample
+    auto snapshot() const -> std::vector<WaylandClientTraffic>;
+
+private:
+    ClientTrafficMonitor(ClientTrafficMonitor const&) = delete;
+    ClientTrafficMonitor& operator=(ClientTrafficMonitor const&) = delete;
+
+    friend class ClientTraffic;
+
+    struct ClientCreatedListener
+    {
+        wl_listener listener;
+        ClientTrafficMonitor* monitor;
+    };
+
+    static auto add_logger(wl_display* display, ClientTrafficMonitor* monitor) -> wl_protocol_logger*;
+    static void on_client_created(wl_listener* listener, void* data);
+#ifndef MIR_NO_WAYLAND_PROTOCOL_LOGGER
+    static void on_message(void* data, wl_protocol_logger_type direction, wl_protocol_logger_message const* message);
+#endif
+    static int on_sample_timer(void* data);
+
+    Limits const limits;
+    ClientCreatedListener client_created;
+    wl_protocol_logger* const logger;
+    wl_event_source* const timer;
+
+    std::vector<ClientTraffic*> clients;
+    std::chrono::steady_clock::time_point last_sample;
+
+    std::mutex mutable snapshot_mutex;
+    std::vector<WaylandClientTraffic> latest;
+};
+}
+}
+
+#endif /* MIR_FRONTEND_CLIENT_TRAFFIC_MONITOR_H_ */
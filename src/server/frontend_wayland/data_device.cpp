@@ -43,12 +43,12 @@ struct DataOffer : mw::DataOffer
 {
     DataOffer(DataSource* source, DataDevice* device);
 
-    void accept(uint32_t serial, std::experimental::optional<std::string> const& mime_type) override
+    void accept(uint32_t serial, std::experimental::optional<std::string_view> const& mime_type) override
     {
         (void)serial, (void)mime_type;
     }
 
-    void receive(std::string const& mime_type, mir::Fd fd) override;
+    void receive(std::string_view mime_type, mir::Fd fd) override;
 
     void destroy() override;
 
@@ -77,7 +77,7 @@ public:
 
     ~DataSource();
 
-    void offer(std::string const& mime_type) override;
+    void offer(std::string_view mime_type) override;
 
     void destroy() override;
 
@@ -169,11 +169,11 @@ private:
 };
 }
 
-void DataSource::offer(std::string const& mime_type)
+void DataSource::offer(std::string_view mime_type)
 {
-    mime_types.push_back(mime_type);
+    mime_types.emplace_back(mime_type);
     for (auto const& listener : listeners)
-        listener->offer(mime_type);
+        listener->offer(mime_types.back());
 }
 
 void DataSource::destroy()
@@ -337,9 +337,9 @@ void DataOffer::offer(std::string const& mime_type)
     send_offer_event(mime_type);
 }
 
-void DataOffer::receive(std::string const& mime_type, mir::Fd fd)
+void DataOffer::receive(std::string_view mime_type, mir::Fd fd)
 {
-    source->send_send(mime_type, fd);
+    source->send_send(std::string{mime_type}, fd);
 }
 
 void DataOffer::destroy()
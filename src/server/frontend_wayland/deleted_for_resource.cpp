@@ -22,6 +22,8 @@
 
 namespace
 {
+/// The flag for a resource lives in its destroy listener; both are freed
+/// once the resource is destroyed and nothing else refers to the flag.
 class DestructionShim
 {
 public:
@@ -36,29 +38,30 @@ public:
         }
         else
         {
-            shim = new DestructionShim{resource};
+            auto const owner = std::make_shared<DestructionShim>();
+            shim = owner.get();
+            shim->self = owner;
+            shim->destruction_listener.notify = &on_destroyed;
+            wl_resource_add_destroy_listener(resource, &shim->destruction_listener);
         }
-        return shim->destroyed;
-    }
-private:
-    DestructionShim(wl_resource* resource)
-        : destroyed{std::make_shared<bool>(false)}
-    {
-        destruction_listener.notify = &on_destroyed;
-        wl_resource_add_destroy_listener(resource, &destruction_listener);
+        return std::shared_ptr<bool>{shim->self, &shim->destroyed};
     }
 
+private:
     static void on_destroyed(wl_listener* listener, void*)
     {
         DestructionShim* shim;
 
         shim = wl_container_of(listener, shim, destruction_listener);
-        *shim->destroyed = true;
-        delete shim;
+        shim->destroyed = true;
+        shim->self.reset();
     }
 
-    std::shared_ptr<bool> const destroyed;
+public:
+    bool destroyed{false};
     wl_listener destruction_listener;
+    /// Keeps the shim alive until the resource is destroyed
+    std::shared_ptr<DestructionShim> self;
 };
 static_assert(
     std::is_standard_layout<DestructionShim>::value,
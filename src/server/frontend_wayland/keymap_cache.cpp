@@ -0,0 +1,265 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keymap_cache.h"
+
+#include "mir/anonymous_shm_file.h"
+
+#include <xkbcommon/xkbcommon.h>
+#include <boost/throw_exception.hpp>
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <linux/memfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Older libc headers lack the sealing API, even where the kernel supports it
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#define F_SEAL_WRITE 0x0008
+#endif
+
+namespace mf = mir::frontend;
+namespace mi = mir::input;
+
+namespace
+{
+auto compile(xkb_context* context, mi::Keymap const& names) -> xkb_keymap*
+{
+    if (!context)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to create XKB context"});
+    }
+
+    xkb_rule_names const rules = {
+        "evdev",
+        names.model.c_str(),
+        names.layout.c_str(),
+        names.variant.c_str(),
+        names.options.c_str()
+    };
+
+    auto const keymap = xkb_keymap_new_from_names(context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    if (!keymap)
+    {
+        std::stringstream message;
+        message << "Failed to compile keymap " << names;
+        BOOST_THROW_EXCEPTION(std::runtime_error{message.str()});
+    }
+    return keymap;
+}
+
+void write_all(int fd, char const* data, size_t size)
+{
+    while (size)
+    {
+        auto const written = write(fd, data, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            BOOST_THROW_EXCEPTION(
+                std::system_error(errno, std::system_category(), "Failed to write keymap"));
+        }
+        data += written;
+        size -= written;
+    }
+}
+
+/// A file holding text, sealed against modification if the kernel allows it
+auto sealed_file_holding(char const* text, size_t size) -> mir::Fd
+{
+    auto const raw_fd = static_cast<int>(
+        syscall(SYS_memfd_create, "mir-keymap", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+
+    if (raw_fd == -1)
+    {
+        // Fall back to an ordinary (if still shared) file
+        mir::AnonymousShmFile file{size};
+        std::memcpy(file.base_ptr(), text, size);
+
+        auto const duplicate = fcntl(file.fd(), F_DUPFD_CLOEXEC, 0);
+        if (duplicate == -1)
+        {
+            BOOST_THROW_EXCEPTION(
+                std::system_error(errno, std::system_category(), "Failed to duplicate keymap file"));
+        }
+        return mir::Fd{duplicate};
+    }
+
+    mir::Fd fd{raw_fd};
+
+    // Written rather than mapped, as F_SEAL_WRITE is refused while writable mappings exist
+    write_all(fd, text, size);
+
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == -1)
+    {
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to seal keymap"));
+    }
+
+    return fd;
+}
+}
+
+mf::CompiledKeymap::CompiledKeymap(mi::Keymap const& names)
+    : context{xkb_context_new(XKB_CONTEXT_NO_FLAGS), &xkb_context_unref},
+      compiled{compile(context.get(), names), &xkb_keymap_unref}
+{
+    std::unique_ptr<char, void(*)(void*)> const buffer{
+        xkb_keymap_get_as_string(compiled.get(), XKB_KEYMAP_FORMAT_TEXT_V1),
+        &free};
+
+    text_size = strlen(buffer.get()) + 1;
+    text = sealed_file_holding(buffer.get(), text_size);
+}
+
+mf::CompiledKeymap::~CompiledKeymap() = default;
+
+auto mf::CompiledKeymap::keymap() const -> xkb_keymap*
+{
+    return compiled.get();
+}
+
+auto mf::CompiledKeymap::client_fd() const -> Fd
+{
+    // Opening the file afresh gives each client its own read-only file description
+    auto const path = "/proc/self/fd/" + std::to_string(static_cast<int>(text));
+    auto const raw_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (raw_fd == -1)
+    {
+        return text;
+    }
+
+    return Fd{raw_fd};
+}
+
+auto mf::CompiledKeymap::size() const -> size_t
+{
+    return text_size;
+}
+
+mf::KeymapCache::Compilation::Compilation(mi::Keymap const& names)
+    : names{names}
+{
+}
+
+mf::KeymapCache::KeymapCache() = default;
+
+mf::KeymapCache::~KeymapCache()
+{
+    // Compilations still in progress reference the cache
+    for (auto const& compilation : keymaps)
+    {
+        compilation.done.wait();
+    }
+}
+
+void mf::KeymapCache::prepare(mi::Keymap const& names)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    compilation_of(names);
+}
+
+auto mf::KeymapCache::get(mi::Keymap const& names) -> std::shared_ptr<CompiledKeymap const>
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    auto const& compilation = compilation_of(names);
+    auto const done = compilation.done;
+
+    lock.unlock();
+    done.wait();
+    lock.lock();
+
+    if (compilation.error)
+    {
+        std::rethrow_exception(compilation.error);
+    }
+    return compilation.compiled;
+}
+
+void mf::KeymapCache::when_compiled(mi::Keymap const& names, Completion&& completion)
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    auto& compilation = compilation_of(names);
+
+    if (!compilation.complete)
+    {
+        compilation.waiting.push_back(std::move(completion));
+        return;
+    }
+
+    auto const compiled = compilation.compiled;
+    auto const error = compilation.error;
+    lock.unlock();
+
+    completion(compiled, error);
+}
+
+auto mf::KeymapCache::compilation_of(mi::Keymap const& names) -> Compilation&
+{
+    for (auto& keymap : keymaps)
+    {
+        if (keymap.names == names)
+            return keymap;
+    }
+
+    keymaps.emplace_back(names);
+    auto& compilation = keymaps.back();
+    compilation.done = std::async(std::launch::async, [this, &compilation] { compile(compilation); }).share();
+    return compilation;
+}
+
+void mf::KeymapCache::compile(Compilation& compilation)
+{
+    std::shared_ptr<CompiledKeymap const> compiled;
+    std::exception_ptr error;
+
+    try
+    {
+        compiled = std::make_shared<CompiledKeymap const>(compilation.names);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    std::vector<Completion> waiting;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        compilation.complete = true;
+        compilation.compiled = compiled;
+        compilation.error = error;
+        waiting.swap(compilation.waiting);
+    }
+
+    // Without the lock, so that completions can use the cache
+    for (auto const& completion : waiting)
+    {
+        completion(compiled, error);
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_KEYMAP_CACHE_H_
+#define MIR_FRONTEND_KEYMAP_CACHE_H_
+
+#include "mir/fd.h"
+#include "mir/input/keymap.h"
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// from <xkbcommon/xkbcommon.h>
+struct xkb_keymap;
+struct xkb_context;
+
+namespace mir
+{
+namespace frontend
+{
+/**
+ * A keymap compiled from its names, along with the text sent to clients.
+ *
+ * Compiled keymaps are immutable and shared by every keyboard using them;
+ * only keyboard state is per-keyboard. The text is held in a sealed memfd
+ * (where the kernel supports them) that clients can map but not modify.
+ */
+class CompiledKeymap
+{
+public:
+    /// Compiles the keymap. This takes tens of milliseconds, so avoid the Wayland thread
+    explicit CompiledKeymap(input::Keymap const& names);
+    ~CompiledKeymap();
+
+    /// Only reference this (e.g. with xkb_state_new()) on the Wayland thread
+    auto keymap() const -> xkb_keymap*;
+
+    /// A read-only descriptor for the keymap text, to send to a client
+    auto client_fd() const -> Fd;
+
+    /// The size of the keymap text, including its terminating nul
+    auto size() const -> size_t;
+
+private:
+    CompiledKeymap(CompiledKeymap const&) = delete;
+    CompiledKeymap& operator=(CompiledKeymap const&) = delete;
+
+    // Each keymap has its own context, as xkbcommon contexts are not threadsafe
+    std::unique_ptr<xkb_context, void (*)(xkb_context*)> const context;
+    std::unique_ptr<xkb_keymap, void (*)(xkb_keymap*)> const compiled;
+    size_t text_size;
+    Fd text;
+};
+
+/**
+ * Compiles each distinct keymap once, for all clients.
+ *
+ * Keymaps can be prepared as soon as they are known, so that they are
+ * compiled in the background before any keyboard needs them. There are
+ * few distinct keymaps in any session, so they are never evicted.
+ *
+ * All members are threadsafe.
+ */
+class KeymapCache
+{
+public:
+    KeymapCache();
+    ~KeymapCache();
+
+    /// Starts compiling the keymap in the background, unless it already has been
+    void prepare(input::Keymap const& names);
+
+    /// The compiled keymap, waiting for it to be compiled if need be (so not on the Wayland thread)
+    /// \throws std::runtime_error if the keymap does not compile
+    auto get(input::Keymap const& names) -> std::shared_ptr<CompiledKeymap const>;
+
+    /// Receives the compiled keymap, or (if it does not compile) null and the reason
+    using Completion =
+        std::function<void(std::shared_ptr<CompiledKeymap const> const& keymap, std::exception_ptr const& error)>;
+
+    /**
+     * Calls completion once the keymap is compiled, starting to compile it if need be.
+     *
+     * This does not wait: completion is called immediately if the keymap is already
+     * compiled, or else on the thread compiling it.
+     */
+    void when_compiled(input::Keymap const& names, Completion&& completion);
+
+private:
+    KeymapCache(KeymapCache const&) = delete;
+    KeymapCache& operator=(KeymapCache const&) = delete;
+
+    struct Compilation
+    {
+        explicit Compilation(input::Keymap const& names);
+
+        input::Keymap const names;
+
+        // Guarded by the cache's mutex
+        bool complete{false};
+        std::shared_ptr<CompiledKeymap const> compiled;
+        std::exception_ptr error;
+        std::vector<Completion> waiting;
+
+        std::shared_future<void> done;
+    };
+
+    /// Called with the cache's mutex locked
+    auto compilation_of(input::Keymap const& names) -> Compilation&;
+    void compile(Compilation& compilation);
+
+    std::mutex mutex;
+    // A list, so that compilations in progress are not moved by adding another
+    std::list<Compilation> keymaps;
+};
+}
+}
+
+#endif // MIR_FRONTEND_KEYMAP_CACHE_H_
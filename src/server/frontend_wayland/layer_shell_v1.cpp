@@ -79,7 +79,7 @@ private:
         wl_resource* surface,
         std::experimental::optional<wl_resource*> const& output,
         uint32_t layer,
-        std::string const& namespace_) override;
+        std::string_view namespace_) override;
     void destroy() override;
 
     mf::LayerShellV1* const shell;
@@ -248,7 +248,7 @@ void mf::LayerShellV1::Instance::get_layer_surface(
     wl_resource* surface,
     std::experimental::optional<wl_resource*> const& output,
     uint32_t layer,
-    std::string const& namespace_)
+    std::string_view namespace_)
 {
     (void)namespace_; // Can be ignored if no special behavior is required
 
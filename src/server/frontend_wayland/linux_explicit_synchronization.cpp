@@ -0,0 +1,193 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "linux_explicit_synchronization.h"
+
+#include "wl_surface.h"
+#include "linux-explicit-synchronization-unstable-v1_wrapper.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <fcntl.h>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+
+class LinuxExplicitSynchronization : public wayland::LinuxExplicitSynchronizationV1::Global
+{
+public:
+    LinuxExplicitSynchronization(struct wl_display* display);
+
+private:
+    class Instance : public wayland::LinuxExplicitSynchronizationV1
+    {
+    public:
+        Instance(wl_resource* new_resource);
+
+    private:
+        void destroy() override;
+        void get_synchronization(wl_resource* new_synchronization, wl_resource* surface) override;
+    };
+
+    void bind(wl_resource* new_resource) override;
+};
+
+/// Per-commit acquire fence and release event for one wl_surface; the surface applies them on commit
+class LinuxSurfaceSynchronization : public wayland::LinuxSurfaceSynchronizationV1
+{
+public:
+    LinuxSurfaceSynchronization(wl_resource* new_resource, WlSurface* surface);
+    ~LinuxSurfaceSynchronization();
+
+private:
+    void destroy() override;
+    void set_acquire_fence(Fd fd) override;
+    void get_release(wl_resource* new_release) override;
+
+    auto require_surface() const -> WlSurface*;
+
+    WlSurface* surface;
+};
+
+}
+}
+
+auto mf::create_linux_explicit_synchronization(struct wl_display* display)
+    -> std::shared_ptr<LinuxExplicitSynchronization>
+{
+    return std::make_shared<LinuxExplicitSynchronization>(display);
+}
+
+mf::LinuxExplicitSynchronization::LinuxExplicitSynchronization(struct wl_display* display)
+    : Global(display, Version<1>())
+{
+}
+
+void mf::LinuxExplicitSynchronization::bind(wl_resource* new_resource)
+{
+    new Instance{new_resource};
+}
+
+mf::LinuxExplicitSynchronization::Instance::Instance(wl_resource* new_resource)
+    : wayland::LinuxExplicitSynchronizationV1{new_resource, Version<1>()}
+{
+}
+
+void mf::LinuxExplicitSynchronization::Instance::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::LinuxExplicitSynchronization::Instance::get_synchronization(
+    wl_resource* new_synchronization,
+    wl_resource* surface)
+{
+    auto const wl_surface = WlSurface::from(surface);
+    if (wl_surface->synchronization())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::synchronization_exists,
+            "wl_surface@%d already has a zwp_linux_surface_synchronization_v1",
+            wl_resource_get_id(surface)));
+    }
+
+    new LinuxSurfaceSynchronization{new_synchronization, wl_surface};
+}
+
+mf::LinuxSurfaceSynchronization::LinuxSurfaceSynchronization(wl_resource* new_resource, WlSurface* surface)
+    : wayland::LinuxSurfaceSynchronizationV1{new_resource, Version<1>()},
+      surface{surface}
+{
+    surface->set_synchronization(resource);
+    surface->add_destroy_listener(this, [this]() { this->surface = nullptr; });
+}
+
+mf::LinuxSurfaceSynchronization::~LinuxSurfaceSynchronization()
+{
+    if (surface)
+    {
+        // Fences and release events requested since the last commit are discarded
+        surface->remove_destroy_listener(this);
+        surface->set_synchronization(nullptr);
+        surface->set_pending_acquire_fence(std::experimental::nullopt);
+        surface->set_pending_buffer_release(nullptr);
+    }
+}
+
+void mf::LinuxSurfaceSynchronization::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::LinuxSurfaceSynchronization::set_acquire_fence(Fd fd)
+{
+    auto const target = require_surface();
+
+    // Anything that isn't a sync_file would be rejected by the GPU import; catching the
+    // obvious cases here gives the client a useful error
+    if (fcntl(fd, F_GETFD) < 0)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_fence,
+            "Acquire fence %d is not a valid file descriptor",
+            static_cast<int>(fd)));
+    }
+
+    if (target->has_pending_acquire_fence())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::duplicate_fence,
+            "An acquire fence has already been set for this commit"));
+    }
+
+    target->set_pending_acquire_fence(fd);
+}
+
+void mf::LinuxSurfaceSynchronization::get_release(wl_resource* new_release)
+{
+    auto const target = require_surface();
+
+    if (target->has_pending_buffer_release())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::duplicate_release,
+            "A release event has already been requested for this commit"));
+    }
+
+    target->set_pending_buffer_release(std::make_shared<WlSurfaceState::BufferRelease>(new_release));
+}
+
+auto mf::LinuxSurfaceSynchronization::require_surface() const -> WlSurface*
+{
+    if (!surface)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::no_surface,
+            "wl_surface of zwp_linux_surface_synchronization_v1@%d has been destroyed",
+            wl_resource_get_id(resource)));
+    }
+    return surface;
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "viewporter.h"
+
+#include "wl_surface.h"
+#include "viewporter_wrapper.h"
+
+#include <boost/throw_exception.hpp>
+
+namespace mf = mir::frontend;
+namespace geom = mir::geometry;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+
+class Viewporter : public wayland::Viewporter::Global
+{
+public:
+    Viewporter(struct wl_display* display);
+
+private:
+    class Instance : public wayland::Viewporter
+    {
+    public:
+        Instance(wl_resource* new_resource);
+
+    private:
+        void destroy() override;
+        void get_viewport(wl_resource* new_viewport, wl_resource* surface) override;
+    };
+
+    void bind(wl_resource* new_resource) override;
+};
+
+/// Crop and scale state for one wl_surface; the surface applies it on commit
+class Viewport : public wayland::Viewport
+{
+public:
+    Viewport(wl_resource* new_resource, WlSurface* surface);
+    ~Viewport();
+
+private:
+    void destroy() override;
+    void set_source(double x, double y, double width, double height) override;
+    void set_destination(int32_t width, int32_t height) override;
+
+    auto require_surface() const -> WlSurface*;
+
+    WlSurface* surface;
+};
+
+}
+}
+
+auto mf::create_viewporter(struct wl_display* display) -> std::shared_ptr<Viewporter>
+{
+    return std::make_shared<Viewporter>(display);
+}
+
+mf::Viewporter::Viewporter(struct wl_display* display)
+    : Global(display, Version<1>())
+{
+}
+
+void mf::Viewporter::bind(wl_resource* new_resource)
+{
+    new Instance{new_resource};
+}
+
+mf::Viewporter::Instance::Instance(wl_resource* new_resource)
+    : wayland::Viewporter{new_resource, Version<1>()}
+{
+}
+
+void mf::Viewporter::Instance::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::Viewporter::Instance::get_viewport(wl_resource* new_viewport, wl_resource* surface)
+{
+    auto const wl_surface = WlSurface::from(surface);
+    if (wl_surface->viewport())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::viewport_exists,
+            "wl_surface@%d already has a wp_viewport",
+            wl_resource_get_id(surface)));
+    }
+
+    new Viewport{new_viewport, wl_surface};
+}
+
+mf::Viewport::Viewport(wl_resource* new_resource, WlSurface* surface)
+    : wayland::Viewport{new_resource, Version<1>()},
+      surface{surface}
+{
+    surface->set_viewport(resource);
+    surface->add_destroy_listener(this, [this]() { this->surface = nullptr; });
+}
+
+mf::Viewport::~Viewport()
+{
+    if (surface)
+    {
+        surface->remove_destroy_listener(this);
+        surface->set_viewport(nullptr);
+        surface->set_pending_viewport_source(std::experimental::nullopt);
+        surface->set_pending_viewport_destination(std::experimental::nullopt);
+    }
+}
+
+void mf::Viewport::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::Viewport::set_source(double x, double y, double width, double height)
+{
+    auto const target = require_surface();
+
+    if (x == -1 && y == -1 && width == -1 && height == -1)
+    {
+        target->set_pending_viewport_source(std::experimental::nullopt);
+        return;
+    }
+
+    if (x < 0 || y < 0 || width <= 0 || height <= 0)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::bad_value,
+            "Invalid source rectangle %gx%g+%g+%g",
+            width, height, x, y));
+    }
+
+    target->set_pending_viewport_source(WlSurfaceState::ViewportSource{x, y, width, height});
+}
+
+void mf::Viewport::set_destination(int32_t width, int32_t height)
+{
+    auto const target = require_surface();
+
+    if (width == -1 && height == -1)
+    {
+        target->set_pending_viewport_destination(std::experimental::nullopt);
+        return;
+    }
+
+    if (width <= 0 || height <= 0)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::bad_value,
+            "Invalid destination size %dx%d",
+            width, height));
+    }
+
+    target->set_pending_viewport_destination(geom::Size{width, height});
+}
+
+auto mf::Viewport::require_surface() const -> WlSurface*
+{
+    if (!surface)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::no_surface,
+            "wl_surface of wp_viewport@%d has been destroyed",
+            wl_resource_get_id(resource)));
+    }
+    return surface;
+}
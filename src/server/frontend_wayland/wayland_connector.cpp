@@ -413,9 +413,9 @@ protected:
         WindowWlSurfaceRole::set_state_now(mir_window_state_maximized);
     }
 
-    void set_title(std::string const& title) override
+    void set_title(std::string_view title) override
     {
-        WindowWlSurfaceRole::set_title(title);
+        WindowWlSurfaceRole::set_title(std::string{title});
     }
 
     void pong(uint32_t /*serial*/) override
@@ -471,7 +471,7 @@ protected:
         WindowWlSurfaceRole::initiate_interactive_resize(edge);
     }
 
-    void set_class(std::string const& /*class_*/) override
+    void set_class(std::string_view /*class_*/) override
     {
     }
 };
@@ -616,9 +616,11 @@ mf::WaylandConnector::WaylandConnector(
     std::shared_ptr<SurfaceStack> const& surface_stack,
     bool arw_socket,
     std::unique_ptr<WaylandExtensions> extensions_,
-    WaylandProtocolExtensionFilter const& extension_filter)
+    WaylandProtocolExtensionFilter const& extension_filter,
+    ClientTrafficMonitor::Limits const& client_traffic_limits)
     : display{wl_display_create(), &cleanup_display},
       pause_signal{eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE)},
+      traffic_monitor{std::make_unique<ClientTrafficMonitor>(display.get(), client_traffic_limits)},
       executor{std::make_shared<WaylandExecutor>(wl_display_get_event_loop(display.get()))},
       allocator{allocator_for_display(allocator, display.get(), executor)},
       shell{shell},
@@ -725,6 +727,17 @@ mf::WaylandConnector::~WaylandConnector()
         stop();
     }
     wl_event_source_remove(pause_source);
+
+    // Only wrappers generated with --profile-requests have anything to report
+    mw::for_each_request_profile([](mw::RequestProfile const& profile)
+        {
+            mir::log_info(
+                "%s: %llu dispatches, %lldns total, %lldns max",
+                profile.name,
+                static_cast<unsigned long long>(profile.dispatch_count),
+                static_cast<long long>(profile.total_time.count()),
+                static_cast<long long>(profile.max_time.count()));
+        });
 }
 
 void mf::WaylandConnector::start()
@@ -851,6 +864,11 @@ auto mf::WaylandConnector::get_extension(std::string const& name) const -> std::
     return extensions->get_extension(name);
 }
 
+auto mf::WaylandConnector::client_traffic() const -> std::vector<WaylandClientTraffic>
+{
+    return traffic_monitor->snapshot();
+}
+
 bool mf::WaylandConnector::wl_display_global_filter_func_thunk(wl_client const* client, wl_global const* global, void *data)
 {
     return static_cast<WaylandConnector*>(data)->wl_display_global_filter_func(client, global);
@@ -20,8 +20,10 @@
 #define MIR_FRONTEND_WAYLAND_CONNECTOR_H_
 
 #include "mir/frontend/connector.h"
+#include "mir/frontend/wayland_client_traffic.h"
 #include "mir/fd.h"
 #include "mir/optional_value.h"
+#include "client_traffic_monitor.h"
 
 #include <wayland-server-core.h>
 #include <unordered_map>
@@ -116,7 +118,8 @@ public:
         std::shared_ptr<SurfaceStack> const& surface_stack,
         bool arw_socket,
         std::unique_ptr<WaylandExtensions> extensions,
-        WaylandProtocolExtensionFilter const& extension_filter);
+        WaylandProtocolExtensionFilter const& extension_filter,
+        ClientTrafficMonitor::Limits const& client_traffic_limits);
 
     ~WaylandConnector() override;
 
@@ -138,12 +141,16 @@ public:
 
     auto get_extension(std::string const& name) const -> std::shared_ptr<void>;
 
+    /// The protocol traffic of each connected client, as last sampled
+    auto client_traffic() const -> std::vector<WaylandClientTraffic>;
+
 private:
     bool wl_display_global_filter_func(wl_client const* client, wl_global const* global) const;
     static bool wl_display_global_filter_func_thunk(wl_client const* client, wl_global const* global, void* data);
 
     std::unique_ptr<wl_display, void(*)(wl_display*)> const display;
     mir::Fd const pause_signal;
+    std::unique_ptr<ClientTrafficMonitor> const traffic_monitor;
     std::unique_ptr<WlCompositor> compositor_global;
     std::unique_ptr<WlSubcompositor> subcompositor_global;
     std::unique_ptr<WlSeat> seat_global;
@@ -30,12 +30,22 @@
 #include "xdg-output-unstable-v1_wrapper.h"
 #include "foreign_toplevel_manager_v1.h"
 #include "wlr-foreign-toplevel-management-unstable-v1_wrapper.h"
+#include "viewporter.h"
+#include "viewporter_wrapper.h"
+#include "linux_explicit_synchronization.h"
+#include "linux-explicit-synchronization-unstable-v1_wrapper.h"
 
 #include "mir/graphics/platform.h"
 #include "mir/options/default_configuration.h"
 #include "mir/scene/session.h"
 #include "mir/log.h"
 
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
 namespace mf = mir::frontend;
 namespace ms = mir::scene;
 namespace msh = mir::shell;
@@ -73,6 +83,14 @@ std::vector<ExtensionBuilder> const internal_extension_builders = {
         mw::XdgOutputManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
             { return create_xdg_output_manager_v1(ctx.display, ctx.output_manager); }
     },
+    {
+        mw::Viewporter::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_viewporter(ctx.display); }
+    },
+    {
+        mw::LinuxExplicitSynchronizationV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_linux_explicit_synchronization(ctx.display); }
+    },
     {
         mw::ForeignToplevelManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
             {
@@ -162,6 +180,26 @@ auto configure_wayland_extensions(
 
     return std::make_unique<WaylandExtensions>(move(enabled_internal_builders), move(enabled_external_hooks));
 }
+
+auto client_traffic_limits(mo::Option const& options) -> mf::ClientTrafficMonitor::Limits
+{
+    using namespace std::chrono_literals;
+
+    auto const policy = options.get<std::string>(mo::wayland_slow_client_policy_opt);
+    auto const queue_limit = options.get<int>(mo::wayland_client_queue_limit_opt);
+
+    if (policy != mo::off_opt_value && policy != mo::throttle_opt_value && policy != mo::disconnect_opt_value)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("Unknown slow Wayland client policy: " + policy));
+    }
+
+    // Sampled twice a second: throttled after a second behind, disconnected after ten
+    return mf::ClientTrafficMonitor::Limits{
+        policy == mo::off_opt_value ? 0 : static_cast<size_t>(std::max(queue_limit, 0)),
+        2,
+        policy == mo::disconnect_opt_value ? 20u : 0u,
+        500ms};
+}
 }
 
 auto mf::get_standard_extensions() -> std::vector<std::string>
@@ -169,7 +207,9 @@ auto mf::get_standard_extensions() -> std::vector<std::string>
     return std::vector<std::string>{
         mw::Shell::interface_name,
         mw::XdgWmBase::interface_name,
-        mw::XdgShellV6::interface_name};
+        mw::XdgShellV6::interface_name,
+        mw::Viewporter::interface_name,
+        mw::LinuxExplicitSynchronizationV1::interface_name};
 }
 
 auto mf::get_supported_extensions() -> std::vector<std::string>
@@ -212,7 +252,8 @@ std::shared_ptr<mf::Connector>
                     wayland_extensions,
                     options->is_set(mo::x11_display_opt),
                     wayland_extension_hooks),
-                wayland_extension_filter);
+                wayland_extension_filter,
+                client_traffic_limits(*options));
         });
 }
 
@@ -109,6 +109,9 @@ void mf::WaylandSurfaceObserver::keymap_changed(
     // shared pointer instead of unique so it can be owned by the lambda
     auto const keymap = std::make_shared<mi::Keymap>(model, layout, variant, options);
 
+    // Compile it here, rather than stall the Wayland thread
+    seat->prepare_keymap(*keymap);
+
     run_on_wayland_thread_unless_destroyed(
         [this, keymap]()
         {
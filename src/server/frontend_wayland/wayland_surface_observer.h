@@ -81,7 +81,7 @@ public:
     void disconnect() { *destroyed = true; }
 
 private:
-    WlSeat* const seat; // only used by run_on_wayland_thread_unless_destroyed()
+    WlSeat* const seat; // only used by run_on_wayland_thread_unless_destroyed() and keymap_changed()
     WindowWlSurfaceRole* const window;
     std::unique_ptr<WaylandInputDispatcher> const input_dispatcher;
 
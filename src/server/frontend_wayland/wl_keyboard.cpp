@@ -18,11 +18,11 @@
 
 #include "wl_keyboard.h"
 
+#include "keymap_cache.h"
 #include "wayland_utils.h"
 #include "wl_surface.h"
 
 #include "mir/executor.h"
-#include "mir/anonymous_shm_file.h"
 #include "mir/input/keymap.h"
 #include "mir/log.h"
 #include "mir/fatal.h"
@@ -38,13 +38,15 @@ namespace mi = mir::input;
 
 mf::WlKeyboard::WlKeyboard(
     wl_resource* new_resource,
+    std::shared_ptr<KeymapCache> const& keymap_cache,
+    std::shared_ptr<Executor> const& wayland_executor,
     mir::input::Keymap const& initial_keymap,
     std::function<void(WlKeyboard*)> const& on_destroy,
     std::function<std::vector<uint32_t>()> const& acquire_current_keyboard_state)
     : Keyboard(new_resource, Version<6>()),
-      keymap{nullptr, &xkb_keymap_unref},
+      keymap_cache{keymap_cache},
+      wayland_executor{wayland_executor},
       state{nullptr, &xkb_state_unref},
-      context{xkb_context_new(XKB_CONTEXT_NO_FLAGS), &xkb_context_unref},
       on_destroy{on_destroy},
       acquire_current_keyboard_state{acquire_current_keyboard_state}
 {
@@ -86,10 +88,13 @@ void mf::WlKeyboard::key(std::chrono::milliseconds const& ms, WlSurface* surface
          * HACK! Maintain our own XKB state, so we can serialise it for
          * wl_keyboard_send_modifiers
          */
-        xkb_key_direction const xkb_state = down ? XKB_KEY_DOWN : XKB_KEY_UP;
-        xkb_state_update_key(state.get(), scancode + 8, xkb_state);
+        if (state)
+        {
+            xkb_key_direction const xkb_state = down ? XKB_KEY_DOWN : XKB_KEY_UP;
+            xkb_state_update_key(state.get(), scancode + 8, xkb_state);
 
-        update_modifier_state();
+            update_modifier_state();
+        }
     }
     else
     {
@@ -169,8 +174,12 @@ void mf::WlKeyboard::focussed(WlSurface* surface, bool should_be_focused)
 
 void mf::WlKeyboard::update_keyboard_state(std::vector<uint32_t> const& keyboard_state)
 {
+    // Without a keymap there's no state to keep; it's built once the keymap is compiled
+    if (!keymap)
+        return;
+
     // Rebuild xkb state
-    state = decltype(state)(xkb_state_new(keymap.get()), &xkb_state_unref);
+    state = decltype(state)(xkb_state_new(keymap->keymap()), &xkb_state_unref);
     for (auto scancode : keyboard_state)
     {
         xkb_state_update_key(state.get(), scancode + 8, XKB_KEY_DOWN);
@@ -181,32 +190,64 @@ void mf::WlKeyboard::update_keyboard_state(std::vector<uint32_t> const& keyboard
 
 void mf::WlKeyboard::set_keymap(mi::Keymap const& new_keymap)
 {
-    xkb_rule_names const names = {
-        "evdev",
-        new_keymap.model.c_str(),
-        new_keymap.layout.c_str(),
-        new_keymap.variant.c_str(),
-        new_keymap.options.c_str()
-    };
-    keymap = decltype(keymap){
-        xkb_keymap_new_from_names(
-            context.get(),
-            &names,
-            XKB_KEYMAP_COMPILE_NO_FLAGS),
-        &xkb_keymap_unref};
-
-    // TODO: We might need to copy across the existing depressed keys?
-    state = decltype(state)(xkb_state_new(keymap.get()), &xkb_state_unref);
-
-    std::unique_ptr<char, void(*)(void*)> buffer{xkb_keymap_get_as_string(keymap.get(), XKB_KEYMAP_FORMAT_TEXT_V1), free};
-    auto length = strlen(buffer.get());
-
-    mir::AnonymousShmFile shm_buffer{length};
-    memcpy(shm_buffer.base_ptr(), buffer.get(), length);
-
-    send_keymap_event(KeymapFormat::xkb_v1,
-                      Fd{IntOwnedFd{shm_buffer.fd()}},
-                      length);
+    // Compiling a keymap takes tens of milliseconds, so rather than wait for it the
+    // keymap is sent once it has been compiled (which may be on another thread)
+    auto const request = ++keymap_requests;
+
+    keymap_cache->when_compiled(
+        new_keymap,
+        [weak_self = mw::make_weak(this), executor = wayland_executor, request](
+            std::shared_ptr<CompiledKeymap const> const& compiled,
+            std::exception_ptr const& error)
+        {
+            executor->spawn(
+                [weak_self, request, compiled, error]()
+                {
+                    if (weak_self)
+                    {
+                        weak_self.value().keymap_compiled(request, compiled, error);
+                    }
+                });
+        });
+}
+
+void mf::WlKeyboard::keymap_compiled(
+    uint64_t request,
+    std::shared_ptr<CompiledKeymap const> const& compiled,
+    std::exception_ptr const& error)
+{
+    // A later keymap has been requested since
+    if (request != keymap_requests)
+        return;
+
+    if (error)
+    {
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch (std::exception const& reason)
+        {
+            if (keymap)
+                log_warning("Keeping the current keymap: %s", reason.what());
+            else
+                log_error("Failed to compile a keymap for a keyboard: %s", reason.what());
+        }
+        return;
+    }
+
+    keymap = compiled;
+    send_keymap_event(KeymapFormat::xkb_v1, keymap->client_fd(), keymap->size());
+
+    if (focused_surface)
+    {
+        update_keyboard_state(acquire_current_keyboard_state());
+    }
+    else
+    {
+        // TODO: We might need to copy across the existing depressed keys?
+        state = decltype(state)(xkb_state_new(keymap->keymap()), &xkb_state_unref);
+    }
 }
 
 void mf::WlKeyboard::update_modifier_state()
@@ -214,6 +255,9 @@ void mf::WlKeyboard::update_modifier_state()
     // TODO?
     // assert_on_wayland_event_loop()
 
+    if (!state)
+        return;
+
     auto new_depressed_mods = xkb_state_serialize_mods(
         state.get(),
         XKB_STATE_MODS_DEPRESSED);
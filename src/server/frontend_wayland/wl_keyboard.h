@@ -24,11 +24,10 @@
 #include <vector>
 #include <functional>
 #include <chrono>
+#include <exception>
 
 // from <xkbcommon/xkbcommon.h>
-struct xkb_keymap;
 struct xkb_state;
-struct xkb_context;
 
 namespace mir
 {
@@ -43,12 +42,16 @@ class Keymap;
 namespace frontend
 {
 class WlSurface;
+class KeymapCache;
+class CompiledKeymap;
 
 class WlKeyboard : public wayland::Keyboard
 {
 public:
     WlKeyboard(
         wl_resource* new_resource,
+        std::shared_ptr<KeymapCache> const& keymap_cache,
+        std::shared_ptr<Executor> const& wayland_executor,
         mir::input::Keymap const& initial_keymap,
         std::function<void(WlKeyboard*)> const& on_destroy,
         std::function<std::vector<uint32_t>()> const& acquire_current_keyboard_state);
@@ -63,10 +66,18 @@ public:
 private:
     void update_modifier_state();
     void update_keyboard_state(std::vector<uint32_t> const& keyboard_state);
-
-    std::unique_ptr<xkb_keymap, void (*)(xkb_keymap *)> keymap;
+    void keymap_compiled(
+        uint64_t request,
+        std::shared_ptr<CompiledKeymap const> const& compiled,
+        std::exception_ptr const& error);
+
+    std::shared_ptr<KeymapCache> const keymap_cache;
+    std::shared_ptr<Executor> const wayland_executor;
+    /// Counts calls to set_keymap(), so that only the latest keymap requested is sent
+    uint64_t keymap_requests{0};
+    /// Null until the first keymap is compiled
+    std::shared_ptr<CompiledKeymap const> keymap;
     std::unique_ptr<xkb_state, void (*)(xkb_state *)> state;
-    std::unique_ptr<xkb_context, void (*)(xkb_context *)> const context;
 
     std::function<void(WlKeyboard*)> on_destroy;
     std::function<std::vector<uint32_t>()> const acquire_current_keyboard_state;
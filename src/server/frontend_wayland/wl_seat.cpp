@@ -20,6 +20,7 @@
 
 #include "wl_seat.h"
 
+#include "keymap_cache.h"
 #include "wayland_utils.h"
 #include "wl_surface.h"
 #include "wl_keyboard.h"
@@ -161,11 +162,13 @@ mf::WlSeat::WlSeat(
     std::shared_ptr<mir::Executor> const& executor)
     :   Global(display, Version<6>()),
         keymap{std::make_unique<input::Keymap>()},
+        keymap_cache{std::make_shared<KeymapCache>()},
         config_observer{
             std::make_shared<ConfigObserver>(
                 *keymap,
                 [this](mi::Keymap const& new_keymap)
                 {
+                    keymap_cache->prepare(new_keymap);
                     *keymap = new_keymap;
                 })},
         pointer_listeners{std::make_shared<ListenerList<WlPointer>>()},
@@ -175,6 +178,7 @@ mf::WlSeat::WlSeat(
         seat{seat},
         executor{executor}
 {
+    keymap_cache->prepare(*keymap);
     input_hub->add_observer(config_observer);
     add_focus_listener(&focus);
 }
@@ -219,6 +223,11 @@ void mf::WlSeat::spawn(std::function<void()>&& work)
     executor->spawn(std::move(work));
 }
 
+void mf::WlSeat::prepare_keymap(mi::Keymap const& keymap)
+{
+    keymap_cache->prepare(keymap);
+}
+
 void mf::WlSeat::bind(wl_resource* new_wl_seat)
 {
     new Instance{new_wl_seat, this};
@@ -252,6 +261,8 @@ void mf::WlSeat::Instance::get_keyboard(wl_resource* new_keyboard)
         client,
         new WlKeyboard{
             new_keyboard,
+            seat->keymap_cache,
+            seat->executor,
             *seat->keymap,
             [listeners = seat->keyboard_listeners, client = client](WlKeyboard* listener)
             {
@@ -23,12 +23,17 @@
 #include "wl_subcompositor.h"
 #include "wl_region.h"
 #include "deleted_for_resource.h"
+#include "client_traffic_monitor.h"
 
 #include "wayland_wrapper.h"
+#include "viewporter_wrapper.h"
+#include "linux-explicit-synchronization-unstable-v1_wrapper.h"
 
 #include "wayland_frontend.tp.h"
 
 #include "mir/graphics/buffer_properties.h"
+#include "mir/graphics/fenced_buffer.h"
+#include "mir/graphics/renderable.h"
 #include "mir/scene/session.h"
 #include "mir/frontend/wayland.h"
 #include "mir/compositor/buffer_stream.h"
@@ -38,6 +43,7 @@
 #include "mir/log.h"
 
 #include <algorithm>
+#include <cmath>
 #include <boost/throw_exception.hpp>
 #include <wayland-server-protocol.h>
 
@@ -52,6 +58,12 @@ mf::WlSurfaceState::Callback::Callback(wl_resource* new_resource)
 {
 }
 
+mf::WlSurfaceState::BufferRelease::BufferRelease(wl_resource* new_resource)
+    : mw::LinuxBufferReleaseV1{new_resource, Version<1>()},
+      destroyed{deleted_flag_for_resource(resource)}
+{
+}
+
 void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
 {
     if (source.buffer)
@@ -66,6 +78,18 @@ void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
     if (source.input_shape)
         input_shape = source.input_shape;
 
+    if (source.viewport_source)
+        viewport_source = source.viewport_source;
+
+    if (source.viewport_destination)
+        viewport_destination = source.viewport_destination;
+
+    if (source.acquire_fence)
+        acquire_fence = source.acquire_fence;
+
+    if (source.buffer_release)
+        buffer_release = source.buffer_release;
+
     frame_callbacks.insert(end(frame_callbacks),
                            begin(source.frame_callbacks),
                            end(source.frame_callbacks));
@@ -107,6 +131,12 @@ mf::WlSurface::~WlSurface()
         listener.second();
     }
 
+    if (auto const traffic = ClientTraffic::from(client))
+    {
+        traffic->frame_callbacks_completed(frame_callbacks.size() + pending.frame_callbacks.size());
+        traffic->cancel_deferred(this);
+    }
+
     role->destroy();
     session->destroy_buffer_stream(stream);
 }
@@ -161,6 +191,27 @@ void mf::WlSurface::set_pending_offset(std::experimental::optional<geom::Displac
     pending.offset = offset;
 }
 
+void mf::WlSurface::set_pending_acquire_fence(std::experimental::optional<Fd> const& fence)
+{
+    pending.acquire_fence = fence;
+}
+
+void mf::WlSurface::set_pending_buffer_release(std::shared_ptr<WlSurfaceState::BufferRelease> const& release)
+{
+    pending.buffer_release = release;
+}
+
+void mf::WlSurface::set_pending_viewport_source(
+    std::experimental::optional<WlSurfaceState::ViewportSource> const& source)
+{
+    pending.viewport_source = source;
+}
+
+void mf::WlSurface::set_pending_viewport_destination(std::experimental::optional<geom::Size> const& size)
+{
+    pending.viewport_destination = size;
+}
+
 void mf::WlSurface::add_subsurface(WlSubsurface* child)
 {
     if (std::find(children.begin(), children.end(), child) != children.end())
@@ -242,6 +293,22 @@ mf::WlSurface* mf::WlSurface::from(wl_resource* resource)
 
 void mf::WlSurface::send_frame_callbacks()
 {
+    auto const traffic = ClientTraffic::from(client);
+
+    if (traffic && traffic->throttled())
+    {
+        // Hold the callbacks (and so the client's drawing) back until it catches up with its events
+        // However many frames it commits meanwhile, this surface has one send queued
+        traffic->run_unthrottled(this, [weak_self = mw::make_weak(this)]()
+            {
+                if (weak_self)
+                {
+                    weak_self.value().send_frame_callbacks();
+                }
+            });
+        return;
+    }
+
     for (auto const& frame : frame_callbacks)
     {
         if (!*frame->destroyed)
@@ -251,6 +318,11 @@ void mf::WlSurface::send_frame_callbacks()
             frame->destroy_wayland_object();
         }
     }
+
+    if (traffic)
+    {
+        traffic->frame_callbacks_completed(frame_callbacks.size());
+    }
     frame_callbacks.clear();
 }
 
@@ -290,6 +362,11 @@ void mf::WlSurface::damage_buffer(int32_t x, int32_t y, int32_t width, int32_t h
 void mf::WlSurface::frame(wl_resource* new_callback)
 {
     pending.frame_callbacks.push_back(std::make_shared<WlSurfaceState::Callback>(new_callback));
+
+    if (auto const traffic = ClientTraffic::from(client))
+    {
+        traffic->frame_callbacks_requested(1);
+    }
 }
 
 void mf::WlSurface::set_opaque_region(std::experimental::optional<wl_resource*> const& region)
@@ -357,7 +434,25 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
         input_shape = state.input_shape.value();
 
     if (state.scale)
+    {
         stream->set_scale(state.scale.value());
+        scale_ = state.scale.value();
+    }
+
+    if (state.viewport_source)
+        viewport_source = state.viewport_source.value();
+
+    if (state.viewport_destination)
+        viewport_destination = state.viewport_destination.value();
+
+    if ((state.acquire_fence || state.buffer_release) && !(state.buffer && *state.buffer))
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            synchronization_ ? synchronization_ : resource,
+            mw::LinuxSurfaceSynchronizationV1::Error::no_buffer,
+            "Fence or release requested for a commit of wl_surface@%d without a buffer",
+            wl_resource_get_id(resource)));
+    }
 
     if (state.buffer)
     {
@@ -367,6 +462,7 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
         {
             // TODO: unmap surface, and unmap all subsurfaces
             buffer_size_ = std::experimental::nullopt;
+            buffer_pixel_size = std::experimental::nullopt;
             send_frame_callbacks();
         }
         else
@@ -432,6 +528,9 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                     mir_buffer->id().as_value());
             }
 
+            apply_fences(state, *mir_buffer);
+            buffer_pixel_size = mir_buffer->size();
+            apply_viewport();
             stream->submit_buffer(mir_buffer);
             auto const new_buffer_size = stream->stream_size();
 
@@ -445,6 +544,18 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     }
     else
     {
+        if (buffer_size_ && (state.scale || state.viewport_source || state.viewport_destination))
+        {
+            apply_viewport();
+            auto const new_buffer_size = stream->stream_size();
+
+            if (!input_shape && std::experimental::make_optional(new_buffer_size) != buffer_size_)
+            {
+                state.invalidate_surface_data();
+            }
+
+            buffer_size_ = new_buffer_size;
+        }
         send_frame_callbacks();
     }
 
@@ -454,6 +565,91 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     }
 }
 
+void mf::WlSurface::apply_viewport()
+{
+    if (!buffer_pixel_size)
+        return;
+
+    // Errors are raised on the wp_viewport; if that has gone its state is already pending removal
+    auto const error_source = viewport_ ? viewport_ : resource;
+
+    // The viewport source is in surface-local coordinates after the buffer scale is applied
+    double const logical_width = buffer_pixel_size.value().width.as_int() / double(scale_);
+    double const logical_height = buffer_pixel_size.value().height.as_int() / double(scale_);
+
+    graphics::TextureBounds bounds;
+    std::experimental::optional<geom::Size> size = viewport_destination;
+
+    if (viewport_source)
+    {
+        auto const& src = viewport_source.value();
+        if (src.x + src.width > logical_width || src.y + src.height > logical_height)
+        {
+            BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                error_source,
+                mw::Viewport::Error::out_of_buffer,
+                "Source rectangle %gx%g+%g+%g extends outside of the %gx%g buffer",
+                src.width, src.height, src.x, src.y, logical_width, logical_height));
+        }
+
+        bounds = {
+            float(src.x / logical_width),
+            float(src.y / logical_height),
+            float((src.x + src.width) / logical_width),
+            float((src.y + src.height) / logical_height)};
+
+        if (!size)
+        {
+            if (src.width != std::floor(src.width) || src.height != std::floor(src.height))
+            {
+                BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                    error_source,
+                    mw::Viewport::Error::bad_size,
+                    "Source size %gx%g is not integer and no destination size is set",
+                    src.width, src.height));
+            }
+            size = geom::Size{int(src.width), int(src.height)};
+        }
+    }
+
+    stream->set_viewport(bounds, size);
+}
+
+void mf::WlSurface::apply_fences(WlSurfaceState const& state, graphics::Buffer& buffer)
+{
+    if (!state.acquire_fence && !state.buffer_release)
+        return;
+
+    auto const fenced = dynamic_cast<graphics::FencedBuffer*>(buffer.native_buffer_base());
+    if (!fenced)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            synchronization_ ? synchronization_ : resource,
+            mw::LinuxSurfaceSynchronizationV1::Error::unsupported_buffer,
+            "Buffer attached to wl_surface@%d does not support explicit synchronization",
+            wl_resource_get_id(resource)));
+    }
+
+    if (state.acquire_fence)
+        fenced->set_acquire_fence(state.acquire_fence.value());
+
+    if (auto const release = state.buffer_release)
+    {
+        // The buffer calls this on the Wayland thread
+        fenced->set_release_handler([release](Fd release_fence)
+            {
+                if (*release->destroyed)
+                    return;
+
+                if (release_fence != Fd::invalid)
+                    release->send_fenced_release_event(release_fence);
+                else
+                    release->send_immediate_release_event();
+                release->destroy_wayland_object();
+            });
+    }
+}
+
 void mf::WlSurface::commit()
 {
     if (pending.offset && *pending.offset == offset_)
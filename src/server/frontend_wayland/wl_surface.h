@@ -20,9 +20,12 @@
 #define MIR_FRONTEND_WL_SURFACE_H
 
 #include "wayland_wrapper.h"
+#include "linux-explicit-synchronization-unstable-v1_wrapper.h"
 
 #include "wl_surface_role.h"
 
+#include "mir/fd.h"
+
 #include "mir/geometry/displacement.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/point.h"
@@ -37,6 +40,7 @@ class Executor;
 namespace graphics
 {
 class GraphicBufferAllocator;
+class Buffer;
 }
 namespace scene
 {
@@ -68,6 +72,13 @@ struct WlSurfaceState
         std::shared_ptr<bool> destroyed;
     };
 
+    class BufferRelease : public wayland::LinuxBufferReleaseV1
+    {
+    public:
+        BufferRelease(wl_resource* new_resource);
+        std::shared_ptr<bool> destroyed;
+    };
+
     // if you add variables, don't forget to update this
     void update_from(WlSurfaceState const& source);
 
@@ -85,6 +96,19 @@ struct WlSurfaceState
     std::experimental::optional<std::experimental::optional<std::vector<geometry::Rectangle>>> input_shape;
     std::vector<std::shared_ptr<Callback>> frame_callbacks;
 
+    /// A wp_viewport source rectangle, in surface-local (post buffer scale) coordinates
+    struct ViewportSource
+    {
+        double x, y, width, height;
+    };
+    // Same semantics as input_shape: outer nullopt means no change, inner nullopt means unset
+    std::experimental::optional<std::experimental::optional<ViewportSource>> viewport_source;
+    std::experimental::optional<std::experimental::optional<geometry::Size>> viewport_destination;
+
+    /// zwp_linux_surface_synchronization_v1 state; applies only to the buffer attached in the same commit
+    std::experimental::optional<Fd> acquire_fence;
+    std::shared_ptr<BufferRelease> buffer_release;
+
 private:
     // only set to true if invalidate_surface_data() is called
     // surface_data_needs_refresh() returns true if this is true, or if other things are changed which mandate a refresh
@@ -126,6 +150,18 @@ public:
     void set_role(WlSurfaceRole* role_);
     void clear_role();
     void set_pending_offset(std::experimental::optional<geometry::Displacement> const& offset);
+    void set_pending_viewport_source(std::experimental::optional<WlSurfaceState::ViewportSource> const& source);
+    void set_pending_viewport_destination(std::experimental::optional<geometry::Size> const& size);
+    /// The wp_viewport associated with this surface, or nullptr if there isn't one
+    wl_resource* viewport() const { return viewport_; }
+    void set_viewport(wl_resource* viewport) { viewport_ = viewport; }
+    void set_pending_acquire_fence(std::experimental::optional<Fd> const& fence);
+    void set_pending_buffer_release(std::shared_ptr<WlSurfaceState::BufferRelease> const& release);
+    bool has_pending_acquire_fence() const { return static_cast<bool>(pending.acquire_fence); }
+    bool has_pending_buffer_release() const { return static_cast<bool>(pending.buffer_release); }
+    /// The zwp_linux_surface_synchronization_v1 associated with this surface, or nullptr if there isn't one
+    wl_resource* synchronization() const { return synchronization_; }
+    void set_synchronization(wl_resource* synchronization) { synchronization_ = synchronization; }
     void add_subsurface(WlSubsurface* child);
     void remove_subsurface(WlSubsurface* child);
     void refresh_surface_data_now();
@@ -153,11 +189,19 @@ private:
     WlSurfaceState pending;
     geometry::Displacement offset_;
     std::experimental::optional<geometry::Size> buffer_size_;
+    std::experimental::optional<geometry::Size> buffer_pixel_size;
+    int scale_{1};
+    wl_resource* viewport_{nullptr};
+    std::experimental::optional<WlSurfaceState::ViewportSource> viewport_source;
+    std::experimental::optional<geometry::Size> viewport_destination;
+    wl_resource* synchronization_{nullptr};
     std::vector<std::shared_ptr<WlSurfaceState::Callback>> frame_callbacks;
     std::experimental::optional<std::vector<mir::geometry::Rectangle>> input_shape;
     std::map<void const*, std::function<void()>> destroy_listeners;
 
     void send_frame_callbacks();
+    void apply_viewport();
+    void apply_fences(WlSurfaceState const& state, graphics::Buffer& buffer);
 
     void destroy() override;
     void attach(std::experimental::optional<wl_resource*> const& buffer, int32_t x, int32_t y) override;
@@ -85,8 +85,8 @@ public:
 
     void destroy() override;
     void set_parent(std::experimental::optional<struct wl_resource*> const& parent) override;
-    void set_title(std::string const& title) override;
-    void set_app_id(std::string const& app_id) override;
+    void set_title(std::string_view title) override;
+    void set_app_id(std::string_view app_id) override;
     void show_window_menu(struct wl_resource* seat, uint32_t serial, int32_t x, int32_t y) override;
     void move(struct wl_resource* seat, uint32_t serial) override;
     void resize(struct wl_resource* seat, uint32_t serial, uint32_t edges) override;
@@ -432,14 +432,14 @@ void mf::XdgToplevelStable::set_parent(std::experimental::optional<struct wl_res
     }
 }
 
-void mf::XdgToplevelStable::set_title(std::string const& title)
+void mf::XdgToplevelStable::set_title(std::string_view title)
 {
-    WindowWlSurfaceRole::set_title(title);
+    WindowWlSurfaceRole::set_title(std::string{title});
 }
 
-void mf::XdgToplevelStable::set_app_id(std::string const& app_id)
+void mf::XdgToplevelStable::set_app_id(std::string_view app_id)
 {
-    WindowWlSurfaceRole::set_application_id(app_id);
+    WindowWlSurfaceRole::set_application_id(std::string{app_id});
 }
 
 void mf::XdgToplevelStable::show_window_menu(struct wl_resource* seat, uint32_t serial, int32_t x, int32_t y)
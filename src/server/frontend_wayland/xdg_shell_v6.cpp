@@ -104,8 +104,8 @@ public:
 
     void destroy() override;
     void set_parent(std::experimental::optional<struct wl_resource*> const& parent) override;
-    void set_title(std::string const& title) override;
-    void set_app_id(std::string const& app_id) override;
+    void set_title(std::string_view title) override;
+    void set_app_id(std::string_view app_id) override;
     void show_window_menu(struct wl_resource* seat, uint32_t serial, int32_t x, int32_t y) override;
     void move(struct wl_resource* seat, uint32_t serial) override;
     void resize(struct wl_resource* seat, uint32_t serial, uint32_t edges) override;
@@ -387,14 +387,14 @@ void mf::XdgToplevelV6::set_parent(std::experimental::optional<struct wl_resourc
     }
 }
 
-void mf::XdgToplevelV6::set_title(std::string const& title)
+void mf::XdgToplevelV6::set_title(std::string_view title)
 {
-    WindowWlSurfaceRole::set_title(title);
+    WindowWlSurfaceRole::set_title(std::string{title});
 }
 
-void mf::XdgToplevelV6::set_app_id(std::string const& app_id)
+void mf::XdgToplevelV6::set_app_id(std::string_view app_id)
 {
-    WindowWlSurfaceRole::set_application_id(app_id);
+    WindowWlSurfaceRole::set_application_id(std::string{app_id});
 }
 
 void mf::XdgToplevelV6::show_window_menu(struct wl_resource* seat, uint32_t serial, int32_t x, int32_t y)
@@ -23,6 +23,7 @@
 #include "mir/c_memory.h"
 
 #include "boost/throw_exception.hpp"
+#include <xcb/xcbext.h>
 #include <sstream>
 
 namespace mf = mir::frontend;
@@ -174,32 +175,10 @@ auto vector_handler(
 }
 
 mf::XCBConnection::Atom::Atom(std::string const& name, XCBConnection* connection)
-    : connection{connection},
-      name_{name},
+    : name_{name},
       cookie{xcb_intern_atom(*connection, 0, name_.size(), name_.c_str())}
 {
-}
-
-mf::XCBConnection::Atom::operator xcb_atom_t() const
-{
-    if (atom == XCB_ATOM_NONE)
-    {
-        std::lock_guard<std::mutex> lock{mutex};
-
-        // The initial atomic check is faster, but we need to check again once we've got the lock
-        if (atom == XCB_ATOM_NONE)
-        {
-            auto const reply = make_unique_cptr(xcb_intern_atom_reply(*connection, cookie, nullptr));
-            if (!reply)
-                BOOST_THROW_EXCEPTION(std::runtime_error("Failed to look up atom " + name_));
-            atom = reply->atom;
-
-            std::lock_guard<std::mutex> lock{connection->atom_name_cache_mutex};
-            connection->atom_name_cache[atom] = name_;
-        }
-    }
-
-    return atom;
+    connection->atoms.push_back(this);
 }
 
 mf::XCBConnection::XCBConnection(Fd const& fd)
@@ -208,6 +187,18 @@ mf::XCBConnection::XCBConnection(Fd const& fd)
       xcb_screen{xcb_setup_roots_iterator(xcb_get_setup(xcb_connection)).data},
       atom_name_cache{{XCB_ATOM_NONE, "None/Any"}}
 {
+    // All the intern requests were sent as the atoms were constructed, so this waits for a single round trip
+    for (auto const atom : atoms)
+    {
+        auto const reply = make_unique_cptr(xcb_intern_atom_reply(xcb_connection, atom->cookie, nullptr));
+        if (!reply)
+        {
+            xcb_disconnect(xcb_connection);
+            BOOST_THROW_EXCEPTION(std::runtime_error("Failed to look up atom " + atom->name_));
+        }
+        atom->atom = reply->atom;
+        atom_name_cache[reply->atom] = atom->name_;
+    }
 }
 
 mf::XCBConnection::~XCBConnection()
@@ -225,35 +216,36 @@ void mf::XCBConnection::verify_not_in_error_state() const
 
 auto mf::XCBConnection::query_name(xcb_atom_t atom) const -> std::string
 {
-    std::lock_guard<std::mutex>{atom_name_cache_mutex};
-    auto const iter = atom_name_cache.find(atom);
-
-    if (iter == atom_name_cache.end())
     {
-        xcb_get_atom_name_cookie_t const cookie = xcb_get_atom_name(xcb_connection, atom);
-        auto const reply = make_unique_cptr(xcb_get_atom_name_reply(xcb_connection, cookie, nullptr));
-
-        std::string name;
-
-        if (reply)
+        std::lock_guard<std::mutex> lock{atom_name_cache_mutex};
+        auto const iter = atom_name_cache.find(atom);
+        if (iter != atom_name_cache.end())
         {
-            name = std::string{
-                xcb_get_atom_name_name(reply.get()),
-                static_cast<size_t>(xcb_get_atom_name_name_length(reply.get()))};
-        }
-        else
-        {
-            name = "Atom " + std::to_string(atom);
+            return iter->second;
         }
+    }
 
-        atom_name_cache[atom] = name;
+    // Don't hold the lock while waiting on the server
+    xcb_get_atom_name_cookie_t const cookie = xcb_get_atom_name(xcb_connection, atom);
+    auto const reply = make_unique_cptr(xcb_get_atom_name_reply(xcb_connection, cookie, nullptr));
 
-        return name;
+    std::string name;
+
+    if (reply)
+    {
+        name = std::string{
+            xcb_get_atom_name_name(reply.get()),
+            static_cast<size_t>(xcb_get_atom_name_name_length(reply.get()))};
     }
     else
     {
-        return iter->second;
+        name = "Atom " + std::to_string(atom);
     }
+
+    std::lock_guard<std::mutex> lock{atom_name_cache_mutex};
+    atom_name_cache[atom] = name;
+
+    return name;
 }
 
 auto mf::XCBConnection::reply_contains_string_data(xcb_get_property_reply_t const* reply) const -> bool
@@ -285,12 +277,9 @@ bool mf::XCBConnection::is_ours(uint32_t id) const
     return (id & ~setup->resource_id_mask) == setup->resource_id_base;
 }
 
-auto mf::XCBConnection::read_property(
-    xcb_window_t window,
-    xcb_atom_t prop,
-    Handler<xcb_get_property_reply_t*>&& handler) const -> std::function<void()>
+auto mf::XCBConnection::get_property(xcb_window_t window, xcb_atom_t prop) const -> xcb_get_property_cookie_t
 {
-    xcb_get_property_cookie_t cookie = xcb_get_property(
+    return xcb_get_property(
         xcb_connection,
         0, // don't delete
         window,
@@ -298,53 +287,131 @@ auto mf::XCBConnection::read_property(
         XCB_ATOM_ANY,
         0, // no offset
         2048); // big buffer
+}
 
-    return [this, cookie, handler=std::move(handler), window, prop]()
+void mf::XCBConnection::complete_property_read(
+    xcb_window_t window,
+    xcb_atom_t prop,
+    Handler<xcb_get_property_reply_t*> const& handler,
+    xcb_get_property_reply_t* reply,
+    xcb_generic_error_t* error) const
+{
+    try
+    {
+        if (reply && reply->type != XCB_ATOM_NONE)
         {
-            try
+            handler.on_success(reply);
+        }
+        else if (reply)
+        {
+            std::string message = "no reply data";
+            if (verbose_xwayland_logging_enabled())
             {
-                Error error;
-                auto const reply = make_unique_cptr(xcb_get_property_reply(xcb_connection, cookie, &error.ptr));
-                if (reply && reply->type != XCB_ATOM_NONE)
-                {
-                    handler.on_success(reply.get());
-                }
-                else if (reply)
-                {
-                    std::string message = "no reply data";
-                    if (verbose_xwayland_logging_enabled())
-                    {
-                        message +=  " for " + window_debug_string(window) + "." + query_name(prop);
-                    }
-                    handler.on_error("no reply data" + message);
-                }
-                else
-                {
-                    std::string message = "error reading property: ";
-                    if (verbose_xwayland_logging_enabled())
-                    {
-                        message = "error reading " + window_debug_string(window) + "." + query_name(prop) + ": ";
-                    }
-                    handler.on_error(message + error_debug_string(error.ptr));
-                }
+                message +=  " for " + window_debug_string(window) + "." + query_name(prop);
             }
-            catch (...)
+            handler.on_error("no reply data" + message);
+        }
+        else
+        {
+            std::string message = "error reading property: ";
+            if (verbose_xwayland_logging_enabled())
             {
-                log(
-                    logging::Severity::warning,
-                    MIR_LOG_COMPONENT,
-                    "Exception thrown processing reply for property " +
-                    window_debug_string(window) + "." + query_name(prop));
+                message = "error reading " + window_debug_string(window) + "." + query_name(prop) + ": ";
             }
-        };
+            handler.on_error(message + error_debug_string(error));
+        }
+    }
+    catch (...)
+    {
+        log(
+            logging::Severity::warning,
+            MIR_LOG_COMPONENT,
+            "Exception thrown processing reply for property " +
+            window_debug_string(window) + "." + query_name(prop));
+    }
+}
+
+void mf::XCBConnection::read_property_async(
+    xcb_window_t window,
+    xcb_atom_t prop,
+    Handler<xcb_get_property_reply_t*>&& handler) const
+{
+    queue_reply(
+        get_property(window, prop).sequence,
+        [this, handler=std::move(handler), window, prop](void* reply, xcb_generic_error_t* error)
+        {
+            complete_property_read(window, prop, handler, static_cast<xcb_get_property_reply_t*>(reply), error);
+        });
+}
+
+void mf::XCBConnection::queue_reply(
+    unsigned int sequence,
+    std::function<void(void* reply, xcb_generic_error_t* error)>&& complete) const
+{
+    std::lock_guard<std::mutex> lock{pending_replies_mutex};
+    pending_replies.push_back({sequence, std::move(complete)});
+}
+
+void mf::XCBConnection::dispatch_replies() const
+{
+    dispatch_replies_up_to(std::experimental::nullopt);
+}
+
+void mf::XCBConnection::dispatch_replies_preceding(xcb_generic_event_t const* event) const
+{
+    dispatch_replies_up_to(event->full_sequence);
+}
+
+void mf::XCBConnection::dispatch_replies_up_to(std::experimental::optional<uint32_t> last_sequence) const
+{
+    std::unique_lock<std::mutex> lock{pending_replies_mutex};
+
+    while (!pending_replies.empty())
+    {
+        auto const sequence = pending_replies.front().sequence;
+
+        // Sequence numbers wrap, so compare the difference rather than the values
+        if (last_sequence && static_cast<int32_t>(sequence - last_sequence.value()) > 0)
+        {
+            return;
+        }
+
+        void* reply{nullptr};
+        Error error;
+        if (!xcb_poll_for_reply(xcb_connection, sequence, &reply, &error.ptr))
+        {
+            // Replies arrive in request order, so none of the later ones are here yet either
+            return;
+        }
+
+        auto const complete = std::move(pending_replies.front().complete);
+        pending_replies.pop_front();
+
+        // Handlers are allowed to queue more requests
+        lock.unlock();
+        try
+        {
+            complete(reply, error.ptr);
+        }
+        catch (...)
+        {
+            log(
+                logging::Severity::warning,
+                MIR_LOG_COMPONENT,
+                std::current_exception(),
+                "Exception thrown processing XCB reply");
+        }
+        free(reply);
+        lock.lock();
+    }
 }
 
-auto mf::XCBConnection::read_property(
+void mf::XCBConnection::read_property_async(
     xcb_window_t window,
     xcb_atom_t prop,
-    Handler<std::string> handler) const -> std::function<void()>
+    Handler<std::string> handler) const
 {
-    return read_property(
+    read_property_async(
         window,
         prop,
         {
@@ -356,36 +423,36 @@ auto mf::XCBConnection::read_property(
         });
 }
 
-auto mf::XCBConnection::read_property(
+void mf::XCBConnection::read_property_async(
     xcb_window_t window,
     xcb_atom_t prop,
-    Handler<uint32_t> handler) const -> std::function<void()>
+    Handler<uint32_t> handler) const
 {
-    return read_property(window, prop, value_handler(this, prop, handler));
+    read_property_async(window, prop, value_handler(this, prop, handler));
 }
 
-auto mf::XCBConnection::read_property(
+void mf::XCBConnection::read_property_async(
     xcb_window_t window,
     xcb_atom_t prop,
-    Handler<int32_t> handler) const -> std::function<void()>
+    Handler<int32_t> handler) const
 {
-    return read_property(window, prop, value_handler(this, prop, handler));
+    read_property_async(window, prop, value_handler(this, prop, handler));
 }
 
-auto mf::XCBConnection::read_property(
+void mf::XCBConnection::read_property_async(
     xcb_window_t window,
     xcb_atom_t prop,
-    Handler<std::vector<uint32_t>> handler) const -> std::function<void()>
+    Handler<std::vector<uint32_t>> handler) const
 {
-    return read_property(window, prop, vector_handler(this, prop, handler));
+    read_property_async(window, prop, vector_handler(this, prop, handler));
 }
 
-auto mf::XCBConnection::read_property(
+void mf::XCBConnection::read_property_async(
     xcb_window_t window,
     xcb_atom_t prop,
-    Handler<std::vector<int32_t>> handler) const -> std::function<void()>
+    Handler<std::vector<int32_t>> handler) const
 {
-    return read_property(window, prop, vector_handler(this, prop, handler));
+    read_property_async(window, prop, vector_handler(this, prop, handler));
 }
 
 void mf::XCBConnection::configure_window(
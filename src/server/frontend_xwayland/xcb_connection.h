@@ -29,9 +29,9 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <deque>
 #include <functional>
 #include <mutex>
-#include <atomic>
 #include <experimental/optional>
 
 namespace mir
@@ -61,6 +61,9 @@ template<> struct NativeXCBType<XCBType::WM_PROTOCOLS>  { typedef uint32_t type;
 
 class XCBConnection
 {
+public:
+    class Atom;
+
 private:
     Fd const fd;
     xcb_connection_t* const xcb_connection;
@@ -69,26 +72,40 @@ private:
     std::mutex mutable atom_name_cache_mutex;
     std::unordered_map<xcb_atom_t, std::string> mutable atom_name_cache;
 
+    /// Every Atom member adds itself here, so the constructor can intern them all with a single round trip
+    std::vector<Atom*> atoms;
+
+    struct PendingReply
+    {
+        unsigned int sequence;
+        /// Called with the reply, or with null and the error (which may also be null if the connection is broken)
+        std::function<void(void* reply, xcb_generic_error_t* error)> complete;
+    };
+
+    std::mutex mutable pending_replies_mutex;
+    /// In the order the requests were sent, which is the order the replies arrive in
+    std::deque<PendingReply> mutable pending_replies;
+
 public:
     class Atom
     {
     public:
         /// Context should outlive the atom
+        /// The intern request is sent immediately, and the reply is collected by the XCBConnection constructor
         Atom(std::string const& name, XCBConnection* connection);
-        operator xcb_atom_t() const;
+        operator xcb_atom_t() const { return atom; }
 
     private:
+        friend class XCBConnection;
+
         Atom(Atom&) = delete;
         Atom& operator=(Atom&) = delete;
 
-        XCBConnection* const connection;
         std::string const name_;
         xcb_intern_atom_cookie_t const cookie;
-        std::mutex mutable mutex;
 
-        /// Accessed locklessly, but only set under lock
-        /// Once set to a value other than XCB_ATOM_NONE, not changed again
-        std::atomic<xcb_atom_t> mutable atom{XCB_ATOM_NONE};
+        /// Set before the XCBConnection constructor returns, and not changed after that
+        xcb_atom_t atom{XCB_ATOM_NONE};
     };
 
     struct Error
@@ -150,40 +167,68 @@ public:
     /// If the window was created by us
     auto is_ours(xcb_window_t window) const -> bool;
 
-    /// Read a single property of various types from the window
-    /// Returns a function that will wait on the reply before calling action()
+    /// Read a single property of various types from the window without ever waiting on the reply
+    /// The handler is called by dispatch_replies() once the reply has arrived
     /// @{
-    auto read_property(
+    void read_property_async(
         xcb_window_t window,
         xcb_atom_t prop,
-        Handler<xcb_get_property_reply_t*>&& handler) const -> std::function<void()>;
+        Handler<xcb_get_property_reply_t*>&& handler) const;
 
-    auto read_property(
+    void read_property_async(
         xcb_window_t window,
         xcb_atom_t prop,
-        Handler<std::string> handler) const -> std::function<void()>;
+        Handler<std::string> handler) const;
 
-    auto read_property(
+    void read_property_async(
         xcb_window_t window,
         xcb_atom_t prop,
-        Handler<uint32_t> handler) const -> std::function<void()>;
+        Handler<uint32_t> handler) const;
 
-    auto read_property(
+    void read_property_async(
         xcb_window_t window,
         xcb_atom_t prop,
-        Handler<int32_t> handler) const -> std::function<void()>;
+        Handler<int32_t> handler) const;
 
-    auto read_property(
+    void read_property_async(
         xcb_window_t window,
         xcb_atom_t prop,
-        Handler<std::vector<uint32_t>> handler) const -> std::function<void()>;
+        Handler<std::vector<uint32_t>> handler) const;
 
-    auto read_property(
+    void read_property_async(
         xcb_window_t window,
         xcb_atom_t prop,
-        Handler<std::vector<int32_t>> handler) const -> std::function<void()>;
+        Handler<std::vector<int32_t>> handler) const;
     /// @}
 
+    /// Have dispatch_replies() call the handler once the reply to the request has arrived, instead of blocking on it
+    /// The reply is freed once the handler returns
+    template<typename Reply, typename Cookie>
+    void on_reply(Cookie cookie, Handler<Reply*>&& handler) const
+    {
+        queue_reply(
+            cookie.sequence,
+            [this, handler = std::move(handler)](void* reply, xcb_generic_error_t* error)
+            {
+                if (reply)
+                {
+                    handler.on_success(static_cast<Reply*>(reply));
+                }
+                else
+                {
+                    handler.on_error(error_debug_string(error));
+                }
+            });
+    }
+
+    /// Calls the handlers of queued requests whose replies have arrived, in the order the requests were sent
+    /// Never blocks. Handlers may send further requests, but must not wait on their replies.
+    void dispatch_replies() const;
+
+    /// As dispatch_replies(), but leaves the replies to any requests sent after the server generated the event
+    /// Dispatching these before each event keeps replies and events in the order the server sent them.
+    void dispatch_replies_preceding(xcb_generic_event_t const* event) const;
+
     /// Set X11 window properties
     /// Safer and more fun than the C-style function provided by XCB
     /// @{
@@ -306,6 +351,17 @@ private:
 
     auto xcb_type_atom(XCBType type) const -> xcb_atom_t;
 
+    auto get_property(xcb_window_t window, xcb_atom_t prop) const -> xcb_get_property_cookie_t;
+    void complete_property_read(
+        xcb_window_t window,
+        xcb_atom_t prop,
+        Handler<xcb_get_property_reply_t*> const& handler,
+        xcb_get_property_reply_t* reply,
+        xcb_generic_error_t* error) const;
+
+    void queue_reply(unsigned int sequence, std::function<void(void* reply, xcb_generic_error_t* error)>&& complete) const;
+    void dispatch_replies_up_to(std::experimental::optional<uint32_t> last_sequence) const;
+
     template<XCBType type>
     static inline constexpr uint8_t xcb_type_format()
     {
@@ -45,14 +45,34 @@ std::initializer_list<std::string> const default_cursor_names{
 }
 
 mf::XWaylandCursors::XWaylandCursors(std::shared_ptr<XCBConnection> const& connection)
-    : loader{connection},
-      default_cursor{loader.load_default()}
+    : connection{connection}
 {
+    // The cursor can only be loaded once the server's formats are known, which dispatch_replies() tells us
+    connection->on_reply<xcb_render_query_pict_formats_reply_t>(
+        xcb_render_query_pict_formats(*connection),
+        {
+            [this](xcb_render_query_pict_formats_reply_t* const& reply)
+            {
+                Loader const loader{this->connection, Loader::formats_from(reply)};
+                default_cursor_loaded(loader.load_default());
+            },
+            [this](std::string const& message)
+            {
+                log_warning("Could not get color formats from the X server: %s", message.c_str());
+                default_cursor_loaded(nullptr);
+            }
+        });
 }
 
-void mf::XWaylandCursors::apply_default_to(xcb_window_t window) const
+void mf::XWaylandCursors::apply_default_to(xcb_window_t window)
 {
-    if (default_cursor)
+    std::lock_guard<std::mutex> lock{mutex};
+
+    if (!loaded)
+    {
+        windows_awaiting_default.push_back(window);
+    }
+    else if (default_cursor)
     {
         default_cursor->apply_to(window);
     }
@@ -62,6 +82,22 @@ void mf::XWaylandCursors::apply_default_to(xcb_window_t window) const
     }
 }
 
+void mf::XWaylandCursors::default_cursor_loaded(std::unique_ptr<Cursor> cursor)
+{
+    std::vector<xcb_window_t> windows;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        default_cursor = std::move(cursor);
+        loaded = true;
+        windows = std::move(windows_awaiting_default);
+    }
+
+    for (auto const window : windows)
+    {
+        apply_default_to(window);
+    }
+}
+
 mf::XWaylandCursors::Cursor::Cursor(std::shared_ptr<XCBConnection> const& connection, xcb_cursor_t xcb_cursor)
     : connection{connection},
       xcb_cursor{xcb_cursor}
@@ -79,40 +115,29 @@ void mf::XWaylandCursors::Cursor::apply_to(xcb_window_t window) const
     connection->flush();
 }
 
-mf::XWaylandCursors::Loader::Loader(std::shared_ptr<XCBConnection> const& connection)
+mf::XWaylandCursors::Loader::Loader(std::shared_ptr<XCBConnection> const& connection, Formats const& formats)
     : connection{connection},
-      formats{query_formats(connection)},
+      formats{formats},
       cursor_size{get_xcursor_size()}
 {
 }
 
-auto mf::XWaylandCursors::Loader::query_formats(std::shared_ptr<XCBConnection> const& connection) -> Loader::Formats
+auto mf::XWaylandCursors::Loader::formats_from(xcb_render_query_pict_formats_reply_t const* reply) -> Loader::Formats
 {
-    auto const formats_cookie = xcb_render_query_pict_formats(*connection);
-    auto const formats_reply = xcb_render_query_pict_formats_reply(*connection, formats_cookie, 0);
     mf::XWaylandCursors::Loader::Formats result;
-    if (formats_reply)
+    auto const formats = xcb_render_query_pict_formats_formats(reply);
+    for (unsigned i = 0; i < reply->num_formats; i++)
     {
-        auto const formats = xcb_render_query_pict_formats_formats(formats_reply);
-        for (unsigned i = 0; i < formats_reply->num_formats; i++)
+        if (formats[i].direct.red_mask != 0xff && formats[i].direct.red_shift != 16)
         {
-            if (formats[i].direct.red_mask != 0xff && formats[i].direct.red_shift != 16)
-            {
-                continue;
-            }
-
-            if (formats[i].type == XCB_RENDER_PICT_TYPE_DIRECT && formats[i].depth == 32 &&
-                formats[i].direct.alpha_mask == 0xff && formats[i].direct.alpha_shift == 24)
-            {
-                result.rgba = formats[i];
-            }
+            continue;
         }
 
-        free(formats_reply);
-    }
-    else
-    {
-        log_warning("Could not get color formats from the X server");
+        if (formats[i].type == XCB_RENDER_PICT_TYPE_DIRECT && formats[i].depth == 32 &&
+            formats[i].direct.alpha_mask == 0xff && formats[i].direct.alpha_shift == 24)
+        {
+            result.rgba = formats[i];
+        }
     }
     return result;
 }
@@ -20,6 +20,7 @@
 #define MIR_FRONTEND_XWAYLAND_CURSORS_H
 
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <experimental/optional>
 #include <X11/Xcursor/Xcursor.h>
@@ -36,7 +37,9 @@ class XWaylandCursors
 {
 public:
     XWaylandCursors(std::shared_ptr<XCBConnection> const& connection);
-    void apply_default_to(xcb_window_t window) const;
+
+    /// If the default cursor is still loading, it is applied once it has loaded
+    void apply_default_to(xcb_window_t window);
 
 private:
     XWaylandCursors(XWaylandCursors const&) = delete;
@@ -62,8 +65,8 @@ private:
             std::experimental::optional<xcb_render_pictforminfo_t> rgba;
         };
 
-        Loader(std::shared_ptr<XCBConnection> const& connection);
-        static auto query_formats(std::shared_ptr<XCBConnection> const& connection) -> Loader::Formats;
+        Loader(std::shared_ptr<XCBConnection> const& connection, Formats const& formats);
+        static auto formats_from(xcb_render_query_pict_formats_reply_t const* reply) -> Loader::Formats;
         static auto get_xcursor_size() -> int;
 
         /// Can return null
@@ -76,8 +79,14 @@ private:
         int const cursor_size;
     };
 
-    Loader const loader;
-    std::unique_ptr<Cursor> const default_cursor; ///< Can be null
+    void default_cursor_loaded(std::unique_ptr<Cursor> cursor);
+
+    std::shared_ptr<XCBConnection> const connection;
+
+    std::mutex mutex;
+    bool loaded{false};
+    std::unique_ptr<Cursor> default_cursor; ///< Can be null
+    std::vector<xcb_window_t> windows_awaiting_default;
 };
 }
 }
@@ -185,13 +185,35 @@ auto property_handler(
     std::shared_ptr<mf::XCBConnection> const& connection,
     xcb_window_t window,
     xcb_atom_t property,
-    mf::XCBConnection::Handler<T>&& handler) -> std::pair<xcb_atom_t, std::function<std::function<void()>()>>
+    mf::XCBConnection::Handler<T>&& handler) -> std::pair<xcb_atom_t, mf::XWaylandSurface::PropertyRequest>
 {
     return std::make_pair(
         property,
-        [connection, window, property, handler = std::move(handler)]()
+        [connection, window, property, handler = std::move(handler)](
+            std::weak_ptr<mf::XWaylandSurface> const& self,
+            std::function<void()> const& then)
         {
-            return connection->read_property(window, property, std::move(handler));
+            connection->read_property_async(
+                window,
+                property,
+                mf::XCBConnection::Handler<T>{
+                    [self, then, on_success = handler.on_success](T const& value)
+                    {
+                        if (auto const alive = self.lock())
+                        {
+                            on_success(value);
+                            then();
+                        }
+                    },
+                    [self, then, on_error = handler.on_error](std::string const& message)
+                    {
+                        if (auto const alive = self.lock())
+                        {
+                            on_error(message);
+                            then();
+                        }
+                    }
+                });
         });
 }
 
@@ -200,7 +222,7 @@ auto property_handler(
     std::shared_ptr<mf::XCBConnection> const& connection,
     xcb_window_t window,
     xcb_atom_t property,
-    std::function<void(T const&)> handler) -> std::pair<xcb_atom_t, std::function<std::function<void()>()>>
+    std::function<void(T const&)> handler) -> std::pair<xcb_atom_t, mf::XWaylandSurface::PropertyRequest>
 {
     return property_handler<T>(connection, window, property, mf::XCBConnection::Handler<T>{std::move(handler)});
 }
@@ -319,30 +341,43 @@ mf::XWaylandSurface::~XWaylandSurface()
 
 void mf::XWaylandSurface::map()
 {
-    WindowState state;
-    {
-        std::lock_guard<std::mutex> lock{mutex};
-        state = cached.state;
-    }
-
     // _NET_WM_STATE is not in property_handlers because we only read it on window creation
     // We, the server (not the client) are responsible for updating it after the window has been mapped
     // The client should use a client message to change state later
-    auto const cookie = connection->read_property(
+    // The window is mapped by dispatch_replies() once the state has arrived
+    connection->read_property_async(
         window,
         connection->_NET_WM_STATE,
-        {
-            [&](std::vector<xcb_atom_t> const& net_wm_states)
+        XCBConnection::Handler<std::vector<xcb_atom_t>>{
+            [self = weak_from_this()](std::vector<xcb_atom_t> const& net_wm_states)
             {
-                for (auto const& net_wm_state : net_wm_states)
+                if (auto const surface = self.lock())
                 {
-                    state.apply_change(connection, NetWmStateAction::ADD, net_wm_state);
+                    surface->complete_map(net_wm_states);
+                }
+            },
+            [self = weak_from_this()](std::string const&)
+            {
+                if (auto const surface = self.lock())
+                {
+                    surface->complete_map({});
                 }
             }
         });
+}
 
-    // If we had more properties to read we would queue them all up before completing the first one
-    cookie();
+void mf::XWaylandSurface::complete_map(std::vector<xcb_atom_t> const& net_wm_states)
+{
+    WindowState state;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        state = cached.state;
+    }
+
+    for (auto const& net_wm_state : net_wm_states)
+    {
+        state.apply_change(connection, NetWmStateAction::ADD, net_wm_state);
+    }
 
     uint32_t const workspace = 1;
     connection->set_property<XCBType::CARDINAL32>(
@@ -603,11 +638,42 @@ void mf::XWaylandSurface::property_notify(xcb_atom_t property)
     auto const handler = property_handlers.find(property);
     if (handler != property_handlers.end())
     {
-        auto completion = handler->second();
-        completion();
+        handler->second(weak_from_this(), [this]() { apply_any_mods_to_scene_surface(); });
+    }
+}
+
+void mf::XWaylandSurface::read_initial_properties(std::function<void()>&& ready)
+{
+    auto const self = weak_from_this();
 
-        apply_any_mods_to_scene_surface();
+    for (auto const& handler : property_handlers)
+    {
+        handler.second(self, []{});
     }
+
+    // Replies are dispatched in request order, so this one's handler is called after all of the above
+    connection->read_property_async(
+        window, connection->_NET_WM_PID,
+        XCBConnection::Handler<uint32_t>{
+            [self, ready](uint32_t pid)
+            {
+                if (auto const surface = self.lock())
+                {
+                    {
+                        std::lock_guard<std::mutex> lock{surface->mutex};
+                        surface->pid_client_session = surface->client_manager->session_for_client(pid);
+                    }
+                    ready();
+                }
+            },
+            [self, ready](std::string const&)
+            {
+                if (self.lock())
+                {
+                    ready();
+                }
+            }
+        });
 }
 
 void mf::XWaylandSurface::attach_wl_surface(WlSurface* wl_surface)
@@ -650,35 +716,22 @@ void mf::XWaylandSurface::attach_wl_surface(WlSurface* wl_surface)
         params.state = state.mir_window_state();
     }
 
-    std::vector<std::function<void()>> reply_functions;
-
-    // Read all properties
-    for (auto const& handler : property_handlers)
+    std::shared_ptr<XWaylandClientManager::Session> local_client_session;
     {
-        reply_functions.push_back(handler.second());
+        std::lock_guard<std::mutex> lock{mutex};
+        local_client_session = std::move(pid_client_session);
     }
 
-    std::shared_ptr<XWaylandClientManager::Session> local_client_session;
+    // read_initial_properties() has already had all the properties handled
     std::shared_ptr<ms::Session> session;
-    reply_functions.push_back(connection->read_property(
-        window, connection->_NET_WM_PID,
-        XCBConnection::Handler<uint32_t>{
-            [&](uint32_t pid)
-            {
-                local_client_session = client_manager->session_for_client(pid);
-                session = local_client_session->session();
-            },
-            [&](std::string const&)
-            {
-                log_warning("X11 app did not set _NET_WM_PID, grouping it under the default XWayland application");
-                session = get_session(wl_surface->resource);
-            }
-        }));
-
-    // Wait for and process all the XCB replies
-    for (auto const& reply_function : reply_functions)
+    if (local_client_session)
+    {
+        session = local_client_session->session();
+    }
+    else
     {
-        reply_function();
+        log_warning("X11 app did not set _NET_WM_PID, grouping it under the default XWayland application");
+        session = get_session(wl_surface->resource);
     }
 
     if (!session)
@@ -29,6 +29,8 @@
 
 #include <mutex>
 #include <chrono>
+#include <functional>
+#include <memory>
 #include <set>
 
 namespace mir
@@ -46,9 +48,14 @@ class XWaylandSurfaceObserver;
 
 class XWaylandSurface
     : public XWaylandSurfaceRoleSurface,
-      public XWaylandSurfaceObserverSurface
+      public XWaylandSurfaceObserverSurface,
+      public std::enable_shared_from_this<XWaylandSurface>
 {
 public:
+    /// Requests a property without waiting on the reply. Once dispatch_replies() has handled the reply, then() is
+    /// called. Neither happens if the surface has been destroyed by then.
+    using PropertyRequest = std::function<void(std::weak_ptr<XWaylandSurface> const& self, std::function<void()> const& then)>;
+
     XWaylandSurface(
         XWaylandWM *wm,
         std::shared_ptr<XCBConnection> const& connection,
@@ -68,7 +75,10 @@ public:
     void net_wm_state_client_message(uint32_t const (&data)[5]);
     void wm_change_state_client_message(uint32_t const (&data)[5]);
     void property_notify(xcb_atom_t property);
-    void attach_wl_surface(WlSurface* wl_surface); ///< Should only be called on the Wayland thread
+    /// Requests the properties the scene surface is created from, and calls ready() once they have all been handled
+    void read_initial_properties(std::function<void()>&& ready);
+    /// Should only be called on the Wayland thread, after read_initial_properties() is ready
+    void attach_wl_surface(WlSurface* wl_surface);
     void move_resize(uint32_t detail);
 
 private:
@@ -141,6 +151,7 @@ private:
     /// Appplies any mods in nullable_pending_spec to the scene_surface (if any)
     void apply_any_mods_to_scene_surface();
 
+    void complete_map(std::vector<xcb_atom_t> const& net_wm_states);
     void window_type(std::vector<xcb_atom_t> const& wm_types);
     void set_parent(xcb_window_t xcb_window, std::lock_guard<std::mutex> const&);
     void fix_parent_if_necessary(const std::lock_guard<std::mutex>& lock);
@@ -153,7 +164,7 @@ private:
     std::shared_ptr<shell::Shell> const shell;
     std::shared_ptr<XWaylandClientManager> const client_manager;
     xcb_window_t const window;
-    std::map<xcb_window_t, std::function<std::function<void()>()>> const property_handlers;
+    std::map<xcb_atom_t, PropertyRequest> const property_handlers;
 
     std::mutex mutable mutex;
 
@@ -179,6 +190,7 @@ private:
     /// Set in set_wl_surface and cleared when a scene surface is created from it
     std::experimental::optional<std::shared_ptr<XWaylandSurfaceObserver>> surface_observer;
     std::unique_ptr<shell::SurfaceSpecification> nullable_pending_spec;
+    std::shared_ptr<XWaylandClientManager::Session> pid_client_session; ///< From _NET_WM_PID, until attached
     std::shared_ptr<XWaylandClientManager::Session> client_session;
     std::weak_ptr<scene::Surface> weak_scene_surface;
 };
@@ -26,7 +26,6 @@
 #include "xwayland_cursors.h"
 #include "xwayland_client_manager.h"
 
-#include "mir/c_memory.h"
 #include "mir/fd.h"
 #include "mir/frontend/surface_stack.h"
 #include "mir/scene/null_observer.h"
@@ -76,9 +75,6 @@ auto create_wm_window(mf::XCBConnection const& connection) -> xcb_window_t
 
 void check_xfixes(mf::XCBConnection const& connection)
 {
-    xcb_xfixes_query_version_cookie_t xfixes_cookie;
-    xcb_xfixes_query_version_reply_t *xfixes_reply;
-
     xcb_prefetch_extension_data(connection, &xcb_xfixes_id);
     xcb_prefetch_extension_data(connection, &xcb_composite_id);
 
@@ -88,15 +84,18 @@ void check_xfixes(mf::XCBConnection const& connection)
         mir::log_warning("xfixes not available");
     }
 
-    xfixes_cookie = xcb_xfixes_query_version(connection, XCB_XFIXES_MAJOR_VERSION, XCB_XFIXES_MINOR_VERSION);
-    xfixes_reply = xcb_xfixes_query_version_reply(connection, xfixes_cookie, NULL);
-
-    if (mir::verbose_xwayland_logging_enabled())
-    {
-        mir::log_debug("xfixes version: %d.%d", xfixes_reply->major_version, xfixes_reply->minor_version);
-    }
-
-    free(xfixes_reply);
+    // The version must be queried before XFixes is used, but nothing needs to wait on the reply
+    connection.on_reply<xcb_xfixes_query_version_reply_t>(
+        xcb_xfixes_query_version(connection, XCB_XFIXES_MAJOR_VERSION, XCB_XFIXES_MINOR_VERSION),
+        {
+            [](xcb_xfixes_query_version_reply_t* const& reply)
+            {
+                if (mir::verbose_xwayland_logging_enabled())
+                {
+                    mir::log_debug("xfixes version: %d.%d", reply->major_version, reply->minor_version);
+                }
+            }
+        });
 }
 
 auto focus_mode_to_string(uint32_t focus_mode) -> std::string
@@ -170,56 +169,21 @@ mf::XWaylandWM::XWaylandWM(std::shared_ptr<WaylandConnector> wayland_connector,
     wm_shell->surface_stack->add_observer(scene_observer);
 
     // Detect and manage any windows that already exist
-    auto const query_tree_cookie = xcb_query_tree(*connection, connection->root_window());
-    auto const query_tree_reply = make_unique_cptr(xcb_query_tree_reply(*connection, query_tree_cookie, nullptr));
-    if (query_tree_reply)
-    {
-        std::vector<std::function<void()>> window_setup_funcs;
-        for (int i = 0; i < xcb_query_tree_children_length(query_tree_reply.get()); ++i)
+    // The replies are handled by handle_events() as they arrive, so this never waits on the X server
+    connection->on_reply<xcb_query_tree_reply_t>(
+        xcb_query_tree(*connection, connection->root_window()),
         {
-            xcb_window_t const window = xcb_query_tree_children(query_tree_reply.get())[i];
-            if (!connection->is_ours(window))
+            [this](xcb_query_tree_reply_t* const& reply)
             {
-                if (verbose_xwayland_logging_enabled())
-                {
-                    log_debug("Window %s already exists", connection->window_debug_string(window).c_str());
-                }
-
-                auto const geometry_cookie = xcb_get_geometry(*connection, window);
-                auto const attrs_cookie = xcb_get_window_attributes(*connection, window);
-                window_setup_funcs.push_back([this, window, geometry_cookie, attrs_cookie]()
-                    {
-                        auto const geometry_reply = make_unique_cptr(xcb_get_geometry_reply(*connection, geometry_cookie, nullptr));
-                        auto const attrs_reply = make_unique_cptr(xcb_get_window_attributes_reply(*connection, attrs_cookie, nullptr));
-
-                        if (geometry_reply && attrs_reply)
-                        {
-                            manage_window(
-                                window,
-                                geom::Rectangle{
-                                    {geometry_reply->x, geometry_reply->y},
-                                    {geometry_reply->width, geometry_reply->height}},
-                                attrs_reply->override_redirect);
-                        }
-                        else
-                        {
-                            log_warning(
-                                "Faild to load geometry and attributes for %s",
-                                connection->window_debug_string(window).c_str());
-                        }
-                    });
+                manage_existing_windows(reply);
+            },
+            [](std::string const& message)
+            {
+                log_warning("Failed to query initial windows: %s", message.c_str());
             }
-        }
+        });
 
-        for (auto const& f : window_setup_funcs)
-        {
-            f();
-        }
-    }
-    else
-    {
-        log_warning("Failed to query initial windows");
-    }
+    connection->flush();
 }
 
 mf::XWaylandWM::~XWaylandWM()
@@ -256,14 +220,13 @@ mf::XWaylandWM::~XWaylandWM()
 
 void mf::XWaylandWM::handle_events()
 {
-    bool got_events = false;
-
     connection->verify_not_in_error_state();
 
     while (xcb_generic_event_t* const event = xcb_poll_for_event(*connection))
     {
         try
         {
+            connection->dispatch_replies_preceding(event);
             handle_event(event);
         }
         catch (...)
@@ -275,13 +238,13 @@ void mf::XWaylandWM::handle_events()
                 "Error processing XCB event");
         }
         free(event);
-        got_events = true;
     }
 
-    if (got_events)
-    {
-        connection->flush();
-    }
+    // xcb_poll_for_event() has read everything the server sent, so this picks up any replies without events after them
+    connection->dispatch_replies();
+
+    // Reply handlers may have sent requests even if there were no events
+    connection->flush();
 }
 
 auto mf::XWaylandWM::get_wm_surface(
@@ -439,54 +402,78 @@ void mf::XWaylandWM::restack_surfaces()
     connection->flush();
 }
 
-void mf::XWaylandWM::manage_window(xcb_window_t window, geom::Rectangle const& geometry, bool override_redirect)
+void mf::XWaylandWM::manage_existing_windows(xcb_query_tree_reply_t* reply)
 {
-    if (verbose_xwayland_logging_enabled())
+    for (int i = 0; i < xcb_query_tree_children_length(reply); ++i)
     {
-        auto const props_cookie = xcb_list_properties(*connection, window);
-        auto const props_reply = xcb_list_properties_reply(*connection, props_cookie, nullptr);
-        if (props_reply)
+        xcb_window_t const window = xcb_query_tree_children(reply)[i];
+        if (connection->is_ours(window))
+        {
+            continue;
+        }
+
+        if (verbose_xwayland_logging_enabled())
         {
-            std::vector<std::function<void()>> functions;
-            int const prop_count = xcb_list_properties_atoms_length(props_reply);
-            for (int i = 0; i < prop_count; i++)
+            log_debug("Window %s already exists", connection->window_debug_string(window).c_str());
+        }
+
+        // Both requests for every window go out together; the attributes reply always arrives after the geometry
+        auto const geometry = std::make_shared<std::experimental::optional<geom::Rectangle>>();
+
+        connection->on_reply<xcb_get_geometry_reply_t>(
+            xcb_get_geometry(*connection, window),
             {
-                auto const atom = xcb_list_properties_atoms(props_reply)[i];
+                [geometry](xcb_get_geometry_reply_t* const& reply)
+                {
+                    *geometry = geom::Rectangle{{reply->x, reply->y}, {reply->width, reply->height}};
+                },
+                [](std::string const&) {}
+            });
 
-                auto const log_prop = [this, atom](std::string const& value)
+        connection->on_reply<xcb_get_window_attributes_reply_t>(
+            xcb_get_window_attributes(*connection, window),
+            {
+                [this, window, geometry](xcb_get_window_attributes_reply_t* const& reply)
+                {
+                    if (*geometry)
                     {
-                        auto const prop_name = connection->query_name(atom);
-                        log_debug(
-                            "  | %s: %s",
-                            prop_name.c_str(),
-                            value.c_str());
-                    };
-
-                functions.push_back(connection->read_property(
-                    window,
-                    atom,
+                        manage_window(window, geometry->value(), reply->override_redirect);
+                    }
+                    else
                     {
-                        [this, log_prop](xcb_get_property_reply_t* reply)
-                        {
-                            auto const reply_str = connection->reply_debug_string(reply);
-                            log_prop(reply_str);
-                        },
-                        [log_prop](std::string const& message)
-                        {
-                            log_prop("error getting value: " + message);
-                        }
-                    }));
-            }
-            free(props_reply);
+                        log_warning(
+                            "Failed to load geometry and attributes for %s",
+                            connection->window_debug_string(window).c_str());
+                    }
+                },
+                [this, window](std::string const&)
+                {
+                    log_warning(
+                        "Failed to load geometry and attributes for %s",
+                        connection->window_debug_string(window).c_str());
+                }
+            });
+    }
+}
 
-            log_debug("%s has %d initial propertie(s):", connection->window_debug_string(window).c_str(), prop_count);
-            for (auto const& f : functions)
-                f();
-        }
-        else
-        {
-            log_debug("%s's initial properties failed to load", connection->window_debug_string(window).c_str());
-        }
+void mf::XWaylandWM::manage_window(xcb_window_t window, geom::Rectangle const& geometry, bool override_redirect)
+{
+    if (verbose_xwayland_logging_enabled())
+    {
+        connection->on_reply<xcb_list_properties_reply_t>(
+            xcb_list_properties(*connection, window),
+            {
+                [this, window](xcb_list_properties_reply_t* const& reply)
+                {
+                    log_initial_properties(window, reply);
+                },
+                [this, window](std::string const&)
+                {
+                    log_debug(
+                        "%s's initial properties failed to load",
+                        connection->window_debug_string(window).c_str());
+                }
+            });
     }
 
     std::lock_guard<std::mutex> lock{mutex};
@@ -508,6 +495,42 @@ void mf::XWaylandWM::manage_window(xcb_window_t window, geom::Rectangle const& g
         override_redirect);
 }
 
+void mf::XWaylandWM::log_initial_properties(xcb_window_t window, xcb_list_properties_reply_t* reply)
+{
+    int const prop_count = xcb_list_properties_atoms_length(reply);
+    log_debug("%s has %d initial propertie(s):", connection->window_debug_string(window).c_str(), prop_count);
+
+    // One burst of requests for the window, each value logged as its reply arrives
+    for (int i = 0; i < prop_count; i++)
+    {
+        auto const atom = xcb_list_properties_atoms(reply)[i];
+
+        auto const log_prop = [this, atom](std::string const& value)
+            {
+                auto const prop_name = connection->query_name(atom);
+                log_debug(
+                    "  | %s: %s",
+                    prop_name.c_str(),
+                    value.c_str());
+            };
+
+        connection->read_property_async(
+            window,
+            atom,
+            {
+                [this, log_prop](xcb_get_property_reply_t* reply)
+                {
+                    auto const reply_str = connection->reply_debug_string(reply);
+                    log_prop(reply_str);
+                },
+                [log_prop](std::string const& message)
+                {
+                    log_prop("error getting value: " + message);
+                }
+            });
+    }
+}
+
 void mf::XWaylandWM::handle_event(xcb_generic_event_t* event)
 {
     // see https://www.systutorials.com/docs/linux/man/3-xcb-requests/
@@ -598,17 +621,18 @@ void mf::XWaylandWM::handle_property_notify(xcb_property_notify_event_t *event)
         }
         else
         {
-            auto const log_prop = [this, event](std::string const& value)
+            // The reply is handled after the event has been freed
+            auto const log_prop = [this, window = event->window, atom = event->atom](std::string const& value)
                 {
-                    auto const prop_name = connection->query_name(event->atom);
+                    auto const prop_name = connection->query_name(atom);
                     log_debug(
                         "XCB_PROPERTY_NOTIFY (%s).%s: %s",
-                        connection->window_debug_string(event->window).c_str(),
+                        connection->window_debug_string(window).c_str(),
                         prop_name.c_str(),
                         value.c_str());
                 };
 
-            auto const reply_function = connection->read_property(
+            connection->read_property_async(
                 event->window,
                 event->atom,
                 {
@@ -622,8 +646,6 @@ void mf::XWaylandWM::handle_property_notify(xcb_property_notify_event_t *event)
                         log_prop("error getting value: " + message);
                     }
                 });
-
-            reply_function();
         }
     }
 
@@ -774,33 +796,42 @@ void mf::XWaylandWM::handle_surface_id(
 {
     uint32_t id = event->data.data32[0];
 
-    wayland_connector->run_on_wayland_display([
+    auto const surface = weak_surface.lock();
+    if (!surface)
+        return;
+
+    // The scene surface is created from the window's properties, so have them all handled (without waiting on the
+    // X server) before attaching it
+    surface->read_initial_properties([
             wayland_connector = wayland_connector,
             client=wayland_client,
             id,
             weak_surface,
-            weak_shell = std::weak_ptr<shell::Shell>{wm_shell->shell}](auto)
+            weak_shell = std::weak_ptr<shell::Shell>{wm_shell->shell}]()
         {
-            wayland_connector->on_surface_created(client, id, [weak_surface, weak_shell](WlSurface* wl_surface)
+            wayland_connector->run_on_wayland_display([wayland_connector, client, id, weak_surface, weak_shell](auto)
                 {
-                    auto const surface = weak_surface.lock();
-                    auto const shell = weak_shell.lock();
-                    if (surface && shell)
-                    {
-                        surface->attach_wl_surface(wl_surface);
-
-                        // Will destroy itself
-                        new XWaylandSurfaceRole{shell, surface, wl_surface};
-                    }
-                    else
-                    {
-                        if (verbose_xwayland_logging_enabled())
+                    wayland_connector->on_surface_created(client, id, [weak_surface, weak_shell](WlSurface* wl_surface)
                         {
-                            log_debug(
-                                "wl_surface@%d created but surface or shell has been destroyed",
-                                wl_resource_get_id(wl_surface->resource));
-                        }
-                    }
+                            auto const surface = weak_surface.lock();
+                            auto const shell = weak_shell.lock();
+                            if (surface && shell)
+                            {
+                                surface->attach_wl_surface(wl_surface);
+
+                                // Will destroy itself
+                                new XWaylandSurfaceRole{shell, surface, wl_surface};
+                            }
+                            else
+                            {
+                                if (verbose_xwayland_logging_enabled())
+                                {
+                                    log_debug(
+                                        "wl_surface@%d created but surface or shell has been destroyed",
+                                        wl_resource_get_id(wl_surface->resource));
+                                }
+                            }
+                        });
                 });
         });
 }
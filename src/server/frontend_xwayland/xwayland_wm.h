@@ -77,10 +77,15 @@ private:
 
     void restack_surfaces();
 
+    /// Requests the geometry and attributes of windows that existed before the WM, and manages them as they arrive
+    void manage_existing_windows(xcb_query_tree_reply_t* reply);
+
     /// Called for all windows at startup and whenever a window is created
     /// May occasionally be called multiple times for the same window
     void manage_window(xcb_window_t window, geometry::Rectangle const& geometry, bool override_redirect);
 
+    void log_initial_properties(xcb_window_t window, xcb_list_properties_reply_t* reply);
+
     void handle_event(xcb_generic_event_t* event);
     void handle_create_notify(xcb_create_notify_event_t *event);
     void handle_motion_notify(xcb_motion_notify_event_t *event);
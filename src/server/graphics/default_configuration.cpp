@@ -25,6 +25,7 @@
 #include "mir/renderer/gl/egl_platform.h"
 #include "null_cursor.h"
 #include "offscreen/display.h"
+#include "offscreen/shm_buffer_allocator.h"
 #include "software_cursor.h"
 #include "platform_probe.h"
 
@@ -141,8 +142,13 @@ std::shared_ptr<mg::GraphicBufferAllocator>
 mir::DefaultServerConfiguration::the_buffer_allocator()
 {
     return buffer_allocator(
-        [&]()
+        [&]() -> std::shared_ptr<mg::GraphicBufferAllocator>
         {
+            // The platform allocators need a GL context, which an offscreen display without EGL can't give
+            auto const offscreen = std::dynamic_pointer_cast<mg::offscreen::Display>(the_display());
+            if (offscreen && !offscreen->supports_gl())
+                return std::make_shared<mg::offscreen::ShmBufferAllocator>();
+
             return the_graphics_platform()->create_buffer_allocator(*the_display());
         });
 }
@@ -155,20 +161,42 @@ mir::DefaultServerConfiguration::the_display()
         {
             if (the_options()->is_set(options::offscreen_opt))
             {
+                // The software renderer needs no EGL, so can do without it if there is none
+                bool const software_rendering =
+                    the_options()->get<std::string>(options::renderer_opt) == options::software_renderer_value;
+
                 if (auto egl_access = std::dynamic_pointer_cast<mir::renderer::gl::EGLPlatform>(
                     the_graphics_platform()))
                 {
-                    return std::make_shared<mg::offscreen::Display>(
-                        egl_access->egl_native_display(),
-                        the_display_configuration_policy(),
-                        the_display_report());
+                    try
+                    {
+                        return std::make_shared<mg::offscreen::Display>(
+                            egl_access->egl_native_display(),
+                            the_display_configuration_policy(),
+                            the_display_report());
+                    }
+                    catch (std::exception const&)
+                    {
+                        if (!software_rendering)
+                            throw;
+
+                        mir::log(
+                            ::mir::logging::Severity::warning,
+                            "graphics",
+                            std::current_exception(),
+                            "Failed to initialise EGL for the offscreen display; continuing without it");
+                    }
                 }
-                else
+                else if (!software_rendering)
                 {
                     BOOST_THROW_EXCEPTION(std::runtime_error(
                         "underlying rendering platform does not support EGL access."\
                         " Could not create offscreen display"));
                 }
+
+                return std::make_shared<mg::offscreen::Display>(
+                    the_display_configuration_policy(),
+                    the_display_report());
             }
 
             return the_graphics_platform()->create_display(
@@ -24,6 +24,7 @@
 #include "mir/geometry/size.h"
 
 #include <boost/throw_exception.hpp>
+#include <algorithm>
 #include <stdexcept>
 
 namespace mg = mir::graphics;
@@ -107,15 +108,35 @@ mgo::Display::Display(
     EGLNativeDisplayType egl_native_display,
     std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
     std::shared_ptr<DisplayReport> const&)
-    : egl_display{create_and_initialize_display(egl_native_display)},
-      egl_context_shared{egl_display, EGL_NO_CONTEXT},
+    : Display{
+        std::make_unique<detail::EGLDisplayHandle>(create_and_initialize_display(egl_native_display)),
+        initial_conf_policy}
+{
+}
+
+mgo::Display::Display(
+    std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
+    std::shared_ptr<DisplayReport> const&)
+    : Display{nullptr, initial_conf_policy}
+{
+}
+
+mgo::Display::Display(
+    std::unique_ptr<detail::EGLDisplayHandle> egl_display,
+    std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy)
+    : egl_display{std::move(egl_display)},
+      egl_context_shared{
+          this->egl_display ?
+              std::make_unique<SurfacelessEGLContext const>(*this->egl_display, EGL_NO_CONTEXT) :
+              nullptr},
       current_display_configuration{geom::Size{1024,768}}
 {
     /*
      * Make the shared context current. This needs to be done before we configure()
      * since mgo::DisplayBuffer creation needs a current GL context.
      */
-    egl_context_shared.make_current();
+    if (egl_context_shared)
+        egl_context_shared->make_current();
 
     initial_conf_policy->apply_to(current_display_configuration);
 
@@ -131,8 +152,8 @@ void mgo::Display::for_each_display_sync_group(
 {
     std::lock_guard<std::mutex> lock{configuration_mutex};
 
-    for (auto& dg_ptr : display_sync_groups)
-        f(*dg_ptr);
+    for (auto& output_group : display_sync_groups)
+        f(*output_group.group);
 }
 
 std::unique_ptr<mg::DisplayConfiguration> mgo::Display::configuration() const
@@ -157,17 +178,105 @@ void mgo::Display::configure(mg::DisplayConfiguration const& conf)
     conf.for_each_output(
         [this] (DisplayConfigurationOutput const& output)
         {
-            if (output.connected && output.preferred_mode_index < output.modes.size())
+            if (displayed(output))
+            {
+                display_sync_groups.push_back({output.id, output.extents(), create_group_for(output)});
+            }
+        });
+}
+
+void mgo::Display::configure_incrementally(
+    mg::DisplayConfiguration const& conf,
+    std::function<void(mg::DisplaySyncGroup&)> const& invalidating)
+{
+    if (!conf.valid())
+    {
+        BOOST_THROW_EXCEPTION(
+            std::logic_error("Invalid or inconsistent display configuration"));
+    }
+
+    std::unique_lock<std::mutex> lock{configuration_mutex};
+
+    decltype(display_sync_groups) new_groups;
+
+    conf.for_each_output(
+        [&] (DisplayConfigurationOutput const& output)
+        {
+            if (!displayed(output))
+                return;
+
+            auto const unchanged = std::find_if(
+                display_sync_groups.begin(), display_sync_groups.end(),
+                [&](OutputGroup const& output_group)
+                {
+                    return output_group.group &&
+                        output_group.output_id == output.id &&
+                        output_group.extents == output.extents();
+                });
+
+            if (unchanged != display_sync_groups.end())
+            {
+                new_groups.push_back(std::move(*unchanged));
+            }
+            else
             {
-                eglBindAPI(EGL_OPENGL_ES_API);
-                auto raw_db = new mgo::DisplayBuffer{
-                    SurfacelessEGLContext{egl_display, egl_context_shared},
-                    output.extents()};
+                new_groups.push_back({output.id, output.extents(), nullptr});
+            }
+        });
+
+    /*
+     * Stopping compositing to a group waits for its compositor thread, which may
+     * itself be waiting for configuration_mutex in for_each_display_sync_group().
+     * Configuration changes come from a single thread, so the groups being replaced
+     * stay ours while the lock is released.
+     */
+    std::vector<std::unique_ptr<detail::DisplaySyncGroup>> replaced;
+    for (auto& output_group : display_sync_groups)
+    {
+        if (output_group.group)
+            replaced.push_back(std::move(output_group.group));
+    }
+    display_sync_groups.clear();
+
+    lock.unlock();
+    for (auto const& group : replaced)
+        invalidating(*group);
+    replaced.clear();
+    lock.lock();
 
-                display_sync_groups.emplace_back(
-                    new mgo::detail::DisplaySyncGroup(std::unique_ptr<mg::DisplayBuffer>(raw_db)));
+    conf.for_each_output(
+        [&] (DisplayConfigurationOutput const& output)
+        {
+            for (auto& output_group : new_groups)
+            {
+                if (output_group.output_id == output.id && !output_group.group)
+                    output_group.group = create_group_for(output);
             }
         });
+
+    display_sync_groups = std::move(new_groups);
+}
+
+bool mgo::Display::displayed(DisplayConfigurationOutput const& output)
+{
+    return output.connected && output.preferred_mode_index < output.modes.size();
+}
+
+auto mgo::Display::create_group_for(DisplayConfigurationOutput const& output) const
+    -> std::unique_ptr<detail::DisplaySyncGroup>
+{
+    if (!egl_display)
+    {
+        return std::make_unique<mgo::detail::DisplaySyncGroup>(
+            std::make_unique<mgo::DisplayBuffer>(output.extents()));
+    }
+
+    eglBindAPI(EGL_OPENGL_ES_API);
+    auto raw_db = new mgo::DisplayBuffer{
+        SurfacelessEGLContext{*egl_display, *egl_context_shared},
+        output.extents()};
+
+    return std::make_unique<mgo::detail::DisplaySyncGroup>(std::unique_ptr<mg::DisplayBuffer>(raw_db));
 }
 
 void mgo::Display::register_configuration_change_handler(
@@ -198,8 +307,16 @@ std::shared_ptr<mg::Cursor> mgo::Display::create_hardware_cursor()
 
 std::unique_ptr<mir::renderer::gl::Context> mgo::Display::create_gl_context() const
 {
+    if (!egl_display)
+        BOOST_THROW_EXCEPTION(std::logic_error("Offscreen display was created without EGL, so has no GL contexts"));
+
     eglBindAPI(EGL_OPENGL_ES_API);
-    return std::make_unique<SurfacelessEGLContext>(egl_display, egl_context_shared);
+    return std::make_unique<SurfacelessEGLContext>(*egl_display, *egl_context_shared);
+}
+
+bool mgo::Display::supports_gl() const
+{
+    return egl_display != nullptr;
 }
 
 mg::Frame mgo::Display::last_frame_on(unsigned) const
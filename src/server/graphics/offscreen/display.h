@@ -20,6 +20,7 @@
 #define MIR_GRAPHICS_OFFSCREEN_DISPLAY_H_
 
 #include "mir/graphics/display.h"
+#include "mir/graphics/incrementally_configurable_display.h"
 #include "display_configuration.h"
 #include "mir/graphics/surfaceless_egl_context.h"
 #include "mir/renderer/gl/context_source.h"
@@ -72,18 +73,24 @@ private:
 
 }
 
-class Display : public graphics::Display
+class Display : public graphics::Display, public IncrementallyConfigurableDisplay
 {
 public:
     Display(EGLNativeDisplayType egl_native_display,
             std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
             std::shared_ptr<DisplayReport> const& listener);
+    /// A display that needs no EGL, but can only be composited by the software renderer
+    Display(std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
+            std::shared_ptr<DisplayReport> const& listener);
     ~Display() noexcept;
 
     void for_each_display_sync_group(std::function<void(DisplaySyncGroup&)> const& f) override;
 
     std::unique_ptr<graphics::DisplayConfiguration> configuration() const override;
     void configure(graphics::DisplayConfiguration const& conf) override;
+    void configure_incrementally(
+        graphics::DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& invalidating) override;
 
     void register_configuration_change_handler(
         EventHandlerRegister& handlers,
@@ -103,13 +110,30 @@ public:
     Frame last_frame_on(unsigned output_id) const override;
 
     std::unique_ptr<renderer::gl::Context> create_gl_context() const override;
+    /// Whether create_gl_context() can succeed (it can't if the display was created without EGL)
+    bool supports_gl() const;
     bool apply_if_configuration_preserves_display_buffers(graphics::DisplayConfiguration const& conf) override;
 private:
-    detail::EGLDisplayHandle const egl_display;
-    SurfacelessEGLContext const egl_context_shared;
+    /// The group displaying an output, as it was when the group was created
+    struct OutputGroup
+    {
+        DisplayConfigurationOutputId output_id;
+        geometry::Rectangle extents;
+        std::unique_ptr<detail::DisplaySyncGroup> group;
+    };
+
+    Display(std::unique_ptr<detail::EGLDisplayHandle> egl_display,
+            std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy);
+
+    auto create_group_for(DisplayConfigurationOutput const& output) const -> std::unique_ptr<detail::DisplaySyncGroup>;
+    static bool displayed(DisplayConfigurationOutput const& output);
+
+    /// Both are null if the display is only used for software rendering
+    std::unique_ptr<detail::EGLDisplayHandle const> const egl_display;
+    std::unique_ptr<SurfacelessEGLContext const> const egl_context_shared;
     mutable std::mutex configuration_mutex;
     DisplayConfiguration current_display_configuration;
-    std::vector<std::unique_ptr<DisplaySyncGroup>> display_sync_groups;
+    std::vector<OutputGroup> display_sync_groups;
 };
 
 }
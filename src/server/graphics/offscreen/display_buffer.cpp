@@ -17,10 +17,12 @@
  */
 
 #include "display_buffer.h"
+#include "mir/graphics/buffer.h"
 #include "mir/graphics/gl_extensions_base.h"
 #include "mir/raii.h"
 
 #include <boost/throw_exception.hpp>
+#include <algorithm>
 #include <stdexcept>
 
 #include <GLES2/gl2.h>
@@ -28,6 +30,7 @@
 
 namespace mg = mir::graphics;
 namespace mgo = mg::offscreen;
+namespace mrs = mir::renderer::software;
 namespace geom = mir::geometry;
 
 namespace
@@ -43,6 +46,45 @@ public:
     }
 };
 
+class PixelMapping : public mrs::Mapping<unsigned char>
+{
+public:
+    PixelMapping(std::vector<unsigned char>& pixels, geom::Size const& size)
+        : pixels{pixels},
+          size_{size}
+    {
+    }
+
+    auto format() const -> MirPixelFormat override
+    {
+        return mir_pixel_format_argb_8888;
+    }
+
+    auto stride() const -> geom::Stride override
+    {
+        return geom::Stride{size_.width.as_uint32_t() * MIR_BYTES_PER_PIXEL(mir_pixel_format_argb_8888)};
+    }
+
+    auto size() const -> geom::Size override
+    {
+        return size_;
+    }
+
+    auto data() -> unsigned char* override
+    {
+        return pixels.data();
+    }
+
+    auto len() const -> size_t override
+    {
+        return pixels.size();
+    }
+
+private:
+    std::vector<unsigned char>& pixels;
+    geom::Size const size_;
+};
+
 }
 
 mgo::detail::GLFramebufferObject::GLFramebufferObject(geom::Size const& size)
@@ -118,36 +160,109 @@ void mgo::detail::GLFramebufferObject::unbind() const
 
 mgo::DisplayBuffer::DisplayBuffer(SurfacelessEGLContext egl_context,
                                   geom::Rectangle const& area)
-    : egl_context{std::move(egl_context)},
-      fbo{area.size},
+    : egl_context{std::make_unique<SurfacelessEGLContext const>(std::move(egl_context))},
+      fbo{std::make_unique<detail::GLFramebufferObject const>(area.size)},
       area(area)
 {
 }
 
+mgo::DisplayBuffer::DisplayBuffer(geom::Rectangle const& area)
+    : area(area)
+{
+}
+
 geom::Rectangle mgo::DisplayBuffer::view_area() const
 {
     return area;
 }
 
+void mgo::DisplayBuffer::require_gl() const
+{
+    if (!egl_context)
+        BOOST_THROW_EXCEPTION(std::logic_error("Offscreen display buffer was created for software rendering only"));
+}
+
 void mgo::DisplayBuffer::make_current()
 {
-    egl_context.make_current();
+    require_gl();
+    egl_context->make_current();
 }
 
 void mgo::DisplayBuffer::bind()
 {
-    fbo.bind();
+    require_gl();
+    fbo->bind();
 }
 
 void mgo::DisplayBuffer::release_current()
 {
-    fbo.unbind();
-    egl_context.release_current();
+    require_gl();
+    fbo->unbind();
+    egl_context->release_current();
 }
 
 void mgo::DisplayBuffer::swap_buffers()
 {
+    require_gl();
     glFinish();
+    scanned_out = nullptr;
+}
+
+auto mgo::DisplayBuffer::map_framebuffer() -> std::unique_ptr<mrs::Mapping<unsigned char>>
+{
+    if (pixels.empty())
+    {
+        pixels.resize(
+            area.size.width.as_uint32_t() * area.size.height.as_uint32_t() *
+            MIR_BYTES_PER_PIXEL(mir_pixel_format_argb_8888));
+    }
+
+    return std::make_unique<PixelMapping>(pixels, area.size);
+}
+
+void mgo::DisplayBuffer::commit(std::vector<geom::Rectangle> const& damage)
+{
+    scanned_out = nullptr;
+
+    std::lock_guard<std::mutex> lock{presented_mutex};
+
+    // The renderer keeps drawing into pixels, so the presented frame is a copy;
+    // only the damaged areas differ from what was presented last time.
+    presented.resize(pixels.size());
+
+    // Nothing can have been drawn if the framebuffer was never mapped
+    geom::Rectangle const bounds{{0, 0}, pixels.empty() ? geom::Size{} : area.size};
+    auto const stride = area.size.width.as_int() * MIR_BYTES_PER_PIXEL(mir_pixel_format_argb_8888);
+
+    for (auto const& region : damage)
+    {
+        auto const copy = region.intersection_with(bounds);
+        if (copy.size.width.as_int() <= 0 || copy.size.height.as_int() <= 0)
+            continue;
+
+        auto const row_offset = copy.top_left.x.as_int() * MIR_BYTES_PER_PIXEL(mir_pixel_format_argb_8888);
+        auto const row_length = copy.size.width.as_int() * MIR_BYTES_PER_PIXEL(mir_pixel_format_argb_8888);
+
+        for (auto y = copy.top_left.y.as_int(); y != copy.bottom().as_int(); ++y)
+        {
+            auto const row = pixels.begin() + y * stride + row_offset;
+            std::copy(row, row + row_length, presented.begin() + y * stride + row_offset);
+        }
+    }
+
+    ++frames_presented;
+}
+
+auto mgo::DisplayBuffer::presented_pixels() const -> std::vector<unsigned char>
+{
+    std::lock_guard<std::mutex> lock{presented_mutex};
+    return presented;
+}
+
+auto mgo::DisplayBuffer::presented_frames() const -> uint64_t
+{
+    std::lock_guard<std::mutex> lock{presented_mutex};
+    return frames_presented;
 }
 
 bool mgo::DisplayBuffer::overlay(RenderableList const&)
@@ -155,6 +270,22 @@ bool mgo::DisplayBuffer::overlay(RenderableList const&)
     return false;
 }
 
+bool mgo::DisplayBuffer::scanout(std::shared_ptr<Renderable> const& candidate)
+{
+    auto const buffer = candidate->buffer();
+    if (buffer->size() != area.size)
+        return false;
+
+    // Keep the buffer, as a display would, until the next frame replaces it
+    scanned_out = buffer;
+    return true;
+}
+
+auto mgo::DisplayBuffer::scanout_buffer() const -> std::shared_ptr<Buffer>
+{
+    return scanned_out;
+}
+
 glm::mat2 mgo::DisplayBuffer::transformation() const
 {
     return glm::mat2(1);
@@ -22,12 +22,18 @@
 #include "mir/graphics/surfaceless_egl_context.h"
 
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/direct_scanout.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/rectangle.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
 
 #include <EGL/egl.h>
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace mir
 {
 namespace graphics
@@ -58,25 +64,52 @@ private:
 }
 
 class DisplayBuffer : public graphics::DisplayBuffer,
+                      public graphics::DirectScanout,
                       public graphics::NativeDisplayBuffer,
-                      public renderer::gl::RenderTarget
+                      public renderer::gl::RenderTarget,
+                      public renderer::software::RenderTarget
 {
 public:
     DisplayBuffer(SurfacelessEGLContext egl_context,
                   geometry::Rectangle const& area);
+    /// A display buffer that can only be rendered to by the CPU
+    explicit DisplayBuffer(geometry::Rectangle const& area);
 
     geometry::Rectangle view_area() const override;
     bool overlay(RenderableList const& renderlist) override;
+    bool scanout(std::shared_ptr<Renderable> const& candidate) override;
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
     void make_current() override;
     void bind() override;
     void release_current() override;
     void swap_buffers() override;
+    auto map_framebuffer() -> std::unique_ptr<renderer::software::Mapping<unsigned char>> override;
+    void commit(std::vector<geometry::Rectangle> const& damage) override;
+
+    /// The client buffer that is the current frame, if it was scanned out rather than rendered
+    auto scanout_buffer() const -> std::shared_ptr<Buffer>;
+
+    /// The ARGB pixels of the most recent frame committed by software rendering
+    auto presented_pixels() const -> std::vector<unsigned char>;
+    /// The number of frames committed by software rendering
+    auto presented_frames() const -> uint64_t;
+
 private:
-    SurfacelessEGLContext const egl_context;
-    detail::GLFramebufferObject const fbo;
+    void require_gl() const;
+
+    /// Both are null if the display buffer is only used for software rendering
+    std::unique_ptr<SurfacelessEGLContext const> const egl_context;
+    std::unique_ptr<detail::GLFramebufferObject const> const fbo;
     geometry::Rectangle const area;
+    /// Only allocated if the display buffer is used for software rendering
+    std::vector<unsigned char> pixels;
+
+    std::mutex mutable presented_mutex;
+    std::vector<unsigned char> presented;
+    uint64_t frames_presented{0};
+    /// Nothing reads an offscreen output, so scanning out is just holding the client's buffer
+    std::shared_ptr<Buffer> scanned_out;
 };
 
 }
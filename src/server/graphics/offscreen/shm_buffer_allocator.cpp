@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "shm_buffer_allocator.h"
+#include "shm_buffer.h"
+#include "buffer_from_wl_shm.h"
+#include "mir/executor.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mgo = mg::offscreen;
+namespace mgc = mg::common;
+namespace geom = mir::geometry;
+
+std::vector<MirPixelFormat> mgo::ShmBufferAllocator::supported_pixel_formats()
+{
+    // The same formats the hardware platforms offer, so clients see no difference
+    return {mir_pixel_format_argb_8888, mir_pixel_format_xrgb_8888};
+}
+
+std::shared_ptr<mg::Buffer> mgo::ShmBufferAllocator::alloc_software_buffer(
+    geom::Size size,
+    MirPixelFormat format)
+{
+    if (!mgc::ShmBuffer::supports(format))
+    {
+        BOOST_THROW_EXCEPTION(
+            std::runtime_error(
+                "Trying to create SHM buffer with unsupported pixel format"));
+    }
+
+    // No EGL, so nothing to release textures on; the software renderer never binds them
+    return std::make_shared<mgc::MemoryBackedShmBuffer>(size, format, nullptr);
+}
+
+void mgo::ShmBufferAllocator::bind_display(wl_display*, std::shared_ptr<Executor>)
+{
+    // Without EGL there is no client buffer extension to bind; wl_shm needs no setup
+}
+
+std::shared_ptr<mg::Buffer> mgo::ShmBufferAllocator::buffer_from_resource(
+    wl_resource*,
+    std::function<void()>&&,
+    std::function<void()>&&)
+{
+    BOOST_THROW_EXCEPTION(std::runtime_error{"Only SHM buffers are supported without EGL"});
+}
+
+auto mgo::ShmBufferAllocator::buffer_from_shm(
+    wl_resource* buffer,
+    std::shared_ptr<Executor> wayland_executor,
+    std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
+{
+    return mg::wayland::buffer_from_wl_shm(
+        buffer,
+        std::move(wayland_executor),
+        nullptr,
+        std::move(on_consumed));
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_OFFSCREEN_SHM_BUFFER_ALLOCATOR_H_
+#define MIR_GRAPHICS_OFFSCREEN_SHM_BUFFER_ALLOCATOR_H_
+
+#include "mir/graphics/graphic_buffer_allocator.h"
+
+namespace mir
+{
+namespace graphics
+{
+namespace offscreen
+{
+/**
+ * Allocates only CPU-accessible (SHM) buffers.
+ *
+ * Used with an offscreen display that has no EGL, where the platform's allocator
+ * (which needs a GL context) can't be created and everything is composited by the
+ * software renderer.
+ */
+class ShmBufferAllocator : public GraphicBufferAllocator
+{
+public:
+    std::vector<MirPixelFormat> supported_pixel_formats() override;
+
+    std::shared_ptr<Buffer> alloc_software_buffer(geometry::Size size, MirPixelFormat format) override;
+
+    void bind_display(wl_display* display, std::shared_ptr<Executor> wayland_executor) override;
+
+    std::shared_ptr<Buffer> buffer_from_resource(
+        wl_resource* buffer,
+        std::function<void()>&& on_consumed,
+        std::function<void()>&& on_release) override;
+
+    auto buffer_from_shm(
+        wl_resource* buffer,
+        std::shared_ptr<Executor> wayland_executor,
+        std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer> override;
+};
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_OFFSCREEN_SHM_BUFFER_ALLOCATOR_H_ */
@@ -202,15 +202,25 @@ void mg::SoftwareCursor::hide()
 
 void mg::SoftwareCursor::move_to(geometry::Point position)
 {
+    geom::Rectangle old_area;
+    geom::Rectangle new_area;
     {
         std::lock_guard<std::mutex> lg{guard};
 
         if (!renderable)
             return;
 
+        old_area = renderable->screen_position();
         renderable->move_to(position - hotspot);
+        new_area = renderable->screen_position();
+
+        // Not in the scene, so nothing to recomposite
+        if (!visible || old_area == new_area)
+            return;
     }
 
-    // This doesn't need to be called in a specific order with other potential calls, so it doesn't go on the executor
-    scene->emit_scene_changed();
+    // This doesn't need to be called in a specific order with other potential calls, so it doesn't go on the executor.
+    // Only the outputs the cursor has left, or entered, need recompositing.
+    scene->emit_scene_damaged(old_area);
+    scene->emit_scene_damaged(new_area);
 }
@@ -152,6 +152,11 @@ struct UpdateCursorOnSceneChanges : ms::Observer
         cursor_controller->update_cursor_image();
     }
 
+    void scene_damaged(geom::Rectangle const&) override
+    {
+        // Only overlays (such as the cursor itself) are damaged: the surface under the cursor is unchanged
+    }
+
     void surface_exists(std::shared_ptr<ms::Surface> const& surface) override
     {
         add_surface_observer(surface.get());
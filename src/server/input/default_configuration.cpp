@@ -19,6 +19,7 @@
 #include "mir/default_server_configuration.h"
 
 #include "key_repeat_dispatcher.h"
+#include "resampling_dispatcher.h"
 #include "event_filter_chain_dispatcher.h"
 #include "config_changer.h"
 #include "cursor_controller.h"
@@ -140,8 +141,26 @@ mir::DefaultServerConfiguration::the_input_dispatcher()
             // lp:1675357: Disable generation of key repeat events on nested servers
             auto enable_repeat = options->get<bool>(options::enable_key_repeat_opt);
 
+            std::shared_ptr<mi::InputDispatcher> next = the_event_filter_chain_dispatcher();
+
+            auto const resampling = options->get<std::string>(options::input_resampling_opt);
+            if (resampling != options::off_opt_value)
+            {
+                auto const all = resampling == options::all_opt_value;
+                auto const touch = all || resampling == options::touch_opt_value;
+                auto const pointer = all || resampling == options::pointer_opt_value;
+                if (!touch && !pointer)
+                {
+                    throw AbnormalExit(std::string("Invalid ") + options::input_resampling_opt + " option: " +
+                        resampling + " (valid options are: \"off\", \"touch\", \"pointer\" and \"all\")");
+                }
+
+                next = std::make_shared<mi::ResamplingDispatcher>(
+                    next, the_main_loop(), the_clock(), the_presentation_clock(), touch, pointer);
+            }
+
             return std::make_shared<mi::KeyRepeatDispatcher>(
-                the_event_filter_chain_dispatcher(), the_main_loop(), the_cookie_authority(),
+                next, the_main_loop(), the_cookie_authority(),
                 enable_repeat, key_repeat_timeout, key_repeat_delay, false);
         });
 }
@@ -0,0 +1,358 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resampling_dispatcher.h"
+
+#include "mir/compositor/presentation_clock.h"
+#include "mir/events/event_builders.h"
+#include "mir/events/event_private.h"
+#include "mir/time/alarm.h"
+#include "mir/time/alarm_factory.h"
+#include "mir/time/clock.h"
+
+#include <algorithm>
+
+namespace mi = mir::input;
+namespace mev = mir::events;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+/// How long before a frame its motion is delivered, to leave the client time to draw
+std::chrono::nanoseconds const frame_lead{4ms};
+
+/// How far behind delivery positions are resampled to, so they can usually be interpolated
+std::chrono::nanoseconds const resample_latency{5ms};
+
+/// Samples closer together than this are too noisy to extrapolate from
+std::chrono::nanoseconds const min_sample_interval{2ms};
+
+/// Samples further apart than this are not part of one continuous motion
+std::chrono::nanoseconds const max_sample_interval{20ms};
+
+/// The furthest ahead of the newest sample a position is predicted
+std::chrono::nanoseconds const max_prediction{8ms};
+
+auto is_motion(MirInputEvent const& event) -> bool
+{
+    switch (event.input_type())
+    {
+    case mir_input_event_type_pointer:
+    {
+        auto const pointer = event.to_pointer();
+        return pointer->action() == mir_pointer_action_motion &&
+               pointer->vscroll() == 0.0f &&
+               pointer->hscroll() == 0.0f;
+    }
+
+    case mir_input_event_type_touch:
+    {
+        auto const touch = event.to_touch();
+        for (size_t i = 0; i != touch->pointer_count(); ++i)
+        {
+            if (touch->action(i) != mir_touch_action_change)
+                return false;
+        }
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+auto since_epoch(mir::time::Timestamp time) -> std::chrono::nanoseconds
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch());
+}
+}
+
+mi::ResamplingDispatcher::ResamplingDispatcher(
+    std::shared_ptr<InputDispatcher> const& next_dispatcher,
+    std::shared_ptr<time::AlarmFactory> const& alarm_factory,
+    std::shared_ptr<time::Clock> const& clock,
+    std::shared_ptr<compositor::PresentationClock> const& presentation_clock,
+    bool resample_touch,
+    bool resample_pointer)
+    : next_dispatcher{next_dispatcher},
+      clock{clock},
+      presentation_clock{presentation_clock},
+      resample_touch{resample_touch},
+      resample_pointer{resample_pointer},
+      alarm{alarm_factory->create_alarm([this]{ on_frame_deadline(); })}
+{
+}
+
+mi::ResamplingDispatcher::~ResamplingDispatcher() = default;
+
+bool mi::ResamplingDispatcher::dispatch(std::shared_ptr<MirEvent const> const& event)
+{
+    optional_value<time::Timestamp> deliver_at;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        deliver_at = queue_or_hold(event);
+    }
+
+    if (deliver_at)
+    {
+        alarm->reschedule_for(deliver_at.value());
+    }
+
+    return dispatch_queued(event);
+}
+
+auto mi::ResamplingDispatcher::queue_or_hold(std::shared_ptr<MirEvent const> const& event)
+    -> optional_value<time::Timestamp>
+{
+    auto const input = mir_event_get_type(event.get()) == mir_event_type_input ? event->to_input() : nullptr;
+    if (!input || !resamples(*input))
+    {
+        queue_held({});
+        queued.push_back(event);
+        return {};
+    }
+
+    auto& device = motion[input->device_id()];
+    record(device, *input);
+
+    if (!is_motion(*input))
+    {
+        queue_held({});
+        queued.push_back(event);
+        return {};
+    }
+
+    hold(device, event);
+
+    auto const next_frame = presentation_clock->next_frame();
+    if (!next_frame)
+    {
+        queue_held({});
+        return {};
+    }
+
+    auto const deliver_at = next_frame.value() - frame_lead;
+    if (deliver_at <= clock->now())
+    {
+        // Too late to wait for this frame, but not to suit the motion to it
+        queue_held(since_epoch(deliver_at) - resample_latency);
+        return {};
+    }
+
+    if (scheduled_delivery)
+    {
+        return {};
+    }
+    scheduled_delivery = deliver_at;
+    return deliver_at;
+}
+
+bool mi::ResamplingDispatcher::dispatch_queued(std::shared_ptr<MirEvent const> const& event)
+{
+    std::unique_lock<std::mutex> lock{mutex};
+
+    // Whichever thread is already dispatching also delivers what we queued, after what it queued itself
+    if (dispatching)
+    {
+        return true;
+    }
+    dispatching = true;
+
+    auto result = true;
+    while (!queued.empty())
+    {
+        auto const next = std::move(queued.front());
+        queued.pop_front();
+
+        lock.unlock();
+        bool dispatched;
+        try
+        {
+            dispatched = next_dispatcher->dispatch(next);
+        }
+        catch (...)
+        {
+            lock.lock();
+            dispatching = false;
+            throw;
+        }
+        lock.lock();
+
+        if (next == event)
+        {
+            result = dispatched;
+        }
+    }
+
+    dispatching = false;
+    return result;
+}
+
+void mi::ResamplingDispatcher::start()
+{
+    next_dispatcher->start();
+}
+
+void mi::ResamplingDispatcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        motion.clear();
+        scheduled_delivery = optional_value<time::Timestamp>{};
+    }
+
+    alarm->cancel();
+    next_dispatcher->stop();
+}
+
+auto mi::ResamplingDispatcher::resamples(MirInputEvent const& event) const -> bool
+{
+    switch (event.input_type())
+    {
+    case mir_input_event_type_pointer:
+        return resample_pointer;
+
+    case mir_input_event_type_touch:
+        return resample_touch;
+
+    default:
+        return false;
+    }
+}
+
+void mi::ResamplingDispatcher::record(DeviceMotion& device, MirInputEvent const& event)
+{
+    Sample sample{event.event_time(), {}};
+    if (event.input_type() == mir_input_event_type_pointer)
+    {
+        auto const pointer = event.to_pointer();
+        sample.contacts.push_back({0, pointer->x(), pointer->y()});
+    }
+    else
+    {
+        auto const touch = event.to_touch();
+        for (size_t i = 0; i != touch->pointer_count(); ++i)
+        {
+            sample.contacts.push_back({touch->id(i), touch->x(i), touch->y(i)});
+        }
+    }
+
+    device.previous = std::move(device.latest);
+    device.latest = std::move(sample);
+}
+
+void mi::ResamplingDispatcher::hold(DeviceMotion& device, std::shared_ptr<MirEvent const> const& event)
+{
+    if (!device.held)
+    {
+        device.held_dx = 0;
+        device.held_dy = 0;
+    }
+
+    auto const input = event->to_input();
+    if (input->input_type() == mir_input_event_type_pointer)
+    {
+        auto const pointer = input->to_pointer();
+        device.held_dx += pointer->dx();
+        device.held_dy += pointer->dy();
+    }
+
+    device.held = event;
+}
+
+void mi::ResamplingDispatcher::queue_held(optional_value<std::chrono::nanoseconds> const& sample_time)
+{
+    for (auto& entry : motion)
+    {
+        auto& device = entry.second;
+        if (!device.held)
+            continue;
+
+        auto resampled = mev::clone_event(*device.held);
+        device.held.reset();
+
+        auto const input = resampled->to_input();
+        auto const is_pointer = input->input_type() == mir_input_event_type_pointer;
+        if (is_pointer)
+        {
+            auto const pointer = input->to_pointer();
+            pointer->set_dx(device.held_dx);
+            pointer->set_dy(device.held_dy);
+        }
+
+        auto const interval = device.latest.time - device.previous.time;
+        if (sample_time && interval >= min_sample_interval && interval <= max_sample_interval &&
+            sample_time.value() > device.previous.time)
+        {
+            // Interpolate if the sample time has been and gone, otherwise (cautiously) extrapolate
+            auto const target = std::min(
+                sample_time.value(),
+                device.latest.time + std::min(max_prediction, interval / 2));
+            auto const alpha = static_cast<float>((target - device.previous.time).count()) / interval.count();
+
+            auto const previous_position = [&](int id) -> Contact const*
+                {
+                    for (auto const& contact : device.previous.contacts)
+                    {
+                        if (contact.id == id)
+                            return &contact;
+                    }
+                    return nullptr;
+                };
+
+            // The held event is the latest sample, so its contacts are in the same order
+            for (size_t i = 0; i != device.latest.contacts.size(); ++i)
+            {
+                auto const& latest = device.latest.contacts[i];
+                if (auto const previous = previous_position(latest.id))
+                {
+                    auto const x = previous->x + alpha * (latest.x - previous->x);
+                    auto const y = previous->y + alpha * (latest.y - previous->y);
+
+                    if (is_pointer)
+                    {
+                        input->to_pointer()->set_x(x);
+                        input->to_pointer()->set_y(y);
+                    }
+                    else
+                    {
+                        input->to_touch()->set_x(i, x);
+                        input->to_touch()->set_y(i, y);
+                    }
+                }
+            }
+
+            input->set_event_time(target);
+        }
+
+        queued.push_back(std::move(resampled));
+    }
+}
+
+void mi::ResamplingDispatcher::on_frame_deadline()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        if (scheduled_delivery)
+        {
+            queue_held(since_epoch(scheduled_delivery.consume()) - resample_latency);
+        }
+    }
+
+    dispatch_queued(nullptr);
+}
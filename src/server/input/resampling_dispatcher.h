@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_INPUT_RESAMPLING_DISPATCHER_H_
+#define MIR_INPUT_RESAMPLING_DISPATCHER_H_
+
+#include "mir/input/input_dispatcher.h"
+#include "mir/optional_value.h"
+#include "mir/time/types.h"
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+class PresentationClock;
+}
+namespace time
+{
+class Alarm;
+class AlarmFactory;
+class Clock;
+}
+namespace input
+{
+/**
+ * Delivers pointer and touch motion once per frame, at positions predicted
+ * for that frame.
+ *
+ * Devices report motion at their own rate, which beats against the display's
+ * refresh rate: some frames see two new positions, others none, and the age
+ * of the newest position varies from frame to frame. Motion is instead held
+ * until shortly before the next frame is due and then delivered as a single
+ * event, interpolated (or briefly extrapolated) from the two most recent
+ * samples to a fixed offset from that frame.
+ *
+ * Any other event first flushes held motion, so nothing is reordered. While
+ * the compositor is idle there is no frame to aim at and motion passes
+ * straight through.
+ */
+class ResamplingDispatcher : public InputDispatcher
+{
+public:
+    ResamplingDispatcher(
+        std::shared_ptr<InputDispatcher> const& next_dispatcher,
+        std::shared_ptr<time::AlarmFactory> const& alarm_factory,
+        std::shared_ptr<time::Clock> const& clock,
+        std::shared_ptr<compositor::PresentationClock> const& presentation_clock,
+        bool resample_touch,
+        bool resample_pointer);
+    ~ResamplingDispatcher();
+
+    // InputDispatcher
+    bool dispatch(std::shared_ptr<MirEvent const> const& event) override;
+    void start() override;
+    void stop() override;
+
+private:
+    struct Contact
+    {
+        int id;
+        float x;
+        float y;
+    };
+
+    struct Sample
+    {
+        std::chrono::nanoseconds time;
+        std::vector<Contact> contacts;
+    };
+
+    struct DeviceMotion
+    {
+        Sample previous;
+        Sample latest;
+
+        /// The newest motion not yet delivered
+        std::shared_ptr<MirEvent const> held;
+        /// Relative pointer motion of everything held so far
+        float held_dx;
+        float held_dy;
+    };
+
+    auto resamples(MirInputEvent const& event) const -> bool;
+    void record(DeviceMotion& device, MirInputEvent const& event);
+    void hold(DeviceMotion& device, std::shared_ptr<MirEvent const> const& event);
+
+    /// Queues or holds event, returning when to deliver held motion if that has just been scheduled
+    auto queue_or_hold(std::shared_ptr<MirEvent const> const& event) -> optional_value<time::Timestamp>;
+
+    /// Queues all held motion for delivery, resampled to sample_time if that is set
+    void queue_held(optional_value<std::chrono::nanoseconds> const& sample_time);
+
+    /// Dispatches the queued events in order, without holding mutex
+    /// Returns next_dispatcher's result for event, if this thread dispatched it
+    bool dispatch_queued(std::shared_ptr<MirEvent const> const& event);
+
+    void on_frame_deadline();
+
+    std::shared_ptr<InputDispatcher> const next_dispatcher;
+    std::shared_ptr<time::Clock> const clock;
+    std::shared_ptr<compositor::PresentationClock> const presentation_clock;
+    bool const resample_touch;
+    bool const resample_pointer;
+
+    std::mutex mutex;
+    std::unordered_map<MirInputDeviceId, DeviceMotion> motion;
+    optional_value<time::Timestamp> scheduled_delivery;
+
+    // Events are queued in order under mutex, and dispatched in that order by one thread at a time, so
+    // held motion is never overtaken
+    std::deque<std::shared_ptr<MirEvent const>> queued;
+    bool dispatching{false};
+
+    std::unique_ptr<time::Alarm> const alarm;
+};
+}
+}
+
+#endif // MIR_INPUT_RESAMPLING_DISPATCHER_H_
@@ -220,6 +220,22 @@ std::shared_ptr<ms::Surface> ms::ApplicationSession::surface_after(std::shared_p
 }
 
 void ms::ApplicationSession::take_snapshot(SnapshotCallback const& snapshot_taken)
+{
+    if (auto const content = default_content())
+        snapshot_strategy->take_snapshot_of(content, snapshot_taken);
+    else
+        snapshot_taken(Snapshot());
+}
+
+void ms::ApplicationSession::take_snapshot(geometry::Size const& max_size, SnapshotCallback const& snapshot_taken)
+{
+    if (auto const content = default_content())
+        snapshot_strategy->take_snapshot_of(content, max_size, snapshot_taken);
+    else
+        snapshot_taken(Snapshot());
+}
+
+auto ms::ApplicationSession::default_content() -> std::shared_ptr<compositor::BufferStream>
 {
     //TODO: taking a snapshot of a session doesn't make much sense. Snapshots can be on surfaces
     //or bufferstreams, as those represent some content. A multi-surface session doesn't have enough
@@ -232,12 +248,11 @@ void ms::ApplicationSession::take_snapshot(SnapshotCallback const& snapshot_take
             if (!content)
                 BOOST_THROW_EXCEPTION(std::logic_error(
                     "Buffer was dropped without being removed from default_content_map"));
-            snapshot_strategy->take_snapshot_of(content, snapshot_taken);
-            return;
+            return content;
         }
     }
 
-    snapshot_taken(Snapshot());
+    return {};
 }
 
 std::shared_ptr<ms::Surface> ms::ApplicationSession::default_surface() const
@@ -72,6 +72,7 @@ public:
     auto surface_after(std::shared_ptr<Surface> const& sruface) const -> std::shared_ptr<Surface> override;
 
     void take_snapshot(SnapshotCallback const& snapshot_taken) override;
+    void take_snapshot(geometry::Size const& max_size, SnapshotCallback const& snapshot_taken) override;
     std::shared_ptr<Surface> default_surface() const override;
 
     std::string name() const override;
@@ -103,6 +104,8 @@ protected:
     ApplicationSession& operator=(ApplicationSession const&) = delete;
 
 private:
+    auto default_content() -> std::shared_ptr<compositor::BufferStream>;
+
     std::shared_ptr<shell::SurfaceStack> const surface_stack;
     std::shared_ptr<SurfaceFactory> const surface_factory;
     std::shared_ptr<BufferStreamFactory> const buffer_stream_factory;
@@ -821,6 +821,9 @@ public:
 
     ~SurfaceSnapshot()
     {
+        // The compositor is done with the renderable once it has drawn the frame
+        if (compositor_buffer)
+            underlying_buffer_stream->frame_composited(compositor_id);
     }
 
     unsigned int swap_interval() const override
@@ -841,6 +844,14 @@ public:
     std::experimental::optional<geom::Rectangle> clip_area() const override
     { return clip_area_; }
 
+    mg::TextureBounds texture_bounds() const override
+    {
+        // The bounds belong to the buffer they were submitted with, not whichever is latest
+        if (auto const shown = buffer())
+            return underlying_buffer_stream->texture_bounds(*shown);
+        return {};
+    }
+
     float alpha() const override
     { return alpha_; }
 
@@ -873,6 +884,19 @@ int ms::BasicSurface::buffers_ready_for_compositor(void const* id) const
     return max_buf;
 }
 
+void ms::BasicSurface::frame_presented(mc::CompositorID id)
+{
+    std::lock_guard<std::mutex> lock(guard);
+    for (auto const& info : layers)
+        info.stream->frame_presented(id);
+}
+
+auto ms::BasicSurface::frame_statistics() const -> mc::FrameStatistics
+{
+    // Doesn't lock the mutex because surface_buffer_stream is const
+    return surface_buffer_stream->frame_statistics();
+}
+
 void ms::BasicSurface::consume(MirEvent const* event)
 {
     observers->input_consumed(this, event);
@@ -110,6 +110,8 @@ public:
 
     graphics::RenderableList generate_renderables(compositor::CompositorID id) const override;
     int buffers_ready_for_compositor(void const* compositor_id) const override;
+    void frame_presented(compositor::CompositorID id) override;
+    auto frame_statistics() const -> compositor::FrameStatistics override;
 
     MirWindowType type() const override;
     MirWindowState state() const override;
@@ -30,6 +30,7 @@
 
 #include "broadcasting_session_event_sink.h"
 #include "gl_pixel_buffer.h"
+#include "software_pixel_buffer.h"
 #include "mediating_display_changer.h"
 #include "mir/scene/session_container.h"
 #include "session_manager.h"
@@ -42,6 +43,8 @@
 #include "timeout_application_not_responding_detector.h"
 #include "mir/options/program_option.h"
 #include "mir/options/default_configuration.h"
+#include "mir/options/configuration.h"
+#include "mir/options/option.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/frontend/display_changer.h"
 
@@ -52,6 +55,32 @@ namespace ms = mir::scene;
 namespace mg = mir::graphics;
 namespace msh = mir::shell;
 
+namespace
+{
+size_t const snapshot_workers{2};
+
+// There's no point in snapshotting a surface faster than a display can show it
+std::chrono::milliseconds const snapshot_min_interval{16};
+
+bool software_rendering(mir::options::Option const& options)
+{
+    return options.get<std::string>(mir::options::renderer_opt) == mir::options::software_renderer_value;
+}
+
+auto make_pixel_buffer(mg::Display& display, bool software) -> std::shared_ptr<ms::PixelBuffer>
+{
+    // The software renderer only composites CPU-mappable buffers, and the display may have no GL
+    if (software)
+        return std::make_shared<ms::SoftwarePixelBuffer>();
+
+    auto const ctx = dynamic_cast<mir::renderer::gl::ContextSource*>(&display);
+    if (!ctx)
+        BOOST_THROW_EXCEPTION(std::logic_error("Display does not support GL rendering"));
+
+    return std::make_shared<ms::GLPixelBuffer>(ctx->create_gl_context());
+}
+}
+
 std::shared_ptr<mc::Scene>
 mir::DefaultServerConfiguration::the_scene()
 {
@@ -192,16 +221,7 @@ mir::DefaultServerConfiguration::the_pixel_buffer()
     return pixel_buffer(
         [this]()
         {
-            auto as_context_source = [](mg::Display* display)
-            {
-                auto const ctx = dynamic_cast<renderer::gl::ContextSource*>(display);
-                if (!ctx)
-                    BOOST_THROW_EXCEPTION(std::logic_error("Display does not support GL rendering"));
-                return ctx;
-            };
-
-            return std::make_shared<ms::GLPixelBuffer>(
-                as_context_source(the_display().get())->create_gl_context());
+            return make_pixel_buffer(*the_display(), software_rendering(*the_options()));
         });
 }
 
@@ -211,8 +231,18 @@ mir::DefaultServerConfiguration::the_snapshot_strategy()
     return snapshot_strategy(
         [this]()
         {
+            // Each worker has a pixel buffer (and GL context) of its own: while one reads back, another can render.
+            // They're made on the first snapshot request, as many servers never take a snapshot.
+            auto const make_pixels =
+                [display = the_display(), software = software_rendering(*the_options())]
+                {
+                    return make_pixel_buffer(*display, software);
+                };
+
             return std::make_shared<ms::ThreadedSnapshotStrategy>(
-                the_pixel_buffer());
+                make_pixels,
+                snapshot_workers,
+                snapshot_min_interval);
         });
 }
 
@@ -21,7 +21,10 @@
 #include "mir/renderer/gl/context.h"
 #include "mir/renderer/gl/texture_source.h"
 
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
+#include <string>
 #include <boost/throw_exception.hpp>
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
@@ -47,11 +50,68 @@ inline uint32_t abgr_to_argb(uint32_t p)
            ((p) & 0xff000000);        /* A remains at same position */
 }
 
+GLchar const* const scaling_vertex_shader =
+    "attribute vec2 position;\n"
+    "attribute vec2 texcoord;\n"
+    "varying vec2 v_texcoord;\n"
+    "void main() {\n"
+    "    gl_Position = vec4(position, 0.0, 1.0);\n"
+    "    v_texcoord = texcoord;\n"
+    "}\n";
+
+GLchar const* const scaling_fragment_shader =
+    "precision mediump float;\n"
+    "uniform sampler2D tex;\n"
+    "varying vec2 v_texcoord;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(tex, v_texcoord);\n"
+    "}\n";
+
+GLuint compile_shader(GLenum type, GLchar const* source)
+{
+    auto const shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled)
+    {
+        GLchar log[1024];
+        glGetShaderInfoLog(shader, sizeof log - 1, nullptr, log);
+        log[sizeof log - 1] = '\0';
+        glDeleteShader(shader);
+
+        BOOST_THROW_EXCEPTION(
+            std::runtime_error(std::string{"Failed to compile snapshot scaling shader:\n"} + log));
+    }
+
+    return shader;
+}
+
+/// The largest size, with the same aspect ratio, that fits within max_size
+geom::Size scaled_size(geom::Size const& size, geom::Size const& max_size)
+{
+    auto const width = size.width.as_int();
+    auto const height = size.height.as_int();
+    auto const max_width = max_size.width.as_int();
+    auto const max_height = max_size.height.as_int();
+
+    if (max_width <= 0 || max_height <= 0 || (width <= max_width && height <= max_height))
+        return size;
+
+    auto const scale = std::min(double(max_width) / width, double(max_height) / height);
+
+    return {
+        std::max(1, static_cast<int>(std::lround(width * scale))),
+        std::max(1, static_cast<int>(std::lround(height * scale)))};
+}
 }
 
 ms::GLPixelBuffer::GLPixelBuffer(std::unique_ptr<renderer::gl::Context> gl_context)
     : gl_context{std::move(gl_context)},
-      tex{0}, fbo{0}, gl_pixel_format{0}, pixels_need_y_flip{false}
+      tex{0}, fbo{0}, scaling_program{0}, scaled_tex{0, 0},
+      gl_pixel_format{0}, pixels_need_y_flip{false}
 {
     /*
      * TODO: Handle systems that are big-endian, and therefore GL_BGRA doesn't
@@ -70,13 +130,18 @@ ms::GLPixelBuffer::~GLPixelBuffer() noexcept
      * This may be called from a different thread
      * than the one that called prepare
      */
-    if (tex != 0 || fbo != 0)
+    if (tex != 0 || fbo != 0 || scaling_program != 0)
         gl_context->make_current();
 
     if (tex != 0)
         glDeleteTextures(1, &tex);
     if (fbo != 0)
         glDeleteFramebuffers(1, &fbo);
+    if (scaling_program != 0)
+    {
+        glDeleteTextures(2, scaled_tex);
+        glDeleteProgram(scaling_program);
+    }
 }
 
 void ms::GLPixelBuffer::prepare()
@@ -97,21 +162,135 @@ void ms::GLPixelBuffer::prepare()
 
 void ms::GLPixelBuffer::fill_from(graphics::Buffer& buffer)
 {
-    auto width = buffer.size().width.as_uint32_t();
-    auto height = buffer.size().height.as_uint32_t();
+    prepare();
+    bind_buffer_texture(buffer);
 
-    pixels.resize(width * height * 4);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+
+    read_pixels(buffer.size());
+}
+
+void ms::GLPixelBuffer::fill_from(graphics::Buffer& buffer, geom::Size const& max_size)
+{
+    auto const size = scaled_size(buffer.size(), max_size);
+
+    if (size == buffer.size())
+    {
+        fill_from(buffer);
+        return;
+    }
 
     prepare();
+    bind_buffer_texture(buffer);
+    prepare_scaling();
+
+    /*
+     * Each pass at most halves the size, so that linear filtering averages
+     * every source pixel rather than skipping most of them.
+     */
+    auto source = tex;
+    auto source_size = buffer.size();
+    auto target = 0;
+    do
+    {
+        auto const halved = [](int from, int to) { return std::max(to, (from + 1) / 2); };
+        geom::Size const pass_size{
+            halved(source_size.width.as_int(), size.width.as_int()),
+            halved(source_size.height.as_int(), size.height.as_int())};
 
+        draw_scaled(source, scaled_tex[target], pass_size);
+
+        source = scaled_tex[target];
+        source_size = pass_size;
+        target = 1 - target;
+    }
+    while (source_size != size);
+
+    /* Only the scaled down pixels leave the GPU */
+    read_pixels(size);
+}
+
+void ms::GLPixelBuffer::bind_buffer_texture(graphics::Buffer& buffer)
+{
     auto const texture_source =
         dynamic_cast<mir::renderer::gl::TextureSource*>(
             buffer.native_buffer_base());
     if (!texture_source)
         BOOST_THROW_EXCEPTION(std::logic_error("Buffer does not support GL rendering"));
     texture_source->gl_bind_to_texture();
+}
 
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+void ms::GLPixelBuffer::prepare_scaling()
+{
+    if (scaling_program == 0)
+    {
+        auto const vertex = compile_shader(GL_VERTEX_SHADER, scaling_vertex_shader);
+        auto const fragment = compile_shader(GL_FRAGMENT_SHADER, scaling_fragment_shader);
+
+        scaling_program = glCreateProgram();
+        glAttachShader(scaling_program, vertex);
+        glAttachShader(scaling_program, fragment);
+        glLinkProgram(scaling_program);
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+
+        GLint linked;
+        glGetProgramiv(scaling_program, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            GLchar log[1024];
+            glGetProgramInfoLog(scaling_program, sizeof log - 1, nullptr, log);
+            log[sizeof log - 1] = '\0';
+            glDeleteProgram(scaling_program);
+            scaling_program = 0;
+
+            BOOST_THROW_EXCEPTION(
+                std::runtime_error(std::string{"Failed to link snapshot scaling program:\n"} + log));
+        }
+
+        glGenTextures(2, scaled_tex);
+    }
+
+    static GLfloat const vertices[] = { -1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, 1.f };
+    static GLfloat const texcoords[] = { 0.f, 0.f, 1.f, 0.f, 0.f, 1.f, 1.f, 1.f };
+
+    glUseProgram(scaling_program);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    auto const position = glGetAttribLocation(scaling_program, "position");
+    auto const texcoord = glGetAttribLocation(scaling_program, "texcoord");
+    glVertexAttribPointer(position, 2, GL_FLOAT, GL_FALSE, 0, vertices);
+    glVertexAttribPointer(texcoord, 2, GL_FLOAT, GL_FALSE, 0, texcoords);
+    glEnableVertexAttribArray(position);
+    glEnableVertexAttribArray(texcoord);
+    glUniform1i(glGetUniformLocation(scaling_program, "tex"), 0);
+}
+
+void ms::GLPixelBuffer::draw_scaled(GLuint source, GLuint target, geom::Size const& target_size)
+{
+    auto const width = target_size.width.as_int();
+    auto const height = target_size.height.as_int();
+
+    glBindTexture(GL_TEXTURE_2D, target);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target, 0);
+
+    glBindTexture(GL_TEXTURE_2D, source);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glViewport(0, 0, width, height);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+void ms::GLPixelBuffer::read_pixels(geom::Size const& size)
+{
+    auto const width = size.width.as_uint32_t();
+    auto const height = size.height.as_uint32_t();
+
+    pixels.resize(width * height * 4);
 
     /* First try to get pixels as BGRA */
     glGetError();
@@ -125,7 +304,7 @@ void ms::GLPixelBuffer::fill_from(graphics::Buffer& buffer)
         glReadPixels(0, 0, width, height, gl_pixel_format, GL_UNSIGNED_BYTE, pixels.data());
     }
 
-    size_ = buffer.size();
+    size_ = size;
     pixels_need_y_flip = true;
 }
 
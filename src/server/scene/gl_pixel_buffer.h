@@ -50,17 +50,24 @@ public:
     ~GLPixelBuffer() noexcept;
 
     void fill_from(graphics::Buffer& buffer);
+    void fill_from(graphics::Buffer& buffer, geometry::Size const& max_size);
     void const* as_argb_8888();
     geometry::Size size() const;
     geometry::Stride stride() const;
 
 private:
     void prepare();
+    void bind_buffer_texture(graphics::Buffer& buffer);
+    void prepare_scaling();
+    void draw_scaled(GLuint source, GLuint target, geometry::Size const& target_size);
+    void read_pixels(geometry::Size const& size);
     void copy_and_convert_pixel_line(char* src, char* dst);
 
     std::unique_ptr<renderer::gl::Context> const gl_context;
     GLuint tex;
     GLuint fbo;
+    GLuint scaling_program;
+    GLuint scaled_tex[2];
     std::vector<char> pixels;
     GLuint gl_pixel_format;
     bool pixels_need_y_flip;
@@ -25,6 +25,7 @@
 #include "mir/scene/session_event_handler_register.h"
 #include "mir/scene/session_event_sink.h"
 #include "mir/graphics/display.h"
+#include "mir/graphics/incrementally_configurable_display.h"
 #include "mir/compositor/compositor.h"
 #include "mir/geometry/rectangles.h"
 #include "mir/graphics/display_configuration_policy.h"
@@ -474,10 +475,7 @@ void ms::MediatingDisplayChanger::apply_config(
         if (configuration_has_new_outputs_enabled(*display->configuration(), *conf) ||
             !display->apply_if_configuration_preserves_display_buffers(*conf))
         {
-            ApplyNowAndRevertOnScopeExit comp{
-                [this] { compositor->stop(); },
-                [this] { compositor->start(); }};
-            display->configure(*conf);
+            configure_display(*conf);
         }
 
         observer->configuration_applied(conf);
@@ -494,10 +492,7 @@ void ms::MediatingDisplayChanger::apply_config(
              * was one that has been successfully display->configure()d, or it was the
              * configuration that existed at Mir startup. Which presumably worked!
              */
-            ApplyNowAndRevertOnScopeExit comp{
-                [this] { compositor->stop(); },
-                [this] { compositor->start(); }};
-            display->configure(*existing_configuration);
+            configure_display(*existing_configuration);
         }
         catch (std::exception const& e)
         {
@@ -509,6 +504,30 @@ void ms::MediatingDisplayChanger::apply_config(
     }
 }
 
+void ms::MediatingDisplayChanger::configure_display(mg::DisplayConfiguration const& conf)
+{
+    if (auto const incremental = std::dynamic_pointer_cast<mg::IncrementallyConfigurableDisplay>(display))
+    {
+        /*
+         * Only the sync groups the display replaces stop compositing; the others
+         * keep presenting throughout.
+         */
+        ApplyNowAndRevertOnScopeExit comp{
+            [] {},
+            [this] { compositor->start_compositing_to_new_groups(); }};
+        incremental->configure_incrementally(
+            conf,
+            [this](mg::DisplaySyncGroup& group) { compositor->stop_compositing_to(group); });
+    }
+    else
+    {
+        ApplyNowAndRevertOnScopeExit comp{
+            [this] { compositor->stop(); },
+            [this] { compositor->start(); }};
+        display->configure(conf);
+    }
+}
+
 void ms::MediatingDisplayChanger::apply_base_config()
 {
     apply_config(base_configuration_);
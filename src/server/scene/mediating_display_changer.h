@@ -99,6 +99,8 @@ private:
     void session_stopping_handler(std::shared_ptr<Session> const& session);
 
     void apply_config(std::shared_ptr<graphics::DisplayConfiguration> const& conf);
+    /// Reconfigures the display, pausing as little compositing as the display allows
+    void configure_display(graphics::DisplayConfiguration const& conf);
     void apply_base_config();
     void send_config_to_all_sessions(
         std::shared_ptr<graphics::DisplayConfiguration> const& conf);
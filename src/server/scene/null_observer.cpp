@@ -24,5 +24,6 @@ void ms::NullObserver::surface_added(std::shared_ptr<ms::Surface> const& /* surf
 void ms::NullObserver::surface_removed(std::shared_ptr<ms::Surface> const& /* surface */) {}
 void ms::NullObserver::surfaces_reordered(SurfaceSet const& /* affected_surfaces */) {}
 void ms::NullObserver::scene_changed() {}
+void ms::NullObserver::scene_damaged(geometry::Rectangle const& /* damage */) {}
 void ms::NullObserver::surface_exists(std::shared_ptr<ms::Surface> const& /* surface */) {}
 void ms::NullObserver::end_observation() {}
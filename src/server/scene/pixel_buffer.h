@@ -45,6 +45,15 @@ public:
      */
     virtual void fill_from(graphics::Buffer& buffer) = 0;
 
+    /**
+     * Fills the PixelBuffer with the contents of a graphics::Buffer, scaled
+     * down (keeping its aspect ratio) to fit within max_size.
+     *
+     * \param [in] buffer    the buffer to get the pixels of
+     * \param [in] max_size  the largest size wanted; an empty size means full size
+     */
+    virtual void fill_from(graphics::Buffer& buffer, geometry::Size const& max_size) = 0;
+
     /**
      * The pixels in 0xAARRGGBB format.
      *
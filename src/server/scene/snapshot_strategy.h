@@ -38,6 +38,12 @@ public:
         std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
         SnapshotCallback const& snapshot_taken) = 0;
 
+    /// As above, but scaled down (keeping its aspect ratio) to fit within max_size
+    virtual void take_snapshot_of(
+        std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
+        geometry::Size const& max_size,
+        SnapshotCallback const& snapshot_taken) = 0;
+
 protected:
     SnapshotStrategy() = default;
     SnapshotStrategy(SnapshotStrategy const&) = delete;
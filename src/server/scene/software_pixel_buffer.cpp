@@ -0,0 +1,159 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "software_pixel_buffer.h"
+#include "mir/graphics/buffer.h"
+#include "mir/renderer/sw/pixel_source.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// Converts a 32bpp pixel in the given format to 0xAARRGGBB
+inline uint32_t to_argb(uint32_t p, MirPixelFormat format)
+{
+    switch (format)
+    {
+    case mir_pixel_format_argb_8888:
+        return p;
+    case mir_pixel_format_xrgb_8888:
+        return p | 0xff000000;
+    case mir_pixel_format_abgr_8888:
+        return ((p << 16) & 0x00ff0000) | (p & 0xff00ff00) | ((p >> 16) & 0x000000ff);
+    case mir_pixel_format_xbgr_8888:
+        return ((p << 16) & 0x00ff0000) | (p & 0x0000ff00) | ((p >> 16) & 0x000000ff) | 0xff000000;
+    default:
+        BOOST_THROW_EXCEPTION(std::logic_error("Unsupported pixel format for snapshot"));
+    }
+}
+
+/// The largest size, with the same aspect ratio, that fits within max_size
+geom::Size scaled_size(geom::Size const& size, geom::Size const& max_size)
+{
+    auto const width = size.width.as_int();
+    auto const height = size.height.as_int();
+    auto const max_width = max_size.width.as_int();
+    auto const max_height = max_size.height.as_int();
+
+    if (max_width <= 0 || max_height <= 0 || (width <= max_width && height <= max_height))
+        return size;
+
+    auto const scale = std::min(double(max_width) / width, double(max_height) / height);
+
+    return {
+        std::max(1, static_cast<int>(std::lround(width * scale))),
+        std::max(1, static_cast<int>(std::lround(height * scale)))};
+}
+}
+
+void ms::SoftwarePixelBuffer::fill_from(graphics::Buffer& buffer)
+{
+    fill_from(buffer, geom::Size{});
+}
+
+void ms::SoftwarePixelBuffer::fill_from(graphics::Buffer& buffer, geom::Size const& max_size)
+{
+    // The buffer is only borrowed for the duration of this call
+    auto const mappable = mrs::as_read_mappable_buffer(
+        std::shared_ptr<mg::Buffer>{&buffer, [](mg::Buffer*) {}});
+    auto const mapping = mappable->map_readable();
+
+    auto const format = mapping->format();
+    if (MIR_BYTES_PER_PIXEL(format) != 4)
+        BOOST_THROW_EXCEPTION(std::logic_error("Unsupported pixel format for snapshot"));
+
+    auto const source_size = mapping->size();
+    auto const source_width = source_size.width.as_int();
+    auto const source_height = source_size.height.as_int();
+    auto const source_stride = mapping->stride().as_int();
+    auto const source = mapping->data();
+
+    auto const source_pixel = [&](int x, int y)
+        {
+            uint32_t p;
+            std::memcpy(&p, source + y * source_stride + x * 4, sizeof p);
+            return to_argb(p, format);
+        };
+
+    size_ = scaled_size(source_size, max_size);
+    auto const width = size_.width.as_int();
+    auto const height = size_.height.as_int();
+    pixels.resize(width * height);
+
+    if (size_ == source_size)
+    {
+        for (int y = 0; y != height; ++y)
+            for (int x = 0; x != width; ++x)
+                pixels[y * width + x] = source_pixel(x, y);
+        return;
+    }
+
+    // Average each box of source pixels, so that scaling down skips none of them
+    for (int y = 0; y != height; ++y)
+    {
+        auto const y_begin = y * source_height / height;
+        auto const y_end = std::max(y_begin + 1, (y + 1) * source_height / height);
+
+        for (int x = 0; x != width; ++x)
+        {
+            auto const x_begin = x * source_width / width;
+            auto const x_end = std::max(x_begin + 1, (x + 1) * source_width / width);
+
+            uint32_t sum[4] = {0, 0, 0, 0};
+            for (auto sy = y_begin; sy != y_end; ++sy)
+            {
+                for (auto sx = x_begin; sx != x_end; ++sx)
+                {
+                    auto const p = source_pixel(sx, sy);
+                    for (int channel = 0; channel != 4; ++channel)
+                        sum[channel] += (p >> (8 * channel)) & 0xff;
+                }
+            }
+
+            uint32_t const count = (y_end - y_begin) * (x_end - x_begin);
+            uint32_t average = 0;
+            for (int channel = 0; channel != 4; ++channel)
+                average |= ((sum[channel] + count / 2) / count) << (8 * channel);
+
+            pixels[y * width + x] = average;
+        }
+    }
+}
+
+void const* ms::SoftwarePixelBuffer::as_argb_8888()
+{
+    return pixels.data();
+}
+
+geom::Size ms::SoftwarePixelBuffer::size() const
+{
+    return size_;
+}
+
+geom::Stride ms::SoftwarePixelBuffer::stride() const
+{
+    return geom::Stride{size_.width.as_uint32_t() * sizeof(uint32_t)};
+}
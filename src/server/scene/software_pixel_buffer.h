@@ -0,0 +1,47 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_SOFTWARE_PIXEL_BUFFER_H_
+#define MIR_SCENE_SOFTWARE_PIXEL_BUFFER_H_
+
+#include "pixel_buffer.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+/** Extracts the pixels from a CPU-mappable graphics::Buffer, without needing GL. */
+class SoftwarePixelBuffer : public PixelBuffer
+{
+public:
+    void fill_from(graphics::Buffer& buffer) override;
+    void fill_from(graphics::Buffer& buffer, geometry::Size const& max_size) override;
+    void const* as_argb_8888() override;
+    geometry::Size size() const override;
+    geometry::Stride stride() const override;
+
+private:
+    std::vector<uint32_t> pixels;
+    geometry::Size size_;
+};
+
+}
+}
+
+#endif /* MIR_SCENE_SOFTWARE_PIXEL_BUFFER_H_ */
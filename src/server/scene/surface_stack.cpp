@@ -21,6 +21,7 @@
 #include "surface_stack.h"
 #include "rendering_tracker.h"
 #include "mir/scene/surface.h"
+#include "mir/scene/session.h"
 #include "mir/scene/null_surface_observer.h"
 #include "mir/scene/scene_report.h"
 #include "mir/compositor/scene_element.h"
@@ -156,13 +157,18 @@ mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID i
 
     scene_changed = false;
     mc::SceneElementSequence elements;
+    std::vector<std::weak_ptr<Surface>> surfaces;
     for (auto const& layer : surface_layers)
     {
         for (auto const& surface : layer)
         {
             if (surface->visible())
             {
-                for (auto& renderable : surface->generate_renderables(id))
+                auto const renderables = surface->generate_renderables(id);
+                if (!renderables.empty())
+                    surfaces.push_back(surface);
+
+                for (auto& renderable : renderables)
                 {
                     elements.emplace_back(
                         std::make_shared<SurfaceSceneElement>(
@@ -174,6 +180,10 @@ mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID i
             }
         }
     }
+    {
+        std::lock_guard<std::mutex> lock{composited_surfaces_mutex};
+        composited_surfaces[id] = std::move(surfaces);
+    }
     for (auto const& renderable : overlays)
     {
         elements.emplace_back(std::make_shared<OverlaySceneElement>(renderable));
@@ -208,6 +218,44 @@ int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
     return result;
 }
 
+void ms::SurfaceStack::frame_presented(mc::CompositorID id)
+{
+    std::vector<std::weak_ptr<Surface>> surfaces;
+    {
+        std::lock_guard<std::mutex> lock{composited_surfaces_mutex};
+        auto const composited = composited_surfaces.find(id);
+        if (composited == composited_surfaces.end())
+            return;
+
+        surfaces.swap(composited->second);
+    }
+
+    for (auto const& weak_surface : surfaces)
+    {
+        if (auto const surface = weak_surface.lock())
+            surface->frame_presented(id);
+    }
+}
+
+auto ms::SurfaceStack::frame_statistics() const -> std::vector<mc::SurfaceFrameStatistics>
+{
+    RecursiveReadLock lg(guard);
+
+    std::vector<mc::SurfaceFrameStatistics> result;
+    for (auto const& layer : surface_layers)
+    {
+        for (auto const& surface : layer)
+        {
+            auto const session = surface->session().lock();
+            result.push_back(mc::SurfaceFrameStatistics{
+                session ? session->process_id() : 0,
+                surface->name(),
+                surface->frame_statistics()});
+        }
+    }
+    return result;
+}
+
 void ms::SurfaceStack::register_compositor(mc::CompositorID cid)
 {
     RecursiveWriteLock lg(guard);
@@ -224,6 +272,9 @@ void ms::SurfaceStack::unregister_compositor(mc::CompositorID cid)
     registered_compositors.erase(cid);
 
     update_rendering_tracker_compositors();
+
+    std::lock_guard<std::mutex> lock{composited_surfaces_mutex};
+    composited_surfaces.erase(cid);
 }
 
 void ms::SurfaceStack::add_input_visualization(
@@ -262,6 +313,13 @@ void ms::SurfaceStack::emit_scene_changed()
     observers.scene_changed();
 }
 
+void ms::SurfaceStack::emit_scene_damaged(geometry::Rectangle const& damage)
+{
+    // Unlike emit_scene_changed() this doesn't mark the scene changed for every compositor:
+    // the observers schedule those showing the damage.
+    observers.scene_damaged(damage);
+}
+
 void ms::SurfaceStack::add_surface(
     std::shared_ptr<Surface> const& surface,
     mi::InputReceptionMode input_mode)
@@ -527,6 +585,12 @@ void ms::Observers::scene_changed()
         { observer->scene_changed(); });
 }
 
+void ms::Observers::scene_damaged(geometry::Rectangle const& damage)
+{
+   for_each([&](std::shared_ptr<Observer> const& observer)
+        { observer->scene_damaged(damage); });
+}
+
 void ms::Observers::surface_exists(std::shared_ptr<Surface> const& surface)
 {
     for_each([&](std::shared_ptr<Observer> const& observer)
@@ -23,6 +23,7 @@
 #include "mir/frontend/surface_stack.h"
 
 #include "mir/compositor/scene.h"
+#include "mir/compositor/frame_statistics.h"
 #include "mir/scene/observer.h"
 #include "mir/input/scene.h"
 #include "mir/recursive_read_write_mutex.h"
@@ -59,6 +60,7 @@ public:
    void surface_removed(std::shared_ptr<Surface> const& surface) override;
    void surfaces_reordered(SurfaceSet const& affected_surfaces) override;
    void scene_changed() override;
+   void scene_damaged(geometry::Rectangle const& damage) override;
    void surface_exists(std::shared_ptr<Surface> const& surface) override;
    void end_observation() override;
 
@@ -80,6 +82,7 @@ public:
     // From Scene
     compositor::SceneElementSequence scene_elements_for(compositor::CompositorID id) override;
     int frames_pending(compositor::CompositorID) const override;
+    void frame_presented(compositor::CompositorID id) override;
     void register_compositor(compositor::CompositorID id) override;
     void unregister_compositor(compositor::CompositorID id) override;
 
@@ -108,6 +111,10 @@ public:
     void remove_input_visualization(std::weak_ptr<graphics::Renderable> const& overlay) override;
 
     void emit_scene_changed() override;
+    void emit_scene_damaged(geometry::Rectangle const& damage) override;
+
+    /// The frame pacing of each surface, bottom to top
+    auto frame_statistics() const -> std::vector<compositor::SurfaceFrameStatistics>;
 
 private:
     SurfaceStack(const SurfaceStack&) = delete;
@@ -130,6 +137,10 @@ private:
     std::vector<std::vector<std::shared_ptr<Surface>>> surface_layers;
     std::map<Surface*,std::shared_ptr<RenderingTracker>> rendering_trackers;
     std::set<compositor::CompositorID> registered_compositors;
+
+    /// The surfaces in the scene each compositor was last given, for frame_presented()
+    std::mutex composited_surfaces_mutex;
+    std::map<compositor::CompositorID, std::vector<std::weak_ptr<Surface>>> composited_surfaces;
     
     std::vector<std::shared_ptr<graphics::Renderable>> overlays;
 
@@ -21,9 +21,11 @@
 #include "mir/compositor/buffer_stream.h"
 #include "mir/thread_name.h"
 
+#include <algorithm>
 #include <deque>
 #include <mutex>
 #include <condition_variable>
+#include <unordered_map>
 
 namespace geom = mir::geometry;
 namespace ms = mir::scene;
@@ -33,60 +35,106 @@ namespace mir
 namespace scene
 {
 
+using Clock = std::chrono::steady_clock;
+
 struct WorkItem
 {
-    std::shared_ptr<compositor::BufferStream> const stream;
-    ms::SnapshotCallback const snapshot_taken;
+    std::shared_ptr<compositor::BufferStream> stream;
+    geom::Size max_size;
+    std::vector<ms::SnapshotCallback> snapshot_taken;
 };
 
 class SnapshottingFunctor
 {
 public:
-    SnapshottingFunctor(std::shared_ptr<PixelBuffer> const& pixels)
-        : running{true}, pixels{pixels}
+    SnapshottingFunctor(std::chrono::milliseconds min_interval)
+        : running{true}, min_interval{min_interval}
     {
     }
 
-    void operator()()
+    void operator()(std::shared_ptr<PixelBuffer> const& pixels)
     {
         mir::set_thread_name("Mir/Snapshot");
         std::unique_lock<std::mutex> lock{work_mutex};
 
         while (running)
         {
-            while (running && work.empty())
-                work_cv.wait(lock);
+            auto const now = Clock::now();
+            auto const due = std::find_if(begin(work), end(work),
+                [&](WorkItem const& wi) { return due_time(wi) <= now; });
 
-            if (running)
+            if (due != end(work))
             {
-                auto wi = work.front();
-                work.pop_front();
+                auto wi = std::move(*due);
+                work.erase(due);
+                last_taken[wi.stream.get()] = now;
 
                 lock.unlock();
 
-                take_snapshot(wi);
+                take_snapshot(*pixels, wi);
 
                 lock.lock();
             }
+            else if (work.empty())
+            {
+                work_cv.wait(lock);
+            }
+            else
+            {
+                auto next = due_time(work.front());
+                for (auto const& wi : work)
+                    next = std::min(next, due_time(wi));
+                work_cv.wait_until(lock, next);
+            }
         }
     }
 
-    void take_snapshot(WorkItem const& wi)
+    void take_snapshot(PixelBuffer& pixels, WorkItem const& wi)
     {
-        wi.stream->with_most_recent_buffer_do([this](mir::graphics::Buffer& buffer) {
-            pixels->fill_from(buffer);
+        wi.stream->with_most_recent_buffer_do([&](mir::graphics::Buffer& buffer) {
+            if (wi.max_size == geom::Size{})
+                pixels.fill_from(buffer);
+            else
+                pixels.fill_from(buffer, wi.max_size);
         });
 
-        wi.snapshot_taken(
-            ms::Snapshot{pixels->size(),
-                     pixels->stride(),
-                     pixels->as_argb_8888()});
+        ms::Snapshot const snapshot{
+            pixels.size(),
+            pixels.stride(),
+            pixels.as_argb_8888()};
+
+        for (auto const& snapshot_taken : wi.snapshot_taken)
+            snapshot_taken(snapshot);
     }
 
-    void schedule_snapshot(WorkItem const& wi)
+    void schedule_snapshot(
+        std::shared_ptr<compositor::BufferStream> const& stream,
+        geom::Size const& max_size,
+        ms::SnapshotCallback const& snapshot_taken)
     {
         std::lock_guard<std::mutex> lg{work_mutex};
-        work.push_back(wi);
+
+        // A snapshot already waiting to be taken will do for this request too
+        for (auto& wi : work)
+        {
+            if (wi.stream == stream && wi.max_size == max_size)
+            {
+                wi.snapshot_taken.push_back(snapshot_taken);
+                return;
+            }
+        }
+
+        // Streams not snapshotted lately don't need remembering
+        auto const now = Clock::now();
+        for (auto i = begin(last_taken); i != end(last_taken);)
+        {
+            if (i->second + min_interval <= now)
+                i = last_taken.erase(i);
+            else
+                ++i;
+        }
+
+        work.push_back(WorkItem{stream, max_size, {snapshot_taken}});
         work_cv.notify_one();
     }
 
@@ -94,15 +142,23 @@ public:
     {
         std::lock_guard<std::mutex> lg{work_mutex};
         running = false;
-        work_cv.notify_one();
+        work_cv.notify_all();
     }
 
 private:
+    /// Called with work_mutex held: when the rate limit allows a snapshot of the stream
+    auto due_time(WorkItem const& wi) const -> Clock::time_point
+    {
+        auto const last = last_taken.find(wi.stream.get());
+        return last != end(last_taken) ? last->second + min_interval : Clock::time_point{};
+    }
+
     bool running;
-    std::shared_ptr<PixelBuffer> const pixels;
+    std::chrono::milliseconds const min_interval;
     std::mutex work_mutex;
     std::condition_variable work_cv;
     std::deque<WorkItem> work;
+    std::unordered_map<compositor::BufferStream const*, Clock::time_point> last_taken;
 };
 
 }
@@ -110,21 +166,61 @@ private:
 
 ms::ThreadedSnapshotStrategy::ThreadedSnapshotStrategy(
     std::shared_ptr<PixelBuffer> const& pixels)
-    : pixels{pixels},
-      functor{new SnapshottingFunctor{pixels}},
-      thread{std::ref(*functor)}
+    : ThreadedSnapshotStrategy{{pixels}, std::chrono::milliseconds::zero()}
+{
+}
+
+ms::ThreadedSnapshotStrategy::ThreadedSnapshotStrategy(
+    std::vector<std::shared_ptr<PixelBuffer>> const& pixels,
+    std::chrono::milliseconds min_interval)
+    : ThreadedSnapshotStrategy{
+        [pixels, next = 0u]() mutable { return pixels[next++]; },
+        pixels.size(),
+        min_interval}
+{
+}
+
+ms::ThreadedSnapshotStrategy::ThreadedSnapshotStrategy(
+    std::function<std::shared_ptr<PixelBuffer>()> const& make_pixels,
+    size_t workers,
+    std::chrono::milliseconds min_interval)
+    : make_pixels{make_pixels},
+      workers{workers},
+      functor{new SnapshottingFunctor{min_interval}}
 {
 }
 
 ms::ThreadedSnapshotStrategy::~ThreadedSnapshotStrategy() noexcept
 {
     functor->stop();
-    thread.join();
+
+    std::lock_guard<std::mutex> lock{threads_mutex};
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void ms::ThreadedSnapshotStrategy::start_workers()
+{
+    std::lock_guard<std::mutex> lock{threads_mutex};
+
+    // Should making a pixel buffer throw, the next request tries again
+    while (threads.size() < workers)
+        threads.emplace_back(std::ref(*functor), make_pixels());
+}
+
+void ms::ThreadedSnapshotStrategy::take_snapshot_of(
+    std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
+    SnapshotCallback const& snapshot_taken)
+{
+    start_workers();
+    functor->schedule_snapshot(surface_buffer_access, geom::Size{}, snapshot_taken);
 }
 
 void ms::ThreadedSnapshotStrategy::take_snapshot_of(
     std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
+    geom::Size const& max_size,
     SnapshotCallback const& snapshot_taken)
 {
-    functor->schedule_snapshot(WorkItem{surface_buffer_access, snapshot_taken});
+    start_workers();
+    functor->schedule_snapshot(surface_buffer_access, max_size, snapshot_taken);
 }
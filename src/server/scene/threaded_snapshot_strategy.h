@@ -21,9 +21,12 @@
 
 #include "snapshot_strategy.h"
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <thread>
-#include <functional>
+#include <vector>
 
 namespace mir
 {
@@ -32,20 +35,48 @@ namespace scene
 class PixelBuffer;
 class SnapshottingFunctor;
 
+/**
+ * Takes snapshots on a pool of worker threads, one for each PixelBuffer.
+ *
+ * The workers, and their pixel buffers (which may each need a GL context),
+ * are only made when the first snapshot is asked for.
+ *
+ * A request for a stream that already has one waiting (for the same size) is
+ * answered by the same snapshot, and snapshots of any one stream are taken at
+ * most once every min_interval; requests made sooner wait for it to pass.
+ */
 class ThreadedSnapshotStrategy : public SnapshotStrategy
 {
 public:
     ThreadedSnapshotStrategy(std::shared_ptr<PixelBuffer> const& pixels);
+    ThreadedSnapshotStrategy(
+        std::vector<std::shared_ptr<PixelBuffer>> const& pixels,
+        std::chrono::milliseconds min_interval);
+    /// \param make_pixels called, once for each of the workers, on the first snapshot request
+    ThreadedSnapshotStrategy(
+        std::function<std::shared_ptr<PixelBuffer>()> const& make_pixels,
+        size_t workers,
+        std::chrono::milliseconds min_interval);
     ~ThreadedSnapshotStrategy() noexcept;
 
     void take_snapshot_of(
         std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
-        SnapshotCallback const& snapshot_taken);
+        SnapshotCallback const& snapshot_taken) override;
+
+    void take_snapshot_of(
+        std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
+        geometry::Size const& max_size,
+        SnapshotCallback const& snapshot_taken) override;
 
 private:
-    std::shared_ptr<PixelBuffer> const pixels;
+    void start_workers();
+
+    std::function<std::shared_ptr<PixelBuffer>()> const make_pixels;
+    size_t const workers;
     std::unique_ptr<SnapshottingFunctor> functor;
-    std::thread thread;
+
+    std::mutex threads_mutex;
+    std::vector<std::thread> threads;
 };
 
 }
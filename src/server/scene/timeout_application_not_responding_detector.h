@@ -25,6 +25,8 @@
 #include <chrono>
 #include <unordered_map>
 #include <functional>
+#include <mutex>
+#include <vector>
 
 namespace mir
 {
@@ -41,6 +41,7 @@
 #include "mir/renderer/renderer_factory.h"
 
 #include "frontend_wayland/wayland_connector.h"
+#include "scene/surface_stack.h"
 
 #include <iostream>
 #include <mir/server.h>
@@ -506,6 +507,31 @@ auto mir::Server::x11_display() const -> mir::optional_value<std::string>
     BOOST_THROW_EXCEPTION(std::logic_error("Cannot open connection when not running"));
 }
 
+auto mir::Server::wayland_client_traffic() const -> std::vector<frontend::WaylandClientTraffic>
+{
+    if (auto const config = self->server_config)
+    {
+        return std::dynamic_pointer_cast<mir::frontend::WaylandConnector>(config->the_wayland_connector())
+            ->client_traffic();
+    }
+
+    BOOST_THROW_EXCEPTION(std::logic_error("Cannot get Wayland client traffic when not running"));
+}
+
+auto mir::Server::surface_frame_statistics() const -> std::vector<compositor::SurfaceFrameStatistics>
+{
+    if (auto const config = self->server_config)
+    {
+        // A scene replaced by the shell may not keep statistics
+        if (auto const stack = std::dynamic_pointer_cast<mir::scene::SurfaceStack>(config->the_scene()))
+            return stack->frame_statistics();
+
+        return {};
+    }
+
+    BOOST_THROW_EXCEPTION(std::logic_error("Cannot get surface frame statistics when not running"));
+}
+
 void mir::Server::run_on_wayland_display(std::function<void(wl_display*)> const& functor)
 {
     if (auto const config = self->server_config)
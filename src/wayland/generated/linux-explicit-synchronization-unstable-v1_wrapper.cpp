@@ -0,0 +1,366 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from linux-explicit-synchronization-unstable-v1.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#include "linux-explicit-synchronization-unstable-v1_wrapper.h"
+
+#include <boost/throw_exception.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+
+#include <wayland-server-core.h>
+
+#include "mir/log.h"
+
+namespace mir
+{
+namespace wayland
+{
+extern struct wl_interface const wl_surface_interface_data;
+extern struct wl_interface const zwp_linux_buffer_release_v1_interface_data;
+extern struct wl_interface const zwp_linux_explicit_synchronization_v1_interface_data;
+extern struct wl_interface const zwp_linux_surface_synchronization_v1_interface_data;
+}
+}
+
+namespace mw = mir::wayland;
+
+namespace
+{
+struct wl_interface const* all_null_types [] {
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr};
+}
+
+// LinuxExplicitSynchronizationV1
+
+struct mw::LinuxExplicitSynchronizationV1::Thunks
+{
+    static int const supported_version;
+
+    static void destroy_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        auto me = static_cast<LinuxExplicitSynchronizationV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->destroy();
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "LinuxExplicitSynchronizationV1::destroy()");
+        }
+    }
+
+    static void get_synchronization_thunk(struct wl_client* client, struct wl_resource* resource, uint32_t id, struct wl_resource* surface)
+    {
+        auto me = static_cast<LinuxExplicitSynchronizationV1*>(wl_resource_get_user_data(resource));
+        wl_resource* id_resolved{
+            wl_resource_create(client, &zwp_linux_surface_synchronization_v1_interface_data, wl_resource_get_version(resource), id)};
+        if (id_resolved == nullptr)
+        {
+            wl_client_post_no_memory(client);
+            BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+        }
+        try
+        {
+            me->get_synchronization(id_resolved, surface);
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "LinuxExplicitSynchronizationV1::get_synchronization()");
+        }
+    }
+
+    static void resource_destroyed_thunk(wl_resource* resource)
+    {
+        delete static_cast<LinuxExplicitSynchronizationV1*>(wl_resource_get_user_data(resource));
+    }
+
+    static void bind_thunk(struct wl_client* client, void* data, uint32_t version, uint32_t id)
+    {
+        auto me = static_cast<LinuxExplicitSynchronizationV1::Global*>(data);
+        auto resource = wl_resource_create(
+            client,
+            &zwp_linux_explicit_synchronization_v1_interface_data,
+            std::min((int)version, Thunks::supported_version),
+            id);
+        if (resource == nullptr)
+        {
+            wl_client_post_no_memory(client);
+            BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+        }
+        try
+        {
+            me->bind(resource);
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "LinuxExplicitSynchronizationV1 global bind");
+        }
+    }
+
+    static struct wl_interface const* get_synchronization_types[];
+    static struct wl_message const request_messages[];
+    static void const* request_vtable[];
+};
+
+int const mw::LinuxExplicitSynchronizationV1::Thunks::supported_version = 1;
+
+mw::LinuxExplicitSynchronizationV1::LinuxExplicitSynchronizationV1(struct wl_resource* resource, Version<1>)
+    : client{wl_resource_get_client(resource)},
+      resource{resource}
+{
+    if (resource == nullptr)
+    {
+        BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+    }
+    wl_resource_set_implementation(resource, Thunks::request_vtable, this, &Thunks::resource_destroyed_thunk);
+}
+
+mw::LinuxExplicitSynchronizationV1::~LinuxExplicitSynchronizationV1()
+{
+    wl_resource_set_implementation(resource, nullptr, nullptr, nullptr);
+}
+
+bool mw::LinuxExplicitSynchronizationV1::is_instance(wl_resource* resource)
+{
+    return wl_resource_instance_of(resource, &zwp_linux_explicit_synchronization_v1_interface_data, Thunks::request_vtable);
+}
+
+void mw::LinuxExplicitSynchronizationV1::destroy_wayland_object() const
+{
+    wl_resource_destroy(resource);
+}
+
+mw::LinuxExplicitSynchronizationV1::Global::Global(wl_display* display, Version<1>)
+    : wayland::Global{
+          wl_global_create(
+              display,
+              &zwp_linux_explicit_synchronization_v1_interface_data,
+              Thunks::supported_version,
+              this,
+              &Thunks::bind_thunk)}
+{
+}
+
+auto mw::LinuxExplicitSynchronizationV1::Global::interface_name() const -> char const*
+{
+    return LinuxExplicitSynchronizationV1::interface_name;
+}
+
+struct wl_interface const* mw::LinuxExplicitSynchronizationV1::Thunks::get_synchronization_types[] {
+    &zwp_linux_surface_synchronization_v1_interface_data,
+    &wl_surface_interface_data};
+
+struct wl_message const mw::LinuxExplicitSynchronizationV1::Thunks::request_messages[] {
+    {"destroy", "", all_null_types},
+    {"get_synchronization", "no", get_synchronization_types}};
+
+void const* mw::LinuxExplicitSynchronizationV1::Thunks::request_vtable[] {
+    (void*)Thunks::destroy_thunk,
+    (void*)Thunks::get_synchronization_thunk};
+
+mw::LinuxExplicitSynchronizationV1* mw::LinuxExplicitSynchronizationV1::from(struct wl_resource* resource)
+{
+    if (wl_resource_instance_of(resource, &zwp_linux_explicit_synchronization_v1_interface_data, LinuxExplicitSynchronizationV1::Thunks::request_vtable))
+    {
+        return static_cast<LinuxExplicitSynchronizationV1*>(wl_resource_get_user_data(resource));
+    }
+    return nullptr;
+}
+
+// LinuxSurfaceSynchronizationV1
+
+struct mw::LinuxSurfaceSynchronizationV1::Thunks
+{
+    static int const supported_version;
+
+    static void destroy_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        auto me = static_cast<LinuxSurfaceSynchronizationV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->destroy();
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "LinuxSurfaceSynchronizationV1::destroy()");
+        }
+    }
+
+    static void set_acquire_fence_thunk(struct wl_client* client, struct wl_resource* resource, int32_t fd)
+    {
+        auto me = static_cast<LinuxSurfaceSynchronizationV1*>(wl_resource_get_user_data(resource));
+        mir::Fd fd_resolved{fd};
+        try
+        {
+            me->set_acquire_fence(fd_resolved);
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "LinuxSurfaceSynchronizationV1::set_acquire_fence()");
+        }
+    }
+
+    static void get_release_thunk(struct wl_client* client, struct wl_resource* resource, uint32_t release)
+    {
+        auto me = static_cast<LinuxSurfaceSynchronizationV1*>(wl_resource_get_user_data(resource));
+        wl_resource* release_resolved{
+            wl_resource_create(client, &zwp_linux_buffer_release_v1_interface_data, wl_resource_get_version(resource), release)};
+        if (release_resolved == nullptr)
+        {
+            wl_client_post_no_memory(client);
+            BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+        }
+        try
+        {
+            me->get_release(release_resolved);
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "LinuxSurfaceSynchronizationV1::get_release()");
+        }
+    }
+
+    static void resource_destroyed_thunk(wl_resource* resource)
+    {
+        delete static_cast<LinuxSurfaceSynchronizationV1*>(wl_resource_get_user_data(resource));
+    }
+
+    static struct wl_interface const* get_release_types[];
+    static struct wl_message const request_messages[];
+    static void const* request_vtable[];
+};
+
+int const mw::LinuxSurfaceSynchronizationV1::Thunks::supported_version = 1;
+
+mw::LinuxSurfaceSynchronizationV1::LinuxSurfaceSynchronizationV1(struct wl_resource* resource, Version<1>)
+    : client{wl_resource_get_client(resource)},
+      resource{resource}
+{
+    if (resource == nullptr)
+    {
+        BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+    }
+    wl_resource_set_implementation(resource, Thunks::request_vtable, this, &Thunks::resource_destroyed_thunk);
+}
+
+mw::LinuxSurfaceSynchronizationV1::~LinuxSurfaceSynchronizationV1()
+{
+    wl_resource_set_implementation(resource, nullptr, nullptr, nullptr);
+}
+
+bool mw::LinuxSurfaceSynchronizationV1::is_instance(wl_resource* resource)
+{
+    return wl_resource_instance_of(resource, &zwp_linux_surface_synchronization_v1_interface_data, Thunks::request_vtable);
+}
+
+void mw::LinuxSurfaceSynchronizationV1::destroy_wayland_object() const
+{
+    wl_resource_destroy(resource);
+}
+
+struct wl_interface const* mw::LinuxSurfaceSynchronizationV1::Thunks::get_release_types[] {
+    &zwp_linux_buffer_release_v1_interface_data};
+
+struct wl_message const mw::LinuxSurfaceSynchronizationV1::Thunks::request_messages[] {
+    {"destroy", "", all_null_types},
+    {"set_acquire_fence", "h", all_null_types},
+    {"get_release", "n", get_release_types}};
+
+void const* mw::LinuxSurfaceSynchronizationV1::Thunks::request_vtable[] {
+    (void*)Thunks::destroy_thunk,
+    (void*)Thunks::set_acquire_fence_thunk,
+    (void*)Thunks::get_release_thunk};
+
+mw::LinuxSurfaceSynchronizationV1* mw::LinuxSurfaceSynchronizationV1::from(struct wl_resource* resource)
+{
+    if (wl_resource_instance_of(resource, &zwp_linux_surface_synchronization_v1_interface_data, LinuxSurfaceSynchronizationV1::Thunks::request_vtable))
+    {
+        return static_cast<LinuxSurfaceSynchronizationV1*>(wl_resource_get_user_data(resource));
+    }
+    return nullptr;
+}
+
+// LinuxBufferReleaseV1
+
+struct mw::LinuxBufferReleaseV1::Thunks
+{
+    static int const supported_version;
+
+    static struct wl_message const event_messages[];
+};
+
+int const mw::LinuxBufferReleaseV1::Thunks::supported_version = 1;
+
+mw::LinuxBufferReleaseV1::LinuxBufferReleaseV1(struct wl_resource* resource, Version<1>)
+    : client{wl_resource_get_client(resource)},
+      resource{resource}
+{
+    if (resource == nullptr)
+    {
+        BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+    }
+}
+
+mw::LinuxBufferReleaseV1::~LinuxBufferReleaseV1()
+{
+}
+
+void mw::LinuxBufferReleaseV1::send_fenced_release_event(mir::Fd fence) const
+{
+    int32_t fence_resolved{fence};
+    wl_resource_post_event(resource, Opcode::fenced_release, fence_resolved);
+}
+
+void mw::LinuxBufferReleaseV1::send_immediate_release_event() const
+{
+    wl_resource_post_event(resource, Opcode::immediate_release);
+}
+
+void mw::LinuxBufferReleaseV1::destroy_wayland_object() const
+{
+    wl_resource_destroy(resource);
+}
+
+struct wl_message const mw::LinuxBufferReleaseV1::Thunks::event_messages[] {
+    {"fenced_release", "h", all_null_types},
+    {"immediate_release", "", all_null_types}};
+
+mw::LinuxBufferReleaseV1* mw::LinuxBufferReleaseV1::from(struct wl_resource* resource)
+{
+    // WARNING: This is potentially unsafe; there is no guarantee that resource is a LinuxBufferReleaseV1
+    return static_cast<LinuxBufferReleaseV1*>(wl_resource_get_user_data(resource));
+}
+
+namespace mir
+{
+namespace wayland
+{
+
+struct wl_interface const zwp_linux_explicit_synchronization_v1_interface_data {
+    mw::LinuxExplicitSynchronizationV1::interface_name,
+    mw::LinuxExplicitSynchronizationV1::Thunks::supported_version,
+    2, mw::LinuxExplicitSynchronizationV1::Thunks::request_messages,
+    0, nullptr};
+
+struct wl_interface const zwp_linux_surface_synchronization_v1_interface_data {
+    mw::LinuxSurfaceSynchronizationV1::interface_name,
+    mw::LinuxSurfaceSynchronizationV1::Thunks::supported_version,
+    3, mw::LinuxSurfaceSynchronizationV1::Thunks::request_messages,
+    0, nullptr};
+
+struct wl_interface const zwp_linux_buffer_release_v1_interface_data {
+    mw::LinuxBufferReleaseV1::interface_name,
+    mw::LinuxBufferReleaseV1::Thunks::supported_version,
+    0, nullptr,
+    2, mw::LinuxBufferReleaseV1::Thunks::event_messages};
+
+}
+}
@@ -0,0 +1,138 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from linux-explicit-synchronization-unstable-v1.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_LINUX_EXPLICIT_SYNCHRONIZATION_UNSTABLE_V1_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_LINUX_EXPLICIT_SYNCHRONIZATION_UNSTABLE_V1_XML_WRAPPER
+
+#include <experimental/optional>
+#include <string_view>
+
+#include "mir/fd.h"
+#include <wayland-server-core.h>
+
+#include "mir/wayland/wayland_base.h"
+
+namespace mir
+{
+namespace wayland
+{
+
+class LinuxExplicitSynchronizationV1;
+class LinuxSurfaceSynchronizationV1;
+class LinuxBufferReleaseV1;
+
+class LinuxExplicitSynchronizationV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "zwp_linux_explicit_synchronization_v1";
+
+    static LinuxExplicitSynchronizationV1* from(struct wl_resource*);
+
+    LinuxExplicitSynchronizationV1(struct wl_resource* resource, Version<1>);
+    virtual ~LinuxExplicitSynchronizationV1();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const synchronization_exists = 0;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+    class Global : public wayland::Global
+    {
+    public:
+        Global(wl_display* display, Version<1>);
+
+        auto interface_name() const -> char const* override;
+
+    private:
+        virtual void bind(wl_resource* new_zwp_linux_explicit_synchronization_v1) = 0;
+        friend LinuxExplicitSynchronizationV1::Thunks;
+    };
+
+private:
+    virtual void destroy() = 0;
+    virtual void get_synchronization(struct wl_resource* id, struct wl_resource* surface) = 0;
+};
+
+class LinuxSurfaceSynchronizationV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "zwp_linux_surface_synchronization_v1";
+
+    static LinuxSurfaceSynchronizationV1* from(struct wl_resource*);
+
+    LinuxSurfaceSynchronizationV1(struct wl_resource* resource, Version<1>);
+    virtual ~LinuxSurfaceSynchronizationV1();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const invalid_fence = 0;
+        static uint32_t const duplicate_fence = 1;
+        static uint32_t const duplicate_release = 2;
+        static uint32_t const no_surface = 3;
+        static uint32_t const unsupported_buffer = 4;
+        static uint32_t const no_buffer = 5;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+private:
+    virtual void destroy() = 0;
+    virtual void set_acquire_fence(mir::Fd fd) = 0;
+    virtual void get_release(struct wl_resource* release) = 0;
+};
+
+class LinuxBufferReleaseV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "zwp_linux_buffer_release_v1";
+
+    static LinuxBufferReleaseV1* from(struct wl_resource*);
+
+    LinuxBufferReleaseV1(struct wl_resource* resource, Version<1>);
+    virtual ~LinuxBufferReleaseV1();
+
+    void send_fenced_release_event(mir::Fd fence) const;
+    void send_immediate_release_event() const;
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Opcode
+    {
+        static uint32_t const fenced_release = 0;
+        static uint32_t const immediate_release = 1;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+private:
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_LINUX_EXPLICIT_SYNCHRONIZATION_UNSTABLE_V1_XML_WRAPPER
@@ -118,10 +118,6 @@ struct mw::Compositor::Thunks
         {
             me->create_surface(id_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Compositor::create_surface()");
@@ -142,10 +138,6 @@ struct mw::Compositor::Thunks
         {
             me->create_region(id_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Compositor::create_region()");
@@ -273,10 +265,6 @@ struct mw::ShmPool::Thunks
         {
             me->create_buffer(id_resolved, offset, width, height, stride, format);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShmPool::create_buffer()");
@@ -290,10 +278,6 @@ struct mw::ShmPool::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShmPool::destroy()");
@@ -307,10 +291,6 @@ struct mw::ShmPool::Thunks
         {
             me->resize(size);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShmPool::resize()");
@@ -403,10 +383,6 @@ struct mw::Shm::Thunks
         {
             me->create_pool(id_resolved, fd_resolved, size);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Shm::create_pool()");
@@ -532,10 +508,6 @@ struct mw::Buffer::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Buffer::destroy()");
@@ -612,19 +584,15 @@ struct mw::DataOffer::Thunks
     static void accept_thunk(struct wl_client* client, struct wl_resource* resource, uint32_t serial, char const* mime_type)
     {
         auto me = static_cast<DataOffer*>(wl_resource_get_user_data(resource));
-        std::experimental::optional<std::string> mime_type_resolved;
+        std::experimental::optional<std::string_view> mime_type_resolved;
         if (mime_type != nullptr)
         {
-            mime_type_resolved = {mime_type};
+            mime_type_resolved = std::string_view{mime_type};
         }
         try
         {
             me->accept(serial, mime_type_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataOffer::accept()");
@@ -639,10 +607,6 @@ struct mw::DataOffer::Thunks
         {
             me->receive(mime_type, fd_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataOffer::receive()");
@@ -656,10 +620,6 @@ struct mw::DataOffer::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataOffer::destroy()");
@@ -673,10 +633,6 @@ struct mw::DataOffer::Thunks
         {
             me->finish();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataOffer::finish()");
@@ -690,10 +646,6 @@ struct mw::DataOffer::Thunks
         {
             me->set_actions(dnd_actions, preferred_action);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataOffer::set_actions()");
@@ -805,10 +757,6 @@ struct mw::DataSource::Thunks
         {
             me->offer(mime_type);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataSource::offer()");
@@ -822,10 +770,6 @@ struct mw::DataSource::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataSource::destroy()");
@@ -839,10 +783,6 @@ struct mw::DataSource::Thunks
         {
             me->set_actions(dnd_actions);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataSource::set_actions()");
@@ -989,10 +929,6 @@ struct mw::DataDevice::Thunks
         {
             me->start_drag(source_resolved, origin, icon_resolved, serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataDevice::start_drag()");
@@ -1011,10 +947,6 @@ struct mw::DataDevice::Thunks
         {
             me->set_selection(source_resolved, serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataDevice::set_selection()");
@@ -1028,10 +960,6 @@ struct mw::DataDevice::Thunks
         {
             me->release();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataDevice::release()");
@@ -1195,10 +1123,6 @@ struct mw::DataDeviceManager::Thunks
         {
             me->create_data_source(id_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataDeviceManager::create_data_source()");
@@ -1219,10 +1143,6 @@ struct mw::DataDeviceManager::Thunks
         {
             me->get_data_device(id_resolved, seat);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "DataDeviceManager::get_data_device()");
@@ -1351,10 +1271,6 @@ struct mw::Shell::Thunks
         {
             me->get_shell_surface(id_resolved, surface);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Shell::get_shell_surface()");
@@ -1470,10 +1386,6 @@ struct mw::ShellSurface::Thunks
         {
             me->pong(serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShellSurface::pong()");
@@ -1487,10 +1399,6 @@ struct mw::ShellSurface::Thunks
         {
             me->move(seat, serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShellSurface::move()");
@@ -1504,10 +1412,6 @@ struct mw::ShellSurface::Thunks
         {
             me->resize(seat, serial, edges);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShellSurface::resize()");
@@ -1521,10 +1425,6 @@ struct mw::ShellSurface::Thunks
         {
             me->set_toplevel();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShellSurface::set_toplevel()");
@@ -1538,10 +1438,6 @@ struct mw::ShellSurface::Thunks
         {
             me->set_transient(parent, x, y, flags);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShellSurface::set_transient()");
@@ -1560,10 +1456,6 @@ struct mw::ShellSurface::Thunks
         {
             me->set_fullscreen(method, framerate, output_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShellSurface::set_fullscreen()");
@@ -1577,10 +1469,6 @@ struct mw::ShellSurface::Thunks
         {
             me->set_popup(seat, serial, parent, x, y, flags);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShellSurface::set_popup()");
@@ -1599,10 +1487,6 @@ struct mw::ShellSurface::Thunks
         {
             me->set_maximized(output_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShellSurface::set_maximized()");
@@ -1616,10 +1500,6 @@ struct mw::ShellSurface::Thunks
         {
             me->set_title(title);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShellSurface::set_title()");
@@ -1633,10 +1513,6 @@ struct mw::ShellSurface::Thunks
         {
             me->set_class(class_);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ShellSurface::set_class()");
@@ -1784,10 +1660,6 @@ struct mw::Surface::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Surface::destroy()");
@@ -1806,10 +1678,6 @@ struct mw::Surface::Thunks
         {
             me->attach(buffer_resolved, x, y);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Surface::attach()");
@@ -1823,10 +1691,6 @@ struct mw::Surface::Thunks
         {
             me->damage(x, y, width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Surface::damage()");
@@ -1847,10 +1711,6 @@ struct mw::Surface::Thunks
         {
             me->frame(callback_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Surface::frame()");
@@ -1869,10 +1729,6 @@ struct mw::Surface::Thunks
         {
             me->set_opaque_region(region_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Surface::set_opaque_region()");
@@ -1891,10 +1747,6 @@ struct mw::Surface::Thunks
         {
             me->set_input_region(region_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Surface::set_input_region()");
@@ -1908,10 +1760,6 @@ struct mw::Surface::Thunks
         {
             me->commit();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Surface::commit()");
@@ -1925,10 +1773,6 @@ struct mw::Surface::Thunks
         {
             me->set_buffer_transform(transform);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Surface::set_buffer_transform()");
@@ -1942,10 +1786,6 @@ struct mw::Surface::Thunks
         {
             me->set_buffer_scale(scale);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Surface::set_buffer_scale()");
@@ -1959,10 +1799,6 @@ struct mw::Surface::Thunks
         {
             me->damage_buffer(x, y, width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Surface::damage_buffer()");
@@ -2100,10 +1936,6 @@ struct mw::Seat::Thunks
         {
             me->get_pointer(id_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Seat::get_pointer()");
@@ -2124,10 +1956,6 @@ struct mw::Seat::Thunks
         {
             me->get_keyboard(id_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Seat::get_keyboard()");
@@ -2148,10 +1976,6 @@ struct mw::Seat::Thunks
         {
             me->get_touch(id_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Seat::get_touch()");
@@ -2165,10 +1989,6 @@ struct mw::Seat::Thunks
         {
             me->release();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Seat::release()");
@@ -2323,10 +2143,6 @@ struct mw::Pointer::Thunks
         {
             me->set_cursor(serial, surface_resolved, hotspot_x, hotspot_y);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Pointer::set_cursor()");
@@ -2340,10 +2156,6 @@ struct mw::Pointer::Thunks
         {
             me->release();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Pointer::release()");
@@ -2518,10 +2330,6 @@ struct mw::Keyboard::Thunks
         {
             me->release();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Keyboard::release()");
@@ -2649,10 +2457,6 @@ struct mw::Touch::Thunks
         {
             me->release();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Touch::release()");
@@ -2795,10 +2599,6 @@ struct mw::Output::Thunks
         {
             me->release();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Output::release()");
@@ -2959,10 +2759,6 @@ struct mw::Region::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Region::destroy()");
@@ -2976,10 +2772,6 @@ struct mw::Region::Thunks
         {
             me->add(x, y, width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Region::add()");
@@ -2993,10 +2785,6 @@ struct mw::Region::Thunks
         {
             me->subtract(x, y, width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Region::subtract()");
@@ -3072,10 +2860,6 @@ struct mw::Subcompositor::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Subcompositor::destroy()");
@@ -3096,10 +2880,6 @@ struct mw::Subcompositor::Thunks
         {
             me->get_subsurface(id_resolved, surface, parent);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Subcompositor::get_subsurface()");
@@ -3218,10 +2998,6 @@ struct mw::Subsurface::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Subsurface::destroy()");
@@ -3235,10 +3011,6 @@ struct mw::Subsurface::Thunks
         {
             me->set_position(x, y);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Subsurface::set_position()");
@@ -3252,10 +3024,6 @@ struct mw::Subsurface::Thunks
         {
             me->place_above(sibling);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Subsurface::place_above()");
@@ -3269,10 +3037,6 @@ struct mw::Subsurface::Thunks
         {
             me->place_below(sibling);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Subsurface::place_below()");
@@ -3286,10 +3050,6 @@ struct mw::Subsurface::Thunks
         {
             me->set_sync();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Subsurface::set_sync()");
@@ -3303,10 +3063,6 @@ struct mw::Subsurface::Thunks
         {
             me->set_desync();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "Subsurface::set_desync()");
@@ -9,6 +9,7 @@
 #define MIR_FRONTEND_WAYLAND_WAYLAND_XML_WRAPPER
 
 #include <experimental/optional>
+#include <string_view>
 
 #include "mir/fd.h"
 #include <wayland-server-core.h>
@@ -313,8 +314,8 @@ public:
     static bool is_instance(wl_resource* resource);
 
 private:
-    virtual void accept(uint32_t serial, std::experimental::optional<std::string> const& mime_type) = 0;
-    virtual void receive(std::string const& mime_type, mir::Fd fd) = 0;
+    virtual void accept(uint32_t serial, std::experimental::optional<std::string_view> const& mime_type) = 0;
+    virtual void receive(std::string_view mime_type, mir::Fd fd) = 0;
     virtual void destroy() = 0;
     virtual void finish() = 0;
     virtual void set_actions(uint32_t dnd_actions, uint32_t preferred_action) = 0;
@@ -366,7 +367,7 @@ public:
     static bool is_instance(wl_resource* resource);
 
 private:
-    virtual void offer(std::string const& mime_type) = 0;
+    virtual void offer(std::string_view mime_type) = 0;
     virtual void destroy() = 0;
     virtual void set_actions(uint32_t dnd_actions) = 0;
 };
@@ -567,8 +568,8 @@ private:
     virtual void set_fullscreen(uint32_t method, uint32_t framerate, std::experimental::optional<struct wl_resource*> const& output) = 0;
     virtual void set_popup(struct wl_resource* seat, uint32_t serial, struct wl_resource* parent, int32_t x, int32_t y, uint32_t flags) = 0;
     virtual void set_maximized(std::experimental::optional<struct wl_resource*> const& output) = 0;
-    virtual void set_title(std::string const& title) = 0;
-    virtual void set_class(std::string const& class_) = 0;
+    virtual void set_title(std::string_view title) = 0;
+    virtual void set_class(std::string_view class_) = 0;
 };
 
 class Surface : public Resource
@@ -52,10 +52,6 @@ struct mw::ForeignToplevelManagerV1::Thunks
         {
             me->stop();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ForeignToplevelManagerV1::stop()");
@@ -185,10 +181,6 @@ struct mw::ForeignToplevelHandleV1::Thunks
         {
             me->set_maximized();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ForeignToplevelHandleV1::set_maximized()");
@@ -202,10 +194,6 @@ struct mw::ForeignToplevelHandleV1::Thunks
         {
             me->unset_maximized();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ForeignToplevelHandleV1::unset_maximized()");
@@ -219,10 +207,6 @@ struct mw::ForeignToplevelHandleV1::Thunks
         {
             me->set_minimized();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ForeignToplevelHandleV1::set_minimized()");
@@ -236,10 +220,6 @@ struct mw::ForeignToplevelHandleV1::Thunks
         {
             me->unset_minimized();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ForeignToplevelHandleV1::unset_minimized()");
@@ -253,10 +233,6 @@ struct mw::ForeignToplevelHandleV1::Thunks
         {
             me->activate(seat);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ForeignToplevelHandleV1::activate()");
@@ -270,10 +246,6 @@ struct mw::ForeignToplevelHandleV1::Thunks
         {
             me->close();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ForeignToplevelHandleV1::close()");
@@ -287,10 +259,6 @@ struct mw::ForeignToplevelHandleV1::Thunks
         {
             me->set_rectangle(surface, x, y, width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ForeignToplevelHandleV1::set_rectangle()");
@@ -304,10 +272,6 @@ struct mw::ForeignToplevelHandleV1::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ForeignToplevelHandleV1::destroy()");
@@ -326,10 +290,6 @@ struct mw::ForeignToplevelHandleV1::Thunks
         {
             me->set_fullscreen(output_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ForeignToplevelHandleV1::set_fullscreen()");
@@ -343,10 +303,6 @@ struct mw::ForeignToplevelHandleV1::Thunks
         {
             me->unset_fullscreen();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ForeignToplevelHandleV1::unset_fullscreen()");
@@ -9,6 +9,7 @@
 #define MIR_FRONTEND_WAYLAND_WLR_FOREIGN_TOPLEVEL_MANAGEMENT_UNSTABLE_V1_XML_WRAPPER
 
 #include <experimental/optional>
+#include <string_view>
 
 #include "mir/fd.h"
 #include <wayland-server-core.h>
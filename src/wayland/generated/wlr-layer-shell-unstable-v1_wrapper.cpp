@@ -64,10 +64,6 @@ struct mw::LayerShellV1::Thunks
         {
             me->get_layer_surface(id_resolved, surface, output_resolved, layer, namespace_);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "LayerShellV1::get_layer_surface()");
@@ -81,10 +77,6 @@ struct mw::LayerShellV1::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "LayerShellV1::destroy()");
@@ -205,10 +197,6 @@ struct mw::LayerSurfaceV1::Thunks
         {
             me->set_size(width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "LayerSurfaceV1::set_size()");
@@ -222,10 +210,6 @@ struct mw::LayerSurfaceV1::Thunks
         {
             me->set_anchor(anchor);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "LayerSurfaceV1::set_anchor()");
@@ -239,10 +223,6 @@ struct mw::LayerSurfaceV1::Thunks
         {
             me->set_exclusive_zone(zone);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "LayerSurfaceV1::set_exclusive_zone()");
@@ -256,10 +236,6 @@ struct mw::LayerSurfaceV1::Thunks
         {
             me->set_margin(top, right, bottom, left);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "LayerSurfaceV1::set_margin()");
@@ -273,10 +249,6 @@ struct mw::LayerSurfaceV1::Thunks
         {
             me->set_keyboard_interactivity(keyboard_interactivity);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "LayerSurfaceV1::set_keyboard_interactivity()");
@@ -290,10 +262,6 @@ struct mw::LayerSurfaceV1::Thunks
         {
             me->get_popup(popup);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "LayerSurfaceV1::get_popup()");
@@ -307,10 +275,6 @@ struct mw::LayerSurfaceV1::Thunks
         {
             me->ack_configure(serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "LayerSurfaceV1::ack_configure()");
@@ -324,10 +288,6 @@ struct mw::LayerSurfaceV1::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "LayerSurfaceV1::destroy()");
@@ -341,10 +301,6 @@ struct mw::LayerSurfaceV1::Thunks
         {
             me->set_layer(layer);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "LayerSurfaceV1::set_layer()");
@@ -50,10 +50,6 @@ struct mw::XdgOutputManagerV1::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgOutputManagerV1::destroy()");
@@ -74,10 +70,6 @@ struct mw::XdgOutputManagerV1::Thunks
         {
             me->get_xdg_output(id_resolved, output);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgOutputManagerV1::get_xdg_output()");
@@ -195,10 +187,6 @@ struct mw::XdgOutputV1::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgOutputV1::destroy()");
@@ -55,10 +55,6 @@ struct mw::XdgShellV6::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgShellV6::destroy()");
@@ -79,10 +75,6 @@ struct mw::XdgShellV6::Thunks
         {
             me->create_positioner(id_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgShellV6::create_positioner()");
@@ -103,10 +95,6 @@ struct mw::XdgShellV6::Thunks
         {
             me->get_xdg_surface(id_resolved, surface);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgShellV6::get_xdg_surface()");
@@ -120,10 +108,6 @@ struct mw::XdgShellV6::Thunks
         {
             me->pong(serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgShellV6::pong()");
@@ -258,10 +242,6 @@ struct mw::XdgPositionerV6::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositionerV6::destroy()");
@@ -275,10 +255,6 @@ struct mw::XdgPositionerV6::Thunks
         {
             me->set_size(width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositionerV6::set_size()");
@@ -292,10 +268,6 @@ struct mw::XdgPositionerV6::Thunks
         {
             me->set_anchor_rect(x, y, width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositionerV6::set_anchor_rect()");
@@ -309,10 +281,6 @@ struct mw::XdgPositionerV6::Thunks
         {
             me->set_anchor(anchor);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositionerV6::set_anchor()");
@@ -326,10 +294,6 @@ struct mw::XdgPositionerV6::Thunks
         {
             me->set_gravity(gravity);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositionerV6::set_gravity()");
@@ -343,10 +307,6 @@ struct mw::XdgPositionerV6::Thunks
         {
             me->set_constraint_adjustment(constraint_adjustment);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositionerV6::set_constraint_adjustment()");
@@ -360,10 +320,6 @@ struct mw::XdgPositionerV6::Thunks
         {
             me->set_offset(x, y);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositionerV6::set_offset()");
@@ -447,10 +403,6 @@ struct mw::XdgSurfaceV6::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgSurfaceV6::destroy()");
@@ -471,10 +423,6 @@ struct mw::XdgSurfaceV6::Thunks
         {
             me->get_toplevel(id_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgSurfaceV6::get_toplevel()");
@@ -495,10 +443,6 @@ struct mw::XdgSurfaceV6::Thunks
         {
             me->get_popup(id_resolved, parent, positioner);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgSurfaceV6::get_popup()");
@@ -512,10 +456,6 @@ struct mw::XdgSurfaceV6::Thunks
         {
             me->set_window_geometry(x, y, width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgSurfaceV6::set_window_geometry()");
@@ -529,10 +469,6 @@ struct mw::XdgSurfaceV6::Thunks
         {
             me->ack_configure(serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgSurfaceV6::ack_configure()");
@@ -631,10 +567,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::destroy()");
@@ -653,10 +585,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->set_parent(parent_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::set_parent()");
@@ -670,10 +598,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->set_title(title);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::set_title()");
@@ -687,10 +611,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->set_app_id(app_id);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::set_app_id()");
@@ -704,10 +624,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->show_window_menu(seat, serial, x, y);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::show_window_menu()");
@@ -721,10 +637,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->move(seat, serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::move()");
@@ -738,10 +650,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->resize(seat, serial, edges);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::resize()");
@@ -755,10 +663,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->set_max_size(width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::set_max_size()");
@@ -772,10 +676,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->set_min_size(width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::set_min_size()");
@@ -789,10 +689,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->set_maximized();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::set_maximized()");
@@ -806,10 +702,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->unset_maximized();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::unset_maximized()");
@@ -828,10 +720,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->set_fullscreen(output_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::set_fullscreen()");
@@ -845,10 +733,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->unset_fullscreen();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::unset_fullscreen()");
@@ -862,10 +746,6 @@ struct mw::XdgToplevelV6::Thunks
         {
             me->set_minimized();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevelV6::set_minimized()");
@@ -1004,10 +884,6 @@ struct mw::XdgPopupV6::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPopupV6::destroy()");
@@ -1021,10 +897,6 @@ struct mw::XdgPopupV6::Thunks
         {
             me->grab(seat, serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPopupV6::grab()");
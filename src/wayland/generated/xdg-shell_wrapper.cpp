@@ -55,10 +55,6 @@ struct mw::XdgWmBase::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgWmBase::destroy()");
@@ -79,10 +75,6 @@ struct mw::XdgWmBase::Thunks
         {
             me->create_positioner(id_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgWmBase::create_positioner()");
@@ -103,10 +95,6 @@ struct mw::XdgWmBase::Thunks
         {
             me->get_xdg_surface(id_resolved, surface);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgWmBase::get_xdg_surface()");
@@ -120,10 +108,6 @@ struct mw::XdgWmBase::Thunks
         {
             me->pong(serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgWmBase::pong()");
@@ -258,10 +242,6 @@ struct mw::XdgPositioner::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositioner::destroy()");
@@ -275,10 +255,6 @@ struct mw::XdgPositioner::Thunks
         {
             me->set_size(width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositioner::set_size()");
@@ -292,10 +268,6 @@ struct mw::XdgPositioner::Thunks
         {
             me->set_anchor_rect(x, y, width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositioner::set_anchor_rect()");
@@ -309,10 +281,6 @@ struct mw::XdgPositioner::Thunks
         {
             me->set_anchor(anchor);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositioner::set_anchor()");
@@ -326,10 +294,6 @@ struct mw::XdgPositioner::Thunks
         {
             me->set_gravity(gravity);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositioner::set_gravity()");
@@ -343,10 +307,6 @@ struct mw::XdgPositioner::Thunks
         {
             me->set_constraint_adjustment(constraint_adjustment);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositioner::set_constraint_adjustment()");
@@ -360,10 +320,6 @@ struct mw::XdgPositioner::Thunks
         {
             me->set_offset(x, y);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPositioner::set_offset()");
@@ -447,10 +403,6 @@ struct mw::XdgSurface::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgSurface::destroy()");
@@ -471,10 +423,6 @@ struct mw::XdgSurface::Thunks
         {
             me->get_toplevel(id_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgSurface::get_toplevel()");
@@ -500,10 +448,6 @@ struct mw::XdgSurface::Thunks
         {
             me->get_popup(id_resolved, parent_resolved, positioner);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgSurface::get_popup()");
@@ -517,10 +461,6 @@ struct mw::XdgSurface::Thunks
         {
             me->set_window_geometry(x, y, width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgSurface::set_window_geometry()");
@@ -534,10 +474,6 @@ struct mw::XdgSurface::Thunks
         {
             me->ack_configure(serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgSurface::ack_configure()");
@@ -636,10 +572,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::destroy()");
@@ -658,10 +590,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->set_parent(parent_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::set_parent()");
@@ -675,10 +603,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->set_title(title);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::set_title()");
@@ -692,10 +616,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->set_app_id(app_id);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::set_app_id()");
@@ -709,10 +629,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->show_window_menu(seat, serial, x, y);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::show_window_menu()");
@@ -726,10 +642,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->move(seat, serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::move()");
@@ -743,10 +655,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->resize(seat, serial, edges);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::resize()");
@@ -760,10 +668,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->set_max_size(width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::set_max_size()");
@@ -777,10 +681,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->set_min_size(width, height);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::set_min_size()");
@@ -794,10 +694,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->set_maximized();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::set_maximized()");
@@ -811,10 +707,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->unset_maximized();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::unset_maximized()");
@@ -833,10 +725,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->set_fullscreen(output_resolved);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::set_fullscreen()");
@@ -850,10 +738,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->unset_fullscreen();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::unset_fullscreen()");
@@ -867,10 +751,6 @@ struct mw::XdgToplevel::Thunks
         {
             me->set_minimized();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgToplevel::set_minimized()");
@@ -1009,10 +889,6 @@ struct mw::XdgPopup::Thunks
         {
             me->destroy();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPopup::destroy()");
@@ -1026,10 +902,6 @@ struct mw::XdgPopup::Thunks
         {
             me->grab(seat, serial);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "XdgPopup::grab()");
@@ -9,6 +9,7 @@
 #define MIR_FRONTEND_WAYLAND_XDG_SHELL_XML_WRAPPER
 
 #include <experimental/optional>
+#include <string_view>
 
 #include "mir/fd.h"
 #include <wayland-server-core.h>
@@ -245,8 +246,8 @@ public:
 private:
     virtual void destroy() = 0;
     virtual void set_parent(std::experimental::optional<struct wl_resource*> const& parent) = 0;
-    virtual void set_title(std::string const& title) = 0;
-    virtual void set_app_id(std::string const& app_id) = 0;
+    virtual void set_title(std::string_view title) = 0;
+    virtual void set_app_id(std::string_view app_id) = 0;
     virtual void show_window_menu(struct wl_resource* seat, uint32_t serial, int32_t x, int32_t y) = 0;
     virtual void move(struct wl_resource* seat, uint32_t serial) = 0;
     virtual void resize(struct wl_resource* seat, uint32_t serial, uint32_t edges) = 0;
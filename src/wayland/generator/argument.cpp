@@ -93,10 +93,10 @@ Emitter optional_object_mir2wl(Argument const* me)
 Emitter optional_string_wl2mir(Argument const* me)
 {
     return Lines{
-        {"std::experimental::optional<std::string> ", me->name, "_resolved;"},
+        {"std::experimental::optional<std::string_view> ", me->name, "_resolved;"},
         {"if (", me->name, " != nullptr)"},
         Block{
-            {me->name, "_resolved = {", me->name, "};"}
+            {me->name, "_resolved = std::string_view{", me->name, "};"}
         }
     };
 }
@@ -117,7 +117,7 @@ std::unordered_map<std::string, Argument::TypeDescriptor const> const request_ty
     { "int", { "int32_t", "int32_t", "i", {} }},
     { "fd", { "mir::Fd", "int32_t", "h", { fd_wl2mir } }},
     { "object", { "struct wl_resource*", "struct wl_resource*", "o", {} }},
-    { "string", { "std::string const&", "char const*", "s", {} }},
+    { "string", { "std::string_view", "char const*", "s", {} }},
     { "new_id", { "struct wl_resource*", "uint32_t", "n", {new_id_wl2mir} }},
     { "fixed", { "double", "wl_fixed_t", "f", { fixed_wl2mir } }},
     { "array", { "struct wl_array*", "struct wl_array*", "a", {} }}
@@ -125,7 +125,7 @@ std::unordered_map<std::string, Argument::TypeDescriptor const> const request_ty
 
 std::unordered_map<std::string, Argument::TypeDescriptor const> const request_optional_type_map = {
     { "object", { "std::experimental::optional<struct wl_resource*> const&", "struct wl_resource*", "?o", { optional_object_wl2mir } }},
-    { "string", { "std::experimental::optional<std::string> const&", "char const*",  "?s",{ optional_string_wl2mir } }},
+    { "string", { "std::experimental::optional<std::string_view> const&", "char const*",  "?s",{ optional_string_wl2mir } }},
 };
 
 std::unordered_map<std::string, Argument::TypeDescriptor const> const event_type_map = {
@@ -64,7 +64,8 @@ auto matching_keys_to_vector(
 Interface::Interface(xmlpp::Element const& node,
                      std::function<std::string(std::string)> const& name_transform,
                      std::unordered_set<std::string> const& constructable_interfaces,
-                     std::unordered_multimap<std::string, std::string> const& event_constructable_interfaces)
+                     std::unordered_multimap<std::string, std::string> const& event_constructable_interfaces,
+                     bool profile_requests)
     : wl_name{node.get_attribute_value("name")},
       version{std::stoi(node.get_attribute_value("version"))},
       generated_name{name_transform(wl_name)},
@@ -74,7 +75,7 @@ Interface::Interface(xmlpp::Element const& node,
       global{!(has_server_constructor || has_client_constructor) ?
           std::experimental::make_optional(Global{wl_name, generated_name, version, nmspace}) :
           std::experimental::nullopt},
-      requests{get_requests(node, generated_name)},
+      requests{get_requests(node, generated_name, profile_requests)},
       events{get_events(node, generated_name)},
       enums{get_enums(node)},
       parent_interfaces{matching_keys_to_vector(event_constructable_interfaces, name_transform, wl_name)},
@@ -471,13 +472,13 @@ Emitter Interface::types_init() const
     return EmptyLineList{types};
 }
 
-std::vector<Request> Interface::get_requests(xmlpp::Element const& node, std::string generated_name)
+std::vector<Request> Interface::get_requests(xmlpp::Element const& node, std::string generated_name, bool profiled)
 {
     std::vector<Request> requests;
     for (auto method_node : node.get_children("request"))
     {
         auto elem = dynamic_cast<xmlpp::Element*>(method_node);
-        requests.emplace_back(Request{std::ref(*elem), generated_name});
+        requests.emplace_back(Request{std::ref(*elem), generated_name, profiled});
     }
     return requests;
 }
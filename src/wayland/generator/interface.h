@@ -43,7 +43,8 @@ public:
     Interface(xmlpp::Element const& node,
               std::function<std::string(std::string)> const& name_transform,
               std::unordered_set<std::string> const& constructible_interfaces,
-              std::unordered_multimap<std::string, std::string> const& event_constructable_interfaces);
+              std::unordered_multimap<std::string, std::string> const& event_constructable_interfaces,
+              bool profile_requests);
 
     std::string class_name() const;
     Emitter declaration() const;
@@ -72,7 +73,7 @@ private:
     Emitter is_instance_prototype() const;
     Emitter is_instance_impl() const;
 
-    static std::vector<Request> get_requests(xmlpp::Element const& node, std::string generated_name);
+    static std::vector<Request> get_requests(xmlpp::Element const& node, std::string generated_name, bool profiled);
     static std::vector<Event> get_events(xmlpp::Element const& node, std::string generated_name);
     static std::vector<Enum> get_enums(xmlpp::Element const& node);
 
@@ -18,8 +18,9 @@
 
 #include "request.h"
 
-Request::Request(xmlpp::Element const& node, std::string const& class_name)
-    : Method{node, class_name, false}
+Request::Request(xmlpp::Element const& node, std::string const& class_name, bool profiled)
+    : Method{node, class_name, false},
+      profiled{profiled}
 {
 }
 
@@ -34,16 +35,13 @@ Emitter Request::thunk_impl() const
 {
     return {"static void ", name, "_thunk(", wl_args(), ")",
         Block{
+            profiling_hook(),
             {"auto me = static_cast<", class_name, "*>(wl_resource_get_user_data(resource));"},
             wl2mir_converters(),
             "try",
             Block{
                 {"me->", name, "(", mir_call_args(), ");"}
             },
-            "catch(ProtocolError const& err)",
-            Block{
-                {"wl_resource_post_error(err.resource(), err.code(), \"%s\", err.message());"},
-            },
             "catch(...)",
             Block{
                 {"internal_error_processing_request(client, \"", class_name, "::", name, "()\");"},
@@ -52,6 +50,17 @@ Emitter Request::thunk_impl() const
     };
 }
 
+Emitter Request::profiling_hook() const
+{
+    if (!profiled)
+        return nullptr;
+
+    return Lines{
+        {"static RequestProfile profile{\"", class_name, "::", name, "()\"};"},
+        "RequestTimer const timer{profile};",
+    };
+}
+
 Emitter Request::vtable_initialiser() const
 {
     return {name, "_thunk"};
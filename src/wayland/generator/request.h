@@ -24,7 +24,7 @@
 class Request : public Method
 {
 public:
-    Request(xmlpp::Element const& node, std::string const& class_name);
+    Request(xmlpp::Element const& node, std::string const& class_name, bool profiled);
 
     // prototype of virtual function that is overridden in Mir
     Emitter virtual_mir_prototype() const;
@@ -48,6 +48,11 @@ protected:
 
     // arguments to call the virtual mir function call (just names, no types)
     Emitter mir_call_args() const;
+
+    // counts and times each dispatch of this request
+    Emitter profiling_hook() const;
+
+    bool const profiled;
 };
 
 #endif // MIR_WAYLAND_GENERATOR_REQUEST_H
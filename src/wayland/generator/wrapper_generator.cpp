@@ -47,6 +47,7 @@ Emitter header_includes()
 {
     return Lines{
         "#include <experimental/optional>",
+        "#include <string_view>",
         empty_line,
         "#include \"mir/fd.h\"",
         "#include <wayland-server-core.h>",
@@ -180,18 +181,19 @@ int main(int argc, char** argv)
     Emitter usage_emitter = Lines{
         empty_line,
         "/*",
-        {"Usage: ./", file_name_from_path(argv[0]), " <prefix> <input> <mode>"},
+        {"Usage: ./", file_name_from_path(argv[0]), " <prefix> <input> <mode> [--profile-requests]"},
         Block{
             "prefix: the name prefix which will be removed, such as wl_",
             "        to not use a prefix, use _ or anything that won't match the start of a name",
             "input: the input xml file path",
             "mode: 'header' or 'source'",
+            "--profile-requests: count and time the dispatch of each request (see mir::wayland::RequestProfile)",
         },
         "*/",
         empty_line,
     };
 
-    if (argc != 4)
+    if (argc != 4 && argc != 5)
     {
         usage_emitter.emit({std::cerr});
         usage_emitter.emit({std::cout});
@@ -217,6 +219,21 @@ int main(int argc, char** argv)
         exit(1);
     }
 
+    bool profile_requests{false};
+    if (argc == 5)
+    {
+        if (std::string{argv[4]} == "--profile-requests")
+        {
+            profile_requests = true;
+        }
+        else
+        {
+            usage_emitter.emit({std::cerr});
+            usage_emitter.emit({std::cout});
+            exit(1);
+        }
+    }
+
     auto name_transform = [prefix](std::string protocol_name)
     {
         std::string transformed_name = protocol_name;
@@ -274,7 +291,8 @@ int main(int argc, char** argv)
             *interface,
             name_transform,
             client_constructable_interfaces,
-            server_constructable_interfaces);
+            server_constructable_interfaces,
+            profile_requests);
     }
 
     Emitter emitter{nullptr};
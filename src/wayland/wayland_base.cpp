@@ -22,8 +22,16 @@
 
 #include "mir/wayland/wayland_base.h"
 
+#include <atomic>
+
 namespace mw = mir::wayland;
 
+namespace
+{
+/// The most recently created profile; each links to the one created before it
+std::atomic<mw::RequestProfile*> request_profiles{nullptr};
+}
+
 mw::ProtocolError::ProtocolError(
     wl_resource* source,
     uint32_t code,
@@ -103,6 +111,19 @@ mw::Global::~Global()
 
 void mw::internal_error_processing_request(wl_client* client, char const* method_name)
 {
+    try
+    {
+        throw;
+    }
+    catch (ProtocolError const& err)
+    {
+        wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        return;
+    }
+    catch (...)
+    {
+    }
+
 #if (WAYLAND_VERSION_MAJOR > 1 || (WAYLAND_VERSION_MAJOR == 1 && WAYLAND_VERSION_MINOR > 16))
     wl_client_post_implementation_error(client, "Mir internal error processing %s request", method_name);
 #else
@@ -114,3 +135,20 @@ void mw::internal_error_processing_request(wl_client* client, char const* method
         std::current_exception(),
         std::string() + "Exception processing " + method_name + " request");
 }
+
+mw::RequestProfile::RequestProfile(char const* name)
+    : name{name},
+      next{request_profiles.load()}
+{
+    while (!request_profiles.compare_exchange_weak(next, this))
+    {
+    }
+}
+
+void mw::for_each_request_profile(std::function<void(RequestProfile const&)> const& callback)
+{
+    for (auto profile = request_profiles.load(); profile; profile = profile->next)
+    {
+        callback(*profile);
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir_test_framework/async_server_runner.h"
+#include "mir_test_framework/executable_path.h"
+#include "mir/compositor/display_buffer_compositor.h"
+#include "mir/compositor/display_buffer_compositor_factory.h"
+#include "mir/compositor/scene.h"
+#include "mir/graphics/display.h"
+#include "mir/graphics/platform.h"
+#include "mir/renderer/gl/egl_platform.h"
+#include "mir/test/signal.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mtf = mir_test_framework;
+namespace mt = mir::test;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+using namespace testing;
+
+namespace
+{
+/// Signals when the display buffer compositor it wraps has composited a frame
+struct SignallingCompositorFactory : mc::DisplayBufferCompositorFactory
+{
+    SignallingCompositorFactory(std::shared_ptr<mc::DisplayBufferCompositorFactory> wrapped) :
+        wrapped{std::move(wrapped)}
+    {
+    }
+
+    auto create_compositor_for(mg::DisplayBuffer& display_buffer)
+        -> std::unique_ptr<mc::DisplayBufferCompositor> override
+    {
+        struct SignallingCompositor : mc::DisplayBufferCompositor
+        {
+            SignallingCompositor(std::unique_ptr<mc::DisplayBufferCompositor> wrapped, mt::Signal& composited) :
+                wrapped{std::move(wrapped)},
+                composited{composited}
+            {
+            }
+
+            void composite(mc::SceneElementSequence&& scene_sequence) override
+            {
+                wrapped->composite(std::move(scene_sequence));
+                composited.raise();
+            }
+
+            std::unique_ptr<mc::DisplayBufferCompositor> const wrapped;
+            mt::Signal& composited;
+        };
+
+        return std::make_unique<SignallingCompositor>(wrapped->create_compositor_for(display_buffer), composited);
+    }
+
+    std::shared_ptr<mc::DisplayBufferCompositorFactory> const wrapped;
+    mt::Signal composited;
+};
+
+struct SoftwareRenderingWithoutEGL : mtf::AsyncServerRunner, Test
+{
+    SoftwareRenderingWithoutEGL()
+    {
+        // The stub graphics platform offers no EGL at all
+        add_to_environment("MIR_SERVER_PLATFORM_GRAPHICS_LIB", mtf::server_platform("graphics-dummy.so").c_str());
+        add_to_environment("MIR_SERVER_PLATFORM_INPUT_LIB", mtf::server_platform("input-stub.so").c_str());
+        add_to_environment("MIR_SERVER_ENABLE_KEY_REPEAT", "false");
+        add_to_environment("MIR_SERVER_CONSOLE_PROVIDER", "none");
+        add_to_environment("MIR_SERVER_OFFSCREEN", "");
+        add_to_environment("MIR_SERVER_RENDERER", "software");
+
+        server.wrap_display_buffer_compositor_factory(
+            [this](std::shared_ptr<mc::DisplayBufferCompositorFactory> const& wrapped)
+            {
+                compositor_factory = std::make_shared<SignallingCompositorFactory>(wrapped);
+                return compositor_factory;
+            });
+
+        server.add_init_callback([this] { graphics_platform = server.the_graphics_platform(); });
+    }
+
+    void SetUp() override
+    {
+        start_server();
+    }
+
+    void TearDown() override
+    {
+        stop_server();
+    }
+
+    std::shared_ptr<SignallingCompositorFactory> compositor_factory;
+    // Unloading the stub platform before its buffers are gone crashes (as HeadlessTest notes)
+    std::shared_ptr<mg::Platform> graphics_platform;
+};
+}
+
+TEST_F(SoftwareRenderingWithoutEGL, server_starts_on_a_platform_without_egl)
+{
+    EXPECT_THAT(std::dynamic_pointer_cast<mir::renderer::gl::EGLPlatform>(graphics_platform), IsNull());
+    EXPECT_THAT(server.the_display(), NotNull());
+}
+
+TEST_F(SoftwareRenderingWithoutEGL, composites_frames)
+{
+    ASSERT_THAT(compositor_factory, NotNull());
+    EXPECT_TRUE(compositor_factory->composited.wait_for(std::chrono::seconds{10}));
+}
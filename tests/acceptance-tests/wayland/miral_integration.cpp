@@ -32,7 +32,9 @@ WlcsExtensionDescriptor const extensions[] = {
     {"wl_subcompositor",            1},
     {"xdg_wm_base",                 1},
     {"zxdg_shell_unstable_v6",      1},
-    {"wlr_layer_shell_unstable_v1", 1}
+    {"wlr_layer_shell_unstable_v1", 1},
+    {"wp_viewporter",               1},
+    {"zwp_linux_explicit_synchronization_v1", 1}
 };
 
 WlcsIntegrationDescriptor const descriptor{
@@ -20,6 +20,7 @@
 #define MIR_TEST_DOUBLES_MOCK_BUFFER_STREAM_H_
 
 #include "mir/compositor/buffer_stream.h"
+#include "mir/graphics/renderable.h"
 #include "stub_buffer.h"
 #include <gmock/gmock.h>
 
@@ -53,6 +54,8 @@ struct MockBufferStream : public compositor::BufferStream
             .WillByDefault(testing::Return(mir_pixel_format_abgr_8888));
         ON_CALL(*this, stream_size())
             .WillByDefault(testing::Return(geometry::Size{0,0}));
+        ON_CALL(*this, texture_bounds(testing::_))
+            .WillByDefault(testing::Return(graphics::TextureBounds{}));
     }
     std::shared_ptr<StubBuffer> buffer { std::make_shared<StubBuffer>() };
     MOCK_METHOD1(acquire_client_buffer, void(std::function<void(graphics::Buffer* buffer)>));
@@ -78,6 +81,13 @@ struct MockBufferStream : public compositor::BufferStream
     MOCK_METHOD1(disassociate_buffer, void(graphics::BufferID));
     MOCK_METHOD1(associate_buffer, void(graphics::BufferID));
     MOCK_METHOD1(set_scale, void(float));
+    MOCK_METHOD2(set_viewport, void(
+        graphics::TextureBounds const&,
+        std::experimental::optional<geometry::Size> const&));
+    MOCK_CONST_METHOD1(texture_bounds, graphics::TextureBounds(graphics::Buffer const&));
+    MOCK_METHOD1(frame_composited, void(void const*));
+    MOCK_METHOD1(frame_presented, void(void const*));
+    MOCK_CONST_METHOD0(frame_statistics, compositor::FrameStatistics());
 
 };
 }
@@ -35,6 +35,8 @@ class MockCompositor : public compositor::Compositor
 public:
     MOCK_METHOD0(start, void());
     MOCK_METHOD0(stop, void());
+    MOCK_METHOD1(stop_compositing_to, void(graphics::DisplaySyncGroup&));
+    MOCK_METHOD0(start_compositing_to_new_groups, void());
 };
 
 }
@@ -99,6 +99,7 @@ public:
 
     MOCK_METHOD1(drmModeGetResources, drmModeResPtr(int fd));
     MOCK_METHOD2(drmModeGetConnector, drmModeConnectorPtr(int fd, uint32_t connectorId));
+    MOCK_METHOD2(drmModeGetConnectorCurrent, drmModeConnectorPtr(int fd, uint32_t connectorId));
     MOCK_METHOD2(drmModeGetEncoder, drmModeEncoderPtr(int fd, uint32_t encoder_id));
     MOCK_METHOD1(drmModeGetPlaneResources, drmModePlaneResPtr(int fd));
     MOCK_METHOD2(drmModeGetPlane, drmModePlanePtr(int fd, uint32_t plane_id));
@@ -134,6 +135,8 @@ public:
     MOCK_METHOD2(drmModeGetProperty, drmModePropertyPtr(int fd, uint32_t propertyId));
     MOCK_METHOD1(drmModeFreeProperty, void(drmModePropertyPtr));
     MOCK_METHOD4(drmModeConnectorSetProperty, int(int fd, uint32_t connector_id, uint32_t property_id, uint64_t value));
+    MOCK_METHOD5(drmModeObjectSetProperty, int(int fd, uint32_t object_id, uint32_t object_type,
+                                               uint32_t property_id, uint64_t value));
 
     MOCK_METHOD2(drmGetMagic, int(int fd, drm_magic_t *magic));
     MOCK_METHOD2(drmAuthMagic, int(int fd, drm_magic_t magic));
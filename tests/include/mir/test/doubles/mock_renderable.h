@@ -39,6 +39,8 @@ struct MockRenderable : public graphics::Renderable
             .WillByDefault(testing::Return(std::experimental::optional<geometry::Rectangle>()));
         ON_CALL(*this, buffer())
             .WillByDefault(testing::Return(std::make_shared<StubBuffer>()));
+        ON_CALL(*this, texture_bounds())
+            .WillByDefault(testing::Return(graphics::TextureBounds{}));
         ON_CALL(*this, alpha())
             .WillByDefault(testing::Return(1.0f));
         ON_CALL(*this, transformation())
@@ -51,6 +53,7 @@ struct MockRenderable : public graphics::Renderable
     MOCK_CONST_METHOD0(buffer, std::shared_ptr<graphics::Buffer>());
     MOCK_CONST_METHOD0(screen_position, geometry::Rectangle());
     MOCK_CONST_METHOD0(clip_area, std::experimental::optional<geometry::Rectangle>());
+    MOCK_CONST_METHOD0(texture_bounds, graphics::TextureBounds());
     MOCK_CONST_METHOD0(alpha, float());
     MOCK_CONST_METHOD0(transformation, glm::mat4());
     MOCK_CONST_METHOD0(visible, bool());
@@ -42,6 +42,7 @@ public:
 
     MOCK_METHOD1(scene_elements_for, compositor::SceneElementSequence(compositor::CompositorID));
     MOCK_CONST_METHOD1(frames_pending, int(compositor::CompositorID));
+    MOCK_METHOD1(frame_presented, void(compositor::CompositorID));
     MOCK_METHOD1(register_compositor, void(compositor::CompositorID));
     MOCK_METHOD1(unregister_compositor, void(compositor::CompositorID));
 
@@ -23,6 +23,7 @@
 
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <X11/Xcursor/Xcursor.h>
 
 namespace mir
 {
@@ -51,6 +52,7 @@ public:
     XEvent motion_event_return = { 0 };
     XEvent enter_notify_event_return = { 0 };
     XEvent leave_notify_event_return = { 0 };
+    Cursor cursor{0x1234};
     int pending_events = 1;
 };
 
@@ -95,6 +97,12 @@ public:
     MOCK_METHOD9(XGetGeometry, Status(Display*, Drawable, Window*, int*, int*, unsigned int*, unsigned int*, unsigned int*, unsigned int*));
     MOCK_METHOD2(XFixesHideCursor, void(Display *dpy, Window win));
     MOCK_METHOD2(XFixesShowCursor, void(Display *dpy, Window win));
+    MOCK_METHOD3(XDefineCursor, int(Display*, Window, Cursor));
+    MOCK_METHOD2(XFreeCursor, int(Display*, Cursor));
+    MOCK_METHOD1(XFlush, int(Display*));
+    MOCK_METHOD2(XcursorImageCreate, XcursorImage*(int, int));
+    MOCK_METHOD1(XcursorImageDestroy, void(XcursorImage*));
+    MOCK_METHOD2(XcursorImageLoadCursor, Cursor(Display*, XcursorImage const*));
 
     FakeX11Resources fake_x11;
 };
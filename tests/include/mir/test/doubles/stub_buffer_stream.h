@@ -20,6 +20,7 @@
 #define MIR_TEST_DOUBLES_NULL_BUFFER_STREAM_H_
 
 #include <mir/compositor/buffer_stream.h>
+#include <mir/graphics/renderable.h>
 #include <mir/test/doubles/stub_buffer.h>
 #include "mir_test_framework/stub_platform_native_buffer.h"
 
@@ -73,6 +74,13 @@ public:
     void set_frame_posted_callback(std::function<void(geometry::Size const&)> const&) override {}
     bool has_submitted_buffer() const override { return true; }
     void set_scale(float) override {}
+    void set_viewport(
+        graphics::TextureBounds const&,
+        std::experimental::optional<geometry::Size> const&) override {}
+    graphics::TextureBounds texture_bounds(graphics::Buffer const&) const override { return {}; }
+    void frame_composited(void const*) override {}
+    void frame_presented(void const*) override {}
+    compositor::FrameStatistics frame_statistics() const override { return {}; }
 
     std::shared_ptr<graphics::Buffer> stub_compositor_buffer;
     int nready = 0;
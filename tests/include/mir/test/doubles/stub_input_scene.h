@@ -50,6 +50,10 @@ class StubInputScene : public input::Scene
     void emit_scene_changed() override
     {
     }
+
+    void emit_scene_damaged(geometry::Rectangle const& /* damage */) override
+    {
+    }
 };
 
 }
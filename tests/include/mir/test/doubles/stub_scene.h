@@ -40,6 +40,9 @@ public:
     {
         return 0;
     }
+    void frame_presented(compositor::CompositorID) override
+    {
+    }
     void register_compositor(compositor::CompositorID) override
     {
     }
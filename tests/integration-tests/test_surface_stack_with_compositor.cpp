@@ -17,8 +17,10 @@
  */
 
 #include "mir/compositor/display_listener.h"
+#include "mir/compositor/presentation_clock.h"
 #include "mir/renderer/renderer_factory.h"
 #include "mir/scene/surface_creation_parameters.h"
+#include "mir/time/steady_clock.h"
 #include "src/server/report/null_report_factory.h"
 #include "src/server/scene/surface_stack.h"
 #include "src/server/scene/basic_surface.h"
@@ -142,6 +144,8 @@ struct SurfaceStackCompositor : public Test
     std::shared_ptr<ms::SceneReport> null_scene_report{mr::null_scene_report()};
     ms::SurfaceStack stack{null_scene_report};
     std::shared_ptr<mc::CompositorReport> null_comp_report{mr::null_compositor_report()};
+    std::shared_ptr<mc::PresentationClock> presentation_clock{
+        std::make_shared<mc::PresentationClock>(std::make_shared<mir::time::SteadyClock>())};
     StubRendererFactory renderer_factory;
     std::chrono::system_clock::time_point timeout;
     std::shared_ptr<mc::Stream> stream;
@@ -170,7 +174,7 @@ TEST_F(SurfaceStackCompositor, composes_on_start_if_told_to_in_constructor)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, true);
+        null_comp_report, presentation_clock, default_delay, true);
     mt_compositor.start();
 
     EXPECT_TRUE(stub_primary_db.has_posted_at_least(1, timeout));
@@ -184,7 +188,7 @@ TEST_F(SurfaceStackCompositor, does_not_composes_on_start_if_told_not_to_in_cons
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, presentation_clock, default_delay, false);
     mt_compositor.start();
 
     EXPECT_TRUE(stub_primary_db.has_posted_at_least(0, timeout));
@@ -198,7 +202,7 @@ TEST_F(SurfaceStackCompositor, swapping_a_surface_that_has_been_added_triggers_a
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, presentation_clock, default_delay, false);
     mt_compositor.start();
 
     stack.add_surface(stub_surface, default_params.input_mode);
@@ -224,7 +228,7 @@ TEST_F(SurfaceStackCompositor, compositor_runs_until_all_surfaces_buffers_are_co
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, presentation_clock, default_delay, false);
     mt_compositor.start();
 
     stack.add_surface(stub_surface, default_params.input_mode);
@@ -254,7 +258,7 @@ TEST_F(SurfaceStackCompositor, bypassed_compositor_runs_until_all_surfaces_buffe
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, presentation_clock, default_delay, false);
     mt_compositor.start();
 
     stack.add_surface(stub_surface, default_params.input_mode);
@@ -272,7 +276,7 @@ TEST_F(SurfaceStackCompositor, an_empty_scene_retriggers)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, presentation_clock, default_delay, false);
     mt_compositor.start();
 
     stack.add_surface(stub_surface, default_params.input_mode);
@@ -297,7 +301,7 @@ TEST_F(SurfaceStackCompositor, moving_a_surface_triggers_composition)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, presentation_clock, default_delay, false);
 
     mt_compositor.start();
     stub_surface->move_to(geom::Point{1,1});
@@ -316,7 +320,7 @@ TEST_F(SurfaceStackCompositor, removing_a_surface_triggers_composition)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, presentation_clock, default_delay, false);
 
     mt_compositor.start();
     stack.remove_surface(stub_surface);
@@ -335,7 +339,7 @@ TEST_F(SurfaceStackCompositor, buffer_updates_trigger_composition)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, presentation_clock, default_delay, false);
 
     mt_compositor.start();
     streams.front().stream->submit_buffer(stub_buffer);
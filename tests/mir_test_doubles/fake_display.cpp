@@ -22,6 +22,7 @@
 
 #include "mir/graphics/event_handler_register.h"
 
+#include <algorithm>
 #include <system_error>
 #include <boost/throw_exception.hpp>
 
@@ -74,15 +75,17 @@ mtd::FakeDisplay::FakeDisplay(std::vector<geometry::Rectangle> const& output_rec
     {
         BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to create wakeup FD"));
     }
-    for (auto const& rect : output_rects)
-        groups.emplace_back(new StubDisplaySyncGroup({rect}));
+    config->for_each_output([this](mg::DisplayConfigurationOutput const& output)
+        {
+            groups.push_back({output.id, output.extents(), std::make_unique<StubDisplaySyncGroup>(std::vector<geometry::Rectangle>{output.extents()})});
+        });
 }
 
 void mtd::FakeDisplay::for_each_display_sync_group(std::function<void(mir::graphics::DisplaySyncGroup&)> const& f)
 {
     std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
     for (auto& group : groups)
-        f(*group);
+        f(*group.group);
 }
 
 std::unique_ptr<mir::graphics::DisplayConfiguration> mtd::FakeDisplay::configuration() const
@@ -135,13 +138,47 @@ void mtd::FakeDisplay::configure(mir::graphics::DisplayConfiguration const& new_
 
     new_configuration->for_each_output([&](mir::graphics::DisplayConfigurationOutput const& output)
         {
-            new_groups.emplace_back(new StubDisplaySyncGroup({output.extents()}));
+            new_groups.push_back({output.id, output.extents(), std::make_unique<StubDisplaySyncGroup>(std::vector<geometry::Rectangle>{output.extents()})});
         });
 
     swap(config, new_configuration);
     swap(groups, new_groups);
 }
 
+void mtd::FakeDisplay::configure_incrementally(
+    graphics::DisplayConfiguration const& new_config,
+    std::function<void(graphics::DisplaySyncGroup&)> const& invalidating)
+{
+    std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
+    decltype(config) new_configuration = std::make_shared<StubDisplayConfig>(new_config);
+    decltype(groups) new_groups;
+
+    new_configuration->for_each_output([&](mir::graphics::DisplayConfigurationOutput const& output)
+        {
+            auto const unchanged = std::find_if(begin(groups), end(groups), [&](OutputGroup const& group)
+                {
+                    return group.group && group.output_id == output.id && group.extents == output.extents();
+                });
+
+            if (unchanged != end(groups))
+            {
+                new_groups.push_back(std::move(*unchanged));
+            }
+            else
+            {
+                new_groups.push_back({output.id, output.extents(), std::make_unique<StubDisplaySyncGroup>(std::vector<geometry::Rectangle>{output.extents()})});
+            }
+        });
+
+    for (auto& group : groups)
+    {
+        if (group.group) invalidating(*group.group);
+    }
+
+    swap(config, new_configuration);
+    swap(groups, new_groups);
+}
+
 void mtd::FakeDisplay::emit_configuration_change_event(
     std::shared_ptr<mir::graphics::DisplayConfiguration> const& new_config)
 {
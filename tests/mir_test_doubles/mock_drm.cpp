@@ -304,6 +304,14 @@ mtd::MockDRM::MockDRM()
                     return fd_to_drm.at(fd).find_connector(connector_id);
                 }));
 
+    ON_CALL(*this, drmModeGetConnectorCurrent(_, _))
+        .WillByDefault(
+            Invoke(
+                [this](int fd, uint32_t connector_id)
+                {
+                    return fd_to_drm.at(fd).find_connector(connector_id);
+                }));
+
     ON_CALL(*this, drmModeObjectGetProperties(_, _, _))
         .WillByDefault(Return(&empty_object_props));
 
@@ -510,6 +518,11 @@ drmModeConnectorPtr drmModeGetConnector(int fd, uint32_t connectorId)
     return global_mock->drmModeGetConnector(fd, connectorId);
 }
 
+drmModeConnectorPtr drmModeGetConnectorCurrent(int fd, uint32_t connectorId)
+{
+    return global_mock->drmModeGetConnectorCurrent(fd, connectorId);
+}
+
 drmModeEncoderPtr drmModeGetEncoder(int fd, uint32_t encoder_id)
 {
     return global_mock->drmModeGetEncoder(fd, encoder_id);
@@ -595,6 +608,12 @@ int drmModeConnectorSetProperty(int fd, uint32_t connector_id, uint32_t property
     return global_mock->drmModeConnectorSetProperty(fd, connector_id, property_id, value);
 }
 
+int drmModeObjectSetProperty(int fd, uint32_t object_id, uint32_t object_type,
+                             uint32_t property_id, uint64_t value)
+{
+    return global_mock->drmModeObjectSetProperty(fd, object_id, object_type, property_id, value);
+}
+
 void drmModeFreeConnector(drmModeConnectorPtr ptr)
 {
     global_mock->drmModeFreeConnector(ptr);
@@ -49,6 +49,8 @@ void extension_glEGLImageTargetTexture2DOES(GLenum target, GLeglImageOES image);
 EGLSyncKHR extension_eglCreateSyncKHR(EGLDisplay dpy, EGLenum type, const EGLint *attrib_list);
 EGLBoolean extension_eglDestroySyncKHR(EGLDisplay dpy, EGLSyncKHR sync);
 EGLint extension_eglClientWaitSyncKHR(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags, EGLTimeKHR timeout);
+EGLint extension_eglWaitSyncKHR(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags);
+EGLint extension_eglDupNativeFenceFDANDROID(EGLDisplay dpy, EGLSyncKHR sync);
 EGLBoolean extension_eglGetSyncValuesCHROMIUM(EGLDisplay dpy,
     EGLSurface surface, int64_t *ust, int64_t *msc, int64_t *sbc);
 EGLBoolean extension_eglBindWaylandDisplayWL(
@@ -176,6 +178,10 @@ mtd::MockEGL::MockEGL()
         .WillByDefault(Return(reinterpret_cast<func_ptr_t>(extension_eglDestroySyncKHR)));
     ON_CALL(*this, eglGetProcAddress(StrEq("eglClientWaitSyncKHR")))
         .WillByDefault(Return(reinterpret_cast<func_ptr_t>(extension_eglClientWaitSyncKHR)));
+    ON_CALL(*this, eglGetProcAddress(StrEq("eglWaitSyncKHR")))
+        .WillByDefault(Return(reinterpret_cast<func_ptr_t>(extension_eglWaitSyncKHR)));
+    ON_CALL(*this, eglGetProcAddress(StrEq("eglDupNativeFenceFDANDROID")))
+        .WillByDefault(Return(reinterpret_cast<func_ptr_t>(extension_eglDupNativeFenceFDANDROID)));
     ON_CALL(*this, eglGetProcAddress(StrEq("eglGetSyncValuesCHROMIUM")))
         .WillByDefault(Return(
             reinterpret_cast<func_ptr_t>(extension_eglGetSyncValuesCHROMIUM)
@@ -469,6 +475,18 @@ EGLint extension_eglClientWaitSyncKHR(EGLDisplay dpy, EGLSyncKHR sync, EGLint fl
     return global_mock_egl->eglClientWaitSyncKHR(dpy, sync, flags, timeout);
 }
 
+EGLint extension_eglWaitSyncKHR(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags)
+{
+    CHECK_GLOBAL_MOCK(EGLint);
+    return global_mock_egl->eglWaitSyncKHR(dpy, sync, flags);
+}
+
+EGLint extension_eglDupNativeFenceFDANDROID(EGLDisplay dpy, EGLSyncKHR sync)
+{
+    CHECK_GLOBAL_MOCK(EGLint);
+    return global_mock_egl->eglDupNativeFenceFDANDROID(dpy, sync);
+}
+
 EGLBoolean extension_eglGetSyncValuesCHROMIUM(EGLDisplay dpy,
               EGLSurface surface, int64_t *ust, int64_t *msc, int64_t *sbc)
 {
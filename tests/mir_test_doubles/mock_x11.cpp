@@ -20,6 +20,7 @@
 #include "mir/test/doubles/mock_x11.h"
 #include <gtest/gtest.h>
 
+#include <cstdlib>
 #include <cstring>
 
 namespace mtd=mir::test::doubles;
@@ -104,6 +105,24 @@ mtd::MockX11::MockX11()
     .WillByDefault(DoAll(SetArgPointee<5>(fake_x11.screen.width),
                          SetArgPointee<6>(fake_x11.screen.height),
                          Return(1)));
+
+    // Like libXcursor, the pixels follow the image in one allocation
+    ON_CALL(*this, XcursorImageCreate(_,_))
+    .WillByDefault(Invoke([](int width, int height)
+                          {
+                              auto const image = static_cast<XcursorImage*>(
+                                  calloc(1, sizeof(XcursorImage) + width * height * sizeof(XcursorPixel)));
+                              image->width = width;
+                              image->height = height;
+                              image->pixels = reinterpret_cast<XcursorPixel*>(image + 1);
+                              return image;
+                          }));
+
+    ON_CALL(*this, XcursorImageDestroy(_))
+    .WillByDefault(Invoke([](XcursorImage* image) { free(image); }));
+
+    ON_CALL(*this, XcursorImageLoadCursor(fake_x11.display,_))
+    .WillByDefault(Return(fake_x11.cursor));
 }
 
 mtd::MockX11::~MockX11()
@@ -282,3 +301,33 @@ extern "C" void XFixesShowCursor(Display *dpy, Window win)
 {
     global_mock->XFixesShowCursor(dpy, win);
 }
+
+int XDefineCursor(Display* display, Window w, Cursor cursor)
+{
+    return global_mock->XDefineCursor(display, w, cursor);
+}
+
+int XFreeCursor(Display* display, Cursor cursor)
+{
+    return global_mock->XFreeCursor(display, cursor);
+}
+
+int XFlush(Display* display)
+{
+    return global_mock->XFlush(display);
+}
+
+extern "C" XcursorImage* XcursorImageCreate(int width, int height)
+{
+    return global_mock->XcursorImageCreate(width, height);
+}
+
+extern "C" void XcursorImageDestroy(XcursorImage* image)
+{
+    global_mock->XcursorImageDestroy(image);
+}
+
+extern "C" Cursor XcursorImageLoadCursor(Display* display, XcursorImage const* image)
+{
+    return global_mock->XcursorImageLoadCursor(display, image);
+}
@@ -39,11 +39,6 @@ struct wl_interface const* all_null_types [] {
 
 // ServerDecorationManager
 
-mw::ServerDecorationManager* mw::ServerDecorationManager::from(struct wl_resource* resource)
-{
-    return static_cast<ServerDecorationManager*>(wl_resource_get_user_data(resource));
-}
-
 struct mw::ServerDecorationManager::Thunks
 {
     static int const supported_version;
@@ -62,10 +57,6 @@ struct mw::ServerDecorationManager::Thunks
         {
             me->create(id_resolved, surface);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ServerDecorationManager::create()");
@@ -168,13 +159,17 @@ struct wl_message const mw::ServerDecorationManager::Thunks::event_messages[] {
 void const* mw::ServerDecorationManager::Thunks::request_vtable[] {
     (void*)Thunks::create_thunk};
 
-// ServerDecoration
-
-mw::ServerDecoration* mw::ServerDecoration::from(struct wl_resource* resource)
+mw::ServerDecorationManager* mw::ServerDecorationManager::from(struct wl_resource* resource)
 {
-    return static_cast<ServerDecoration*>(wl_resource_get_user_data(resource));
+    if (wl_resource_instance_of(resource, &org_kde_kwin_server_decoration_manager_interface_data, ServerDecorationManager::Thunks::request_vtable))
+    {
+        return static_cast<ServerDecorationManager*>(wl_resource_get_user_data(resource));
+    }
+    return nullptr;
 }
 
+// ServerDecoration
+
 struct mw::ServerDecoration::Thunks
 {
     static int const supported_version;
@@ -186,10 +181,6 @@ struct mw::ServerDecoration::Thunks
         {
             me->release();
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ServerDecoration::release()");
@@ -203,10 +194,6 @@ struct mw::ServerDecoration::Thunks
         {
             me->request_mode(mode);
         }
-        catch(ProtocolError const& err)
-        {
-            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
-        }
         catch(...)
         {
             internal_error_processing_request(client, "ServerDecoration::request_mode()");
@@ -267,6 +254,15 @@ void const* mw::ServerDecoration::Thunks::request_vtable[] {
     (void*)Thunks::release_thunk,
     (void*)Thunks::request_mode_thunk};
 
+mw::ServerDecoration* mw::ServerDecoration::from(struct wl_resource* resource)
+{
+    if (wl_resource_instance_of(resource, &org_kde_kwin_server_decoration_interface_data, ServerDecoration::Thunks::request_vtable))
+    {
+        return static_cast<ServerDecoration*>(wl_resource_get_user_data(resource));
+    }
+    return nullptr;
+}
+
 namespace mir
 {
 namespace wayland
@@ -394,3 +394,51 @@ TEST_F(StaticDisplayConfig, ill_formed_status_causes_AbnormalExit)
 
     EXPECT_THROW((sdc.load_config(ill_formed, "")), mir::AbnormalExit);
 }
+
+TEST_F(StaticDisplayConfig, adaptive_sync_is_enabled_where_supported_by_default)
+{
+    vga1.vrr_capable = true;
+
+    std::istringstream stream{
+        "layouts:\n"
+        "  default:\n"
+        "    cards:\n"
+        "    - VGA-1:\n"
+        "        orientation: normal\n"};
+
+    sdc.load_config(stream, "");
+    sdc.apply_to(dc);
+
+    EXPECT_THAT(vga1.vrr_enabled, Eq(true));
+    EXPECT_THAT(hdmi1.vrr_enabled, Eq(false));
+}
+
+TEST_F(StaticDisplayConfig, disabling_adaptive_sync_on_vga1_disables_it)
+{
+    vga1.vrr_capable = true;
+    vga1.vrr_enabled = true;
+
+    std::istringstream stream{
+        "layouts:\n"
+        "  default:\n"
+        "    cards:\n"
+        "    - VGA-1:\n"
+        "        adaptive-sync: disabled\n"};
+
+    sdc.load_config(stream, "");
+    sdc.apply_to(dc);
+
+    EXPECT_THAT(vga1.vrr_enabled, Eq(false));
+}
+
+TEST_F(StaticDisplayConfig, ill_formed_adaptive_sync_causes_AbnormalExit)
+{
+    std::istringstream ill_formed{
+        "layouts:\n"
+        "  default:\n"
+        "    cards:\n"
+        "    - HDMI-A-1:\n"
+        "        adaptive-sync: sometimes\n"};
+
+    EXPECT_THROW((sdc.load_config(ill_formed, "")), mir::AbnormalExit);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "xcursor_loader.h"
+
+#include <mir/graphics/cursor_image.h>
+#include <mir_test_framework/executable_path.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <stdlib.h>
+#include <string>
+
+namespace mtf = mir_test_framework;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+struct XCursorLoader : Test
+{
+    XCursorLoader()
+    {
+        // The XCursor code reads the search path once, so every test has to use the same one
+        setenv("XCURSOR_PATH", (mtf::test_data_path() + "/testing-cursor-theme").c_str(), true);
+    }
+
+    geom::Size const size{24, 24};
+};
+}
+
+TEST_F(XCursorLoader, loads_named_cursor_from_theme)
+{
+    miral::XCursorLoader loader{"default"};
+
+    auto const image = loader.image("blue", size);
+
+    ASSERT_THAT(image, NotNull());
+    EXPECT_THAT(image->size(), Eq(size));
+    EXPECT_THAT(image->as_argb_8888(), NotNull());
+}
+
+TEST_F(XCursorLoader, repeated_requests_share_one_image)
+{
+    miral::XCursorLoader loader{"default"};
+
+    auto const first = loader.image("blue", size);
+    auto const second = loader.image("blue", size);
+
+    EXPECT_THAT(first, NotNull());
+    EXPECT_THAT(second, Eq(first));
+}
+
+TEST_F(XCursorLoader, uses_closest_size_in_theme)
+{
+    miral::XCursorLoader loader{"default"};
+
+    auto const image = loader.image("blue", {48, 48});
+
+    ASSERT_THAT(image, NotNull());
+    EXPECT_THAT(image->size(), Eq(size));
+}
+
+TEST_F(XCursorLoader, falls_back_to_arrow_for_unknown_cursor)
+{
+    miral::XCursorLoader loader{"default"};
+
+    auto const arrow = loader.image("arrow", size);
+
+    EXPECT_THAT(arrow, NotNull());
+    EXPECT_THAT(loader.image("no-such-cursor", size), Eq(arrow));
+}
+
+TEST_F(XCursorLoader, still_finds_cursors_after_many_unknown_names)
+{
+    miral::XCursorLoader loader{"default"};
+
+    auto const arrow = loader.image("arrow", size);
+
+    for (auto i = 0; i != 1000; ++i)
+    {
+        EXPECT_THAT(loader.image("no-such-cursor-" + std::to_string(i), size), Eq(arrow));
+    }
+
+    EXPECT_THAT(loader.image("blue", size), NotNull());
+    EXPECT_THAT(loader.image("arrow", size), Eq(arrow));
+}
+
+TEST_F(XCursorLoader, does_not_look_outside_theme_for_cursor_names_with_paths)
+{
+    miral::XCursorLoader loader{"default"};
+
+    auto const arrow = loader.image("arrow", size);
+
+    EXPECT_THAT(loader.image("../cursors/blue", size), Eq(arrow));
+}
+
+TEST_F(XCursorLoader, missing_theme_has_no_images)
+{
+    miral::XCursorLoader loader{"no-such-theme"};
+
+    EXPECT_THAT(loader.image("arrow", size), IsNull());
+}
@@ -173,6 +173,15 @@ void SystemPerformanceTest::set_up_with(std::string const server_args)
     ASSERT_TRUE(wait_for_file((getenv("XDG_RUNTIME_DIR") + ("/" + mir_sock)).c_str(), 5s)) << server_cmd;
 }
 
+void SystemPerformanceTest::set_up_host_with(std::string const host_args, std::string const wayland_socket)
+{
+    auto const host_cmd = bin_dir+"/mir_demo_server "+host_args;
+    setenv("WAYLAND_DISPLAY", wayland_socket.c_str(), 1);
+
+    host_pid = spawn(host_cmd);
+    ASSERT_TRUE(wait_for_file((getenv("XDG_RUNTIME_DIR") + ("/" + wayland_socket)).c_str(), 5s)) << host_cmd;
+}
+
 void SystemPerformanceTest::TearDown()
 {
     for (auto const client_pid: client_pids)
@@ -180,6 +189,9 @@ void SystemPerformanceTest::TearDown()
 
     kill_nicely(server_pid);
     fclose(server_output);
+
+    if (host_pid)
+        kill_nicely(host_pid);
 }
 
 void SystemPerformanceTest::spawn_clients(std::initializer_list<std::string> clients)
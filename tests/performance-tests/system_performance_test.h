@@ -31,6 +31,8 @@ class SystemPerformanceTest : public testing::Test
 protected:
     SystemPerformanceTest();
     void set_up_with(std::string const server_args);
+    // Start a host server listening on wayland_socket (for the server under test to nest in)
+    void set_up_host_with(std::string const host_args, std::string const wayland_socket);
     void TearDown() override;
     void spawn_clients(std::initializer_list<std::string> clients);
     void run_server_for(std::chrono::seconds timeout);
@@ -39,6 +41,7 @@ protected:
 private:
     std::string const bin_dir;
     pid_t server_pid = 0;
+    pid_t host_pid = 0;
     std::vector<pid_t> client_pids;
 };
 
@@ -18,6 +18,8 @@
 
 #include "system_performance_test.h"
 
+#include <cstdlib>
+
 using namespace std::literals::chrono_literals;
 using namespace mir::test;
 
@@ -66,3 +68,83 @@ TEST_F(CompositorPerformance, regression_test_1563287)
     EXPECT_GE(compositor_fps, 0);
     EXPECT_GT(compositor_render_time, 0);
 }
+
+namespace
+{
+struct OffscreenRendererPerformance : CompositorPerformance, testing::WithParamInterface<char const*>
+{
+    void SetUp() override
+    {
+        compositor_fps = compositor_render_time = -1.0f;
+        // Without a GPU the GL renderer runs on llvmpipe; force that so the
+        // comparison is the same on any machine.
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+        SystemPerformanceTest::set_up_with(
+            std::string{"--compositor-report=log --offscreen --renderer="} + GetParam());
+    }
+
+    void TearDown() override
+    {
+        CompositorPerformance::TearDown();
+        unsetenv("LIBGL_ALWAYS_SOFTWARE");
+    }
+};
+}
+
+TEST_P(OffscreenRendererPerformance, throughput_with_shm_clients)
+{
+    spawn_clients({"mir_demo_client_wayland", "mir_demo_client_wayland",
+                   "mir_demo_client_wayland", "mir_demo_client_wayland"});
+    run_server_for(10s);
+
+    read_compositor_report();
+    RecordProperty("renderer", GetParam());
+    RecordProperty("framerate", std::to_string(compositor_fps));
+    RecordProperty("render_time", std::to_string(compositor_render_time));
+    // The clients animate continuously, so the compositor must have been producing frames
+    EXPECT_GT(compositor_fps, 1.0f);
+    EXPECT_GT(compositor_render_time, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Renderers, OffscreenRendererPerformance, testing::Values("gl", "software"));
+
+namespace
+{
+struct NestedPassthroughPerformance : CompositorPerformance, testing::WithParamInterface<bool>
+{
+    void SetUp() override
+    {
+        compositor_fps = compositor_render_time = -1.0f;
+        auto const host_socket = "mir_test_host_socket_"+std::to_string(getpid());
+        SystemPerformanceTest::set_up_host_with("--offscreen", host_socket);
+        SystemPerformanceTest::set_up_with(
+            "--compositor-report=log --wayland-host=" + host_socket +
+            " --wayland-host-passthrough=" + (GetParam() ? "true" : "false"));
+    }
+};
+}
+
+TEST_P(NestedPassthroughPerformance, throughput_with_shm_clients)
+{
+    spawn_clients({"mir_demo_client_wayland", "mir_demo_client_wayland",
+                   "mir_demo_client_wayland", "mir_demo_client_wayland"});
+    run_server_for(10s);
+
+    read_compositor_report();
+    RecordProperty("passthrough", GetParam() ? "true" : "false");
+    RecordProperty("framerate", std::to_string(compositor_fps));
+    RecordProperty("render_time", std::to_string(compositor_render_time));
+    // The clients animate continuously, so the compositor must have been producing frames
+    EXPECT_GT(compositor_fps, 1.0f);
+    // ...but those the host shows entirely as subsurfaces take no rendering
+    if (GetParam())
+    {
+        EXPECT_GE(compositor_render_time, 0);
+    }
+    else
+    {
+        EXPECT_GT(compositor_render_time, 0);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Passthrough, NestedPassthroughPerformance, testing::Bool());
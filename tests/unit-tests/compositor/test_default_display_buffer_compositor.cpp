@@ -20,6 +20,8 @@
 #include "mir/compositor/display_buffer_compositor.h"
 #include "src/server/report/null_report_factory.h"
 #include "mir/compositor/scene.h"
+#include "mir/graphics/direct_scanout.h"
+#include "mir/graphics/partial_overlay.h"
 #include "mir/renderer/renderer.h"
 #include "mir/geometry/rectangle.h"
 #include "mir/test/doubles/mock_renderer.h"
@@ -109,6 +111,16 @@ struct DefaultDisplayBufferCompositor : public testing::Test
     std::shared_ptr<mtd::FakeRenderable> big;
     std::shared_ptr<mtd::FakeRenderable> fullscreen;
 };
+
+struct MockScanoutDisplayBuffer : mtd::MockDisplayBuffer, mg::DirectScanout
+{
+    MOCK_METHOD1(scanout, bool(std::shared_ptr<mg::Renderable> const&));
+};
+
+struct MockPartialOverlayDisplayBuffer : mtd::MockDisplayBuffer, mg::PartialOverlay
+{
+    MOCK_METHOD1(overlay_top_of, bool(mg::RenderableList&));
+};
 }
 
 TEST_F(DefaultDisplayBufferCompositor, render)
@@ -388,3 +400,110 @@ TEST_F(DefaultDisplayBufferCompositor, marks_occluded_scene_elements)
     compositor.composite({element0_occluded, element1_rendered, element2_occluded});
 }
 
+
+TEST_F(DefaultDisplayBufferCompositor, scans_out_fullscreen_renderable_without_rendering)
+{
+    using namespace testing;
+    NiceMock<MockScanoutDisplayBuffer> scanout_display_buffer;
+    ON_CALL(scanout_display_buffer, view_area())
+        .WillByDefault(Return(screen));
+
+    EXPECT_CALL(scanout_display_buffer, scanout(Eq(fullscreen)))
+        .WillOnce(Return(true));
+    EXPECT_CALL(scanout_display_buffer, overlay(_))
+        .Times(0);
+    EXPECT_CALL(mock_renderer, suspend());
+    EXPECT_CALL(mock_renderer, render(_))
+        .Times(0);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        scanout_display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({small, fullscreen}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, renders_when_scanout_is_refused)
+{
+    using namespace testing;
+    NiceMock<MockScanoutDisplayBuffer> scanout_display_buffer;
+    ON_CALL(scanout_display_buffer, view_area())
+        .WillByDefault(Return(screen));
+    ON_CALL(scanout_display_buffer, overlay(_))
+        .WillByDefault(Return(false));
+
+    EXPECT_CALL(scanout_display_buffer, scanout(Eq(fullscreen)))
+        .WillOnce(Return(false));
+    EXPECT_CALL(mock_renderer, render(ElementsAre(fullscreen)));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        scanout_display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({fullscreen}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, does_not_offer_partly_covered_surface_for_scanout)
+{
+    using namespace testing;
+    NiceMock<MockScanoutDisplayBuffer> scanout_display_buffer;
+    ON_CALL(scanout_display_buffer, view_area())
+        .WillByDefault(Return(screen));
+
+    EXPECT_CALL(scanout_display_buffer, scanout(_))
+        .Times(0);
+    EXPECT_CALL(mock_renderer, render(ElementsAre(fullscreen, small)));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        scanout_display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({fullscreen, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, renders_only_what_a_partial_overlay_leaves)
+{
+    using namespace testing;
+    NiceMock<MockPartialOverlayDisplayBuffer> overlay_display_buffer;
+    ON_CALL(overlay_display_buffer, view_area())
+        .WillByDefault(Return(screen));
+
+    EXPECT_CALL(overlay_display_buffer, overlay(_))
+        .Times(0);
+    EXPECT_CALL(overlay_display_buffer, overlay_top_of(ElementsAre(big, small)))
+        .WillOnce(DoAll(
+            Invoke([this](mg::RenderableList& renderlist) { renderlist = {big}; }),
+            Return(false)));
+    EXPECT_CALL(mock_renderer, render(ElementsAre(big)));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        overlay_display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, does_not_render_when_a_partial_overlay_shows_everything)
+{
+    using namespace testing;
+    NiceMock<MockPartialOverlayDisplayBuffer> overlay_display_buffer;
+    ON_CALL(overlay_display_buffer, view_area())
+        .WillByDefault(Return(screen));
+
+    EXPECT_CALL(overlay_display_buffer, overlay_top_of(ElementsAre(big, small)))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_renderer, suspend());
+    EXPECT_CALL(mock_renderer, render(_))
+        .Times(0);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        overlay_display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/frame_timeline.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct FrameTimeline : Test
+{
+    auto at(std::chrono::milliseconds ms) -> mc::FrameTimeline::Clock::time_point
+    {
+        return mc::FrameTimeline::Clock::time_point{} + 1h + ms;
+    }
+
+    mc::FrameTimeline timeline;
+    int const output{0};
+    int const other_output{0};
+    mg::BufferID const buffer{1};
+    mg::BufferID const other_buffer{2};
+};
+}
+
+TEST_F(FrameTimeline, records_each_stage_of_a_frame)
+{
+    timeline.committed(buffer, at(0ms));
+    timeline.acquired(&output, buffer, at(2ms));
+    timeline.composited(&output, at(5ms));
+    timeline.presented(&output, at(16ms));
+
+    auto const statistics = timeline.statistics();
+
+    EXPECT_THAT(statistics.frames_committed, Eq(1u));
+    EXPECT_THAT(statistics.frames_presented, Eq(1u));
+    EXPECT_THAT(statistics.frames_missed, Eq(0u));
+    ASSERT_THAT(statistics.recent_frames, SizeIs(1));
+    EXPECT_THAT(statistics.recent_frames[0].committed, Eq(at(0ms)));
+    EXPECT_THAT(statistics.recent_frames[0].acquired, Eq(at(2ms)));
+    EXPECT_THAT(statistics.recent_frames[0].composited, Eq(at(5ms)));
+    EXPECT_THAT(statistics.recent_frames[0].presented, Eq(at(16ms)));
+}
+
+TEST_F(FrameTimeline, keeps_the_first_time_each_stage_was_reached)
+{
+    timeline.committed(buffer, at(0ms));
+    timeline.acquired(&output, buffer, at(2ms));
+    timeline.composited(&output, at(5ms));
+    timeline.presented(&output, at(16ms));
+
+    // The same buffer shown again, and on another output
+    timeline.acquired(&output, buffer, at(18ms));
+    timeline.composited(&output, at(20ms));
+    timeline.presented(&output, at(32ms));
+    timeline.acquired(&other_output, buffer, at(19ms));
+    timeline.composited(&other_output, at(21ms));
+    timeline.presented(&other_output, at(33ms));
+
+    auto const statistics = timeline.statistics();
+
+    EXPECT_THAT(statistics.frames_presented, Eq(1u));
+    ASSERT_THAT(statistics.recent_frames, SizeIs(1));
+    EXPECT_THAT(statistics.recent_frames[0].acquired, Eq(at(2ms)));
+    EXPECT_THAT(statistics.recent_frames[0].composited, Eq(at(5ms)));
+    EXPECT_THAT(statistics.recent_frames[0].presented, Eq(at(16ms)));
+}
+
+TEST_F(FrameTimeline, counts_frames_replaced_before_they_were_acquired_as_missed)
+{
+    timeline.committed(buffer, at(0ms));
+    timeline.committed(other_buffer, at(4ms));
+    timeline.committed(mg::BufferID{3}, at(8ms));
+    timeline.acquired(&output, mg::BufferID{3}, at(10ms));
+
+    auto const statistics = timeline.statistics();
+
+    EXPECT_THAT(statistics.frames_missed, Eq(2u));
+    ASSERT_THAT(statistics.recent_frames, SizeIs(3));
+    EXPECT_THAT(statistics.recent_frames[0].acquired, Eq(mc::FrameTimeline::Clock::time_point{}));
+    EXPECT_THAT(statistics.recent_frames[2].acquired, Eq(at(10ms)));
+}
+
+TEST_F(FrameTimeline, matches_a_reused_buffer_to_its_latest_commit)
+{
+    timeline.committed(buffer, at(0ms));
+    timeline.acquired(&output, buffer, at(2ms));
+    timeline.committed(buffer, at(16ms));
+    timeline.acquired(&output, buffer, at(18ms));
+
+    auto const statistics = timeline.statistics();
+
+    ASSERT_THAT(statistics.recent_frames, SizeIs(2));
+    EXPECT_THAT(statistics.recent_frames[0].acquired, Eq(at(2ms)));
+    EXPECT_THAT(statistics.recent_frames[1].acquired, Eq(at(18ms)));
+}
+
+TEST_F(FrameTimeline, does_not_present_a_frame_that_was_not_composited)
+{
+    timeline.committed(buffer, at(0ms));
+    timeline.acquired(&output, buffer, at(2ms));
+    timeline.presented(&output, at(16ms));
+
+    auto const statistics = timeline.statistics();
+
+    EXPECT_THAT(statistics.frames_presented, Eq(0u));
+    EXPECT_THAT(statistics.recent_frames[0].presented, Eq(mc::FrameTimeline::Clock::time_point{}));
+}
+
+TEST_F(FrameTimeline, keeps_only_the_most_recent_frames)
+{
+    auto const frames = mc::FrameTimeline::capacity + 10;
+    for (auto i = 0u; i != frames; ++i)
+    {
+        timeline.committed(mg::BufferID{i % 3 + 1}, at(std::chrono::milliseconds(i)));
+    }
+
+    auto const statistics = timeline.statistics();
+
+    EXPECT_THAT(statistics.frames_committed, Eq(frames));
+    ASSERT_THAT(statistics.recent_frames, SizeIs(mc::FrameTimeline::capacity));
+    EXPECT_THAT(statistics.recent_frames.front().committed, Eq(at(10ms)));
+    EXPECT_THAT(statistics.recent_frames.back().committed, Eq(at(std::chrono::milliseconds(frames - 1))));
+}
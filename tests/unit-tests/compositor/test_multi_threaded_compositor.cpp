@@ -23,10 +23,13 @@
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/compositor/scene.h"
 #include "mir/compositor/display_buffer_compositor_factory.h"
+#include "mir/compositor/presentation_clock.h"
 #include "mir/scene/observer.h"
 #include "mir/raii.h"
+#include "mir/time/steady_clock.h"
 
 #include "mir/test/current_thread_name.h"
+#include "mir/test/signal.h"
 #include "mir/test/doubles/null_display.h"
 #include "mir/test/doubles/null_display_buffer.h"
 #include "mir/test/doubles/mock_display_buffer.h"
@@ -34,10 +37,13 @@
 #include "mir/test/doubles/mock_scene.h"
 #include "mir/test/doubles/stub_scene.h"
 #include "mir/test/doubles/stub_display.h"
+#include "mir/test/doubles/fake_display.h"
 #include "mir/test/doubles/null_display_buffer_compositor_factory.h"
 
 #include <boost/throw_exception.hpp>
 
+#include <atomic>
+#include <future>
 #include <unordered_map>
 #include <unordered_set>
 #include <thread>
@@ -264,6 +270,14 @@ public:
         return true;
     }
 
+    unsigned int record_count_for(mg::DisplayBuffer& display_buffer)
+    {
+        std::lock_guard<std::mutex> lk{m};
+
+        auto const record = records.find(&display_buffer);
+        return record == records.end() ? 0 : record->second.first;
+    }
+
 private:
     std::mutex m;
     typedef std::pair<unsigned int, std::unordered_set<std::thread::id>> Record;
@@ -360,6 +374,7 @@ struct MockDisplayListener : mc::DisplayListener
 };
 
 auto const null_report = mr::null_compositor_report();
+auto const presentation_clock = std::make_shared<mc::PresentationClock>(std::make_shared<mir::time::SteadyClock>());
 unsigned int const composites_per_update{1};
 auto const null_display_listener = std::make_shared<StubDisplayListener>();
 std::chrono::milliseconds const default_delay{-1};
@@ -375,7 +390,7 @@ TEST(MultiThreadedCompositor, compositing_happens_in_different_threads)
     auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, presentation_clock, default_delay, true};
 
     compositor.start();
 
@@ -388,6 +403,86 @@ TEST(MultiThreadedCompositor, compositing_happens_in_different_threads)
     EXPECT_TRUE(db_compositor_factory->buffers_rendered_in_different_threads());
 }
 
+TEST(MultiThreadedCompositor, untouched_outputs_keep_compositing_while_another_output_is_reconfigured)
+{
+    using namespace testing;
+
+    geom::Rectangle const untouched_area{{0, 0}, {640, 480}};
+    geom::Rectangle const moved_area{{640, 0}, {640, 480}};
+    geom::Point const moved_to{640, 480};
+    unsigned int const frames_during_change{10};
+
+    auto display = std::make_shared<mtd::FakeDisplay>(std::vector<geom::Rectangle>{untouched_area, moved_area});
+    auto scene = std::make_shared<StubScene>();
+    auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, presentation_clock, default_delay, true};
+
+    auto const buffer_at = [&](geom::Point top_left)
+        {
+            mg::DisplayBuffer* found{nullptr};
+            display->for_each_display_sync_group([&](mg::DisplaySyncGroup& group)
+                {
+                    group.for_each_display_buffer([&](mg::DisplayBuffer& buffer)
+                        {
+                            if (buffer.view_area().top_left == top_left)
+                                found = &buffer;
+                        });
+                });
+            return found;
+        };
+
+    compositor.start();
+    // Keep every output compositing continuously
+    scene->set_pending(1);
+
+    auto const untouched_buffer = buffer_at(untouched_area.top_left);
+    ASSERT_THAT(untouched_buffer, NotNull());
+
+    auto const conf = display->configuration();
+    conf->for_each_output([&](mg::UserDisplayConfigurationOutput& output)
+        {
+            if (output.top_left == moved_area.top_left)
+                output.top_left = moved_to;
+        });
+
+    auto const deadline = std::chrono::steady_clock::now() + 10s;
+    unsigned int invalidated_groups{0};
+
+    display->configure_incrementally(*conf, [&](mg::DisplaySyncGroup& group)
+        {
+            ++invalidated_groups;
+            compositor.stop_compositing_to(group);
+
+            // The untouched output must keep presenting while the change is in progress
+            auto const frames_before = db_compositor_factory->record_count_for(*untouched_buffer);
+            while (db_compositor_factory->record_count_for(*untouched_buffer) < frames_before + frames_during_change &&
+                   std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::yield();
+            }
+            EXPECT_THAT(
+                db_compositor_factory->record_count_for(*untouched_buffer),
+                Ge(frames_before + frames_during_change));
+        });
+
+    compositor.start_compositing_to_new_groups();
+
+    EXPECT_THAT(invalidated_groups, Eq(1u));
+    EXPECT_THAT(buffer_at(untouched_area.top_left), Eq(untouched_buffer));
+
+    auto const moved_buffer = buffer_at(moved_to);
+    ASSERT_THAT(moved_buffer, NotNull());
+
+    while (db_compositor_factory->record_count_for(*moved_buffer) == 0 &&
+           std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+    EXPECT_THAT(db_compositor_factory->record_count_for(*moved_buffer), Gt(0u));
+
+    compositor.stop();
+}
+
 TEST(MultiThreadedCompositor, does_not_deadlock_itself)
 {   // Regression test for LP: #1471909
     auto scene = std::make_shared<StubScene>();
@@ -416,6 +511,7 @@ TEST(MultiThreadedCompositor, does_not_deadlock_itself)
         std::make_shared<mtd::NullDisplayBufferCompositorFactory>(),
         std::make_shared<ReentrantDisplayListener>(scene),
         null_report,
+        presentation_clock,
         default_delay,
         true
     };
@@ -441,6 +537,7 @@ TEST(MultiThreadedCompositor, reports_in_the_right_places)
                                            db_compositor_factory,
                                            null_display_listener,
                                            mock_report,
+                                           presentation_clock,
                                            default_delay,
                                            true};
 
@@ -486,7 +583,7 @@ TEST(MultiThreadedCompositor, composites_only_on_demand)
     auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, presentation_clock, default_delay, true};
 
     // Verify we're actually starting at zero frames
     EXPECT_TRUE(db_compositor_factory->check_record_count_for_each_buffer(nbuffers, 0, 0));
@@ -547,7 +644,7 @@ TEST(MultiThreadedCompositor, schedules_enough_frames)
     auto scene = std::make_shared<StubScene>();
     auto factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
     mc::MultiThreadedCompositor compositor{display, scene, factory,
-                                           null_display_listener, null_report, default_delay, true};
+                                           null_display_listener, null_report, presentation_clock, default_delay, true};
 
     EXPECT_TRUE(factory->check_record_count_for_each_buffer(nbuffers, 0, 0));
 
@@ -623,6 +720,7 @@ TEST(MultiThreadedCompositor, recommended_sleep_throttles_compositor_loop)
     auto factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
     mc::MultiThreadedCompositor compositor{display, scene, factory,
                                            null_display_listener, null_report,
+                                           presentation_clock,
                                            recommendation, false};
 
     EXPECT_TRUE(factory->check_record_count_for_each_buffer(nbuffers, 0, 0));
@@ -671,7 +769,7 @@ TEST(MultiThreadedCompositor, when_no_initial_composite_is_needed_there_is_none)
     auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, false};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, presentation_clock, default_delay, false};
 
     // Verify we're actually starting at zero frames
     ASSERT_TRUE(db_compositor_factory->check_record_count_for_each_buffer(nbuffers, 0, 0));
@@ -694,7 +792,7 @@ TEST(MultiThreadedCompositor, when_no_initial_composite_is_needed_we_still_compo
     auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, false};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, presentation_clock, default_delay, false};
 
     compositor.start();
 
@@ -729,7 +827,7 @@ TEST(MultiThreadedCompositor, surface_update_from_render_doesnt_deadlock)
     auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<SurfaceUpdatingDisplayBufferCompositorFactory>(scene);
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, presentation_clock, default_delay, true};
 
     compositor.start();
 
@@ -761,7 +859,7 @@ TEST(MultiThreadedCompositor, double_start_or_stop_ignored)
         .Times(AtLeast(0))
         .WillRepeatedly(Return(mc::SceneElementSequence{}));
 
-    mc::MultiThreadedCompositor compositor{display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, mock_scene, db_compositor_factory, null_display_listener, mock_report, presentation_clock, default_delay, true};
 
     compositor.start();
     compositor.start();
@@ -769,6 +867,35 @@ TEST(MultiThreadedCompositor, double_start_or_stop_ignored)
     compositor.stop();
 }
 
+TEST(MultiThreadedCompositor, tells_the_scene_when_each_compositors_frame_is_posted)
+{
+    using namespace testing;
+
+    unsigned int const nbuffers{3};
+    auto display = std::make_shared<StubDisplayWithMockBuffers>(nbuffers);
+    auto mock_scene = std::make_shared<NiceMock<mtd::MockScene>>();
+    auto db_compositor_factory = std::make_shared<mtd::NullDisplayBufferCompositorFactory>();
+
+    std::mutex mutex;
+    std::unordered_set<mc::CompositorID> posted;
+    mt::Signal all_posted;
+
+    ON_CALL(*mock_scene, frame_presented(_))
+        .WillByDefault(Invoke([&](mc::CompositorID id)
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                posted.insert(id);
+                if (posted.size() == nbuffers)
+                    all_posted.raise();
+            }));
+
+    mc::MultiThreadedCompositor compositor{display, mock_scene, db_compositor_factory, null_display_listener, null_report, presentation_clock, default_delay, true};
+
+    compositor.start();
+    EXPECT_TRUE(all_posted.wait_for(std::chrono::seconds{5}));
+    compositor.stop();
+}
+
 TEST(MultiThreadedCompositor, cleans_up_after_throw_in_start)
 {
     unsigned int const nbuffers{3};
@@ -776,7 +903,7 @@ TEST(MultiThreadedCompositor, cleans_up_after_throw_in_start)
     auto display = std::make_shared<StubDisplayWithMockBuffers>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, presentation_clock, default_delay, true};
 
     scene->throw_on_add_observer(true);
 
@@ -830,7 +957,7 @@ TEST(MultiThreadedCompositor, DISABLED_names_compositor_threads)
     auto display = std::make_shared<StubDisplayWithMockBuffers>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<ThreadNameDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, presentation_clock, default_delay, true};
 
     compositor.start();
 
@@ -859,7 +986,7 @@ TEST(MultiThreadedCompositor, registers_and_unregisters_with_scene)
     EXPECT_CALL(*mock_scene, register_compositor(_))
         .Times(nbuffers);
     mc::MultiThreadedCompositor compositor{
-        display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true};
+        display, mock_scene, db_compositor_factory, null_display_listener, mock_report, presentation_clock, default_delay, true};
 
     compositor.start();
 
@@ -882,7 +1009,7 @@ TEST(MultiThreadedCompositor, notifies_about_display_additions_and_removals)
     auto mock_report = std::make_shared<testing::NiceMock<mtd::MockCompositorReport>>();
 
     mc::MultiThreadedCompositor compositor{
-        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true};
+        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, presentation_clock, default_delay, true};
 
     EXPECT_CALL(*mock_display_listener, add_display(_)).Times(nbuffers);
 
@@ -904,7 +1031,7 @@ TEST(MultiThreadedCompositor, when_compositor_thread_fails_start_reports_error)
     auto mock_report = std::make_shared<testing::NiceMock<mtd::MockCompositorReport>>();
 
     mc::MultiThreadedCompositor compositor{
-        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true};
+        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, presentation_clock, default_delay, true};
 
     EXPECT_CALL(*mock_display_listener, add_display(_))
         .WillRepeatedly(Throw(std::runtime_error("Failed to add display")));
@@ -927,7 +1054,7 @@ TEST(MultiThreadedCompositor, can_schedule_from_display_observer_when_adding_dis
         .WillByDefault(InvokeWithoutArgs([&]{ stub_scene->emit_change_event(); }));
 
     mc::MultiThreadedCompositor compositor{
-        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true};
+        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, presentation_clock, default_delay, true};
     compositor.start();
 }
 
@@ -945,6 +1072,49 @@ TEST(MultiThreadedCompositor, can_schedule_from_display_observer_when_removing_d
         .WillByDefault(InvokeWithoutArgs([&]{ stub_scene->emit_change_event(); }));
 
     mc::MultiThreadedCompositor compositor{
-        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true};
+        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, presentation_clock, default_delay, true};
     compositor.start();
 }
+
+TEST(MultiThreadedCompositor, stop_waits_for_a_sync_group_being_stopped_concurrently)
+{
+    using namespace testing;
+    unsigned int const nbuffers{2};
+    auto display = std::make_shared<StubDisplayWithMockBuffers>(nbuffers);
+    auto stub_scene = std::make_shared<NiceMock<StubScene>>();
+    auto mock_display_listener = std::make_shared<NiceMock<MockDisplayListener>>();
+    auto db_compositor_factory = std::make_shared<mtd::NullDisplayBufferCompositorFactory>();
+
+    mt::Signal group_stopping;
+    mt::Signal finish_stopping_group;
+    std::atomic<bool> first_removal{true};
+
+    // A sync group's thread tells the listener its display is gone as it finishes
+    ON_CALL(*mock_display_listener, remove_display(_))
+        .WillByDefault(InvokeWithoutArgs([&]
+            {
+                if (first_removal.exchange(false))
+                {
+                    group_stopping.raise();
+                    finish_stopping_group.wait_for(10s);
+                }
+            }));
+
+    mc::MultiThreadedCompositor compositor{
+        display, stub_scene, db_compositor_factory, mock_display_listener, null_report, presentation_clock, default_delay, true};
+    compositor.start();
+
+    mg::DisplaySyncGroup* group{nullptr};
+    display->for_each_display_sync_group([&](mg::DisplaySyncGroup& g) { if (!group) group = &g; });
+
+    auto const stopped_group = std::async(std::launch::async, [&] { compositor.stop_compositing_to(*group); });
+    ASSERT_TRUE(group_stopping.wait_for(10s));
+
+    auto const stopped = std::async(std::launch::async, [&] { compositor.stop(); });
+
+    EXPECT_THAT(stopped.wait_for(100ms), Eq(std::future_status::timeout));
+
+    finish_stopping_group.raise();
+    stopped_group.wait();
+    stopped.wait();
+}
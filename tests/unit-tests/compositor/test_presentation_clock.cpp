@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/compositor/presentation_clock.h"
+
+#include "mir/test/doubles/advanceable_clock.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mc = mir::compositor;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct PresentationClock : Test
+{
+    std::shared_ptr<mtd::AdvanceableClock> const clock{std::make_shared<mtd::AdvanceableClock>()};
+    mc::PresentationClock presentation_clock{clock};
+    int const output{0};
+    int const other_output{0};
+};
+}
+
+TEST_F(PresentationClock, predicts_nothing_before_the_first_frame)
+{
+    EXPECT_FALSE(presentation_clock.next_frame().is_set());
+}
+
+TEST_F(PresentationClock, initially_assumes_sixty_hertz)
+{
+    presentation_clock.frame_posted(&output);
+    auto const posted = clock->now();
+
+    clock->advance_by(5ms);
+
+    ASSERT_TRUE(presentation_clock.next_frame().is_set());
+    EXPECT_THAT(presentation_clock.next_frame().value() - posted, Eq(std::chrono::nanoseconds{16666667}));
+}
+
+TEST_F(PresentationClock, learns_the_refresh_period)
+{
+    for (auto frame = 0; frame != 100; ++frame)
+    {
+        presentation_clock.frame_posted(&output);
+        clock->advance_by(10ms);
+    }
+
+    clock->advance_by(-7ms);
+    auto const next = presentation_clock.next_frame();
+
+    ASSERT_TRUE(next.is_set());
+    EXPECT_THAT(next.value() - clock->now(), AllOf(Gt(6ms), Lt(8ms)));
+}
+
+TEST_F(PresentationClock, treats_a_missed_refresh_as_two_periods)
+{
+    for (auto frame = 0; frame != 10; ++frame)
+    {
+        presentation_clock.frame_posted(&output);
+        clock->advance_by(frame % 2 ? 33333333ns : 16666667ns);
+    }
+
+    presentation_clock.frame_posted(&output);
+    auto const posted = clock->now();
+
+    EXPECT_THAT(presentation_clock.next_frame().value() - posted, AllOf(Gt(16ms), Lt(17ms)));
+}
+
+TEST_F(PresentationClock, stops_predicting_when_frames_stop)
+{
+    presentation_clock.frame_posted(&output);
+    clock->advance_by(100ms);
+
+    EXPECT_FALSE(presentation_clock.next_frame().is_set());
+}
+
+TEST_F(PresentationClock, predicts_the_earliest_frame_of_all_outputs)
+{
+    presentation_clock.frame_posted(&output);
+    auto const posted = clock->now();
+    clock->advance_by(10ms);
+    presentation_clock.frame_posted(&other_output);
+    auto const other_posted = clock->now();
+    clock->advance_by(1ms);
+
+    EXPECT_THAT(presentation_clock.next_frame().value() - posted, Eq(std::chrono::nanoseconds{16666667}));
+
+    presentation_clock.source_removed(&output);
+
+    EXPECT_THAT(presentation_clock.next_frame().value() - other_posted, Eq(std::chrono::nanoseconds{16666667}));
+}
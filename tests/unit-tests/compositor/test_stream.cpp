@@ -241,3 +241,72 @@ TEST_F(Stream, stream_remembers_scale_when_buffer_added)
     stream.submit_buffer(buffers[0]);
     ASSERT_THAT(stream.stream_size(), Eq(initial_size / 2));
 }
+
+TEST_F(Stream, viewport_size_overrides_scaled_buffer_size)
+{
+    geom::Size const viewport_size{3840, 2160};
+    stream.submit_buffer(buffers[0]);
+    stream.set_scale(2.0f);
+    stream.set_viewport({}, viewport_size);
+    EXPECT_THAT(stream.stream_size(), Eq(viewport_size));
+
+    stream.set_viewport({}, {});
+    EXPECT_THAT(stream.stream_size(), Eq(initial_size / 2));
+}
+
+TEST_F(Stream, reports_the_texture_bounds_each_buffer_was_submitted_with)
+{
+    mg::TextureBounds const bounds{0.25f, 0.0f, 0.75f, 1.0f};
+    stream.submit_buffer(buffers[0]);
+    stream.set_viewport(bounds, {});
+    stream.submit_buffer(buffers[1]);
+
+    EXPECT_THAT(stream.texture_bounds(*buffers[0]), Eq(mg::TextureBounds{}));
+    EXPECT_THAT(stream.texture_bounds(*buffers[1]), Eq(bounds));
+}
+
+TEST_F(Stream, resubmitted_buffer_takes_the_current_texture_bounds)
+{
+    mg::TextureBounds const bounds{0.25f, 0.0f, 0.75f, 1.0f};
+    stream.set_viewport(bounds, {});
+    stream.submit_buffer(buffers[0]);
+    stream.set_viewport({}, {});
+    stream.submit_buffer(buffers[0]);
+
+    EXPECT_THAT(stream.texture_bounds(*buffers[0]), Eq(mg::TextureBounds{}));
+}
+
+TEST_F(Stream, records_the_timing_of_each_frame)
+{
+    for (auto& buffer : buffers)
+        stream.submit_buffer(buffer);
+
+    stream.lock_compositor_buffer(this);
+    stream.frame_composited(this);
+    stream.frame_presented(this);
+
+    auto const statistics = stream.frame_statistics();
+
+    EXPECT_THAT(statistics.frames_committed, Eq(buffers.size()));
+    EXPECT_THAT(statistics.frames_presented, Eq(1u));
+    EXPECT_THAT(statistics.queued_buffers, Eq(buffers.size() - 1));
+    ASSERT_THAT(statistics.recent_frames, SizeIs(buffers.size()));
+
+    auto const& first = statistics.recent_frames.front();
+    EXPECT_THAT(first.acquired, Ge(first.committed));
+    EXPECT_THAT(first.composited, Ge(first.acquired));
+    EXPECT_THAT(first.presented, Ge(first.composited));
+    EXPECT_THAT(statistics.recent_frames.back().acquired, Eq(std::chrono::steady_clock::time_point{}));
+}
+
+TEST_F(Stream, counts_frames_dropped_before_compositing_as_missed)
+{
+    stream.allow_framedropping(true);
+
+    for (auto& buffer : buffers)
+        stream.submit_buffer(buffer);
+
+    stream.lock_compositor_buffer(this);
+
+    EXPECT_THAT(stream.frame_statistics().frames_missed, Eq(buffers.size() - 1));
+}
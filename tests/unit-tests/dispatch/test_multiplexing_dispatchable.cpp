@@ -490,3 +490,64 @@ TEST(MultiplexingDispatchableTest, automatic_removals_are_threadsafe)
     
     dispatchee->trigger();
 }
+
+TEST(MultiplexingDispatchableTest, dispatches_several_ready_dispatchees_in_one_call)
+{
+    int dispatch_count{0};
+    std::vector<std::shared_ptr<mt::TestDispatchable>> dispatchees;
+    md::MultiplexingDispatchable dispatcher;
+
+    for (int i = 0; i != 3; ++i)
+    {
+        dispatchees.push_back(std::make_shared<mt::TestDispatchable>([&dispatch_count]() { ++dispatch_count; }));
+        dispatcher.add_watch(dispatchees.back());
+        dispatchees.back()->trigger();
+    }
+
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatch_count, testing::Eq(3));
+    EXPECT_FALSE(mt::fd_is_readable(dispatcher.watch_fd()));
+}
+
+TEST(MultiplexingDispatchableTest, another_thread_dispatches_the_rest_of_a_batch)
+{
+    using namespace testing;
+
+    auto a_dispatched = std::make_shared<mt::Signal>();
+    auto b_dispatched = std::make_shared<mt::Signal>();
+    std::atomic<int> unblocked{0};
+
+    // Each dispatchee blocks until the other has been dispatched, so whichever
+    // thread collects both must leave one for the other thread.
+    auto dispatchee_a = std::make_shared<mt::TestDispatchable>([a_dispatched, b_dispatched, &unblocked]()
+    {
+        a_dispatched->raise();
+        if (b_dispatched->wait_for(std::chrono::seconds{5}))
+            ++unblocked;
+    });
+    auto dispatchee_b = std::make_shared<mt::TestDispatchable>([a_dispatched, b_dispatched, &unblocked]()
+    {
+        b_dispatched->raise();
+        if (a_dispatched->wait_for(std::chrono::seconds{5}))
+            ++unblocked;
+    });
+
+    auto dispatcher = std::make_shared<md::MultiplexingDispatchable>();
+    dispatcher->add_watch(dispatchee_a);
+    dispatcher->add_watch(dispatchee_b);
+
+    dispatchee_a->trigger();
+    dispatchee_b->trigger();
+
+    {
+        md::ThreadedDispatcher eventloop{"Battenberg", dispatcher};
+        eventloop.add_thread();
+
+        EXPECT_TRUE(a_dispatched->wait_for(std::chrono::seconds{5}));
+        EXPECT_TRUE(b_dispatched->wait_for(std::chrono::seconds{5}));
+    }
+
+    EXPECT_THAT(unblocked, Eq(2));
+}
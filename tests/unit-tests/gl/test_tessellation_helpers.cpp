@@ -147,3 +147,20 @@ TEST_F(Tessellation, tex_coords_0_or_1_when_transformed)
     mgl::Primitive const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {x, y});
     expect_tex_coords_1_or_0(primitive);
 }
+
+TEST_F(Tessellation, tex_coords_match_texture_bounds)
+{
+    mir::graphics::TextureBounds const bounds{0.25f, 0.125f, 0.75f, 0.5f};
+    ON_CALL(renderable, texture_bounds())
+        .WillByDefault(testing::Return(bounds));
+    mgl::Primitive const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {});
+
+    for (int i = 0; i < primitive.nvertices; i++)
+    {
+        auto const& vertex = primitive.vertices[i];
+        bool const is_left = vertex.position[0] == rect.left().as_int();
+        bool const is_top = vertex.position[1] == rect.top().as_int();
+        EXPECT_THAT(vertex.texcoord[0], Eq(is_left ? bounds.left : bounds.right)) << "for i = " << i;
+        EXPECT_THAT(vertex.texcoord[1], Eq(is_top ? bounds.top : bounds.bottom)) << "for i = " << i;
+    }
+}
@@ -1,17 +1,23 @@
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/direct_scanout.h"
 
 #include "src/server/graphics/offscreen/display.h"
+#include "src/server/graphics/offscreen/display_buffer.h"
 #include "mir/graphics/default_display_configuration_policy.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
 #include "src/server/report/null_report_factory.h"
 
 #include "mir/test/doubles/mock_egl.h"
 #include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
 #include "mir/test/as_render_target.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace mg=mir::graphics;
@@ -19,6 +25,8 @@ namespace mgo=mir::graphics::offscreen;
 namespace mtd=mir::test::doubles;
 namespace mr = mir::report;
 namespace mt = mir::test;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
 
 namespace
 {
@@ -173,3 +181,138 @@ TEST_F(OffscreenDisplayTest, restores_previous_state_on_fbo_setup_failure)
             mr::null_display_report());
     }, std::runtime_error);
 }
+
+TEST_F(OffscreenDisplayTest, scans_out_buffer_of_the_output_size_in_place_of_rendering)
+{
+    using namespace ::testing;
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report()};
+
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            auto const scanout = dynamic_cast<mg::DirectScanout*>(&db);
+            ASSERT_THAT(scanout, NotNull());
+
+            auto const renderable = std::make_shared<mtd::FakeRenderable>(db.view_area());
+            auto const buffer = std::make_shared<mtd::StubBuffer>(db.view_area().size);
+            renderable->set_buffer(buffer);
+
+            EXPECT_TRUE(scanout->scanout(renderable));
+            EXPECT_THAT(dynamic_cast<mgo::DisplayBuffer&>(db).scanout_buffer(), Eq(buffer));
+
+            // Rendering the next frame replaces it
+            mt::as_render_target(db)->swap_buffers();
+            EXPECT_THAT(dynamic_cast<mgo::DisplayBuffer&>(db).scanout_buffer(), IsNull());
+        });
+    });
+}
+
+TEST_F(OffscreenDisplayTest, does_not_scan_out_buffer_of_another_size)
+{
+    using namespace ::testing;
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report()};
+
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            auto const renderable = std::make_shared<mtd::FakeRenderable>(db.view_area());
+            renderable->set_buffer(std::make_shared<mtd::StubBuffer>(mir::geometry::Size{16, 16}));
+
+            EXPECT_FALSE(dynamic_cast<mg::DirectScanout&>(db).scanout(renderable));
+        });
+    });
+}
+
+TEST_F(OffscreenDisplayTest, software_only_display_does_not_use_egl)
+{
+    using namespace ::testing;
+    EXPECT_CALL(mock_egl, eglGetDisplay(_)).Times(0);
+    EXPECT_CALL(mock_egl, eglInitialize(_, _, _)).Times(0);
+    EXPECT_CALL(mock_egl, eglCreateContext(_, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glGenFramebuffers(_, _)).Times(0);
+
+    mgo::Display display{
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report()};
+
+    int count = 0;
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            ++count;
+            EXPECT_THAT(dynamic_cast<mrs::RenderTarget*>(db.native_display_buffer()), NotNull());
+            EXPECT_THROW(mt::as_render_target(db)->make_current(), std::logic_error);
+        });
+    });
+
+    EXPECT_TRUE(count);
+    EXPECT_THROW(display.create_gl_context(), std::logic_error);
+}
+
+TEST_F(OffscreenDisplayTest, commit_presents_the_software_rendered_frame)
+{
+    using namespace ::testing;
+    mgo::Display display{
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report()};
+
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            auto& offscreen = dynamic_cast<mgo::DisplayBuffer&>(db);
+            auto const target = dynamic_cast<mrs::RenderTarget*>(db.native_display_buffer());
+            ASSERT_THAT(target, NotNull());
+
+            {
+                auto const framebuffer = target->map_framebuffer();
+                std::fill(framebuffer->data(), framebuffer->data() + framebuffer->len(), 0x7f);
+            }
+            EXPECT_THAT(offscreen.presented_pixels(), IsEmpty());
+
+            target->commit({geom::Rectangle{{0, 0}, db.view_area().size}});
+            EXPECT_THAT(offscreen.presented_frames(), Eq(1u));
+            EXPECT_THAT(offscreen.presented_pixels(), AllOf(Not(IsEmpty()), Each(Eq(0x7f))));
+
+            // A frame without damage presents the same content again
+            target->commit({});
+            EXPECT_THAT(offscreen.presented_frames(), Eq(2u));
+            EXPECT_THAT(offscreen.presented_pixels(), AllOf(Not(IsEmpty()), Each(Eq(0x7f))));
+        });
+    });
+}
+
+TEST_F(OffscreenDisplayTest, commit_presents_only_the_damaged_area)
+{
+    using namespace ::testing;
+    mgo::Display display{
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report()};
+
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            auto& offscreen = dynamic_cast<mgo::DisplayBuffer&>(db);
+            auto const target = dynamic_cast<mrs::RenderTarget*>(db.native_display_buffer());
+            ASSERT_THAT(target, NotNull());
+
+            {
+                auto const framebuffer = target->map_framebuffer();
+                std::fill(framebuffer->data(), framebuffer->data() + framebuffer->len(), 0x7f);
+            }
+            target->commit({geom::Rectangle{{0, 0}, db.view_area().size}});
+
+            {
+                auto const framebuffer = target->map_framebuffer();
+                std::fill(framebuffer->data(), framebuffer->data() + framebuffer->len(), 0x10);
+            }
+            target->commit({geom::Rectangle{{1, 0}, {1, 1}}});
+
+            auto const presented = offscreen.presented_pixels();
+            ASSERT_THAT(presented.size(), Gt(8u));
+            EXPECT_THAT(std::vector<unsigned char>(presented.begin(), presented.begin() + 4), Each(Eq(0x7f)));
+            EXPECT_THAT(std::vector<unsigned char>(presented.begin() + 4, presented.begin() + 8), Each(Eq(0x10)));
+            EXPECT_THAT(std::vector<unsigned char>(presented.begin() + 8, presented.end()), Each(Eq(0x7f)));
+        });
+    });
+}
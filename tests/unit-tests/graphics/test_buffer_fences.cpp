@@ -0,0 +1,254 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/common/server/buffer_fences.h"
+
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_egl.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <linux/types.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+namespace mtd = mir::test::doubles;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+/// Stands in for a sync_file where sw_sync isn't available: a pipe polls readable once written to
+struct PipeFence
+{
+    PipeFence()
+    {
+        int fds[2];
+        if (pipe(fds) != 0)
+            throw std::system_error{errno, std::system_category(), "Failed to create pipe"};
+        fence = mir::Fd{fds[0]};
+        signaller = mir::Fd{fds[1]};
+    }
+
+    void signal()
+    {
+        char const byte{0};
+        if (write(signaller, &byte, 1) != 1)
+            throw std::system_error{errno, std::system_category(), "Failed to signal pipe"};
+    }
+
+    mir::Fd fence;
+    mir::Fd signaller;
+};
+
+// From the kernel's drivers/dma-buf/sw_sync.c
+struct sw_sync_create_fence_data
+{
+    __u32 value;
+    char name[32];
+    __s32 fence;
+};
+#define SW_SYNC_IOC_CREATE_FENCE _IOWR('W', 0, struct sw_sync_create_fence_data)
+#define SW_SYNC_IOC_INC _IOW('W', 1, __u32)
+
+/// A kernel sw_sync timeline, if debugfs exposes one to us
+struct SwSyncTimeline
+{
+    SwSyncTimeline()
+        : timeline{open("/sys/kernel/debug/sync/sw_sync", O_RDWR | O_CLOEXEC)}
+    {
+    }
+
+    bool available() const { return timeline != mir::Fd::invalid; }
+
+    auto fence_at(__u32 value) -> mir::Fd
+    {
+        sw_sync_create_fence_data data{};
+        data.value = value;
+        strncpy(data.name, "test", sizeof data.name - 1);
+        if (ioctl(timeline, SW_SYNC_IOC_CREATE_FENCE, &data) < 0)
+            throw std::system_error{errno, std::system_category(), "Failed to create sw_sync fence"};
+        return mir::Fd{data.fence};
+    }
+
+    void advance(__u32 count)
+    {
+        if (ioctl(timeline, SW_SYNC_IOC_INC, &count) < 0)
+            throw std::system_error{errno, std::system_category(), "Failed to advance sw_sync timeline"};
+    }
+
+    mir::Fd timeline;
+};
+
+struct BufferFences : Test
+{
+    BufferFences()
+    {
+        ON_CALL(mock_egl, eglQueryString(_, EGL_EXTENSIONS))
+            .WillByDefault(Return("EGL_ANDROID_native_fence_sync EGL_KHR_wait_sync"));
+        ON_CALL(mock_egl, eglCreateSyncKHR(_, _, _))
+            .WillByDefault(Return(fake_sync));
+    }
+
+    auto native_sync() -> std::shared_ptr<mg::EGLExtensions::ANDROIDNativeFenceSync const>
+    {
+        return std::make_shared<mg::EGLExtensions::ANDROIDNativeFenceSync>(dpy);
+    }
+
+    NiceMock<mtd::MockEGL> mock_egl;
+    NiceMock<mtd::MockGL> mock_gl;
+    EGLDisplay const dpy{reinterpret_cast<EGLDisplay>(0xd15)};
+    EGLSyncKHR const fake_sync{reinterpret_cast<EGLSyncKHR>(0x5e7c)};
+};
+}
+
+TEST_F(BufferFences, invalid_fence_counts_as_signalled)
+{
+    EXPECT_TRUE(mgc::wait_for_fence(mir::Fd{}, 0ms));
+}
+
+TEST_F(BufferFences, wait_for_fence_times_out_if_fence_does_not_signal)
+{
+    PipeFence pending;
+
+    EXPECT_FALSE(mgc::wait_for_fence(pending.fence, 10ms));
+}
+
+TEST_F(BufferFences, wait_for_fence_returns_once_fence_signals)
+{
+    PipeFence pending;
+    std::thread signaller{[&]() { std::this_thread::sleep_for(10ms); pending.signal(); }};
+
+    EXPECT_TRUE(mgc::wait_for_fence(pending.fence, 10s));
+    signaller.join();
+}
+
+TEST_F(BufferFences, signalled_acquire_fence_needs_no_gpu_wait)
+{
+    PipeFence signalled;
+    signalled.signal();
+    mgc::BufferFences fences{dpy, native_sync()};
+    fences.set_acquire_fence(signalled.fence);
+
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(_, _, _)).Times(0);
+    EXPECT_CALL(mock_egl, eglWaitSyncKHR(_, _, _)).Times(0);
+
+    fences.wait_for_acquire();
+}
+
+TEST_F(BufferFences, pending_acquire_fence_is_waited_for_on_the_gpu)
+{
+    PipeFence pending;
+    mgc::BufferFences fences{dpy, native_sync()};
+    fences.set_acquire_fence(pending.fence);
+
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(dpy, EGL_SYNC_NATIVE_FENCE_ANDROID, _))
+        .WillOnce(Invoke(
+            [this](EGLDisplay, EGLenum, EGLint const* attribs)
+            {
+                EXPECT_THAT(attribs[0], Eq(EGL_SYNC_NATIVE_FENCE_FD_ANDROID));
+                EXPECT_THAT(attribs[1], Ge(0));
+                close(attribs[1]);  // EGL owns the imported fd
+                return fake_sync;
+            }));
+    EXPECT_CALL(mock_egl, eglWaitSyncKHR(dpy, fake_sync, 0));
+    EXPECT_CALL(mock_egl, eglDestroySyncKHR(dpy, fake_sync));
+
+    // Must not block: the fence never signals
+    fences.wait_for_acquire();
+}
+
+TEST_F(BufferFences, without_native_sync_acquire_fence_is_waited_for_on_the_cpu)
+{
+    PipeFence pending;
+    mgc::BufferFences fences{dpy, nullptr};
+    fences.set_acquire_fence(pending.fence);
+
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(_, _, _)).Times(0);
+
+    std::thread signaller{[&]() { std::this_thread::sleep_for(10ms); pending.signal(); }};
+    auto const start = std::chrono::steady_clock::now();
+    fences.wait_for_acquire();
+    auto const waited = std::chrono::steady_clock::now() - start;
+    signaller.join();
+
+    EXPECT_THAT(waited, Ge(10ms));
+}
+
+TEST_F(BufferFences, release_point_exports_native_fence)
+{
+    PipeFence gpu_work;
+    mgc::BufferFences fences{dpy, native_sync()};
+
+    InSequence seq;
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(dpy, EGL_SYNC_NATIVE_FENCE_ANDROID, _))
+        .WillOnce(Return(fake_sync));
+    EXPECT_CALL(mock_gl, glFlush());
+    EXPECT_CALL(mock_egl, eglDupNativeFenceFDANDROID(dpy, fake_sync))
+        .WillOnce(Return(dup(gpu_work.fence)));
+    EXPECT_CALL(mock_egl, eglDestroySyncKHR(dpy, fake_sync));
+
+    fences.add_release_point();
+
+    auto const release = fences.release_fence();
+    ASSERT_THAT(release, Ne(mir::Fd::invalid));
+    EXPECT_FALSE(mgc::wait_for_fence(release, 0ms));
+    gpu_work.signal();
+    EXPECT_TRUE(mgc::wait_for_fence(release, 0ms));
+}
+
+TEST_F(BufferFences, without_native_sync_there_is_no_release_fence)
+{
+    mgc::BufferFences fences{dpy, nullptr};
+
+    fences.add_release_point();
+
+    EXPECT_THAT(fences.release_fence(), Eq(mir::Fd::invalid));
+}
+
+TEST_F(BufferFences, sw_sync_fence_signals_when_timeline_reaches_it)
+{
+    SwSyncTimeline timeline;
+    if (!timeline.available())
+        GTEST_SKIP() << "sw_sync needs debugfs and CONFIG_SW_SYNC; the pipe tests cover the logic";
+
+    auto const fence = timeline.fence_at(1);
+    EXPECT_FALSE(mgc::wait_for_fence(fence, 0ms));
+    timeline.advance(1);
+    EXPECT_TRUE(mgc::wait_for_fence(fence, 0ms));
+}
+
+TEST_F(BufferFences, merged_sw_sync_fence_signals_only_after_both)
+{
+    SwSyncTimeline timeline;
+    if (!timeline.available())
+        GTEST_SKIP() << "sw_sync needs debugfs and CONFIG_SW_SYNC";
+
+    SwSyncTimeline other_timeline;
+    auto const merged = mgc::merge_fences(timeline.fence_at(1), other_timeline.fence_at(1));
+
+    timeline.advance(1);
+    EXPECT_FALSE(mgc::wait_for_fence(merged, 0ms));
+    other_timeline.advance(1);
+    EXPECT_TRUE(mgc::wait_for_fence(merged, 0ms));
+}
@@ -68,3 +68,25 @@ TEST_F(EGLExtensions, success_has_sane_function_hooks)
     EXPECT_NE(nullptr, extensions.eglDestroyImageKHR);
     EXPECT_NE(nullptr, extensions.glEGLImageTargetTexture2DOES);
 }
+
+TEST_F(EGLExtensions, native_fence_sync_throws_if_not_advertised)
+{
+    ON_CALL(mock_egl, eglQueryString(_, EGL_EXTENSIONS))
+        .WillByDefault(Return("EGL_KHR_image EGL_KHR_wait_sync"));
+
+    EXPECT_THROW({
+        mg::EGLExtensions::ANDROIDNativeFenceSync extension{EGL_NO_DISPLAY};
+    }, std::runtime_error);
+}
+
+TEST_F(EGLExtensions, native_fence_sync_has_sane_function_hooks)
+{
+    ON_CALL(mock_egl, eglQueryString(_, EGL_EXTENSIONS))
+        .WillByDefault(Return("EGL_ANDROID_native_fence_sync EGL_KHR_wait_sync"));
+
+    mg::EGLExtensions::ANDROIDNativeFenceSync extension{EGL_NO_DISPLAY};
+    EXPECT_NE(nullptr, extension.eglCreateSyncKHR);
+    EXPECT_NE(nullptr, extension.eglDestroySyncKHR);
+    EXPECT_NE(nullptr, extension.eglWaitSyncKHR);
+    EXPECT_NE(nullptr, extension.eglDupNativeFenceFDANDROID);
+}
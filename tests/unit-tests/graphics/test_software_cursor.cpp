@@ -47,6 +47,7 @@ struct MockInputScene : mtd::StubInputScene
                  void(std::weak_ptr<mg::Renderable> const&));
 
     MOCK_METHOD0(emit_scene_changed, void());
+    MOCK_METHOD1(emit_scene_damaged, void(geom::Rectangle const&));
 };
 
 struct StubCursorImage : mg::CursorImage
@@ -286,14 +287,32 @@ TEST_F(SoftwareCursor, moves_scene_renderable_offset_by_hotspot_when_moved)
                 Eq(new_position - stub_cursor_image.hotspot()));
 }
 
-TEST_F(SoftwareCursor, notifies_scene_when_moving)
+TEST_F(SoftwareCursor, damages_old_and_new_cursor_areas_when_moving)
 {
     using namespace testing;
 
-    EXPECT_CALL(mock_input_scene, emit_scene_changed());
+    cursor.show(stub_cursor_image);
+    executor.execute();
+
+    EXPECT_CALL(mock_input_scene, emit_scene_changed()).Times(0);
+    EXPECT_CALL(mock_input_scene, emit_scene_damaged(geom::Rectangle{{0,0}, stub_cursor_image.size()}));
+    EXPECT_CALL(mock_input_scene, emit_scene_damaged(
+        geom::Rectangle{geom::Point{22,23} - stub_cursor_image.hotspot(), stub_cursor_image.size()}));
+
+    cursor.move_to({22,23});
+}
+
+TEST_F(SoftwareCursor, does_not_damage_scene_when_moving_hidden_cursor)
+{
+    using namespace testing;
 
     cursor.show(stub_cursor_image);
     executor.execute();
+    cursor.hide();
+    executor.execute();
+
+    EXPECT_CALL(mock_input_scene, emit_scene_damaged(_)).Times(0);
+
     cursor.move_to({22,23});
 }
 
@@ -326,6 +345,7 @@ TEST_F(SoftwareCursor, does_not_hide_or_move_when_already_hidden)
 
     EXPECT_CALL(mock_input_scene, remove_input_visualization(_)).Times(0);
     EXPECT_CALL(mock_input_scene, emit_scene_changed()).Times(0);
+    EXPECT_CALL(mock_input_scene, emit_scene_damaged(_)).Times(0);
 
     // Already hidden, nothing should happen
     cursor.hide();
@@ -0,0 +1,316 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/input/resampling_dispatcher.h"
+
+#include "mir/compositor/presentation_clock.h"
+#include "mir/events/event_private.h"
+#include "mir/events/event_builders.h"
+#include "mir/events/contact_state.h"
+#include "mir/time/alarm.h"
+#include "mir/time/alarm_factory.h"
+
+#include "mir/test/fake_shared.h"
+#include "mir/test/doubles/advanceable_clock.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <functional>
+#include <vector>
+
+namespace mi = mir::input;
+namespace mc = mir::compositor;
+namespace mev = mir::events;
+namespace mtd = mir::test::doubles;
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+MirInputDeviceId const touchscreen{3};
+MirInputDeviceId const mouse{4};
+
+struct StubAlarm : mir::time::Alarm
+{
+    explicit StubAlarm(std::function<void()> const& callback)
+        : callback{callback}
+    {
+    }
+
+    bool cancel() override
+    {
+        pending = false;
+        return true;
+    }
+
+    State state() const override
+    {
+        return pending ? State::pending : State::cancelled;
+    }
+
+    bool reschedule_in(std::chrono::milliseconds) override
+    {
+        pending = true;
+        return false;
+    }
+
+    bool reschedule_for(mir::time::Timestamp timeout) override
+    {
+        pending = true;
+        scheduled_for = timeout;
+        return false;
+    }
+
+    void fire()
+    {
+        ASSERT_TRUE(pending);
+        pending = false;
+        callback();
+    }
+
+    std::function<void()> const callback;
+    bool pending{false};
+    mir::time::Timestamp scheduled_for;
+};
+
+struct StubAlarmFactory : mir::time::AlarmFactory
+{
+    std::unique_ptr<mir::time::Alarm> create_alarm(std::function<void()> const& callback) override
+    {
+        auto result = std::make_unique<StubAlarm>(callback);
+        alarm = result.get();
+        return result;
+    }
+
+    std::unique_ptr<mir::time::Alarm> create_alarm(std::unique_ptr<mir::LockableCallback>) override
+    {
+        return nullptr;
+    }
+
+    StubAlarm* alarm{nullptr};
+};
+
+struct RecordingDispatcher : mi::InputDispatcher
+{
+    bool dispatch(std::shared_ptr<MirEvent const> const& event) override
+    {
+        events.push_back(event);
+        return true;
+    }
+
+    void start() override {}
+    void stop() override {}
+
+    std::vector<std::shared_ptr<MirEvent const>> events;
+};
+
+struct ResamplingDispatcher : Test
+{
+    auto now() const -> std::chrono::nanoseconds
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock->now().time_since_epoch());
+    }
+
+    auto touch(MirTouchAction action, float x) -> mir::EventUPtr
+    {
+        return mev::make_event(
+            touchscreen, now(), {}, mir_input_event_modifier_none,
+            {{0, action, mir_touch_tooltype_finger, x, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f}});
+    }
+
+    auto pointer(MirPointerAction action, float x, float dx) -> mir::EventUPtr
+    {
+        return mev::make_event(
+            mouse, now(), {}, mir_input_event_modifier_none, action, 0,
+            x, 0.0f, 0.0f, 0.0f, dx, 0.0f);
+    }
+
+    /// The compositor starts posting frames (at the default 60Hz)
+    void frame_posted()
+    {
+        presentation_clock->frame_posted(this);
+    }
+
+    static auto x_of(std::shared_ptr<MirEvent const> const& event) -> float
+    {
+        auto const input = event->to_input();
+        if (input->input_type() == mir_input_event_type_touch)
+            return input->to_touch()->x(0);
+        return input->to_pointer()->x();
+    }
+
+    std::shared_ptr<mtd::AdvanceableClock> const clock{std::make_shared<mtd::AdvanceableClock>()};
+    std::shared_ptr<mc::PresentationClock> const presentation_clock{std::make_shared<mc::PresentationClock>(clock)};
+    std::shared_ptr<RecordingDispatcher> const next_dispatcher{std::make_shared<RecordingDispatcher>()};
+    StubAlarmFactory alarm_factory;
+    mi::ResamplingDispatcher dispatcher{
+        next_dispatcher, mir::test::fake_shared(alarm_factory), clock, presentation_clock, true, false};
+};
+}
+
+TEST_F(ResamplingDispatcher, passes_motion_through_while_the_compositor_is_idle)
+{
+    dispatcher.dispatch(touch(mir_touch_action_down, 0.0f));
+    clock->advance_by(10ms);
+    dispatcher.dispatch(touch(mir_touch_action_change, 100.0f));
+
+    ASSERT_THAT(next_dispatcher->events.size(), Eq(2u));
+    EXPECT_THAT(x_of(next_dispatcher->events[1]), FloatEq(100.0f));
+    EXPECT_FALSE(alarm_factory.alarm->pending);
+}
+
+TEST_F(ResamplingDispatcher, holds_motion_until_shortly_before_the_next_frame)
+{
+    frame_posted();
+    auto const next_frame = presentation_clock->next_frame().value();
+
+    dispatcher.dispatch(touch(mir_touch_action_down, 0.0f));
+    clock->advance_by(5ms);
+    dispatcher.dispatch(touch(mir_touch_action_change, 50.0f));
+
+    EXPECT_THAT(next_dispatcher->events.size(), Eq(1u));
+    ASSERT_TRUE(alarm_factory.alarm->pending);
+    EXPECT_THAT(alarm_factory.alarm->scheduled_for, Lt(next_frame));
+    EXPECT_THAT(alarm_factory.alarm->scheduled_for, Gt(clock->now()));
+
+    alarm_factory.alarm->fire();
+
+    EXPECT_THAT(next_dispatcher->events.size(), Eq(2u));
+}
+
+TEST_F(ResamplingDispatcher, interpolates_between_samples_either_side_of_the_resampling_time)
+{
+    frame_posted();
+
+    // Resampled 16.7ms (the frame) - 4ms (lead) - 5ms (latency) after the frame was posted
+    dispatcher.dispatch(touch(mir_touch_action_down, 0.0f));
+    clock->advance_by(10ms);
+    dispatcher.dispatch(touch(mir_touch_action_change, 100.0f));
+    alarm_factory.alarm->fire();
+
+    ASSERT_THAT(next_dispatcher->events.size(), Eq(2u));
+    EXPECT_THAT(x_of(next_dispatcher->events[1]), FloatNear(76.67f, 0.01f));
+}
+
+TEST_F(ResamplingDispatcher, extrapolates_a_limited_distance_beyond_the_latest_sample)
+{
+    frame_posted();
+
+    dispatcher.dispatch(touch(mir_touch_action_down, 0.0f));
+    clock->advance_by(4ms);
+    dispatcher.dispatch(touch(mir_touch_action_change, 40.0f));
+    alarm_factory.alarm->fire();
+
+    // Predicts only half the interval between the samples ahead
+    ASSERT_THAT(next_dispatcher->events.size(), Eq(2u));
+    EXPECT_THAT(x_of(next_dispatcher->events[1]), FloatNear(60.0f, 0.01f));
+}
+
+TEST_F(ResamplingDispatcher, delivers_one_event_per_frame_for_each_device)
+{
+    frame_posted();
+
+    dispatcher.dispatch(touch(mir_touch_action_down, 0.0f));
+    for (auto x = 10.0f; x != 40.0f; x += 10.0f)
+    {
+        clock->advance_by(3ms);
+        dispatcher.dispatch(touch(mir_touch_action_change, x));
+    }
+    alarm_factory.alarm->fire();
+
+    EXPECT_THAT(next_dispatcher->events.size(), Eq(2u));
+}
+
+TEST_F(ResamplingDispatcher, flushes_held_motion_before_other_events)
+{
+    frame_posted();
+
+    dispatcher.dispatch(touch(mir_touch_action_down, 0.0f));
+    clock->advance_by(5ms);
+    dispatcher.dispatch(touch(mir_touch_action_change, 50.0f));
+    dispatcher.dispatch(touch(mir_touch_action_up, 50.0f));
+
+    ASSERT_THAT(next_dispatcher->events.size(), Eq(3u));
+    EXPECT_THAT(next_dispatcher->events[1]->to_input()->to_touch()->action(0), Eq(mir_touch_action_change));
+    EXPECT_THAT(next_dispatcher->events[2]->to_input()->to_touch()->action(0), Eq(mir_touch_action_up));
+
+    alarm_factory.alarm->fire();
+    EXPECT_THAT(next_dispatcher->events.size(), Eq(3u));
+}
+
+TEST_F(ResamplingDispatcher, events_dispatched_from_the_next_dispatcher_follow_the_one_it_is_handling)
+{
+    struct ReentrantDispatcher : RecordingDispatcher
+    {
+        bool dispatch(std::shared_ptr<MirEvent const> const& event) override
+        {
+            RecordingDispatcher::dispatch(event);
+            if (reenter)
+            {
+                // For example, a synthesized event in reply to this one
+                auto const nested = std::move(reenter);
+                reenter = nullptr;
+                nested();
+            }
+            return true;
+        }
+
+        std::function<void()> reenter;
+    };
+
+    auto const reentrant = std::make_shared<ReentrantDispatcher>();
+    mi::ResamplingDispatcher dispatcher{
+        reentrant, mir::test::fake_shared(alarm_factory), clock, presentation_clock, true, false};
+    std::shared_ptr<MirEvent const> const up{touch(mir_touch_action_up, 0.0f)};
+    reentrant->reenter = [&] { dispatcher.dispatch(up); };
+
+    dispatcher.dispatch(touch(mir_touch_action_down, 0.0f));
+
+    ASSERT_THAT(reentrant->events.size(), Eq(2u));
+    EXPECT_THAT(reentrant->events[0]->to_input()->to_touch()->action(0), Eq(mir_touch_action_down));
+    EXPECT_THAT(reentrant->events[1], Eq(up));
+}
+
+TEST_F(ResamplingDispatcher, leaves_devices_it_is_not_resampling_alone)
+{
+    frame_posted();
+
+    dispatcher.dispatch(pointer(mir_pointer_action_motion, 10.0f, 10.0f));
+    clock->advance_by(5ms);
+    dispatcher.dispatch(pointer(mir_pointer_action_motion, 20.0f, 10.0f));
+
+    ASSERT_THAT(next_dispatcher->events.size(), Eq(2u));
+    EXPECT_THAT(x_of(next_dispatcher->events[1]), FloatEq(20.0f));
+}
+
+TEST_F(ResamplingDispatcher, accumulates_the_relative_motion_of_coalesced_pointer_events)
+{
+    mi::ResamplingDispatcher pointer_dispatcher{
+        next_dispatcher, mir::test::fake_shared(alarm_factory), clock, presentation_clock, false, true};
+    frame_posted();
+
+    pointer_dispatcher.dispatch(pointer(mir_pointer_action_motion, 10.0f, 10.0f));
+    clock->advance_by(3ms);
+    pointer_dispatcher.dispatch(pointer(mir_pointer_action_motion, 20.0f, 10.0f));
+    clock->advance_by(3ms);
+    pointer_dispatcher.dispatch(pointer(mir_pointer_action_motion, 25.0f, 5.0f));
+    alarm_factory.alarm->fire();
+
+    ASSERT_THAT(next_dispatcher->events.size(), Eq(1u));
+    EXPECT_THAT(next_dispatcher->events[0]->to_input()->to_pointer()->dx(), FloatEq(25.0f));
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/logging/async_logger.h"
+#include "mir/fd.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <string>
+#include <system_error>
+#include <thread>
+
+namespace ml = mir::logging;
+
+using namespace testing;
+
+namespace
+{
+/// A pipe standing in for the console
+struct Pipe
+{
+    Pipe()
+    {
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) != 0)
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to create pipe"};
+        }
+        read_end = mir::Fd{fds[0]};
+        write_end = mir::Fd{fds[1]};
+        fcntl(read_end, F_SETFL, O_NONBLOCK);
+    }
+
+    auto read_all() -> std::string
+    {
+        std::string text;
+        char buffer[4096];
+        ssize_t count;
+        while ((count = read(read_end, buffer, sizeof buffer)) > 0)
+        {
+            text.append(buffer, count);
+        }
+        return text;
+    }
+
+    mir::Fd read_end;
+    mir::Fd write_end;
+};
+
+struct AsyncLogger : Test
+{
+    Pipe output;
+    Pipe errors;
+};
+}
+
+TEST_F(AsyncLogger, writes_messages_in_the_console_logger_format)
+{
+    ml::AsyncLogger logger{output.write_end, errors.write_end, 4096};
+
+    logger.log(ml::Severity::informational, "Hello", "component");
+    logger.flush();
+
+    EXPECT_THAT(output.read_all(), MatchesRegex(
+        "\\[[0-9]{4}-[0-9]{2}-[0-9]{2} [0-9]{2}:[0-9]{2}:[0-9]{2}\\.[0-9]{6}\\] <information> component: Hello\n"));
+}
+
+TEST_F(AsyncLogger, formats_printf_style_messages)
+{
+    ml::AsyncLogger logger{output.write_end, errors.write_end, 4096};
+
+    logger.log("component", ml::Severity::debug, "%d %s", 42, "things");
+    logger.flush();
+
+    EXPECT_THAT(output.read_all(), EndsWith("< - debug - > component: 42 things\n"));
+}
+
+TEST_F(AsyncLogger, writes_warnings_and_worse_to_the_error_fd)
+{
+    ml::AsyncLogger logger{output.write_end, errors.write_end, 4096};
+
+    logger.log(ml::Severity::warning, "Careful", "component");
+    logger.flush();
+
+    EXPECT_THAT(errors.read_all(), EndsWith("< -warning- > component: Careful\n"));
+    EXPECT_THAT(output.read_all(), IsEmpty());
+}
+
+TEST_F(AsyncLogger, writes_errors_before_returning)
+{
+    ml::AsyncLogger logger{output.write_end, errors.write_end, 4096};
+
+    logger.log(ml::Severity::error, "Oops", "component");
+
+    EXPECT_THAT(errors.read_all(), EndsWith("< - ERROR - > component: Oops\n"));
+}
+
+TEST_F(AsyncLogger, keeps_the_order_of_each_threads_messages)
+{
+    ml::AsyncLogger logger{output.write_end, errors.write_end, 64 * 1024};
+    int const messages{100};
+
+    auto const log_from = [&](std::string const& name)
+        {
+            for (int i = 0; i != messages; ++i)
+            {
+                logger.log(ml::Severity::informational, std::to_string(i), name);
+            }
+        };
+
+    std::thread first{log_from, "first"};
+    std::thread second{log_from, "second"};
+    first.join();
+    second.join();
+    logger.flush();
+
+    auto const text = output.read_all();
+    for (auto const name : {"first", "second"})
+    {
+        std::string::size_type position{0};
+        for (int i = 0; i != messages; ++i)
+        {
+            position = text.find(std::string{name} + ": " + std::to_string(i) + "\n", position);
+            ASSERT_THAT(position, Ne(std::string::npos)) << name << " message " << i;
+        }
+    }
+}
+
+TEST_F(AsyncLogger, reports_messages_dropped_rather_than_blocking)
+{
+    ml::AsyncLogger logger{output.write_end, errors.write_end, 4096};
+    std::string const message(100, 'x');
+
+    // Nothing reads the output, so the logger is soon blocked writing it
+    for (int i = 0; i != 20000; ++i)
+    {
+        logger.log(ml::Severity::informational, message, "component");
+    }
+
+    std::thread reader{[&]
+        {
+            fcntl(output.read_end, F_SETFL, 0);
+            char buffer[4096];
+            while (read(output.read_end, buffer, sizeof buffer) > 0)
+                ;
+        }};
+    logger.flush();
+
+    EXPECT_THAT(errors.read_all(), HasSubstr("message(s) dropped"));
+
+    output.write_end = mir::Fd{};
+    reader.join();
+}
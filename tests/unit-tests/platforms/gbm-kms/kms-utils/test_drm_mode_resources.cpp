@@ -205,3 +205,22 @@ TEST(DRMModeResources, can_access_plane_properties)
                 Eq(static_cast<unsigned>(DRM_PLANE_TYPE_CURSOR)));
     EXPECT_THAT(plane_props.id_for("CRTC_ID"), Eq(99u));
 }
+
+TEST(DRMModeResources, get_connector_current_does_not_force_a_probe)
+{
+    using namespace testing;
+
+    NiceMock<mtd::MockDRM> mock_drm;
+    drmModeConnector connector{};
+    connector.connector_id = 42;
+    connector.connection = DRM_MODE_CONNECTED;
+
+    EXPECT_CALL(mock_drm, drmModeGetConnector(_, _)).Times(0);
+    EXPECT_CALL(mock_drm, drmModeGetConnectorCurrent(_, connector.connector_id))
+        .WillOnce(Return(&connector));
+
+    auto const current = mgk::get_connector_current(0, connector.connector_id);
+
+    EXPECT_THAT(current->connector_id, Eq(connector.connector_id));
+    EXPECT_THAT(current->connection, Eq(DRM_MODE_CONNECTED));
+}
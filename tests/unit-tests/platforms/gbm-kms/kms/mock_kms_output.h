@@ -69,6 +69,9 @@ struct MockKMSOutput : public graphics::gbm::KMSOutput
     MOCK_METHOD1(set_power_mode, void(MirPowerMode));
     MOCK_METHOD1(set_gamma, void(mir::graphics::GammaCurves const&));
 
+    MOCK_METHOD1(allow_variable_refresh, void(bool));
+    MOCK_METHOD1(set_variable_refresh, bool(bool));
+
     MOCK_METHOD0(refresh_hardware_state, void());
     MOCK_CONST_METHOD1(update_from_hardware_state, void(graphics::DisplayConfigurationOutput&));
 
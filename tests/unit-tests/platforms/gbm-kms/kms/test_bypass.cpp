@@ -95,6 +95,22 @@ TEST_F(BypassMatchTest, offset_fullscreen_window_not_bypassed)
     EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), matcher));
 }
 
+TEST_F(BypassMatchTest, cropped_fullscreen_window_not_bypassed)
+{
+    struct CroppedRenderable : mtd::FakeRenderable
+    {
+        using FakeRenderable::FakeRenderable;
+        mg::TextureBounds texture_bounds() const override { return {0.0f, 0.0f, 0.5f, 0.5f}; }
+    };
+    mgg::BypassMatch matcher(primary_monitor);
+
+    mg::RenderableList list{
+        std::make_shared<CroppedRenderable>(0, 0, 1920, 1200)
+    };
+
+    EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), matcher));
+}
+
 TEST_F(BypassMatchTest, obscured_fullscreen_window_not_bypassed)
 {
     mgg::BypassMatch matcher(primary_monitor);
@@ -0,0 +1,243 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/gbm-kms/server/kms/connector_prober.h"
+
+#include "mir/geometry/size.h"
+#include "mir/test/doubles/mock_drm.h"
+#include "mir/test/signal.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+
+namespace mgg = mir::graphics::gbm;
+namespace geom = mir::geometry;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+class ConnectorProberTest : public ::testing::Test
+{
+public:
+    ConnectorProberTest()
+    {
+        using fake = mtd::FakeDRMResources;
+
+        modes.push_back(fake::create_mode(1920, 1080, 148500, 2200, 1125, fake::PreferredMode));
+
+        mock_drm.reset(drm_device);
+
+        for (auto i = 0u; i != connector_ids.size(); ++i)
+        {
+            mock_drm.add_crtc(drm_device, crtc_ids[i], drmModeModeInfo());
+            mock_drm.add_encoder(drm_device, encoder_ids[i], crtc_ids[i], 0xff);
+        }
+
+        for (auto i = 0u; i != connector_ids.size(); ++i)
+        {
+            mock_drm.add_connector(
+                drm_device,
+                connector_ids[i],
+                DRM_MODE_CONNECTOR_HDMIA,
+                DRM_MODE_CONNECTED,
+                encoder_ids[i],
+                modes,
+                encoder_ids,
+                geom::Size{597, 336});
+        }
+
+        mock_drm.prepare(drm_device);
+
+        drm_fd = open(drm_device, 0, 0);
+    }
+
+    /// Makes the kernel report connector_ids[1] as unplugged
+    void unplug_second_connector()
+    {
+        unplugged = *mock_drm.drmModeGetConnectorCurrent(drm_fd, connector_ids[1]);
+        unplugged.connection = DRM_MODE_DISCONNECTED;
+
+        ON_CALL(mock_drm, drmModeGetConnectorCurrent(drm_fd, connector_ids[1]))
+            .WillByDefault(Return(&unplugged));
+        ON_CALL(mock_drm, drmModeGetConnector(drm_fd, connector_ids[1]))
+            .WillByDefault(Return(&unplugged));
+    }
+
+    /// Gives connector_ids[0] an EDID, whose blob is edid_blob_id
+    void add_edid_property()
+    {
+        connector_props = {1, &edid.prop_id, &edid_blob_id};
+
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, connector_ids[0], DRM_MODE_OBJECT_CONNECTOR))
+            .WillByDefault(Return(&connector_props));
+        ON_CALL(mock_drm, drmModeGetProperty(_, edid.prop_id))
+            .WillByDefault(Return(&edid));
+    }
+
+    static bool wait_for_completion(mgg::ConnectorProber const& prober, std::chrono::milliseconds timeout)
+    {
+        pollfd completion{prober.completion_fd(), POLLIN, 0};
+        if (poll(&completion, 1, timeout.count()) != 1)
+            return false;
+
+        eventfd_t unused;
+        return eventfd_read(completion.fd, &unused) == 0;
+    }
+
+    NiceMock<mtd::MockDRM> mock_drm;
+
+    char const* const drm_device = "/dev/dri/card0";
+    std::vector<uint32_t> crtc_ids{10, 11};
+    std::vector<uint32_t> encoder_ids{20, 21};
+    std::vector<uint32_t> connector_ids{30, 31};
+    std::vector<drmModeModeInfo> modes;
+    drmModeConnector unplugged;
+    drmModePropertyRes edid{103, DRM_MODE_PROP_BLOB | DRM_MODE_PROP_IMMUTABLE, "EDID", 0, nullptr, 0, nullptr, 0, nullptr};
+    uint64_t edid_blob_id{1};
+    drmModeObjectProperties connector_props{};
+    int drm_fd;
+};
+}
+
+TEST_F(ConnectorProberTest, does_not_probe_when_no_connection_changed)
+{
+    mgg::ConnectorProber prober{{drm_fd}};
+
+    EXPECT_CALL(mock_drm, drmModeGetConnector(_, _)).Times(0);
+
+    prober.request_probe();
+    EXPECT_TRUE(wait_for_completion(prober, 10s));
+}
+
+TEST_F(ConnectorProberTest, only_probes_connectors_whose_connection_changed)
+{
+    mgg::ConnectorProber prober{{drm_fd}};
+
+    unplug_second_connector();
+
+    EXPECT_CALL(mock_drm, drmModeGetConnector(_, connector_ids[0])).Times(0);
+    EXPECT_CALL(mock_drm, drmModeGetConnector(drm_fd, connector_ids[1])).Times(1);
+
+    prober.request_probe();
+    EXPECT_TRUE(wait_for_completion(prober, 10s));
+
+
+    // The change has been seen, so the next check has nothing to probe
+    EXPECT_CALL(mock_drm, drmModeGetConnector(_, _)).Times(0);
+
+    prober.request_probe();
+    EXPECT_TRUE(wait_for_completion(prober, 10s));
+}
+
+TEST_F(ConnectorProberTest, probes_off_the_requesting_thread)
+{
+    mgg::ConnectorProber prober{{drm_fd}};
+    std::thread::id probing_thread;
+
+    unplug_second_connector();
+
+    EXPECT_CALL(mock_drm, drmModeGetConnector(drm_fd, connector_ids[1]))
+        .WillOnce(DoAll(
+            InvokeWithoutArgs([&probing_thread] { probing_thread = std::this_thread::get_id(); }),
+            Return(&unplugged)));
+
+    prober.request_probe();
+    ASSERT_TRUE(wait_for_completion(prober, 10s));
+
+    EXPECT_THAT(probing_thread, Ne(std::this_thread::get_id()));
+}
+
+TEST_F(ConnectorProberTest, probes_a_connector_whose_edid_changed)
+{
+    add_edid_property();
+    mgg::ConnectorProber prober{{drm_fd}};
+
+    // The kernel read a different EDID, e.g. a monitor was swapped for another
+    edid_blob_id = 2;
+
+    EXPECT_CALL(mock_drm, drmModeGetConnector(_, connector_ids[1])).Times(0);
+    EXPECT_CALL(mock_drm, drmModeGetConnector(drm_fd, connector_ids[0])).Times(1);
+
+    prober.request_probe();
+    EXPECT_TRUE(wait_for_completion(prober, 10s));
+}
+
+TEST_F(ConnectorProberTest, probes_a_connector_a_hotplug_named_even_if_it_looks_unchanged)
+{
+    struct stat device;
+    ASSERT_THAT(fstat(drm_fd, &device), Eq(0));
+    mgg::ConnectorProber prober{{drm_fd}};
+
+    EXPECT_CALL(mock_drm, drmModeGetConnector(_, connector_ids[1])).Times(0);
+    EXPECT_CALL(mock_drm, drmModeGetConnector(drm_fd, connector_ids[0])).Times(1);
+
+    prober.request_probe(device.st_rdev, connector_ids[0]);
+    EXPECT_TRUE(wait_for_completion(prober, 10s));
+
+
+    // Only the hotplug asked for a full probe
+    EXPECT_CALL(mock_drm, drmModeGetConnector(_, _)).Times(0);
+
+    prober.request_probe();
+    EXPECT_TRUE(wait_for_completion(prober, 10s));
+}
+
+TEST_F(ConnectorProberTest, signals_completion_once_for_each_check)
+{
+    int const requests_during_check{4};
+    mgg::ConnectorProber prober{{drm_fd}};
+
+    mt::Signal checking;
+    mt::Signal finish_check;
+    std::atomic<bool> first_check{true};
+    auto const connector = mock_drm.drmModeGetConnectorCurrent(drm_fd, connector_ids[0]);
+
+    ON_CALL(mock_drm, drmModeGetConnectorCurrent(drm_fd, connector_ids[0]))
+        .WillByDefault(InvokeWithoutArgs([&]
+            {
+                if (first_check.exchange(false))
+                {
+                    checking.raise();
+                    finish_check.wait_for(10s);
+                }
+                return connector;
+            }));
+
+    prober.request_probe();
+    ASSERT_TRUE(checking.wait_for(10s));
+
+    // These are all served by the one check after the current one
+    for (int i = 0; i != requests_during_check; ++i)
+        prober.request_probe();
+
+    finish_check.raise();
+
+    EXPECT_TRUE(wait_for_completion(prober, 10s));
+    EXPECT_TRUE(wait_for_completion(prober, 10s));
+    EXPECT_FALSE(wait_for_completion(prober, 100ms));
+}
@@ -37,6 +37,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <gbm.h>
+#include <sys/eventfd.h>
 
 using namespace testing;
 using namespace mir;
@@ -207,6 +208,50 @@ TEST_F(MesaDisplayBufferTest, predictive_bypass_is_throttled)
     }
 }
 
+TEST_F(MesaDisplayBufferTest, bypass_with_variable_refresh_follows_the_client)
+{
+    EXPECT_CALL(*mock_kms_output, set_variable_refresh(true))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Return(true));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    for (int frame = 0; frame < 5; ++frame)
+    {
+        ASSERT_TRUE(db.overlay(bypassable_list));
+        db.post();
+
+        ASSERT_EQ(0, db.recommended_sleep().count());
+    }
+}
+
+TEST_F(MesaDisplayBufferTest, composited_frames_have_a_fixed_refresh_rate)
+{
+    graphics::RenderableList non_bypassable_list{
+        std::make_shared<FakeRenderable>(geometry::Rectangle{{12, 34}, {1, 1}})
+    };
+
+    EXPECT_CALL(*mock_kms_output, set_variable_refresh(true)).Times(0);
+    EXPECT_CALL(*mock_kms_output, set_variable_refresh(false)).Times(AtLeast(1));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    ASSERT_FALSE(db.overlay(non_bypassable_list));
+    db.post();
+}
+
 TEST_F(MesaDisplayBufferTest, frames_requiring_gl_are_not_throttled)
 {
     graphics::RenderableList non_bypassable_list{
@@ -503,3 +548,56 @@ TEST_F(MesaDisplayBufferTest, buffer_requiring_migration_is_ineligable_for_bypas
 
     EXPECT_FALSE(db.overlay(bypassable_list));
 }
+
+TEST_F(MesaDisplayBufferTest, output_on_another_device_scans_out_rendered_frames_without_copying)
+{
+    ON_CALL(*mock_kms_output, buffer_requires_migration(fake_bo))
+        .WillByDefault(Return(true));
+
+    EXPECT_CALL(*mock_kms_output, fb_for(fake_bo))
+        .Times(AtLeast(1));
+    EXPECT_CALL(mock_gbm, gbm_create_device(_))
+        .Times(0);
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, output_on_another_device_that_cannot_scan_out_rendered_frames_gets_copies)
+{
+    auto const copied_bo = reinterpret_cast<gbm_bo*>(456);
+
+    ON_CALL(mock_gbm, gbm_surface_lock_front_buffer(mock_gbm.fake_gbm.surface))
+        .WillByDefault(Return(copied_bo));
+    ON_CALL(mock_gbm, gbm_bo_get_fd(fake_bo))
+        .WillByDefault(InvokeWithoutArgs([]() { return eventfd(0, EFD_CLOEXEC); }));
+    ON_CALL(*mock_kms_output, buffer_requires_migration(fake_bo))
+        .WillByDefault(Return(true));
+    ON_CALL(*mock_kms_output, fb_for(fake_bo))
+        .WillByDefault(Return(nullptr));
+
+    // The copy is made on (and into the memory of) the output's device
+    EXPECT_CALL(mock_gbm, gbm_create_device(_))
+        .Times(1);
+    EXPECT_CALL(*mock_kms_output, fb_for(copied_bo))
+        .Times(AtLeast(1));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    db.swap_buffers();
+    db.post();
+}
@@ -20,6 +20,7 @@
 #include "mir/graphics/display_buffer.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/graphics/platform.h"
+#include "mir/graphics/incrementally_configurable_display.h"
 
 #include "src/platforms/gbm-kms/server/kms/platform.h"
 
@@ -40,6 +41,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <algorithm>
+#include <chrono>
+#include <future>
 #include <unordered_set>
 #include <fcntl.h>
 
@@ -541,6 +545,79 @@ TEST_F(MesaDisplayMultiMonitorTest, configure_clears_unused_connected_outputs)
     }
 }
 
+TEST_F(MesaDisplayMultiMonitorTest, incremental_configure_only_replaces_sync_groups_of_changed_outputs)
+{
+    using namespace testing;
+
+    int const num_connected_outputs{3};
+    int const num_disconnected_outputs{2};
+
+    setup_outputs(num_connected_outputs, num_disconnected_outputs);
+
+    auto display = create_display_side_by_side(create_platform());
+    auto& incremental_display = dynamic_cast<mg::IncrementallyConfigurableDisplay&>(*display);
+
+    std::vector<mg::DisplaySyncGroup*> groups_before;
+    display->for_each_display_sync_group(
+        [&](mg::DisplaySyncGroup& group) { groups_before.push_back(&group); });
+    ASSERT_THAT(groups_before.size(), Eq(static_cast<size_t>(num_connected_outputs)));
+
+    /* Change the mode of the rightmost output only */
+    auto conf = display->configuration();
+    int rightmost_x{0};
+    conf->for_each_output(
+        [&](mg::DisplayConfigurationOutput const& output)
+        {
+            if (output.used)
+                rightmost_x = std::max(rightmost_x, output.top_left.x.as_int());
+        });
+    conf->for_each_output(
+        [&](mg::UserDisplayConfigurationOutput& output)
+        {
+            if (output.used && output.top_left.x.as_int() == rightmost_x)
+                output.current_mode_index = 2;
+        });
+
+    Mock::VerifyAndClearExpectations(&mock_drm);
+
+    /* The untouched outputs are not modeset again */
+    for (int i = 0; i < num_connected_outputs - 1; i++)
+    {
+        EXPECT_CALL(mock_drm,
+                    drmModeSetCrtc(mtd::IsFdOfDevice(drm_device), crtc_ids[i],
+                                   _, _, _, _, _, _))
+                        .Times(0);
+    }
+
+    std::vector<mg::DisplaySyncGroup*> invalidated;
+    incremental_display.configure_incrementally(
+        *conf,
+        [&](mg::DisplaySyncGroup& group)
+        {
+            invalidated.push_back(&group);
+
+            // Compositor threads use the display while they're being stopped
+            auto const used = std::async(std::launch::async, [&] { display->configuration(); });
+            EXPECT_THAT(used.wait_for(std::chrono::seconds{5}), Eq(std::future_status::ready));
+        });
+
+    Mock::VerifyAndClearExpectations(&mock_drm);
+
+    std::vector<mg::DisplaySyncGroup*> groups_after;
+    display->for_each_display_sync_group(
+        [&](mg::DisplaySyncGroup& group) { groups_after.push_back(&group); });
+
+    ASSERT_THAT(invalidated.size(), Eq(1u));
+    EXPECT_THAT(groups_after.size(), Eq(groups_before.size()));
+    for (auto const group : groups_before)
+    {
+        if (group != invalidated.front())
+        {
+            EXPECT_THAT(groups_after, Contains(group));
+        }
+    }
+}
+
 TEST_F(MesaDisplayMultiMonitorTest, resume_clears_unused_connected_outputs)
 {
     using namespace testing;
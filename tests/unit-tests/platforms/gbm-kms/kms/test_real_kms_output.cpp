@@ -30,6 +30,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <fcntl.h>
+#include <sys/eventfd.h>
 
 namespace mg = mir::graphics;
 namespace mgg = mir::graphics::gbm;
@@ -148,6 +149,35 @@ public:
         mock_drm.prepare(drm_device);
     }
 
+    /// Makes fake_bo look as though it was allocated on another device
+    void make_bo_foreign()
+    {
+        int const other_device_fd{99};
+        ON_CALL(mock_gbm, gbm_device_get_fd(_))
+            .WillByDefault(Return(other_device_fd));
+        ON_CALL(mock_drm, drmGetPrimaryDeviceNameFromFd(other_device_fd))
+            .WillByDefault(InvokeWithoutArgs([]() { return strdup("/dev/dri/card1"); }));
+        ON_CALL(mock_gbm, gbm_bo_get_fd(fake_bo))
+            .WillByDefault(InvokeWithoutArgs([]() { return eventfd(0, EFD_CLOEXEC); }));
+    }
+
+    /// Gives the connector, and its CRTC, the adaptive sync properties
+    void add_vrr_properties(bool capable)
+    {
+        connector_props = {1, &vrr_capable.prop_id, &vrr_capable_value};
+        crtc_props = {1, &vrr_enabled.prop_id, &vrr_enabled_value};
+        vrr_capable_value = capable;
+
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, connector_ids[0], DRM_MODE_OBJECT_CONNECTOR))
+            .WillByDefault(Return(&connector_props));
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, crtc_ids[0], DRM_MODE_OBJECT_CRTC))
+            .WillByDefault(Return(&crtc_props));
+        ON_CALL(mock_drm, drmModeGetProperty(_, vrr_capable.prop_id))
+            .WillByDefault(Return(&vrr_capable));
+        ON_CALL(mock_drm, drmModeGetProperty(_, vrr_enabled.prop_id))
+            .WillByDefault(Return(&vrr_enabled));
+    }
+
     void append_fb_id(uint32_t fb_id)
     {
         EXPECT_CALL(mock_drm, drmModeAddFB2(_,_,_,_,_,_,_,_,_))
@@ -167,6 +197,12 @@ public:
     int const drm_fd;
 
     gbm_bo* const fake_bo{reinterpret_cast<gbm_bo*>(0x123ba)};
+    drmModePropertyRes vrr_capable{101, DRM_MODE_PROP_RANGE | DRM_MODE_PROP_IMMUTABLE, "vrr_capable", 0, nullptr, 0, nullptr, 0, nullptr};
+    drmModePropertyRes vrr_enabled{102, DRM_MODE_PROP_RANGE, "VRR_ENABLED", 0, nullptr, 0, nullptr, 0, nullptr};
+    uint64_t vrr_capable_value{0};
+    uint64_t vrr_enabled_value{0};
+    drmModeObjectProperties connector_props{};
+    drmModeObjectProperties crtc_props{};
     uint32_t const invalid_id;
     std::vector<uint32_t> const crtc_ids;
     std::vector<uint32_t> const encoder_ids;
@@ -548,3 +584,206 @@ TEST_F(RealKMSOutputTest, drm_set_gamma_failure_does_not_throw)
 
     EXPECT_NO_THROW(output.set_gamma(gamma););
 }
+
+TEST_F(RealKMSOutputTest, buffer_from_another_device_is_imported_for_display)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+    make_bo_foreign();
+
+    uint32_t const imported_handle{77};
+    uint32_t const fb_id{42};
+
+    EXPECT_CALL(mock_drm, drmPrimeFDToHandle(drm_fd, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(imported_handle), Return(0)));
+    EXPECT_CALL(mock_drm, drmModeAddFB2(drm_fd, _, _, _, Pointee(imported_handle), _, _, _, _))
+        .WillOnce(DoAll(SetArgPointee<7>(fb_id), Return(0)));
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    EXPECT_THAT(output.fb_for(fake_bo), NotNull());
+}
+
+TEST_F(RealKMSOutputTest, buffer_from_another_device_that_cannot_be_imported_has_no_framebuffer)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+    make_bo_foreign();
+
+    EXPECT_CALL(mock_drm, drmPrimeFDToHandle(drm_fd, _, _))
+        .WillOnce(Return(-EINVAL));
+    EXPECT_CALL(mock_drm, drmModeAddFB2(_, _, _, _, _, _, _, _, _))
+        .Times(0);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    EXPECT_THAT(output.fb_for(fake_bo), IsNull());
+}
+
+TEST_F(RealKMSOutputTest, reports_adaptive_sync_capability_of_connected_display)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+    add_vrr_properties(true);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    mg::DisplayConfigurationOutput conf_output;
+    output.update_from_hardware_state(conf_output);
+
+    EXPECT_TRUE(conf_output.vrr_capable);
+}
+
+TEST_F(RealKMSOutputTest, display_without_adaptive_sync_is_not_vrr_capable)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+    add_vrr_properties(false);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    mg::DisplayConfigurationOutput conf_output;
+    conf_output.vrr_capable = true;
+    output.update_from_hardware_state(conf_output);
+
+    EXPECT_FALSE(conf_output.vrr_capable);
+}
+
+TEST_F(RealKMSOutputTest, adaptive_sync_display_has_variable_refresh_enabled_by_default)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+    add_vrr_properties(true);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    mg::DisplayConfigurationOutput conf_output;
+    output.update_from_hardware_state(conf_output);
+
+    EXPECT_TRUE(conf_output.vrr_capable);
+    EXPECT_TRUE(conf_output.vrr_enabled);
+}
+
+TEST_F(RealKMSOutputTest, refreshing_hardware_state_keeps_variable_refresh_disabled_by_configuration)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+    add_vrr_properties(true);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    mg::DisplayConfigurationOutput conf_output;
+    output.update_from_hardware_state(conf_output);
+    conf_output.vrr_enabled = false;
+    output.update_from_hardware_state(conf_output);
+
+    EXPECT_FALSE(conf_output.vrr_enabled);
+}
+
+TEST_F(RealKMSOutputTest, variable_refresh_sets_crtc_property_when_allowed)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+    add_vrr_properties(true);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    InSequence seq;
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(drm_fd, crtc_ids[0], DRM_MODE_OBJECT_CRTC, vrr_enabled.prop_id, 1))
+        .WillOnce(Return(0));
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(drm_fd, crtc_ids[0], DRM_MODE_OBJECT_CRTC, vrr_enabled.prop_id, 0))
+        .WillOnce(Return(0));
+
+    output.allow_variable_refresh(true);
+    EXPECT_TRUE(output.set_variable_refresh(true));
+    // Unchanged, so nothing to set
+    EXPECT_TRUE(output.set_variable_refresh(true));
+    EXPECT_FALSE(output.set_variable_refresh(false));
+}
+
+TEST_F(RealKMSOutputTest, variable_refresh_is_not_set_unless_allowed)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+    add_vrr_properties(true);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(_, _, _, _, _))
+        .Times(0);
+
+    EXPECT_FALSE(output.set_variable_refresh(true));
+}
+
+TEST_F(RealKMSOutputTest, disallowing_variable_refresh_returns_to_fixed_rate)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+    add_vrr_properties(true);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    output.allow_variable_refresh(true);
+    output.set_variable_refresh(true);
+
+    EXPECT_CALL(mock_drm, drmModeObjectSetProperty(drm_fd, crtc_ids[0], DRM_MODE_OBJECT_CRTC, vrr_enabled.prop_id, 0))
+        .WillOnce(Return(0));
+
+    output.allow_variable_refresh(false);
+    EXPECT_FALSE(output.set_variable_refresh(true));
+}
+
+TEST_F(RealKMSOutputTest, failure_to_set_variable_refresh_is_non_fatal)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+    add_vrr_properties(true);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    ON_CALL(mock_drm, drmModeObjectSetProperty(_, _, _, _, _))
+        .WillByDefault(Return(-EINVAL));
+
+    output.allow_variable_refresh(true);
+    EXPECT_FALSE(output.set_variable_refresh(true));
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "passthrough.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <experimental/optional>
+
+namespace mg = mir::graphics;
+namespace mgw = mir::graphics::wayland;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+struct Shown
+{
+    mg::Renderable const* renderable;
+    geom::Displacement offset;
+    wl_surface* sibling;
+};
+
+struct FakeLayer : mgw::SubsurfaceStack::Layer
+{
+    FakeLayer(wl_surface* surface) :
+        surface{surface}
+    {
+    }
+
+    void show(mg::Renderable const& renderable, geom::Displacement offset, wl_surface* sibling) override
+    {
+        shown = Shown{&renderable, offset, sibling};
+    }
+
+    void hide() override
+    {
+        shown = {};
+    }
+
+    auto host_surface() const -> wl_surface* override
+    {
+        return surface;
+    }
+
+    wl_surface* const surface;
+    std::experimental::optional<Shown> shown;
+};
+
+struct Passthrough : Test
+{
+    auto surface(int index) -> wl_surface*
+    {
+        return reinterpret_cast<wl_surface*>(&surfaces[index]);
+    }
+
+    auto can_pass_through() -> std::function<bool(mg::Renderable const&)>
+    {
+        return [this](mg::Renderable const& renderable) { return &renderable != refused.get(); };
+    }
+
+    geom::Rectangle const view{{0, 0}, {1920, 1080}};
+
+    std::shared_ptr<mg::Renderable> const bottom{std::make_shared<mtd::FakeRenderable>(0, 0, 1920, 1080)};
+    std::shared_ptr<mg::Renderable> const middle{std::make_shared<mtd::FakeRenderable>(100, 100, 640, 480)};
+    std::shared_ptr<mg::Renderable> const top{std::make_shared<mtd::FakeRenderable>(200, 50, 320, 240)};
+    std::shared_ptr<mg::Renderable> const offscreen{std::make_shared<mtd::FakeRenderable>(2000, 0, 320, 240)};
+    std::shared_ptr<mg::Renderable> refused;
+
+    // Stand-ins for host surfaces: only their addresses are used
+    std::array<int, 8> surfaces{};
+    std::vector<FakeLayer*> layers;
+
+    mgw::SubsurfaceStack stack{
+        surface(0),
+        [this]
+        {
+            auto layer = std::make_unique<FakeLayer>(surface(layers.size() + 1));
+            layers.push_back(layer.get());
+            return layer;
+        }};
+};
+}
+
+TEST_F(Passthrough, passes_through_everything_when_it_can)
+{
+    auto const split = mgw::split_for_passthrough({bottom, middle, top}, view, can_pass_through());
+
+    EXPECT_THAT(split.composited, IsEmpty());
+    EXPECT_THAT(split.passed_through, ElementsAre(bottom, middle, top));
+}
+
+TEST_F(Passthrough, composites_what_cant_be_passed_through_and_everything_beneath_it)
+{
+    refused = middle;
+
+    auto const split = mgw::split_for_passthrough({bottom, middle, top}, view, can_pass_through());
+
+    EXPECT_THAT(split.composited, ElementsAre(bottom, middle));
+    EXPECT_THAT(split.passed_through, ElementsAre(top));
+}
+
+TEST_F(Passthrough, composites_everything_when_the_top_cant_be_passed_through)
+{
+    refused = top;
+
+    auto const split = mgw::split_for_passthrough({bottom, middle, top}, view, can_pass_through());
+
+    EXPECT_THAT(split.composited, ElementsAre(bottom, middle, top));
+    EXPECT_THAT(split.passed_through, IsEmpty());
+}
+
+TEST_F(Passthrough, leaves_out_renderables_outside_the_view)
+{
+    refused = offscreen;
+
+    auto const split = mgw::split_for_passthrough({bottom, offscreen, top}, view, can_pass_through());
+
+    EXPECT_THAT(split.composited, IsEmpty());
+    EXPECT_THAT(split.passed_through, ElementsAre(bottom, top));
+}
+
+TEST_F(Passthrough, stacks_each_layer_above_the_one_beneath_it)
+{
+    geom::Point const origin{100, 0};
+
+    stack.show({bottom, middle, top}, origin);
+
+    ASSERT_THAT(layers, SizeIs(3));
+    ASSERT_TRUE(layers[0]->shown && layers[1]->shown && layers[2]->shown);
+
+    EXPECT_THAT(layers[0]->shown.value().renderable, Eq(bottom.get()));
+    EXPECT_THAT(layers[0]->shown.value().sibling, Eq(surface(0)));
+    EXPECT_THAT(layers[0]->shown.value().offset, Eq(geom::Displacement{-100, 0}));
+
+    EXPECT_THAT(layers[1]->shown.value().renderable, Eq(middle.get()));
+    EXPECT_THAT(layers[1]->shown.value().sibling, Eq(layers[0]->surface));
+    EXPECT_THAT(layers[1]->shown.value().offset, Eq(geom::Displacement{0, 100}));
+
+    EXPECT_THAT(layers[2]->shown.value().renderable, Eq(top.get()));
+    EXPECT_THAT(layers[2]->shown.value().sibling, Eq(layers[1]->surface));
+    EXPECT_THAT(layers[2]->shown.value().offset, Eq(geom::Displacement{100, 50}));
+}
+
+TEST_F(Passthrough, reuses_layers_from_earlier_frames)
+{
+    stack.show({bottom, middle}, view.top_left);
+    stack.show({middle, top}, view.top_left);
+
+    ASSERT_THAT(layers, SizeIs(2));
+    ASSERT_TRUE(layers[0]->shown && layers[1]->shown);
+    EXPECT_THAT(layers[0]->shown.value().renderable, Eq(middle.get()));
+    EXPECT_THAT(layers[1]->shown.value().renderable, Eq(top.get()));
+}
+
+TEST_F(Passthrough, hides_layers_no_longer_needed)
+{
+    stack.show({bottom, middle, top}, view.top_left);
+    stack.show({top}, view.top_left);
+
+    ASSERT_THAT(layers, SizeIs(3));
+    ASSERT_TRUE(layers[0]->shown);
+    EXPECT_THAT(layers[0]->shown.value().renderable, Eq(top.get()));
+    EXPECT_FALSE(layers[1]->shown);
+    EXPECT_FALSE(layers[2]->shown);
+}
+
+TEST_F(Passthrough, hides_every_layer)
+{
+    stack.show({bottom, middle}, view.top_left);
+    stack.hide();
+
+    ASSERT_THAT(layers, SizeIs(2));
+    EXPECT_FALSE(layers[0]->shown);
+    EXPECT_FALSE(layers[1]->shown);
+}
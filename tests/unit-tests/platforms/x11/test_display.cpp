@@ -24,6 +24,8 @@
 #include "src/server/report/null/display_report.h"
 
 #include "mir/graphics/display_configuration.h"
+#include "mir/graphics/cursor.h"
+#include "mir/graphics/cursor_image.h"
 
 #include "mir/test/doubles/null_display_configuration_policy.h"
 #include "mir/test/doubles/mock_egl.h"
@@ -42,7 +44,14 @@ using namespace testing;
 
 namespace
 {
+struct StubCursorImage : mg::CursorImage
+{
+    void const* as_argb_8888() const override { return pixels; }
+    geom::Size size() const override { return {16, 16}; }
+    geom::Displacement hotspot() const override { return {3, 4}; }
 
+    uint32_t pixels[16 * 16] = {};
+};
 
 class X11DisplayTest : public ::testing::Test
 {
@@ -365,3 +374,51 @@ TEST_F(X11DisplayTest, updates_scale_property_correctly)
 
     EXPECT_THAT(new_scale, Eq(scale));
 }
+
+TEST_F(X11DisplayTest, creates_a_hardware_cursor)
+{
+    auto display = create_display();
+
+    EXPECT_THAT(display->create_hardware_cursor(), NotNull());
+}
+
+TEST_F(X11DisplayTest, hardware_cursor_defines_x_cursor_for_output_windows)
+{
+    StubCursorImage const image;
+    auto display = create_display();
+    auto const cursor = display->create_hardware_cursor();
+
+    EXPECT_CALL(mock_x11, XcursorImageLoadCursor(mock_x11.fake_x11.display,
+        Pointee(AllOf(Field(&XcursorImage::xhot, 3u), Field(&XcursorImage::yhot, 4u)))));
+    EXPECT_CALL(mock_x11, XDefineCursor(mock_x11.fake_x11.display, mock_x11.fake_x11.window, mock_x11.fake_x11.cursor));
+    EXPECT_CALL(mock_x11, XFlush(mock_x11.fake_x11.display)).Times(AtLeast(1));
+
+    cursor->show(image);
+}
+
+TEST_F(X11DisplayTest, hardware_cursor_frees_the_x_cursor_it_replaces)
+{
+    StubCursorImage const image;
+    auto display = create_display();
+    auto const cursor = display->create_hardware_cursor();
+    cursor->show(image);
+
+    EXPECT_CALL(mock_x11, XFreeCursor(mock_x11.fake_x11.display, mock_x11.fake_x11.cursor));
+
+    cursor->hide();
+    Mock::VerifyAndClearExpectations(&mock_x11);
+}
+
+TEST_F(X11DisplayTest, moving_hardware_cursor_makes_no_x_requests)
+{
+    StubCursorImage const image;
+    auto display = create_display();
+    auto const cursor = display->create_hardware_cursor();
+    cursor->show(image);
+
+    EXPECT_CALL(mock_x11, XDefineCursor(_, _, _)).Times(0);
+    EXPECT_CALL(mock_x11, XFlush(_)).Times(0);
+
+    cursor->move_to({100, 100});
+    Mock::VerifyAndClearExpectations(&mock_x11);
+}
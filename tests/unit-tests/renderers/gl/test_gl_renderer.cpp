@@ -29,6 +29,7 @@
 #include <mir/test/doubles/mock_gl.h>
 #include <mir/test/doubles/mock_egl.h>
 #include <src/renderers/gl/renderer.h>
+#include <src/renderers/gl/program_cache.h>
 #include <mir/test/doubles/stub_gl_display_buffer.h>
 #include <mir/test/doubles/mock_gl_display_buffer.h>
 
@@ -220,6 +221,33 @@ TEST_F(GLRenderer, avoids_src_alpha_for_rgbx_blending)  // LP: #1423462
     renderer.render(renderable_list);
 }
 
+TEST_F(GLRenderer, uploads_the_vertices_of_all_renderables_at_once)
+{
+    renderable_list.push_back(renderable);
+
+    EXPECT_CALL(mock_gl, glBufferData(GL_ARRAY_BUFFER, 2 * 4 * sizeof(mgl::Vertex), _, GL_STREAM_DRAW));
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLE_FAN, 0, 4));
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLE_FAN, 4, 4));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, does_not_repeat_state_changes_between_similar_renderables)
+{
+    renderable_list.push_back(renderable);
+    renderable_list.push_back(renderable);
+
+    mrg::Renderer renderer(display_buffer);
+
+    EXPECT_CALL(mock_gl, glUseProgram(_));
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glEnableVertexAttribArray(_)).Times(2);
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(3);
+
+    renderer.render(renderable_list);
+}
+
 TEST_F(GLRenderer, clears_all_channels_zero)
 {
     InSequence seq;
@@ -466,3 +494,18 @@ TEST_F(GLRenderer, sets_viewport_downscaled_wide)
 
     mrg::Renderer renderer(mock_display_buffer);
 }
+
+TEST_F(GLRenderer, sets_uniforms_of_a_shared_program_again_after_another_renderer_used_it)
+{
+    auto const program_cache = std::make_shared<mrg::ProgramCache>("");
+    mrg::Renderer renderer(display_buffer, program_cache);
+    mrg::Renderer other_renderer(display_buffer, program_cache);
+
+    renderer.render(renderable_list);
+    other_renderer.render(renderable_list);
+
+    EXPECT_CALL(mock_gl, glUseProgram(stub_program));
+    EXPECT_CALL(mock_gl, glUniformMatrix4fv(screen_to_gl_coords_uniform_location, 1, GL_FALSE, _))
+        .Times(AtLeast(1));
+    renderer.render(renderable_list);
+}
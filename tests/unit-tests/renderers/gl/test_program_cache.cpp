@@ -0,0 +1,215 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/gl/program_cache.h"
+
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_egl.h"
+
+#include <GLES2/gl2ext.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace mrg = mir::renderer::gl;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+GLuint const built_program{7};
+GLuint const loaded_program{9};
+GLenum const binary_format{0x1234};
+std::string const binary{"binary"};
+
+GLchar const* const vertex_src = "vertex";
+GLchar const* const fragment_src = "fragment";
+
+std::vector<std::string> loaded_binaries;
+
+void get_program_binary(GLuint, GLsizei size, GLsizei* length, GLenum* format, void* data)
+{
+    *length = std::min<GLsizei>(size, binary.size());
+    *format = binary_format;
+    memcpy(data, binary.data(), *length);
+}
+
+void program_binary(GLuint, GLenum format, void const* data, GLint length)
+{
+    if (format == binary_format)
+        loaded_binaries.emplace_back(static_cast<char const*>(data), length);
+}
+
+struct ProgramCache : Test
+{
+    ProgramCache()
+    {
+        char name[] = "/tmp/mir_program_cache_XXXXXX";
+        if (!mkdtemp(name))
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to create temporary directory"};
+        }
+        directory = name;
+
+        loaded_binaries.clear();
+
+        ON_CALL(mock_gl, glGetString(GL_EXTENSIONS))
+            .WillByDefault(Return(reinterpret_cast<GLubyte const*>("GL_OES_get_program_binary")));
+        ON_CALL(mock_gl, glGetString(GL_RENDERER))
+            .WillByDefault(Invoke([this](GLenum) { return reinterpret_cast<GLubyte const*>(renderer.c_str()); }));
+        ON_CALL(mock_gl, glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, _))
+            .WillByDefault(SetArgPointee<1>(1));
+        ON_CALL(mock_gl, glGetProgramiv(_, GL_PROGRAM_BINARY_LENGTH_OES, _))
+            .WillByDefault(SetArgPointee<2>(binary.size()));
+        ON_CALL(mock_gl, glGetProgramiv(_, GL_LINK_STATUS, _))
+            .WillByDefault(SetArgPointee<2>(GL_TRUE));
+        ON_CALL(mock_gl, glCreateProgram())
+            .WillByDefault(Return(loaded_program));
+
+        ON_CALL(mock_egl, eglGetProcAddress(StrEq("glGetProgramBinaryOES")))
+            .WillByDefault(Return(reinterpret_cast<mtd::MockEGL::generic_function_pointer_t>(&get_program_binary)));
+        ON_CALL(mock_egl, eglGetProcAddress(StrEq("glProgramBinaryOES")))
+            .WillByDefault(Return(reinterpret_cast<mtd::MockEGL::generic_function_pointer_t>(&program_binary)));
+    }
+
+    ~ProgramCache()
+    {
+        boost::system::error_code ignored;
+        boost::filesystem::remove_all(directory, ignored);
+    }
+
+    auto shared_program_from(mrg::ProgramCache& cache) -> std::shared_ptr<mrg::SharedProgram>
+    {
+        return cache.program(vertex_src, fragment_src, [this] { ++builds; return built_program; });
+    }
+
+    /// The id of a program no one else is using (so it is deleted again)
+    auto program_from(mrg::ProgramCache& cache) -> GLuint
+    {
+        return shared_program_from(cache)->id;
+    }
+
+    NiceMock<mtd::MockGL> mock_gl;
+    NiceMock<mtd::MockEGL> mock_egl;
+    std::string directory;
+    std::string renderer{"llvmpipe"};
+    int builds{0};
+};
+}
+
+TEST_F(ProgramCache, builds_a_program_it_has_not_seen)
+{
+    mrg::ProgramCache cache{directory};
+
+    EXPECT_THAT(program_from(cache), Eq(built_program));
+    EXPECT_THAT(builds, Eq(1));
+}
+
+TEST_F(ProgramCache, loads_a_program_it_has_seen_from_its_binary)
+{
+    mrg::ProgramCache cache{""};
+    program_from(cache);
+
+    EXPECT_THAT(program_from(cache), Eq(loaded_program));
+    EXPECT_THAT(builds, Eq(1));
+    EXPECT_THAT(loaded_binaries, ElementsAre(binary));
+}
+
+TEST_F(ProgramCache, loads_a_program_built_by_an_earlier_run)
+{
+    {
+        mrg::ProgramCache earlier_run{directory};
+        program_from(earlier_run);
+    }
+
+    mrg::ProgramCache cache{directory};
+
+    EXPECT_THAT(program_from(cache), Eq(loaded_program));
+    EXPECT_THAT(builds, Eq(1));
+}
+
+TEST_F(ProgramCache, rebuilds_programs_for_a_different_driver)
+{
+    {
+        mrg::ProgramCache earlier_run{directory};
+        program_from(earlier_run);
+    }
+
+    renderer = "some other GPU";
+    mrg::ProgramCache cache{directory};
+
+    EXPECT_THAT(program_from(cache), Eq(built_program));
+    EXPECT_THAT(builds, Eq(2));
+}
+
+TEST_F(ProgramCache, rebuilds_a_program_whose_binary_is_rejected)
+{
+    mrg::ProgramCache cache{""};
+    program_from(cache);
+
+    EXPECT_CALL(mock_gl, glGetProgramiv(_, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_gl, glGetProgramiv(loaded_program, GL_LINK_STATUS, _))
+        .WillOnce(SetArgPointee<2>(GL_FALSE));
+    EXPECT_CALL(mock_gl, glDeleteProgram(_)).Times(AnyNumber());
+    EXPECT_CALL(mock_gl, glDeleteProgram(loaded_program));
+
+    EXPECT_THAT(program_from(cache), Eq(built_program));
+    EXPECT_THAT(builds, Eq(2));
+}
+
+TEST_F(ProgramCache, always_builds_programs_without_binary_support)
+{
+    ON_CALL(mock_gl, glGetString(GL_EXTENSIONS))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("GL_OES_EGL_image")));
+    mrg::ProgramCache cache{directory};
+
+    program_from(cache);
+    program_from(cache);
+
+    EXPECT_THAT(builds, Eq(2));
+}
+
+TEST_F(ProgramCache, shares_a_program_while_it_is_used)
+{
+    mrg::ProgramCache cache{""};
+
+    auto const program = shared_program_from(cache);
+
+    EXPECT_THAT(shared_program_from(cache), Eq(program));
+    EXPECT_THAT(builds, Eq(1));
+    EXPECT_THAT(loaded_binaries, IsEmpty());
+}
+
+TEST_F(ProgramCache, deletes_a_program_when_it_is_no_longer_used)
+{
+    mrg::ProgramCache cache{""};
+    auto program = shared_program_from(cache);
+
+    EXPECT_CALL(mock_gl, glDeleteProgram(built_program));
+
+    program.reset();
+}
@@ -0,0 +1,412 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/software/renderer.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/graphics/transformation.h"
+
+#include "mir/graphics/buffer_basic.h"
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/stub_display_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+class StubSoftwareDisplayBuffer : public mtd::StubDisplayBuffer,
+                                  public mrs::RenderTarget
+{
+public:
+    StubSoftwareDisplayBuffer(geom::Rectangle const& area)
+        : StubDisplayBuffer{area},
+          size{area.size},
+          pixels(area.size.width.as_int() * area.size.height.as_int(), 0xdeadbeef)
+    {
+    }
+
+    auto map_framebuffer() -> std::unique_ptr<mrs::Mapping<unsigned char>> override
+    {
+        class PixelMapping : public mrs::Mapping<unsigned char>
+        {
+        public:
+            PixelMapping(std::vector<uint32_t>& pixels, geom::Size size)
+                : pixels{pixels}, size_{size}
+            {
+            }
+
+            MirPixelFormat format() const override { return mir_pixel_format_argb_8888; }
+            geom::Stride stride() const override { return geom::Stride{size_.width.as_int() * 4}; }
+            geom::Size size() const override { return size_; }
+            unsigned char* data() override { return reinterpret_cast<unsigned char*>(pixels.data()); }
+            size_t len() const override { return pixels.size() * 4; }
+
+        private:
+            std::vector<uint32_t>& pixels;
+            geom::Size const size_;
+        };
+
+        return std::make_unique<PixelMapping>(pixels, size);
+    }
+
+    void commit(std::vector<geom::Rectangle> const& damage) override
+    {
+        committed_damage = damage;
+        ++commits;
+    }
+
+    uint32_t pixel_at(int x, int y) const
+    {
+        return pixels[y * size.width.as_int() + x];
+    }
+
+    geom::Size const size;
+    std::vector<uint32_t> pixels;
+    int commits{0};
+    std::vector<geom::Rectangle> committed_damage;
+};
+
+/// A buffer with no CPU access at all
+struct UnmappableBuffer : mg::BufferBasic, mg::NativeBufferBase
+{
+    std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override { return nullptr; }
+    geom::Size size() const override { return {4, 4}; }
+    MirPixelFormat pixel_format() const override { return mir_pixel_format_argb_8888; }
+    mg::NativeBufferBase* native_buffer_base() override { return this; }
+};
+
+auto buffer_filled_with(geom::Size size, MirPixelFormat format, uint32_t value) -> std::shared_ptr<mtd::StubBuffer>
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        nullptr,
+        mg::BufferProperties{size, format, mg::BufferUsage::software},
+        geom::Stride{size.width.as_int() * 4});
+
+    std::vector<uint32_t> const content(size.width.as_int() * size.height.as_int(), value);
+    buffer->write(reinterpret_cast<unsigned char const*>(content.data()), content.size() * 4);
+    return buffer;
+}
+
+struct TestRenderable : mg::Renderable
+{
+    TestRenderable(std::shared_ptr<mg::Buffer> buffer, geom::Rectangle position)
+        : buffer_{std::move(buffer)}, position{position}
+    {
+    }
+
+    ID id() const override { return this; }
+    std::shared_ptr<mg::Buffer> buffer() const override { return buffer_; }
+    geom::Rectangle screen_position() const override { return position; }
+    std::experimental::optional<geom::Rectangle> clip_area() const override { return {}; }
+    float alpha() const override { return alpha_; }
+    glm::mat4 transformation() const override { return glm::mat4{1}; }
+    bool shaped() const override { return shaped_; }
+    unsigned int swap_interval() const override { return 1; }
+    mg::TextureBounds texture_bounds() const override { return bounds; }
+
+    std::shared_ptr<mg::Buffer> buffer_;
+    geom::Rectangle position;
+    float alpha_{1.0f};
+    bool shaped_{false};
+    mg::TextureBounds bounds;
+};
+
+struct SoftwareRenderer : Test
+{
+    geom::Rectangle const view_area{{0, 0}, {16, 16}};
+    StubSoftwareDisplayBuffer display_buffer{view_area};
+};
+}
+
+TEST_F(SoftwareRenderer, throws_for_display_buffer_without_software_target)
+{
+    mtd::StubDisplayBuffer gl_only{view_area};
+
+    EXPECT_THROW((mrs::Renderer{gl_only}), std::logic_error);
+}
+
+TEST_F(SoftwareRenderer, composites_opaque_buffer_at_its_position_and_clears_the_rest)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 4}, mir_pixel_format_argb_8888, 0xff112233), geom::Rectangle{{2, 3}, {4, 4}});
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.pixel_at(2, 3), Eq(0xff112233u));
+    EXPECT_THAT(display_buffer.pixel_at(5, 6), Eq(0xff112233u));
+    EXPECT_THAT(display_buffer.pixel_at(1, 3), Eq(0u));
+    EXPECT_THAT(display_buffer.pixel_at(6, 6), Eq(0u));
+    EXPECT_THAT(display_buffer.commits, Eq(1));
+}
+
+TEST_F(SoftwareRenderer, swaps_red_and_blue_of_abgr_buffers)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 4}, mir_pixel_format_abgr_8888, 0xff112233), geom::Rectangle{{0, 0}, {4, 4}});
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(0xff332211u));
+}
+
+TEST_F(SoftwareRenderer, blends_shaped_renderable_over_those_below)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const below = std::make_shared<TestRenderable>(
+        buffer_filled_with({16, 16}, mir_pixel_format_xrgb_8888, 0x00ffffff), view_area);
+    auto const above = std::make_shared<TestRenderable>(
+        buffer_filled_with({16, 16}, mir_pixel_format_argb_8888, 0x80000080), view_area);
+    above->shaped_ = true;
+
+    renderer.render({below, above});
+
+    // Premultiplied OVER: 0x80 + 0xff * (0xff - 0x80) / 0xff = 0xff; 0 + 0xff * 0x7f / 0xff = 0x7f
+    EXPECT_THAT(display_buffer.pixel_at(8, 8), Eq(0xff7f7fffu));
+}
+
+TEST_F(SoftwareRenderer, applies_renderable_alpha)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({16, 16}, mir_pixel_format_xrgb_8888, 0x00ffffff), view_area);
+    renderable->alpha_ = 0.5f;
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(0x80808080u));
+}
+
+TEST_F(SoftwareRenderer, scales_buffer_to_screen_position)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({2, 2}, mir_pixel_format_argb_8888, 0xff00ff00), view_area);
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0xff00ff00u)));
+}
+
+TEST_F(SoftwareRenderer, scales_only_the_texture_bounds_to_screen_position)
+{
+    mrs::Renderer renderer{display_buffer};
+    geom::Size const size{4, 4};
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        nullptr,
+        mg::BufferProperties{size, mir_pixel_format_argb_8888, mg::BufferUsage::software},
+        geom::Stride{size.width.as_int() * 4});
+    // Left half red, right half green
+    std::vector<uint32_t> const content{
+        0xffff0000, 0xffff0000, 0xff00ff00, 0xff00ff00,
+        0xffff0000, 0xffff0000, 0xff00ff00, 0xff00ff00,
+        0xffff0000, 0xffff0000, 0xff00ff00, 0xff00ff00,
+        0xffff0000, 0xffff0000, 0xff00ff00, 0xff00ff00};
+    buffer->write(reinterpret_cast<unsigned char const*>(content.data()), content.size() * 4);
+    auto const renderable = std::make_shared<TestRenderable>(buffer, view_area);
+    renderable->bounds = {0.5f, 0.0f, 1.0f, 1.0f};
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0xff00ff00u)));
+}
+
+TEST_F(SoftwareRenderer, changing_texture_bounds_damages_renderable)
+{
+    mrs::Renderer renderer{display_buffer};
+    geom::Rectangle const position{{4, 4}, {4, 4}};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 4}, mir_pixel_format_argb_8888, 0xff112233), position);
+
+    renderer.render({renderable});
+    renderable->bounds = {0.0f, 0.0f, 0.5f, 0.5f};
+    renderer.render({renderable});
+
+    EXPECT_THAT(renderer.last_damage(), ElementsAre(position));
+}
+
+TEST_F(SoftwareRenderer, unchanged_scene_is_not_recomposited)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 4}, mir_pixel_format_argb_8888, 0xff112233), geom::Rectangle{{0, 0}, {4, 4}});
+
+    renderer.render({renderable});
+    std::fill(display_buffer.pixels.begin(), display_buffer.pixels.end(), 0xdeadbeef);
+    renderer.render({renderable});
+
+    EXPECT_THAT(renderer.last_damage(), IsEmpty());
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0xdeadbeefu)));
+    EXPECT_THAT(display_buffer.commits, Eq(2));
+}
+
+TEST_F(SoftwareRenderer, new_buffer_damages_only_its_renderable)
+{
+    mrs::Renderer renderer{display_buffer};
+    geom::Rectangle const position{{4, 4}, {4, 4}};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 4}, mir_pixel_format_argb_8888, 0xff112233), position);
+
+    renderer.render({renderable});
+    renderable->buffer_ = buffer_filled_with({4, 4}, mir_pixel_format_argb_8888, 0xff445566);
+    renderer.render({renderable});
+
+    EXPECT_THAT(renderer.last_damage(), ElementsAre(position));
+    EXPECT_THAT(display_buffer.pixel_at(4, 4), Eq(0xff445566u));
+}
+
+TEST_F(SoftwareRenderer, commits_only_the_recomposited_framebuffer_area)
+{
+    mrs::Renderer renderer{display_buffer};
+    geom::Rectangle const position{{4, 4}, {4, 4}};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 4}, mir_pixel_format_argb_8888, 0xff112233), position);
+
+    renderer.render({renderable});
+    EXPECT_THAT(display_buffer.committed_damage, ElementsAre(view_area));
+
+    renderable->buffer_ = buffer_filled_with({4, 4}, mir_pixel_format_argb_8888, 0xff445566);
+    renderer.render({renderable});
+    EXPECT_THAT(display_buffer.committed_damage, ElementsAre(position));
+
+    renderer.render({renderable});
+    EXPECT_THAT(display_buffer.committed_damage, IsEmpty());
+}
+
+TEST_F(SoftwareRenderer, reports_a_buffer_that_cannot_be_mapped_only_once)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const renderable = std::make_shared<TestRenderable>(
+        std::make_shared<UnmappableBuffer>(), geom::Rectangle{{0, 0}, {4, 4}});
+
+    std::stringstream errors;
+    auto const saved = std::cerr.rdbuf(errors.rdbuf());
+
+    renderer.render({renderable});
+    auto const first_frame = errors.str();
+    renderer.suspend();
+    renderer.render({renderable});
+    auto const second_frame = errors.str();
+
+    std::cerr.rdbuf(saved);
+
+    EXPECT_THAT(first_frame, Not(IsEmpty()));
+    EXPECT_THAT(second_frame, Eq(first_frame));
+}
+
+TEST_F(SoftwareRenderer, moving_renderable_damages_old_and_new_positions)
+{
+    mrs::Renderer renderer{display_buffer};
+    geom::Rectangle const before{{0, 0}, {4, 4}};
+    geom::Rectangle const after{{8, 8}, {4, 4}};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 4}, mir_pixel_format_argb_8888, 0xff112233), before);
+
+    renderer.render({renderable});
+    renderable->position = after;
+    renderer.render({renderable});
+
+    EXPECT_THAT(renderer.last_damage(), UnorderedElementsAre(before, after));
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(0u));
+    EXPECT_THAT(display_buffer.pixel_at(8, 8), Eq(0xff112233u));
+}
+
+TEST_F(SoftwareRenderer, removed_renderable_damages_its_old_position)
+{
+    mrs::Renderer renderer{display_buffer};
+    geom::Rectangle const position{{2, 2}, {4, 4}};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 4}, mir_pixel_format_argb_8888, 0xff112233), position);
+
+    renderer.render({renderable});
+    renderer.render({});
+
+    EXPECT_THAT(renderer.last_damage(), ElementsAre(position));
+    EXPECT_THAT(display_buffer.pixel_at(2, 2), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, suspend_forces_full_redraw)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 4}, mir_pixel_format_argb_8888, 0xff112233), geom::Rectangle{{0, 0}, {4, 4}});
+
+    renderer.render({renderable});
+    renderer.suspend();
+    renderer.render({renderable});
+
+    EXPECT_THAT(renderer.last_damage(), ElementsAre(view_area));
+}
+
+TEST_F(SoftwareRenderer, rotates_output_as_the_gl_renderer_does)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 2}, mir_pixel_format_argb_8888, 0xff112233), geom::Rectangle{{0, 0}, {4, 2}});
+
+    renderer.set_output_transform(mg::transformation(mir_orientation_left));
+    renderer.render({renderable});
+
+    // The top left of the screen is shown at the bottom left of the framebuffer
+    EXPECT_THAT(display_buffer.pixel_at(0, 12), Eq(0xff112233u));
+    EXPECT_THAT(display_buffer.pixel_at(1, 15), Eq(0xff112233u));
+    EXPECT_THAT(display_buffer.pixel_at(2, 12), Eq(0u));
+    EXPECT_THAT(display_buffer.pixel_at(0, 11), Eq(0u));
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, mirrors_output)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 2}, mir_pixel_format_argb_8888, 0xff112233), geom::Rectangle{{0, 0}, {4, 2}});
+
+    renderer.set_output_transform(mg::transformation(mir_mirror_mode_horizontal));
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.pixel_at(12, 0), Eq(0xff112233u));
+    EXPECT_THAT(display_buffer.pixel_at(15, 1), Eq(0xff112233u));
+    EXPECT_THAT(display_buffer.pixel_at(11, 0), Eq(0u));
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, redraws_everything_when_the_output_transform_changes)
+{
+    mrs::Renderer renderer{display_buffer};
+    auto const renderable = std::make_shared<TestRenderable>(
+        buffer_filled_with({4, 2}, mir_pixel_format_argb_8888, 0xff112233), geom::Rectangle{{0, 0}, {4, 2}});
+
+    renderer.render({renderable});
+    renderer.set_output_transform(mg::transformation(mir_mirror_mode_horizontal));
+    renderer.render({renderable});
+
+    EXPECT_THAT(renderer.last_damage(), ElementsAre(view_area));
+    EXPECT_THAT(display_buffer.pixel_at(0, 0), Eq(0u));
+    EXPECT_THAT(display_buffer.pixel_at(12, 0), Eq(0xff112233u));
+}
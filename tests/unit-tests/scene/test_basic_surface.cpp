@@ -415,6 +415,22 @@ TEST_F(BasicSurfaceTest, test_surface_set_transformation_updates_transform)
     EXPECT_EQ(trans, got);
 }
 
+TEST_F(BasicSurfaceTest, renderable_shows_the_texture_bounds_of_its_buffer)
+{
+    using namespace testing;
+    mg::TextureBounds const bounds{0.25f, 0.0f, 0.75f, 1.0f};
+    auto const buffer = std::make_shared<mtd::StubBuffer>();
+
+    ON_CALL(*mock_buffer_stream, lock_compositor_buffer(_))
+        .WillByDefault(Return(buffer));
+    EXPECT_CALL(*mock_buffer_stream, texture_bounds(Ref(*buffer)))
+        .WillOnce(Return(bounds));
+
+    auto renderables = surface.generate_renderables(compositor_id);
+    ASSERT_THAT(renderables.size(), testing::Eq(1));
+    EXPECT_THAT(renderables[0]->texture_bounds(), Eq(bounds));
+}
+
 TEST_F(BasicSurfaceTest, test_surface_is_opaque_by_default)
 {
     using namespace testing;
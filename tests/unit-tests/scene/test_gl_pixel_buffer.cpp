@@ -225,3 +225,41 @@ TEST_F(GLPixelBufferTest, returns_data_from_rgba_buffer_texture)
     EXPECT_EQ(width - 1,
               static_cast<uint32_t const*>(data)[width * height - 1]);
 }
+
+TEST_F(GLPixelBufferTest, reads_back_only_the_scaled_down_pixels)
+{
+    using namespace testing;
+    GLuint const program{30};
+    geom::Size const scaled{14, 20};
+
+    ON_CALL(mock_gl, glCreateProgram()).WillByDefault(Return(program));
+    EXPECT_CALL(mock_context, make_current()).Times(AtLeast(1));
+
+    /* 51x71 is halved to 26x36, then scaled to fit 20x20 */
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLE_STRIP, 0, 4)).Times(2);
+    EXPECT_CALL(mock_gl, glReadPixels(0, 0, scaled.width.as_int(), scaled.height.as_int(), _, _, _));
+    EXPECT_CALL(mock_gl, glReadPixels(0, 0, 51, 71, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glDeleteProgram(program));
+
+    ms::GLPixelBuffer pixels{std::move(context)};
+
+    pixels.fill_from(mock_buffer, geom::Size{20, 20});
+
+    EXPECT_EQ(scaled, pixels.size());
+    EXPECT_EQ(geom::Stride{scaled.width.as_int() * 4}, pixels.stride());
+}
+
+TEST_F(GLPixelBufferTest, does_not_scale_up_a_buffer_that_fits)
+{
+    using namespace testing;
+
+    EXPECT_CALL(mock_context, make_current()).Times(AtLeast(1));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glReadPixels(0, 0, 51, 71, _, _, _));
+
+    ms::GLPixelBuffer pixels{std::move(context)};
+
+    pixels.fill_from(mock_buffer, geom::Size{640, 480});
+
+    EXPECT_EQ(mock_buffer.size(), pixels.size());
+}
@@ -22,10 +22,12 @@
 #include "mir/geometry/rectangles.h"
 #include "src/server/scene/broadcasting_session_event_sink.h"
 #include "mir/server_action_queue.h"
+#include "mir/graphics/incrementally_configurable_display.h"
 
 #include "mir/test/doubles/mock_display.h"
 #include "mir/test/doubles/mock_compositor.h"
 #include "mir/test/doubles/null_display_configuration.h"
+#include "mir/test/doubles/null_display_sync_group.h"
 #include "mir/test/doubles/stub_display_configuration.h"
 #include "mir/test/doubles/mock_scene_session.h"
 #include "mir/test/doubles/stub_session.h"
@@ -77,6 +79,12 @@ struct MockDisplay : public mtd::MockDisplay
     std::unique_ptr<mg::DisplayConfiguration> config;
 };
 
+struct MockIncrementallyConfigurableDisplay : MockDisplay, mg::IncrementallyConfigurableDisplay
+{
+    MOCK_METHOD2(configure_incrementally,
+        void(mg::DisplayConfiguration const&, std::function<void(mg::DisplaySyncGroup&)> const&));
+};
+
 struct StubServerActionQueue : mir::ServerActionQueue
 {
     void enqueue(void const* /*owner*/, mir::ServerAction const& action) override
@@ -165,6 +173,43 @@ TEST_F(MediatingDisplayChangerTest, pauses_system_when_applying_new_configuratio
                        mt::fake_shared(conf));
 }
 
+TEST_F(MediatingDisplayChangerTest, only_stops_compositing_to_replaced_groups_when_display_is_incrementally_configurable)
+{
+    using namespace testing;
+    NiceMock<MockIncrementallyConfigurableDisplay> display;
+    mtd::StubDisplaySyncGroup replaced_group{geom::Size{640, 480}};
+    mtd::NullDisplayConfiguration conf;
+    auto session = std::make_shared<mtd::StubSession>();
+
+    changer = std::make_shared<ms::MediatingDisplayChanger>(
+                  mt::fake_shared(display),
+                  mt::fake_shared(mock_compositor),
+                  mt::fake_shared(mock_conf_policy),
+                  mt::fake_shared(session_container),
+                  mt::fake_shared(session_event_sink),
+                  mt::fake_shared(server_action_queue),
+                  mt::fake_shared(display_configuration_observer),
+                  mt::fake_shared(alarm_factory));
+
+    ON_CALL(display, apply_if_configuration_preserves_display_buffers(_))
+        .WillByDefault(Return(false));
+    ON_CALL(display, configure_incrementally(_, _))
+        .WillByDefault(Invoke([&](auto const&, auto const& invalidating) { invalidating(replaced_group); }));
+
+    EXPECT_CALL(mock_compositor, stop()).Times(0);
+    EXPECT_CALL(mock_compositor, start()).Times(0);
+    EXPECT_CALL(display, configure(_)).Times(0);
+
+    InSequence s;
+    EXPECT_CALL(display, configure_incrementally(Ref(conf), _));
+    EXPECT_CALL(mock_compositor, stop_compositing_to(Ref(replaced_group)));
+    EXPECT_CALL(mock_compositor, start_compositing_to_new_groups());
+
+    session_event_sink.handle_focus_change(session);
+    changer->configure(session,
+                       mt::fake_shared(conf));
+}
+
 TEST_F(MediatingDisplayChangerTest, does_not_pause_system_when_applying_new_configuration_for_focused_session_would_preserve_display_buffers)
 {
     using namespace testing;
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/software_pixel_buffer.h"
+#include "mir/graphics/buffer_properties.h"
+
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+auto buffer_with(geom::Size size, MirPixelFormat format, std::vector<uint32_t> const& content)
+    -> std::unique_ptr<mtd::StubBuffer>
+{
+    auto buffer = std::make_unique<mtd::StubBuffer>(
+        mg::BufferProperties{size, format, mg::BufferUsage::software});
+    buffer->write(
+        reinterpret_cast<unsigned char const*>(content.data()),
+        content.size() * sizeof(uint32_t));
+    return buffer;
+}
+
+auto pixels_of(ms::PixelBuffer& pixels) -> std::vector<uint32_t>
+{
+    auto const data = static_cast<uint32_t const*>(pixels.as_argb_8888());
+    return {data, data + pixels.size().width.as_int() * pixels.size().height.as_int()};
+}
+}
+
+TEST(SoftwarePixelBuffer, copies_argb_pixels_unchanged)
+{
+    using namespace testing;
+    std::vector<uint32_t> const content{0x11223344, 0x55667788, 0x99aabbcc, 0xddeeff00};
+    auto const buffer = buffer_with({2, 2}, mir_pixel_format_argb_8888, content);
+    ms::SoftwarePixelBuffer pixels;
+
+    pixels.fill_from(*buffer);
+
+    EXPECT_THAT(pixels.size(), Eq(geom::Size{2, 2}));
+    EXPECT_THAT(pixels.stride(), Eq(geom::Stride{8}));
+    EXPECT_THAT(pixels_of(pixels), ElementsAreArray(content));
+}
+
+TEST(SoftwarePixelBuffer, converts_abgr_pixels_to_argb)
+{
+    using namespace testing;
+    auto const buffer = buffer_with({2, 1}, mir_pixel_format_abgr_8888, {0x11223344, 0x55667788});
+    ms::SoftwarePixelBuffer pixels;
+
+    pixels.fill_from(*buffer);
+
+    EXPECT_THAT(pixels_of(pixels), ElementsAre(0x11443322, 0x55887766));
+}
+
+TEST(SoftwarePixelBuffer, makes_xrgb_pixels_opaque)
+{
+    using namespace testing;
+    auto const buffer = buffer_with({1, 1}, mir_pixel_format_xrgb_8888, {0x00123456});
+    ms::SoftwarePixelBuffer pixels;
+
+    pixels.fill_from(*buffer);
+
+    EXPECT_THAT(pixels_of(pixels), ElementsAre(0xff123456));
+}
+
+TEST(SoftwarePixelBuffer, scales_down_to_fit_max_size_averaging_every_pixel)
+{
+    using namespace testing;
+    std::vector<uint32_t> const content{
+        0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ff00,
+        0xff0000ff, 0xff000000, 0xff00ff00, 0xff00ff00};
+    auto const buffer = buffer_with({4, 2}, mir_pixel_format_argb_8888, content);
+    ms::SoftwarePixelBuffer pixels;
+
+    pixels.fill_from(*buffer, geom::Size{2, 2});
+
+    EXPECT_THAT(pixels.size(), Eq(geom::Size{2, 1}));
+    EXPECT_THAT(pixels_of(pixels), ElementsAre(0xff000080, 0xff00ff00));
+}
+
+TEST(SoftwarePixelBuffer, empty_max_size_means_full_size)
+{
+    using namespace testing;
+    auto const buffer = buffer_with({3, 1}, mir_pixel_format_argb_8888, {1, 2, 3});
+    ms::SoftwarePixelBuffer pixels;
+
+    pixels.fill_from(*buffer, geom::Size{});
+
+    EXPECT_THAT(pixels.size(), Eq(geom::Size{3, 1}));
+}
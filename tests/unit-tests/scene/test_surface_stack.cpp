@@ -84,6 +84,7 @@ struct MockSceneObserver : public ms::Observer
     MOCK_METHOD1(surface_removed, void(std::shared_ptr<ms::Surface> const&));
     MOCK_METHOD1(surfaces_reordered, void(ms::SurfaceSet const&));
     MOCK_METHOD0(scene_changed, void());
+    MOCK_METHOD1(scene_damaged, void(geom::Rectangle const&));
 
     MOCK_METHOD1(surface_exists, void(std::shared_ptr<ms::Surface> const&));
     MOCK_METHOD0(end_observation, void());
@@ -952,6 +953,33 @@ TEST_F(SurfaceStack, scene_observers_notified_of_generic_scene_change)
     stack.emit_scene_changed();
 }
 
+TEST_F(SurfaceStack, scene_observers_notified_of_scene_damage)
+{
+    MockSceneObserver o1, o2;
+    geom::Rectangle const damage{{10, 20}, {30, 40}};
+
+    EXPECT_CALL(o1, scene_damaged(damage)).Times(1);
+    EXPECT_CALL(o2, scene_damaged(damage)).Times(1);
+    EXPECT_CALL(o1, scene_changed()).Times(0);
+    EXPECT_CALL(o2, scene_changed()).Times(0);
+
+    stack.add_observer(mt::fake_shared(o1));
+    stack.add_observer(mt::fake_shared(o2));
+
+    stack.emit_scene_damaged(damage);
+}
+
+TEST_F(SurfaceStack, scene_damage_does_not_leave_frames_pending)
+{
+    using namespace testing;
+
+    stack.scene_elements_for(compositor_id);
+
+    stack.emit_scene_damaged({{10, 20}, {30, 40}});
+
+    EXPECT_THAT(stack.frames_pending(compositor_id), Eq(0));
+}
+
 TEST_F(SurfaceStack, for_each_enumerates_all_input_surfaces)
 {
     using namespace ::testing;
@@ -1261,3 +1289,128 @@ TEST_F(SurfaceStack, all_depth_layers_are_handled)
     }
 
 }
+
+TEST_F(SurfaceStack, scene_elements_whose_buffer_was_used_report_it_composited_when_released)
+{
+    using namespace testing;
+
+    auto mock_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    ON_CALL(*mock_stream, lock_compositor_buffer(_))
+        .WillByDefault(Return(std::make_shared<mtd::StubBuffer>()));
+
+    auto const surface = std::make_shared<ms::BasicSurface>(
+        nullptr /* session */,
+        std::string("stub"),
+        geom::Rectangle{geom::Point{3, 4},geom::Size{1, 2}},
+        mir_pointer_unconfined,
+        std::list<ms::StreamInfo> { { mock_stream, {}, {} } },
+        std::shared_ptr<mg::CursorImage>(),
+        report);
+    stack.add_surface(surface, default_params.input_mode);
+
+    // Not drawn: the buffer is never taken
+    EXPECT_CALL(*mock_stream, frame_composited(_)).Times(0);
+    stack.scene_elements_for(compositor_id);
+    Mock::VerifyAndClearExpectations(mock_stream.get());
+
+    EXPECT_CALL(*mock_stream, frame_composited(compositor_id)).Times(1);
+    {
+        auto const elements = stack.scene_elements_for(compositor_id);
+        ASSERT_THAT(elements.size(), Eq(1u));
+        elements.front()->renderable()->buffer();
+    }
+}
+
+TEST_F(SurfaceStack, tells_the_streams_of_composited_surfaces_when_a_frame_is_posted)
+{
+    using namespace testing;
+
+    auto visible_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    auto hidden_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+
+    auto const make_surface = [&](std::shared_ptr<mc::BufferStream> const& stream)
+        {
+            return std::make_shared<ms::BasicSurface>(
+                nullptr /* session */,
+                std::string("stub"),
+                geom::Rectangle{geom::Point{3, 4},geom::Size{1, 2}},
+                mir_pointer_unconfined,
+                std::list<ms::StreamInfo> { { stream, {}, {} } },
+                std::shared_ptr<mg::CursorImage>(),
+                report);
+        };
+
+    auto const visible = make_surface(visible_stream);
+    auto const hidden = make_surface(hidden_stream);
+    hidden->hide();
+    stack.add_surface(visible, default_params.input_mode);
+    stack.add_surface(hidden, default_params.input_mode);
+
+    stack.scene_elements_for(compositor_id);
+
+    EXPECT_CALL(*visible_stream, frame_presented(compositor_id));
+    EXPECT_CALL(*hidden_stream, frame_presented(_)).Times(0);
+
+    stack.frame_presented(compositor_id);
+}
+
+TEST_F(SurfaceStack, tells_only_the_surfaces_in_the_scene_a_compositor_was_given_when_its_frame_is_posted)
+{
+    using namespace testing;
+
+    auto earlier_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    auto later_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+
+    auto const make_surface = [&](std::shared_ptr<mc::BufferStream> const& stream)
+        {
+            return std::make_shared<ms::BasicSurface>(
+                nullptr /* session */,
+                std::string("stub"),
+                geom::Rectangle{geom::Point{3, 4},geom::Size{1, 2}},
+                mir_pointer_unconfined,
+                std::list<ms::StreamInfo> { { stream, {}, {} } },
+                std::shared_ptr<mg::CursorImage>(),
+                report);
+        };
+
+    auto const other_compositor_id = &earlier_stream;
+    stack.register_compositor(other_compositor_id);
+
+    stack.add_surface(make_surface(earlier_stream), default_params.input_mode);
+    stack.scene_elements_for(compositor_id);
+    stack.add_surface(make_surface(later_stream), default_params.input_mode);
+    stack.scene_elements_for(other_compositor_id);
+
+    EXPECT_CALL(*earlier_stream, frame_presented(compositor_id)).Times(1);
+    EXPECT_CALL(*later_stream, frame_presented(compositor_id)).Times(0);
+
+    stack.frame_presented(compositor_id);
+    // Once for each scene
+    stack.frame_presented(compositor_id);
+}
+
+TEST_F(SurfaceStack, reports_the_frame_statistics_of_each_surface)
+{
+    using namespace testing;
+
+    auto mock_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    mc::FrameStatistics statistics;
+    statistics.frames_committed = 42;
+    ON_CALL(*mock_stream, frame_statistics()).WillByDefault(Return(statistics));
+
+    auto const surface = std::make_shared<ms::BasicSurface>(
+        nullptr /* session */,
+        std::string("counted"),
+        geom::Rectangle{geom::Point{3, 4},geom::Size{1, 2}},
+        mir_pointer_unconfined,
+        std::list<ms::StreamInfo> { { mock_stream, {}, {} } },
+        std::shared_ptr<mg::CursorImage>(),
+        report);
+    stack.add_surface(surface, default_params.input_mode);
+
+    auto const result = stack.frame_statistics();
+
+    ASSERT_THAT(result.size(), Eq(1u));
+    EXPECT_THAT(result[0].name, Eq("counted"));
+    EXPECT_THAT(result[0].frames.frames_committed, Eq(42u));
+}
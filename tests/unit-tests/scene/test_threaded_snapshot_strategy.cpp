@@ -33,6 +33,8 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <vector>
 
 namespace mg = mir::graphics;
 namespace ms = mir::scene;
@@ -49,6 +51,7 @@ public:
     ~MockPixelBuffer() noexcept {}
 
     MOCK_METHOD1(fill_from, void(mg::Buffer& buffer));
+    MOCK_METHOD2(fill_from, void(mg::Buffer& buffer, geom::Size const& max_size));
     MOCK_METHOD0(as_argb_8888, void const*());
     MOCK_CONST_METHOD0(size, geom::Size());
     MOCK_CONST_METHOD0(stride, geom::Stride());
@@ -66,6 +69,32 @@ struct NamedThreadBufferStream : mtd::StubBufferStream
     std::string thread_name;
 };
 
+/// Holds up each snapshot until released, and counts them
+struct BlockingBufferStream : mtd::StubBufferStream
+{
+    void with_most_recent_buffer_do(std::function<void(mg::Buffer & )> const& fn) override
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            times.push_back(std::chrono::steady_clock::now());
+        }
+        entered.raise();
+        release.wait_for(std::chrono::seconds{5});
+        StubBufferStream::with_most_recent_buffer_do(fn);
+    }
+
+    auto snapshot_times() -> std::vector<std::chrono::steady_clock::time_point>
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return times;
+    }
+
+    mt::Signal entered;
+    mt::Signal release;
+    std::mutex mutex;
+    std::vector<std::chrono::steady_clock::time_point> times;
+};
+
 struct ThreadedSnapshotStrategyTest : testing::Test
 {
     NamedThreadBufferStream buffer_access;
@@ -135,3 +164,152 @@ TEST_F(ThreadedSnapshotStrategyTest, names_snapshot_thread)
     EXPECT_THAT(buffer_access.thread_name, Eq("Mir/Snapshot"));
 }
 #endif
+
+TEST_F(ThreadedSnapshotStrategyTest, takes_scaled_snapshot)
+{
+    using namespace testing;
+
+    geom::Size const max_size{32, 24};
+
+    NiceMock<MockPixelBuffer> pixel_buffer;
+
+    EXPECT_CALL(pixel_buffer, fill_from(_)).Times(0);
+    EXPECT_CALL(pixel_buffer, fill_from(Ref(*buffer_access.stub_compositor_buffer), max_size));
+
+    ms::ThreadedSnapshotStrategy strategy{mt::fake_shared(pixel_buffer)};
+
+    mt::Signal snapshot_taken;
+
+    strategy.take_snapshot_of(
+        mt::fake_shared(buffer_access),
+        max_size,
+        [&](ms::Snapshot const&)
+        {
+            snapshot_taken.raise();
+        });
+
+    EXPECT_TRUE(snapshot_taken.wait_for(std::chrono::seconds{5}));
+}
+
+TEST_F(ThreadedSnapshotStrategyTest, pending_requests_for_a_stream_share_a_snapshot)
+{
+    using namespace testing;
+
+    NiceMock<MockPixelBuffer> pixel_buffer;
+    BlockingBufferStream busy;
+    mtd::StubBufferStream stream;
+
+    EXPECT_CALL(pixel_buffer, fill_from(Ref(*busy.stub_compositor_buffer)));
+    EXPECT_CALL(pixel_buffer, fill_from(Ref(*stream.stub_compositor_buffer))).Times(1);
+
+    ms::ThreadedSnapshotStrategy strategy{mt::fake_shared(pixel_buffer)};
+
+    std::atomic<int> snapshots_taken{0};
+    mt::Signal all_taken;
+    auto const count = [&](ms::Snapshot const&)
+        {
+            if (++snapshots_taken == 3)
+                all_taken.raise();
+        };
+
+    // Keep the only worker busy while the requests queue up
+    strategy.take_snapshot_of(mt::fake_shared(busy), count);
+    ASSERT_TRUE(busy.entered.wait_for(std::chrono::seconds{5}));
+
+    strategy.take_snapshot_of(mt::fake_shared(stream), count);
+    strategy.take_snapshot_of(mt::fake_shared(stream), count);
+    busy.release.raise();
+
+    EXPECT_TRUE(all_taken.wait_for(std::chrono::seconds{5}));
+    EXPECT_THAT(snapshots_taken, Eq(3));
+}
+
+TEST_F(ThreadedSnapshotStrategyTest, limits_the_rate_of_snapshots_of_a_stream)
+{
+    using namespace testing;
+
+    std::chrono::milliseconds const min_interval{100};
+
+    mtd::NullPixelBuffer pixel_buffer;
+    BlockingBufferStream stream;
+    stream.release.raise();
+
+    ms::ThreadedSnapshotStrategy strategy{{mt::fake_shared(pixel_buffer)}, min_interval};
+
+    for (int i = 0; i != 2; ++i)
+    {
+        mt::Signal snapshot_taken;
+        strategy.take_snapshot_of(
+            mt::fake_shared(stream),
+            [&](ms::Snapshot const&)
+            {
+                snapshot_taken.raise();
+            });
+        ASSERT_TRUE(snapshot_taken.wait_for(std::chrono::seconds{5}));
+    }
+
+    auto const times = stream.snapshot_times();
+    ASSERT_THAT(times.size(), Eq(2u));
+    EXPECT_THAT(times[1] - times[0], Ge(min_interval));
+}
+
+TEST_F(ThreadedSnapshotStrategyTest, workers_snapshot_different_streams_at_once)
+{
+    using namespace testing;
+
+    mtd::NullPixelBuffer first_pixels;
+    mtd::NullPixelBuffer second_pixels;
+    BlockingBufferStream busy;
+    mtd::StubBufferStream stream;
+
+    ms::ThreadedSnapshotStrategy strategy{
+        {mt::fake_shared(first_pixels), mt::fake_shared(second_pixels)},
+        std::chrono::milliseconds::zero()};
+
+    mt::Signal busy_taken;
+    mt::Signal snapshot_taken;
+
+    strategy.take_snapshot_of(mt::fake_shared(busy), [&](ms::Snapshot const&) { busy_taken.raise(); });
+    ASSERT_TRUE(busy.entered.wait_for(std::chrono::seconds{5}));
+
+    strategy.take_snapshot_of(mt::fake_shared(stream), [&](ms::Snapshot const&) { snapshot_taken.raise(); });
+
+    EXPECT_TRUE(snapshot_taken.wait_for(std::chrono::seconds{5}));
+    EXPECT_FALSE(busy_taken.raised());
+
+    busy.release.raise();
+    EXPECT_TRUE(busy_taken.wait_for(std::chrono::seconds{5}));
+}
+
+TEST_F(ThreadedSnapshotStrategyTest, makes_its_workers_on_the_first_snapshot_request)
+{
+    using namespace testing;
+
+    mtd::NullPixelBuffer pixel_buffer;
+    int pixel_buffers_made{0};
+
+    ms::ThreadedSnapshotStrategy strategy{
+        [&]
+        {
+            ++pixel_buffers_made;
+            return mt::fake_shared(pixel_buffer);
+        },
+        2,
+        std::chrono::milliseconds::zero()};
+
+    EXPECT_THAT(pixel_buffers_made, Eq(0));
+
+    for (int i = 0; i != 2; ++i)
+    {
+        mt::Signal snapshot_taken;
+        strategy.take_snapshot_of(
+            mt::fake_shared(buffer_access),
+            [&](ms::Snapshot const&)
+            {
+                snapshot_taken.raise();
+            });
+        ASSERT_TRUE(snapshot_taken.wait_for(std::chrono::seconds{5}));
+    }
+
+    EXPECT_THAT(pixel_buffers_made, Eq(2));
+}
@@ -22,6 +22,10 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 namespace
 {
 
@@ -157,3 +161,171 @@ TEST_F(ThreadSafeListTest, clears_all_elements)
 
     EXPECT_THAT(elements_seen, Eq(0));
 }
+
+TEST_F(ThreadSafeListTest, can_remove_element_while_iterating_same_element_recursively)
+{
+    using namespace testing;
+
+    list.add(element1);
+    list.add(element2);
+
+    int elements_seen = 0;
+
+    list.for_each(
+        [&] (Element const& outer)
+        {
+            list.for_each(
+                [&] (Element const& inner)
+                {
+                    if (inner == outer) list.remove(inner);
+                });
+            ++elements_seen;
+        });
+
+    EXPECT_THAT(elements_seen, Eq(2));
+
+    list.for_each([&] (Element const&) { ++elements_seen; });
+
+    EXPECT_THAT(elements_seen, Eq(2));
+}
+
+TEST_F(ThreadSafeListTest, remove_waits_for_element_in_use_in_different_thread)
+{
+    using namespace testing;
+
+    list.add(element1);
+
+    mir::test::Signal element_in_use;
+    std::atomic<bool> element_released{false};
+    std::atomic<bool> removed{false};
+
+    std::thread t{
+        [&]
+        {
+            list.for_each(
+                [&] (Element const&)
+                {
+                    element_in_use.raise();
+                    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+                    EXPECT_FALSE(removed);
+                    element_released = true;
+                });
+        }};
+
+    element_in_use.wait_for(std::chrono::seconds{3});
+    list.remove(element1);
+    removed = true;
+
+    EXPECT_TRUE(element_released);
+
+    t.join();
+}
+
+TEST_F(ThreadSafeListTest, reuses_items_of_removed_elements)
+{
+    using namespace testing;
+
+    std::vector<Element> elements_seen;
+
+    list.add(element1);
+    list.add(element2);
+    list.remove(element1);
+    list.add(element1);
+
+    list.for_each(
+        [&] (Element const& element)
+        {
+            elements_seen.push_back(element);
+        });
+
+    EXPECT_THAT(elements_seen, ElementsAre(element1, element2));
+}
+
+TEST_F(ThreadSafeListTest, removes_only_one_of_duplicate_elements)
+{
+    using namespace testing;
+
+    int elements_seen = 0;
+
+    list.add(element1);
+    list.add(element1);
+
+    list.remove(element1);
+
+    list.for_each([&] (Element const&) { ++elements_seen; });
+
+    EXPECT_THAT(elements_seen, Eq(1));
+}
+
+TEST_F(ThreadSafeListTest, removed_elements_are_released)
+{
+    using namespace testing;
+
+    list.add(element1);
+    auto const use_count = element1.use_count();
+
+    list.remove(element1);
+
+    EXPECT_THAT(element1.use_count(), Lt(use_count));
+}
+
+TEST_F(ThreadSafeListTest, for_each_skips_elements_that_convert_to_false)
+{
+    using namespace testing;
+
+    list.add(element1);
+    list.add(Element{});
+    list.add(element2);
+
+    std::vector<Element> elements_seen;
+    list.for_each([&] (Element const& element) { elements_seen.push_back(element); });
+
+    EXPECT_THAT(elements_seen, ElementsAre(element1, element2));
+}
+
+TEST_F(ThreadSafeListTest, concurrent_updates_and_iteration_see_only_live_elements)
+{
+    using namespace testing;
+
+    struct Counted
+    {
+        explicit Counted(std::atomic<int>& calls_after_removal) : calls_after_removal{calls_after_removal} {}
+        std::atomic<int>& calls_after_removal;
+        std::atomic<bool> removed{false};
+    };
+
+    std::atomic<int> calls_after_removal{0};
+    std::atomic<bool> done{false};
+
+    mir::ThreadSafeList<std::shared_ptr<Counted>> counted_list;
+
+    std::vector<std::thread> iterators;
+    for (auto i = 0; i != 4; ++i)
+    {
+        iterators.emplace_back(
+            [&]
+            {
+                while (!done)
+                {
+                    counted_list.for_each(
+                        [&] (std::shared_ptr<Counted> const& counted)
+                        {
+                            if (counted->removed) ++counted->calls_after_removal;
+                        });
+                }
+            });
+    }
+
+    for (auto i = 0; i != 1000; ++i)
+    {
+        auto const counted = std::make_shared<Counted>(calls_after_removal);
+        counted_list.add(counted);
+        counted_list.remove(counted);
+        counted->removed = true;
+    }
+
+    done = true;
+    for (auto& t : iterators) t.join();
+
+    EXPECT_THAT(calls_after_removal, Eq(0));
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/protobuf/wire_codec.h"
+
+#include "mir_protobuf.pb.h"
+#include "mir_protobuf_wire.pb.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+namespace mp = mir::protobuf;
+
+using namespace testing;
+
+namespace
+{
+mp::BufferRequest a_buffer_request(int buffer_id)
+{
+    mp::BufferRequest request;
+    request.mutable_id()->set_value(3);
+    request.mutable_buffer()->set_buffer_id(buffer_id);
+    return request;
+}
+
+mp::EventSequence a_ping(int serial)
+{
+    mp::EventSequence seq;
+    seq.mutable_ping_event()->set_serial(serial);
+    return seq;
+}
+
+template<typename Message>
+std::string serialize(mp::ResultEnvelope const& envelope, Message const& payload)
+{
+    std::vector<unsigned char> buffer(envelope.size());
+    payload.SerializeWithCachedSizesToArray(envelope.write_header(buffer.data()));
+    return {buffer.begin(), buffer.end()};
+}
+}
+
+TEST(WireCodec, decodes_invocation_fields)
+{
+    mp::wire::Invocation invocation;
+    invocation.set_id(17);
+    invocation.set_method_name("submit_buffer");
+    invocation.set_parameters(a_buffer_request(42).SerializeAsString());
+    invocation.set_protocol_version(0x600);
+    invocation.set_side_channel_fds(2);
+    auto const bytes = invocation.SerializeAsString();
+
+    mp::InvocationView view;
+    ASSERT_TRUE(view.parse(bytes.data(), bytes.size()));
+
+    EXPECT_THAT(view.id, Eq(17u));
+    EXPECT_THAT(view.method_name, Eq("submit_buffer"));
+    EXPECT_TRUE(view.has_protocol_version);
+    EXPECT_THAT(view.protocol_version, Eq(0x600u));
+    EXPECT_THAT(view.side_channel_fds, Eq(2u));
+
+    mp::BufferRequest request;
+    ASSERT_TRUE(view.parameters.parse_into(request));
+    EXPECT_THAT(request.buffer().buffer_id(), Eq(42));
+}
+
+TEST(WireCodec, invocation_parameters_refer_into_the_received_bytes)
+{
+    mp::wire::Invocation invocation;
+    invocation.set_id(1);
+    invocation.set_method_name("m");
+    invocation.set_parameters(a_buffer_request(1).SerializeAsString());
+    invocation.set_protocol_version(1);
+    auto const bytes = invocation.SerializeAsString();
+
+    mp::InvocationView view;
+    ASSERT_TRUE(view.parse(bytes.data(), bytes.size()));
+
+    auto const begin = reinterpret_cast<unsigned char const*>(bytes.data());
+    EXPECT_THAT(view.parameters.data, Ge(begin));
+    EXPECT_THAT(view.parameters.data + view.parameters.size, Le(begin + bytes.size()));
+}
+
+TEST(WireCodec, reused_view_forgets_previous_invocation)
+{
+    mp::wire::Invocation first;
+    first.set_id(1);
+    first.set_method_name("first");
+    first.set_parameters("");
+    first.set_protocol_version(1);
+    first.set_side_channel_fds(3);
+    auto const first_bytes = first.SerializeAsString();
+
+    mp::wire::Invocation second;
+    second.set_id(2);
+    second.set_method_name("second");
+    second.set_parameters("");
+    auto const second_bytes = second.SerializePartialAsString();
+
+    mp::InvocationView view;
+    ASSERT_TRUE(view.parse(first_bytes.data(), first_bytes.size()));
+    ASSERT_TRUE(view.parse(second_bytes.data(), second_bytes.size()));
+
+    EXPECT_THAT(view.id, Eq(2u));
+    EXPECT_THAT(view.method_name, Eq("second"));
+    EXPECT_FALSE(view.has_protocol_version);
+    EXPECT_THAT(view.side_channel_fds, Eq(0u));
+}
+
+TEST(WireCodec, decodes_result_with_response_and_events)
+{
+    mp::wire::Result result;
+    result.set_id(9);
+    result.set_response(a_buffer_request(5).SerializeAsString());
+    result.add_events(a_ping(1).SerializeAsString());
+    result.add_events(a_ping(2).SerializeAsString());
+    auto const bytes = result.SerializeAsString();
+
+    mp::ResultView view;
+    ASSERT_TRUE(view.parse(bytes.data(), bytes.size()));
+
+    EXPECT_TRUE(view.has_id);
+    EXPECT_THAT(view.id, Eq(9u));
+
+    mp::BufferRequest response;
+    ASSERT_TRUE(view.response.parse_into(response));
+    EXPECT_THAT(response.buffer().buffer_id(), Eq(5));
+
+    ASSERT_THAT(view.events.size(), Eq(2u));
+    mp::EventSequence seq;
+    ASSERT_TRUE(view.events[1].parse_into(seq));
+    EXPECT_THAT(seq.ping_event().serial(), Eq(2));
+}
+
+TEST(WireCodec, decodes_event_only_result)
+{
+    mp::wire::Result result;
+    result.add_events(a_ping(7).SerializeAsString());
+    auto const bytes = result.SerializeAsString();
+
+    mp::ResultView view;
+    ASSERT_TRUE(view.parse(bytes.data(), bytes.size()));
+
+    EXPECT_FALSE(view.has_id);
+    EXPECT_THAT(view.events.size(), Eq(1u));
+}
+
+TEST(WireCodec, rejects_truncated_result)
+{
+    mp::wire::Result result;
+    result.set_id(9);
+    result.set_response(a_buffer_request(5).SerializeAsString());
+    auto const bytes = result.SerializeAsString();
+
+    mp::ResultView view;
+    EXPECT_FALSE(view.parse(bytes.data(), bytes.size() - 1));
+}
+
+TEST(WireCodec, response_envelope_matches_serialized_result)
+{
+    auto const response = a_buffer_request(11);
+
+    mp::wire::Result result;
+    result.set_id(300);
+    result.set_response(response.SerializeAsString());
+
+#if GOOGLE_PROTOBUF_VERSION >= 3010000
+    auto const envelope = mp::ResultEnvelope::response(300, response.ByteSizeLong());
+#else
+    auto const envelope = mp::ResultEnvelope::response(300, response.ByteSize());
+#endif
+
+    EXPECT_THAT(serialize(envelope, response), Eq(result.SerializeAsString()));
+}
+
+TEST(WireCodec, event_envelope_matches_serialized_result)
+{
+    auto const seq = a_ping(1234);
+
+    mp::wire::Result result;
+    result.add_events(seq.SerializeAsString());
+
+#if GOOGLE_PROTOBUF_VERSION >= 3010000
+    auto const envelope = mp::ResultEnvelope::event(seq.ByteSizeLong());
+#else
+    auto const envelope = mp::ResultEnvelope::event(seq.ByteSize());
+#endif
+
+    EXPECT_THAT(serialize(envelope, seq), Eq(result.SerializeAsString()));
+}
+
+TEST(WireCodec, arena_messages_are_usable_after_reset)
+{
+    mp::MessageArena arena;
+
+    for (int i = 0; i != 3; ++i)
+    {
+        arena.reset();
+        auto const request = arena.create<mp::BufferRequest>();
+        request->mutable_buffer()->set_buffer_id(i);
+        EXPECT_THAT(request->buffer().buffer_id(), Eq(i));
+    }
+}
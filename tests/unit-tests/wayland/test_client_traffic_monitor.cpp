@@ -0,0 +1,264 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/client_traffic_monitor.h"
+
+#include "mir/fd.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <wayland-server-core.h>
+#include <wayland-server-protocol.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace mf = mir::frontend;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+size_t const queue_limit{8192};
+
+struct Client
+{
+    wl_client* server_end;
+    mir::Fd client_end;
+};
+
+class ClientTrafficMonitorTest : public Test
+{
+public:
+    ClientTrafficMonitorTest()
+        : display{wl_display_create()}
+    {
+    }
+
+    ~ClientTrafficMonitorTest()
+    {
+        wl_display_destroy_clients(display);
+        monitor.reset();
+        wl_display_destroy(display);
+    }
+
+    void start_monitor(unsigned throttle_after, unsigned disconnect_after)
+    {
+        monitor = std::make_unique<mf::ClientTrafficMonitor>(
+            display,
+            mf::ClientTrafficMonitor::Limits{queue_limit, throttle_after, disconnect_after, 0ms});
+    }
+
+    auto connect_client() -> Client
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+        {
+            ADD_FAILURE() << "Failed to create client socket pair";
+        }
+        return Client{wl_client_create(display, fds[0]), mir::Fd{fds[1]}};
+    }
+
+    /// Sends the client more events than the queue limit, without it reading any of them
+    void stall(Client const& client)
+    {
+        auto const callback = wl_resource_create(client.server_end, &wl_callback_interface, 1, 0);
+
+        // Comfortably more than the limit, but less than the socket buffer holds
+        for (auto batch = 0; batch != 20; ++batch)
+        {
+            for (auto event = 0; event != 100; ++event)
+            {
+                wl_callback_send_done(callback, 0);
+            }
+            wl_client_flush(client.server_end);
+        }
+    }
+
+    static void catch_up(Client const& client)
+    {
+        std::array<char, 4096> buffer;
+        while (recv(client.client_end, buffer.data(), buffer.size(), MSG_DONTWAIT) > 0)
+        {
+        }
+    }
+
+    static bool has_events(Client const& client)
+    {
+        pollfd readable{client.client_end, POLLIN, 0};
+        return poll(&readable, 1, 0) == 1;
+    }
+
+    wl_display* const display;
+    std::unique_ptr<mf::ClientTrafficMonitor> monitor;
+};
+}
+
+#ifndef MIR_NO_WAYLAND_PROTOCOL_LOGGER
+TEST_F(ClientTrafficMonitorTest, counts_requests_and_events_of_each_client)
+{
+    start_monitor(0, 0);
+    auto const busy = connect_client();
+    auto const idle = connect_client();
+
+    // wl_display@1.sync(new wl_callback@2)
+    uint32_t const sync[] = {1, (12 << 16) | WL_DISPLAY_SYNC, 2};
+    ASSERT_THAT(send(busy.client_end, sync, sizeof sync, 0), Eq(static_cast<ssize_t>(sizeof sync)));
+
+    wl_event_loop_dispatch(wl_display_get_event_loop(display), 0);
+    monitor->sample();
+
+    auto const traffic = monitor->snapshot();
+    ASSERT_THAT(traffic.size(), Eq(2u));
+    EXPECT_THAT(traffic[0].requests, Eq(1u));
+    EXPECT_THAT(traffic[0].events, Gt(0u));
+    EXPECT_THAT(traffic[1].requests, Eq(0u));
+    EXPECT_THAT(traffic[1].events, Eq(0u));
+}
+#endif
+
+TEST_F(ClientTrafficMonitorTest, throttles_a_client_that_stays_behind)
+{
+    start_monitor(2, 0);
+    auto const stalled = connect_client();
+    auto const healthy = connect_client();
+
+    stall(stalled);
+
+    monitor->sample();
+    EXPECT_FALSE(mf::ClientTraffic::from(stalled.server_end)->throttled());
+
+    monitor->sample();
+    EXPECT_TRUE(mf::ClientTraffic::from(stalled.server_end)->throttled());
+    EXPECT_FALSE(mf::ClientTraffic::from(healthy.server_end)->throttled());
+
+    auto const traffic = monitor->snapshot();
+    ASSERT_THAT(traffic.size(), Eq(2u));
+    EXPECT_THAT(traffic[0].queued_bytes, Gt(queue_limit));
+    EXPECT_TRUE(traffic[0].throttled);
+    EXPECT_FALSE(traffic[1].throttled);
+}
+
+TEST_F(ClientTrafficMonitorTest, stalled_client_does_not_delay_other_clients_frame_callbacks)
+{
+    start_monitor(1, 0);
+    auto const stalled = connect_client();
+    auto const healthy = connect_client();
+    auto const healthy_frame = wl_resource_create(healthy.server_end, &wl_callback_interface, 1, 0);
+
+    stall(stalled);
+    monitor->sample();
+
+    bool stalled_frame_done{false};
+    mf::ClientTraffic::from(stalled.server_end)->run_unthrottled(this, [&] { stalled_frame_done = true; });
+
+    auto const start = std::chrono::steady_clock::now();
+    mf::ClientTraffic::from(healthy.server_end)->run_unthrottled(this, [&] { wl_callback_send_done(healthy_frame, 0); });
+    wl_display_flush_clients(display);
+
+    EXPECT_TRUE(has_events(healthy));
+    EXPECT_THAT(std::chrono::steady_clock::now() - start, Lt(100ms));
+    EXPECT_FALSE(stalled_frame_done);
+
+    // Once the stalled client reads its events its frame callbacks are released
+    catch_up(stalled);
+    monitor->sample();
+
+    EXPECT_TRUE(stalled_frame_done);
+    EXPECT_FALSE(mf::ClientTraffic::from(stalled.server_end)->throttled());
+}
+
+TEST_F(ClientTrafficMonitorTest, work_deferred_for_the_same_key_runs_once)
+{
+    start_monitor(1, 0);
+    auto const stalled = connect_client();
+    auto const traffic = mf::ClientTraffic::from(stalled.server_end);
+
+    stall(stalled);
+    monitor->sample();
+
+    int const surface{0}, other_surface{0};
+    int surface_runs{0}, other_surface_runs{0};
+    for (auto i = 0; i != 100; ++i)
+    {
+        traffic->run_unthrottled(&surface, [&] { ++surface_runs; });
+    }
+    traffic->run_unthrottled(&other_surface, [&] { ++other_surface_runs; });
+
+    catch_up(stalled);
+    monitor->sample();
+
+    EXPECT_THAT(surface_runs, Eq(1));
+    EXPECT_THAT(other_surface_runs, Eq(1));
+}
+
+TEST_F(ClientTrafficMonitorTest, cancelled_work_is_not_run)
+{
+    start_monitor(1, 0);
+    auto const stalled = connect_client();
+    auto const traffic = mf::ClientTraffic::from(stalled.server_end);
+
+    stall(stalled);
+    monitor->sample();
+
+    bool ran{false};
+    traffic->run_unthrottled(this, [&] { ran = true; });
+    traffic->cancel_deferred(this);
+
+    catch_up(stalled);
+    monitor->sample();
+
+    EXPECT_FALSE(ran);
+}
+
+TEST_F(ClientTrafficMonitorTest, disconnects_a_client_that_stays_behind)
+{
+    start_monitor(1, 3);
+    auto const stalled = connect_client();
+    auto const healthy = connect_client();
+
+    stall(stalled);
+
+    monitor->sample();
+    monitor->sample();
+    EXPECT_THAT(monitor->snapshot().size(), Eq(2u));
+
+    monitor->sample();
+    EXPECT_THAT(monitor->snapshot().size(), Eq(1u));
+    EXPECT_THAT(mf::ClientTraffic::from(healthy.server_end), NotNull());
+}
+
+TEST_F(ClientTrafficMonitorTest, counts_pending_frame_callbacks)
+{
+    start_monitor(0, 0);
+    auto const client = connect_client();
+    auto const traffic = mf::ClientTraffic::from(client.server_end);
+
+    traffic->frame_callbacks_requested(3);
+    traffic->frame_callbacks_completed(2);
+    monitor->sample();
+    EXPECT_THAT(monitor->snapshot()[0].pending_frame_callbacks, Eq(1u));
+
+    traffic->frame_callbacks_completed(2);
+    monitor->sample();
+    EXPECT_THAT(monitor->snapshot()[0].pending_frame_callbacks, Eq(0u));
+}
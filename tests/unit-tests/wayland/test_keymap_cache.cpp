@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/keymap_cache.h"
+
+#include "mir/input/keymap.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <future>
+
+namespace mf = mir::frontend;
+namespace mi = mir::input;
+
+using namespace testing;
+
+namespace
+{
+struct KeymapCache : Test
+{
+    mi::Keymap const us{"pc105", "us", "", ""};
+    mi::Keymap const gb{"pc105", "gb", "", ""};
+
+    mf::KeymapCache cache;
+};
+}
+
+TEST_F(KeymapCache, compiles_each_keymap_once)
+{
+    cache.prepare(us);
+
+    auto const first = cache.get(us);
+    auto const second = cache.get(mi::Keymap{"pc105", "us", "", ""});
+
+    EXPECT_THAT(first, Eq(second));
+    EXPECT_THAT(first->keymap(), NotNull());
+}
+
+TEST_F(KeymapCache, compiles_distinct_keymaps_separately)
+{
+    EXPECT_THAT(cache.get(us), Ne(cache.get(gb)));
+}
+
+TEST_F(KeymapCache, hands_clients_the_nul_terminated_keymap_text)
+{
+    auto const keymap = cache.get(us);
+    auto const fd = keymap->client_fd();
+
+    auto const text = static_cast<char const*>(mmap(nullptr, keymap->size(), PROT_READ, MAP_PRIVATE, fd, 0));
+    ASSERT_THAT(text, Ne(MAP_FAILED));
+
+    EXPECT_THAT(text[keymap->size() - 1], Eq('\0'));
+    EXPECT_THAT(strlen(text), Eq(keymap->size() - 1));
+    EXPECT_THAT(text, StartsWith("xkb_keymap"));
+
+    munmap(const_cast<char*>(text), keymap->size());
+}
+
+TEST_F(KeymapCache, clients_cannot_modify_the_keymap_text)
+{
+    auto const keymap = cache.get(us);
+    auto const fd = keymap->client_fd();
+
+    EXPECT_THAT(write(fd, "x", 1), Eq(-1));
+    EXPECT_THAT(ftruncate(fd, 0), Eq(-1));
+    EXPECT_THAT(mmap(nullptr, keymap->size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0), Eq(MAP_FAILED));
+}
+
+TEST_F(KeymapCache, throws_for_a_keymap_that_does_not_compile)
+{
+    EXPECT_THROW(cache.get(mi::Keymap{"pc105", "not-a-layout", "", ""}), std::runtime_error);
+}
+
+TEST_F(KeymapCache, hands_over_the_compiled_keymap_without_waiting_for_it)
+{
+    std::promise<std::shared_ptr<mf::CompiledKeymap const>> compiled;
+
+    cache.when_compiled(
+        us,
+        [&compiled](std::shared_ptr<mf::CompiledKeymap const> const& keymap, std::exception_ptr const& error)
+        {
+            if (error)
+                compiled.set_exception(error);
+            else
+                compiled.set_value(keymap);
+        });
+
+    auto result = compiled.get_future();
+    ASSERT_THAT(result.wait_for(std::chrono::seconds{10}), Eq(std::future_status::ready));
+    EXPECT_THAT(result.get(), Eq(cache.get(us)));
+}
+
+TEST_F(KeymapCache, hands_over_the_reason_a_keymap_does_not_compile)
+{
+    std::promise<std::shared_ptr<mf::CompiledKeymap const>> compiled;
+
+    cache.when_compiled(
+        mi::Keymap{"pc105", "not-a-layout", "", ""},
+        [&compiled](std::shared_ptr<mf::CompiledKeymap const> const& keymap, std::exception_ptr const& error)
+        {
+            if (error)
+                compiled.set_exception(error);
+            else
+                compiled.set_value(keymap);
+        });
+
+    auto result = compiled.get_future();
+    ASSERT_THAT(result.wait_for(std::chrono::seconds{10}), Eq(std::future_status::ready));
+    EXPECT_THROW(result.get(), std::runtime_error);
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/wayland/wayland_base.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <thread>
+
+namespace mw = mir::wayland;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+auto profile_names() -> std::vector<std::string>
+{
+    std::vector<std::string> names;
+    mw::for_each_request_profile([&names](mw::RequestProfile const& profile)
+        {
+            names.push_back(profile.name);
+        });
+    return names;
+}
+}
+
+TEST(WaylandRequestProfile, new_profile_is_visited)
+{
+    static mw::RequestProfile profile{"Test::new_profile_is_visited()"};
+
+    EXPECT_THAT(profile_names(), Contains(StrEq("Test::new_profile_is_visited()")));
+}
+
+TEST(WaylandRequestProfile, timer_counts_each_dispatch)
+{
+    static mw::RequestProfile profile{"Test::timer_counts_each_dispatch()"};
+
+    for (int i = 0; i != 3; ++i)
+    {
+        mw::RequestTimer const timer{profile};
+    }
+
+    EXPECT_THAT(profile.dispatch_count, Eq(3u));
+}
+
+TEST(WaylandRequestProfile, timer_accounts_time_spent_dispatching)
+{
+    static mw::RequestProfile profile{"Test::timer_accounts_time_spent_dispatching()"};
+
+    {
+        mw::RequestTimer const timer{profile};
+        std::this_thread::sleep_for(10ms);
+    }
+    {
+        mw::RequestTimer const timer{profile};
+    }
+
+    EXPECT_THAT(profile.max_time, Ge(10ms));
+    EXPECT_THAT(profile.total_time, Ge(profile.max_time));
+}